@@ -0,0 +1,718 @@
+// End-to-end benchmark: the controller's nodes, distributor and AAS client against
+// simulated stations behind an in-process MQTT broker and a mock AAS server
+#include "fake_broker.h"
+#include "mock_aas_server.h"
+#include "station_simulator.h"
+
+#include "aas/aas_client.h"
+#include "aas/aas_interface_cache.h"
+#include "bt/register_all_nodes.h"
+#include "bt/tick_pool.h"
+#include "metrics/latency_metrics.h"
+#include "mqtt/mqtt_client.h"
+#include "mqtt/node_message_distributor.h"
+#include "utils.h"
+
+#include <behaviortree_cpp/bt_factory.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef BT_CONTROLLER_REPO_ROOT
+#define BT_CONTROLLER_REPO_ROOT ".."
+#endif
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct BenchOptions
+    {
+        size_t stations = 4;
+        size_t shuttles = 6;
+        size_t cycles = 5;
+        int service_time_us = 2000;
+        std::string policy = "first_response";
+        size_t storm_messages = 100000;
+        size_t storm_subscribers = 64;
+        int dispatch_workers = 4;
+        int parallel_tick_workers = -1; // >= 0 runs the shuttles under Parallel_Concurrent
+        size_t validation_iterations = 100000;
+        size_t starting_runs = 5;
+        int timeout_s = 120;
+        std::string fixture = std::string(BT_CONTROLLER_REPO_ROOT) + "/AASDescriptions/Resource/configs/imaDispensing.yaml";
+        std::string schema_dir = std::string(BT_CONTROLLER_REPO_ROOT) + "/MQTTSchemas";
+        std::string output = "bt_controller_bench.json";
+        bool verbose = false;
+    };
+
+    double msSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // The nodes log every step to std::cout; keep it out of the way unless asked for
+    class QuietStdout
+    {
+    public:
+        explicit QuietStdout(bool verbose) : saved_(verbose ? nullptr : std::cout.rdbuf(nullptr)) {}
+        ~QuietStdout()
+        {
+            if (saved_)
+            {
+                std::cout.rdbuf(saved_);
+                std::cout.clear();
+            }
+        }
+
+    private:
+        std::streambuf *saved_;
+    };
+
+    /// @brief The simulated plant: broker, stations and their AAS
+    struct SimulatedLine
+    {
+        FakeMqttBroker broker;
+        std::unique_ptr<MockAasServer> aas;
+        std::unique_ptr<StationSimulator> stations;
+        std::map<std::string, std::string> equipment; // Equipment name -> AAS id
+        std::vector<std::string> station_ids;
+
+        bool start(const BenchOptions &options)
+        {
+            if (broker.start() == 0)
+            {
+                return false;
+            }
+            aas = std::make_unique<MockAasServer>(options.schema_dir);
+            if (aas->start() == 0)
+            {
+                return false;
+            }
+
+            YAML::Node fixture = YAML::LoadFile(options.fixture);
+            if (!fixture.IsMap() || fixture.size() == 0)
+            {
+                std::cerr << "Fixture " << options.fixture << " has no shell" << std::endl;
+                return false;
+            }
+            YAML::Node shell = fixture.begin()->second;
+
+            stations = std::make_unique<StationSimulator>(broker, std::chrono::microseconds(options.service_time_us));
+            for (size_t i = 0; i < options.stations; ++i)
+            {
+                char suffix[16];
+                std::snprintf(suffix, sizeof(suffix), "_s%03zu", i + 1);
+                std::string base_topic = std::string("Bench/Line/Station") + (suffix + 2);
+                std::string id = aas->addShell(shell, suffix, base_topic);
+                stations->addStation(base_topic);
+                equipment[std::string("Station") + (suffix + 2)] = id;
+                station_ids.push_back(id);
+            }
+            stations->start();
+            return true;
+        }
+
+        void stop()
+        {
+            if (stations)
+            {
+                stations->stop();
+            }
+            broker.stop();
+            if (aas)
+            {
+                aas->stop();
+            }
+        }
+    };
+
+    /// @brief The controller's runtime objects wired the way BehaviorTreeController does it
+    struct ControllerRuntime
+    {
+        std::unique_ptr<MqttClient> mqtt;
+        std::unique_ptr<NodeMessageDistributor> distributor;
+        std::unique_ptr<AASClient> aas;
+        std::unique_ptr<AASInterfaceCache> cache;
+        std::unique_ptr<BT::BehaviorTreeFactory> factory;
+
+        bool start(const SimulatedLine &line, const BenchOptions &options, const std::string &client_id)
+        {
+            auto conn_opts = mqtt::connect_options_builder::v5()
+                                 .clean_start(true)
+                                 .finalize();
+            mqtt = std::make_unique<MqttClient>(line.broker.uri(), client_id, conn_opts, 5);
+            if (!mqtt->is_connected())
+            {
+                std::cerr << "Could not connect to the bench broker at " << line.broker.uri() << std::endl;
+                return false;
+            }
+            distributor = std::make_unique<NodeMessageDistributor>(
+                *mqtt, static_cast<size_t>(std::max(options.dispatch_workers, 0)));
+            NodeMessageDistributor *target = distributor.get();
+            mqtt->set_message_handler([target](const std::string &topic, const std::shared_ptr<const json> &payload,
+                                               mqtt::properties props)
+                                      { target->handle_incoming_message(topic, payload, props); });
+
+            aas = std::make_unique<AASClient>(line.aas->url(), line.aas->url());
+            cache = std::make_unique<AASInterfaceCache>(*aas);
+            factory = std::make_unique<BT::BehaviorTreeFactory>();
+            registerAllNodes(*factory, *distributor, *mqtt, *aas);
+            MqttSubBase::setNodeMessageDistributor(distributor.get());
+            MqttSubBase::setAASInterfaceCache(cache.get());
+            return true;
+        }
+
+        void stop()
+        {
+            if (mqtt)
+            {
+                mqtt->set_message_handler(nullptr);
+            }
+            MqttSubBase::setNodeMessageDistributor(nullptr);
+            MqttSubBase::setAASInterfaceCache(nullptr);
+            factory.reset();
+            distributor.reset();
+            cache.reset();
+            aas.reset();
+            mqtt.reset();
+        }
+    };
+
+    /**
+     * @brief production.xml's shape: a Parallel of one subtree per shuttle
+     *
+     * The fixture's line trees (lineSOP.xml, product.xml) are not part of the repository,
+     * so each shuttle runs `cycles` occupy-and-dispense steps on the shared stations.
+     * The steps are unrolled rather than wrapped in a Repeat because action nodes bind
+     * their topics to the first Asset they are ticked with.
+     */
+    std::string productionTreeXml(const BenchOptions &options, const std::vector<std::string> &station_ids)
+    {
+        std::string assets;
+        for (const auto &id : station_ids)
+        {
+            assets += (assets.empty() ? "" : ";") + id;
+        }
+
+        const char *parallel_node = options.parallel_tick_workers >= 0 ? "Parallel_Concurrent" : "Parallel";
+
+        std::ostringstream xml;
+        xml << "<root BTCPP_format=\"4\" main_tree_to_execute=\"Production\">\n"
+            << "  <BehaviorTree ID=\"Production\">\n"
+            << "    <" << parallel_node << " success_count=\"" << options.shuttles << "\" failure_count=\"1\">\n";
+        for (size_t shuttle = 1; shuttle <= options.shuttles; ++shuttle)
+        {
+            xml << "      <SubTree ID=\"Shuttle\" Xbot=\"Xbot" << shuttle << "\"/>\n";
+        }
+        xml << "    </" << parallel_node << ">\n"
+            << "  </BehaviorTree>\n"
+            << "  <BehaviorTree ID=\"Shuttle\">\n"
+            << "    <SequenceWithMemory>\n";
+        for (size_t cycle = 1; cycle <= options.cycles; ++cycle)
+        {
+            xml << "      <Occupy Assets=\"" << assets << "\" Policy=\"" << options.policy
+                << "\" SelectedAsset=\"{Station" << cycle << "}\" Uuid=\"{Uuid" << cycle << "}\">\n"
+                << "        <Command_Execution Asset=\"{Station" << cycle << "}\" Operation=\"Dispensing\""
+                << " Uuid=\"{Uuid" << cycle << "}\"/>\n"
+                << "      </Occupy>\n";
+        }
+        xml << "    </SequenceWithMemory>\n"
+            << "  </BehaviorTree>\n"
+            << "</root>\n";
+        return xml.str();
+    }
+
+    /// @brief The controller's STARTING sequence: prefetch, build, subscribe. Times in ms.
+    json runStartingPhase(ControllerRuntime &runtime, const SimulatedLine &line, const BenchOptions &options,
+                          BT::Tree &tree, bool &ok)
+    {
+        json phase;
+        auto start = Clock::now();
+
+        runtime.aas->clearMemo();
+        runtime.cache->clear();
+        auto step = Clock::now();
+        ok = runtime.cache->prefetchInterfaces(line.equipment);
+        phase["PrefetchMs"] = msSince(step);
+
+        auto blackboard = BT::Blackboard::create();
+        for (const auto &[name, id] : line.equipment)
+        {
+            blackboard->set(name, id);
+        }
+        step = Clock::now();
+        try
+        {
+            tree = runtime.factory->createTreeFromText(productionTreeXml(options, line.station_ids), blackboard);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Tree creation failed: " << e.what() << std::endl;
+            ok = false;
+            return phase;
+        }
+        phase["TreeBuildMs"] = msSince(step);
+
+        step = Clock::now();
+        ok = runtime.distributor->subscribeForActiveNodes(tree) && ok;
+        phase["SubscribeMs"] = msSince(step);
+        phase["TotalMs"] = msSince(start);
+        phase["Ok"] = ok;
+        return phase;
+    }
+
+    json productionScenario(const BenchOptions &options)
+    {
+        json result;
+        SimulatedLine line;
+        ControllerRuntime runtime;
+        if (!line.start(options) || !runtime.start(line, options, "bt_controller_bench_production"))
+        {
+            runtime.stop();
+            line.stop();
+            return {{"Error", "setup failed"}};
+        }
+
+        LatencyMetrics::instance().toJson(true);
+        {
+            BT::Tree tree;
+            bool ok = false;
+            result["Starting"] = runStartingPhase(runtime, line, options, tree, ok);
+
+            BT::NodeStatus status = BT::NodeStatus::FAILURE;
+            auto start = Clock::now();
+            auto deadline = start + std::chrono::seconds(options.timeout_s);
+            if (ok)
+            {
+                status = tree.tickOnce();
+                while (status == BT::NodeStatus::RUNNING && Clock::now() < deadline)
+                {
+                    tree.sleep(std::chrono::milliseconds(1));
+                    status = tree.tickOnce();
+                }
+            }
+            double makespan_ms = msSince(start);
+            if (status == BT::NodeStatus::RUNNING)
+            {
+                tree.haltTree();
+            }
+
+            size_t steps = options.shuttles * options.cycles;
+            result["Status"] = BT::toStr(status);
+            result["TimedOut"] = status == BT::NodeStatus::RUNNING;
+            result["Steps"] = steps;
+            result["MakespanMs"] = makespan_ms;
+            result["StepsPerSecond"] = makespan_ms > 0 ? steps * 1000.0 / makespan_ms : 0.0;
+            // Lower bound with every station busy all the time
+            result["IdealMakespanMs"] = static_cast<double>((steps + options.stations - 1) / options.stations) *
+                                        options.service_time_us / 1000.0;
+        }
+        result["Latency"] = LatencyMetrics::instance().toJson(true);
+
+        auto broker_stats = line.broker.getStats();
+        result["Broker"] = {{"PublishesIn", broker_stats.publishes_in},
+                            {"PublishesOut", broker_stats.publishes_out},
+                            {"Subscriptions", broker_stats.subscriptions}};
+        result["StationCommands"] = line.stations->commandsHandled();
+        result["AasRequests"] = line.aas->requestCount();
+
+        runtime.stop();
+        line.stop();
+        return result;
+    }
+
+    json startingPhaseScenario(const BenchOptions &options)
+    {
+        json runs = json::array();
+        SimulatedLine line;
+        ControllerRuntime runtime;
+        if (!line.start(options) || !runtime.start(line, options, "bt_controller_bench_starting"))
+        {
+            runtime.stop();
+            line.stop();
+            return {{"Error", "setup failed"}};
+        }
+
+        for (size_t run = 0; run < options.starting_runs; ++run)
+        {
+            uint64_t requests_before = line.aas->requestCount();
+            BT::Tree tree;
+            bool ok = false;
+            json phase = runStartingPhase(runtime, line, options, tree, ok);
+            phase["AasRequests"] = line.aas->requestCount() - requests_before;
+            runs.push_back(std::move(phase));
+        }
+
+        runtime.stop();
+        line.stop();
+        // The first run also fetches and compiles the schemas, which stay cached in-process
+        return {{"Runs", runs}};
+    }
+
+    /// @brief Counts deliveries; validation runs in MqttSubBase::processMessage as for any node
+    class StormSubscriber : public MqttSubBase
+    {
+    public:
+        StormSubscriber(MqttClient &mqtt_client, const mqtt_utils::Topic &topic)
+            : MqttSubBase(mqtt_client)
+        {
+            setTopic("output", topic);
+        }
+
+        void callback(const std::string &, const nlohmann::json &, mqtt::properties) override
+        {
+            received_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::string getBTNodeName() const override { return "StormSubscriber"; }
+
+        uint64_t received() const { return received_.load(); }
+
+    private:
+        std::atomic<uint64_t> received_{0};
+    };
+
+    json messageStormScenario(const BenchOptions &options)
+    {
+        json result;
+        SimulatedLine line;
+        ControllerRuntime runtime;
+        if (!line.start(options) || !runtime.start(line, options, "bt_controller_bench_storm"))
+        {
+            runtime.stop();
+            line.stop();
+            return {{"Error", "setup failed"}};
+        }
+
+        json schema = schema_utils::fetchSchemaFromUrl(line.aas->url() + "/MQTTSchemas/stationState.schema.json");
+        schema_utils::resolveSchemaReferences(schema);
+
+        // One subscriber per station topic plus one wildcard listener, as Occupy nodes
+        // and a line-wide condition would subscribe
+        size_t subscriber_count = std::max<size_t>(options.storm_subscribers, 1);
+        std::vector<std::string> topics;
+        std::vector<std::unique_ptr<StormSubscriber>> subscribers;
+        for (size_t i = 0; i < subscriber_count; ++i)
+        {
+            topics.push_back("Bench/Storm/Station" + std::to_string(i) + "/DATA/State");
+            subscribers.push_back(std::make_unique<StormSubscriber>(*runtime.mqtt, mqtt_utils::Topic(topics.back(), schema)));
+        }
+        subscribers.push_back(std::make_unique<StormSubscriber>(*runtime.mqtt,
+                                                                mqtt_utils::Topic("Bench/Storm/+/DATA/State", schema)));
+        for (auto &subscriber : subscribers)
+        {
+            runtime.distributor->registerLateInitializingNode(subscriber.get());
+        }
+
+        json payload = {{"TimeStamp", bt_utils::getCurrentTimestampISO()},
+                        {"State", "EXECUTE"},
+                        {"ProcessQueue", json::array({"a", "b"})},
+                        {"QueueDepth", 2}};
+        std::string payload_text = payload.dump();
+
+        auto totalReceived = [&subscribers]()
+        {
+            uint64_t total = 0;
+            for (const auto &subscriber : subscribers)
+            {
+                total += subscriber->received();
+            }
+            return total;
+        };
+
+        // Wait for the deliveries or until nothing has arrived for a second (drops, losses)
+        auto drain = [&](uint64_t expected)
+        {
+            uint64_t last = totalReceived();
+            auto last_progress = Clock::now();
+            while (last < expected && Clock::now() - last_progress < std::chrono::seconds(1))
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                uint64_t now = totalReceived();
+                if (now != last)
+                {
+                    last = now;
+                    last_progress = Clock::now();
+                }
+            }
+            return last;
+        };
+
+        // Straight into the distributor, as Paho's callback thread would hand messages over
+        // One parsed document for the whole storm: parsing is measured through the socket below
+        auto shared_payload = std::make_shared<const json>(payload);
+        uint64_t expected = options.storm_messages * 2;
+        uint64_t base = totalReceived();
+        auto start = Clock::now();
+        for (size_t i = 0; i < options.storm_messages; ++i)
+        {
+            runtime.distributor->handle_incoming_message(topics[i % topics.size()], shared_payload, mqtt::properties());
+        }
+        double enqueue_ms = msSince(start);
+        uint64_t delivered = drain(base + expected) - base;
+        double elapsed_ms = msSince(start);
+        result["Distributor"] = {{"Messages", options.storm_messages},
+                                 {"Deliveries", delivered},
+                                 {"ExpectedDeliveries", expected},
+                                 {"HandOffMs", enqueue_ms},
+                                 {"ElapsedMs", elapsed_ms},
+                                 {"MessagesPerSecond", elapsed_ms > 0 ? options.storm_messages * 1000.0 / elapsed_ms : 0.0}};
+
+        // Through the socket: broker fan-out, Paho, JSON parsing and the distributor
+        base = totalReceived();
+        start = Clock::now();
+        for (size_t i = 0; i < options.storm_messages; ++i)
+        {
+            line.broker.publish(topics[i % topics.size()], payload_text);
+        }
+        delivered = drain(base + expected) - base;
+        elapsed_ms = msSince(start);
+        result["EndToEnd"] = {{"Messages", options.storm_messages},
+                              {"Deliveries", delivered},
+                              {"ExpectedDeliveries", expected},
+                              {"ElapsedMs", elapsed_ms},
+                              {"MessagesPerSecond", elapsed_ms > 0 ? options.storm_messages * 1000.0 / elapsed_ms : 0.0}};
+
+        auto stats = runtime.distributor->getDispatchStats();
+        result["Dispatch"] = {{"Workers", stats.workers},
+                              {"MaxQueueDepth", stats.max_queue_depth},
+                              {"Dropped", stats.dropped}};
+        result["Latency"] = LatencyMetrics::instance().toJson(true);
+
+        for (auto &subscriber : subscribers)
+        {
+            runtime.distributor->unregisterInstance(subscriber.get());
+        }
+        runtime.stop();
+        subscribers.clear();
+        line.stop();
+        return result;
+    }
+
+    json schemaValidationScenario(const BenchOptions &options)
+    {
+        json result;
+        MockAasServer aas(options.schema_dir);
+        if (aas.start() == 0)
+        {
+            return {{"Error", "setup failed"}};
+        }
+
+        std::string timestamp = bt_utils::getCurrentTimestampISO();
+        struct Case
+        {
+            std::string schema;
+            json valid;
+            json invalid;
+        };
+        std::vector<Case> cases = {
+            {"command.schema.json", {{"Uuid", "3f1c"}}, {{"Uuid", 42}}},
+            {"commandResponse.schema.json",
+             {{"TimeStamp", timestamp}, {"Uuid", "3f1c"}, {"State", "SUCCESS"}},
+             {{"TimeStamp", timestamp}, {"Uuid", "3f1c"}, {"State", "DONE"}}},
+            {"stationState.schema.json",
+             {{"TimeStamp", timestamp}, {"State", "EXECUTE"}, {"ProcessQueue", {"a", "b", "c"}}, {"QueueDepth", 3}},
+             {{"TimeStamp", timestamp}, {"State", "EXECUTE"}}},
+        };
+
+        for (const auto &test_case : cases)
+        {
+            json schema = schema_utils::fetchSchemaFromUrl(aas.url() + "/MQTTSchemas/" + test_case.schema);
+            schema_utils::resolveSchemaReferences(schema);
+            mqtt_utils::Topic topic("Bench/Validation", schema);
+
+            json entry;
+            for (const auto &[label, message] : {std::pair<const char *, const json &>{"Valid", test_case.valid},
+                                                 std::pair<const char *, const json &>{"Invalid", test_case.invalid}})
+            {
+                size_t accepted = 0;
+                auto start = Clock::now();
+                for (size_t i = 0; i < options.validation_iterations; ++i)
+                {
+                    accepted += topic.validateMessage(message) ? 1 : 0;
+                }
+                double elapsed_ms = msSince(start);
+                entry[label] = {{"Iterations", options.validation_iterations},
+                                {"Accepted", accepted},
+                                {"NsPerMessage", options.validation_iterations > 0
+                                                     ? elapsed_ms * 1e6 / options.validation_iterations
+                                                     : 0.0},
+                                {"MessagesPerSecond", elapsed_ms > 0 ? options.validation_iterations * 1000.0 / elapsed_ms : 0.0}};
+            }
+            result[test_case.schema] = entry;
+        }
+
+        aas.stop();
+        return result;
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --stations N             Simulated stations (default 4)\n"
+                  << "  --shuttles M             Shuttles running in parallel (default 6)\n"
+                  << "  --cycles K               Occupy/dispense steps per shuttle (default 5)\n"
+                  << "  --service-us T           Station service time in microseconds (default 2000)\n"
+                  << "  --policy NAME            Occupy Policy port (default first_response)\n"
+                  << "  --storm-messages N       Messages per storm phase (default 100000)\n"
+                  << "  --storm-subscribers N    Topics in the storm (default 64)\n"
+                  << "  --dispatch-workers N     Distributor workers, 0 = synchronous (default 4)\n"
+                  << "  --parallel-tick-workers N  Tick shuttles under Parallel_Concurrent with N pool workers\n"
+                  << "  --validation-iterations N  Validations per schema and case (default 100000)\n"
+                  << "  --starting-runs N        STARTING phase repetitions (default 5)\n"
+                  << "  --timeout-s S            Production run time limit (default 120)\n"
+                  << "  --scenario NAME          production, storm, validation or starting; repeatable\n"
+                  << "  --fixture PATH           AAS description YAML of the station template\n"
+                  << "  --schemas DIR            Directory with the MQTT schemas\n"
+                  << "  --output PATH            JSON results (default bt_controller_bench.json, - for stdout)\n"
+                  << "  --verbose                Keep the nodes' console output\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    std::vector<std::string> scenarios;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--stations")
+                options.stations = std::stoul(next());
+            else if (arg == "--shuttles")
+                options.shuttles = std::stoul(next());
+            else if (arg == "--cycles")
+                options.cycles = std::stoul(next());
+            else if (arg == "--service-us")
+                options.service_time_us = std::stoi(next());
+            else if (arg == "--policy")
+                options.policy = next();
+            else if (arg == "--storm-messages")
+                options.storm_messages = std::stoul(next());
+            else if (arg == "--storm-subscribers")
+                options.storm_subscribers = std::stoul(next());
+            else if (arg == "--dispatch-workers")
+                options.dispatch_workers = std::stoi(next());
+            else if (arg == "--parallel-tick-workers")
+                options.parallel_tick_workers = std::stoi(next());
+            else if (arg == "--validation-iterations")
+                options.validation_iterations = std::stoul(next());
+            else if (arg == "--starting-runs")
+                options.starting_runs = std::stoul(next());
+            else if (arg == "--timeout-s")
+                options.timeout_s = std::stoi(next());
+            else if (arg == "--scenario")
+                scenarios.push_back(next());
+            else if (arg == "--fixture")
+                options.fixture = next();
+            else if (arg == "--schemas")
+                options.schema_dir = next();
+            else if (arg == "--output")
+                options.output = next();
+            else if (arg == "--verbose")
+                options.verbose = true;
+            else
+            {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Invalid argument " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (options.stations == 0 || options.shuttles == 0 || options.cycles == 0)
+    {
+        std::cerr << "--stations, --shuttles and --cycles must be at least 1" << std::endl;
+        return 1;
+    }
+    if (options.parallel_tick_workers >= 0)
+    {
+        TickPool::instance().configure(static_cast<size_t>(options.parallel_tick_workers));
+    }
+    if (scenarios.empty())
+    {
+        scenarios = {"validation", "storm", "starting", "production"};
+    }
+
+    json report = {
+        {"Benchmark", "bt_controller_bench"},
+        {"TimeStamp", bt_utils::getCurrentTimestampISO()},
+        {"Options", {{"Stations", options.stations},
+                     {"Shuttles", options.shuttles},
+                     {"Cycles", options.cycles},
+                     {"ServiceTimeUs", options.service_time_us},
+                     {"Policy", options.policy},
+                     {"StormMessages", options.storm_messages},
+                     {"StormSubscribers", options.storm_subscribers},
+                     {"DispatchWorkers", options.dispatch_workers},
+                     {"ParallelTickWorkers", options.parallel_tick_workers},
+                     {"ValidationIterations", options.validation_iterations},
+                     {"StartingRuns", options.starting_runs}}},
+        {"Scenarios", json::object()}};
+
+    for (const auto &scenario : scenarios)
+    {
+        std::cerr << "Running scenario: " << scenario << std::endl;
+        auto start = Clock::now();
+        json result;
+        {
+            QuietStdout quiet(options.verbose);
+            if (scenario == "production")
+                result = productionScenario(options);
+            else if (scenario == "storm")
+                result = messageStormScenario(options);
+            else if (scenario == "validation")
+                result = schemaValidationScenario(options);
+            else if (scenario == "starting")
+                result = startingPhaseScenario(options);
+            else
+            {
+                std::cerr << "Unknown scenario: " << scenario << std::endl;
+                continue;
+            }
+        }
+        result["ScenarioMs"] = msSince(start);
+        report["Scenarios"][scenario] = std::move(result);
+    }
+
+    if (options.output == "-")
+    {
+        std::cout << report.dump(2) << std::endl;
+        return 0;
+    }
+
+    std::ofstream out(options.output);
+    if (!out)
+    {
+        std::cerr << "Cannot write " << options.output << std::endl;
+        return 1;
+    }
+    out << report.dump(2) << std::endl;
+    std::cerr << "Results written to " << options.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,550 @@
+#include "fake_broker.h"
+#include "utils.h"
+#include "logging/logger.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace
+{
+    enum PacketType : uint8_t
+    {
+        CONNECT = 1,
+        PUBLISH = 3,
+        PUBREL = 6,
+        SUBSCRIBE = 8,
+        UNSUBSCRIBE = 10,
+        PINGREQ = 12,
+        DISCONNECT = 14
+    };
+
+    // Bounds-checked reader over one packet body; any overrun clears ok
+    struct PacketReader
+    {
+        const std::string &body;
+        size_t pos = 0;
+        bool ok = true;
+
+        size_t remaining() const { return pos < body.size() ? body.size() - pos : 0; }
+
+        uint8_t u8()
+        {
+            if (remaining() < 1)
+            {
+                ok = false;
+                return 0;
+            }
+            return static_cast<uint8_t>(body[pos++]);
+        }
+
+        uint16_t u16()
+        {
+            uint16_t high = u8();
+            return static_cast<uint16_t>((high << 8) | u8());
+        }
+
+        uint32_t varint()
+        {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 28; shift += 7)
+            {
+                uint8_t byte = u8();
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            ok = false;
+            return 0;
+        }
+
+        std::string bytes(size_t n)
+        {
+            if (remaining() < n)
+            {
+                ok = false;
+                return "";
+            }
+            std::string out = body.substr(pos, n);
+            pos += n;
+            return out;
+        }
+
+        std::string str() { return bytes(u16()); }
+        std::string rest() { return bytes(remaining()); }
+    };
+
+    void appendVarint(std::string &out, uint32_t value)
+    {
+        do
+        {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            if (value > 0)
+            {
+                byte |= 0x80;
+            }
+            out.push_back(static_cast<char>(byte));
+        } while (value > 0);
+    }
+
+    void appendU16(std::string &out, uint16_t value)
+    {
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    void appendString(std::string &out, const std::string &value)
+    {
+        appendU16(out, static_cast<uint16_t>(value.size()));
+        out += value;
+    }
+
+    std::string packet(uint8_t header, const std::string &body)
+    {
+        std::string out(1, static_cast<char>(header));
+        appendVarint(out, static_cast<uint32_t>(body.size()));
+        out += body;
+        return out;
+    }
+
+    std::string ack(uint8_t header, uint16_t packet_id)
+    {
+        std::string body;
+        appendU16(body, packet_id);
+        return packet(header, body);
+    }
+}
+
+FakeMqttBroker::~FakeMqttBroker()
+{
+    stop();
+}
+
+uint16_t FakeMqttBroker::start()
+{
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+    {
+        BT_LOG_ERROR << "FakeMqttBroker: socket() failed";
+        return 0;
+    }
+
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 64) < 0)
+    {
+        BT_LOG_ERROR << "FakeMqttBroker: bind/listen failed";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return 0;
+    }
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    running_ = true;
+    accept_thread_ = std::thread(&FakeMqttBroker::acceptLoop, this);
+    return port_;
+}
+
+void FakeMqttBroker::stop()
+{
+    if (!running_.exchange(false))
+    {
+        return;
+    }
+
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (accept_thread_.joinable())
+    {
+        accept_thread_.join();
+    }
+
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions.swap(sessions_);
+    }
+    for (auto &session : sessions)
+    {
+        {
+            std::lock_guard<std::mutex> write_lock(session->write_mutex);
+            if (session->fd >= 0)
+            {
+                ::shutdown(session->fd, SHUT_RDWR);
+            }
+        }
+        if (session->reader.joinable())
+        {
+            session->reader.join();
+        }
+    }
+}
+
+std::string FakeMqttBroker::uri() const
+{
+    return "tcp://127.0.0.1:" + std::to_string(port_);
+}
+
+void FakeMqttBroker::publish(const std::string &topic, const std::string &payload, bool retain)
+{
+    route(topic, payload, "", retain);
+}
+
+void FakeMqttBroker::setPublishHook(PublishHook hook)
+{
+    auto shared_hook = hook ? std::make_shared<const PublishHook>(std::move(hook)) : nullptr;
+    std::lock_guard<std::mutex> lock(publish_hook_mutex_);
+    publish_hook_ = std::move(shared_hook);
+}
+
+FakeMqttBroker::Stats FakeMqttBroker::getStats() const
+{
+    Stats stats;
+    stats.connections = connections_.load();
+    stats.publishes_in = publishes_in_.load();
+    stats.publishes_out = publishes_out_.load();
+    stats.subscriptions = subscriptions_.load();
+    return stats;
+}
+
+void FakeMqttBroker::acceptLoop()
+{
+    while (running_)
+    {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (!running_)
+        {
+            ::close(fd);
+            break;
+        }
+
+        // Request/response round trips dominate what the benchmarks measure
+        int nodelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        auto session = std::make_shared<Session>();
+        session->fd = fd;
+        connections_++;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_.push_back(session);
+        session->reader = std::thread(&FakeMqttBroker::readLoop, this, session);
+    }
+}
+
+void FakeMqttBroker::readLoop(std::shared_ptr<Session> session)
+{
+    std::string rx;
+    std::vector<char> chunk(64 * 1024);
+    bool open = true;
+
+    while (open)
+    {
+        ssize_t n = ::recv(session->fd, chunk.data(), chunk.size(), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        rx.append(chunk.data(), static_cast<size_t>(n));
+
+        // Handle every complete packet in the buffer
+        size_t offset = 0;
+        while (open && rx.size() - offset >= 2)
+        {
+            uint32_t remaining_length = 0;
+            size_t length_bytes = 0;
+            bool complete = false;
+            for (; length_bytes < 4 && offset + 1 + length_bytes < rx.size(); ++length_bytes)
+            {
+                uint8_t byte = static_cast<uint8_t>(rx[offset + 1 + length_bytes]);
+                remaining_length |= static_cast<uint32_t>(byte & 0x7F) << (7 * length_bytes);
+                if ((byte & 0x80) == 0)
+                {
+                    complete = true;
+                    ++length_bytes;
+                    break;
+                }
+            }
+            if (!complete)
+            {
+                open = length_bytes < 4; // Five length bytes is a protocol error
+                break;
+            }
+
+            size_t total = 1 + length_bytes + remaining_length;
+            if (rx.size() - offset < total)
+            {
+                break;
+            }
+
+            uint8_t header = static_cast<uint8_t>(rx[offset]);
+            std::string body = rx.substr(offset + 1 + length_bytes, remaining_length);
+            offset += total;
+            open = handlePacket(session, header, body);
+        }
+        rx.erase(0, offset);
+    }
+
+    std::lock_guard<std::mutex> write_lock(session->write_mutex);
+    if (session->fd >= 0)
+    {
+        ::close(session->fd);
+        session->fd = -1;
+    }
+}
+
+bool FakeMqttBroker::handlePacket(const std::shared_ptr<Session> &session, uint8_t header, const std::string &body)
+{
+    PacketReader reader{body};
+
+    switch (header >> 4)
+    {
+    case CONNECT:
+    {
+        reader.str(); // "MQTT"
+        uint8_t level = reader.u8();
+        reader.u8();  // Connect flags; will, username and password are ignored
+        reader.u16(); // Keep alive
+        session->v5 = level == 5;
+        if (session->v5)
+        {
+            reader.bytes(reader.varint());
+        }
+        session->client_id = reader.str();
+        if (!reader.ok)
+        {
+            return false;
+        }
+        send(*session, session->v5 ? packet(0x20, std::string("\x00\x00\x00", 3))
+                                   : packet(0x20, std::string("\x00\x00", 2)));
+        return true;
+    }
+    case PUBLISH:
+    {
+        int qos = (header >> 1) & 0x03;
+        bool retain = header & 0x01;
+        std::string topic = reader.str();
+        uint16_t packet_id = qos > 0 ? reader.u16() : 0;
+        std::string properties = session->v5 ? reader.bytes(reader.varint()) : "";
+        std::string payload = reader.rest();
+        if (!reader.ok)
+        {
+            return false;
+        }
+
+        publishes_in_++;
+        if (qos == 1)
+        {
+            send(*session, ack(0x40, packet_id));
+        }
+        else if (qos == 2)
+        {
+            // Delivered on PUBLISH rather than PUBREL; the loopback link never retransmits
+            send(*session, ack(0x50, packet_id));
+        }
+
+        route(topic, payload, properties, retain);
+        std::shared_ptr<const PublishHook> hook;
+        {
+            std::lock_guard<std::mutex> lock(publish_hook_mutex_);
+            hook = publish_hook_;
+        }
+        if (hook)
+        {
+            (*hook)(topic, payload);
+        }
+        return true;
+    }
+    case PUBREL:
+        send(*session, ack(0x70, reader.u16()));
+        return reader.ok;
+    case SUBSCRIBE:
+    {
+        uint16_t packet_id = reader.u16();
+        if (session->v5)
+        {
+            reader.bytes(reader.varint());
+        }
+
+        std::vector<std::string> filters;
+        while (reader.ok && reader.remaining() > 0)
+        {
+            filters.push_back(reader.str());
+            reader.u8(); // Options; everything is granted at QoS 0
+        }
+        if (!reader.ok)
+        {
+            return false;
+        }
+
+        std::string suback;
+        appendU16(suback, packet_id);
+        if (session->v5)
+        {
+            suback.push_back('\0');
+        }
+        suback.append(filters.size(), '\0');
+
+        // Retained messages follow the SUBACK, as the client expects them after the grant
+        std::vector<std::string> retained_packets;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto &filter : filters)
+            {
+                if (std::find(session->filters.begin(), session->filters.end(), filter) == session->filters.end())
+                {
+                    session->filters.push_back(filter);
+                }
+                for (const auto &[topic, message] : retained_)
+                {
+                    if (mqtt_utils::topicMatches(filter, topic))
+                    {
+                        retained_packets.push_back(
+                            encodePublish(*session, topic, message.payload, message.properties, true));
+                    }
+                }
+            }
+        }
+        subscriptions_ += filters.size();
+
+        send(*session, packet(0x90, suback));
+        for (const auto &retained_packet : retained_packets)
+        {
+            send(*session, retained_packet);
+            publishes_out_++;
+        }
+        return true;
+    }
+    case UNSUBSCRIBE:
+    {
+        uint16_t packet_id = reader.u16();
+        if (session->v5)
+        {
+            reader.bytes(reader.varint());
+        }
+
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (reader.ok && reader.remaining() > 0)
+            {
+                std::string filter = reader.str();
+                session->filters.erase(std::remove(session->filters.begin(), session->filters.end(), filter),
+                                       session->filters.end());
+                count++;
+            }
+        }
+        if (!reader.ok)
+        {
+            return false;
+        }
+
+        std::string unsuback;
+        appendU16(unsuback, packet_id);
+        if (session->v5)
+        {
+            unsuback.push_back('\0');
+            unsuback.append(count, '\0');
+        }
+        send(*session, packet(0xB0, unsuback));
+        return true;
+    }
+    case PINGREQ:
+        send(*session, std::string("\xD0\x00", 2));
+        return true;
+    case DISCONNECT:
+        return false;
+    default:
+        // PUBACK/PUBREC/PUBCOMP never arrive since nothing goes out above QoS 0
+        return true;
+    }
+}
+
+void FakeMqttBroker::route(const std::string &topic, const std::string &payload, const std::string &properties,
+                           bool retain)
+{
+    std::vector<std::shared_ptr<Session>> targets;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (retain)
+        {
+            if (payload.empty())
+            {
+                retained_.erase(topic);
+            }
+            else
+            {
+                retained_[topic] = Retained{payload, properties};
+            }
+        }
+
+        for (const auto &session : sessions_)
+        {
+            for (const auto &filter : session->filters)
+            {
+                if (mqtt_utils::topicMatches(filter, topic))
+                {
+                    targets.push_back(session);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const auto &session : targets)
+    {
+        send(*session, encodePublish(*session, topic, payload, properties, false));
+        publishes_out_++;
+    }
+}
+
+void FakeMqttBroker::send(Session &session, const std::string &data)
+{
+    std::lock_guard<std::mutex> write_lock(session.write_mutex);
+    size_t sent = 0;
+    while (session.fd >= 0 && sent < data.size())
+    {
+        ssize_t n = ::send(session.fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string FakeMqttBroker::encodePublish(const Session &session, const std::string &topic,
+                                          const std::string &payload, const std::string &properties,
+                                          bool retain) const
+{
+    std::string body;
+    appendString(body, topic);
+    if (session.v5)
+    {
+        appendVarint(body, static_cast<uint32_t>(properties.size()));
+        body += properties;
+    }
+    body += payload;
+    return packet(static_cast<uint8_t>(0x30 | (retain ? 0x01 : 0x00)), body);
+}
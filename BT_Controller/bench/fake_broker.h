@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Minimal in-process MQTT broker for benchmarks
+ *
+ * Listens on 127.0.0.1 with an ephemeral port so the real MqttClient (and with it
+ * Paho's networking, threading and callback path) can be measured without an
+ * external broker. Supports MQTT 3.1.1 and 5: CONNECT, SUBSCRIBE/UNSUBSCRIBE with
+ * wildcards, PUBLISH at QoS 0-2 inbound, retained messages and PINGREQ. Everything is
+ * delivered to subscribers at QoS 0 with the publisher's MQTT 5 properties; sessions
+ * are not persisted.
+ */
+class FakeMqttBroker
+{
+public:
+    // Called for every PUBLISH received from a client, on that client's reader thread
+    using PublishHook = std::function<void(const std::string &topic, const std::string &payload)>;
+
+    struct Stats
+    {
+        uint64_t connections = 0;
+        uint64_t publishes_in = 0;
+        uint64_t publishes_out = 0;
+        uint64_t subscriptions = 0;
+    };
+
+    FakeMqttBroker() = default;
+    ~FakeMqttBroker();
+
+    FakeMqttBroker(const FakeMqttBroker &) = delete;
+    FakeMqttBroker &operator=(const FakeMqttBroker &) = delete;
+
+    /// @brief Start listening; returns the port, 0 on failure
+    uint16_t start();
+    void stop();
+
+    /// @brief "tcp://127.0.0.1:<port>" once started
+    std::string uri() const;
+
+    /// @brief Install or clear (nullptr) the hook; safe while clients are connected
+    void setPublishHook(PublishHook hook);
+
+    /// @brief Publish from inside the broker, e.g. on behalf of a simulated station
+    void publish(const std::string &topic, const std::string &payload, bool retain = false);
+
+    Stats getStats() const;
+
+private:
+    struct Session
+    {
+        int fd = -1;
+        bool v5 = true;
+        std::string client_id;
+        std::mutex write_mutex;
+        std::vector<std::string> filters; // Guarded by the broker mutex
+        std::thread reader;
+    };
+
+    struct Retained
+    {
+        std::string payload;
+        std::string properties; // Encoded MQTT 5 property block without its length
+    };
+
+    void acceptLoop();
+    void readLoop(std::shared_ptr<Session> session);
+
+    // Returns false when the connection should be closed
+    bool handlePacket(const std::shared_ptr<Session> &session, uint8_t header, const std::string &body);
+
+    void route(const std::string &topic, const std::string &payload, const std::string &properties, bool retain);
+    void send(Session &session, const std::string &packet);
+    std::string encodePublish(const Session &session, const std::string &topic, const std::string &payload,
+                              const std::string &properties, bool retain) const;
+
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+    // Swapped under its own mutex; std::atomic<std::shared_ptr> needs libstdc++ 12
+    mutable std::mutex publish_hook_mutex_;
+    std::shared_ptr<const PublishHook> publish_hook_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Session>> sessions_;
+    std::map<std::string, Retained> retained_;
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> publishes_in_{0};
+    std::atomic<uint64_t> publishes_out_{0};
+    std::atomic<uint64_t> subscriptions_{0};
+};
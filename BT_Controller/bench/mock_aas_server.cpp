@@ -0,0 +1,368 @@
+#include "mock_aas_server.h"
+#include "logging/logger.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+
+namespace
+{
+    const char *const kSubmodelIdBase = "https://smartproductionlab.aau.dk/submodels/instances/";
+
+    std::string replaceAll(std::string text, const std::string &from, const std::string &to)
+    {
+        size_t pos = 0;
+        while ((pos = text.find(from, pos)) != std::string::npos)
+        {
+            text.replace(pos, from.size(), to);
+            pos += to.size();
+        }
+        return text;
+    }
+
+    bool sendAll(int fd, const std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+MockAasServer::MockAasServer(std::string schema_dir)
+    : schema_dir_(std::move(schema_dir))
+{
+}
+
+MockAasServer::~MockAasServer()
+{
+    stop();
+}
+
+uint16_t MockAasServer::start()
+{
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+    {
+        BT_LOG_ERROR << "MockAasServer: socket() failed";
+        return 0;
+    }
+
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 64) < 0)
+    {
+        BT_LOG_ERROR << "MockAasServer: bind/listen failed";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return 0;
+    }
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    running_ = true;
+    accept_thread_ = std::thread(&MockAasServer::acceptLoop, this);
+    return port_;
+}
+
+void MockAasServer::stop()
+{
+    if (!running_.exchange(false))
+    {
+        return;
+    }
+
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (accept_thread_.joinable())
+    {
+        accept_thread_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (auto &[fd, thread] : connections_)
+    {
+        ::shutdown(fd, SHUT_RDWR);
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+        ::close(fd);
+    }
+    connections_.clear();
+}
+
+std::string MockAasServer::url() const
+{
+    return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+std::string MockAasServer::addShell(const YAML::Node &shell, const std::string &id_suffix,
+                                    const std::string &base_topic)
+{
+    std::string id_short = shell["idShort"].as<std::string>() + id_suffix;
+    std::string shell_id = shell["id"].as<std::string>() + id_suffix;
+    std::string interface_submodel_id = kSubmodelIdBase + id_short + "/AssetInterfacesDescription";
+
+    json shell_json = {
+        {"modelType", "AssetAdministrationShell"},
+        {"idShort", id_short},
+        {"id", shell_id},
+        {"submodels", json::array()}};
+    if (shell["globalAssetId"])
+    {
+        shell_json["assetInformation"] = {{"assetKind", "Instance"},
+                                          {"globalAssetId", shell["globalAssetId"].as<std::string>() + id_suffix}};
+    }
+
+    std::map<std::string, std::string> documents;
+    for (const auto &entry : shell)
+    {
+        // Scalars describe the shell itself; maps (and empty entries) are submodels
+        if (entry.second.IsScalar())
+        {
+            continue;
+        }
+
+        std::string submodel_short = entry.first.as<std::string>();
+        std::string submodel_id = kSubmodelIdBase + id_short + "/" + submodel_short;
+        json submodel = {
+            {"modelType", "Submodel"},
+            {"idShort", submodel_short},
+            {"id", submodel_id},
+            {"submodelElements", convertElements(entry.second, interface_submodel_id, base_topic, false)}};
+
+        shell_json["submodels"].push_back(
+            {{"type", "ModelReference"}, {"keys", json::array({{{"type", "Submodel"}, {"value", submodel_id}}})}});
+        documents["/submodels/" + base64url(submodel_id)] = submodel.dump();
+    }
+    documents["/shells/" + base64url(shell_id)] = shell_json.dump();
+
+    json descriptor = {
+        {"idShort", id_short},
+        {"id", shell_id},
+        {"endpoints", json::array({{{"interface", "AAS-3.0"},
+                                    {"protocolInformation", {{"href", url() + "/shells/" + base64url(shell_id)}}}}})}};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    documents_.merge(documents);
+    shell_descriptors_.push_back(std::move(descriptor));
+    return shell_id;
+}
+
+json MockAasServer::convertElements(const YAML::Node &map, const std::string &interface_submodel_id,
+                                    const std::string &base_topic, bool in_endpoint_metadata) const
+{
+    json elements = json::array();
+    if (!map.IsMap())
+    {
+        return elements;
+    }
+
+    for (const auto &entry : map)
+    {
+        std::string key = entry.first.as<std::string>();
+        const YAML::Node &value = entry.second;
+
+        if (value.IsMap() || value.IsNull())
+        {
+            elements.push_back({{"modelType", "SubmodelElementCollection"},
+                                {"idShort", key},
+                                {"value", convertElements(value, interface_submodel_id, base_topic,
+                                                          key == "EndpointMetadata")}});
+        }
+        else if (value.IsSequence())
+        {
+            json items = json::array();
+            for (const auto &item : value)
+            {
+                items.push_back({{"modelType", "Property"}, {"valueType", "xs:string"},
+                                 {"value", item.IsScalar() ? item.as<std::string>() : ""}});
+            }
+            elements.push_back({{"modelType", "SubmodelElementList"}, {"idShort", key}, {"value", items}});
+        }
+        else if (key == "input" || key == "output")
+        {
+            elements.push_back({{"modelType", "File"},
+                                {"idShort", key},
+                                {"contentType", "application/schema+json"},
+                                {"value", rewriteSchemaUrl(value.as<std::string>())}});
+        }
+        else if (key == "InterfaceReference")
+        {
+            // Path to the interaction inside InterfaceMQTT; readers take the last key
+            json keys = json::array({{{"type", "Submodel"}, {"value", interface_submodel_id}},
+                                     {{"type", "SubmodelElementCollection"}, {"value", "InterfaceMQTT"}},
+                                     {{"type", "SubmodelElementCollection"}, {"value", value.as<std::string>()}}});
+            elements.push_back({{"modelType", "ReferenceElement"},
+                                {"idShort", key},
+                                {"value", {{"type", "ModelReference"}, {"keys", keys}}}});
+        }
+        else
+        {
+            std::string text = value.as<std::string>();
+            if (in_endpoint_metadata && key == "base" && !base_topic.empty())
+            {
+                text = "mqtt://127.0.0.1/" + base_topic;
+            }
+            elements.push_back({{"modelType", "Property"}, {"idShort", key}, {"valueType", "xs:string"}, {"value", text}});
+        }
+    }
+    return elements;
+}
+
+std::string MockAasServer::rewriteSchemaUrl(const std::string &value) const
+{
+    return replaceAll(value, kPublishedSchemaPrefix, url() + "/MQTTSchemas/");
+}
+
+bool MockAasServer::lookup(const std::string &path, std::string &body)
+{
+    if (path == "/shell-descriptors")
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body = json{{"result", shell_descriptors_}}.dump();
+        return true;
+    }
+
+    const std::string schema_path = "/MQTTSchemas/";
+    if (path.rfind(schema_path, 0) == 0)
+    {
+        std::string file = path.substr(schema_path.size());
+        if (file.empty() || file.find("..") != std::string::npos || file.find('/') != std::string::npos)
+        {
+            return false;
+        }
+        std::ifstream in(schema_dir_ + "/" + file);
+        if (!in)
+        {
+            return false;
+        }
+        std::stringstream content;
+        content << in.rdbuf();
+        body = rewriteSchemaUrl(content.str());
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = documents_.find(path);
+    if (it == documents_.end())
+    {
+        return false;
+    }
+    body = it->second;
+    return true;
+}
+
+void MockAasServer::acceptLoop()
+{
+    while (running_)
+    {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (!running_)
+        {
+            ::close(fd);
+            break;
+        }
+
+        int nodelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.emplace_back(fd, std::thread(&MockAasServer::serveConnection, this, fd));
+    }
+}
+
+void MockAasServer::serveConnection(int fd)
+{
+    std::string rx;
+    char chunk[8192];
+
+    while (true)
+    {
+        size_t header_end;
+        while ((header_end = rx.find("\r\n\r\n")) == std::string::npos)
+        {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+            {
+                return;
+            }
+            rx.append(chunk, static_cast<size_t>(n));
+        }
+
+        // Only bodiless GETs are served, so the request ends with its headers
+        std::string request_line = rx.substr(0, rx.find("\r\n"));
+        rx.erase(0, header_end + 4);
+        request_count_++;
+
+        std::istringstream line(request_line);
+        std::string method, target;
+        line >> method >> target;
+        target = target.substr(0, target.find('?'));
+
+        std::string body;
+        bool found = method == "GET" && lookup(target, body);
+        std::string response = found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n";
+        response += "Content-Type: application/json\r\n";
+        response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        response += "Connection: keep-alive\r\n\r\n";
+        response += body;
+        if (!sendAll(fd, response))
+        {
+            return;
+        }
+    }
+}
+
+std::string MockAasServer::base64url(const std::string &input)
+{
+    static const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    std::string out;
+    out.reserve((input.size() + 2) / 3 * 4);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (unsigned char c : input)
+    {
+        buffer = (buffer << 8) | c;
+        bits += 8;
+        while (bits >= 6)
+        {
+            bits -= 6;
+            out.push_back(alphabet[(buffer >> bits) & 0x3F]);
+        }
+    }
+    if (bits > 0)
+    {
+        out.push_back(alphabet[(buffer << (6 - bits)) & 0x3F]);
+    }
+    return out;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <yaml-cpp/yaml.h>
+
+/**
+ * @brief Minimal AAS repository and registry serving the AASDescriptions fixtures
+ *
+ * Converts the YAML shell descriptions into the JSON the AASClient reads (shells,
+ * submodels and /shell-descriptors) and serves the repository's MQTTSchemas with
+ * their GitHub Pages URLs pointing back at this server, so a STARTING phase runs
+ * without network access. A fixture shell can be cloned any number of times under
+ * a new id and base topic to build lines of arbitrary size.
+ *
+ * Plain HTTP/1.1 with keep-alive on 127.0.0.1, one thread per connection.
+ */
+class MockAasServer
+{
+public:
+    // Public location of the schemas referenced by the fixtures
+    static constexpr const char *kPublishedSchemaPrefix = "https://aausmartproductionlab.github.io/AP2030-UNS/MQTTSchemas/";
+
+    explicit MockAasServer(std::string schema_dir);
+    ~MockAasServer();
+
+    MockAasServer(const MockAasServer &) = delete;
+    MockAasServer &operator=(const MockAasServer &) = delete;
+
+    /// @brief Start listening; returns the port, 0 on failure. Must precede addShell.
+    uint16_t start();
+    void stop();
+
+    /// @brief "http://127.0.0.1:<port>"
+    std::string url() const;
+
+    /**
+     * @brief Add a shell from a fixture file's top-level entry
+     * @param shell The YAML node of one shell (e.g. root["imaDispensingSystemAAS"])
+     * @param id_suffix Appended to idShort and id; empty keeps the fixture's id
+     * @param base_topic Replaces the path of EndpointMetadata/base; empty keeps it
+     * @return The shell id to use as asset id
+     */
+    std::string addShell(const YAML::Node &shell, const std::string &id_suffix = "",
+                         const std::string &base_topic = "");
+
+    uint64_t requestCount() const { return request_count_.load(); }
+
+private:
+    void acceptLoop();
+    void serveConnection(int fd);
+    bool lookup(const std::string &path, std::string &body);
+
+    nlohmann::json convertElements(const YAML::Node &map, const std::string &interface_submodel_id,
+                                   const std::string &base_topic, bool in_endpoint_metadata) const;
+    std::string rewriteSchemaUrl(const std::string &value) const;
+
+    static std::string base64url(const std::string &input);
+
+    std::string schema_dir_;
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+    std::mutex connections_mutex_;
+    std::vector<std::pair<int, std::thread>> connections_;
+    std::atomic<uint64_t> request_count_{0};
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::string> documents_; // Request path -> JSON body
+    nlohmann::json shell_descriptors_ = nlohmann::json::array();
+};
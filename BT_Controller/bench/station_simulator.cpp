@@ -0,0 +1,200 @@
+#include "station_simulator.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+StationSimulator::StationSimulator(FakeMqttBroker &broker, std::chrono::microseconds service_time)
+    : broker_(broker),
+      service_time_(service_time)
+{
+}
+
+StationSimulator::~StationSimulator()
+{
+    stop();
+}
+
+void StationSimulator::addStation(const std::string &base_topic)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stations_[base_topic];
+}
+
+void StationSimulator::start()
+{
+    std::vector<Outgoing> out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[base, station] : stations_)
+        {
+            stateMessage(out, base, station);
+        }
+    }
+    flush(out);
+
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        stopping_ = false;
+    }
+    timer_thread_ = std::thread(&StationSimulator::timerLoop, this);
+    broker_.setPublishHook([this](const std::string &topic, const std::string &payload)
+                           { onPublish(topic, payload); });
+}
+
+void StationSimulator::stop()
+{
+    broker_.setPublishHook(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        stopping_ = true;
+    }
+    timer_cv_.notify_all();
+    if (timer_thread_.joinable())
+    {
+        timer_thread_.join();
+    }
+}
+
+void StationSimulator::onPublish(const std::string &topic, const std::string &payload)
+{
+    size_t cmd_pos = topic.rfind("/CMD/");
+    if (cmd_pos == std::string::npos)
+    {
+        return;
+    }
+    std::string base = topic.substr(0, cmd_pos);
+    std::string command = topic.substr(cmd_pos + 5);
+
+    std::string uuid;
+    try
+    {
+        json message = json::parse(payload);
+        uuid = message.at("Uuid").get<std::string>();
+    }
+    catch (const std::exception &)
+    {
+        return;
+    }
+
+    std::vector<Outgoing> out;
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stations_.find(base);
+        if (it == stations_.end())
+        {
+            return;
+        }
+        Station &station = it->second;
+        commands_handled_++;
+
+        if (command == "Occupy")
+        {
+            if (std::find(station.queue.begin(), station.queue.end(), uuid) == station.queue.end())
+            {
+                station.queue.push_back(uuid);
+                stateMessage(out, base, station);
+            }
+            respond(out, base, command, uuid, station.queue.front() == uuid ? "SUCCESS" : "RUNNING");
+        }
+        else if (command == "Release")
+        {
+            bool was_head = !station.queue.empty() && station.queue.front() == uuid;
+            station.queue.erase(std::remove(station.queue.begin(), station.queue.end(), uuid), station.queue.end());
+            respond(out, base, command, uuid, "SUCCESS");
+            if (was_head && !station.queue.empty())
+            {
+                respond(out, base, "Occupy", station.queue.front(), "SUCCESS");
+            }
+            stateMessage(out, base, station);
+        }
+        else if (!station.processing && !station.queue.empty() && station.queue.front() == uuid)
+        {
+            station.processing = true;
+            respond(out, base, command, uuid, "RUNNING");
+            stateMessage(out, base, station);
+            schedule = true;
+        }
+        else
+        {
+            respond(out, base, command, uuid, "FAILURE");
+        }
+    }
+    flush(out);
+
+    if (schedule)
+    {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex_);
+            timers_.push({std::chrono::steady_clock::now() + service_time_,
+                          [this, base, command, uuid]()
+                          { finishCommand(base, command, uuid); }});
+        }
+        timer_cv_.notify_one();
+    }
+}
+
+void StationSimulator::finishCommand(const std::string &base, const std::string &command, const std::string &uuid)
+{
+    std::vector<Outgoing> out;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Station &station = stations_[base];
+        station.processing = false;
+        respond(out, base, command, uuid, "SUCCESS");
+        stateMessage(out, base, station);
+    }
+    flush(out);
+}
+
+void StationSimulator::respond(std::vector<Outgoing> &out, const std::string &base, const std::string &command,
+                               const std::string &uuid, const char *state) const
+{
+    json message = {{"TimeStamp", bt_utils::getCurrentTimestampISO()}, {"Uuid", uuid}, {"State", state}};
+    out.push_back({base + "/DATA/" + command, message.dump(), false});
+}
+
+void StationSimulator::stateMessage(std::vector<Outgoing> &out, const std::string &base, const Station &station) const
+{
+    json message = {{"TimeStamp", bt_utils::getCurrentTimestampISO()},
+                    {"State", station.processing ? "EXECUTE" : "IDLE"},
+                    {"ProcessQueue", station.queue},
+                    {"QueueDepth", station.queue.size()}};
+    out.push_back({base + "/DATA/State", message.dump(), true});
+}
+
+void StationSimulator::flush(const std::vector<Outgoing> &out)
+{
+    for (const auto &message : out)
+    {
+        broker_.publish(message.topic, message.payload, message.retain);
+    }
+}
+
+void StationSimulator::timerLoop()
+{
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    while (!stopping_)
+    {
+        if (timers_.empty())
+        {
+            timer_cv_.wait(lock);
+            continue;
+        }
+        auto due = timers_.top().due;
+        if (std::chrono::steady_clock::now() < due)
+        {
+            timer_cv_.wait_until(lock, due);
+            continue;
+        }
+
+        Timer timer = timers_.top();
+        timers_.pop();
+        lock.unlock();
+        timer.action();
+        lock.lock();
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "fake_broker.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Simulated PackML stations answering the controller through a FakeMqttBroker
+ *
+ * Follows the station firmware's occupation protocol on <base>/CMD/<Command>:
+ *   - Occupy queues the UUID and answers RUNNING, or SUCCESS once it is at the head
+ *   - Release removes the UUID, answers SUCCESS and grants the next occupant
+ *   - any other command runs for the service time if its UUID holds the station,
+ *     answering RUNNING and then SUCCESS, and FAILURE otherwise
+ * Each station keeps a retained <base>/DATA/State with ProcessQueue and QueueDepth.
+ */
+class StationSimulator
+{
+public:
+    StationSimulator(FakeMqttBroker &broker, std::chrono::microseconds service_time);
+    ~StationSimulator();
+
+    void addStation(const std::string &base_topic);
+
+    /// @brief Publish the initial states and start handling commands
+    void start();
+    void stop();
+
+    uint64_t commandsHandled() const { return commands_handled_.load(); }
+
+private:
+    struct Station
+    {
+        std::deque<std::string> queue; // Occupants, head holds the station
+        bool processing = false;
+    };
+
+    struct Outgoing
+    {
+        std::string topic;
+        std::string payload;
+        bool retain;
+    };
+
+    struct Timer
+    {
+        std::chrono::steady_clock::time_point due;
+        std::function<void()> action;
+        bool operator>(const Timer &other) const { return due > other.due; }
+    };
+
+    void onPublish(const std::string &topic, const std::string &payload);
+    void finishCommand(const std::string &base, const std::string &command, const std::string &uuid);
+
+    // Callers hold mutex_; messages are collected and published after unlocking
+    void respond(std::vector<Outgoing> &out, const std::string &base, const std::string &command,
+                 const std::string &uuid, const char *state) const;
+    void stateMessage(std::vector<Outgoing> &out, const std::string &base, const Station &station) const;
+    void flush(const std::vector<Outgoing> &out);
+
+    void timerLoop();
+
+    FakeMqttBroker &broker_;
+    std::chrono::microseconds service_time_;
+    std::atomic<uint64_t> commands_handled_{0};
+
+    std::mutex mutex_;
+    std::map<std::string, Station> stations_; // Base topic -> station
+
+    std::mutex timer_mutex_;
+    std::condition_variable timer_cv_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    bool stopping_ = false;
+    std::thread timer_thread_;
+};
@@ -0,0 +1,100 @@
+// Microbenchmark: istringstream-based topic matching vs CompiledTopicPattern
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+namespace
+{
+    // Copy of the original mqtt_utils::topicMatches, kept as the baseline
+    bool legacyTopicMatches(const std::string &pattern, const std::string &topic)
+    {
+        std::istringstream patternStream(pattern);
+        std::istringstream topicStream(topic);
+        std::string patternSegment, topicSegment;
+
+        while (std::getline(patternStream, patternSegment, '/') &&
+               std::getline(topicStream, topicSegment, '/'))
+        {
+            if (patternSegment == "+" || topicSegment == "+")
+            {
+                continue;
+            }
+            else if (patternSegment == "#" || topicSegment == "#")
+            {
+                return true;
+            }
+            else if (patternSegment != topicSegment)
+            {
+                return false;
+            }
+        }
+
+        bool patternDone = !std::getline(patternStream, patternSegment, '/');
+        bool topicDone = !std::getline(topicStream, topicSegment, '/');
+
+        return patternDone && topicDone;
+    }
+
+    const std::vector<std::string> &patterns()
+    {
+        static const std::vector<std::string> p = {
+            "NN/Nybrovej/InnoLab/Dispensing/DATA/State",
+            "NN/Nybrovej/InnoLab/Stoppering/DATA/Occupy",
+            "NN/Nybrovej/InnoLab/+/DATA/State",
+            "NN/Nybrovej/InnoLab/Planar/Xbot1/DATA/#",
+            "NN/Nybrovej/InnoLab/+/DATA/+",
+        };
+        return p;
+    }
+
+    const std::string kTopic = "NN/Nybrovej/InnoLab/Stoppering/DATA/State";
+}
+
+static void BM_LegacyTopicMatches(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        for (const auto &p : patterns())
+        {
+            benchmark::DoNotOptimize(legacyTopicMatches(p, kTopic));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * patterns().size());
+}
+BENCHMARK(BM_LegacyTopicMatches);
+
+static void BM_TopicMatchesStringView(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        for (const auto &p : patterns())
+        {
+            benchmark::DoNotOptimize(mqtt_utils::topicMatches(p, kTopic));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * patterns().size());
+}
+BENCHMARK(BM_TopicMatchesStringView);
+
+static void BM_CompiledTopicPattern(benchmark::State &state)
+{
+    std::vector<mqtt_utils::CompiledTopicPattern> compiled;
+    for (const auto &p : patterns())
+    {
+        compiled.emplace_back(p);
+    }
+
+    for (auto _ : state)
+    {
+        for (const auto &c : compiled)
+        {
+            benchmark::DoNotOptimize(c.matches(kTopic));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * compiled.size());
+}
+BENCHMARK(BM_CompiledTopicPattern);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,296 @@
+// Replays recorded UNS traffic (metrics.traffic_record_path, or an imported NDJSON capture
+// such as production_run_backup) through the controller's distributor and reports throughput
+#include "fake_broker.h"
+
+#include "metrics/latency_metrics.h"
+#include "mqtt/mqtt_client.h"
+#include "mqtt/mqtt_sub_base.h"
+#include "mqtt/node_message_distributor.h"
+#include "mqtt/traffic_log.h"
+#include "utils.h"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct ReplayOptions
+    {
+        double speed = 0.0; // 0 = max
+        int dispatch_workers = 4;
+        size_t subscribers_per_topic = 1;
+        bool validate = false;
+        std::string schema;
+        std::string output = "-";
+    };
+
+    /// @brief Stands in for the nodes listening on a recorded topic; counts deliveries
+    class ReplaySubscriber : public MqttSubBase
+    {
+    public:
+        ReplaySubscriber(MqttClient &mqtt_client, const mqtt_utils::Topic &topic)
+            : MqttSubBase(mqtt_client)
+        {
+            setTopic("output", topic);
+        }
+
+        void callback(const std::string &, const nlohmann::json &, mqtt::properties) override
+        {
+            received_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::string getBTNodeName() const override { return "ReplaySubscriber"; }
+
+        uint64_t received() const { return received_.load(); }
+
+    private:
+        std::atomic<uint64_t> received_{0};
+    };
+
+    int importCapture(const std::string &ndjson_path, const std::string &log_path)
+    {
+        TrafficRecorder recorder;
+        if (!recorder.open(log_path))
+        {
+            return 1;
+        }
+        long written = importNdjsonCapture(ndjson_path, recorder);
+        if (written < 0)
+        {
+            return 1;
+        }
+        std::cerr << "Imported " << written << " messages into " << log_path << std::endl;
+        return 0;
+    }
+
+    int replay(const std::string &log_path, const ReplayOptions &options)
+    {
+        TrafficLog log;
+        if (!log.open(log_path))
+        {
+            return 1;
+        }
+        if (log.empty())
+        {
+            std::cerr << log_path << " holds no messages" << std::endl;
+            return 1;
+        }
+
+        FakeMqttBroker broker;
+        if (broker.start() == 0)
+        {
+            std::cerr << "Could not start the in-process broker" << std::endl;
+            return 1;
+        }
+        auto conn_opts = mqtt::connect_options_builder::v5()
+                             .clean_start(true)
+                             .finalize();
+        auto mqtt = std::make_unique<MqttClient>(broker.uri(), "traffic_replay", conn_opts, 5);
+        if (!mqtt->is_connected())
+        {
+            std::cerr << "Could not connect to the in-process broker at " << broker.uri() << std::endl;
+            return 1;
+        }
+        auto distributor = std::make_unique<NodeMessageDistributor>(
+            *mqtt, static_cast<size_t>(std::max(options.dispatch_workers, 0)));
+        MqttSubBase::setNodeMessageDistributor(distributor.get());
+
+        json schema;
+        if (options.validate && !options.schema.empty())
+        {
+            schema = mqtt_utils::load_schema(options.schema);
+        }
+        mqtt_utils::ValidationConfig validation;
+        validation.default_policy = options.validate ? mqtt_utils::ValidationPolicy::Always
+                                                     : mqtt_utils::ValidationPolicy::Off;
+        mqtt_utils::setValidationConfig(validation);
+
+        // The recorded topics, each with the node count a tree would put on it
+        std::set<std::string> topics;
+        for (const auto &record : log.records())
+        {
+            topics.emplace(record.topic);
+        }
+        std::vector<std::unique_ptr<ReplaySubscriber>> subscribers;
+        for (const auto &topic : topics)
+        {
+            for (size_t i = 0; i < std::max<size_t>(options.subscribers_per_topic, 1); ++i)
+            {
+                subscribers.push_back(std::make_unique<ReplaySubscriber>(*mqtt, mqtt_utils::Topic(topic, schema)));
+                distributor->registerLateInitializingNode(subscribers.back().get());
+            }
+        }
+        LatencyMetrics::instance().toJson(true); // Drop what the setup recorded
+
+        auto totalReceived = [&subscribers]()
+        {
+            uint64_t total = 0;
+            for (const auto &subscriber : subscribers)
+            {
+                total += subscriber->received();
+            }
+            return total;
+        };
+        uint64_t base = totalReceived();
+
+        TrafficReplayer replayer(log, *distributor);
+        TrafficReplayer::Result result = replayer.run(options.speed);
+
+        // Let the workers drain, or give up once nothing arrives for a second
+        uint64_t expected = result.messages * std::max<size_t>(options.subscribers_per_topic, 1);
+        auto start_drain = Clock::now();
+        uint64_t last = totalReceived() - base;
+        auto last_progress = Clock::now();
+        while (last < expected && Clock::now() - last_progress < std::chrono::seconds(1))
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            uint64_t now = totalReceived() - base;
+            if (now != last)
+            {
+                last = now;
+                last_progress = Clock::now();
+            }
+        }
+        double total_ms = result.elapsed_ms + std::chrono::duration<double, std::milli>(Clock::now() - start_drain).count();
+
+        auto stats = distributor->getDispatchStats();
+        json report = {
+            {"Benchmark", "traffic_replay"},
+            {"TimeStamp", bt_utils::getCurrentTimestampISO()},
+            {"Log", log_path},
+            {"Options", {{"Speed", options.speed},
+                         {"DispatchWorkers", options.dispatch_workers},
+                         {"SubscribersPerTopic", options.subscribers_per_topic},
+                         {"Validate", options.validate}}},
+            {"Topics", topics.size()},
+            {"Messages", result.messages},
+            {"DecodeErrors", result.decode_errors},
+            {"Deliveries", last},
+            {"ExpectedDeliveries", expected},
+            {"RecordedMs", result.recorded_ms},
+            {"HandOffMs", result.elapsed_ms},
+            {"ElapsedMs", total_ms},
+            {"MessagesPerSecond", total_ms > 0 ? result.messages * 1000.0 / total_ms : 0.0},
+            {"Dispatch", {{"Workers", stats.workers},
+                          {"MaxQueueDepth", stats.max_queue_depth},
+                          {"Dropped", stats.dropped}}},
+            {"Latency", LatencyMetrics::instance().toJson(true)}};
+
+        for (auto &subscriber : subscribers)
+        {
+            distributor->unregisterInstance(subscriber.get());
+        }
+        MqttSubBase::setNodeMessageDistributor(nullptr);
+        distributor.reset();
+        subscribers.clear();
+        mqtt.reset();
+        broker.stop();
+
+        if (options.output == "-")
+        {
+            std::cout << report.dump(2) << std::endl;
+            return 0;
+        }
+        std::ofstream out(options.output);
+        if (!out)
+        {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+        out << report.dump(2) << std::endl;
+        std::cerr << "Results written to " << options.output << std::endl;
+        return 0;
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " import CAPTURE.ndjson OUT.log\n"
+                  << "       " << program << " replay LOG [options]\n"
+                  << "  --speed X                1 = recorded pace, N = N times faster, max (default)\n"
+                  << "  --dispatch-workers N     Distributor workers, 0 = synchronous (default 4)\n"
+                  << "  --subscribers-per-topic N  Nodes listening on each recorded topic (default 1)\n"
+                  << "  --validate SCHEMA        Validate every message against this schema file\n"
+                  << "  --output PATH            JSON results (default - for stdout)\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "import")
+    {
+        if (argc != 4)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return importCapture(argv[2], argv[3]);
+    }
+    if (command != "replay")
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ReplayOptions options;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--speed")
+            {
+                std::string value = next();
+                options.speed = value == "max" ? 0.0 : std::stod(value);
+            }
+            else if (arg == "--dispatch-workers")
+                options.dispatch_workers = std::stoi(next());
+            else if (arg == "--subscribers-per-topic")
+                options.subscribers_per_topic = std::stoul(next());
+            else if (arg == "--validate")
+            {
+                options.validate = true;
+                options.schema = next();
+            }
+            else if (arg == "--output")
+                options.output = next();
+            else
+            {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Invalid argument " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    return replay(argv[2], options);
+}
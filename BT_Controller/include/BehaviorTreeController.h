@@ -4,41 +4,43 @@
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <set>
+#include <future>
 #include "mqtt/mqtt_client.h"
 #include "mqtt/node_message_distributor.h"
 #include "aas/aas_client.h"
 #include "aas/aas_interface_cache.h"
+#include "bt/tree_template_cache.h"
 
 #include <behaviortree_cpp/bt_factory.h>
 #include <behaviortree_cpp/basic_types.h>
 #include "utils.h"
 
 class BehaviorTreeController;
+class LatencyHistogram;
+class StatePublisher;
+class CommandDeadlines;
+class MoveBatcher;
 extern BehaviorTreeController *g_controller_instance;
 void signalHandler(int signum);
 
-namespace BT
-{
-    class Groot2Publisher;
-}
+class Groot2Monitor;
 
-struct BtControllerParameters
+// Config file settings plus the topics derived from them at startup
+struct BtControllerParameters : bt_utils::ControllerConfig
 {
     std::string configFile = "../config/controller_config.yaml";
-    bool generate_xml_models = false;
-    std::string serverURI;
-    std::string clientId;
-    std::string unsTopicPrefix;
-    std::string aasServerUrl;
-    std::string aasRegistryUrl;
-    int groot2_port;
-    std::string bt_description_path;
-    std::string bt_nodes_path;
     std::string start_topic;
     std::string stop_topic;
     std::string suspend_topic;
     std::string unsuspend_topic;
     std::string reset_topic;
+    std::string command_prefix;       // <uns>/<client_id>/CMD/
+    std::string group_command_prefix; // <uns>/<shared_group>/CMD/, empty without a group
     
     // Response topics for command acknowledgments
     std::string start_response_topic;
@@ -48,13 +50,59 @@ struct BtControllerParameters
     std::string reset_response_topic;
     
     mqtt_utils::Topic state_publication_config;
+    std::string metrics_topic;
 
     // Registration Service Configuration
-    std::string registration_config_path;      // Path to orchestrator's AAS description YAML
-    std::string registration_topic_pattern;    // MQTT topic pattern for registration
     std::string registration_topic;            // Resolved registration topic
 };
 
+/**
+ * @brief One process AAS hosted by the controller: its tree and PackML state machine
+ *
+ * Executions share the controller's MQTT client, NodeMessageDistributor, node factory and
+ * AASInterfaceCache. With a single slot the execution uses the controller's own State and
+ * response topics; with more, slot N publishes under <uns_topic>/<client_id>/ProcessN/DATA.
+ */
+struct ProcessExecution
+{
+    size_t slot = 0;
+    std::string process_aas_id; // From the Start command, guarded by process_aas_id_mutex_
+    BT::Tree tree;
+    std::unique_ptr<Groot2Monitor> publisher;
+    LatencyHistogram *tick_latency = nullptr; // "tick" histogram of the current tree
+    BT::TreeNode *wake_root = nullptr;        // Root of tree while it is live, guarded by wake_mutex_
+
+    std::atomic<PackML::State> packml_state{PackML::State::STOPPED};
+    BT::NodeStatus bt_tick_status = BT::NodeStatus::IDLE;
+
+    // Equipment mapping: asset name -> AAS ID/URL, guarded by equipment_mapping_mutex_
+    std::map<std::string, std::string> equipment_aas_mapping;
+
+    // Commands set by the MQTT thread, consumed by the main loop
+    std::atomic<bool> start_flag{false};
+    std::atomic<bool> stop_flag{false};
+    std::atomic<bool> suspend_flag{false};
+    std::atomic<bool> unsuspend_flag{false};
+    std::atomic<bool> reset_flag{false};
+
+    // Pending command UUIDs for responses, guarded by pending_command_mutex_
+    std::string pending_start_uuid;
+    std::string pending_stop_uuid;
+    std::string pending_suspend_uuid;
+    std::string pending_unsuspend_uuid;
+    std::string pending_reset_uuid;
+
+    // Mapping the last tree was built from, kept across Reset for a warm Start (warm_restart)
+    std::map<std::string, std::string> previous_equipment_mapping;
+
+    mqtt_utils::Topic state_publication_config;
+    std::string start_response_topic;
+    std::string stop_response_topic;
+    std::string suspend_response_topic;
+    std::string unsuspend_response_topic;
+    std::string reset_response_topic;
+};
+
 class BehaviorTreeController
 {
 public:
@@ -67,73 +115,118 @@ public:
 
 private:
     BtControllerParameters app_params_;
+    std::unique_ptr<TrafficRecorder> traffic_recorder_; // Outlives mqtt_client_, which feeds it
     std::unique_ptr<MqttClient> mqtt_client_;
+    std::unique_ptr<StatePublisher> state_publisher_; // State and command responses, off the control thread
     std::unique_ptr<NodeMessageDistributor> node_message_distributor_;
-    std::function<void(const std::string &, const nlohmann::json &, mqtt::properties)> main_mqtt_message_handler_;
+    std::unique_ptr<CommandDeadlines> command_deadlines_; // Outlives the trees whose nodes arm it
+    MqttClient::MessageCallback main_mqtt_message_handler_;
 
     std::unique_ptr<AASClient> aas_client_;
     std::unique_ptr<AASInterfaceCache> aas_interface_cache_;
+    std::unique_ptr<MoveBatcher> move_batcher_; // Null unless move_batching names a planner asset
     std::unique_ptr<BT::BehaviorTreeFactory> bt_factory_;
-    BT::Tree bt_tree_;
-    std::unique_ptr<BT::Groot2Publisher> bt_publisher_;
-
-    std::atomic<bool> mqtt_start_bt_flag_;
-    std::atomic<bool> mqtt_suspend_bt_flag_;
-    std::atomic<bool> mqtt_unsuspend_bt_flag_;
-    std::atomic<bool> mqtt_reset_bt_flag_;
-    std::atomic<bool> shutdown_flag_;
+    TreeTemplateCache tree_templates_; // BT descriptions by URL, parsed against bt_factory_
+
+    // Fixed at construction (max_concurrent_processes), so other threads may iterate it
+    std::vector<std::unique_ptr<ProcessExecution>> executions_;
+
     std::atomic<bool> sigint_received_;
     std::atomic<bool> nodes_registered_;
 
-    // Process AAS ID received from Start command
-    std::string process_aas_id_;
-    std::mutex process_aas_id_mutex_;
+    // Event-driven main loop: commands and node callbacks wake the loop instead of
+    // it polling; max_idle_interval_ms bounds the wait as a safety net
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool wake_pending_ = false;
 
-    // Pending command UUIDs for responses
-    std::string pending_start_uuid_;
-    std::string pending_stop_uuid_;
-    std::string pending_suspend_uuid_;
-    std::string pending_unsuspend_uuid_;
-    std::string pending_reset_uuid_;
+    std::chrono::steady_clock::time_point last_metrics_publish_;
+
+    std::mutex process_aas_id_mutex_;
     std::mutex pending_command_mutex_;
+    std::mutex equipment_mapping_mutex_;
 
-    PackML::State current_packml_state_;
-    BT::NodeStatus current_bt_tick_status_;
+    // AAS change events (registration_response_topic): asset references waiting to be
+    // refetched, guarded by asset_change_mutex_, and the refetch running off the main loop
+    std::mutex asset_change_mutex_;
+    std::set<std::string> pending_asset_changes_;
+    std::future<std::vector<mqtt_utils::Topic>> asset_refresh_;
 
-    // Equipment mapping: asset name -> AAS ID/URL
-    std::map<std::string, std::string> equipment_aas_mapping_;
-    std::mutex equipment_mapping_mutex_;
+    // aas_snapshot_path: loaded once, on the first Start, then checked against the AAS
+    // off the main loop; assets found changed are queued as AAS change events
+    bool snapshot_loaded_ = false;
+    std::future<void> snapshot_revalidation_;
+
+    // Whether this instance is in the shared subscription for the group's Start topic
+    bool in_start_share_ = false;
 
     void setupMainMqttMessageHandler();
 
     void loadAppConfiguration(int argc, char *argv[]);
+    void createProcessExecutions();
     void initializeMqttControlInterface();
     bool handleGenerateXmlModelsOption();
 
-    void setStateAndPublish(PackML::State new_packml_state, std::optional<BT::NodeStatus> new_bt_tick_status_opt = std::nullopt);
-    void publishCurrentState();
+    void setStateAndPublish(ProcessExecution &execution, PackML::State new_packml_state,
+                            std::optional<BT::NodeStatus> new_bt_tick_status_opt = std::nullopt);
+    void publishCurrentState(const ProcessExecution &execution);
     void publishCommandResponse(const std::string& response_topic, const std::string& uuid, bool success);
-
-    void processBehaviorTreeStart();
-    void processStartingState();
-    void processBehaviorTreeUnsuspend();
-    void processResettingState();
-    void manageRunningBehaviorTree();
+    void publishMetricsIfDue();
+
+    // Command routing: the execution a Start goes to, and those a Stop/Suspend/Unsuspend/Reset
+    // addresses (the "Process" field selects one; without it every execution is addressed).
+    // Group commands always match on "Process", since other controllers may run it.
+    ProcessExecution *findStartableExecution();
+    std::vector<ProcessExecution *> findTargetExecutions(const nlohmann::json &payload, bool group_command = false);
+    // Join the group's shared Start subscription while a slot is IDLE, leave it otherwise,
+    // so the broker hands each group Start to a controller able to run it
+    void updateStartShare();
+    bool hasOtherLiveExecution(const ProcessExecution &execution) const;
+    std::string takePendingUuid(ProcessExecution &execution, std::string ProcessExecution::*pending);
+
+    void serviceExecutionCommands(ProcessExecution &execution);
+    void processBehaviorTreeStart(ProcessExecution &execution);
+    void processStartingState(ProcessExecution &execution);
+    void abortStart(ProcessExecution &execution);
+    // Close the STARTING span trace, if one is recorded, and write it out
+    void finishStartTrace(const ProcessExecution &execution, bool started);
+    void processBehaviorTreeUnsuspend(ProcessExecution &execution);
+    void processResettingState(ProcessExecution &execution);
+    // Returns true when the tree was ticked
+    bool manageRunningBehaviorTree(ProcessExecution &execution);
+
+    // Wake the main loop (and trees waiting in sleep) from any thread
+    void wakeController();
+    void waitForWakeUp(std::chrono::milliseconds timeout);
+    void setWakeRoot(ProcessExecution &execution, BT::TreeNode *root);
 
     // Methods for node registration
     bool registerNodesWithAASConfig();
     void unregisterAllNodes();
+    // Forget what warm Starts would reuse and the parsed tree templates; required
+    // whenever bt_factory_ is replaced
+    void dropWarmState();
 
     // Methods for AAS structure fetching from process AAS
-    bool fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr blackboard = nullptr);
-    void populateBlackboard(BT::Blackboard::Ptr blackboard);
+    bool fetchAndBuildEquipmentMapping(ProcessExecution &execution, BT::Blackboard::Ptr blackboard = nullptr);
+    void populateBlackboard(const ProcessExecution &execution, BT::Blackboard::Ptr blackboard);
 
     // Pre-fetch asset interfaces (for fast node initialization)
-    bool prefetchAssetInterfaces();
+    bool prefetchAssetInterfaces(const ProcessExecution &execution);
 
     // Subscribe to topics for active nodes (triggers retained message delivery)
-    bool subscribeToTopics();
+    bool subscribeToTopics(const ProcessExecution &execution);
+    // Unsubscribe from the topics no tree's nodes listen to anymore
+    void releaseUnusedSubscriptions();
 
     // Methods for AAS registration
     bool publishConfigToRegistrationService();
+
+    // Incremental AAS updates: queue the asset a registration response names, refetch
+    // queued assets in the background and, once done, re-resolve the running nodes
+    // built from changed interactions between ticks
+    void queueAssetChange(const nlohmann::json &payload);
+    void applyAssetChanges();
+
+    std::unique_ptr<NodeMessageDistributor> createNodeMessageDistributor();
 };
\ No newline at end of file
@@ -3,9 +3,14 @@
 #include <string>
 #include <optional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <curl/curl.h>
 #include "utils.h"
+#include "aas/submodel_filter.h"
 
 // Forward declaration
 class AASInterfaceCache;
@@ -13,6 +18,35 @@ class AASInterfaceCache;
 class AASClient
 {
 public:
+    // One property of a fetchPropertyValues batch
+    struct PropertyRequest
+    {
+        std::string submodel_id_short;
+        std::vector<std::string> property_path; // As for the path-based fetchPropertyValue
+    };
+
+    // Station poses of a line, from the Entity statements under its HierarchicalStructures
+    // EntryNode; each station is identified through its SameAs reference
+    struct StationLayout
+    {
+        struct Station
+        {
+            std::string name;                 // Entity idShort
+            std::vector<std::string> same_as; // SameAs reference key values
+            nlohmann::json position;          // x, y and, if present, theta
+        };
+        std::vector<Station> stations;
+        // Station AAS idShort (from .../submodels/instances/<idShort>/...) -> index into stations
+        std::unordered_map<std::string, size_t> by_system_id;
+
+        // Pose of a station by its AAS ID; constant time for SameAs references of the usual
+        // form, otherwise the stations are matched by substring in document order
+        std::optional<nlohmann::json> find(const std::string &station_asset_id) const;
+
+        // Append a station and index its SameAs references
+        void add(Station station);
+    };
+
     AASClient(const std::string &aas_server_url,
               const std::string &registry_url = "");
     ~AASClient();
@@ -39,8 +73,18 @@ public:
         const std::string &submodel_id_short,
         const std::vector<std::string> &property_path);
 
-    // Fetch the HierarchicalStructure submodel of an asset
-    std::optional<nlohmann::json> fetchHierarchicalStructure(const std::string &asset_id);
+    // Batch version: resolve several properties of one asset in one pass
+    // The shell is looked up once and each submodel fetched once and indexed by idShort path;
+    // a path from the submodel root is a single index lookup, a partial path or bare idShort
+    // falls back to the recursive search. One result per request, nullopt where not found.
+    std::vector<std::optional<nlohmann::json>> fetchPropertyValues(
+        const std::string &asset_id,
+        const std::vector<PropertyRequest> &requests);
+
+    // Fetch the HierarchicalStructure submodel of an asset; with id_short_paths only the
+    // elements on those paths are kept while parsing (see SubmodelFilter)
+    std::optional<nlohmann::json> fetchHierarchicalStructure(const std::string &asset_id,
+                                                             const std::vector<std::string> &id_short_paths = {});
 
     // Fetch station position from the filling line's HierarchicalStructures
     // The station_asset_id is the full AAS ID (e.g., https://...imaDispensingSystemAAS)
@@ -50,6 +94,9 @@ public:
         const std::string &station_asset_id,
         const std::string &filling_line_asset_id);
 
+    // Fetch the poses of all stations of a line at once, for repeated lookups
+    std::optional<StationLayout> fetchStationLayout(const std::string &filling_line_asset_id);
+
     // Fetch the RequiredCapabilities submodel from a process AAS
     std::optional<nlohmann::json> fetchRequiredCapabilities(const std::string &aas_shell_id);
 
@@ -65,16 +112,77 @@ public:
     // Lookup AAS shell ID from asset ID using the registry
     std::optional<std::string> lookupAasIdFromAssetId(const std::string &asset_id);
 
+    // Drop memoized shells, submodels, interaction and property indexes so the next run
+    // sees the current AAS content
+    void clearMemo();
+
+    // Drop the memoized shell of one asset, the submodels it references and their indexes,
+    // e.g. after the asset was re-registered; everything else stays memoized
+    void forgetAsset(const std::string &asset_id);
+
     // Allow AASInterfaceCache to access private helpers for bulk fetching
     friend class AASInterfaceCache;
 
 private:
+    // Interactions of an AssetInterfacesDescription submodel, indexed by lower-case idShort
+    struct InteractionIndex
+    {
+        struct Entry
+        {
+            const nlohmann::json *element; // Points into submodel
+            bool is_action;
+        };
+
+        std::shared_ptr<const nlohmann::json> submodel;
+        std::string base_topic;
+        std::unordered_map<std::string, Entry> interactions;
+    };
+
+    // Elements of a submodel by full idShort path ("Requirements/InProcessControls/IPCInspection")
+    struct PropertyIndex
+    {
+        std::shared_ptr<const nlohmann::json> submodel;
+        std::unordered_map<std::string, const nlohmann::json *> elements; // Point into submodel
+    };
+
     std::string aas_server_url_;
     std::string registry_url_;
-    CURL *curl_;
 
-    // Helper to make HTTP GET requests
-    nlohmann::json makeGetRequest(const std::string &endpoint, bool use_registry = false);
+    // Per-run memo of parsed shells and submodels keyed by request path
+    // ("/shells/<base64url id>", "/submodels/<base64url id>"), with "#<filter key>"
+    // appended for documents parsed through a SubmodelFilter
+    std::mutex memo_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<const nlohmann::json>> document_memo_;
+    std::unordered_map<std::string, std::shared_ptr<const InteractionIndex>> interaction_index_memo_;
+    std::unordered_map<std::string, std::shared_ptr<const PropertyIndex>> property_index_memo_;
+
+    // GET through the memo; the first caller for a path fetches and parses it. A filtered
+    // request is served from the full document when that is memoized already.
+    std::shared_ptr<const nlohmann::json> getMemoized(const std::string &path,
+                                                      const SubmodelFilter *filter = nullptr);
+
+    // The part of an AssetInterfacesDescription the interface lookups read
+    static const SubmodelFilter &interfaceFilter();
+
+    // Path of the AssetInterfacesDescription submodel referenced by an asset shell,
+    // empty if the shell has none
+    std::string findInterfaceSubmodelPath(const std::string &asset_id);
+
+    // Build (once per run) the interaction index of an asset's interface submodel
+    std::shared_ptr<const InteractionIndex> getInteractionIndex(const std::string &asset_id);
+
+    // Build (once per run) the idShort-path index of a submodel, by request path
+    std::shared_ptr<const PropertyIndex> getPropertyIndex(const std::string &submodel_path);
+
+    // Request path of an asset's shell from the registry, empty if not registered
+    std::string findShellPath(const std::string &asset_id);
+
+    // Request path of the shell's submodel whose reference contains submodel_id_short, empty if none
+    static std::string findSubmodelPath(const nlohmann::json &shell_data, const std::string &submodel_id_short);
+
+    // Helper to make HTTP GET requests; a filter prunes the body while it is parsed
+    nlohmann::json makeGetRequest(const std::string &endpoint, bool use_registry = false,
+                                  const SubmodelFilter *filter = nullptr);
 
     // Helper to substitute parameters in topic patterns
     std::string substituteParams(const std::string &pattern, const nlohmann::json &params);
@@ -93,6 +201,9 @@ private:
         const std::string &asset_id,
         const std::string &submodel_id_short);
 
+    // Value of a property found at the end of a path (value, valueId or the collection)
+    static std::optional<nlohmann::json> elementValue(const nlohmann::json &element);
+
     // Recursive helper to search for property path in submodel elements
     std::optional<nlohmann::json> searchPropertyInElements(
         const nlohmann::json &elements,
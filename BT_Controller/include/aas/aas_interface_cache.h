@@ -5,10 +5,11 @@
 #include <optional>
 #include <mutex>
 #include <set>
+#include <vector>
+#include <chrono>
 #include <nlohmann/json.hpp>
 #include "utils.h"
-
-class AASClient;
+#include "aas/aas_client.h"
 
 /**
  * @brief Caches Asset Interface Descriptions fetched from AAS
@@ -20,19 +21,57 @@ class AASClient;
 class AASInterfaceCache
 {
 public:
-    AASInterfaceCache(AASClient &aas_client);
+    AASInterfaceCache(AASClient &aas_client, size_t max_parallel_fetches = 8);
 
     /**
      * @brief Pre-fetch and cache interface descriptions for all assets
      *
      * Should be called once when the equipment mapping is built,
-     * before creating the behavior tree.
+     * before creating the behavior tree. Assets are fetched concurrently
+     * by up to max_parallel_fetches threads.
      *
      * @param asset_ids Map of equipment name to AAS ID
      * @return true if at least some interfaces were cached successfully
      */
     bool prefetchInterfaces(const std::map<std::string, std::string> &asset_ids);
 
+    /**
+     * @brief Bring the cache in line with a new equipment mapping without starting over
+     *
+     * Warm counterpart of prefetchInterfaces for a restart: assets already cached are
+     * kept, assets no longer in the mapping are evicted, and only the missing ones (new,
+     * re-pointed, or failed last time) are fetched.
+     *
+     * @param asset_ids Map of equipment name to AAS ID
+     * @return true if at least some interfaces are cached afterwards
+     */
+    bool refreshInterfaces(const std::map<std::string, std::string> &asset_ids);
+
+    /**
+     * @brief What refreshAsset changed for one cached asset
+     */
+    struct AssetChange
+    {
+        std::string asset_id;
+        // Previous topics of the interactions that were changed or removed, so the
+        // nodes built from them can be found and re-resolved
+        std::vector<mqtt_utils::Topic> stale_topics;
+    };
+
+    /**
+     * @brief Refetch one asset after its AAS changed, leaving every other asset untouched
+     *
+     * asset_ref is a full AAS ID or its idShort (the last path segment, as
+     * Registration_Service reports it). The asset's memoized shell and submodels are
+     * dropped and its interfaces fetched again; interactions are compared one by one.
+     * A line's station layout is rebuilt if the asset is one. Assets neither cached nor
+     * failed are ignored, the next prefetch fetches them anyway; a failed refetch keeps
+     * the previous interfaces.
+     *
+     * @return One entry per cached asset that was refetched
+     */
+    std::vector<AssetChange> refreshAsset(const std::string &asset_ref);
+
     /**
      * @brief Get a cached interface for an asset
      *
@@ -46,6 +85,22 @@ public:
         const std::string &interaction,
         const std::string &endpoint) const;
 
+    /**
+     * @brief Resolve several interfaces of one asset, cache first
+     *
+     * Interfaces missing from the cache trigger at most one fetch of the whole
+     * asset, merged into the cache for every later node; only what is still
+     * missing afterwards is queried individually through AASClient::fetchInterface.
+     * After a successful prefetch this never touches the network.
+     *
+     * @param asset_id The AAS ID of the asset
+     * @param requests (interaction, endpoint) pairs
+     * @return One entry per request, nullopt where the interface could not be resolved
+     */
+    std::vector<std::optional<mqtt_utils::Topic>> resolveInterfaces(
+        const std::string &asset_id,
+        const std::vector<std::pair<std::string, std::string>> &requests);
+
     /**
      * @brief Get wildcard topic patterns that cover all cached assets
      *
@@ -66,6 +121,65 @@ public:
      */
     std::vector<mqtt_utils::Topic> getAssetOutputTopics(const std::string &asset_id) const;
 
+    /**
+     * @brief Make the station poses of a line available for getStationPosition
+     *
+     * Fetches the line's HierarchicalStructures once and indexes every station's pose.
+     * The line is remembered: every later prefetchInterfaces rebuilds its layout, so
+     * nodes call this during initialization and never pay for it on the tick path.
+     *
+     * @return true if the layout is cached
+     */
+    bool loadStationLayout(const std::string &line_asset_id);
+
+    /**
+     * @brief Pose (x, y, theta) of a station of a line, without network I/O once loaded
+     *
+     * Loads the line's layout first if loadStationLayout was not called for it.
+     */
+    std::optional<nlohmann::json> getStationPosition(
+        const std::string &station_asset_id,
+        const std::string &line_asset_id);
+
+    /**
+     * @brief Drop the cached layout of a line (all lines if empty); the next lookup rebuilds it
+     */
+    void invalidateStationLayout(const std::string &line_asset_id = "");
+
+    /**
+     * @brief Write the cache to a snapshot file for the next process start
+     *
+     * Topics, schema URLs, variable aliases and base topics per asset with the version
+     * they were fetched at, the station layouts, and each referenced schema once. The
+     * file is replaced atomically.
+     *
+     * @return true if the snapshot was written
+     */
+    bool saveSnapshot(const std::string &path) const;
+
+    /**
+     * @brief Fill the cache from a snapshot instead of the AAS
+     *
+     * Loads the assets of the mapping the snapshot holds and every station layout;
+     * what is already cached is kept. Nodes resolve from the loaded data right away,
+     * and the loaded assets stay unverified until revalidateSnapshot checks them.
+     *
+     * @return Number of assets loaded
+     */
+    size_t loadSnapshot(const std::string &path, const std::map<std::string, std::string> &asset_ids);
+
+    /**
+     * @brief Check the assets loaded from a snapshot against the AAS
+     *
+     * Fetches each unverified asset's shell, interface description and Variables
+     * submodel (no schemas) and compares their version with the snapshot's. Station
+     * layouts from the snapshot are rebuilt. Assets that could not be checked stay as
+     * loaded.
+     *
+     * @return The assets whose AAS changed since the snapshot; refreshAsset updates them
+     */
+    std::vector<std::string> revalidateSnapshot();
+
     /**
      * @brief Check if interfaces are cached for an asset
      */
@@ -84,12 +198,16 @@ public:
         size_t total_assets;
         size_t total_interfaces;
         size_t failed_assets;
+        std::map<std::string, std::chrono::milliseconds> asset_fetch_latency; // asset_id -> fetch time
+        std::chrono::milliseconds last_prefetch_duration{0};
     };
     CacheStats getStats() const;
 
 private:
     AASClient &aas_client_;
+    size_t max_parallel_fetches_;
     mutable std::mutex mutex_;
+    std::mutex prefetch_mutex_; // Serializes whole prefetch runs
 
     // Structure to cache interface data
     struct InterfaceData
@@ -98,6 +216,8 @@ private:
         mqtt_utils::Topic output_topic;
         bool has_input = false;
         bool has_output = false;
+        std::string input_schema_url; // Where the topics' schemas came from, for snapshots
+        std::string output_schema_url;
     };
 
     // Cache: asset_id -> interaction_name -> InterfaceData
@@ -113,12 +233,52 @@ private:
     // Track failed assets for diagnostics
     std::set<std::string> failed_assets_;
 
+    // Version of each asset's AAS content when it was fetched, and the assets loaded
+    // from a snapshot that were not compared with the AAS since
+    std::map<std::string, std::string> asset_versions_;
+    std::set<std::string> unverified_assets_;
+    std::set<std::string> snapshot_layout_lines_;
+
+    // Station layouts by line AAS ID, and every line asked for so far (kept across clear())
+    std::map<std::string, AASClient::StationLayout> station_layouts_;
+    std::set<std::string> layout_lines_;
+
+    // Per-asset fetch latency of the last prefetch
+    std::map<std::string, std::chrono::milliseconds> asset_fetch_latency_;
+    std::chrono::milliseconds last_prefetch_duration_{0};
+
+    // Everything fetched for one asset, built without holding mutex_
+    struct AssetInterfaces
+    {
+        std::map<std::string, InterfaceData> interfaces;
+        std::map<std::string, std::string> aliases;
+        std::string base_topic;
+        std::string version;
+    };
+
+    // Fetch the given (equipment name, AAS ID) pairs concurrently and merge them;
+    // prefetch_mutex_ must be held by the caller. Returns the number fetched successfully.
+    size_t fetchAssetsConcurrently(const std::vector<std::pair<std::string, std::string>> &work);
+
+    // Store one asset's fetch result; mutex_ must be held by the caller
+    void mergeAssetInterfaces(const std::string &asset_id, AssetInterfaces &&result);
+
+    // Fetch and merge a single asset that the prefetch did not cover
+    bool fillAsset(const std::string &asset_id);
+
+    // Fetch and store the layout of a line; prefetch_mutex_ must be held by the caller
+    bool buildStationLayout(const std::string &line_asset_id);
+
     // Helper to extract base topic from a full topic path
     std::string extractBaseTopic(const std::string &topic) const;
 
-    // Helper to fetch all interfaces for a single asset
-    bool fetchAssetInterfaces(const std::string &asset_id);
+    // Helper to fetch all interfaces for a single asset (thread-safe, touches no cache members)
+    bool fetchAssetInterfaces(const std::string &asset_id, AssetInterfaces &result);
+
+    // Helper to fetch variable aliases from the Variables submodel
+    std::map<std::string, std::string> fetchVariableAliases(const std::string &asset_id);
 
-    // Helper to fetch and cache variable aliases from the Variables submodel
-    void fetchVariableAliases(const std::string &asset_id);
+    // Fingerprint of the shell, interface description and Variables submodel of an asset
+    // as memoized by the client, empty if the shell or interface description is missing
+    std::string fetchAssetVersion(const std::string &asset_id);
 };
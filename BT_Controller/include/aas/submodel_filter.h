@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Parses a submodel keeping only the elements under declared idShort paths
+ *
+ * Paths are '/'-separated idShorts from the submodel root, the same form the property
+ * index uses (e.g. "InterfaceMQTT"); a segment "*" matches any idShort, so the Location
+ * of every station entity under EntryNode is "EntryNode", "*", "Location" joined by '/'.
+ * An element is kept while its path and some declared path agree on every segment both
+ * have: ancestors of a declared element keep only the children on the way down,
+ * everything below a declared element is kept whole.
+ *
+ * Filtering happens in the parser callback, so the value/statements of an element whose
+ * idShort is read before them are skipped without being built. Elements serialized with
+ * their idShort after their children are built and dropped once complete. Everything
+ * outside the element tree (id, semanticId, ...) is kept.
+ */
+class SubmodelFilter
+{
+public:
+    explicit SubmodelFilter(std::vector<std::string> paths);
+
+    /// @brief Parse body, pruning elements no declared path leads to or through
+    nlohmann::json parse(std::string_view body) const;
+
+    /// @brief Distinguishes documents parsed with different filters in a memo
+    const std::string &key() const { return key_; }
+
+private:
+    std::vector<std::vector<std::string>> paths_;
+    std::string key_;
+
+    bool wanted(const std::vector<std::string_view> &element_path) const;
+};
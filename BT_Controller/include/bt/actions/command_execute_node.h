@@ -7,6 +7,13 @@
 
 class CommandExecuteNode : public MqttActionNode
 {
+private:
+    // Parameters serialized once; rebuilt only when the port's text changes
+    MessageTemplate command_template_;
+    std::string template_parameters_;
+
+    void selectUuid();
+
 public:
     CommandExecuteNode(
         const std::string &name,
@@ -17,6 +24,8 @@ public:
 
     static BT::PortsList providedPorts();
     nlohmann::json createMessage() override;
+    void publishCommand() override;
+    void resendCommand() override;
     std::string getFormattedTopic(const std::string &pattern) const;
 
     void initializeTopicsFromAAS() override;
@@ -4,8 +4,8 @@
 #include <behaviortree_cpp/bt_factory.h>
 #include <nlohmann/json.hpp>
 #include <string>
-#include <deque>
 #include "aas/aas_client.h"
+#include "bt/product_queue.h"
 
 class ConfigurationNode : public BT::StatefulActionNode
 {
@@ -38,5 +38,4 @@ public:
 
 private:
     AASClient &aas_client_;
-    std::shared_ptr<std::deque<std::string>> shared_queue = std::make_shared<std::deque<std::string>>();
 };
\ No newline at end of file
@@ -7,6 +7,9 @@
 
 class GenericActionNode : public MqttActionNode
 {
+private:
+    MessageTemplate command_template_{nlohmann::json::object(), {"/Uuid"}};
+
 public:
     GenericActionNode(
         const std::string &name,
@@ -14,6 +17,8 @@ public:
         MqttClient &bt_mqtt_client,
         AASClient &aas_client);
     json createMessage() override;
+    void publishCommand() override;
+    void resendCommand() override;
 
     void initializeTopicsFromAAS() override;
 };
\ No newline at end of file
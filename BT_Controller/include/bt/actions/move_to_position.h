@@ -3,12 +3,20 @@
 #include "bt/mqtt_action_node.h"
 #include <behaviortree_cpp/bt_factory.h>
 #include <nlohmann/json.hpp>
+#include <chrono>
 #include <string>
+#include <optional>
 
 class MoveToPosition : public MqttActionNode
 {
 private:
+    MessageTemplate command_template_{nlohmann::json::object(), {"/Position", "/Uuid", "/TimeStamp"}};
+    std::string target_station_;                          // TargetPosition of the current move
+    std::chrono::steady_clock::time_point move_started_; // Travel time fed to AssignmentScheduler
+
     std::string getFormattedTopic(const std::string &pattern, const BT::NodeConfig &config);
+    // Pose [x, y, theta] of the TargetPosition station; sets current_uuid_ from the Uuid port
+    std::optional<nlohmann::json> resolveTarget();
 
 public:
     MoveToPosition(
@@ -19,6 +27,9 @@ public:
 
     static BT::PortsList providedPorts();
     void initializeTopicsFromAAS() override;
+    BT::NodeStatus onStart() override;
     void onHalted() override;
+    void callback(const std::string &topic_key, const nlohmann::json &msg, mqtt::properties props) override;
     nlohmann::json createMessage() override;
+    void publishCommand() override;
 };
\ No newline at end of file
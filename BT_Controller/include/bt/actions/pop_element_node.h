@@ -6,6 +6,7 @@
 #include <nlohmann/json.hpp>
 #include "aas/aas_client.h"
 #include "bt/mqtt_sync_action_node.h"
+#include "bt/product_queue.h"
 #include "mqtt/node_message_distributor.h"
 
 class PopElementNode : public MqttSyncActionNode
@@ -84,3 +84,39 @@ public:
         factory.registerBuilder(manifest, builder);
     }
 };
+
+/**
+ * @brief RetrieveAASPropertiesNode retrieves several values of one asset in a single pass
+ *
+ * Batch variant of RetrieveAASProperty built on AASClient::fetchPropertyValues: each
+ * submodel involved is fetched once, however many properties are read from it.
+ *
+ * Example usage in BT XML:
+ * <Retrieve_AAS_Properties Asset="{product}"
+ *                          Submodel="Requirements"
+ *                          Properties="quantity=BatchInformation:Quantity;
+ *                                      ipc=InProcessControls|IPCInspection"/>
+ *
+ * Each entry is output_key=[Submodel:]Property, with Property an idShort or a | delimited
+ * path as for RetrieveAASProperty; entries without a submodel use the Submodel port.
+ * Returns SUCCESS only if every entry was written; the others are still written.
+ */
+class RetrieveAASPropertiesNode : public BT::SyncActionNode
+{
+private:
+    AASClient &aas_client_;
+
+public:
+    RetrieveAASPropertiesNode(
+        const std::string &name,
+        const BT::NodeConfig &config,
+        AASClient &aas_client)
+        : BT::SyncActionNode(name, config), aas_client_(aas_client)
+    {
+        setRegistrationID("RetrieveAASProperties");
+    }
+
+    static BT::PortsList providedPorts();
+
+    virtual BT::NodeStatus tick() override;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "bt/decorators/occupy_selection_policy.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bt_utils
+{
+    struct SchedulerConfig;
+}
+
+/**
+ * @brief Process-wide station assignment for Occupy nodes, by shortest expected completion
+ *
+ * Fed with the capability-to-resource mapping the controller reads from each execution's process
+ * AAS (RequiredCapabilities), the StationLoadTracker telemetry and the shuttle travel times
+ * MoveToPosition observes. A candidate's expected completion is the longer of the travel to
+ * it and the work queued there, plus one service time for the new request; queued work is
+ * a service time per occupant in its QueueDepth and per assignment made to it since its
+ * last State message. Counting those assignments keeps Occupy nodes that decide in the
+ * same tick from all picking one idle station before its QueueDepth catches up; without
+ * State telemetry they count until the occupation ends.
+ *
+ * Thread-safe; the mapping is written on Start, the rest from tick and MQTT threads.
+ */
+class AssignmentScheduler
+{
+public:
+    static AssignmentScheduler &instance();
+
+    void configure(const bt_utils::SchedulerConfig &config);
+
+    /// @brief Policy of Occupy nodes that set none in the tree
+    std::string defaultPolicy() const;
+
+    /// @brief Capability idShort -> AAS IDs of its resources for the execution in slot execution;
+    /// replaces that execution's mapping, other executions keep theirs
+    void updateCapabilities(size_t execution, const std::map<std::string, std::vector<std::string>> &capability_resources);
+    std::vector<std::string> resourcesFor(size_t execution, const std::string &capability) const;
+
+    /// @brief Candidates in order of expected completion, stations not accepting work last
+    std::vector<std::string> rank(const std::vector<std::string> &candidates, StationLoadTracker &tracker);
+
+    /// @brief An Occupy asked asset_id; returns the ticket to withdraw() it with
+    uint64_t assign(const std::string &asset_id);
+    /// @brief The asset refused, or the occupation ended; unknown tickets are ignored
+    void withdraw(const std::string &asset_id, uint64_t ticket);
+
+    /// @brief MoveToPosition command to SUCCESS for a move to station_id, smoothed
+    void recordTravelTime(const std::string &station_id, std::chrono::steady_clock::duration travel_time);
+
+private:
+    struct Assignment
+    {
+        uint64_t ticket;
+        std::chrono::steady_clock::time_point assigned;
+    };
+
+    struct TravelTime
+    {
+        double mean_ms = 0.0;
+        uint64_t samples = 0;
+    };
+
+    /// @brief Assignments the station's telemetry does not show yet; caller holds mutex_
+    size_t unreportedAssignments(const std::string &asset_id, const std::optional<StationLoad> &load);
+
+    mutable std::mutex mutex_;
+    std::string default_policy_ = "first_response";
+    std::map<std::pair<size_t, std::string>, std::vector<std::string>> capabilities_; // (execution slot, capability)
+    std::unordered_map<std::string, std::vector<Assignment>> assignments_;
+    std::unordered_map<std::string, TravelTime> travel_times_;
+    uint64_t next_ticket_ = 1;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "utils.h"
+#include "bt/sim_clock.h"
+
+/**
+ * @brief Hierarchical timing wheel holding every outstanding command deadline
+ *
+ * Four levels of 64 slots: level 0 spans 64 resolution steps, each further level 64 times
+ * the previous one. A deadline goes into the coarsest slot it fits and moves one level down
+ * each time its slot comes up, so schedule(), cancel() and the work advance() does per
+ * elapsed step are O(1) no matter how many deadlines are pending. Deadlines beyond the top
+ * level are clamped to its end and expire early; with the default 10 ms resolution that is
+ * after about 46 hours.
+ *
+ * Also carries the configured timeouts and resend policy the nodes read when they arm.
+ *
+ * Any thread may schedule or cancel. advance() runs the expired callbacks on the calling
+ * thread (the controller's tick thread) after releasing the wheel's lock, so a callback
+ * may schedule again.
+ */
+class CommandDeadlines
+{
+public:
+    using Clock = SimClock;
+    // Receives the id schedule() returned
+    using Callback = std::function<void(uint64_t id)>;
+
+    explicit CommandDeadlines(const bt_utils::CommandDeadlineConfig &config);
+
+    const bt_utils::CommandDeadlineConfig &config() const { return config_; }
+
+    /// @brief Run on_expire once timeout has passed; the id is never 0
+    uint64_t schedule(std::chrono::milliseconds timeout, Callback on_expire);
+
+    /// @brief False if the deadline already expired or was cancelled
+    bool cancel(uint64_t id);
+
+    /// @brief Expire everything due by now; returns the number of callbacks run
+    size_t advance(Clock::time_point now = Clock::now());
+
+    /// @brief Time until the next slot holding a deadline could expire, at most cap
+    std::chrono::milliseconds untilNext(std::chrono::milliseconds cap) const;
+
+    size_t pending() const;
+
+private:
+    static constexpr unsigned kLevelBits = 6;
+    static constexpr uint64_t kSlots = uint64_t{1} << kLevelBits;
+    static constexpr unsigned kLevels = 4;
+
+    struct Entry
+    {
+        uint64_t expires_step;
+        Callback on_expire;
+    };
+
+    // Caller holds mutex_
+    void place(uint64_t id, uint64_t expires_step);
+    void cascade(unsigned level);
+
+    const bt_utils::CommandDeadlineConfig config_;
+    const Clock::duration resolution_;
+    const Clock::time_point origin_;
+
+    mutable std::mutex mutex_;
+    uint64_t current_step_ = 0; // Every step up to this one has expired
+    uint64_t next_id_ = 1;
+    std::unordered_map<uint64_t, Entry> entries_;
+    // Ids only; cancelled ones stay behind until their slot is processed
+    std::array<std::array<std::vector<uint64_t>, kSlots>, kLevels> slots_;
+};
+
+/**
+ * @brief The one deadline a node has outstanding at a time
+ *
+ * arm() replaces the previous deadline, cancel() and the destructor drop it; call both
+ * under the node's lock. on_expire runs on the tick thread with the deadline already
+ * disarmed and before it takes the node's lock, so it returns early if it then finds the
+ * deadline armed again (a response re-armed it in between). Without an installed wheel
+ * arm() does nothing.
+ */
+class CommandDeadline
+{
+public:
+    CommandDeadline() = default;
+    ~CommandDeadline() { cancel(); }
+
+    CommandDeadline(const CommandDeadline &) = delete;
+    CommandDeadline &operator=(const CommandDeadline &) = delete;
+
+    /// @brief Controller-owned wheel the nodes arm their deadlines on; null disables them
+    static void install(CommandDeadlines *wheel);
+    static CommandDeadlines *installed() { return wheel_.load(std::memory_order_acquire); }
+
+    /// @brief base * factor^attempt, the timeout of resend number attempt (0 = first send)
+    static std::chrono::milliseconds backoff(std::chrono::milliseconds base, int attempt, double factor);
+
+    /// @brief Expire on_expire after timeout; a timeout of 0 or less only cancels
+    void arm(std::chrono::milliseconds timeout, std::function<void()> on_expire);
+    void cancel();
+    bool armed() const { return generation_.load(std::memory_order_acquire) != 0; }
+
+    // Resends made for the command currently awaited; reset by the node on each new command
+    int attempt = 0;
+
+private:
+    static std::atomic<CommandDeadlines *> wheel_;
+    static std::atomic<uint64_t> next_generation_;
+
+    std::atomic<uint64_t> generation_{0}; // Of the armed deadline, 0 = none
+    uint64_t wheel_id_ = 0;
+};
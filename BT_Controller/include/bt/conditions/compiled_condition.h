@@ -0,0 +1,62 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Data_Condition comparison parsed once from its port strings
+ *
+ * Field is a top-level key ("State") or a JSON pointer ("/Position/x"). The expected
+ * value is parsed up front (number, bool, "min;max" range), so evaluate() only looks at
+ * the extracted field value. Results are the same as the former per-tick string compare.
+ */
+class CompiledCondition
+{
+public:
+    /// @brief nullopt when Field is not a valid JSON pointer
+    static std::optional<CompiledCondition> compile(const std::string &field,
+                                                    const std::string &comparison_type,
+                                                    const std::string &expected_value);
+
+    const nlohmann::json::json_pointer &path() const { return path_; }
+    const std::string &field() const { return field_; }
+    // Top-level key the path starts with; messages without it are rejected before the callback
+    const std::string &topLevelField() const { return top_level_field_; }
+
+    bool evaluate(const nlohmann::json &actual) const;
+
+    // Port strings it was compiled from
+    bool compiledFrom(const std::string &field, const std::string &comparison_type,
+                      const std::string &expected_value) const
+    {
+        return field == field_ && comparison_type == comparison_type_ && expected_value == expected_text_;
+    }
+    std::string describe() const { return field_ + " (" + comparison_type_ + ") '" + expected_text_ + "'"; }
+
+private:
+    enum class Op
+    {
+        Equal,
+        Greater,
+        Less,
+        Contains,
+        Inside,
+        Never // Unknown comparison type
+    };
+
+    bool evaluateEqual(const nlohmann::json &actual) const;
+
+    nlohmann::json::json_pointer path_;
+    std::string top_level_field_;
+    std::string field_;
+    std::string comparison_type_;
+    Op op_ = Op::Never;
+    bool negate_ = false; // not_equal, outside
+
+    std::string expected_text_;
+    std::optional<double> expected_number_;
+    bool operational_ = false; // State == "operational" matches any running PackML state
+    std::optional<double> range_min_;
+    std::optional<double> range_max_;
+};
@@ -6,7 +6,10 @@
 #include <string>
 #include <chrono>
 #include <optional>
+#include <atomic>
+#include <memory>
 #include "aas/aas_client.h"
+#include "bt/conditions/compiled_condition.h"
 
 class GenericConditionNode : public MqttSyncConditionNode
 {
@@ -17,10 +20,29 @@ public:
     void initializeTopicsFromAAS() override;
     BT::NodeStatus tick() override;
     virtual void callback(const std::string &topic_key, const json &msg, mqtt::properties props) override;
-    bool compare(const json &msg, const std::string &field_name, const std::string &comparison_type,
-                 const std::string &expected_value);
 
 private:
+    enum Result : uint8_t
+    {
+        kNoMessage,
+        kFalse,
+        kTrue,
+        kInvalid // Ports missing or Field not a valid JSON pointer
+    };
+
+    // Compile from the current port values; false when they are missing or invalid.
+    // Callers hold mutex_ or run before the node is subscribed
+    bool compileCondition();
+    void storeResult(const json &msg);
+
+    // The callback evaluates each message and publishes the outcome here, so a tick is
+    // one atomic load with no lock, port read or JSON lookup
+    std::atomic<uint8_t> result_{kNoMessage};
+    std::shared_ptr<const CompiledCondition> condition_; // Replaced under mutex_
+    // Ports bound to blackboard entries are re-read every tick; then the last message is
+    // kept (in latest_msg_) to re-evaluate when they change
+    bool dynamic_ports_ = false;
+
     std::string initialized_asset_id_; // Track which asset we initialized for
     std::string initialized_property_; // Track which property we initialized for
     
@@ -29,4 +51,6 @@ private:
     std::chrono::steady_clock::time_point initialization_time_;
     std::optional<std::chrono::steady_clock::time_point> first_message_received_time_;
     bool last_comparison_result_ = false;
+    bool waiting_logged_ = false;          // "waiting for the first message" is logged once
+    bool first_message_timed_out_ = false; // The FAILURE diagnostics are logged once
 };
\ No newline at end of file
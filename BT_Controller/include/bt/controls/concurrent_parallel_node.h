@@ -0,0 +1,54 @@
+#pragma once
+
+#include "behaviortree_cpp/control_node.h"
+#include "bt/product_queue.h"
+
+#include <set>
+#include <vector>
+
+namespace BT
+{
+    /**
+     * @brief Parallel node that ticks its children at the same time on the TickPool
+     *
+     * Same ports and semantics as the built-in Parallel: it returns SUCCESS once
+     * success_count children succeeded, FAILURE once failure_count failed (or success
+     * became impossible), and RUNNING otherwise; negative thresholds count from the
+     * number of children.
+     *
+     * Children that write a blackboard entry another child also writes are ticked in
+     * order on the calling thread after the concurrent ones. ProductQueue ports are not
+     * treated as writes: the queue itself is safe to draw from concurrently.
+     */
+    class ConcurrentParallelNode : public ControlNode
+    {
+    public:
+        ConcurrentParallelNode(const std::string &name, const NodeConfig &config);
+
+        static PortsList providedPorts();
+
+        virtual ~ConcurrentParallelNode() override = default;
+
+        virtual void halt() override;
+
+    private:
+        int success_threshold_ = -1;
+        int failure_threshold_ = 1;
+        std::set<size_t> completed_list_;
+        size_t success_count_ = 0;
+        size_t failure_count_ = 0;
+
+        // Children split on first tick by their blackboard writes
+        bool partitioned_ = false;
+        std::vector<size_t> concurrent_children_;
+        std::vector<size_t> sequential_children_;
+
+        size_t successThreshold() const;
+        size_t failureThreshold() const;
+        void partitionChildren();
+        void clear();
+
+        virtual BT::NodeStatus tick() override;
+    };
+
+} // namespace BT
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "behaviortree_cpp/control_node.h"
+#include "bt/product_queue.h"
+
+#include <string>
+#include <vector>
+
+namespace BT
+{
+    /**
+     * @brief Works a product batch through up to MaxInFlight lanes at once
+     *
+     * Every child is a lane, usually a SubTree bound to one shuttle. A lane that is idle
+     * takes the next product from Queue: its ID is written under ProductKey into the lane's
+     * own SubTree blackboard and the lane runs it to completion while the other lanes work
+     * on theirs. Lanes are ticked in order on the calling thread; what runs concurrently
+     * are the stations and shuttles they command.
+     *
+     *   <PipelinedBatch Queue="{ProductIDs}" MaxInFlight="2">
+     *     <SubTree ID="AsepticFilling" Xbot="{Xbot1}" ProductID="" _autoremap="true"/>
+     *     <SubTree ID="AsepticFilling" Xbot="{Xbot2}" ProductID="" _autoremap="true"/>
+     *     <SubTree ID="AsepticFilling" Xbot="{Xbot3}" ProductID="" _autoremap="true"/>
+     *   </PipelinedBatch>
+     *
+     * Declaring ProductID on each SubTree keeps it local; with only _autoremap the
+     * lanes would share the parent's entry. After a lane fails, no further products are
+     * started and the batch returns FAILURE once the lanes still running have finished.
+     * SUCCESS once the queue is empty and every lane is idle (if_empty if no product
+     * was run).
+     */
+    class PipelinedBatchNode : public ControlNode
+    {
+    public:
+        PipelinedBatchNode(const std::string &name, const NodeConfig &config);
+
+        static PortsList providedPorts();
+
+        virtual ~PipelinedBatchNode() override = default;
+
+        virtual void halt() override;
+
+    private:
+        struct Lane
+        {
+            Blackboard::Ptr blackboard; // The SubTree's own, null for other children
+            bool busy = false;
+        };
+
+        std::vector<Lane> lanes_;
+        size_t in_flight_ = 0;
+        size_t completed_ = 0;
+        bool failed_ = false;
+
+        void setupLanes();
+        void clear();
+
+        virtual BT::NodeStatus tick() override;
+    };
+
+} // namespace BT
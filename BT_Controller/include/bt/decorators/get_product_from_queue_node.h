@@ -6,12 +6,13 @@
 #include <string>
 #include "aas/aas_client.h"
 #include "mqtt/mqtt_pub_base.h"
+#include "bt/product_queue.h"
 
 class GetProductFromQueue : public MqttDecorator
 {
 private:
     bool child_running_ = false;
-    BT::SharedQueue<std::string> queue_;
+    ProductQueuePtr queue_;
 
 public:
     GetProductFromQueue(const std::string &name,
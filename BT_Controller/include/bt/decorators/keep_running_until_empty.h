@@ -2,13 +2,11 @@
 
 #include <behaviortree_cpp/bt_factory.h>
 #include "bt/mqtt_decorator.h"
+#include "bt/product_queue.h"
 #include <string>
 
 class KeepRunningUntilEmpty : public MqttDecorator
 {
-private:
-    BT::SharedQueue<std::string> queue_ptr_from_bb_;
-
 public:
     KeepRunningUntilEmpty(const std::string &name,
                           const BT::NodeConfig &config,
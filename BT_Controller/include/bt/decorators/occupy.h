@@ -9,6 +9,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include "mqtt/mqtt_pub_base.h"
+#include "bt/decorators/occupy_selection_policy.h"
+#include "bt/command_deadlines.h"
 #include <fmt/chrono.h>
 #include <chrono>
 #include <utils.h>
@@ -24,10 +26,24 @@
  * 4. Upon completion, releases the occupied asset
  * 
  * This enables flexible resource assignment where assets handle their own queueing internally.
+ *
+ * With a `Policy` other than "first_response" the node instead asks one asset at a time,
+ * in the order chosen by an OccupySelectionPolicy from the stations' State telemetry
+ * (queue depth, PackML state), and falls through to the next asset when one refuses.
+ * Without a `Policy` the node uses scheduler.occupy_policy. Instead of `Assets` it may
+ * name a `Capability`, whose resources the AssignmentScheduler knows from the process AAS.
+ *
+ * If the `Uuid` input names an occupation queued ahead of time by a PrefetchOccupy
+ * ancestor for the same assets, the node adopts it instead of sending new requests.
+ *
+ * Assets that do not answer an occupy request within the command_deadlines ack timeout are
+ * asked again or, once the retries are spent, count as refused. Waiting in a station's queue
+ * after it answered is not bounded. A release of the selected asset left unanswered is
+ * resent the same way and finally assumed to have gone through.
  */
 class Occupy : public MqttDecorator
 {
-private:
+protected:
     std::mutex mutex_;
     PackML::State current_phase_ = PackML::State::IDLE;
 
@@ -38,12 +54,40 @@ private:
     std::unordered_set<std::string> pending_assets_;               // Assets waiting for occupy response
     std::unordered_set<std::string> assets_to_release_;            // Assets that need release (occupied but not selected)
     std::set<std::string> assets_with_pending_requests_;           // All assets we've sent requests to (for proper cleanup)
+    std::chrono::steady_clock::time_point occupy_requested_time_;  // For the "occupy_wait" histogram
+    std::chrono::steady_clock::time_point granted_time_;           // Service time fed to StationLoadTracker
+
+    // Policy-driven selection; null for first_response
+    std::unique_ptr<OccupySelectionPolicy> policy_;
+    std::vector<std::string> ranked_assets_;                       // Request order chosen by policy_
+    size_t next_ranked_asset_ = 0;
+
+    // STARTING: until every asked asset answered once; COMPLETING/STOPPING: until the
+    // selected asset answers its release. Guarded by mutex_
+    CommandDeadline deadline_;
+    void armOccupyDeadline();
+    void armReleaseDeadline();
+    void onDeadline();
+    // Enter COMPLETING or STOPPING and release the selected asset; caller holds mutex_
+    void beginRelease(PackML::State phase);
+    // After an asset refused (or never answered) while STARTING: ask the next ranked one
+    // or fail once none is left; caller holds mutex_
+    void onAssetRefused(const std::string &asset_id);
+    /// @brief False for PrefetchOccupy, whose requests are timed by the Occupy adopting them
+    virtual bool usesCommandDeadlines() const { return true; }
 
     // Helper to generate topic keys per asset
     std::string getOccupyRequestKey(const std::string& asset_id) const;
     std::string getReleaseRequestKey(const std::string& asset_id) const;
     std::string getOccupyResponseKey(const std::string& asset_id) const;
     std::string getReleaseResponseKey(const std::string& asset_id) const;
+    std::string getStationStateKey(const std::string& asset_id) const;
+
+    /// @brief Reset per-run state and send the occupy requests; false if no asset can be asked
+    bool beginOccupation();
+
+    /// @brief Take over an occupation a PrefetchOccupy ancestor queued under our Uuid input
+    bool adoptPrefetchedOccupation();
 
 public:
     Occupy(
@@ -58,6 +102,7 @@ public:
     // Mqtt AAS Stuff
     void initializeTopicsFromAAS() override;
     void sendRegisterCommandToAll();
+    bool sendRegisterCommandToNextRanked();
     void sendRegisterCommand(const std::string& asset_id);
     void sendUnregisterCommand(const std::string& asset_id);
     void releaseNonSelectedAssets();
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Last known load of one station, built from its PackML State telemetry
+ */
+struct StationLoad
+{
+    std::string state;              // PackML state name, empty until the first State message
+    size_t queue_depth = 0;         // QueueDepth, or the ProcessQueue length for older firmware
+    double mean_service_ms = 0.0;   // Smoothed occupy-to-release time observed by Occupy nodes
+    uint64_t service_samples = 0;
+    std::chrono::steady_clock::time_point updated;
+};
+
+/**
+ * @brief Process-wide view of station load shared by all Occupy nodes
+ *
+ * Occupy nodes subscribe to each candidate's PackMLState output and forward what the
+ * distributor routes to them here, so one tree's nodes see the queueing caused by the
+ * others. Thread-safe; updates come from MQTT callback threads, reads from tick threads.
+ */
+class StationLoadTracker
+{
+public:
+    static StationLoadTracker &instance();
+
+    void updateFromState(const std::string &asset_id, const nlohmann::json &state_msg);
+    void recordServiceTime(const std::string &asset_id, std::chrono::steady_clock::duration service_time);
+    std::optional<StationLoad> get(const std::string &asset_id) const;
+
+    /// @brief Monotonic counter per candidate set, shared by every Occupy using that set
+    size_t nextRoundRobin(const std::string &candidate_key);
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, StationLoad> loads_;
+    std::unordered_map<std::string, size_t> round_robin_;
+};
+
+/**
+ * @brief Chooses the order in which Occupy asks its candidate assets
+ *
+ * Occupy requests the first ranked asset and only moves on to the next one when a
+ * station refuses. The default "first_response" behaviour (ask all, keep the first
+ * grant) has no policy object.
+ */
+class OccupySelectionPolicy
+{
+public:
+    virtual ~OccupySelectionPolicy() = default;
+
+    virtual std::string name() const = 0;
+    virtual std::vector<std::string> rank(const std::vector<std::string> &candidates,
+                                          StationLoadTracker &tracker) = 0;
+
+    /// @brief Occupy sent its request to asset_id, the next one in rank() order
+    virtual void onRequested(const std::string &asset_id) {}
+    /// @brief asset_id refused the request or never answered it
+    virtual void onRefused(const std::string &asset_id) {}
+
+    /**
+     * @brief Build a policy by name: "least_queued", "round_robin", "earliest_completion"
+     *        or "shortest_expected_completion"
+     * @return nullptr for "first_response" and for unknown names (logged)
+     */
+    static std::unique_ptr<OccupySelectionPolicy> create(const std::string &policy_name);
+
+    /// @brief Stations that are stopped, aborted, held or suspended will not grant soon
+    static bool acceptsWork(const std::optional<StationLoad> &load);
+};
+
+/// @brief Fewest occupants queued first; ties keep the Assets order
+class LeastQueuedPolicy : public OccupySelectionPolicy
+{
+public:
+    std::string name() const override { return "least_queued"; }
+    std::vector<std::string> rank(const std::vector<std::string> &candidates,
+                                  StationLoadTracker &tracker) override;
+};
+
+/// @brief Rotates the starting asset per request across all Occupy nodes with the same Assets
+class RoundRobinPolicy : public OccupySelectionPolicy
+{
+public:
+    std::string name() const override { return "round_robin"; }
+    std::vector<std::string> rank(const std::vector<std::string> &candidates,
+                                  StationLoadTracker &tracker) override;
+};
+
+/// @brief Smallest queue depth times observed service time first; faster stations may take longer queues
+class EarliestCompletionPolicy : public OccupySelectionPolicy
+{
+public:
+    std::string name() const override { return "earliest_completion"; }
+    std::vector<std::string> rank(const std::vector<std::string> &candidates,
+                                  StationLoadTracker &tracker) override;
+};
+
+/**
+ * @brief Asks the AssignmentScheduler, which also counts the requests other Occupy nodes
+ *        just made and the shuttle's travel to each station
+ *
+ * The request stays assigned to the asset until it refuses, its State telemetry shows it
+ * or the policy is dropped at the end of the occupation.
+ */
+class ShortestExpectedCompletionPolicy : public OccupySelectionPolicy
+{
+public:
+    ~ShortestExpectedCompletionPolicy() override;
+
+    std::string name() const override { return "shortest_expected_completion"; }
+    std::vector<std::string> rank(const std::vector<std::string> &candidates,
+                                  StationLoadTracker &tracker) override;
+    void onRequested(const std::string &asset_id) override;
+    void onRefused(const std::string &asset_id) override;
+
+private:
+    std::string assigned_asset_;
+    uint64_t ticket_ = 0;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "bt/decorators/occupy.h"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Occupations queued by PrefetchOccupy nodes and not yet taken over by an Occupy
+ *
+ * Keyed by the occupation UUID. An entry leaves the registry exactly once: adopted by
+ * the Occupy that uses its UUID, or withdrawn by its PrefetchOccupy, which then
+ * releases the stations.
+ */
+class PrefetchedOccupations
+{
+public:
+    struct Entry
+    {
+        std::set<std::string> requested;              // Assets that got an occupy request
+        std::unordered_set<std::string> pending;      // Assets that have not answered yet
+        std::string selected;                         // Granting asset, empty while queued
+        std::chrono::steady_clock::time_point granted_time;
+    };
+
+    static PrefetchedOccupations &instance();
+
+    void offer(const std::string &uuid, Entry entry);
+
+    /// @brief Run update on the entry under the registry lock; false if it is no longer offered
+    bool updateIfOffered(const std::string &uuid, const std::function<void(Entry &)> &update);
+
+    /// @brief Remove the entry if its requested assets are all among the adopter's assets
+    std::optional<Entry> adopt(const std::string &uuid, const std::vector<std::string> &adopter_assets);
+
+    /// @brief Remove the entry; true if it was still offered, i.e. the caller must release it
+    bool withdraw(const std::string &uuid);
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+/**
+ * @brief Queues at the next station while the steps before it are still running
+ *
+ * Sends the occupy requests for `Assets` as soon as it starts and ticks its child right
+ * away instead of waiting for a grant. The occupation UUID is written to the `Uuid`
+ * output; an Occupy inside the child with the same Assets and that UUID as input adopts
+ * the occupation rather than queueing from scratch:
+ *
+ *   <PrefetchOccupy Assets="{FillingStations}" Uuid="{NextUuid}">
+ *     <Sequence>
+ *       <Occupy Assets="{DispensingStations}"> ... </Occupy>
+ *       <Occupy Assets="{FillingStations}" Uuid="{NextUuid}"> ... </Occupy>
+ *     </Sequence>
+ *   </PrefetchOccupy>
+ *
+ * If the child finishes or the node is halted before the occupation was adopted, every
+ * requested station is released. The child's status is returned unchanged.
+ */
+class PrefetchOccupy : public Occupy
+{
+public:
+    PrefetchOccupy(
+        const std::string &name,
+        const BT::NodeConfig &config,
+        MqttClient &mqtt_client,
+        AASClient &aas_client)
+        : Occupy(name, config, mqtt_client, aas_client)
+    {
+    }
+
+    void callback(const std::string &topic_key, const json &msg, mqtt::properties props) override;
+
+    BT::NodeStatus tick() override;
+    void halt() override;
+
+    static BT::PortsList providedPorts();
+
+private:
+    bool prefetching_ = false;
+    // An unanswered prefetch request only matters once adopted; the Occupy times it then
+    bool usesCommandDeadlines() const override { return false; }
+
+    PrefetchedOccupations::Entry snapshot() const;
+    void releaseUnadopted();
+};
@@ -2,6 +2,7 @@
 
 #include <behaviortree_cpp/bt_factory.h>
 #include <behaviortree_cpp/decorator_node.h>
+#include "bt/product_queue.h"
 #include <string>
 
 /**
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <behaviortree_cpp/bt_factory.h>
+
+namespace BT
+{
+    class Groot2Publisher;
+}
+
+namespace bt_utils
+{
+    struct Groot2MonitorConfig;
+}
+
+/**
+ * @brief Groot2 server for one tree, fed either on every status change or by snapshots
+ *
+ * "stock" is BT::Groot2Publisher as is: its logger callback runs on the tick thread for
+ * every status change of every node. "throttled" turns that callback off; a background
+ * thread reads each node's status every snapshot_interval_ms and hands only the ones that
+ * changed to the publisher, whose server thread answers Groot2 from that buffer. Ticks
+ * then cost the same with Groot2 attached or not, at the price of not showing transitions
+ * shorter than the interval. Breakpoints and the tree view are unaffected.
+ *
+ * Must be destroyed before the tree it monitors.
+ */
+class Groot2Monitor
+{
+public:
+    enum class Mode
+    {
+        Stock,
+        Throttled
+    };
+
+    Groot2Monitor(const BT::Tree &tree, unsigned port, const bt_utils::Groot2MonitorConfig &config);
+    ~Groot2Monitor();
+
+    Groot2Monitor(const Groot2Monitor &) = delete;
+    Groot2Monitor &operator=(const Groot2Monitor &) = delete;
+
+    Mode mode() const { return mode_; }
+
+    static std::optional<Mode> parseMode(const std::string &name);
+
+private:
+    struct SampledNode
+    {
+        const BT::TreeNode *node;
+        BT::NodeStatus last; // As last handed to the publisher
+    };
+
+    void samplerLoop();
+    void sample();
+
+    std::unique_ptr<BT::Groot2Publisher> publisher_;
+    Mode mode_ = Mode::Stock;
+    std::chrono::milliseconds interval_;
+    std::vector<SampledNode> nodes_; // Only touched by the sampler thread once it runs
+
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_ = false; // Guarded by mutex_
+    std::thread sampler_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <future>
+
+/**
+ * @brief Background lazy initialization for MQTT nodes
+ *
+ * A node whose topics were not resolved at construction resolves them on its
+ * first tick. poll() runs that work (AAS lookups, late subscription) on a
+ * separate thread and only reports progress to the tick thread, which returns
+ * RUNNING meanwhile instead of blocking the whole tree on network I/O.
+ */
+class LazyNodeInit
+{
+public:
+    enum class Status
+    {
+        Ready,
+        Pending,
+        Failed
+    };
+
+    LazyNodeInit() = default;
+    LazyNodeInit(const LazyNodeInit &) = delete;
+    LazyNodeInit &operator=(const LazyNodeInit &) = delete;
+    ~LazyNodeInit();
+
+    /**
+     * @brief Start an attempt if none is running, otherwise check on it
+     * @param work Runs on the background thread; returns true once the node is usable
+     * @param on_done Runs on the background thread after work, e.g. to wake the tree
+     * @return Pending while the attempt runs, then its result once. A failed attempt is
+     *         forgotten, so the next poll() starts a new one.
+     */
+    Status poll(const std::function<bool()> &work, const std::function<void()> &on_done);
+
+    bool inProgress() const { return future_.valid(); }
+
+    /// @brief Block until a running attempt has finished; node destructors call this first
+    void wait();
+
+private:
+    std::future<bool> future_;
+};
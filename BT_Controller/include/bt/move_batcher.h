@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "utils.h"
+#include "bt/sim_clock.h"
+#include "mqtt/mqtt_pub_base.h"
+
+class MqttClient;
+class AASClient;
+
+/**
+ * @brief Collects the xbot moves issued close together into one planner command
+ *
+ * MoveToPosition nodes hand their command here instead of publishing it. The moves
+ * collected during one controller loop (window_ms 0) or within window_ms of the first
+ * one go out together as a single {"Moves": [{"Xbot", "Position", "Uuid"}, ...]} command
+ * on the BatchMotion interface of the planner's AAS, resolved through the interface cache
+ * on the first batch, so it can plan the shuttles jointly and start them at once. A move
+ * that ends up alone, or every move if the planner has no BatchMotion, is sent on its
+ * xbot's own command topic as before. Both go through MqttPubBase::publish like a node's
+ * commands, so they carry the trace context and use the topic's encoding.
+ *
+ * Completions are not handled here: the planner answers every move on its xbot's
+ * response topic with the move's Uuid, where the originating node already listens.
+ *
+ * enqueue() and withdraw() may be called from any ticking thread; flush() runs on the
+ * controller thread after the trees have been ticked.
+ */
+class MoveBatcher : private MqttPubBase
+{
+public:
+    using Clock = SimClock;
+
+    MoveBatcher(MqttClient &mqtt_client, AASClient &aas_client, const bt_utils::MoveBatchConfig &config);
+
+    /// @brief The batcher moves hand their commands to, null when batching is off
+    static void install(MoveBatcher *batcher);
+    static MoveBatcher *installed() { return batcher_.load(std::memory_order_acquire); }
+
+    /// @brief Queue a move for the next batch; xbot_topic is the xbot's own command topic
+    void enqueue(const mqtt_utils::Topic &xbot_topic, nlohmann::json position, const std::string &uuid);
+
+    /// @brief Drop a move not sent yet (its node was halted); false if already published
+    bool withdraw(const std::string &uuid);
+
+    /// @brief Publish the collected moves once their window has passed; returns how many
+    size_t flush(Clock::time_point now = Clock::now());
+
+    /// @brief Time until flush() has moves to publish, at most cap
+    std::chrono::milliseconds untilFlush(std::chrono::milliseconds cap) const;
+
+private:
+    struct Move
+    {
+        mqtt_utils::Topic xbot_topic;
+        nlohmann::json position;
+        std::string uuid;
+    };
+
+    AASClient &aas_client_;
+    const bt_utils::MoveBatchConfig config_;
+    bool batch_topic_resolved_ = false; // Tried once; flush() alone touches it and the topics
+    bool has_batch_topic_ = false;
+
+    mutable std::mutex mutex_;
+    std::vector<Move> pending_;
+    Clock::time_point window_end_{};
+
+    static std::atomic<MoveBatcher *> batcher_;
+
+    // Name of the xbot in its command topic, e.g. "Xbot1" for .../Planar/Xbot1/CMD/XYMotion
+    static std::string xbotName(const std::string &topic);
+    bool resolveBatchTopic();
+    void publishSingle(const Move &move);
+    void publishBatch(const std::vector<Move> &moves);
+};
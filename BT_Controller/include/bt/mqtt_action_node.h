@@ -7,19 +7,35 @@
 #include "mqtt/mqtt_pub_base.h"
 #include "mqtt/node_message_distributor.h"
 #include "aas/aas_client.h"
+#include "bt/lazy_node_init.h"
+#include "bt/command_deadlines.h"
 #include <map>
+#include <chrono>
 
 class MqttActionNode : public BT::StatefulActionNode, public MqttPubBase, public MqttSubBase
 {
 protected:
     std::string current_uuid_;
+    std::chrono::steady_clock::time_point command_sent_time_; // For the "action_response" histogram
 
     AASClient &aas_client_;
     bool topics_initialized_ = false;
+    LazyNodeInit lazy_init_;
+    bool awaiting_lazy_init_ = false; // onStart() returned RUNNING while lazy init runs
+
+    // Ack deadline until the first response to current_uuid_, then the completion deadline;
+    // guarded by mutex_
+    CommandDeadline deadline_;
+    bool acknowledged_ = false;
+    void armCommandDeadline();
+    void onCommandDeadline();
+
+    /// @brief State update for a response carrying current_uuid_; caller holds mutex_
+    void handleCommandResponse(const nlohmann::json &msg);
 
     /// @brief Called from tick() to perform lazy initialization if needed
-    /// @return true if initialization is complete, false if still pending
-    bool ensureInitialized();
+    /// @return Ready once topics are configured, Pending while the background attempt runs
+    LazyNodeInit::Status ensureInitialized();
 
 public:
     MqttActionNode(const std::string &name,
@@ -37,7 +53,13 @@ public:
 
     // Mqtt AAS Stuff
     virtual void initializeTopicsFromAAS() {};
+    bool refreshTopicsFromAAS() override;
     virtual nlohmann::json createMessage();
+    // Send the command on "input" when the node starts. The default publishes createMessage();
+    // nodes sending the same message shape every time override it to publish a MessageTemplate.
+    virtual void publishCommand();
+    // Send the current command again after its ack deadline passed, under the same Uuid
+    virtual void resendCommand() { publishCommand(); }
     virtual void callback(const std::string &topic_key, const nlohmann::json &msg, mqtt::properties props) override;
     // BT Stuff
     static BT::PortsList providedPorts() { return {}; };
@@ -8,16 +8,19 @@
 #include <fmt/chrono.h>
 #include <chrono>
 #include <utils.h>
+#include "bt/lazy_node_init.h"
 
 class MqttDecorator : public BT::DecoratorNode, public MqttPubBase, public MqttSubBase
 {
 protected:
     AASClient &aas_client_;
     bool topics_initialized_ = false;
+    LazyNodeInit lazy_init_;
+    bool resumed_from_lazy_init_ = false; // Set on the tick that completes a pending lazy init; treat like IDLE
 
     /// @brief Called from tick() to perform lazy initialization if needed
-    /// @return true if initialization is complete, false if still pending
-    bool ensureInitialized();
+    /// @return Ready once topics are configured, Pending while the background attempt runs
+    LazyNodeInit::Status ensureInitialized();
 
 public:
     MqttDecorator(
@@ -31,6 +34,7 @@ public:
 
     // Mqtt AAS Stuff
     virtual void initializeTopicsFromAAS();
+    bool refreshTopicsFromAAS() override;
     virtual void callback(const std::string &topic_key, const nlohmann::json &msg, mqtt::properties props) override;
     // BT Stuff
     static BT::PortsList providedPorts();
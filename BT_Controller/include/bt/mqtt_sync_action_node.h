@@ -5,19 +5,23 @@
 #include "mqtt/mqtt_pub_base.h"
 #include <nlohmann/json.hpp>
 #include "aas/aas_client.h"
+#include "bt/lazy_node_init.h"
 #include "mqtt/node_message_distributor.h"
 
-class MqttSyncActionNode : public BT::SyncActionNode, public MqttPubBase, public MqttSubBase
+// Derives from ActionNodeBase rather than SyncActionNode: the node completes in one
+// tick once initialized, but returns RUNNING while lazy initialization is pending.
+class MqttSyncActionNode : public BT::ActionNodeBase, public MqttPubBase, public MqttSubBase
 {
 protected:
     std::string current_uuid_;
 
     AASClient &aas_client_;
     bool topics_initialized_ = false;
+    LazyNodeInit lazy_init_;
 
     /// @brief Called from tick() to perform lazy initialization if needed
-    /// @return true if initialization is complete, false if still pending
-    bool ensureInitialized();
+    /// @return Ready once topics are configured, Pending while the background attempt runs
+    LazyNodeInit::Status ensureInitialized();
 
 public:
     MqttSyncActionNode(
@@ -30,11 +34,13 @@ public:
 
     // Mqtt AAS Stuff
     virtual void initializeTopicsFromAAS();
+    bool refreshTopicsFromAAS() override;
     virtual json createMessage();
     virtual void callback(const std::string &topic_key, const json &msg, mqtt::properties props) override;
     // BT Stuff
     static BT::PortsList providedPorts();
     BT::NodeStatus tick() override;
+    void halt() override { resetStatus(); }
 
     template <typename DerivedNode>
     static void registerNodeType(
@@ -7,6 +7,7 @@
 #include "mqtt/node_message_distributor.h"
 #include "utils.h"
 #include "aas/aas_client.h"
+#include "bt/lazy_node_init.h"
 
 class MqttSyncConditionNode : public BT::ConditionNode, public MqttSubBase
 {
@@ -14,10 +15,11 @@ protected:
     json latest_msg_;
     AASClient &aas_client_;
     bool topics_initialized_ = false;
+    LazyNodeInit lazy_init_;
 
     /// @brief Called from tick() to perform lazy initialization if needed
-    /// @return true if initialization is complete, false if still pending
-    bool ensureInitialized();
+    /// @return Ready once topics are configured, Pending while the background attempt runs
+    LazyNodeInit::Status ensureInitialized();
 
 public:
     MqttSyncConditionNode(const std::string &name,
@@ -35,6 +37,7 @@ public:
 
     virtual BT::NodeStatus tick() override;
     virtual void initializeTopicsFromAAS();
+    bool refreshTopicsFromAAS() override;
     template <typename DerivedNode>
     static void registerNodeType(
         BT::BehaviorTreeFactory &factory,
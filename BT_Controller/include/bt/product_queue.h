@@ -0,0 +1,48 @@
+#pragma once
+
+#include <behaviortree_cpp/basic_types.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Product IDs of one batch, drawn from by any number of branches without a lock
+ *
+ * Configure creates the batch whole and IDs are only taken from it afterwards, so the IDs
+ * sit in an immutable array behind a single atomic cursor: pop() is one fetch-add,
+ * reserve() one compare-exchange, peek() and size() one load. The blackboard entry only
+ * holds the shared pointer: nodes copy it with getInput() instead of keeping the entry
+ * locked while they work on the queue.
+ */
+class ProductQueue
+{
+public:
+    explicit ProductQueue(std::vector<std::string> ids);
+
+    /// @brief Take the next ID; false once the batch is used up
+    bool pop(std::string &id);
+
+    /// @brief Take up to count IDs in one step, fewer when the batch has fewer left
+    std::vector<std::string> reserve(size_t count);
+
+    /// @brief Next ID without taking it, null when empty; valid as long as the queue
+    const std::string *peek() const;
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    size_t batchSize() const { return ids_.size(); }
+
+private:
+    const std::vector<std::string> ids_;
+    std::atomic<size_t> next_{0};
+};
+
+using ProductQueuePtr = std::shared_ptr<ProductQueue>;
+
+namespace BT
+{
+    // Literal batches in XML, e.g. Queue="ProductA;ProductB;ProductC"
+    template <>
+    ProductQueuePtr convertFromString<ProductQueuePtr>(StringView str);
+}
@@ -20,8 +20,11 @@
 #include "bt/decorators/get_product_from_queue_node.h"
 #include "bt/decorators/keep_running_until_empty.h"
 #include "bt/decorators/occupy.h"
+#include "bt/decorators/prefetch_occupy.h"
 #include "bt/decorators/sampling_gate.h"
 #include "bt/controls/bc_fallback_node.h"
+#include "bt/controls/concurrent_parallel_node.h"
+#include "bt/controls/pipelined_batch_node.h"
 void registerAllNodes(
     BT::BehaviorTreeFactory &factory,
     NodeMessageDistributor &node_message_distributor,
@@ -41,6 +44,11 @@ void registerAllNodes(
         aas_client,
         "Retrieve_AAS_Property");
 
+    RetrieveAASPropertyNode::registerNodeType<RetrieveAASPropertiesNode>(
+        factory,
+        aas_client,
+        "Retrieve_AAS_Properties");
+
     MqttActionNode::registerNodeType<CommandExecuteNode>(
         factory,
         node_message_distributor,
@@ -81,6 +89,13 @@ void registerAllNodes(
         aas_client,
         "Occupy");
 
+    MqttDecorator::registerNodeType<PrefetchOccupy>(
+        factory,
+        node_message_distributor,
+        mqtt_client,
+        aas_client,
+        "PrefetchOccupy");
+
     MqttDecorator::registerNodeType<KeepRunningUntilEmpty>(
         factory,
         node_message_distributor,
@@ -99,4 +114,7 @@ void registerAllNodes(
 
     factory.registerNodeType<BT::BC_FallbackNode>("BC_Fallback");
     factory.registerNodeType<BT::BC_FallbackNode>("BC_Fallback_Async", true);
+
+    factory.registerNodeType<BT::ConcurrentParallelNode>("Parallel_Concurrent");
+    factory.registerNodeType<BT::PipelinedBatchNode>("PipelinedBatch");
 }
\ No newline at end of file
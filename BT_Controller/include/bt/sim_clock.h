@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace bt_utils
+{
+    struct SimClockConfig;
+}
+
+/**
+ * @brief Line time for the controller and its nodes, optionally running faster than real time
+ *
+ * Everything that times the line rather than the process reads this clock: command
+ * deadlines, move batch windows, condition timeouts, station service times and the
+ * TimeStamp of published messages. Its time points are steady_clock ones, so they mix
+ * with existing members, and in "wall" mode now() is steady_clock::now().
+ *
+ * "scaled" runs speed virtual seconds per wall second from configure(). "driven" follows
+ * the clock messages of the simulated stations (PackML_Stations/sim_clock.py), advancing
+ * at the speed they report in between; it never goes backwards, so a late message holds
+ * the clock until the simulator catches up. Message timestamps take the simulator's date.
+ *
+ * Real waits (the controller's idle sleep) take toWall() of a virtual timeout. Latency
+ * metrics, traces and network timeouts stay on wall time.
+ */
+class SimClock
+{
+public:
+    using duration = std::chrono::steady_clock::duration;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::steady_clock::time_point;
+    static constexpr bool is_steady = true;
+
+    enum class Mode
+    {
+        Wall,
+        Scaled,
+        Driven
+    };
+
+    static time_point now();
+
+    /// @brief now() as a date, for timestamps
+    static std::chrono::system_clock::time_point systemNow();
+
+    /// @brief Wall time a virtual timeout takes at the current speed, rounded up
+    static std::chrono::milliseconds toWall(std::chrono::milliseconds virtual_timeout);
+
+    static Mode mode() { return mode_.load(std::memory_order_acquire); }
+    static bool isVirtual() { return mode() != Mode::Wall; }
+    static double speed();
+
+    /// @brief Switch to the configured mode; call before any tree runs
+    static void configure(const bt_utils::SimClockConfig &config);
+
+    /// @brief Follow a simulator clock message {"SimTime": epoch seconds, "Speed"}; false if it is not one
+    static bool sync(const nlohmann::json &clock_message);
+    static void sync(std::chrono::system_clock::time_point sim_time, double speed);
+
+    static std::optional<Mode> parseMode(const std::string &name);
+    static const char *modeName(Mode mode);
+
+private:
+    // now() = virtual_start + (steady_clock::now() - wall_start) * speed
+    struct Anchor
+    {
+        time_point wall_start;
+        time_point virtual_start;
+        double speed = 1.0;
+    };
+
+    static std::atomic<Mode> mode_;
+    static std::mutex mutex_;
+    static Anchor anchor_;
+    static bool synced_;
+    static std::atomic<rep> latest_;                    // Largest time handed out, for monotonicity
+    static std::atomic<std::chrono::system_clock::rep> date_offset_; // systemNow() - now()
+
+    static time_point virtualNow(const Anchor &anchor, time_point wall_now);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Process-wide work-stealing pool for ticking tree branches concurrently
+ *
+ * run() spreads a batch of tasks over per-worker deques; each worker drains its own
+ * deque from the front and steals from the back of the others when it runs dry. The
+ * calling thread takes part, so a pool with zero workers runs the batch inline.
+ * Batches from different callers (e.g. nested parallel nodes) may overlap.
+ */
+class TickPool
+{
+public:
+    static TickPool &instance();
+
+    /// @brief Set the number of worker threads; call before any tree is ticked
+    void configure(size_t workers);
+    size_t workerCount() const;
+
+    /// @brief Call task(i) for every i in [0, count) and return when all calls are done
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+    ~TickPool();
+
+private:
+    TickPool() = default;
+
+    struct Batch
+    {
+        const std::function<void(size_t)> *task = nullptr;
+        std::atomic<size_t> remaining{0};
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    struct Task
+    {
+        std::shared_ptr<Batch> batch;
+        size_t index;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    bool popOwn(size_t worker, Task &task);
+    bool steal(size_t thief, Task &task);
+    void execute(Task &task);
+    void workerLoop(size_t worker);
+    void stopWorkers();
+
+    mutable std::mutex config_mutex_; // Serializes configure() calls
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    size_t pending_ = 0; // Tasks queued across all workers, guarded by wake_mutex_
+    bool stopping_ = false;
+};
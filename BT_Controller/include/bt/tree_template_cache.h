@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <behaviortree_cpp/bt_factory.h>
+#include <behaviortree_cpp/xml_parsing.h>
+
+/**
+ * @brief Fetched BT descriptions and their parsed documents, keyed by URL
+ *
+ * Each use revalidates the description with If-None-Match/If-Modified-Since; a 304
+ * (or an unchanged body) reuses the parsed document, so repeated Starts neither
+ * download nor re-parse the XML and only instantiate it. When the server cannot be
+ * reached the cached copy is used.
+ *
+ * Templates are kept as one parser per description rather than registered in the
+ * factory: trees hosted side by side may use the same BehaviorTree IDs, which would
+ * overwrite each other in the factory's single registry. A parsed document refers to
+ * the factory it was parsed against, so call dropParsed() whenever that factory is
+ * replaced.
+ */
+class TreeTemplateCache
+{
+public:
+    /**
+     * @brief Fetch or revalidate a description and return its parsed document
+     * @return nullptr if the description could neither be fetched nor taken from the cache
+     * @throws BT::RuntimeError if the XML does not parse against factory
+     */
+    std::shared_ptr<BT::XMLParser> load(const std::string &url, const BT::BehaviorTreeFactory &factory);
+
+    /// @brief Forget parsed documents but keep the XML and its validators
+    void dropParsed();
+
+private:
+    struct Entry
+    {
+        std::string xml;
+        std::string etag;
+        std::string last_modified;
+        std::shared_ptr<BT::XMLParser> parsed;
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
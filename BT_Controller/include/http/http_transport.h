@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <array>
+#include <curl/curl.h>
+
+/**
+ * @brief Result of an HTTP request made through HttpTransport
+ */
+struct HttpResponse
+{
+    CURLcode curl_code = CURLE_OK;
+    long status = 0;
+    std::string body;
+    std::map<std::string, std::string> headers; // Lower-case header name -> value
+
+    bool ok() const { return curl_code == CURLE_OK && status == 200; }
+    std::string error() const { return curl_easy_strerror(curl_code); }
+};
+
+/**
+ * @brief Process-wide HTTP transport shared by AASClient and schema_utils
+ *
+ * Keeps a pool of CURL easy handles attached to one share handle, so DNS
+ * lookups, TLS sessions and open connections are reused across requests and
+ * threads. Each request blocks its calling thread on one connection of its own;
+ * concurrent requests to a host open separate connections rather than sharing
+ * one. Responses are requested compressed.
+ */
+class HttpTransport
+{
+public:
+    static HttpTransport &instance();
+
+    HttpTransport(const HttpTransport &) = delete;
+    HttpTransport &operator=(const HttpTransport &) = delete;
+
+    /**
+     * @brief Perform a blocking GET request; safe to call from any thread
+     * @param url Absolute URL
+     * @param headers Extra request headers ("Name: value")
+     * @param timeout_seconds Total request timeout
+     */
+    HttpResponse get(const std::string &url,
+                     const std::vector<std::string> &headers = {},
+                     long timeout_seconds = 10);
+
+    /**
+     * @brief GET with "Accept: application/json", using a header list built once
+     */
+    HttpResponse getJson(const std::string &url, long timeout_seconds = 10);
+
+private:
+    HttpResponse perform(const std::string &url, const curl_slist *header_list, long timeout_seconds);
+
+    HttpTransport();
+    ~HttpTransport();
+
+    CURL *acquireHandle();
+    void releaseHandle(CURL *handle);
+
+    static void lockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+    static void unlockShare(CURL *handle, curl_lock_data data, void *userptr);
+
+    CURLSH *share_;
+    curl_slist *json_headers_; // Read-only after construction, safe to share between handles
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> share_mutexes_;
+
+    std::mutex pool_mutex_;
+    std::vector<CURL *> idle_handles_;
+    static constexpr size_t kMaxIdleHandles = 16;
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Lowest level compiled in (0 = trace ... 4 = error); statements below it are removed entirely
+#ifndef BT_LOG_ACTIVE_LEVEL
+#define BT_LOG_ACTIVE_LEVEL 0
+#endif
+
+namespace logging
+{
+    enum class Level : uint8_t
+    {
+        Trace,
+        Debug,
+        Info,
+        Warn, // Warn and Error go to stderr, the rest to stdout
+        Error,
+        Off
+    };
+
+    // "trace", "debug", "info", "warn", "error" or "off"
+    std::optional<Level> parseLevel(const std::string &name);
+
+    // Runtime threshold, info by default; may be changed at any time
+    void setLevel(Level level);
+
+    namespace detail
+    {
+        extern std::atomic<Level> runtime_level;
+    }
+
+    inline bool enabled(Level level)
+    {
+        return static_cast<int>(level) + 1 > BT_LOG_ACTIVE_LEVEL &&
+               level >= detail::runtime_level.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Wait until every line logged so far is written
+    void flush();
+
+    struct Stats
+    {
+        uint64_t written = 0;
+        uint64_t dropped = 0; // Lost because the ring was full
+    };
+    Stats stats();
+
+    /**
+     * @brief One log statement, formatted into a fixed stack buffer
+     *
+     * The destructor hands the line to a bounded lock-free ring buffer; a background thread
+     * prefixes the time (cached per second), writes and flushes in batches. Logging therefore
+     * never takes a lock, allocates or waits for the terminal. If the ring is full the line
+     * is dropped and counted. Lines longer than the buffer are truncated.
+     */
+    class Line
+    {
+    public:
+        static constexpr size_t kCapacity = 480;
+
+        explicit Line(Level level)
+            : level_(level), time_(std::chrono::system_clock::now())
+        {
+        }
+        ~Line();
+
+        Line(const Line &) = delete;
+        Line &operator=(const Line &) = delete;
+
+        Line &operator<<(std::string_view text)
+        {
+            append(text.data(), text.size());
+            return *this;
+        }
+        Line &operator<<(const std::string &text) { return *this << std::string_view(text); }
+        Line &operator<<(const char *text) { return *this << std::string_view(text ? text : "(null)"); }
+        Line &operator<<(char c)
+        {
+            append(&c, 1);
+            return *this;
+        }
+        Line &operator<<(bool value) { return *this << (value ? std::string_view("1") : std::string_view("0")); }
+
+        template <typename T>
+            requires(std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>)
+        Line &operator<<(T value)
+        {
+            char buffer[32];
+            auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            if (ec == std::errc())
+            {
+                append(buffer, static_cast<size_t>(end - buffer));
+            }
+            return *this;
+        }
+
+        // Anything else with an ostream operator (enums, json, durations); off the fast path
+        template <typename T>
+            requires(!std::is_arithmetic_v<T> && !std::convertible_to<const T &, std::string_view> &&
+                     requires(std::ostream &os, const T &v) { os << v; })
+        Line &operator<<(const T &value)
+        {
+            std::ostringstream oss;
+            oss << value;
+            return *this << oss.str();
+        }
+
+    private:
+        void append(const char *data, size_t size);
+
+        Level level_;
+        std::chrono::system_clock::time_point time_;
+        size_t length_ = 0;
+        bool truncated_ = false;
+        char buffer_[kCapacity];
+    };
+}
+
+// BT_LOG_INFO << "Node '" << name() << "' started";  No trailing std::endl; the line ends with the statement.
+#define BT_LOG(level)                                 \
+    if (!::logging::enabled(::logging::Level::level)) \
+    {                                                 \
+    }                                                 \
+    else                                              \
+        ::logging::Line(::logging::Level::level)
+
+#define BT_LOG_TRACE BT_LOG(Trace)
+#define BT_LOG_DEBUG BT_LOG(Debug)
+#define BT_LOG_INFO BT_LOG(Info)
+#define BT_LOG_WARN BT_LOG(Warn)
+#define BT_LOG_ERROR BT_LOG(Error)
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace mqtt
+{
+    struct properties;
+}
+
+/**
+ * @brief End-to-end timing of node commands across broker, station queue and actuation
+ *
+ * With tracing on, every node publish carries a trace context as MQTT v5 user properties:
+ * trace-id and trace-sent (wall clock, ms since epoch). Stations echo both on the DATA
+ * responses to that command and add trace-received, trace-started and trace-completed.
+ * MQTT 3.1.1 stations (the ESP32s) never see user properties, so "payload" mode also puts
+ * the context into JSON commands as "Trace": {"Id", "Sent"}; those stations answer with
+ * "Trace": {"Id", "Sent", "Received", "Started", "Completed"}.
+ *
+ * record() turns a final response (one with a completion time) into latency histograms
+ * named by BT node: "trace_to_station" (broker and WiFi), "trace_station_queue",
+ * "trace_actuation", "trace_to_controller" and "trace_total". Hops between controller and
+ * station clocks are only as accurate as NTP keeps them; negative ones count as zero.
+ */
+class CommandTrace
+{
+public:
+    enum class Mode
+    {
+        Off,
+        Properties, // User properties only
+        Payload     // User properties, and "Trace" in JSON payloads
+    };
+
+    struct Context
+    {
+        std::string id;
+        int64_t sent_ms = 0;
+    };
+
+    static void configure(const std::string &mode);
+    static Mode mode() { return mode_.load(std::memory_order_relaxed); }
+    static bool enabled() { return mode() != Mode::Off; }
+
+    /// @brief Start a trace for an outgoing publish and add its user properties to props
+    static Context begin(mqtt::properties &props);
+
+    /// @brief Add "Trace" to a JSON object, as text or as a value; other payloads are left alone
+    static void embed(std::string &json_text, const Context &context);
+    static void embed(nlohmann::json &payload, const Context &context);
+
+    /// @brief Record the hops of a traced final response under name; false if msg is none
+    static bool record(const std::string &name, const nlohmann::json &msg, const mqtt::properties &props);
+
+    static std::optional<Mode> parseMode(const std::string &name);
+
+private:
+    static std::atomic<Mode> mode_;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Lock-free log-linear latency histogram (HDR-style)
+ *
+ * Values are recorded in microseconds into buckets that are linear within each
+ * power of two (16 sub-buckets, ~6% relative error), so percentiles stay accurate
+ * from microseconds up to hours with a fixed 528-bucket array. record() is a few
+ * relaxed atomic increments and can be called from any thread.
+ */
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        uint64_t count = 0;
+        double mean_ms = 0.0;
+        double p50_ms = 0.0;
+        double p90_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+    };
+
+    void record(std::chrono::steady_clock::duration latency);
+
+    /**
+     * @brief Compute count, mean and percentiles over the recorded values
+     * @param reset Start a new window: counts are taken and zeroed atomically per bucket
+     */
+    Summary summarize(bool reset = false);
+
+private:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 35; // ~9.5 hours in microseconds; larger values are clamped
+    static constexpr size_t kBucketCount = (kMaxMagnitude - kSubBucketBits + 1) * kSubBucketCount + kSubBucketCount;
+
+    static size_t bucketIndex(uint64_t value_us);
+    static double bucketMidpointMs(size_t index);
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> total_count_{0};
+    std::atomic<uint64_t> total_us_{0};
+    std::atomic<uint64_t> max_us_{0};
+};
+
+/**
+ * @brief Process-wide registry of latency histograms keyed by category and name
+ *
+ * Categories used by the controller: "tick" (tree name), "action_response" and
+ * "occupy_wait" (BT node name), "dispatch" (MQTT topic) and, with command tracing on,
+ * the "trace_*" hops of CommandTrace (BT node name). Looking a histogram up
+ * takes a shared lock; recording into it takes none, so hot paths may keep the
+ * returned reference, which stays valid for the life of the process.
+ */
+class LatencyMetrics
+{
+public:
+    static LatencyMetrics &instance();
+
+    LatencyHistogram &histogram(const std::string &category, const std::string &name);
+
+    void record(const std::string &category, const std::string &name,
+                std::chrono::steady_clock::duration latency)
+    {
+        histogram(category, name).record(latency);
+    }
+
+    /**
+     * @brief Summaries of all histograms as {category: {name: {Count, MeanMs, P50Ms, ...}}}
+     * @param reset Start a new window after reading (the controller publishes per-interval values)
+     */
+    nlohmann::json toJson(bool reset = false);
+
+private:
+    LatencyMetrics() = default;
+
+    std::shared_mutex mutex_;
+    std::map<std::string, std::map<std::string, std::unique_ptr<LatencyHistogram>>> histograms_;
+};
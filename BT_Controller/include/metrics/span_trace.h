@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Process-wide span recorder for one traced phase at a time (the STARTING state)
+ *
+ * begin() opens a session and end() closes it; in between every TraceSpan on any thread
+ * is recorded with its thread, parent (innermost open span on the same thread, otherwise
+ * the session root) and string attributes. Outside a session a TraceSpan costs one relaxed
+ * atomic load, so the HTTP and subscribe paths are instrumented unconditionally.
+ */
+class SpanTrace
+{
+public:
+    enum class Format
+    {
+        Chrome, // Chrome trace event JSON, opens in chrome://tracing and ui.perfetto.dev
+        Otlp    // OTLP/JSON ExportTraceServiceRequest, accepted by OTLP/HTTP collectors
+    };
+
+    static std::optional<Format> parseFormat(const std::string &name);
+
+    struct Span
+    {
+        std::string name;
+        std::string category;
+        uint64_t id = 0;
+        uint64_t parent_id = 0;
+        uint32_t thread = 0; // Small per-session index, 0 = thread that called begin()
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        std::vector<std::pair<std::string, std::string>> attributes;
+    };
+
+    /// @brief Spans of one ended session, root first
+    struct Session
+    {
+        std::vector<Span> spans;
+        std::chrono::system_clock::time_point wall_start; // Wall-clock time of the root's start
+        uint64_t trace_id_high = 0;
+        uint64_t trace_id_low = 0;
+    };
+
+    static SpanTrace &instance();
+
+    bool active() const { return session_id_.load(std::memory_order_relaxed) != 0; }
+
+    /// @brief Start a session; a session still open is discarded
+    void begin(const std::string &name, std::vector<std::pair<std::string, std::string>> attributes = {});
+
+    /**
+     * @brief Close the session and return its spans
+     * @param outcome Stored as the root's "outcome" attribute
+     */
+    Session end(const std::string &outcome);
+
+    static nlohmann::json toJson(const Session &session, Format format);
+
+    /// @brief Write toJson() to path, creating missing directories
+    static bool writeFile(const Session &session, Format format, const std::string &path);
+
+private:
+    friend class TraceSpan;
+
+    SpanTrace() = default;
+
+    void closeSpan(uint64_t session_id, Span &&span);
+
+    std::atomic<uint64_t> next_id_{1};
+    std::atomic<uint64_t> session_id_{0}; // 0 outside a session
+
+    std::mutex mutex_;
+    Session session_;
+    std::vector<std::thread::id> threads_;
+};
+
+/**
+ * @brief RAII span; records from construction to destruction while a session is open
+ *
+ * Spans opened before begin() or closed after end() are not recorded. attr() is a no-op
+ * outside a session, so building attribute values is only paid for while tracing.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *name, const char *category);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    bool recording() const { return session_ != 0; }
+
+    TraceSpan &attr(const char *key, const std::string &value)
+    {
+        if (recording())
+        {
+            span_.attributes.emplace_back(key, value);
+        }
+        return *this;
+    }
+
+private:
+    SpanTrace::Span span_;
+    uint64_t session_ = 0;
+    uint64_t saved_parent_ = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief JSON command serialized once, with a few fields patched in per send
+ *
+ * The constructor dumps the message once with a marker at every field and keeps the
+ * literal text between them. render() copies those pieces and writes only the field
+ * values, so a send builds no nlohmann::json and, rendering into a reused string, does
+ * not allocate once the string has grown to the message size. The output is the same
+ * as dumping the message with the values assigned.
+ */
+class MessageTemplate
+{
+public:
+    // A field value: a string written as a JSON string without building a json, or any JSON value
+    class Value
+    {
+    public:
+        Value(std::string_view text) : text_(text) {}
+        Value(const std::string &text) : text_(text) {}
+        Value(const char *text) : text_(text) {}
+        Value(const nlohmann::json &json) : json_(&json) {}
+
+    private:
+        friend class MessageTemplate;
+        std::string_view text_;
+        const nlohmann::json *json_ = nullptr;
+    };
+
+    MessageTemplate() = default;
+
+    /**
+     * @param message The static part of the command; values at fields are replaced per send
+     * @param fields JSON pointers ("/Uuid", "/Position") of the patched fields, created if missing
+     */
+    MessageTemplate(nlohmann::json message, const std::vector<std::string> &fields);
+
+    bool empty() const { return pieces_.empty(); }
+    size_t fieldCount() const { return field_order_.size(); }
+
+    /// @brief Serialize with values[i] at fields[i]; out is overwritten, its capacity reused
+    void render(std::string &out, std::initializer_list<Value> values) const;
+
+private:
+    // pieces_[0] field pieces_[1] field ... pieces_[n]; field_order_[k] is the index into
+    // fields of the k-th field in the text
+    std::vector<std::string> pieces_;
+    std::vector<size_t> field_order_;
+    size_t literal_size_ = 0;
+
+    static void appendJsonString(std::string &out, std::string_view text);
+};
@@ -2,22 +2,50 @@
 
 #include <mqtt/async_client.h>
 #include <nlohmann/json.hpp>
+#include "mqtt/payload_codec.h"
+#include "utils.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <algorithm>
 using json = nlohmann::json;
 
+class TrafficRecorder;
+
 class MqttClient : public mqtt::async_client, public virtual mqtt::callback
 {
 public:
-    using MessageCallback = std::function<void(const std::string &topic, const json &payload, mqtt::properties props)>;
-
+    // The payload is parsed once; handlers keeping it (queues, caches) share it instead of copying
+    using MessageCallback = std::function<void(const std::string &topic, const std::shared_ptr<const json> &payload,
+                                               mqtt::properties props)>;
+    // nullopt if nobody handles the topic; otherwise the encoding declared for it, used for
+    // messages that arrive without a content-type
+    using TopicRoute = std::function<std::optional<mqtt_utils::PayloadEncoding>(const std::string &topic)>;
+
+    // topic_alias_maximum > 0 enables MQTT v5 topic aliases: up to that many are accepted from
+    // the broker, and up to that many (capped by the broker's CONNACK limit) are allocated
+    // for topics this client publishes repeatedly.
+    // After a connection loss the client reconnects with backoff. With session.resume the
+    // reconnect keeps the broker session (connOpts should carry a session expiry), so only
+    // the subscriptions changed while offline are sent; otherwise all are restored in batches.
+    // Publishes made while offline are queued (up to session.offline_buffer, oldest dropped)
+    // and sent in order once connected, before any newer publish.
     MqttClient(std::string serverURI, std::string client_id,
-               mqtt::connect_options connOpts, int nretry_attempts);
+               mqtt::connect_options connOpts, int nretry_attempts,
+               int topic_alias_maximum = 0,
+               mqtt_utils::SessionConfig session = {});
     virtual ~MqttClient() override;
 
     // --- MQTT Callback Interface (from mqtt::callback) ---
@@ -27,58 +55,147 @@ public:
 
     // --- Topic Subscription Management ---
     mqtt::token_ptr subscribe_topic(const std::string &topic, int qos);
+    // Subscribe to several (topic, qos) pairs with a single SUBSCRIBE packet.
+    // The token's subscribe response carries one reason code per topic, in order.
+    // Callers split larger sets into chunks of kMaxTopicsPerSubscribe to stay well below packet size limits.
+    static constexpr size_t kMaxTopicsPerSubscribe = 128;
+    mqtt::token_ptr subscribe_topics(const std::vector<std::pair<std::string, int>> &topics);
     bool unsubscribe_topic(const std::string &topic);
+    // Send every tracked subscription again, in batches of kMaxTopicsPerSubscribe
     void resubscribe_all_topics();
 
     // --- Message Handling ---
     void set_message_handler(MessageCallback handler) { message_handler_ = std::move(handler); }
 
+    // When set, messages are routed on topic first and the payload is only parsed if the route
+    // has a handler. Payloads are decoded by their MQTT v5 content-type (JSON, CBOR or
+    // MessagePack); without one, by the encoding the route declares, JSON if none is installed
+    void set_topic_route(TopicRoute route) { topic_route_ = std::move(route); }
+
+    // Every received message is also appended to recorder (nullptr stops recording); the
+    // recorder must outlive the client or be removed first
+    void set_recorder(TrafficRecorder *recorder) { recorder_.store(recorder, std::memory_order_release); }
+
     // --- Publishing ---
+    // Binary encodings are sent with their content-type; JSON is sent as before, without one
     bool publish_message(const std::string &topic, const json &payload,
-                         int qos, bool retained = false);
+                         int qos, bool retained = false,
+                         mqtt_utils::PayloadEncoding encoding = mqtt_utils::PayloadEncoding::Json,
+                         mqtt::properties props = {});
+    // Publish an already serialized payload; every node and controller publish goes through
+    // here so topic aliases apply to all of them. While disconnected the message is queued
+    // for the reconnect; returns false if it could be neither sent nor queued.
+    bool publish_payload(const std::string &topic, std::string payload, int qos, bool retained,
+                         mqtt::properties props = {});
+
+    // Publishes dropped because the offline queue was full or disabled
+    uint64_t offline_dropped() const { return offline_dropped_.load(std::memory_order_relaxed); }
 
 private:
-    // --- Action Listener for Subscribe Operations ---
+    // --- Action Listeners for (Un)Subscribe Operations ---
+    // Paho keeps a reference, not ownership: one instance of each serves every request
     class subscription_listener : public virtual mqtt::iaction_listener
     {
-    private:
-        std::string topic_;
-
         void on_failure(const mqtt::token &tok) override;
         void on_success(const mqtt::token &tok) override;
-
-    public:
-        explicit subscription_listener(const std::string &topic)
-            : topic_(topic) {}
     };
 
-    // --- Action Listener for Unsubscribe Operations ---
     class unsubscription_listener : public virtual mqtt::iaction_listener
     {
-    private:
-        std::string topic_;
-
         void on_failure(const mqtt::token &tok) override;
         void on_success(const mqtt::token &tok) override;
-
-    public:
-        explicit unsubscription_listener(const std::string &topic)
-            : topic_(topic) {}
     };
 
+    subscription_listener subscription_listener_;
+    unsubscription_listener unsubscription_listener_;
+
     std::string server_uri_;
     mqtt::connect_options conn_opts_;
     int nretry_attempts_;
     MessageCallback message_handler_ = nullptr;
+    TopicRoute topic_route_ = nullptr;
+    std::atomic<TrafficRecorder *> recorder_{nullptr};
+
+    mqtt_utils::PayloadEncoding payload_encoding(const mqtt::message &msg, mqtt_utils::PayloadEncoding declared) const;
+
+    // --- Topic aliases (MQTT v5) ---
+    // Aliases live for one network connection; both tables are cleared whenever it changes
+    struct OutboundAlias
+    {
+        uint32_t publishes = 0;
+        uint16_t alias = 0;       // 0 = none allocated
+        bool established = false; // The broker has seen topic and alias together
+    };
+    int topic_alias_maximum_;
+    std::atomic<uint16_t> outbound_alias_limit_{0}; // min(own maximum, broker's TOPIC_ALIAS_MAXIMUM)
+    std::mutex alias_mutex_;
+    std::unordered_map<std::string, OutboundAlias> outbound_aliases_;
+    uint16_t next_outbound_alias_ = 1;
+    std::unordered_map<uint16_t, std::string> inbound_aliases_;
+
+    // Topic to send and alias property to add for a publish; empty topic = alias only.
+    // Caller holds alias_mutex_ and, if establishing is set, keeps it until the publish
+    // carrying topic and alias together has been handed to Paho
+    std::string apply_outbound_alias(const std::string &topic, int qos, mqtt::properties &props,
+                                     bool &establishing);
+    // Resolve (and learn) an inbound alias; empty if the message names an unknown alias
+    std::string resolve_inbound_topic(const mqtt::message &msg);
+    void reset_topic_aliases(uint16_t outbound_limit);
 
     struct TopicSubscriptionInfo
     {
         std::string topic;
         int qos;
     };
+    // Guards the tracked subscriptions and the offline changes to them
+    std::mutex subscriptions_mutex_;
     std::vector<TopicSubscriptionInfo> tracked_subscriptions_;
+    // Tracked topics the broker session may lack (subscribed while offline or not sent) and
+    // topics dropped while offline; applied to a resumed session on reconnect
+    std::set<std::string> offline_subscribes_;
+    std::set<std::string> offline_unsubscribes_;
+
+    // Add or update the tracked entries for a batch of topics with one pass over the list
+    void track_subscriptions(const std::vector<std::pair<std::string, int>> &topics);
+    // One SUBSCRIBE packet for topics, without tracking them
+    mqtt::token_ptr send_subscribe(const std::vector<std::pair<std::string, int>> &topics);
+    void send_subscribes_batched(const std::vector<std::pair<std::string, int>> &topics);
+
+    // --- Reconnect and offline queue ---
+    struct QueuedPublish
+    {
+        std::string topic; // Always the full topic; aliases are applied when it is sent
+        std::string payload;
+        int qos;
+        bool retained;
+        mqtt::properties props;
+    };
+    const mqtt_utils::SessionConfig session_;
+    bool session_established_ = false; // A connect succeeded, so there is a session to resume
+
+    std::mutex outbox_mutex_;
+    std::deque<QueuedPublish> outbox_;
+    // Set from a connection loss (and before the first connect) until the queue is flushed;
+    // publishes queue meanwhile so none overtakes an older queued one
+    std::atomic<bool> outbox_active_{true};
+    std::atomic<uint64_t> offline_dropped_{0};
+
+    std::atomic<bool> reconnecting_{false};
+    std::atomic<bool> closing_{false};
+    std::mutex reconnect_mutex_;
+    std::condition_variable reconnect_cv_;
+    std::thread reconnect_thread_;
+
+    bool send_payload(const std::string &topic, std::string payload, int qos, bool retained,
+                      mqtt::properties props);
+    bool queue_publish(const std::string &topic, std::string payload, int qos, bool retained,
+                       mqtt::properties props);
+    void flush_outbox();
+    void start_reconnect();
+    void reconnect_loop();
 
     // --- Internal Connection Handlers ---
-    void on_successful_connect();
+    // After a connect token completed: aliases, subscriptions, then the offline queue
+    void on_successful_connect(const mqtt::connect_response &response);
     void on_connection_failure();
 };
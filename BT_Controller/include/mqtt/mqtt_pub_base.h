@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils.h"
+#include "mqtt/message_template.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -8,12 +9,21 @@
 
 class MqttClient;
 
+namespace mqtt
+{
+    struct properties;
+}
+
 class MqttPubBase
 {
 protected:
     MqttClient *mqtt_client_;
-    std::map<std::string, mqtt_utils::Topic> topics_;
+    mqtt_utils::TopicMap topics_;
     bool initialized_ = false;
+    std::string publish_buffer_; // Rendered templates; keeps its capacity between sends
+
+    // Send a JSON value in the topic's encoding
+    void publishEncoded(const mqtt_utils::Topic &topic, const nlohmann::json &message, mqtt::properties props);
 
 public:
     MqttPubBase(MqttClient &mqtt_client);
@@ -21,7 +31,12 @@ public:
 
     virtual void publish(const std::string &topic_key, const nlohmann::json &message);
     virtual void publish(const std::string &topic_key, const std::string &message);
+    // Render a command template with per-send field values into this node's buffer and publish it
+    void publish(const std::string &topic_key, const MessageTemplate &message_template,
+                 std::initializer_list<MessageTemplate::Value> values);
 
     void setTopic(const std::string &topic_key, const mqtt_utils::Topic &topic_object);
     void setFormattedTopic(const std::string &topic_key, const std::string &formatted_topic_str);
+
+    const mqtt_utils::TopicMap &getPublishTopics() const { return topics_; }
 };
\ No newline at end of file
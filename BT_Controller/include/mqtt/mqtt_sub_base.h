@@ -6,6 +6,9 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <vector>
+#include <set>
+#include <optional>
 #include "utils.h"
 
 // Forward declarations
@@ -17,6 +20,7 @@ namespace BT
 class MqttClient;
 class NodeMessageDistributor;
 class AASInterfaceCache;
+class AASClient;
 
 namespace mqtt
 {
@@ -40,20 +44,48 @@ public:
 
     void processMessage(const std::string &actual_topic_str, const nlohmann::json &msg, mqtt::properties props);
     void setTopic(const std::string &topic_key, const mqtt_utils::Topic &topic_object);
+    // Top-level fields the callback reads from messages on topic_key; a message lacking one
+    // fails validation whatever the topic's schema validation policy
+    void setRequiredFields(const std::string &topic_key, std::vector<std::string> fields);
+    // Responses on topic_key carry the Uuid of a command this node sent. A message whose Uuid
+    // some node claimed is delivered only to its claimants among the nodes correlating that
+    // topic; unclaimed Uuids still reach all of them. Set before the node is routed.
+    void setCorrelatedTopic(const std::string &topic_key);
+    bool isCorrelatedTopic(const std::string &topic_str) const;
+    // Claim responses carrying uuid, replacing this node's previous claim
+    void claimResponses(const std::string &uuid);
     virtual void callback(const std::string &topic_key, const nlohmann::json &msg, mqtt::properties props) = 0;
 
     // Get all configured topics for this node
-    const std::map<std::string, mqtt_utils::Topic>& getTopics() const { return topics_; }
+    const mqtt_utils::TopicMap& getTopics() const { return topics_; }
+
+    // Re-resolve this node's topics after its asset's AAS changed. Keeps the previous topics
+    // (and returns false) if that fails or the node never initialized. Only called while
+    // the distributor delivers nothing to the node and its tree is not being ticked.
+    virtual bool refreshTopicsFromAAS() { return false; }
 
     static void setNodeMessageDistributor(NodeMessageDistributor *manager);
     static void setAASInterfaceCache(AASInterfaceCache *cache);
     static AASInterfaceCache* getAASInterfaceCache();
 
+    // Interface lookup shared by all node types: cache first with one batched fill on a
+    // miss, or a direct AAS query when no cache is installed. One entry per
+    // (interaction, endpoint) request, nullopt where it could not be resolved.
+    static std::vector<std::optional<mqtt_utils::Topic>> resolveInterfaces(
+        AASClient &aas_client,
+        const std::string &asset_id,
+        const std::vector<std::pair<std::string, std::string>> &requests);
+
     virtual std::string getRegistrationName() const
     {
         return typeid(*this).name();
     }
     virtual std::string getBTNodeName() const = 0;
 
-    std::map<std::string, mqtt_utils::Topic> topics_;
+    mqtt_utils::TopicMap topics_;
+
+private:
+    std::map<std::string, std::vector<std::string>> required_fields_;
+    std::set<std::string> correlated_keys_;
+    bool hasRequiredFields(const std::string &topic_key, const nlohmann::json &msg) const;
 };
\ No newline at end of file
@@ -3,16 +3,24 @@
 #include <nlohmann/json.hpp>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <typeindex>
 #include <algorithm>
 #include <functional>
 #include "mqtt/async_client.h"
 #include "mqtt/mqtt_sub_base.h"
+#include "mqtt/topic_trie.h"
 #include <behaviortree_cpp/bt_factory.h>
 #include <set>
 #include <optional>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <atomic>
+#include <memory>
 #include <chrono>
 
 using json = nlohmann::json;
@@ -26,12 +34,44 @@ class MqttClient;
 class NodeMessageDistributor
 {
 public:
+    // Counters for the dispatch worker pool
+    struct DispatchStats
+    {
+        size_t workers = 0;
+        size_t queue_capacity = 0;  // Per worker
+        size_t queue_depth = 0;     // Messages currently waiting across all workers
+        size_t max_queue_depth = 0; // High-water mark across all workers
+        uint64_t enqueued = 0;
+        uint64_t processed = 0;
+        uint64_t dropped = 0;       // Rejected because the target worker queue was full
+        uint64_t correlated = 0;    // Responses delivered only to the nodes owning their Uuid
+    };
+
+    // Topic tables of the registered nodes of one type (BT registration name)
+    struct TopicMemoryStats
+    {
+        size_t nodes = 0;
+        size_t topics = 0; // Subscribed and published, by logical key
+        size_t bytes = 0;  // TopicMap::memoryUsage of both; the strings/schemas are interned
+    };
+
     // Constructor and destructor
-    NodeMessageDistributor(MqttClient &mqtt_client);
+    // worker_count == 0 keeps dispatch synchronous on the calling (Paho) thread
+    // last_value_cache keeps the latest payload per handled topic so late-initializing
+    // nodes are seeded locally instead of re-subscribing for the retained message
+    NodeMessageDistributor(MqttClient &mqtt_client,
+                           size_t worker_count = 0,
+                           size_t queue_capacity = 1024,
+                           bool last_value_cache = false);
     ~NodeMessageDistributor();
 
     // Message handling
-    void handle_incoming_message(const std::string &msg_topic, const json &payload, mqtt::properties props);
+    // The payload is shared with the dispatch queue and the last-value cache, never copied
+    void handle_incoming_message(const std::string &msg_topic, const std::shared_ptr<const json> &payload,
+                                 mqtt::properties props);
+    // One trie walk: nullopt if no subscribed node handles msg_topic, otherwise the encoding
+    // the AAS declares for it, as recorded in the routing snapshot
+    std::optional<mqtt_utils::PayloadEncoding> routeFor(const std::string &msg_topic) const;
     void route_to_nodes(const std::type_index &type_index, const std::string &topic, const json &msg, mqtt::properties props);
 
     // Node registration methods
@@ -44,23 +84,52 @@ public:
             {}};
     }
 
+    // Correlation index: an outstanding command Uuid -> the nodes waiting for its responses.
+    // Responses on correlated topics (MqttSubBase::setCorrelatedTopic) skip the other nodes
+    // sharing the topic. A node holds one claim; a later claim replaces the previous one.
+    void claimResponses(MqttSubBase *owner, const std::string &uuid);
+    void releaseResponses(MqttSubBase *owner);
+
     // Register the individual nodes
     void registerDerivedInstance(MqttSubBase *instance);
     void unregisterInstance(MqttSubBase *instance);
 
     // Register a late-initializing node AND subscribe to its specific topics
-    // This triggers the broker to resend retained messages for those topics
+    // This triggers the broker to resend retained messages for those topics.
+    // With the last-value cache, topics already seen are seeded from it without a subscribe.
     bool registerLateInitializingNode(MqttSubBase *instance,
                                       std::chrono::milliseconds timeout = std::chrono::seconds(2));
 
+    // Re-resolve, while their tree keeps running, the registered nodes publishing or listening on
+    // any of stale_topics (topics an AAS change replaced): they are detached from routing,
+    // refreshed through MqttSubBase::refreshTopicsFromAAS, and re-attached to their current
+    // topics like late-initializing nodes. Called between ticks. Returns the nodes refreshed.
+    size_t refreshInstancesUsing(const std::vector<mqtt_utils::Topic> &stale_topics,
+                                 std::chrono::milliseconds timeout = std::chrono::seconds(2));
+
     // Set up routing AND subscribe to specific topics for nodes in the active tree
-    // Subscribing triggers delivery of retained messages
+    // Subscribing triggers delivery of retained messages. Topics are sent in batched
+    // SUBSCRIBE packets; the timeout applies to all batches together. With the last-value
+    // cache, topics still subscribed from an earlier tree are seeded locally instead.
     bool subscribeForActiveNodes(const BT::Tree &tree,
                                  std::chrono::milliseconds timeout_per_subscription = std::chrono::seconds(5));
 
     // Method to get all currently subscribed topic patterns
     std::vector<std::string> getActiveTopicPatterns() const;
 
+    // Drop handlers left without instances (their nodes were destroyed with a tree) and
+    // return the subscribed topics among them, for the caller to unsubscribe; cached last
+    // values no remaining subscription covers are dropped with them
+    std::vector<std::string> releaseUnusedTopics();
+
+    // Called after a message was delivered to at least one node, on the delivering thread.
+    // Lets an owner ticking several trees notice callbacks that only wake their own tree.
+    // Install before messages flow.
+    void setDeliveryHook(std::function<void()> hook);
+
+    DispatchStats getDispatchStats() const;
+    std::map<std::string, TopicMemoryStats> getTopicMemoryStats() const;
+
 private:
     // Modified structure to track subscription status and route to multiple instances
     struct TopicHandler
@@ -69,6 +138,12 @@ private:
         std::vector<MqttSubBase*> instances;  // All instances listening to this topic
         int qos;
         bool subscribed;
+        // Derived by updateRouting: instances taking only responses to their own Uuids
+        // (sorted, for lookup) and all others
+        std::vector<MqttSubBase *> correlated;
+        std::vector<MqttSubBase *> uncorrelated;
+        // Derived by updateRouting: what the AAS declares for the topic, from its first instance
+        mqtt_utils::PayloadEncoding encoding = mqtt_utils::PayloadEncoding::Json;
         
         void routeMessage(const std::string &msg_topic, const json &msg, mqtt::properties props) const
         {
@@ -87,11 +162,118 @@ private:
         std::vector<MqttSubBase *> instances;
     };
 
+    // A message waiting for a dispatch worker; the payload is shared, never re-copied per handler
+    struct DispatchItem
+    {
+        std::string topic;
+        std::shared_ptr<const json> payload;
+        mqtt::properties props;
+        std::chrono::steady_clock::time_point enqueued; // For the "dispatch" histogram
+    };
+
+    // One worker thread with its own bounded queue; a topic always hashes to the same shard,
+    // so messages on one topic stay ordered while different topics run in parallel
+    struct DispatchShard
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<DispatchItem> queue;
+        std::thread worker;
+    };
+
+    // Immutable routing snapshot; replaced wholesale whenever routing changes
+    struct RoutingTable
+    {
+        std::vector<TopicHandler> handlers;
+        TopicTrie trie; // Subscription pattern -> index into handlers
+    };
+
+    std::shared_ptr<const RoutingTable> loadRouting() const
+    {
+        std::lock_guard<std::mutex> lock(routing_mutex_);
+        return routing_;
+    }
+
+    // The handlers of one snapshot a topic is delivered to: subscribed, with instances
+    struct Route
+    {
+        std::shared_ptr<const RoutingTable> routing;
+        std::vector<size_t> handlers;
+
+        explicit operator bool() const { return !handlers.empty(); }
+    };
+    Route route(const std::string &msg_topic) const;
+
+    // Copy the current handlers, apply mutate, and publish the result as a new snapshot.
+    // With wait_for_readers the call returns only after every delivery in progress, on any
+    // earlier snapshot, is done, so instances removed by mutate are no longer being called.
+    // Must not be called from a node callback.
+    void updateRouting(const std::function<void(std::vector<TopicHandler> &)> &mutate,
+                       bool wait_for_readers = false);
+    // Route an already registered instance's topics, seeding or (re-)subscribing each
+    bool attachInstanceTopics(MqttSubBase *instance, std::chrono::milliseconds timeout);
+    void markSubscribed(const std::string &topic_str);
+    void markSubscribed(const std::set<std::string> &topics);
+
+    // Last payload seen on a concrete topic; props are kept so seeded callbacks look like live ones
+    struct LastValue
+    {
+        std::shared_ptr<const json> payload;
+        mqtt::properties props;
+    };
+    void storeLastValue(const std::string &msg_topic, const std::shared_ptr<const json> &payload,
+                        const mqtt::properties &props);
+    // Add the instance's routing for topic_str and deliver cached values to it; false if none were cached.
+    // Runs under last_value_mutex_ so no newer message can reach the instance before the seed.
+    bool attachFromLastValueCache(MqttSubBase *instance, const mqtt_utils::Topic &topic_obj,
+                                  const std::function<void(std::vector<TopicHandler> &)> &attach);
+
+    // Deliver to all matching instances using the current snapshot; locks only to copy its pointer.
+    // A route matched just before is reused if it is still on the current snapshot.
+    void dispatch(const std::string &msg_topic, const json &payload, const mqtt::properties &props,
+                  const Route *matched = nullptr);
+    // A handler with correlated instances: a claimed Uuid goes to its owners and the
+    // uncorrelated instances only
+    void routeCorrelated(const TopicHandler &handler, const std::string &msg_topic, const json &payload,
+                         const mqtt::properties &props);
+    void workerLoop(DispatchShard &shard);
+    void stopWorkers();
+
     MqttClient &mqtt_client_;
-    std::vector<TopicHandler> topic_handlers_;
+    // Held only to copy or swap the snapshot pointer: std::atomic<std::shared_ptr> needs
+    // libstdc++ 12, and the image builds on jammy's GCC 11
+    mutable std::mutex routing_mutex_;
+    std::shared_ptr<const RoutingTable> routing_;
+    // Shared by dispatch() for a whole delivery, exclusive for updateRouting's grace period
+    std::shared_mutex delivery_mutex_;
     std::map<std::type_index, NodeTypeSubscription> node_subscriptions_;
 
     // Mutex for thread-safe operations
+    // handlers_mutex_ only serializes routing writers; readers go through routing_
     mutable std::mutex handlers_mutex_;
     mutable std::mutex registry_mutex_;
+
+    // Dispatch worker pool
+    std::vector<std::unique_ptr<DispatchShard>> shards_;
+    size_t queue_capacity_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> queue_depth_{0};
+    std::atomic<size_t> max_queue_depth_{0};
+    std::atomic<uint64_t> enqueued_count_{0};
+    std::atomic<uint64_t> processed_count_{0};
+    std::atomic<uint64_t> dropped_count_{0};
+
+    std::function<void()> delivery_hook_;
+
+    // Owners are copied out of the lock before delivery; more than this many falls back to fan-out
+    static constexpr size_t kMaxOwnersPerUuid = 4;
+    mutable std::shared_mutex correlation_mutex_;
+    std::unordered_map<std::string, std::vector<MqttSubBase *>> owners_by_uuid_;
+    std::unordered_map<MqttSubBase *, std::string> uuid_by_owner_;
+    std::atomic<uint64_t> correlated_count_{0};
+
+    // Opt-in last-value cache: concrete topic -> latest message
+    bool last_value_cache_enabled_;
+    std::mutex last_value_mutex_;
+    std::unordered_map<std::string, LastValue> last_values_;
 };
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace mqtt_utils
+{
+    // Wire encoding of an MQTT payload; the decoded value is the same nlohmann::json either way
+    enum class PayloadEncoding
+    {
+        Json,   // UTF-8 JSON text, the default and what every topic used before
+        Cbor,   // RFC 8949, "application/cbor"
+        MsgPack // MessagePack, "application/msgpack" (what ArduinoJson on the stations reads)
+    };
+
+    /**
+     * @brief Encoding named by an MQTT v5 content-type or an AAS form contentType
+     * Parameters ("; charset=utf-8") are ignored; nullopt for anything not recognised.
+     */
+    std::optional<PayloadEncoding> parsePayloadEncoding(std::string_view content_type);
+
+    /// @brief Content-type sent with messages in this encoding
+    const char *contentTypeFor(PayloadEncoding encoding);
+
+    /// @brief Parse a payload; throws nlohmann::json::parse_error like json::parse
+    nlohmann::json decodePayload(std::string_view payload, PayloadEncoding encoding);
+
+    /// @brief Serialize a payload; encodePayload(x, Json) == x.dump()
+    std::string encodePayload(const nlohmann::json &payload, PayloadEncoding encoding);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+class MqttClient;
+
+/**
+ * @brief Outbound stage for the controller's own state and command-response messages
+ *
+ * post() only queues and returns, so the control thread never waits on the broker; one
+ * worker thread serializes and publishes. Coalescable messages (State) are last-writer-wins
+ * per topic: a newer one posted within the window replaces the one still waiting, and is
+ * published at the time the first would have been. Others (command responses) are all sent.
+ * Messages go out in the order their latest versions were posted. While the client is
+ * disconnected they wait here, still coalescing, and go out once it is back. The payloads
+ * are built by the controller itself, so they are not validated against their schemas here.
+ */
+class StatePublisher
+{
+public:
+    StatePublisher(MqttClient &mqtt_client, std::chrono::milliseconds coalesce_window);
+    ~StatePublisher(); // Publishes whatever is still queued
+
+    StatePublisher(const StatePublisher &) = delete;
+    StatePublisher &operator=(const StatePublisher &) = delete;
+
+    void post(const std::string &topic, nlohmann::json payload, int qos, bool retain, bool coalesce);
+
+    /// @brief Publish everything queued now, ignoring the window; returns once sent, or handed
+    /// to the client's offline queue while disconnected
+    void flush();
+
+private:
+    struct Pending
+    {
+        std::string topic;
+        nlohmann::json payload;
+        int qos;
+        bool retain;
+        bool coalesce;
+        std::chrono::steady_clock::time_point due;
+    };
+
+    void workerLoop();
+
+    // How often the worker checks for a reconnect while holding messages
+    static constexpr std::chrono::milliseconds kReconnectPoll{100};
+
+    MqttClient &mqtt_client_;
+    std::chrono::milliseconds coalesce_window_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Pending> queue_;
+    bool flushing_ = false;
+    bool publishing_ = false;
+    bool stopping_ = false;
+    std::thread worker_;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * @brief MQTT-aware topic trie mapping subscription patterns to handler indices
+ *
+ * Patterns are split on '/' and stored one level per node. The single-level
+ * wildcard '+' and the multi-level wildcard '#' get dedicated child slots so a
+ * concrete topic can be matched against every stored pattern in one walk,
+ * costing roughly the topic depth instead of the number of patterns.
+ */
+class TopicTrie
+{
+public:
+    TopicTrie();
+    ~TopicTrie();
+
+    TopicTrie(const TopicTrie &) = delete;
+    TopicTrie &operator=(const TopicTrie &) = delete;
+    TopicTrie(TopicTrie &&) noexcept;
+    TopicTrie &operator=(TopicTrie &&) noexcept;
+
+    /**
+     * @brief Store a subscription pattern with the index of its handler
+     * @param pattern Topic filter, may contain '+' and a trailing '#'
+     * @param value Index returned by match() for topics covered by the pattern
+     */
+    void insert(const std::string &pattern, size_t value);
+
+    /**
+     * @brief Remove all stored patterns
+     */
+    void clear();
+
+    /**
+     * @brief Collect the values of all patterns matching a concrete topic
+     * @param topic The topic a message arrived on (no wildcards)
+     * @param out Matching values are appended here
+     */
+    void match(std::string_view topic, std::vector<size_t> &out) const;
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    struct Node;
+
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    struct Node
+    {
+        std::unordered_map<std::string, std::unique_ptr<Node>, StringHash, std::equal_to<>> children;
+        std::unique_ptr<Node> single_level; // '+'
+        std::vector<size_t> multi_level;    // values of patterns ending in '#' at this level
+        std::vector<size_t> values;         // values of patterns ending exactly here
+    };
+
+    static void matchLevel(const Node *node, std::string_view remaining, bool at_end,
+                           std::vector<size_t> &out);
+
+    std::unique_ptr<Node> root_;
+    size_t size_ = 0;
+};
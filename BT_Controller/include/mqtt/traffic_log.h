@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mqtt
+{
+    class message;
+}
+
+class NodeMessageDistributor;
+
+/**
+ * @brief Append-only log of received MQTT messages, for replaying real UNS traffic
+ *
+ * The file is an 8 byte magic followed by records, each 8-byte aligned so the log can be
+ * memory-mapped and read in place (host byte order; all our targets are little-endian):
+ *
+ *   RecordHeader | topic | content type | response topic | correlation data | payload | pad
+ *
+ * Payloads are stored as received, before decoding; the content type keeps CBOR and
+ * MessagePack messages replayable. A record cut short by a crash ends the readable log.
+ */
+namespace traffic_log
+{
+    constexpr char kMagic[8] = {'B', 'T', 'T', 'R', 'A', 'F', '0', '1'};
+
+    struct RecordHeader
+    {
+        uint32_t size;         // Whole record including header and padding
+        uint32_t payload_size;
+        int64_t time_ns;       // Arrival, system clock since the epoch
+        uint16_t topic_size;
+        uint16_t content_type_size;
+        uint16_t response_topic_size;
+        uint16_t correlation_size;
+        uint8_t qos;
+        uint8_t retained;
+        uint8_t reserved[6];
+    };
+    static_assert(sizeof(RecordHeader) == 32, "RecordHeader is part of the file format");
+
+    /// @brief One record, pointing into the mapped file
+    struct Record
+    {
+        std::chrono::nanoseconds time;
+        std::string_view topic;
+        std::string_view content_type; // Empty for plain JSON
+        std::string_view response_topic;
+        std::string_view correlation_data;
+        std::string_view payload;
+        int qos = 0;
+        bool retained = false;
+    };
+}
+
+/**
+ * @brief Appends received messages to a traffic log
+ *
+ * record() may be called from any thread; records go through a stdio buffer, so flush()
+ * (or destruction) makes them visible to readers.
+ */
+class TrafficRecorder
+{
+public:
+    TrafficRecorder() = default;
+    ~TrafficRecorder();
+
+    TrafficRecorder(const TrafficRecorder &) = delete;
+    TrafficRecorder &operator=(const TrafficRecorder &) = delete;
+
+    /// @brief Open path for appending, writing the magic to a new file; false on failure
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return file_ != nullptr; }
+
+    /// @brief Record a message as MqttClient received it; topic is the alias-resolved one
+    void record(const std::string &topic, const mqtt::message &msg);
+
+    void record(const traffic_log::Record &record);
+
+    void flush();
+
+    uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex_;
+    std::FILE *file_ = nullptr;
+    std::vector<char> scratch_; // One record; reused
+    std::atomic<uint64_t> recorded_{0};
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a traffic log
+ */
+class TrafficLog
+{
+public:
+    TrafficLog() = default;
+    ~TrafficLog();
+
+    TrafficLog(const TrafficLog &) = delete;
+    TrafficLog &operator=(const TrafficLog &) = delete;
+
+    /// @brief Map path and index its records; false if it is missing or not a traffic log
+    bool open(const std::string &path);
+
+    const std::vector<traffic_log::Record> &records() const { return records_; }
+    size_t size() const { return records_.size(); }
+    bool empty() const { return records_.empty(); }
+
+    /// @brief Time between the first and the last record
+    std::chrono::nanoseconds duration() const;
+
+private:
+    void *data_ = nullptr;
+    size_t length_ = 0;
+    std::vector<traffic_log::Record> records_;
+
+    void unmap();
+};
+
+/**
+ * @brief Convert an NDJSON capture ({"time", "qos", "retain", "topic", "msg_b64"} per
+ * line, as production_run_backup) into a traffic log
+ * @return Records written, or -1 if either file could not be opened
+ */
+long importNdjsonCapture(const std::string &ndjson_path, TrafficRecorder &recorder);
+
+/**
+ * @brief Feeds a traffic log into a NodeMessageDistributor the way MqttClient would
+ *
+ * speed 1 keeps the recorded gaps between messages, N compresses them N times, 0 sends
+ * as fast as the distributor takes them. Payloads are decoded by their recorded content
+ * type on the replaying thread, as on Paho's callback thread.
+ */
+class TrafficReplayer
+{
+public:
+    struct Result
+    {
+        size_t messages = 0;
+        size_t decode_errors = 0;
+        double elapsed_ms = 0.0;
+        double recorded_ms = 0.0; // Span of the replayed records at 1x
+    };
+
+    TrafficReplayer(const TrafficLog &log, NodeMessageDistributor &distributor);
+
+    /// @brief Replay the whole log on the calling thread
+    Result run(double speed = 1.0);
+
+    /// @brief Make a running run() return after its current message
+    void stop() { stopping_ = true; }
+
+private:
+    const TrafficLog &log_;
+    NodeMessageDistributor &distributor_;
+    std::atomic<bool> stopping_{false};
+};
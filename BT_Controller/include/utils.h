@@ -10,8 +10,15 @@
 #include <fstream>
 #include <filesystem>
 #include <yaml-cpp/yaml.h>
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <optional>
 
 #include <behaviortree_cpp/bt_factory.h>
+#include "mqtt/payload_codec.h"
 
 namespace PackML
 {
@@ -49,23 +56,48 @@ namespace PackML
 
 namespace bt_utils
 {
+    // command_deadlines section of the controller config
+    struct CommandDeadlineConfig
+    {
+        int resolution_ms = 10;
+        int ack_timeout_ms = 5000;     // Command sent until the station's first response; 0 disables
+        int completion_timeout_ms = 0; // First response until SUCCESS/FAILURE; 0 waits forever
+        int release_timeout_ms = 5000; // Occupy release sent until its SUCCESS/FAILURE; 0 disables
+        int retries = 0;               // Resends after a missed deadline before giving up
+        double backoff = 2.0;          // Each resend waits backoff times longer than the last
+    };
+
+    // move_batching section of the controller config
+    struct MoveBatchConfig
+    {
+        std::string asset; // AAS ID of the planner offering BatchMotion; empty sends each move on its own
+        int window_ms = 0; // Collect moves this long after the first; 0 = one controller loop
+    };
+
+    struct SimClockConfig
+    {
+        std::string mode = "wall"; // wall, scaled (fixed speed) or driven (follows topic)
+        double speed = 1.0;        // Virtual seconds per wall second; driven: until the first clock message
+        std::string topic;         // Where the simulated stations publish their clock
+    };
+
+    // scheduler section of the controller config
+    struct SchedulerConfig
+    {
+        std::string occupy_policy = "first_response"; // Occupy nodes without a Policy attribute
+    };
+
+    struct Groot2MonitorConfig
+    {
+        std::string mode = "stock";    // stock (every status change) or throttled (snapshots)
+        int snapshot_interval_ms = 100; // Throttled: period of the status snapshots
+    };
+
     /**
      * Saves a string to a file
      */
     std::string getCurrentTimestampISO();
     int saveXmlToFile(const std::string &xml_content, const std::string &filename);
-    bool loadConfigFromYaml(const std::string &filename,
-                            bool &generate_xml_models,
-                            std::string &serverURI,
-                            std::string &clientId,
-                            std::string &unsTopicPrefix,
-                            std::string &aasServerUri,
-                            std::string &aasRegistryUrl,
-                            int &groot2_port,
-                            std::string &bt_description_path,
-                            std::string &bt_nodes_path,
-                            std::string &registration_config_path,
-                            std::string &registration_topic_pattern);
 
 }
 
@@ -78,6 +110,14 @@ namespace schema_utils
      */
     nlohmann::json fetchSchemaFromUrl(const std::string &schema_url);
 
+    /**
+     * Enable the on-disk schema store used by fetchSchemaFromUrl
+     * Stored schemas are revalidated with If-None-Match/If-Modified-Since and
+     * used as fallback when the network is unavailable.
+     * @param directory Directory for cache entries, empty to disable
+     */
+    void setSchemaCacheDirectory(const std::string &directory);
+
     /**
      * Resolve $ref references in a schema by fetching and inlining them
      * @param schema The schema to resolve (modified in place)
@@ -135,7 +175,130 @@ namespace mqtt_utils
     std::string formatWildcardTopic(const std::string &topic, const std::string &id);
     std::string formatWildcardTopic(const std::string &topic_pattern, const std::vector<std::string> &replacements);
     std::unique_ptr<nlohmann::json_schema::json_validator> createSchemaValidator(const std::string &schema_path);
-    bool topicMatches(const std::string &pattern, const std::string &topic);
+
+    using SharedValidator = std::shared_ptr<const nlohmann::json_schema::json_validator>;
+
+    /**
+     * Get a compiled validator for a schema from the process-wide validator cache
+     * Validators are keyed by the schema content, so identical schemas are compiled
+     * (and their $refs fetched) only once. Failed compilations are not cached.
+     * @param schema The root schema
+     * @param context Name used in error messages (e.g. the topic)
+     * @return The shared validator, or nullptr if the schema is empty or invalid
+     */
+    SharedValidator getCachedValidator(const nlohmann::json &schema, const std::string &context = "");
+    bool topicMatches(std::string_view pattern, std::string_view topic);
+
+    /**
+     * @brief MQTT topic filter split into segments once, for allocation-free matching
+     *
+     * Segments are kept as offsets into the owned pattern string and exposed as
+     * string_views, so copies stay valid. '+' matches exactly one level, a trailing
+     * '#' matches the remaining levels including the parent ("a/#" matches "a").
+     */
+    class CompiledTopicPattern
+    {
+    public:
+        CompiledTopicPattern() = default;
+        explicit CompiledTopicPattern(const std::string &pattern);
+
+        // Match a concrete topic without allocating
+        bool matches(std::string_view topic) const;
+
+        const std::string &str() const { return pattern_; }
+        bool hasWildcards() const { return has_wildcards_; }
+        size_t segmentCount() const { return segments_.size(); }
+        std::string_view segment(size_t i) const
+        {
+            return std::string_view(pattern_).substr(segments_[i].offset, segments_[i].length);
+        }
+
+    private:
+        enum class SegmentKind : uint8_t
+        {
+            Literal,
+            SingleLevel, // '+'
+            MultiLevel   // '#'
+        };
+        struct Segment
+        {
+            uint32_t offset;
+            uint32_t length;
+            SegmentKind kind;
+        };
+
+        std::string pattern_;
+        std::vector<Segment> segments_;
+        bool has_wildcards_ = false;
+    };
+
+    // How often inbound messages on a topic get the full JSON-schema check
+    enum class ValidationPolicy
+    {
+        Always,         // Every message
+        Sampled,        // The first sample_first messages, then every sample_every-th
+        OnSchemaChange, // Until one message passes, again after the schema is replaced
+        Off             // Never; only the subscriber's required-field check runs
+    };
+
+    // "always", "sampled", "on_schema_change" or "off"
+    std::optional<ValidationPolicy> parseValidationPolicy(const std::string &name);
+
+    struct ValidationConfig
+    {
+        ValidationPolicy default_policy = ValidationPolicy::Always;
+        uint64_t sample_first = 100;
+        uint64_t sample_every = 50;
+        // Topic filter -> policy, first match wins; topics matching none use default_policy
+        std::vector<std::pair<CompiledTopicPattern, ValidationPolicy>> topic_policies;
+
+        ValidationPolicy policyFor(std::string_view topic) const;
+    };
+
+    /**
+     * Install the process-wide validation policies
+     * Topics resolve their policy when their topic string is set, so call this at startup
+     * before any Topic is created.
+     */
+    void setValidationConfig(ValidationConfig config);
+    const ValidationConfig &getValidationConfig();
+
+    // How the MQTT client rides through broker connection losses (mqtt.session)
+    struct SessionConfig
+    {
+        bool resume = true;         // Reconnect with clean start off, so the broker keeps subscriptions
+        int expiry_s = 604800;      // Session expiry interval: how long the broker keeps it after a loss
+        size_t offline_buffer = 256; // Publishes queued while disconnected, sent on reconnect; 0 = dropped
+        int reconnect_min_ms = 250; // Reconnect backoff, doubled per failed attempt up to reconnect_max_ms
+        int reconnect_max_ms = 8000;
+    };
+
+    using SharedTopicPattern = std::shared_ptr<const CompiledTopicPattern>;
+    using SharedSchema = std::shared_ptr<const nlohmann::json>;
+
+    /**
+     * Intern a topic string in the process-wide topic table
+     * Every Topic naming the same string points to the same compiled pattern; entries live
+     * as long as some Topic holds them.
+     */
+    SharedTopicPattern internTopic(const std::string &topic);
+
+    /**
+     * Intern a schema in the process-wide schema table, keyed by its content
+     * @return The shared schema, or nullptr for an empty/null schema
+     */
+    SharedSchema internSchema(const nlohmann::json &schema);
+
+    struct InternStats
+    {
+        size_t topics = 0;       // Distinct topic strings held by some Topic
+        size_t topic_bytes = 0;  // Their characters
+        size_t schemas = 0;      // Distinct schemas held by some Topic
+        size_t schema_bytes = 0; // Their serialized size
+        size_t schema_refs = 0;  // Topics sharing them; each would otherwise hold a copy
+    };
+    InternStats getInternStats();
+
     class Topic
     {
     public:
@@ -166,29 +329,141 @@ namespace mqtt_utils
         void initValidator();
 
         // Getters
-        const std::string &getTopic() const { return topic_; }
-        const std::string &getPattern() const { return pattern_; }
-        const nlohmann::json &getSchema() const { return schema_; }
+        const std::string &getTopic() const { return getCompiledTopic().str(); }
+        const std::string &getPattern() const { return pattern_ ? pattern_->str() : getTopic(); }
+        const nlohmann::json &getSchema() const;
         int getQos() const { return qos_; }
         bool getRetain() const { return retain_; }
 
         // Setters
-        void setTopic(const std::string &topic) { topic_ = topic; }
-        void setPattern(const std::string &pattern) { pattern_ = pattern; }
+        void setTopic(const std::string &topic);
+        void setPattern(const std::string &pattern) { pattern_ = internTopic(pattern); }
         void setSchema(const nlohmann::json &schema);
         void setSchemaFromPath(const std::string &schema_path);
         void setQos(int qos) { qos_ = qos; }
         void setRetain(bool retain) { retain_ = retain; }
 
+        // Wire encoding declared for the topic (AAS form contentType), JSON unless stated
+        PayloadEncoding getEncoding() const { return encoding_; }
+        void setEncoding(PayloadEncoding encoding) { encoding_ = encoding; }
+
         // Validate message against schema
         bool validateMessage(const nlohmann::json &message) const;
 
+        // Validate an inbound message as far as the topic's policy asks for; messages it
+        // skips count as valid. Failures are reported like validateMessage's.
+        bool validateInbound(const nlohmann::json &message) const;
+        ValidationPolicy getValidationPolicy() const { return validation_policy_; }
+        void setValidationPolicy(ValidationPolicy policy) { validation_policy_ = policy; }
+
+        // Match an incoming topic against this (possibly wildcarded) topic
+        bool matches(std::string_view actual_topic) const { return getCompiledTopic().matches(actual_topic); }
+        const CompiledTopicPattern &getCompiledTopic() const;
+
     private:
-        std::string topic_;
-        std::string pattern_;
-        nlohmann::json schema_;
-        std::unique_ptr<nlohmann::json_schema::json_validator> schema_validator_;
+        // Interned: copies of a Topic, and Topics built from the same strings and schema,
+        // share one topic string, compiled pattern and schema
+        SharedTopicPattern topic_;
+        SharedTopicPattern pattern_;       // Null while the pattern is the topic itself
+        SharedSchema schema_;
+        SharedValidator schema_validator_; // Shared with every Topic using the same schema
         int qos_;
         bool retain_;
+        PayloadEncoding encoding_ = PayloadEncoding::Json;
+        ValidationPolicy validation_policy_;
+        mutable std::atomic<uint64_t> inbound_count_{0};    // Messages seen by validateInbound
+        mutable std::atomic<bool> schema_verified_{false}; // OnSchemaChange: a message passed
+    };
+
+    /**
+     * @brief A node's topics by logical key, kept as one sorted vector
+     *
+     * Nodes hold a handful of topics, so a flat array searched by binary search is both
+     * smaller and faster to walk than a tree of map nodes. Same interface as the
+     * std::map it replaces for the operations nodes use; iterators are invalidated by
+     * inserting and erasing.
+     */
+    class TopicMap
+    {
+    public:
+        using value_type = std::pair<std::string, Topic>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        iterator begin() { return entries_.begin(); }
+        iterator end() { return entries_.end(); }
+        const_iterator begin() const { return entries_.begin(); }
+        const_iterator end() const { return entries_.end(); }
+        size_t size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+
+        iterator find(std::string_view key);
+        const_iterator find(std::string_view key) const;
+        size_t count(std::string_view key) const { return find(key) != end() ? 1 : 0; }
+        // Inserts a default Topic under key if there is none
+        Topic &operator[](const std::string &key);
+        size_t erase(std::string_view key);
+        void clear() { entries_.clear(); }
+
+        // Bytes held by this map itself: the entries and out-of-line key characters,
+        // not the interned topic strings and schemas the entries point to
+        size_t memoryUsage() const;
+
+    private:
+        std::vector<value_type> entries_;
+        const_iterator lowerBound(std::string_view key) const;
     };
-}
\ No newline at end of file
+}
+
+namespace bt_utils
+{
+    // Everything controller_config.yaml sets; keys the file leaves out keep these defaults
+    struct ControllerConfig
+    {
+        bool generate_xml_models = false;
+        std::string serverURI;
+        std::string clientId;
+        std::string unsTopicPrefix;
+        bool lazy_payload_parsing = true; // Only parse payloads for topics with a handler
+        int dispatch_workers = 4;         // 0 = run node callbacks on the MQTT client thread
+        int dispatch_queue_capacity = 1024;
+        bool last_value_cache = false;    // Seed late-initializing nodes locally instead of re-subscribing
+        std::string schema_cache_dir;     // On-disk JSON schema store, empty = memory only
+        std::string aas_snapshot_path;    // AASInterfaceCache snapshot for warm starts, empty = off
+        int max_idle_interval_ms = 100;   // Longest wait between ticks when no MQTT event wakes the tree
+        int metrics_publish_interval_ms = 5000; // Latency histogram publication period, 0 = off
+        int max_concurrent_processes = 1; // Process AAS trees ticking side by side, one per Start
+        int parallel_tick_workers = 3;    // TickPool threads for Parallel_Concurrent, 0 = tick inline
+        bool warm_restart = true;         // Reset keeps registrations/subscriptions for the next Start
+        int state_coalesce_window_ms = 20; // State changes within this window publish only the latest
+        mqtt_utils::ValidationConfig validation; // Per-topic inbound JSON-schema validation policies
+        int topic_alias_maximum = 16;      // MQTT v5 topic aliases each way, 0 = off
+        mqtt_utils::SessionConfig mqtt_session; // Reconnect, session resumption and offline buffering
+        std::string shared_group;          // Controller group sharing <uns>/<group>/CMD/*, empty = standalone
+        std::string log_level = "info";    // Runtime threshold of the async logger
+        std::string starting_trace_dir;    // STARTING span traces are written here, empty = off
+        std::string trace_format = "chrome";
+        std::string traffic_record_path;   // Received MQTT traffic is logged here, empty = off
+        std::string command_trace = "off"; // End-to-end command tracing: off, properties or payload
+        CommandDeadlineConfig command_deadlines; // Ack/completion/release deadlines and resends
+        MoveBatchConfig move_batching; // Planner asset for concurrent moves
+        SchedulerConfig scheduler;     // Default Occupy policy, e.g. shortest_expected_completion
+        SimClockConfig sim_clock;      // Wall, scaled or simulator-driven line time
+        std::string aasServerUrl;
+        std::string aasRegistryUrl;
+        int groot2_port = 1667;
+        Groot2MonitorConfig groot2_monitor; // Stock or snapshot-throttled Groot2 publisher
+        std::string bt_description_path;
+        std::string bt_nodes_path;
+        std::string registration_config_path;    // Path to orchestrator's AAS description YAML
+        std::string registration_topic_pattern;  // MQTT topic pattern for registration
+        std::string registration_response_topic; // Registration results, refresh the assets they name
+    };
+
+    /**
+     * Load the controller configuration from a YAML file
+     * @param config Filled from the file; fields it does not set are left as they are
+     * @return false if the file is missing or not valid YAML
+     */
+    bool loadConfigFromYaml(const std::string &filename, ControllerConfig &config);
+}
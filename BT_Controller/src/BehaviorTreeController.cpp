@@ -1,19 +1,29 @@
 #include "BehaviorTreeController.h"
 
-#include <behaviortree_cpp/loggers/groot2_publisher.h>
 #include <behaviortree_cpp/xml_parsing.h>
 
 #include "mqtt/mqtt_client.h"
 #include "mqtt/node_message_distributor.h"
 #include "mqtt/mqtt_sub_base.h"
+#include "mqtt/state_publisher.h"
+#include "mqtt/traffic_log.h"
 #include "aas/aas_interface_cache.h"
 #include "bt/register_all_nodes.h"
+#include "bt/tick_pool.h"
+#include "bt/command_deadlines.h"
+#include "bt/move_batcher.h"
+#include "bt/sim_clock.h"
+#include "bt/groot2_monitor.h"
+#include "bt/assignment_scheduler.h"
+#include "logging/logger.h"
+#include "metrics/latency_metrics.h"
+#include "metrics/span_trace.h"
+#include "metrics/command_trace.h"
 #include "utils.h"
 
 #include <csignal>
 #include <chrono>
 #include <thread>
-#include <iostream>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -21,32 +31,46 @@
 BehaviorTreeController *g_controller_instance = nullptr;
 
 BehaviorTreeController::BehaviorTreeController(int argc, char *argv[])
-    : mqtt_start_bt_flag_{false},
-      mqtt_suspend_bt_flag_{false},
-      mqtt_unsuspend_bt_flag_{false},
-      mqtt_reset_bt_flag_{false},
-      shutdown_flag_{false},
-      sigint_received_{false},
+    : sigint_received_{false},
       nodes_registered_{false},
-      current_packml_state_{PackML::State::STOPPED},
-      current_bt_tick_status_{BT::NodeStatus::IDLE}
+      last_metrics_publish_{std::chrono::steady_clock::now()}
 {
     g_controller_instance = this;
     loadAppConfiguration(argc, argv);
+    createProcessExecutions();
 
+    command_deadlines_ = std::make_unique<CommandDeadlines>(app_params_.command_deadlines);
+    CommandDeadline::install(command_deadlines_.get());
+
+    // A new process always starts a clean session; MqttClient resumes it on reconnects
     auto connOpts = mqtt::connect_options_builder::v5()
                         .clean_start(true)
-                        .properties({{mqtt::property::SESSION_EXPIRY_INTERVAL, 604800}})
+                        .properties({{mqtt::property::SESSION_EXPIRY_INTERVAL, std::max(app_params_.mqtt_session.expiry_s, 0)}})
                         .finalize();
 
-    mqtt_client_ = std::make_unique<MqttClient>(app_params_.serverURI, app_params_.clientId, connOpts, 5);
-    node_message_distributor_ = std::make_unique<NodeMessageDistributor>(*mqtt_client_);
-
+    mqtt_client_ = std::make_unique<MqttClient>(app_params_.serverURI, app_params_.clientId, connOpts, 5,
+                                                app_params_.topic_alias_maximum, app_params_.mqtt_session);
+    if (!app_params_.traffic_record_path.empty())
+    {
+        traffic_recorder_ = std::make_unique<TrafficRecorder>();
+        if (traffic_recorder_->open(app_params_.traffic_record_path))
+        {
+            mqtt_client_->set_recorder(traffic_recorder_.get());
+        }
+    }
+    state_publisher_ = std::make_unique<StatePublisher>(
+        *mqtt_client_, std::chrono::milliseconds(app_params_.state_coalesce_window_ms));
+    node_message_distributor_ = createNodeMessageDistributor();
     // Initialize AAS client
     aas_client_ = std::make_unique<AASClient>(app_params_.aasServerUrl, app_params_.aasRegistryUrl);
 
     // Initialize AAS interface cache for pre-fetching
     aas_interface_cache_ = std::make_unique<AASInterfaceCache>(*aas_client_);
+    if (!app_params_.move_batching.asset.empty())
+    {
+        move_batcher_ = std::make_unique<MoveBatcher>(*mqtt_client_, *aas_client_, app_params_.move_batching);
+        MoveBatcher::install(move_batcher_.get());
+    }
 
     // Initialize BehaviorTreeFactory
     bt_factory_ = std::make_unique<BT::BehaviorTreeFactory>();
@@ -57,9 +81,14 @@ BehaviorTreeController::BehaviorTreeController(int argc, char *argv[])
 
 BehaviorTreeController::~BehaviorTreeController()
 {
-    if (bt_tree_.rootNode() && bt_tree_.rootNode()->status() == BT::NodeStatus::RUNNING)
+    for (auto &execution : executions_)
     {
-        bt_tree_.haltTree();
+        setWakeRoot(*execution, nullptr);
+
+        if (execution->tree.rootNode() && execution->tree.rootNode()->status() == BT::NodeStatus::RUNNING)
+        {
+            execution->tree.haltTree();
+        }
     }
 
     if (node_message_distributor_ && mqtt_client_)
@@ -78,66 +107,116 @@ BehaviorTreeController::~BehaviorTreeController()
         }
     }
 
+    MoveBatcher::install(nullptr);
+    CommandDeadline::install(nullptr);
     g_controller_instance = nullptr;
 }
 
 void BehaviorTreeController::requestShutdown()
 {
-    shutdown_flag_ = true;
+    for (auto &execution : executions_)
+    {
+        execution->stop_flag = true;
+    }
+    wakeController();
 }
 
 void BehaviorTreeController::onSigint()
 {
-    shutdown_flag_ = true;
     sigint_received_ = true;
+    requestShutdown();
 }
 
-bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr blackboard)
+void BehaviorTreeController::wakeController()
 {
-    std::cout << "Building equipment mapping from process AAS..." << std::endl;
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    wake_pending_ = true;
+    for (auto &execution : executions_)
+    {
+        if (execution->wake_root)
+        {
+            // Interrupts tree.sleep() the same way a node callback does
+            execution->wake_root->emitWakeUpSignal();
+        }
+    }
+    wake_cv_.notify_one();
+}
+
+void BehaviorTreeController::waitForWakeUp(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait_for(lock, timeout,
+                      [this]
+                      { return wake_pending_; });
+    wake_pending_ = false;
+}
+
+void BehaviorTreeController::setWakeRoot(ProcessExecution &execution, BT::TreeNode *root)
+{
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    execution.wake_root = root;
+}
+
+bool BehaviorTreeController::fetchAndBuildEquipmentMapping(ProcessExecution &execution, BT::Blackboard::Ptr blackboard)
+{
+    BT_LOG_INFO << "Building equipment mapping from process AAS...";
 
     // Get the process AAS ID
     std::string process_id;
     {
         std::lock_guard<std::mutex> lock(process_aas_id_mutex_);
-        process_id = process_aas_id_;
+        process_id = execution.process_aas_id;
     }
 
     if (process_id.empty())
     {
-        std::cerr << "No process AAS ID available!" << std::endl;
+        BT_LOG_ERROR << "No process AAS ID available!";
         return false;
     }
 
-    std::cout << "Process AAS ID: " << process_id << std::endl;
+    BT_LOG_INFO << "Process AAS ID: " << process_id;
 
     try
     {
         // Clear existing mapping
         {
             std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-            equipment_aas_mapping_.clear();
+            execution.equipment_aas_mapping.clear();
         }
 
+        // Start the run from current AAS content rather than the previous run's memo;
+        // a tree already running keeps working from it
+        if (!hasOtherLiveExecution(execution))
+        {
+            aas_client_->clearMemo();
+        }
+
+        // ProcessInformation does not depend on the capabilities, so both submodels are
+        // fetched at once; an early return below still waits for it in the future's destructor
+        auto process_info_future = std::async(std::launch::async,
+                                              [this, &process_id]()
+                                              { return aas_client_->fetchProcessInformation(process_id); });
+
         // Fetch the RequiredCapabilities submodel from the process AAS
         auto capabilities_opt = aas_client_->fetchRequiredCapabilities(process_id);
         if (!capabilities_opt.has_value())
         {
-            std::cerr << "Could not fetch RequiredCapabilities from process AAS: " << process_id << std::endl;
+            BT_LOG_ERROR << "Could not fetch RequiredCapabilities from process AAS: " << process_id;
             return false;
         }
 
         const auto &capabilities = capabilities_opt.value();
-        std::cout << "Found RequiredCapabilities submodel" << std::endl;
+        BT_LOG_INFO << "Found RequiredCapabilities submodel";
 
         // Parse each capability and extract the resource references
         if (!capabilities.contains("submodelElements") || !capabilities["submodelElements"].is_array())
         {
-            std::cerr << "No submodelElements in RequiredCapabilities" << std::endl;
+            BT_LOG_ERROR << "No submodelElements in RequiredCapabilities";
             return false;
         }
 
         std::set<std::string> processed_resources;
+        std::map<std::string, std::vector<std::string>> capability_resources; // Resource names until mapped
 
         // Each submodelElement is a capability (SubmodelElementCollection)
         for (const auto &capability : capabilities["submodelElements"])
@@ -149,7 +228,7 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
             }
 
             std::string capability_name = capability.value("idShort", "unknown");
-            std::cout << "  Processing capability: " << capability_name << std::endl;
+            BT_LOG_INFO << "  Processing capability: " << capability_name;
 
             // Navigate into the capability's value array to find the References collection
             if (!capability.contains("value") || !capability["value"].is_array())
@@ -192,6 +271,7 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
                     }
 
                     std::string resource_id_short = ref_element["idShort"].get<std::string>();
+                    capability_resources[capability_name].push_back(resource_id_short);
 
                     // Skip if already processed
                     if (processed_resources.find(resource_id_short) != processed_resources.end())
@@ -235,19 +315,19 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
 
                     if (aas_shell_id.empty())
                     {
-                        std::cerr << "    Could not derive AAS shell ID for: " << resource_id_short << std::endl;
+                        BT_LOG_ERROR << "    Could not derive AAS shell ID for: " << resource_id_short;
                         continue;
                     }
 
                     // Use the resource idShort (with AAS suffix) as the key
                     std::string resource_name = resource_id_short;
 
-                    std::cout << "    Found resource: " << resource_name << " -> " << aas_shell_id << std::endl;
+                    BT_LOG_INFO << "    Found resource: " << resource_name << " -> " << aas_shell_id;
 
                     // Add to equipment mapping
                     {
                         std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-                        equipment_aas_mapping_[resource_name] = aas_shell_id;
+                        execution.equipment_aas_mapping[resource_name] = aas_shell_id;
                     }
                 }
             }
@@ -256,22 +336,38 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
         {
             std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
 
-            if (equipment_aas_mapping_.empty())
+            if (execution.equipment_aas_mapping.empty())
             {
-                std::cerr << "No equipment found in process AAS RequiredCapabilities!" << std::endl;
+                BT_LOG_ERROR << "No equipment found in process AAS RequiredCapabilities!";
                 return false;
             }
 
-            std::cout << "Equipment mapping built successfully with "
-                      << equipment_aas_mapping_.size() << " entries:" << std::endl;
-            for (const auto &[name, id] : equipment_aas_mapping_)
+            BT_LOG_INFO << "Equipment mapping built successfully with "
+                        << execution.equipment_aas_mapping.size() << " entries:";
+            for (const auto &[name, id] : execution.equipment_aas_mapping)
             {
-                std::cout << "  " << name << " -> " << id << std::endl;
+                BT_LOG_INFO << "  " << name << " -> " << id;
+            }
+
+            // The scheduler picks among a capability's resources by their AAS IDs, as Occupy's Assets do
+            for (auto &[capability_name, resources] : capability_resources)
+            {
+                std::vector<std::string> resource_ids;
+                for (const auto &resource_name : resources)
+                {
+                    auto mapped = execution.equipment_aas_mapping.find(resource_name);
+                    if (mapped != execution.equipment_aas_mapping.end())
+                    {
+                        resource_ids.push_back(mapped->second);
+                    }
+                }
+                resources = std::move(resource_ids);
             }
         }
+        AssignmentScheduler::instance().updateCapabilities(execution.slot, capability_resources);
 
         // Fetch the ProductReference from ProcessInformation submodel
-        auto process_info_opt = aas_client_->fetchProcessInformation(process_id);
+        auto process_info_opt = process_info_future.get();
         if (process_info_opt.has_value())
         {
             const auto &process_info = process_info_opt.value();
@@ -295,8 +391,8 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
                             std::string product_aas_id = element["value"]["keys"][0]["value"].get<std::string>();
                             
                             std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-                            equipment_aas_mapping_["product"] = product_aas_id;
-                            std::cout << "  Found product AAS: product -> " << product_aas_id << std::endl;
+                            execution.equipment_aas_mapping["product"] = product_aas_id;
+                            BT_LOG_INFO << "  Found product AAS: product -> " << product_aas_id;
                         }
                         break;
                     }
@@ -305,118 +401,209 @@ bool BehaviorTreeController::fetchAndBuildEquipmentMapping(BT::Blackboard::Ptr b
         }
         else
         {
-            std::cerr << "Warning: Could not fetch ProcessInformation submodel, product AAS will not be available" << std::endl;
+            BT_LOG_WARN << "Could not fetch ProcessInformation submodel, product AAS will not be available";
         }
 
         // Populate blackboard if provided
         if (blackboard)
         {
-            populateBlackboard(blackboard);
+            populateBlackboard(execution, blackboard);
         }
 
         return true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching equipment from process AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching equipment from process AAS: " << e.what();
         return false;
     }
 }
 
-void BehaviorTreeController::populateBlackboard(BT::Blackboard::Ptr blackboard)
+void BehaviorTreeController::populateBlackboard(const ProcessExecution &execution, BT::Blackboard::Ptr blackboard)
 {
     if (!blackboard)
     {
-        std::cerr << "Cannot populate blackboard: blackboard is null" << std::endl;
+        BT_LOG_ERROR << "Cannot populate blackboard: blackboard is null";
         return;
     }
 
     std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-    std::cout << "Populating blackboard with equipment mapping..." << std::endl;
+    BT_LOG_INFO << "Populating blackboard with equipment mapping...";
 
     // Store each equipment mapping in the blackboard
     // Simple name -> AAS URL (e.g., "LoadingSystemAAS" -> "https://.../imaLoadingSystemAAS")
-    for (const auto &[equipment_name, aas_id] : equipment_aas_mapping_)
+    for (const auto &[equipment_name, aas_id] : execution.equipment_aas_mapping)
     {
         blackboard->set(equipment_name, aas_id);
-        std::cout << "  Set blackboard[" << equipment_name << "] = " << aas_id << std::endl;
+        BT_LOG_INFO << "  Set blackboard[" << equipment_name << "] = " << aas_id;
     }
 
-    std::cout << "Blackboard populated with " << equipment_aas_mapping_.size() << " equipment entries" << std::endl;
+    BT_LOG_INFO << "Blackboard populated with " << execution.equipment_aas_mapping.size() << " equipment entries";
 }
 
-bool BehaviorTreeController::prefetchAssetInterfaces()
+bool BehaviorTreeController::prefetchAssetInterfaces(const ProcessExecution &execution)
 {
-    std::cout << "Pre-fetching asset interfaces..." << std::endl;
+    TraceSpan span("prefetchAssetInterfaces", "starting");
+    BT_LOG_INFO << "Pre-fetching asset interfaces...";
 
     // Get the equipment mapping
     std::map<std::string, std::string> mapping_copy;
     {
         std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-        mapping_copy = equipment_aas_mapping_;
+        mapping_copy = execution.equipment_aas_mapping;
     }
 
     if (mapping_copy.empty())
     {
-        std::cerr << "No equipment mapping available for prefetching" << std::endl;
+        BT_LOG_ERROR << "No equipment mapping available for prefetching";
         return false;
     }
 
-    // Pre-fetch all asset interface descriptions
-    if (!aas_interface_cache_->prefetchInterfaces(mapping_copy))
+    // The first Start resolves from the snapshot and checks it against the AAS afterwards
+    bool from_snapshot = false;
+    if (!snapshot_loaded_ && !app_params_.aas_snapshot_path.empty())
+    {
+        snapshot_loaded_ = true;
+        from_snapshot = aas_interface_cache_->loadSnapshot(app_params_.aas_snapshot_path, mapping_copy) > 0;
+    }
+
+    bool prefetched = false;
+    if (app_params_.warm_restart || from_snapshot)
     {
-        std::cerr << "Warning: Failed to prefetch some asset interfaces" << std::endl;
+        // Only assets that are new or point to another AAS since the last tree are fetched
+        size_t added = 0, changed = 0, removed = 0;
+        for (const auto &[name, id] : mapping_copy)
+        {
+            auto previous = execution.previous_equipment_mapping.find(name);
+            if (previous == execution.previous_equipment_mapping.end())
+            {
+                added++;
+            }
+            else if (previous->second != id)
+            {
+                changed++;
+            }
+        }
+        for (const auto &[name, id] : execution.previous_equipment_mapping)
+        {
+            removed += mapping_copy.count(name) == 0 ? 1 : 0;
+        }
+        BT_LOG_INFO << "Equipment mapping since last tree: " << added << " added, " << changed << " changed, "
+                    << removed << " removed";
+
+        prefetched = aas_interface_cache_->refreshInterfaces(mapping_copy);
+    }
+    else
+    {
+        // Pre-fetch all asset interface descriptions
+        prefetched = aas_interface_cache_->prefetchInterfaces(mapping_copy);
+    }
+
+    auto stats = aas_interface_cache_->getStats();
+    for (const auto &[asset_id, latency] : stats.asset_fetch_latency)
+    {
+        BT_LOG_INFO << "  " << asset_id << ": " << latency.count() << " ms";
+    }
+
+    if (from_snapshot)
+    {
+        // Assets the AAS describes differently now come back as ordinary change events
+        snapshot_revalidation_ = std::async(std::launch::async,
+                                            [this]()
+                                            {
+                                                std::vector<std::string> changed = aas_interface_cache_->revalidateSnapshot();
+                                                {
+                                                    std::lock_guard<std::mutex> lock(asset_change_mutex_);
+                                                    pending_asset_changes_.insert(changed.begin(), changed.end());
+                                                }
+                                                if (changed.empty())
+                                                {
+                                                    aas_interface_cache_->saveSnapshot(app_params_.aas_snapshot_path);
+                                                }
+                                                wakeController();
+                                            });
+    }
+    else if (!app_params_.aas_snapshot_path.empty())
+    {
+        aas_interface_cache_->saveSnapshot(app_params_.aas_snapshot_path);
+    }
+
+    if (!prefetched)
+    {
+        BT_LOG_WARN << "Failed to prefetch some asset interfaces";
         // Continue anyway - nodes can still fall back to direct AAS queries
         return false;
     }
 
-    std::cout << "Pre-fetch returning true" << std::endl << std::flush;
+    BT_LOG_INFO << "Pre-fetch returning true";
     return true;
 }
 
-bool BehaviorTreeController::subscribeToTopics()
+bool BehaviorTreeController::subscribeToTopics(const ProcessExecution &execution)
 {
-    std::cout << "Subscribing to topics for active nodes..." << std::endl;
+    BT_LOG_INFO << "Subscribing to topics for active nodes...";
 
     // Use the distributor to subscribe to specific topics for active nodes
     // This triggers delivery of retained messages
-    return node_message_distributor_->subscribeForActiveNodes(bt_tree_, std::chrono::seconds(5));
+    return node_message_distributor_->subscribeForActiveNodes(execution.tree, std::chrono::seconds(5));
+}
+
+void BehaviorTreeController::releaseUnusedSubscriptions()
+{
+    if (!node_message_distributor_ || !mqtt_client_)
+    {
+        return;
+    }
+
+    // Only the topics no remaining tree listens to
+    for (const auto &topic_str : node_message_distributor_->releaseUnusedTopics())
+    {
+        try
+        {
+            mqtt_client_->unsubscribe_topic(topic_str);
+        }
+        catch (const std::exception &e)
+        {
+            BT_LOG_ERROR << "Exception during unsubscribe: " << e.what();
+        }
+    }
 }
 
 bool BehaviorTreeController::registerNodesWithAASConfig()
 {
-    std::cout << "Entering registerNodesWithAASConfig..." << std::endl << std::flush;
+    BT_LOG_INFO << "Entering registerNodesWithAASConfig...";
     try
     {
         // Register all nodes (they will read equipment mapping from blackboard)
-        std::cout << "  Calling registerAllNodes..." << std::endl << std::flush;
+        BT_LOG_INFO << "  Calling registerAllNodes...";
         registerAllNodes(*bt_factory_, *node_message_distributor_, *mqtt_client_, *aas_client_);
-        std::cout << "  registerAllNodes complete" << std::endl << std::flush;
+        BT_LOG_INFO << "  registerAllNodes complete";
 
         // Set the node message distributor and interface cache for base classes
         MqttSubBase::setNodeMessageDistributor(node_message_distributor_.get());
         MqttSubBase::setAASInterfaceCache(aas_interface_cache_.get());
-        std::cout << "  Node registration complete" << std::endl << std::flush;
+        BT_LOG_INFO << "  Node registration complete";
         return true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception during node registration: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception during node registration: " << e.what();
         return false;
     }
 }
 
 void BehaviorTreeController::unregisterAllNodes()
 {
-    // Halt any running tree before unregistering
-    if (bt_tree_.rootNode())
+    // Halt any running tree before unregistering, and reset its Groot2 publisher
+    for (auto &execution : executions_)
     {
-        bt_tree_.haltTree();
+        if (execution->tree.rootNode())
+        {
+            execution->tree.haltTree();
+        }
+        execution->publisher.reset();
     }
 
-    // Reset Groot2 publisher
-    bt_publisher_.reset();
-
     // Reset node message distributor
     if (node_message_distributor_ && mqtt_client_)
     {
@@ -431,20 +618,31 @@ void BehaviorTreeController::unregisterAllNodes()
             }
             catch (const std::exception &e)
             {
-                std::cerr << "Exception during unsubscribe: " << e.what() << std::endl;
+                BT_LOG_ERROR << "Exception during unsubscribe: " << e.what();
             }
         }
     }
 
     // Recreate node message distributor to clear all registrations
-    node_message_distributor_ = std::make_unique<NodeMessageDistributor>(*mqtt_client_);
+    node_message_distributor_ = createNodeMessageDistributor();
 
     // Create a new BehaviorTreeFactory to completely clear all node registrations
     // This is necessary because BT factory doesn't provide a way to unregister individual nodes
     bt_factory_ = std::make_unique<BT::BehaviorTreeFactory>();
 
+    dropWarmState();
+
     nodes_registered_ = false;
-    std::cout << "All nodes unregistered." << std::endl;
+    BT_LOG_INFO << "All nodes unregistered.";
+}
+
+void BehaviorTreeController::dropWarmState()
+{
+    for (auto &execution : executions_)
+    {
+        execution->previous_equipment_mapping.clear();
+    }
+    tree_templates_.dropParsed();
 }
 
 int BehaviorTreeController::run()
@@ -458,85 +656,249 @@ int BehaviorTreeController::run()
 
     while (true)
     {
-        // Handle reset command - transition to RESETTING state
-        if (mqtt_reset_bt_flag_.load())
+        for (auto &execution : executions_)
         {
-            if (!sigint_received_.load())
-            {
-                processResettingState();
-            }
-            mqtt_reset_bt_flag_ = false;
+            serviceExecutionCommands(*execution);
         }
+        applyAssetChanges();
+        updateStartShare();
 
-        // Handle shutdown/stop during execution
-        if (shutdown_flag_.load() && !mqtt_start_bt_flag_.load())
+        // Only exit on SIGINT
+        if (sigint_received_.load())
         {
-            if (current_packml_state_ == PackML::State::EXECUTE)
-            {
-                // Stop will be handled in manageRunningBehaviorTree
-            }
-            else if (current_packml_state_ == PackML::State::IDLE)
-            {
-                // Transition from IDLE to STOPPED when stop command received
-                setStateAndPublish(PackML::State::STOPPED);
-            }
-            // If already in STOPPED or COMPLETE, remain there until reset
-
-            // Only exit on SIGINT
-            if (sigint_received_.load())
-            {
-                break;
-            }
+            break;
         }
 
-        // Handle start command
-        if (mqtt_start_bt_flag_.load())
+        publishMetricsIfDue();
+
+        // Missed command deadlines resend or fail their nodes before the trees see them
+        command_deadlines_->advance();
+
+        // Tick every tree in EXECUTE state
+        ProcessExecution *ticked_execution = nullptr;
+        size_t ticked = 0;
+        for (auto &execution : executions_)
         {
-            if (!sigint_received_.load() && current_packml_state_ == PackML::State::IDLE)
+            if (execution->packml_state == PackML::State::EXECUTE && manageRunningBehaviorTree(*execution))
             {
-                processBehaviorTreeStart();
+                ticked_execution = execution.get();
+                ticked++;
             }
-            mqtt_start_bt_flag_ = false;
         }
 
-        // Handle unsuspend command
-        if (mqtt_unsuspend_bt_flag_.load())
+        // Moves the trees issued this loop leave together, once their window has passed
+        if (move_batcher_)
         {
-            if (!sigint_received_.load() && current_packml_state_ == PackML::State::SUSPENDED)
-            {
-                processBehaviorTreeUnsuspend();
-            }
-            mqtt_unsuspend_bt_flag_ = false;
+            move_batcher_->flush();
         }
 
-        // Execute behavior tree if in EXECUTE state
-        if (current_packml_state_ == PackML::State::EXECUTE)
+        // Sleep until a node callback or command emits a wake-up signal. A single tree sleeps
+        // on its own signal; with several, node deliveries wake the controller instead. The
+        // next command deadline or move batch cuts the wait short.
+        auto idle = command_deadlines_->untilNext(
+            std::chrono::milliseconds(std::max(app_params_.max_idle_interval_ms, 1)));
+        if (move_batcher_)
         {
-            manageRunningBehaviorTree();
+            idle = move_batcher_->untilFlush(idle);
+        }
+        // Deadlines and windows are line time; a faster simulation sleeps that much less
+        auto wall_idle = SimClock::toWall(idle);
+        if (ticked == 1)
+        {
+            ticked_execution->tree.sleep(wall_idle);
         }
         else
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            waitForWakeUp(wall_idle);
         }
     }
+    // Everything logged while running is written before the shutdown in the destructor starts
+    logging::flush();
     return 0;
 }
 
+void BehaviorTreeController::serviceExecutionCommands(ProcessExecution &execution)
+{
+    // Handle reset command - transition to RESETTING state
+    if (execution.reset_flag.load())
+    {
+        if (!sigint_received_.load())
+        {
+            processResettingState(execution);
+        }
+        execution.reset_flag = false;
+    }
+
+    // Handle stop outside of execution; during EXECUTE it is handled in manageRunningBehaviorTree
+    if (execution.stop_flag.load() && !execution.start_flag.load() &&
+        execution.packml_state == PackML::State::IDLE)
+    {
+        // Transition from IDLE to STOPPED when stop command received
+        setStateAndPublish(execution, PackML::State::STOPPED);
+        execution.stop_flag = false;
+    }
+    // If already in STOPPED or COMPLETE, remain there until reset
+
+    // Handle start command
+    if (execution.start_flag.load())
+    {
+        if (!sigint_received_.load() && execution.packml_state == PackML::State::IDLE)
+        {
+            processBehaviorTreeStart(execution);
+        }
+        execution.start_flag = false;
+    }
+
+    // Handle unsuspend command
+    if (execution.unsuspend_flag.load())
+    {
+        if (!sigint_received_.load() && execution.packml_state == PackML::State::SUSPENDED)
+        {
+            processBehaviorTreeUnsuspend(execution);
+        }
+        execution.unsuspend_flag = false;
+    }
+}
+
+void BehaviorTreeController::createProcessExecutions()
+{
+    size_t slots = static_cast<size_t>(std::max(app_params_.max_concurrent_processes, 1));
+    for (size_t slot = 0; slot < slots; ++slot)
+    {
+        auto execution = std::make_unique<ProcessExecution>();
+        execution->slot = slot;
+        execution->tick_latency = &LatencyMetrics::instance().histogram("tick", "main");
+
+        if (slots == 1)
+        {
+            // Single process: the controller's own topics, as before concurrent execution
+            execution->state_publication_config = app_params_.state_publication_config;
+            execution->start_response_topic = app_params_.start_response_topic;
+            execution->stop_response_topic = app_params_.stop_response_topic;
+            execution->suspend_response_topic = app_params_.suspend_response_topic;
+            execution->unsuspend_response_topic = app_params_.unsuspend_response_topic;
+            execution->reset_response_topic = app_params_.reset_response_topic;
+        }
+        else
+        {
+            std::string data_prefix = app_params_.unsTopicPrefix + "/" + app_params_.clientId +
+                                      "/Process" + std::to_string(slot + 1) + "/DATA/";
+            const auto &state_config = app_params_.state_publication_config;
+            execution->state_publication_config = mqtt_utils::Topic(
+                data_prefix + "State", state_config.getSchema(), state_config.getQos(), state_config.getRetain());
+            execution->start_response_topic = data_prefix + "Start";
+            execution->stop_response_topic = data_prefix + "Stop";
+            execution->suspend_response_topic = data_prefix + "Suspend";
+            execution->unsuspend_response_topic = data_prefix + "Unsuspend";
+            execution->reset_response_topic = data_prefix + "Reset";
+        }
+        executions_.push_back(std::move(execution));
+    }
+
+    if (slots > 1)
+    {
+        BT_LOG_INFO << "Hosting up to " << slots << " concurrent processes under "
+                    << app_params_.unsTopicPrefix << "/" << app_params_.clientId << "/Process<N>";
+    }
+}
+
+ProcessExecution *BehaviorTreeController::findStartableExecution()
+{
+    for (auto &execution : executions_)
+    {
+        if (execution->packml_state == PackML::State::IDLE && !execution->start_flag.load())
+        {
+            return execution.get();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<ProcessExecution *> BehaviorTreeController::findTargetExecutions(const nlohmann::json &payload,
+                                                                           bool group_command)
+{
+    std::vector<ProcessExecution *> targets;
+    bool by_process = (executions_.size() > 1 || group_command) &&
+                      payload.contains("Process") && payload["Process"].is_string();
+
+    std::lock_guard<std::mutex> lock(process_aas_id_mutex_);
+    for (auto &execution : executions_)
+    {
+        if (!by_process || execution->process_aas_id == payload["Process"].get<std::string>())
+        {
+            targets.push_back(execution.get());
+        }
+    }
+    return targets;
+}
+
+void BehaviorTreeController::updateStartShare()
+{
+    if (app_params_.group_command_prefix.empty() || !mqtt_client_)
+    {
+        return;
+    }
+
+    bool want = !sigint_received_.load() && findStartableExecution() != nullptr;
+    if (want == in_start_share_)
+    {
+        return;
+    }
+
+    std::string share = "$share/" + app_params_.shared_group + "/" + app_params_.group_command_prefix + "Start";
+    if (want)
+    {
+        mqtt_client_->subscribe_topic(share, 2);
+    }
+    else
+    {
+        mqtt_client_->unsubscribe_topic(share);
+    }
+    in_start_share_ = want;
+    BT_LOG_INFO << (want ? "Joined" : "Left") << " shared Start subscription of group '"
+                << app_params_.shared_group << "'";
+}
+
+bool BehaviorTreeController::hasOtherLiveExecution(const ProcessExecution &execution) const
+{
+    for (const auto &other : executions_)
+    {
+        if (other.get() != &execution && other->tree.rootNode())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string BehaviorTreeController::takePendingUuid(ProcessExecution &execution,
+                                                    std::string ProcessExecution::*pending)
+{
+    std::lock_guard<std::mutex> lock(pending_command_mutex_);
+    std::string uuid = std::move(execution.*pending);
+    (execution.*pending).clear();
+    return uuid;
+}
+
 void BehaviorTreeController::loadAppConfiguration(int argc, char *argv[])
 {
-    bt_utils::loadConfigFromYaml(
-        app_params_.configFile,
-        app_params_.generate_xml_models,
-        app_params_.serverURI,
-        app_params_.clientId,
-        app_params_.unsTopicPrefix,
-        app_params_.aasServerUrl,
-        app_params_.aasRegistryUrl,
-        app_params_.groot2_port,
-        app_params_.bt_description_path,
-        app_params_.bt_nodes_path,
-        app_params_.registration_config_path,
-        app_params_.registration_topic_pattern);
+    bt_utils::loadConfigFromYaml(app_params_.configFile, app_params_);
+
+    schema_utils::setSchemaCacheDirectory(app_params_.schema_cache_dir);
+    mqtt_utils::setValidationConfig(app_params_.validation);
+    if (auto level = logging::parseLevel(app_params_.log_level))
+    {
+        logging::setLevel(*level);
+    }
+    else
+    {
+        BT_LOG_WARN << "Unknown log level '" << app_params_.log_level << "', keeping info";
+    }
+    TickPool::instance().configure(static_cast<size_t>(std::max(app_params_.parallel_tick_workers, 0)));
+    // Before anything takes a time point from it
+    SimClock::configure(app_params_.sim_clock);
+    CommandTrace::configure(app_params_.command_trace);
+    AssignmentScheduler::instance().configure(app_params_.scheduler);
 
     for (int i = 1; i < argc; ++i)
     {
@@ -547,6 +909,11 @@ void BehaviorTreeController::loadAppConfiguration(int argc, char *argv[])
         }
     }
 
+    app_params_.command_prefix = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/CMD/";
+    if (!app_params_.shared_group.empty())
+    {
+        app_params_.group_command_prefix = app_params_.unsTopicPrefix + "/" + app_params_.shared_group + "/CMD/";
+    }
     app_params_.start_topic = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/CMD/Start";
     app_params_.stop_topic = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/CMD/Stop";
     app_params_.suspend_topic = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/CMD/Suspend";
@@ -569,10 +936,11 @@ void BehaviorTreeController::loadAppConfiguration(int argc, char *argv[])
         {
             app_params_.registration_topic.replace(pos, 11, app_params_.clientId);
         }
-        std::cout << "  Registration Topic: " << app_params_.registration_topic << std::endl;
+        BT_LOG_INFO << "  Registration Topic: " << app_params_.registration_topic;
     }
 
     std::string state_topic_str = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/DATA/State";
+    app_params_.metrics_topic = app_params_.unsTopicPrefix + "/" + app_params_.clientId + "/DATA/Metrics";
     std::string state_schema_url = "https://aausmartproductionlab.github.io/AP2030-UNS/MQTTSchemas/state.schema.json";
 
     // Fetch and resolve the state schema
@@ -584,16 +952,51 @@ void BehaviorTreeController::loadAppConfiguration(int argc, char *argv[])
     }
     else
     {
-        std::cerr << "Warning: Failed to fetch state schema, creating topic without schema validation" << std::endl;
+        BT_LOG_WARN << "Failed to fetch state schema, creating topic without schema validation";
         app_params_.state_publication_config = mqtt_utils::Topic(state_topic_str, nlohmann::json(), 2, true);
     }
 }
 
+std::unique_ptr<NodeMessageDistributor> BehaviorTreeController::createNodeMessageDistributor()
+{
+    auto distributor = std::make_unique<NodeMessageDistributor>(
+        *mqtt_client_,
+        static_cast<size_t>(std::max(app_params_.dispatch_workers, 0)),
+        static_cast<size_t>(std::max(app_params_.dispatch_queue_capacity, 1)),
+        app_params_.last_value_cache);
+
+    // Node callbacks only wake their own tree; with several trees the main loop waits on the controller
+    if (executions_.size() > 1)
+    {
+        distributor->setDeliveryHook([this]
+                                     { wakeController(); });
+    }
+    return distributor;
+}
+
 void BehaviorTreeController::setupMainMqttMessageHandler()
 {
     main_mqtt_message_handler_ =
-        [this](const std::string &topic, const nlohmann::json &payload, mqtt::properties props)
-    {
+        [this](const std::string &message_topic, const std::shared_ptr<const nlohmann::json> &shared_payload,
+               mqtt::properties props)
+    {
+        const nlohmann::json &payload = *shared_payload;
+        // A group command is handled as this instance's own command of the same name
+        const std::string &group_prefix = this->app_params_.group_command_prefix;
+        bool group_command = !group_prefix.empty() && message_topic.starts_with(group_prefix);
+        std::string own_topic;
+        if (group_command)
+        {
+            own_topic = this->app_params_.command_prefix + message_topic.substr(group_prefix.size());
+        }
+        const std::string &topic = group_command ? own_topic : message_topic;
+
+        if (!this->app_params_.sim_clock.topic.empty() && topic == this->app_params_.sim_clock.topic)
+        {
+            SimClock::sync(payload);
+            return;
+        }
+
         if (topic == this->app_params_.start_topic)
         {
             std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
@@ -603,10 +1006,19 @@ void BehaviorTreeController::setupMainMqttMessageHandler()
             if (!this->sigint_received_.load())
             {
                 // Only allow start from IDLE state
-                if (this->current_packml_state_ != PackML::State::IDLE)
+                ProcessExecution *execution = this->findStartableExecution();
+                if (!execution)
                 {
-                    std::cerr << "Cannot start from " << PackML::stateToString(this->current_packml_state_)
-                              << " state. Must be in IDLE state." << std::endl;
+                    if (this->executions_.size() == 1)
+                    {
+                        BT_LOG_ERROR << "Cannot start from " << PackML::stateToString(this->executions_.front()->packml_state)
+                                     << " state. Must be in IDLE state.";
+                    }
+                    else
+                    {
+                        BT_LOG_ERROR << "Cannot start: none of the " << this->executions_.size()
+                                     << " process slots is in IDLE state.";
+                    }
                     this->publishCommandResponse(this->app_params_.start_response_topic, uuid, false);
                     return;
                 }
@@ -614,108 +1026,136 @@ void BehaviorTreeController::setupMainMqttMessageHandler()
                 // Extract Process AAS ID from the Start command payload
                 if (!payload.contains("Process") || !payload["Process"].is_string())
                 {
-                    std::cerr << "Cannot start: Start command must contain 'Process' field with AAS ID" << std::endl;
-                    this->publishCommandResponse(this->app_params_.start_response_topic, uuid, false);
+                    BT_LOG_ERROR << "Cannot start: Start command must contain 'Process' field with AAS ID";
+                    this->publishCommandResponse(execution->start_response_topic, uuid, false);
                     return;
                 }
 
                 {
                     std::lock_guard<std::mutex> lock(this->process_aas_id_mutex_);
-                    this->process_aas_id_ = payload["Process"].get<std::string>();
+                    execution->process_aas_id = payload["Process"].get<std::string>();
                 }
-                std::cout << "Received Start command with Process: " << payload["Process"].get<std::string>() << std::endl;
+                BT_LOG_INFO << "Received Start command with Process: " << payload["Process"].get<std::string>()
+                            << (this->executions_.size() > 1 ? " (slot Process" + std::to_string(execution->slot + 1) + ")"
+                                                             : std::string());
 
                 // Store UUID for response after processing
                 {
                     std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
-                    this->pending_start_uuid_ = uuid;
+                    execution->pending_start_uuid = uuid;
                 }
 
-                this->shutdown_flag_ = false;
-                this->mqtt_suspend_bt_flag_ = false;
-                this->mqtt_unsuspend_bt_flag_ = false;
-                this->mqtt_reset_bt_flag_ = false;
-                this->mqtt_start_bt_flag_ = true;
+                execution->stop_flag = false;
+                execution->suspend_flag = false;
+                execution->unsuspend_flag = false;
+                execution->reset_flag = false;
+                execution->start_flag = true;
+                this->wakeController();
             }
             else
             {
                 this->publishCommandResponse(this->app_params_.start_response_topic, uuid, false);
             }
+            return;
         }
-        else if (topic == this->app_params_.stop_topic)
+
+        if (!this->app_params_.registration_response_topic.empty() &&
+            topic == this->app_params_.registration_response_topic)
         {
-            std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
-                                   ? payload["Uuid"].get<std::string>()
-                                   : "";
+            this->queueAssetChange(payload);
+            return;
+        }
+
+        bool is_command = topic == this->app_params_.stop_topic || topic == this->app_params_.suspend_topic ||
+                          topic == this->app_params_.unsuspend_topic || topic == this->app_params_.reset_topic;
+        if (!is_command)
+        {
+            if (this->node_message_distributor_)
+            {
+                this->node_message_distributor_->handle_incoming_message(topic, shared_payload, props);
+            }
+            else
             {
-                std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
-                this->pending_stop_uuid_ = uuid;
+                BT_LOG_ERROR << "MQTT message for NMD, but NodeMessageDistributor is null. Topic: "
+                             << topic;
             }
-            this->requestShutdown();
+            return;
         }
-        else if (topic == this->app_params_.suspend_topic)
+
+        std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
+                               ? payload["Uuid"].get<std::string>()
+                               : "";
+        std::vector<ProcessExecution *> targets = this->findTargetExecutions(payload, group_command);
+        if (targets.empty())
         {
-            std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
-                                   ? payload["Uuid"].get<std::string>()
-                                   : "";
+            if (group_command)
             {
-                std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
-                this->pending_suspend_uuid_ = uuid;
+                return; // Another controller of the group runs that process
             }
-            this->mqtt_suspend_bt_flag_ = true;
+            BT_LOG_ERROR << "No process slot runs Process " << payload["Process"].get<std::string>();
+            std::string response_topic = topic == this->app_params_.stop_topic        ? this->app_params_.stop_response_topic
+                                         : topic == this->app_params_.suspend_topic   ? this->app_params_.suspend_response_topic
+                                         : topic == this->app_params_.unsuspend_topic ? this->app_params_.unsuspend_response_topic
+                                                                                      : this->app_params_.reset_response_topic;
+            this->publishCommandResponse(response_topic, uuid, false);
+            return;
         }
-        else if (topic == this->app_params_.unsuspend_topic)
+
+        for (ProcessExecution *execution : targets)
         {
-            std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
-                                   ? payload["Uuid"].get<std::string>()
-                                   : "";
-            if (this->current_packml_state_ == PackML::State::SUSPENDED)
+            if (topic == this->app_params_.stop_topic)
             {
                 {
                     std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
-                    this->pending_unsuspend_uuid_ = uuid;
+                    execution->pending_stop_uuid = uuid;
                 }
-                this->mqtt_unsuspend_bt_flag_ = true;
+                execution->stop_flag = true;
             }
-            else
-            {
-                std::cerr << "Unsuspend command can only be used from SUSPENDED state." << std::endl;
-                this->publishCommandResponse(this->app_params_.unsuspend_response_topic, uuid, false);
-            }
-        }
-        else if (topic == this->app_params_.reset_topic)
-        {
-            std::string uuid = (payload.contains("Uuid") && payload["Uuid"].is_string())
-                                   ? payload["Uuid"].get<std::string>()
-                                   : "";
-            if (this->current_packml_state_ == PackML::State::STOPPED ||
-                this->current_packml_state_ == PackML::State::COMPLETE ||
-                this->current_packml_state_ == PackML::State::ABORTED)
+            else if (topic == this->app_params_.suspend_topic)
             {
                 {
                     std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
-                    this->pending_reset_uuid_ = uuid;
+                    execution->pending_suspend_uuid = uuid;
                 }
-                this->mqtt_reset_bt_flag_ = true;
+                execution->suspend_flag = true;
             }
-            else
+            else if (topic == this->app_params_.unsuspend_topic)
             {
-                std::cerr << "Reset command can only be used from STOPPED, COMPLETE, or ABORTED states." << std::endl;
-                this->publishCommandResponse(this->app_params_.reset_response_topic, uuid, false);
-            }
-        }
-        else
-        {
-            if (this->node_message_distributor_)
-            {
-                this->node_message_distributor_->handle_incoming_message(topic, payload, props);
+                if (execution->packml_state == PackML::State::SUSPENDED)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
+                        execution->pending_unsuspend_uuid = uuid;
+                    }
+                    execution->unsuspend_flag = true;
+                }
+                else
+                {
+                    BT_LOG_ERROR << "Unsuspend command can only be used from SUSPENDED state.";
+                    this->publishCommandResponse(execution->unsuspend_response_topic, uuid, false);
+                }
             }
             else
             {
-                std::cerr << "MQTT message for NMD, but NodeMessageDistributor is null. Topic: "
-                          << topic << std::endl;
+                PackML::State state = execution->packml_state;
+                if (state == PackML::State::STOPPED ||
+                    state == PackML::State::COMPLETE ||
+                    state == PackML::State::ABORTED)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(this->pending_command_mutex_);
+                        execution->pending_reset_uuid = uuid;
+                    }
+                    execution->reset_flag = true;
+                }
+                else
+                {
+                    BT_LOG_ERROR << "Reset command can only be used from STOPPED, COMPLETE, or ABORTED states.";
+                    this->publishCommandResponse(execution->reset_response_topic, uuid, false);
+                }
             }
         }
+        this->wakeController();
     };
 }
 
@@ -723,29 +1163,72 @@ void BehaviorTreeController::initializeMqttControlInterface()
 {
     if (!mqtt_client_)
     {
-        std::cerr << "Error: mqtt_client_ is null in initializeMqttControlInterface." << std::endl;
+        BT_LOG_ERROR << "Error: mqtt_client_ is null in initializeMqttControlInterface.";
         return;
     }
 
     setupMainMqttMessageHandler();
     mqtt_client_->set_message_handler(main_mqtt_message_handler_);
 
+    // Stations publishing over MQTT 3.1.1 send no content-type; their AAS declares the encoding.
+    // With lazy_payload_parsing, messages no node handles are dropped before parsing.
+    bool drop_unrouted = app_params_.lazy_payload_parsing;
+    mqtt_client_->set_topic_route(
+        [this, drop_unrouted](const std::string &topic) -> std::optional<mqtt_utils::PayloadEncoding>
+        {
+            if (topic == app_params_.start_topic || topic == app_params_.stop_topic ||
+                topic == app_params_.suspend_topic || topic == app_params_.unsuspend_topic ||
+                topic == app_params_.reset_topic ||
+                (!app_params_.registration_response_topic.empty() && topic == app_params_.registration_response_topic) ||
+                (!app_params_.group_command_prefix.empty() && topic.starts_with(app_params_.group_command_prefix)) ||
+                (SimClock::mode() == SimClock::Mode::Driven && topic == app_params_.sim_clock.topic))
+            {
+                return mqtt_utils::PayloadEncoding::Json;
+            }
+            auto route = node_message_distributor_ ? node_message_distributor_->routeFor(topic) : std::nullopt;
+            if (!route && !drop_unrouted)
+            {
+                return mqtt_utils::PayloadEncoding::Json;
+            }
+            return route;
+        });
+
     mqtt_client_->subscribe_topic(app_params_.start_topic, 2);
     mqtt_client_->subscribe_topic(app_params_.stop_topic, 2);
     mqtt_client_->subscribe_topic(app_params_.suspend_topic, 2);
     mqtt_client_->subscribe_topic(app_params_.unsuspend_topic, 2);
     mqtt_client_->subscribe_topic(app_params_.reset_topic, 2);
+    if (!app_params_.registration_response_topic.empty())
+    {
+        mqtt_client_->subscribe_topic(app_params_.registration_response_topic, 2);
+    }
+    if (SimClock::mode() == SimClock::Mode::Driven && !app_params_.sim_clock.topic.empty())
+    {
+        mqtt_client_->subscribe_topic(app_params_.sim_clock.topic, 0);
+    }
+    if (!app_params_.group_command_prefix.empty())
+    {
+        // Every member sees these and acts only on the processes it runs; Start is shared
+        for (const char *command : {"Stop", "Suspend", "Unsuspend", "Reset"})
+        {
+            mqtt_client_->subscribe_topic(app_params_.group_command_prefix + command, 2);
+        }
+        updateStartShare();
+    }
 
-    std::cout << "MQTT control interface initialized." << std::endl;
+    BT_LOG_INFO << "MQTT control interface initialized.";
 
     // Publish orchestrator config to registration service for AAS generation
     if (!publishConfigToRegistrationService())
     {
-        std::cerr << "Warning: Failed to publish config to registration service" << std::endl;
-        std::cerr << "         The AAS may not be generated/updated" << std::endl;
+        BT_LOG_WARN << "Failed to publish config to registration service";
+        BT_LOG_WARN << "The AAS may not be generated/updated";
     }
 
-    publishCurrentState();
+    for (const auto &execution : executions_)
+    {
+        publishCurrentState(*execution);
+    }
 }
 
 bool BehaviorTreeController::handleGenerateXmlModelsOption()
@@ -753,85 +1236,139 @@ bool BehaviorTreeController::handleGenerateXmlModelsOption()
     if (app_params_.generate_xml_models)
     {
         // For XML generation, we need a dummy configuration
-        std::cout << "Generating XML models requires station configuration..." << std::endl;
+        BT_LOG_INFO << "Generating XML models requires station configuration...";
 
         if (!nodes_registered_)
         {
             // Fetch equipment mapping from AAS if not already done
-            if (equipment_aas_mapping_.empty())
+            if (executions_.front()->equipment_aas_mapping.empty())
             {
-                fetchAndBuildEquipmentMapping(nullptr);
+                fetchAndBuildEquipmentMapping(*executions_.front(), nullptr);
             }
             registerNodesWithAASConfig();
         }
 
         std::string xml_models = BT::writeTreeNodesModelXML(*bt_factory_);
         bt_utils::saveXmlToFile(xml_models, app_params_.bt_nodes_path);
-        std::cout << "XML models saved to: " << app_params_.bt_nodes_path << std::endl;
+        BT_LOG_INFO << "XML models saved to: " << app_params_.bt_nodes_path;
         return true;
     }
     return false;
 }
 
-void BehaviorTreeController::setStateAndPublish(PackML::State new_packml_state,
+void BehaviorTreeController::setStateAndPublish(ProcessExecution &execution, PackML::State new_packml_state,
                                                 std::optional<BT::NodeStatus> new_bt_tick_status_opt)
 {
     bool state_changed = false;
 
-    if (current_packml_state_ != new_packml_state)
+    if (execution.packml_state != new_packml_state)
     {
-        current_packml_state_ = new_packml_state;
+        execution.packml_state = new_packml_state;
         state_changed = true;
 
         // Log state transitions
-        std::cout << "State transition to: " << PackML::stateToString(new_packml_state) << std::endl;
+        BT_LOG_INFO << "State transition to: " << PackML::stateToString(new_packml_state)
+                    << (executions_.size() > 1 ? " (Process" + std::to_string(execution.slot + 1) + ")" : std::string());
     }
 
-    if (new_bt_tick_status_opt.has_value() && current_bt_tick_status_ != new_bt_tick_status_opt.value())
+    if (new_bt_tick_status_opt.has_value() && execution.bt_tick_status != new_bt_tick_status_opt.value())
     {
-        current_bt_tick_status_ = new_bt_tick_status_opt.value();
+        execution.bt_tick_status = new_bt_tick_status_opt.value();
         state_changed = true;
     }
 
-    if (current_packml_state_ != PackML::State::EXECUTE && current_packml_state_ != PackML::State::COMPLETE)
+    if (execution.packml_state != PackML::State::EXECUTE && execution.packml_state != PackML::State::COMPLETE)
     {
-        if (current_bt_tick_status_ != BT::NodeStatus::IDLE)
+        if (execution.bt_tick_status != BT::NodeStatus::IDLE)
         {
-            current_bt_tick_status_ = BT::NodeStatus::IDLE;
+            execution.bt_tick_status = BT::NodeStatus::IDLE;
             state_changed = true;
         }
     }
 
     if (state_changed)
     {
-        publishCurrentState();
+        publishCurrentState(execution);
     }
 }
 
-void BehaviorTreeController::publishCurrentState()
+void BehaviorTreeController::publishCurrentState(const ProcessExecution &execution)
 {
     if (!mqtt_client_ || !mqtt_client_->is_connected())
     {
         return;
     }
     nlohmann::json state_json;
-    state_json["State"] = PackML::stateToString(current_packml_state_);
+    state_json["State"] = PackML::stateToString(execution.packml_state);
     state_json["TimeStamp"] = bt_utils::getCurrentTimestampISO();
 
-    if (app_params_.state_publication_config.validateMessage(state_json))
+    // Built from the PackML enum, so not validated; rapid transitions collapse to the latest
+    const auto &state_config = execution.state_publication_config;
+    state_publisher_->post(state_config.getTopic(), std::move(state_json),
+                           state_config.getQos(), state_config.getRetain(), true);
+}
+
+void BehaviorTreeController::publishMetricsIfDue()
+{
+    if (app_params_.metrics_publish_interval_ms <= 0 || !mqtt_client_)
     {
-        mqtt_client_->publish_message(
-            app_params_.state_publication_config.getTopic(),
-            state_json,
-            app_params_.state_publication_config.getQos(),
-            app_params_.state_publication_config.getRetain());
+        return;
     }
-    else
+
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::milliseconds(app_params_.metrics_publish_interval_ms);
+    if (now - last_metrics_publish_ < interval)
     {
-        std::cerr << "Error: Controller State JSON failed validation for topic '"
-                  << app_params_.state_publication_config.getTopic()
-                  << "'. Not publishing. Payload: " << state_json.dump(2) << std::endl;
+        return;
     }
+    auto window = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_metrics_publish_);
+    last_metrics_publish_ = now;
+
+    // Each publication covers the window since the previous one
+    nlohmann::json metrics = LatencyMetrics::instance().toJson(true);
+    if (metrics.empty())
+    {
+        return;
+    }
+
+    nlohmann::json message;
+    message["TimeStamp"] = bt_utils::getCurrentTimestampISO();
+    message["WindowMs"] = window.count();
+    message["Latency"] = std::move(metrics);
+    if (SimClock::isVirtual())
+    {
+        // Latencies above are wall time; TimeStamp and deadlines run at this speed
+        message["Clock"] = {{"Mode", SimClock::modeName(SimClock::mode())}, {"Speed", SimClock::speed()}};
+    }
+    if (node_message_distributor_)
+    {
+        auto stats = node_message_distributor_->getDispatchStats();
+        message["Dispatch"] = {
+            {"QueueDepth", stats.queue_depth},
+            {"MaxQueueDepth", stats.max_queue_depth},
+            {"Processed", stats.processed},
+            {"Dropped", stats.dropped},
+            {"Correlated", stats.correlated}};
+
+        auto interned = mqtt_utils::getInternStats();
+        nlohmann::json &memory = message["Memory"];
+        memory["Interned"] = {
+            {"Topics", interned.topics},
+            {"TopicBytes", interned.topic_bytes},
+            {"Schemas", interned.schemas},
+            {"SchemaBytes", interned.schema_bytes},
+            {"SchemaRefs", interned.schema_refs}};
+        memory["Nodes"] = nlohmann::json::object();
+        for (const auto &[node_type, node_stats] : node_message_distributor_->getTopicMemoryStats())
+        {
+            memory["Nodes"][node_type] = {
+                {"Count", node_stats.nodes},
+                {"Topics", node_stats.topics},
+                {"Bytes", node_stats.bytes}};
+        }
+    }
+
+    mqtt_client_->publish_message(app_params_.metrics_topic, message, 0, true);
 }
 
 void BehaviorTreeController::publishCommandResponse(const std::string &response_topic,
@@ -840,7 +1377,7 @@ void BehaviorTreeController::publishCommandResponse(const std::string &response_
 {
     if (!mqtt_client_ || !mqtt_client_->is_connected())
     {
-        std::cerr << "Cannot publish command response: MQTT client not connected" << std::endl;
+        BT_LOG_ERROR << "Cannot publish command response: MQTT client not connected";
         return;
     }
 
@@ -849,17 +1386,18 @@ void BehaviorTreeController::publishCommandResponse(const std::string &response_
     response_json["State"] = success ? "SUCCESS" : "FAILURE";
     response_json["TimeStamp"] = bt_utils::getCurrentTimestampISO();
 
-    mqtt_client_->publish_message(response_topic, response_json, 2, false);
+    // Queued behind the states posted before it, never coalesced
+    state_publisher_->post(response_topic, std::move(response_json), 2, false, false);
 
-    std::cout << "Published command response to " << response_topic
-              << ": " << (success ? "SUCCESS" : "FAILURE") << std::endl;
+    BT_LOG_INFO << "Published command response to " << response_topic
+                << ": " << (success ? "SUCCESS" : "FAILURE");
 }
 
-void BehaviorTreeController::processBehaviorTreeStart()
+void BehaviorTreeController::processBehaviorTreeStart(ProcessExecution &execution)
 {
-    if (current_packml_state_ != PackML::State::IDLE)
+    if (execution.packml_state != PackML::State::IDLE)
     {
-        std::cerr << "Cannot start: Not in IDLE state" << std::endl;
+        BT_LOG_ERROR << "Cannot start: Not in IDLE state";
         return;
     }
 
@@ -867,94 +1405,130 @@ void BehaviorTreeController::processBehaviorTreeStart()
     std::string process_id;
     {
         std::lock_guard<std::mutex> lock(process_aas_id_mutex_);
-        process_id = process_aas_id_;
+        process_id = execution.process_aas_id;
     }
 
     if (process_id.empty())
     {
-        std::cerr << "Cannot start: No process AAS ID specified!" << std::endl;
+        BT_LOG_ERROR << "Cannot start: No process AAS ID specified!";
         return;
     }
 
-    std::cout << "====== Starting behavior tree for process: " << process_id << " ======" << std::endl;
+    BT_LOG_INFO << "====== Starting behavior tree for process: " << process_id << " ======";
 
     // Transition to STARTING state and initialize the BT
-    processStartingState();
+    processStartingState(execution);
+}
+
+void BehaviorTreeController::abortStart(ProcessExecution &execution)
+{
+    finishStartTrace(execution, false);
+    setStateAndPublish(execution, PackML::State::ABORTED);
+
+    // Send failure response for Start command
+    publishCommandResponse(execution.start_response_topic,
+                           takePendingUuid(execution, &ProcessExecution::pending_start_uuid), false);
+}
+
+void BehaviorTreeController::finishStartTrace(const ProcessExecution &execution, bool started)
+{
+    if (!SpanTrace::instance().active())
+    {
+        return;
+    }
+
+    auto session = SpanTrace::instance().end(started ? "EXECUTE" : "ABORTED");
+    auto format = SpanTrace::parseFormat(app_params_.trace_format).value_or(SpanTrace::Format::Chrome);
+    auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(session.wall_start.time_since_epoch()).count();
+    std::string path = app_params_.starting_trace_dir + "/starting_" + std::to_string(execution.slot) + "_" +
+                       std::to_string(wall_ms) + (format == SpanTrace::Format::Otlp ? ".otlp.json" : ".trace.json");
+
+    if (SpanTrace::writeFile(session, format, path))
+    {
+        BT_LOG_INFO << "STARTING trace (" << session.spans.size() << " spans) written to " << path;
+    }
+    else
+    {
+        BT_LOG_ERROR << "Failed to write STARTING trace to " << path;
+    }
 }
 
-void BehaviorTreeController::processStartingState()
+void BehaviorTreeController::processStartingState(ProcessExecution &execution)
 {
-    std::cout << "====== Entering STARTING state... ======" << std::endl;
-    setStateAndPublish(PackML::State::STARTING);
+    BT_LOG_INFO << "====== Entering STARTING state... ======";
+    setStateAndPublish(execution, PackML::State::STARTING);
 
     // Get the process AAS ID
     std::string process_id;
     {
         std::lock_guard<std::mutex> lock(process_aas_id_mutex_);
-        process_id = process_aas_id_;
+        process_id = execution.process_aas_id;
+    }
+
+    if (!app_params_.starting_trace_dir.empty())
+    {
+        SpanTrace::instance().begin("STARTING", {{"process", process_id}, {"slot", std::to_string(execution.slot)}});
     }
 
     // Clear any existing flags
-    shutdown_flag_ = false;
-    mqtt_suspend_bt_flag_ = false;
-    mqtt_unsuspend_bt_flag_ = false;
-    mqtt_reset_bt_flag_ = false;
+    execution.stop_flag = false;
+    execution.suspend_flag = false;
+    execution.unsuspend_flag = false;
+    execution.reset_flag = false;
 
     // Fetch equipment mapping from AAS hierarchical structure
-    std::cout << "Fetching production line structure from AAS..." << std::endl;
-    if (!fetchAndBuildEquipmentMapping(nullptr))
+    BT_LOG_INFO << "Fetching production line structure from AAS...";
+    bool mapped;
     {
-        std::cerr << "Failed to fetch equipment mapping from AAS!" << std::endl;
-        std::cerr << "Cannot continue without equipment configuration." << std::endl;
-        setStateAndPublish(PackML::State::ABORTED);
-
-        // Send failure response for Start command
-        std::string uuid;
-        {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_start_uuid_;
-            pending_start_uuid_.clear();
-        }
-        publishCommandResponse(app_params_.start_response_topic, uuid, false);
+        TraceSpan span("fetchEquipmentMapping", "starting");
+        mapped = fetchAndBuildEquipmentMapping(execution, nullptr);
+    }
+    if (!mapped)
+    {
+        BT_LOG_ERROR << "Failed to fetch equipment mapping from AAS!";
+        BT_LOG_ERROR << "Cannot continue without equipment configuration.";
+        abortStart(execution);
         return;
     }
 
-    std::cout << "Equipment mapping successfully built from AAS" << std::endl;
+    BT_LOG_INFO << "Equipment mapping successfully built from AAS";
 
     // Pre-fetch asset interface descriptions (but don't subscribe yet)
-    // This allows nodes to get topic info from cache during initialization
-    if (!prefetchAssetInterfaces())
-    {
-        std::cerr << "Warning: Failed to prefetch asset interfaces, nodes will query AAS individually" << std::endl;
-        // Continue anyway - this is a performance optimization, not a hard requirement
-    }
+    // This allows nodes to get topic info from cache during initialization. It runs while
+    // nodes are registered and the BT description is fetched and parsed, and is joined
+    // before the tree is created; an early return waits for it in the future's destructor.
+    auto prefetch = std::async(std::launch::async,
+                               [this, &execution]()
+                               { return prefetchAssetInterfaces(execution); });
 
-    // Register nodes with the equipment mapping
-    if (!registerNodesWithAASConfig())
+    // Register nodes with the equipment mapping; trees started later share the registration
+    if (!nodes_registered_)
     {
-        std::cerr << "Failed to register nodes with AAS configuration!" << std::endl;
-        setStateAndPublish(PackML::State::ABORTED);
-        nodes_registered_ = false;
-
-        // Send failure response for Start command
-        std::string uuid;
+        bool registered;
         {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_start_uuid_;
-            pending_start_uuid_.clear();
+            TraceSpan span("registerNodes", "starting");
+            registered = registerNodesWithAASConfig();
+        }
+        if (!registered)
+        {
+            BT_LOG_ERROR << "Failed to register nodes with AAS configuration!";
+            nodes_registered_ = false;
+            abortStart(execution);
+            return;
         }
-        publishCommandResponse(app_params_.start_response_topic, uuid, false);
-        return;
-    }
 
-    std::cout << "Nodes successfully registered with AAS configuration." << std::endl;
-    nodes_registered_ = true;
+        BT_LOG_INFO << "Nodes successfully registered with AAS configuration.";
+        nodes_registered_ = true;
+    }
 
     // ===== Initialize Behavior Tree =====
-    std::cout << "Initializing behavior tree for process: " << process_id << std::endl;
+    BT_LOG_INFO << "Initializing behavior tree for process: " << process_id;
 
-    // Temporarily disable message handler during tree creation
-    if (mqtt_client_)
+    // Temporarily disable message handler during tree creation, unless other trees
+    // are running and still need their messages, or subscriptions kept for a warm start
+    // must keep their last values current
+    bool pause_messages = mqtt_client_ && !hasOtherLiveExecution(execution) && !app_params_.warm_restart;
+    if (pause_messages)
     {
         mqtt_client_->set_message_handler(nullptr);
     }
@@ -962,147 +1536,151 @@ void BehaviorTreeController::processStartingState()
     try
     {
         // Fetch BT description URL from the process AAS Policy submodel
-        auto bt_url_opt = aas_client_->fetchPolicyBTUrl(process_id);
+        std::optional<std::string> bt_url_opt;
+        {
+            TraceSpan span("fetchPolicyBTUrl", "starting");
+            bt_url_opt = aas_client_->fetchPolicyBTUrl(process_id);
+        }
         if (!bt_url_opt.has_value())
         {
-            std::cerr << "Failed to fetch BT description URL from process AAS Policy submodel" << std::endl;
-            if (mqtt_client_)
+            BT_LOG_ERROR << "Failed to fetch BT description URL from process AAS Policy submodel";
+            if (pause_messages)
             {
                 mqtt_client_->set_message_handler(main_mqtt_message_handler_);
             }
-            setStateAndPublish(PackML::State::ABORTED);
-
-            std::string uuid;
-            {
-                std::lock_guard<std::mutex> lock(pending_command_mutex_);
-                uuid = pending_start_uuid_;
-                pending_start_uuid_.clear();
-            }
-            publishCommandResponse(app_params_.start_response_topic, uuid, false);
+            abortStart(execution);
             return;
         }
 
         std::string bt_url = bt_url_opt.value();
-        std::cout << "Fetching BT description from: " << bt_url << std::endl;
-
-        // Fetch the BT XML content from the URL
-        std::string bt_xml_content = schema_utils::fetchContentFromUrl(bt_url);
-        if (bt_xml_content.empty())
+        // Fetched and parsed once per URL; later Starts revalidate and only instantiate
+        std::shared_ptr<BT::XMLParser> tree_template;
         {
-            std::cerr << "Failed to fetch BT description XML from URL: " << bt_url << std::endl;
-            if (mqtt_client_)
+            TraceSpan span("loadTreeTemplate", "starting");
+            span.attr("url", bt_url);
+            tree_template = tree_templates_.load(bt_url, *bt_factory_);
+        }
+        if (!tree_template)
+        {
+            BT_LOG_ERROR << "Failed to fetch BT description XML from URL: " << bt_url;
+            if (pause_messages)
             {
                 mqtt_client_->set_message_handler(main_mqtt_message_handler_);
             }
-            setStateAndPublish(PackML::State::ABORTED);
-
-            std::string uuid;
-            {
-                std::lock_guard<std::mutex> lock(pending_command_mutex_);
-                uuid = pending_start_uuid_;
-                pending_start_uuid_.clear();
-            }
-            publishCommandResponse(app_params_.start_response_topic, uuid, false);
+            abortStart(execution);
             return;
         }
 
-        std::cout << "Successfully fetched BT description (" << bt_xml_content.size() << " bytes)" << std::endl;
+        bool prefetched;
+        {
+            TraceSpan span("joinPrefetch", "starting");
+            prefetched = prefetch.get();
+        }
+        if (!prefetched)
+        {
+            BT_LOG_WARN << "Failed to prefetch asset interfaces, nodes will query AAS individually";
+            // Continue anyway - this is a performance optimization, not a hard requirement
+        }
 
         // Create blackboard and populate with equipment mapping
         auto root_blackboard = BT::Blackboard::create();
-        populateBlackboard(root_blackboard);
+        populateBlackboard(execution, root_blackboard);
 
         // Store the process ID in blackboard for nodes to access
         root_blackboard->set("ProcessAASId", process_id);
-
-        // createTreeFromText parses XML, registers the tree, and creates it in one call
-        // It automatically uses the main_tree_to_execute attribute from the XML
-        bt_tree_ = bt_factory_->createTreeFromText(bt_xml_content, root_blackboard);
+        // Occupy nodes look up their execution's capability resources under this slot
+        root_blackboard->set("ExecutionSlot", execution.slot);
+
+        // Uses the main_tree_to_execute attribute from the XML
+        TraceSpan span("instantiateTree", "starting");
+        setWakeRoot(execution, nullptr);
+        execution.publisher.reset(); // A throttled monitor still samples the previous tree
+        execution.tree = tree_template->instantiateTree(root_blackboard);
+        execution.tree.manifests = bt_factory_->manifests();
+        setWakeRoot(execution, execution.tree.rootNode());
+        if (!execution.tree.subtrees.empty())
+        {
+            execution.tick_latency = &LatencyMetrics::instance().histogram("tick", execution.tree.subtrees.front()->tree_ID);
+        }
     }
     catch (const BT::RuntimeError &e)
     {
-        std::cerr << "BT Runtime Error during tree creation: " << e.what() << std::endl;
-        if (mqtt_client_)
+        BT_LOG_ERROR << "BT Runtime Error during tree creation: " << e.what();
+        if (pause_messages)
         {
             mqtt_client_->set_message_handler(main_mqtt_message_handler_);
         }
-        setStateAndPublish(PackML::State::ABORTED);
-
-        // Send failure response for Start command
-        std::string uuid;
-        {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_start_uuid_;
-            pending_start_uuid_.clear();
-        }
-        publishCommandResponse(app_params_.start_response_topic, uuid, false);
+        abortStart(execution);
         return;
     }
 
     // Restore message handler
-    if (mqtt_client_)
+    if (pause_messages)
     {
         mqtt_client_->set_message_handler(main_mqtt_message_handler_);
     }
 
     // Subscribe to topics for active nodes - this sets up routing AND subscribes,
     // which triggers delivery of retained messages
-    if (!subscribeToTopics())
+    bool subscribed;
     {
-        std::cerr << "Failed to subscribe to topics for active nodes." << std::endl;
-        if (bt_tree_.rootNode())
-        {
-            bt_tree_.haltTree();
-        }
-        bt_publisher_.reset();
-        setStateAndPublish(PackML::State::ABORTED);
-
-        // Send failure response for Start command
-        std::string uuid;
+        TraceSpan span("subscribeToTopics", "starting");
+        subscribed = subscribeToTopics(execution);
+    }
+    if (!subscribed)
+    {
+        BT_LOG_ERROR << "Failed to subscribe to topics for active nodes.";
+        if (execution.tree.rootNode())
         {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_start_uuid_;
-            pending_start_uuid_.clear();
+            execution.tree.haltTree();
         }
-        publishCommandResponse(app_params_.start_response_topic, uuid, false);
+        execution.publisher.reset();
+        abortStart(execution);
         return;
     }
 
-    std::cout << "Topic subscriptions established - retained messages delivered." << std::endl;
+    BT_LOG_INFO << "Topic subscriptions established - retained messages delivered.";
+
+    // Topics only the previous tree listened to were kept for this Start; drop them now
+    if (app_params_.warm_restart)
+    {
+        releaseUnusedSubscriptions();
+    }
 
-    // Create Groot2 publisher
-    bt_publisher_ = std::make_unique<BT::Groot2Publisher>(bt_tree_, app_params_.groot2_port);
+    // Create Groot2 publisher; each publisher takes two consecutive ports
+    {
+        TraceSpan span("groot2Publisher", "starting");
+        execution.publisher = std::make_unique<Groot2Monitor>(
+            execution.tree, app_params_.groot2_port + 2 * static_cast<unsigned>(execution.slot),
+            app_params_.groot2_monitor);
+    }
+    finishStartTrace(execution, true);
 
     // Transition to EXECUTE state after successful initialization
-    std::cout << "====== Behavior tree fully initialized, transitioning to EXECUTE... ======" << std::endl;
-    setStateAndPublish(PackML::State::EXECUTE, BT::NodeStatus::IDLE);
+    BT_LOG_INFO << "====== Behavior tree fully initialized, transitioning to EXECUTE... ======";
+    setStateAndPublish(execution, PackML::State::EXECUTE, BT::NodeStatus::IDLE);
 
     // Send success response for Start command
-    std::string uuid;
-    {
-        std::lock_guard<std::mutex> lock(pending_command_mutex_);
-        uuid = pending_start_uuid_;
-        pending_start_uuid_.clear();
-    }
-    publishCommandResponse(app_params_.start_response_topic, uuid, true);
+    publishCommandResponse(execution.start_response_topic,
+                           takePendingUuid(execution, &ProcessExecution::pending_start_uuid), true);
 }
 
-void BehaviorTreeController::processBehaviorTreeUnsuspend()
+void BehaviorTreeController::processBehaviorTreeUnsuspend(ProcessExecution &execution)
 {
-    if (current_packml_state_ != PackML::State::SUSPENDED)
+    if (execution.packml_state != PackML::State::SUSPENDED)
     {
-        std::cerr << "Cannot unsuspend: Not in SUSPENDED state" << std::endl;
+        BT_LOG_ERROR << "Cannot unsuspend: Not in SUSPENDED state";
         return;
     }
 
-    if (!bt_tree_.rootNode())
+    if (!execution.tree.rootNode())
     {
-        std::cerr << "Cannot unsuspend: No behavior tree exists" << std::endl;
-        setStateAndPublish(PackML::State::IDLE);
+        BT_LOG_ERROR << "Cannot unsuspend: No behavior tree exists";
+        setStateAndPublish(execution, PackML::State::IDLE);
         return;
     }
 
-    std::cout << "====== Resuming suspended behavior tree... ======" << std::endl;
+    BT_LOG_INFO << "====== Resuming suspended behavior tree... ======";
 
     // Restore message handler if needed
     if (mqtt_client_)
@@ -1110,47 +1688,47 @@ void BehaviorTreeController::processBehaviorTreeUnsuspend()
         mqtt_client_->set_message_handler(main_mqtt_message_handler_);
     }
 
-    shutdown_flag_ = false;
-    mqtt_suspend_bt_flag_ = false;
-    mqtt_unsuspend_bt_flag_ = false;
+    execution.stop_flag = false;
+    execution.suspend_flag = false;
+    execution.unsuspend_flag = false;
 
-    setStateAndPublish(PackML::State::EXECUTE, BT::NodeStatus::IDLE);
+    setStateAndPublish(execution, PackML::State::EXECUTE, BT::NodeStatus::IDLE);
 
     // Send success response for Unsuspend command
-    std::string uuid;
-    {
-        std::lock_guard<std::mutex> lock(pending_command_mutex_);
-        uuid = pending_unsuspend_uuid_;
-        pending_unsuspend_uuid_.clear();
-    }
-    publishCommandResponse(app_params_.unsuspend_response_topic, uuid, true);
+    publishCommandResponse(execution.unsuspend_response_topic,
+                           takePendingUuid(execution, &ProcessExecution::pending_unsuspend_uuid), true);
 }
 
-void BehaviorTreeController::processResettingState()
+void BehaviorTreeController::processResettingState(ProcessExecution &execution)
 {
-    std::cout << "====== Entering RESETTING state... ======" << std::endl;
-    setStateAndPublish(PackML::State::RESETTING);
+    BT_LOG_INFO << "====== Entering RESETTING state... ======";
+    setStateAndPublish(execution, PackML::State::RESETTING);
 
     // Clear any existing flags
-    mqtt_start_bt_flag_ = false;
-    mqtt_suspend_bt_flag_ = false;
-    mqtt_unsuspend_bt_flag_ = false;
-    mqtt_reset_bt_flag_ = false;
-    shutdown_flag_ = false;
+    execution.start_flag = false;
+    execution.suspend_flag = false;
+    execution.unsuspend_flag = false;
+    execution.reset_flag = false;
+    execution.stop_flag = false;
 
     // Clear stored process AAS ID
     {
         std::lock_guard<std::mutex> lock(process_aas_id_mutex_);
-        process_aas_id_.clear();
+        execution.process_aas_id.clear();
     }
 
+    // Other trees keep the shared factory, distributor and subscriptions; with warm_restart
+    // they are kept for the next Start as well, which diffs against what this tree used
+    bool warm = app_params_.warm_restart;
+    bool purge_shared = !warm && !hasOtherLiveExecution(execution);
+
     // Unsubscribe from old node topics if any
-    if (node_message_distributor_ && mqtt_client_)
+    if (purge_shared && node_message_distributor_ && mqtt_client_)
     {
         std::vector<std::string> old_topics = node_message_distributor_->getActiveTopicPatterns();
         if (!old_topics.empty())
         {
-            std::cout << "Unsubscribing from " << old_topics.size() << " old topics..." << std::endl;
+            BT_LOG_INFO << "Unsubscribing from " << old_topics.size() << " old topics...";
             for (const auto &topic_str : old_topics)
             {
                 try
@@ -1159,121 +1737,140 @@ void BehaviorTreeController::processResettingState()
                 }
                 catch (const std::exception &e)
                 {
-                    std::cerr << "Exception during unsubscribe: " << e.what() << std::endl;
+                    BT_LOG_ERROR << "Exception during unsubscribe: " << e.what();
                 }
             }
         }
     }
 
     // Halt and clear any existing tree and factory
-    if (bt_tree_.rootNode())
+    if (execution.tree.rootNode())
     {
-        std::cout << "Halting existing behavior tree..." << std::endl;
-        bt_tree_.haltTree();
-        bt_publisher_.reset();
+        BT_LOG_INFO << "Halting existing behavior tree...";
+        execution.tree.haltTree();
+        execution.publisher.reset();
     }
 
-    // Reset the tree and factory to clear all old registrations
-    bt_tree_ = BT::Tree();
-    bt_factory_ = std::make_unique<BT::BehaviorTreeFactory>();
+    // Destroying the tree unregisters its nodes from the distributor
+    setWakeRoot(execution, nullptr);
+    execution.tree = BT::Tree();
+
+    if (purge_shared)
+    {
+        // Reset the factory to clear all old registrations
+        bt_factory_ = std::make_unique<BT::BehaviorTreeFactory>();
+
+        if (node_message_distributor_)
+        {
+            auto stats = node_message_distributor_->getDispatchStats();
+            BT_LOG_INFO << "Dispatch stats: " << stats.processed << "/" << stats.enqueued << " processed, "
+                        << stats.dropped << " dropped, max queue depth " << stats.max_queue_depth;
+        }
+
+        // Recreate node message distributor for fresh start
+        node_message_distributor_ = createNodeMessageDistributor();
+        MqttSubBase::setNodeMessageDistributor(node_message_distributor_.get());
 
-    // Recreate node message distributor for fresh start
-    node_message_distributor_ = std::make_unique<NodeMessageDistributor>(*mqtt_client_);
-    MqttSubBase::setNodeMessageDistributor(node_message_distributor_.get());
+        // Mark nodes as not registered; parsed trees referred to the old factory
+        nodes_registered_ = false;
+        dropWarmState();
+    }
+    else if (!warm)
+    {
+        releaseUnusedSubscriptions();
+    }
 
-    // Clear equipment mapping
+    // Clear equipment mapping, remembering it for the next Start to diff against
     {
         std::lock_guard<std::mutex> lock(equipment_mapping_mutex_);
-        equipment_aas_mapping_.clear();
+        if (warm)
+        {
+            execution.previous_equipment_mapping = std::move(execution.equipment_aas_mapping);
+        }
+        execution.equipment_aas_mapping.clear();
     }
 
-    // Mark nodes as not registered
-    nodes_registered_ = false;
-
-    std::cout << "====== Reset complete, all BT interfaces purged. Transitioning to IDLE... ======" << std::endl;
-    setStateAndPublish(PackML::State::IDLE);
-
-    // Send success response for Reset command
-    std::string uuid;
+    if (warm)
+    {
+        BT_LOG_INFO << "====== Reset complete, registrations and subscriptions kept for a warm start. Transitioning to IDLE... ======";
+    }
+    else
     {
-        std::lock_guard<std::mutex> lock(pending_command_mutex_);
-        uuid = pending_reset_uuid_;
-        pending_reset_uuid_.clear();
+        BT_LOG_INFO << "====== Reset complete, all BT interfaces purged. Transitioning to IDLE... ======";
     }
-    publishCommandResponse(app_params_.reset_response_topic, uuid, true);
+    setStateAndPublish(execution, PackML::State::IDLE);
+
+    // Send success response for Reset command
+    publishCommandResponse(execution.reset_response_topic,
+                           takePendingUuid(execution, &ProcessExecution::pending_reset_uuid), true);
 }
 
-void BehaviorTreeController::manageRunningBehaviorTree()
+bool BehaviorTreeController::manageRunningBehaviorTree(ProcessExecution &execution)
 {
-    if (!bt_tree_.rootNode())
+    if (!execution.tree.rootNode())
     {
-        std::cerr << "Error: BT is in EXECUTE state but tree.rootNode() is null. "
-                  << "Transitioning to IDLE." << std::endl;
-        setStateAndPublish(PackML::State::IDLE);
-        return;
+        BT_LOG_ERROR << "Error: BT is in EXECUTE state but tree.rootNode() is null. "
+                     << "Transitioning to IDLE.";
+        setStateAndPublish(execution, PackML::State::IDLE);
+        return false;
     }
 
-    if (shutdown_flag_.load())
+    if (execution.stop_flag.load())
     {
-        std::cout << "Stop/Shutdown command active during EXECUTE. "
-                  << "Halting tree and transitioning to STOPPED..." << std::endl;
-        bt_tree_.haltTree();
-        setStateAndPublish(PackML::State::STOPPED);
+        BT_LOG_INFO << "Stop/Shutdown command active during EXECUTE. "
+                    << "Halting tree and transitioning to STOPPED...";
+        execution.tree.haltTree();
+        execution.stop_flag = false;
+        setStateAndPublish(execution, PackML::State::STOPPED);
 
         // Send success response for Stop command
-        std::string uuid;
-        {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_stop_uuid_;
-            pending_stop_uuid_.clear();
-        }
-        publishCommandResponse(app_params_.stop_response_topic, uuid, true);
+        publishCommandResponse(execution.stop_response_topic,
+                               takePendingUuid(execution, &ProcessExecution::pending_stop_uuid), true);
     }
-    else if (mqtt_suspend_bt_flag_.load())
+    else if (execution.suspend_flag.load())
     {
-        std::cout << "SUSPEND command active during EXECUTE. "
-                  << "Halting tree and transitioning to SUSPENDED..." << std::endl;
-        bt_tree_.haltTree();
-        mqtt_suspend_bt_flag_ = false;
-        setStateAndPublish(PackML::State::SUSPENDED);
+        BT_LOG_INFO << "SUSPEND command active during EXECUTE. "
+                    << "Halting tree and transitioning to SUSPENDED...";
+        execution.tree.haltTree();
+        execution.suspend_flag = false;
+        setStateAndPublish(execution, PackML::State::SUSPENDED);
 
         // Send success response for Suspend command
-        std::string uuid;
-        {
-            std::lock_guard<std::mutex> lock(pending_command_mutex_);
-            uuid = pending_suspend_uuid_;
-            pending_suspend_uuid_.clear();
-        }
-        publishCommandResponse(app_params_.suspend_response_topic, uuid, true);
+        publishCommandResponse(execution.suspend_response_topic,
+                               takePendingUuid(execution, &ProcessExecution::pending_suspend_uuid), true);
     }
-    else if (mqtt_unsuspend_bt_flag_.load())
+    else if (execution.unsuspend_flag.load())
     {
-        std::cout << "HALT command active during EXECUTE. "
-                  << "Halting tree and transitioning to SUSPENDED..." << std::endl;
-        bt_tree_.haltTree();
-        mqtt_unsuspend_bt_flag_ = false;
-        setStateAndPublish(PackML::State::EXECUTE);
+        BT_LOG_INFO << "HALT command active during EXECUTE. "
+                    << "Halting tree and transitioning to SUSPENDED...";
+        execution.tree.haltTree();
+        execution.unsuspend_flag = false;
+        setStateAndPublish(execution, PackML::State::EXECUTE);
     }
     else
     {
-        BT::NodeStatus tick_result = bt_tree_.tickOnce();
-        bt_tree_.sleep(std::chrono::milliseconds(100));
+        // Tick; the caller sleeps until a node callback or command emits a wake-up signal
+        auto tick_start = std::chrono::steady_clock::now();
+        BT::NodeStatus tick_result = execution.tree.tickOnce();
+        execution.tick_latency->record(std::chrono::steady_clock::now() - tick_start);
 
         if (BT::isStatusCompleted(tick_result))
         {
-            std::cout << "Behavior tree execution completed with status: "
-                      << BT::toStr(tick_result) << std::endl;
-            setStateAndPublish(PackML::State::COMPLETE, tick_result);
+            BT_LOG_INFO << "Behavior tree execution completed with status: "
+                        << BT::toStr(tick_result);
+            setStateAndPublish(execution, PackML::State::COMPLETE, tick_result);
         }
         else
         {
-            if (current_bt_tick_status_ != tick_result ||
-                current_packml_state_ != PackML::State::EXECUTE)
+            if (execution.bt_tick_status != tick_result ||
+                execution.packml_state != PackML::State::EXECUTE)
             {
-                setStateAndPublish(PackML::State::EXECUTE, tick_result);
+                setStateAndPublish(execution, PackML::State::EXECUTE, tick_result);
             }
         }
+        return true;
     }
+    return false;
 }
 
 bool BehaviorTreeController::publishConfigToRegistrationService()
@@ -1281,24 +1878,24 @@ bool BehaviorTreeController::publishConfigToRegistrationService()
     // Check if registration is configured
     if (app_params_.registration_config_path.empty() || app_params_.registration_topic.empty())
     {
-        std::cout << "Registration not configured, skipping config publication" << std::endl;
+        BT_LOG_INFO << "Registration not configured, skipping config publication";
         return true; // Not an error, just not configured
     }
 
     if (!mqtt_client_ || !mqtt_client_->is_connected())
     {
-        std::cerr << "Cannot publish registration config: MQTT client not connected" << std::endl;
+        BT_LOG_ERROR << "Cannot publish registration config: MQTT client not connected";
         return false;
     }
 
-    std::cout << "Loading AAS description config from: " << app_params_.registration_config_path << std::endl;
+    BT_LOG_INFO << "Loading AAS description config from: " << app_params_.registration_config_path;
 
     // Load the YAML config file and send it as-is (raw YAML)
     // The registration service can parse raw YAML directly
     std::ifstream config_file(app_params_.registration_config_path);
     if (!config_file.is_open())
     {
-        std::cerr << "Failed to open AAS description config: " << app_params_.registration_config_path << std::endl;
+        BT_LOG_ERROR << "Failed to open AAS description config: " << app_params_.registration_config_path;
         return false;
     }
 
@@ -1309,11 +1906,11 @@ bool BehaviorTreeController::publishConfigToRegistrationService()
 
     if (yaml_content.empty())
     {
-        std::cerr << "AAS description config file is empty: " << app_params_.registration_config_path << std::endl;
+        BT_LOG_ERROR << "AAS description config file is empty: " << app_params_.registration_config_path;
         return false;
     }
 
-    std::cout << "Publishing registration config to: " << app_params_.registration_topic << std::endl;
+    BT_LOG_INFO << "Publishing registration config to: " << app_params_.registration_topic;
 
     // Publish raw YAML content with QoS 2 (exactly once) and retain=false
     // The registration service will parse the YAML directly
@@ -1326,16 +1923,86 @@ bool BehaviorTreeController::publishConfigToRegistrationService()
             false // Don't retain
         );
         mqtt_client_->publish(msg)->wait();
-        std::cout << "Successfully published registration config to registration service" << std::endl;
+        BT_LOG_INFO << "Successfully published registration config to registration service";
         return true;
     }
     catch (const mqtt::exception &e)
     {
-        std::cerr << "Failed to publish registration config: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Failed to publish registration config: " << e.what();
         return false;
     }
 }
 
+void BehaviorTreeController::queueAssetChange(const nlohmann::json &payload)
+{
+    // Only successful registrations that name their asset; older services omit assetId
+    if (!payload.contains("success") || !payload["success"].is_boolean() || !payload["success"].get<bool>() ||
+        !payload.contains("assetId") || !payload["assetId"].is_string())
+    {
+        return;
+    }
+
+    std::string asset_ref = payload["assetId"].get<std::string>();
+    BT_LOG_INFO << "AAS change event: " << asset_ref << " was registered";
+    {
+        std::lock_guard<std::mutex> lock(asset_change_mutex_);
+        pending_asset_changes_.insert(asset_ref);
+    }
+    wakeController();
+}
+
+void BehaviorTreeController::applyAssetChanges()
+{
+    if (asset_refresh_.valid())
+    {
+        if (asset_refresh_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return;
+        }
+
+        // On the main loop between ticks, so no tree reads the topics being replaced
+        std::vector<mqtt_utils::Topic> stale_topics = asset_refresh_.get();
+        if (!stale_topics.empty() && node_message_distributor_)
+        {
+            size_t refreshed = node_message_distributor_->refreshInstancesUsing(stale_topics);
+            BT_LOG_INFO << "AAS change: " << stale_topics.size() << " topic(s) changed, "
+                        << refreshed << " running node(s) re-resolved";
+            releaseUnusedSubscriptions();
+        }
+    }
+
+    std::set<std::string> asset_refs;
+    {
+        std::lock_guard<std::mutex> lock(asset_change_mutex_);
+        asset_refs.swap(pending_asset_changes_);
+    }
+    if (asset_refs.empty() || !aas_interface_cache_)
+    {
+        return;
+    }
+
+    // The AAS is queried off the main loop so running trees keep ticking meanwhile
+    asset_refresh_ = std::async(std::launch::async,
+                                [this, asset_refs = std::move(asset_refs)]()
+                                {
+                                    std::vector<mqtt_utils::Topic> stale_topics;
+                                    for (const auto &asset_ref : asset_refs)
+                                    {
+                                        for (auto &change : aas_interface_cache_->refreshAsset(asset_ref))
+                                        {
+                                            stale_topics.insert(stale_topics.end(),
+                                                                change.stale_topics.begin(), change.stale_topics.end());
+                                        }
+                                    }
+                                    if (!app_params_.aas_snapshot_path.empty())
+                                    {
+                                        aas_interface_cache_->saveSnapshot(app_params_.aas_snapshot_path);
+                                    }
+                                    wakeController();
+                                    return stale_topics;
+                                });
+}
+
 void signalHandler(int signum)
 {
     if (g_controller_instance)
@@ -1346,7 +2013,7 @@ void signalHandler(int signum)
 
 int main(int argc, char *argv[])
 {
-    std::cout << "Starting Behavior Tree Controller..." << std::endl;
+    BT_LOG_INFO << "Starting Behavior Tree Controller...";
     BehaviorTreeController controller(argc, argv);
     return controller.run();
 }
\ No newline at end of file
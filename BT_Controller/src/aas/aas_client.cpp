@@ -1,10 +1,12 @@
 #include "aas/aas_client.h"
 #include <stdexcept>
-#include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <functional>
 #include <openssl/evp.h>
 #include "utils.h"
+#include "http/http_transport.h"
+#include "logging/logger.h"
 
 namespace {
     // Case-insensitive string comparison helper
@@ -14,16 +16,6 @@ namespace {
                        [](unsigned char c) { return std::tolower(c); });
         return result;
     }
-    
-    bool equalsIgnoreCase(const std::string& a, const std::string& b) {
-        return toLower(a) == toLower(b);
-    }
-}
-
-static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
-{
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
 }
 
 // Base64url encoding helper using OpenSSL (RFC 4648)
@@ -52,64 +44,41 @@ std::string AASClient::base64url_encode(const std::string &input)
 
 AASClient::AASClient(const std::string &aas_server_url, const std::string &registry_url)
     : aas_server_url_(aas_server_url),
-      registry_url_(registry_url.empty() ? aas_server_url : registry_url),
-      curl_(nullptr)
+      registry_url_(registry_url.empty() ? aas_server_url : registry_url)
 {
     curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl_ = curl_easy_init();
 }
 
 AASClient::~AASClient()
 {
-    if (curl_)
-    {
-        curl_easy_cleanup(curl_);
-    }
     curl_global_cleanup();
 }
 
-nlohmann::json AASClient::makeGetRequest(const std::string &endpoint, bool use_registry)
+nlohmann::json AASClient::makeGetRequest(const std::string &endpoint, bool use_registry,
+                                         const SubmodelFilter *filter)
 {
-    if (!curl_)
-    {
-        throw std::runtime_error("CURL not initialized");
-    }
-
-    std::string readBuffer;
     std::string base_url = use_registry ? registry_url_ : aas_server_url_;
     std::string full_url = base_url + endpoint;
 
-    curl_easy_setopt(curl_, CURLOPT_URL, full_url.c_str());
-    curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &readBuffer);
-    curl_easy_setopt(curl_, CURLOPT_TIMEOUT, 10L);
-
-    struct curl_slist *headers = nullptr;
-    headers = curl_slist_append(headers, "Accept: application/json");
-    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
-
-    CURLcode res = curl_easy_perform(curl_);
-    long response_code;
-    curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
+    // Shared transport: pooled handles with warm connections, safe from any thread
+    HttpResponse response = HttpTransport::instance().getJson(full_url, 10);
 
-    curl_slist_free_all(headers);
-
-    if (res != CURLE_OK)
+    if (response.curl_code != CURLE_OK)
     {
-        throw std::runtime_error(std::string("CURL error: ") + curl_easy_strerror(res));
+        throw std::runtime_error(std::string("CURL error: ") + response.error());
     }
 
-    if (response_code != 200)
+    if (response.status != 200)
     {
-        std::string error_msg = "HTTP error code: " + std::to_string(response_code) + " for URL: " + full_url;
-        if (!readBuffer.empty())
+        std::string error_msg = "HTTP error code: " + std::to_string(response.status) + " for URL: " + full_url;
+        if (!response.body.empty())
         {
-            error_msg += ", Response: " + readBuffer;
+            error_msg += ", Response: " + response.body;
         }
         throw std::runtime_error(error_msg);
     }
 
-    return nlohmann::json::parse(readBuffer);
+    return filter ? filter->parse(response.body) : nlohmann::json::parse(response.body);
 }
 
 std::string AASClient::substituteParams(const std::string &pattern, const nlohmann::json &params)
@@ -145,237 +114,263 @@ void AASClient::resolveSchemaReferences(nlohmann::json &schema)
     schema_utils::resolveSchemaReferences(schema);
 }
 
-std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &asset_id, const std::string &interaction, const std::string &endpoint)
+void AASClient::clearMemo()
 {
-    try
-    {
-        std::cout << "Fetching interface from AAS - Asset: " << asset_id
-                  << ", Interaction: " << interaction
-                  << ", Endpoint: " << endpoint << std::endl;
-
-        // Validate endpoint parameter
-        if (endpoint != "input" && endpoint != "output")
-        {
-            std::cerr << "Invalid endpoint type: " << endpoint << ". Must be 'input' or 'output'" << std::endl;
-            return std::nullopt;
-        }
+    std::lock_guard<std::mutex> lock(memo_mutex_);
+    document_memo_.clear();
+    interaction_index_memo_.clear();
+    property_index_memo_.clear();
+}
 
-        std::string shell_id_b64 = base64url_encode(asset_id);
-        std::string shell_path = "/shells/" + shell_id_b64;
+void AASClient::forgetAsset(const std::string &asset_id)
+{
+    std::string shell_path = "/shells/" + base64url_encode(asset_id);
 
-        // Step 2: Get the shell to find submodel references
-        nlohmann::json shell_data = makeGetRequest(shell_path);
+    std::lock_guard<std::mutex> lock(memo_mutex_);
+    interaction_index_memo_.erase(asset_id);
 
-        if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
-        {
-            std::cerr << "Shell missing submodels array" << std::endl;
-            return std::nullopt;
-        }
+    auto shell_it = document_memo_.find(shell_path);
+    if (shell_it == document_memo_.end())
+    {
+        return;
+    }
 
-        // Find AssetInterfacesDescription submodel reference
-        std::string submodel_id;
+    const nlohmann::json &shell_data = *shell_it->second;
+    if (shell_data.contains("submodels") && shell_data["submodels"].is_array())
+    {
         for (const auto &submodel_ref : shell_data["submodels"])
         {
-            if (submodel_ref.contains("keys") && submodel_ref["keys"].is_array())
+            if (!submodel_ref.contains("keys") || !submodel_ref["keys"].is_array() || submodel_ref["keys"].empty() ||
+                !submodel_ref["keys"][0].contains("value") || !submodel_ref["keys"][0]["value"].is_string())
             {
-                std::string ref_value = submodel_ref["keys"][0]["value"];
-                if (ref_value.find("AssetInterfacesDescription") != std::string::npos ||
-                    ref_value.find("AssetInterfaceDescription") != std::string::npos)
-                {
-                    submodel_id = ref_value;
-                    break;
-                }
+                continue;
             }
+            std::string submodel_path = "/submodels/" + base64url_encode(submodel_ref["keys"][0]["value"].get<std::string>());
+            std::erase_if(document_memo_, [&submodel_path](const auto &entry)
+                          { return entry.first.compare(0, submodel_path.size(), submodel_path) == 0 &&
+                                   (entry.first.size() == submodel_path.size() || entry.first[submodel_path.size()] == '#'); });
+            property_index_memo_.erase(submodel_path);
         }
+    }
+    document_memo_.erase(shell_it);
+}
 
-        if (submodel_id.empty())
+std::shared_ptr<const nlohmann::json> AASClient::getMemoized(const std::string &path, const SubmodelFilter *filter)
+{
+    std::string key = filter ? path + "#" + filter->key() : path;
+    {
+        std::lock_guard<std::mutex> lock(memo_mutex_);
+        auto it = document_memo_.find(path);
+        if (it == document_memo_.end() && filter)
         {
-            std::cerr << "Could not find AssetInterfacesDescription submodel" << std::endl;
-            return std::nullopt;
+            it = document_memo_.find(key);
+        }
+        if (it != document_memo_.end())
+        {
+            return it->second;
         }
+    }
 
-        std::cout << "Found submodel ID: " << submodel_id << std::endl;
+    // Fetch outside the lock so parallel prefetches of different assets don't serialize;
+    // two racing callers for the same path both fetch and the first result wins
+    auto document = std::make_shared<const nlohmann::json>(makeGetRequest(path, false, filter));
 
-        // Step 3: Fetch the submodel using base64url-encoded ID
-        // AAS specification requires base64url encoding for IDs in URLs
-        std::string submodel_id_b64 = base64url_encode(submodel_id);
+    std::lock_guard<std::mutex> lock(memo_mutex_);
+    return document_memo_.emplace(std::move(key), std::move(document)).first->second;
+}
 
-        std::string submodel_url = "/submodels/" + submodel_id_b64;
-        std::cout << "Fetching submodel from URL: " << submodel_url << std::endl;
+const SubmodelFilter &AASClient::interfaceFilter()
+{
+    static const SubmodelFilter filter({"InterfaceMQTT"});
+    return filter;
+}
 
-        nlohmann::json submodel_data = makeGetRequest(submodel_url);
+std::string AASClient::findInterfaceSubmodelPath(const std::string &asset_id)
+{
+    auto shell_data = getMemoized("/shells/" + base64url_encode(asset_id));
 
-        // Step 4: Navigate through the submodel structure
-        if (!submodel_data.contains("submodelElements") || !submodel_data["submodelElements"].is_array())
-        {
-            std::cerr << "Submodel missing submodelElements array" << std::endl;
-            return std::nullopt;
-        }
+    if (!shell_data->contains("submodels") || !(*shell_data)["submodels"].is_array())
+    {
+        BT_LOG_ERROR << "Shell missing submodels array";
+        return "";
+    }
 
-        // Find InterfaceMQTT
-        nlohmann::json interface_mqtt;
-        for (const auto &elem : submodel_data["submodelElements"])
+    // Find AssetInterfacesDescription submodel reference
+    for (const auto &submodel_ref : (*shell_data)["submodels"])
+    {
+        if (submodel_ref.contains("keys") && submodel_ref["keys"].is_array())
         {
-            if (elem.contains("idShort") && elem["idShort"] == "InterfaceMQTT")
+            std::string ref_value = submodel_ref["keys"][0]["value"];
+            if (ref_value.find("AssetInterfacesDescription") != std::string::npos ||
+                ref_value.find("AssetInterfaceDescription") != std::string::npos)
             {
-                interface_mqtt = elem;
-                break;
+                // AAS specification requires base64url encoding for IDs in URLs
+                return "/submodels/" + base64url_encode(ref_value);
             }
         }
+    }
+
+    BT_LOG_ERROR << "Could not find AssetInterfacesDescription submodel";
+    return "";
+}
+
+std::shared_ptr<const AASClient::InteractionIndex> AASClient::getInteractionIndex(const std::string &asset_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(memo_mutex_);
+        auto it = interaction_index_memo_.find(asset_id);
+        if (it != interaction_index_memo_.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::string submodel_url = findInterfaceSubmodelPath(asset_id);
+    if (submodel_url.empty())
+    {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<InteractionIndex>();
+    index->submodel = getMemoized(submodel_url, &interfaceFilter());
+    const nlohmann::json &submodel_data = *index->submodel;
 
-        if (interface_mqtt.empty())
+    if (!submodel_data.contains("submodelElements") || !submodel_data["submodelElements"].is_array())
+    {
+        BT_LOG_ERROR << "Submodel missing submodelElements array";
+        return nullptr;
+    }
+
+    // Find InterfaceMQTT
+    const nlohmann::json *interface_mqtt = nullptr;
+    for (const auto &elem : submodel_data["submodelElements"])
+    {
+        if (elem.contains("idShort") && elem["idShort"] == "InterfaceMQTT")
         {
-            std::cerr << "Could not find InterfaceMQTT element" << std::endl;
-            return std::nullopt;
+            interface_mqtt = &elem;
+            break;
         }
+    }
 
+    if (!interface_mqtt || !interface_mqtt->contains("value"))
+    {
+        BT_LOG_ERROR << "Could not find InterfaceMQTT element";
+        return nullptr;
+    }
+
+    for (const auto &elem : (*interface_mqtt)["value"])
+    {
         // Get base topic from EndpointMetadata
-        std::string base_topic;
-        for (const auto &elem : interface_mqtt["value"])
+        if (elem["idShort"] == "EndpointMetadata")
         {
-            if (elem["idShort"] == "EndpointMetadata")
+            for (const auto &metadata_elem : elem["value"])
             {
-                for (const auto &metadata_elem : elem["value"])
+                if (metadata_elem["idShort"] == "base")
                 {
-                    if (metadata_elem["idShort"] == "base")
+                    std::string base_topic = metadata_elem["value"];
+                    // Remove mqtt:// or mqtts:// prefix and host:port, keep only topic path
+                    size_t scheme_len = base_topic.find("mqtts://") == 0  ? 8
+                                        : base_topic.find("mqtt://") == 0 ? 7
+                                                                          : 0;
+                    if (scheme_len > 0)
                     {
-                        base_topic = metadata_elem["value"];
-                        // Remove mqtt:// or mqtts:// prefix if present
-                        if (base_topic.find("mqtts://") == 0)
+                        base_topic = base_topic.substr(scheme_len);
+                        size_t slash_pos = base_topic.find('/');
+                        if (slash_pos != std::string::npos)
                         {
-                            base_topic = base_topic.substr(8); // Remove "mqtts://"
-                            // Remove host:port, keep only topic path
-                            size_t slash_pos = base_topic.find('/');
-                            if (slash_pos != std::string::npos)
-                            {
-                                base_topic = base_topic.substr(slash_pos);
-                            }
-                        }
-                        else if (base_topic.find("mqtt://") == 0)
-                        {
-                            base_topic = base_topic.substr(7); // Remove "mqtt://"
-                            // Remove host:port, keep only topic path
-                            size_t slash_pos = base_topic.find('/');
-                            if (slash_pos != std::string::npos)
-                            {
-                                base_topic = base_topic.substr(slash_pos);
-                            }
+                            base_topic = base_topic.substr(slash_pos);
                         }
-                        // Remove slash between port and base topic if present
-                        if (!base_topic.empty() && base_topic[0] == '/')
-                        {
-                            base_topic = base_topic.substr(1);
-                        }
-                        break;
                     }
+                    // Remove slash between port and base topic if present
+                    if (!base_topic.empty() && base_topic[0] == '/')
+                    {
+                        base_topic = base_topic.substr(1);
+                    }
+                    index->base_topic = base_topic;
+                    break;
                 }
-                break;
             }
         }
-
-        // Step 5: Find InteractionMetadata and locate the interaction (action or property)
-        nlohmann::json interaction_data;
-        bool is_action = false;
-
-        for (const auto &elem : interface_mqtt["value"])
+        // Index actions and properties; the first occurrence of a name wins as before
+        else if (elem["idShort"] == "InteractionMetadata")
         {
-            if (elem["idShort"] == "InteractionMetadata")
+            for (const auto &interaction_type_elem : elem["value"])
             {
-                // Search in actions first
-                for (const auto &interaction_type_elem : elem["value"])
+                bool is_action = interaction_type_elem["idShort"] == "actions";
+                if (!is_action && interaction_type_elem["idShort"] != "properties")
                 {
-                    if (interaction_type_elem["idShort"] == "actions")
-                    {
-                        for (const auto &action : interaction_type_elem["value"])
-                        {
-                            if (equalsIgnoreCase(action["idShort"].get<std::string>(), interaction))
-                            {
-                                interaction_data = action;
-                                is_action = true;
-                                break;
-                            }
-                        }
-                    }
-                    else if (interaction_type_elem["idShort"] == "properties")
-                    {
-                        for (const auto &property : interaction_type_elem["value"])
-                        {
-                            if (equalsIgnoreCase(property["idShort"].get<std::string>(), interaction))
-                            {
-                                interaction_data = property;
-                                is_action = false;
-                                break;
-                            }
-                        }
-                    }
-
-                    if (!interaction_data.empty())
-                        break;
+                    continue;
+                }
+                for (const auto &interaction : interaction_type_elem["value"])
+                {
+                    index->interactions.emplace(toLower(interaction["idShort"].get<std::string>()),
+                                                InteractionIndex::Entry{&interaction, is_action});
                 }
-                break;
             }
         }
+    }
 
-        if (interaction_data.empty())
+    std::lock_guard<std::mutex> lock(memo_mutex_);
+    return interaction_index_memo_.emplace(asset_id, std::move(index)).first->second;
+}
+
+std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &asset_id, const std::string &interaction, const std::string &endpoint)
+{
+    try
+    {
+        BT_LOG_INFO << "Fetching interface from AAS - Asset: " << asset_id
+                    << ", Interaction: " << interaction
+                    << ", Endpoint: " << endpoint;
+
+        // Validate endpoint parameter
+        if (endpoint != "input" && endpoint != "output")
+        {
+            BT_LOG_ERROR << "Invalid endpoint type: " << endpoint << ". Must be 'input' or 'output'";
+            return std::nullopt;
+        }
+
+        // Steps 2-4: Shell, AssetInterfacesDescription submodel and InterfaceMQTT,
+        // fetched and indexed once per run no matter how many nodes ask
+        auto index = getInteractionIndex(asset_id);
+        if (!index)
+        {
+            return std::nullopt;
+        }
+        const std::string &base_topic = index->base_topic;
+
+        // Step 5: Locate the interaction (action or property)
+        auto entry_it = index->interactions.find(toLower(interaction));
+
+        if (entry_it == index->interactions.end())
         {
             // Interaction not found directly - try to resolve via Variables submodel InterfaceReference
-            std::cout << "Interaction '" << interaction << "' not found directly, checking Variables submodel..." << std::endl;
+            BT_LOG_INFO << "Interaction '" << interaction << "' not found directly, checking Variables submodel...";
 
             auto resolved_interface = resolveInterfaceReference(asset_id, interaction);
             if (resolved_interface && *resolved_interface != interaction)
             {
                 // Found an InterfaceReference - search again with the resolved name
-                std::cout << "Retrying with resolved interface name: " << *resolved_interface << std::endl;
-
-                for (const auto &elem : interface_mqtt["value"])
-                {
-                    if (elem["idShort"] == "InteractionMetadata")
-                    {
-                        // Search in actions first
-                        for (const auto &interaction_type_elem : elem["value"])
-                        {
-                            if (interaction_type_elem["idShort"] == "actions")
-                            {
-                                for (const auto &action : interaction_type_elem["value"])
-                                {
-                                    if (equalsIgnoreCase(action["idShort"].get<std::string>(), *resolved_interface))
-                                    {
-                                        interaction_data = action;
-                                        is_action = true;
-                                        break;
-                                    }
-                                }
-                            }
-                            else if (interaction_type_elem["idShort"] == "properties")
-                            {
-                                for (const auto &property : interaction_type_elem["value"])
-                                {
-                                    if (equalsIgnoreCase(property["idShort"].get<std::string>(), *resolved_interface))
-                                    {
-                                        interaction_data = property;
-                                        is_action = false;
-                                        break;
-                                    }
-                                }
-                            }
-
-                            if (!interaction_data.empty())
-                                break;
-                        }
-                        break;
-                    }
-                }
+                BT_LOG_INFO << "Retrying with resolved interface name: " << *resolved_interface;
+                entry_it = index->interactions.find(toLower(*resolved_interface));
             }
         }
 
+        nlohmann::json interaction_data;
+        bool is_action = false;
+        if (entry_it != index->interactions.end())
+        {
+            interaction_data = *entry_it->second.element;
+            is_action = entry_it->second.is_action;
+        }
+
         if (interaction_data.empty())
         {
-            std::cerr << "Could not find interaction: " << interaction << std::endl;
+            BT_LOG_ERROR << "Could not find interaction: " << interaction;
             return std::nullopt;
         }
 
-        std::cout << "Found interaction: " << interaction << " (Type: "
-                  << (is_action ? "action" : "property") << ")" << std::endl;
+        BT_LOG_INFO << "Found interaction: " << interaction << " (Type: "
+                    << (is_action ? "action" : "property") << ")";
 
         // Step 6: Extract schema URL and forms data
         nlohmann::json forms_data;
@@ -401,7 +396,7 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
 
         if (forms_data.empty())
         {
-            std::cerr << "Could not find forms in interaction" << std::endl;
+            BT_LOG_ERROR << "Could not find forms in interaction";
             return std::nullopt;
         }
 
@@ -409,6 +404,7 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
         std::string href;
         int qos = 0;
         bool retain = false;
+        std::string content_type;
 
         // First, extract default values from the main forms data
         for (const auto &form_elem : forms_data["value"])
@@ -417,6 +413,10 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
             {
                 href = form_elem["value"].get<std::string>();
             }
+            else if (form_elem["idShort"] == "contentType" && form_elem["value"].is_string())
+            {
+                content_type = form_elem["value"].get<std::string>();
+            }
             else if (form_elem["idShort"] == "mqv_qos")
             {
                 // Handle both int and string representations
@@ -451,7 +451,7 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
             {
                 if (form_elem["idShort"] == "response" && form_elem["modelType"] == "SubmodelElementCollection")
                 {
-                    std::cout << "Found specific response form, overriding default values" << std::endl;
+                    BT_LOG_INFO << "Found specific response form, overriding default values";
 
                     // Override with response-specific values
                     for (const auto &resp_elem : form_elem["value"])
@@ -460,6 +460,10 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
                         {
                             href = resp_elem["value"].get<std::string>();
                         }
+                        else if (resp_elem["idShort"] == "contentType" && resp_elem["value"].is_string())
+                        {
+                            content_type = resp_elem["value"].get<std::string>();
+                        }
                         else if (resp_elem["idShort"] == "mqv_qos")
                         {
                             if (resp_elem["value"].is_number())
@@ -491,7 +495,7 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
 
         if (href.empty())
         {
-            std::cerr << "Could not extract href from forms for endpoint: " << endpoint << std::endl;
+            BT_LOG_ERROR << "Could not extract href from forms for endpoint: " << endpoint;
             return std::nullopt;
         }
 
@@ -509,21 +513,24 @@ std::optional<mqtt_utils::Topic> AASClient::fetchInterface(const std::string &as
             {
                 // Resolve any $ref references in the schema
                 resolveSchemaReferences(schema);
-                std::cout << "Successfully fetched and resolved schema" << std::endl;
+                BT_LOG_INFO << "Successfully fetched and resolved schema";
             }
         }
 
-        std::cout << "Successfully fetched interface - Topic: " << full_topic
-                  << ", QoS: " << qos << ", Retain: " << retain << std::endl;
+        BT_LOG_INFO << "Successfully fetched interface - Topic: " << full_topic
+                    << ", QoS: " << qos << ", Retain: " << retain
+                    << (content_type.empty() ? "" : ", Content-Type: ") << content_type;
 
-        return mqtt_utils::Topic(full_topic, schema, qos, retain);
+        mqtt_utils::Topic topic(full_topic, schema, qos, retain);
+        topic.setEncoding(mqtt_utils::parsePayloadEncoding(content_type).value_or(mqtt_utils::PayloadEncoding::Json));
+        return topic;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Failed to fetch interface from AAS for asset: " << asset_id
-                  << ", interaction: " << interaction
-                  << ", endpoint: " << endpoint
-                  << " - Error: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Failed to fetch interface from AAS for asset: " << asset_id
+                     << ", interaction: " << interaction
+                     << ", endpoint: " << endpoint
+                     << " - Error: " << e.what();
         return std::nullopt;
     }
 }
@@ -544,152 +551,303 @@ std::optional<nlohmann::json> AASClient::fetchPropertyValue(
 {
     try
     {
-        std::cout << "Fetching property value from AAS with path - Asset: " << asset_id
-                  << ", Submodel: " << submodel_id_short
-                  << ", Path: [";
+        std::string joined_path;
         for (size_t i = 0; i < property_path.size(); ++i)
         {
-            std::cout << property_path[i];
-            if (i < property_path.size() - 1)
-                std::cout << " -> ";
-        }
-        std::cout << "]" << std::endl;
-
-        // Fetch the submodel data using common helper
-        auto submodel_data = fetchSubmodelData(asset_id, submodel_id_short);
-        if (!submodel_data.has_value())
-        {
-            return std::nullopt;
+            joined_path += (i > 0 ? " -> " : "") + property_path[i];
         }
+        BT_LOG_INFO << "Fetching property value from AAS with path - Asset: " << asset_id
+                    << ", Submodel: " << submodel_id_short
+                    << ", Path: [" << joined_path << "]";
 
-        // Navigate through the path to find the target property
-        if (!submodel_data->contains("submodelElements") || !(*submodel_data)["submodelElements"].is_array())
-        {
-            std::cerr << "Submodel missing submodelElements array" << std::endl;
-            return std::nullopt;
-        }
-
-        // Use the extracted recursive search method
-        auto result = searchPropertyInElements((*submodel_data)["submodelElements"], property_path, 0);
+        auto result = fetchPropertyValues(asset_id, {{submodel_id_short, property_path}}).front();
         if (result.has_value())
         {
             return result;
         }
 
-        std::cerr << "Could not find property path" << std::endl;
+        BT_LOG_ERROR << "Could not find property path";
         return std::nullopt;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception fetching property value with path from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception fetching property value with path from AAS: " << e.what();
         return std::nullopt;
     }
 }
 
-std::optional<nlohmann::json> AASClient::fetchSubmodelData(
+std::vector<std::optional<nlohmann::json>> AASClient::fetchPropertyValues(
     const std::string &asset_id,
-    const std::string &submodel_id_short)
+    const std::vector<PropertyRequest> &requests)
 {
-    try
+    std::vector<std::optional<nlohmann::json>> results(requests.size());
+    if (requests.empty())
     {
-        // Step 1: Get the shell descriptor from registry
-        std::string registry_url = "/shell-descriptors";
-        nlohmann::json registry_response = makeGetRequest(registry_url, true);
+        return results;
+    }
 
-        if (!registry_response.contains("result") || !registry_response["result"].is_array())
+    try
+    {
+        std::string shell_path = findShellPath(asset_id);
+        if (shell_path.empty())
         {
-            std::cerr << "Invalid registry response structure" << std::endl;
-            return std::nullopt;
+            return results;
         }
+        auto shell_doc = getMemoized(shell_path);
 
-        // Find the AAS with matching id (asset_id is the full AAS ID like https://smartproductionlab.aau.dk/aas/MIM8AAS)
-        std::string shell_endpoint;
-        for (const auto &shell : registry_response["result"])
+        // One index per distinct submodel of the batch; nullptr marks a submodel the shell lacks
+        std::map<std::string, std::shared_ptr<const PropertyIndex>> indexes;
+        size_t resolved = 0;
+        for (size_t i = 0; i < requests.size(); ++i)
         {
-            // Match by full id first, then try idShort for backwards compatibility
-            bool matches = false;
-            if (shell.contains("id") && shell["id"].get<std::string>() == asset_id)
+            const auto &request = requests[i];
+            if (request.property_path.empty())
             {
-                matches = true;
+                continue;
             }
-            else if (shell.contains("idShort"))
+
+            auto index_it = indexes.find(request.submodel_id_short);
+            if (index_it == indexes.end())
             {
-                // Try matching idShort for legacy support (e.g., "MIM8AAS" or adding "AAS" suffix)
-                std::string id_short = shell["idShort"].get<std::string>();
-                if (id_short == asset_id || asset_id.find(id_short) != std::string::npos)
+                std::string submodel_path = findSubmodelPath(*shell_doc, request.submodel_id_short);
+                if (submodel_path.empty())
                 {
-                    matches = true;
+                    BT_LOG_ERROR << "Could not find submodel with idShort: " << request.submodel_id_short;
                 }
+                index_it = indexes.emplace(request.submodel_id_short,
+                                           submodel_path.empty() ? nullptr : getPropertyIndex(submodel_path))
+                               .first;
             }
-            
-            if (matches)
+            if (!index_it->second)
             {
-                if (shell.contains("endpoints") && shell["endpoints"].is_array() && !shell["endpoints"].empty())
-                {
-                    shell_endpoint = shell["endpoints"][0]["protocolInformation"]["href"];
-                    break;
-                }
+                continue;
+            }
+            const PropertyIndex &index = *index_it->second;
+
+            std::string full_path;
+            for (const auto &id_short : request.property_path)
+            {
+                full_path += (full_path.empty() ? "" : "/") + id_short;
+            }
+
+            auto element_it = index.elements.find(full_path);
+            if (element_it != index.elements.end())
+            {
+                results[i] = elementValue(*element_it->second);
+            }
+            else if (index.submodel->contains("submodelElements") && (*index.submodel)["submodelElements"].is_array())
+            {
+                // Partial path or bare idShort: matches may sit at any depth
+                results[i] = searchPropertyInElements((*index.submodel)["submodelElements"], request.property_path, 0);
+            }
+
+            if (results[i].has_value())
+            {
+                resolved++;
             }
         }
 
-        if (shell_endpoint.empty())
+        BT_LOG_INFO << "Resolved " << resolved << "/" << requests.size() << " properties of " << asset_id
+                    << " from " << indexes.size() << " submodels";
+    }
+    catch (const std::exception &e)
+    {
+        BT_LOG_ERROR << "Exception fetching property values from AAS: " << e.what();
+    }
+    return results;
+}
+
+std::shared_ptr<const AASClient::PropertyIndex> AASClient::getPropertyIndex(const std::string &submodel_path)
+{
+    {
+        std::lock_guard<std::mutex> lock(memo_mutex_);
+        auto it = property_index_memo_.find(submodel_path);
+        if (it != property_index_memo_.end())
         {
-            std::cerr << "Could not find shell endpoint for asset: " << asset_id << std::endl;
-            return std::nullopt;
+            return it->second;
         }
+    }
+
+    auto index = std::make_shared<PropertyIndex>();
+    index->submodel = getMemoized(submodel_path);
 
-        // Extract the relative path from the full URL
-        size_t pos = shell_endpoint.find("/shells/");
-        if (pos == std::string::npos)
+    // Same containers the recursive search descends into; the first element on a path wins
+    std::function<void(const nlohmann::json &, const std::string &)> add_elements =
+        [&index, &add_elements](const nlohmann::json &elements, const std::string &prefix)
+    {
+        for (const auto &elem : elements)
         {
-            std::cerr << "Invalid shell endpoint format: " << shell_endpoint << std::endl;
-            return std::nullopt;
+            if (!elem.contains("idShort") || !elem["idShort"].is_string())
+            {
+                continue;
+            }
+            std::string path = prefix.empty() ? elem["idShort"].get<std::string>()
+                                              : prefix + "/" + elem["idShort"].get<std::string>();
+            index->elements.emplace(path, &elem);
+
+            if (elem.contains("value") && elem["value"].is_array())
+            {
+                add_elements(elem["value"], path);
+            }
+            else if (elem.contains("statements") && elem["statements"].is_array())
+            {
+                add_elements(elem["statements"], path);
+            }
         }
-        std::string shell_path = shell_endpoint.substr(pos);
+    };
 
-        // Step 2: Get the shell to find submodel references
-        nlohmann::json shell_data = makeGetRequest(shell_path);
+    const nlohmann::json &submodel_data = *index->submodel;
+    if (submodel_data.contains("submodelElements") && submodel_data["submodelElements"].is_array())
+    {
+        add_elements(submodel_data["submodelElements"], "");
+    }
+    else
+    {
+        BT_LOG_ERROR << "Submodel missing submodelElements array";
+    }
 
-        if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
+    std::lock_guard<std::mutex> lock(memo_mutex_);
+    return property_index_memo_.emplace(submodel_path, std::move(index)).first->second;
+}
+
+std::string AASClient::findShellPath(const std::string &asset_id)
+{
+    // Get the shell descriptor from registry
+    std::string registry_url = "/shell-descriptors";
+    nlohmann::json registry_response = makeGetRequest(registry_url, true);
+
+    if (!registry_response.contains("result") || !registry_response["result"].is_array())
+    {
+        BT_LOG_ERROR << "Invalid registry response structure";
+        return "";
+    }
+
+    // Find the AAS with matching id (asset_id is the full AAS ID like https://smartproductionlab.aau.dk/aas/MIM8AAS)
+    std::string shell_endpoint;
+    for (const auto &shell : registry_response["result"])
+    {
+        // Match by full id first, then try idShort for backwards compatibility
+        bool matches = false;
+        if (shell.contains("id") && shell["id"].get<std::string>() == asset_id)
         {
-            std::cerr << "Shell missing submodels array" << std::endl;
-            return std::nullopt;
+            matches = true;
+        }
+        else if (shell.contains("idShort"))
+        {
+            // Try matching idShort for legacy support (e.g., "MIM8AAS" or adding "AAS" suffix)
+            std::string id_short = shell["idShort"].get<std::string>();
+            if (id_short == asset_id || asset_id.find(id_short) != std::string::npos)
+            {
+                matches = true;
+            }
         }
 
-        // Find the submodel reference matching the submodel_id_short
-        std::string submodel_id;
-        for (const auto &submodel_ref : shell_data["submodels"])
+        if (matches)
         {
-            if (submodel_ref.contains("keys") && submodel_ref["keys"].is_array())
+            if (shell.contains("endpoints") && shell["endpoints"].is_array() && !shell["endpoints"].empty())
             {
-                std::string ref_value = submodel_ref["keys"][0]["value"];
-                if (ref_value.find(submodel_id_short) != std::string::npos)
-                {
-                    submodel_id = ref_value;
-                    break;
-                }
+                shell_endpoint = shell["endpoints"][0]["protocolInformation"]["href"];
+                break;
             }
         }
+    }
 
-        if (submodel_id.empty())
+    if (shell_endpoint.empty())
+    {
+        BT_LOG_ERROR << "Could not find shell endpoint for asset: " << asset_id;
+        return "";
+    }
+
+    // Extract the relative path from the full URL
+    size_t pos = shell_endpoint.find("/shells/");
+    if (pos == std::string::npos)
+    {
+        BT_LOG_ERROR << "Invalid shell endpoint format: " << shell_endpoint;
+        return "";
+    }
+    return shell_endpoint.substr(pos);
+}
+
+std::string AASClient::findSubmodelPath(const nlohmann::json &shell_data, const std::string &submodel_id_short)
+{
+    if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
+    {
+        BT_LOG_ERROR << "Shell missing submodels array";
+        return "";
+    }
+
+    // Find the submodel reference matching the submodel_id_short
+    for (const auto &submodel_ref : shell_data["submodels"])
+    {
+        if (submodel_ref.contains("keys") && submodel_ref["keys"].is_array())
+        {
+            std::string ref_value = submodel_ref["keys"][0]["value"];
+            if (ref_value.find(submodel_id_short) != std::string::npos)
+            {
+                // Submodels are addressed by base64url-encoded ID
+                return "/submodels/" + base64url_encode(ref_value);
+            }
+        }
+    }
+    return "";
+}
+
+std::optional<nlohmann::json> AASClient::fetchSubmodelData(
+    const std::string &asset_id,
+    const std::string &submodel_id_short)
+{
+    try
+    {
+        // Step 1: Get the shell endpoint from registry
+        std::string shell_path = findShellPath(asset_id);
+        if (shell_path.empty())
         {
-            std::cerr << "Could not find submodel with idShort: " << submodel_id_short << std::endl;
             return std::nullopt;
         }
 
-        // Step 3: Fetch the submodel using base64url-encoded ID
-        std::string submodel_id_b64 = base64url_encode(submodel_id);
-        std::string submodel_url = "/submodels/" + submodel_id_b64;
+        // Step 2: Get the shell to find submodel references
+        auto shell_doc = getMemoized(shell_path);
+
+        std::string submodel_url = findSubmodelPath(*shell_doc, submodel_id_short);
+        if (submodel_url.empty())
+        {
+            BT_LOG_ERROR << "Could not find submodel with idShort: " << submodel_id_short;
+            return std::nullopt;
+        }
 
-        return makeGetRequest(submodel_url);
+        // Step 3: Fetch the submodel
+        return *getMemoized(submodel_url);
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception fetching submodel data: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception fetching submodel data: " << e.what();
         return std::nullopt;
     }
 }
 
+std::optional<nlohmann::json> AASClient::elementValue(const nlohmann::json &elem)
+{
+    if (elem.contains("value") && !elem["value"].is_array())
+    {
+        BT_LOG_DEBUG << "Found property at path end, value: " << elem["value"].dump();
+        return elem["value"];
+    }
+    else if (elem.contains("valueId"))
+    {
+        BT_LOG_DEBUG << "Found property at path end, valueId: " << elem["valueId"].dump();
+        return elem["valueId"];
+    }
+    else if (elem.contains("value") && elem["value"].is_array())
+    {
+        // Return the whole collection/element if it's an array
+        BT_LOG_DEBUG << "Found collection at path end";
+        return elem["value"];
+    }
+
+    BT_LOG_ERROR << "Found element but it has no value or valueId";
+    return std::nullopt;
+}
+
 std::optional<nlohmann::json> AASClient::searchPropertyInElements(
     const nlohmann::json &elements,
     const std::vector<std::string> &property_path,
@@ -712,27 +870,7 @@ std::optional<nlohmann::json> AASClient::searchPropertyInElements(
             if (is_last_element)
             {
                 // This is the target property - return its value
-                if (elem.contains("value") && !elem["value"].is_array())
-                {
-                    std::cout << "Found property at path end, value: " << elem["value"].dump() << std::endl;
-                    return elem["value"];
-                }
-                else if (elem.contains("valueId"))
-                {
-                    std::cout << "Found property at path end, valueId: " << elem["valueId"].dump() << std::endl;
-                    return elem["valueId"];
-                }
-                else if (elem.contains("value") && elem["value"].is_array())
-                {
-                    // Return the whole collection/element if it's an array
-                    std::cout << "Found collection at path end" << std::endl;
-                    return elem["value"];
-                }
-                else
-                {
-                    std::cerr << "Found element but it has no value or valueId" << std::endl;
-                    return std::nullopt;
-                }
+                return elementValue(elem);
             }
             else
             {
@@ -773,11 +911,12 @@ std::optional<nlohmann::json> AASClient::searchPropertyInElements(
     return std::nullopt;
 }
 
-std::optional<nlohmann::json> AASClient::fetchHierarchicalStructure(const std::string &aas_shell_id)
+std::optional<nlohmann::json> AASClient::fetchHierarchicalStructure(const std::string &aas_shell_id,
+                                                                    const std::vector<std::string> &id_short_paths)
 {
     try
     {
-        std::cout << "Fetching HierarchicalStructures submodel for AAS: " << aas_shell_id << std::endl;
+        BT_LOG_INFO << "Fetching HierarchicalStructures submodel for AAS: " << aas_shell_id;
 
         // Step 1: Fetch the full shell to get submodel references
         std::string encoded_id = base64url_encode(aas_shell_id);
@@ -786,7 +925,7 @@ std::optional<nlohmann::json> AASClient::fetchHierarchicalStructure(const std::s
 
         if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
         {
-            std::cerr << "Shell missing submodels array" << std::endl;
+            BT_LOG_ERROR << "Shell missing submodels array";
             return std::nullopt;
         }
 
@@ -807,24 +946,25 @@ std::optional<nlohmann::json> AASClient::fetchHierarchicalStructure(const std::s
 
         if (submodel_id.empty())
         {
-            std::cerr << "HierarchicalStructures submodel reference not found for AAS: " << aas_shell_id << std::endl;
+            BT_LOG_ERROR << "HierarchicalStructures submodel reference not found for AAS: " << aas_shell_id;
             return std::nullopt;
         }
 
-        std::cout << "Found HierarchicalStructures submodel reference: " << submodel_id << std::endl;
+        BT_LOG_INFO << "Found HierarchicalStructures submodel reference: " << submodel_id;
 
         // Step 3: Fetch the submodel using base64url-encoded ID
         std::string submodel_id_b64 = base64url_encode(submodel_id);
         std::string submodel_url = "/submodels/" + submodel_id_b64;
 
-        nlohmann::json submodel_data = makeGetRequest(submodel_url);
-        std::cout << "Successfully fetched HierarchicalStructures submodel" << std::endl;
+        SubmodelFilter filter(id_short_paths);
+        nlohmann::json submodel_data = makeGetRequest(submodel_url, false, &filter);
+        BT_LOG_INFO << "Successfully fetched HierarchicalStructures submodel";
 
         return submodel_data;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching HierarchicalStructures: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching HierarchicalStructures: " << e.what();
         return std::nullopt;
     }
 }
@@ -833,157 +973,181 @@ std::optional<nlohmann::json> AASClient::fetchStationPosition(
     const std::string &station_asset_id,
     const std::string &filling_line_asset_id)
 {
-    try
+    BT_LOG_INFO << "Fetching position for station: " << station_asset_id
+                << " from line: " << filling_line_asset_id;
+
+    auto layout = fetchStationLayout(filling_line_asset_id);
+    if (!layout.has_value())
     {
-        std::cout << "Fetching position for station: " << station_asset_id 
-                  << " from line: " << filling_line_asset_id << std::endl;
+        return std::nullopt;
+    }
 
-        // Step 1: Fetch the filling line's HierarchicalStructures submodel
-        auto hs_data = fetchHierarchicalStructure(filling_line_asset_id);
+    auto position = layout->find(station_asset_id);
+    if (!position.has_value())
+    {
+        BT_LOG_ERROR << "Could not find station " << station_asset_id << " in HierarchicalStructures";
+    }
+    return position;
+}
+
+std::optional<AASClient::StationLayout> AASClient::fetchStationLayout(const std::string &filling_line_asset_id)
+{
+    try
+    {
+        // Step 1: Fetch the filling line's HierarchicalStructures submodel, keeping only the
+        // two statements read of each station
+        auto hs_data = fetchHierarchicalStructure(filling_line_asset_id, {"EntryNode/*/SameAs", "EntryNode/*/Location"});
         if (!hs_data.has_value())
         {
-            std::cerr << "Failed to fetch HierarchicalStructures for filling line" << std::endl;
+            BT_LOG_ERROR << "Failed to fetch HierarchicalStructures for filling line";
             return std::nullopt;
         }
 
         // Step 2: Find the EntryNode
         const auto &submodel_elements = hs_data.value()["submodelElements"];
-        nlohmann::json entry_node;
+        const nlohmann::json *entry_node = nullptr;
         for (const auto &elem : submodel_elements)
         {
             if (elem["idShort"] == "EntryNode")
             {
-                entry_node = elem;
+                entry_node = &elem;
                 break;
             }
         }
 
-        if (entry_node.empty())
+        if (!entry_node)
         {
-            std::cerr << "EntryNode not found in HierarchicalStructures" << std::endl;
+            BT_LOG_ERROR << "EntryNode not found in HierarchicalStructures";
             return std::nullopt;
         }
 
-        // Step 3: Search through statements to find the station entity
-        // The station_asset_id is the full AAS ID, we need to find the entity with matching globalAssetId
-        // or find by looking at the SameAs reference that points to the station's HierarchicalStructures
-        if (!entry_node.contains("statements") || !entry_node["statements"].is_array())
+        // Step 3: Collect every station entity with its SameAs reference and Location
+        if (!entry_node->contains("statements") || !(*entry_node)["statements"].is_array())
         {
-            std::cerr << "EntryNode has no statements" << std::endl;
+            BT_LOG_ERROR << "EntryNode has no statements";
             return std::nullopt;
         }
 
-        for (const auto &statement : entry_node["statements"])
+        StationLayout layout;
+        for (const auto &statement : (*entry_node)["statements"])
         {
-            if (statement["modelType"] != "Entity")
+            if (statement["modelType"] != "Entity" ||
+                !statement.contains("statements") || !statement["statements"].is_array())
                 continue;
 
-            // Check if this entity references our station
-            // Method 1: Check SameAs reference for the station's submodel ID
-            bool is_matching_station = false;
-            std::string entity_name = statement.value("idShort", "");
+            StationLayout::Station station;
+            station.name = statement.value("idShort", "");
 
-            if (statement.contains("statements") && statement["statements"].is_array())
+            for (const auto &inner_stmt : statement["statements"])
             {
-                for (const auto &inner_stmt : statement["statements"])
+                if (inner_stmt.value("idShort", "") == "SameAs" &&
+                    inner_stmt["modelType"] == "ReferenceElement")
                 {
-                    if (inner_stmt.value("idShort", "") == "SameAs" && 
-                        inner_stmt["modelType"] == "ReferenceElement")
+                    // Submodel ID format: .../submodels/instances/{systemIdAAS}/HierarchicalStructures
+                    if (inner_stmt.contains("value") && inner_stmt["value"].contains("keys"))
                     {
-                        // Check if the reference points to our station's submodel
-                        if (inner_stmt.contains("value") && inner_stmt["value"].contains("keys"))
+                        for (const auto &key : inner_stmt["value"]["keys"])
                         {
-                            for (const auto &key : inner_stmt["value"]["keys"])
-                            {
-                                std::string key_value = key.value("value", "");
-                                // Check if this references the station's AAS (extracting AAS ID from submodel ID)
-                                // Submodel ID format: .../submodels/instances/{systemIdAAS}/HierarchicalStructures
-                                if (key_value.find(station_asset_id) != std::string::npos)
-                                {
-                                    is_matching_station = true;
-                                    break;
-                                }
-                                // Also check by extracting system name from station_asset_id
-                                // station_asset_id: https://...aas/imaDispensingSystemAAS
-                                // key_value: https://...submodels/instances/imaDispensingSystemAAS/HierarchicalStructures
-                                size_t aas_pos = station_asset_id.rfind("/aas/");
-                                if (aas_pos != std::string::npos)
-                                {
-                                    std::string system_id = station_asset_id.substr(aas_pos + 5);
-                                    if (key_value.find(system_id) != std::string::npos)
-                                    {
-                                        is_matching_station = true;
-                                        break;
-                                    }
-                                }
-                            }
+                            station.same_as.push_back(key.value("value", ""));
                         }
                     }
                 }
-            }
-
-            if (!is_matching_station)
-                continue;
-
-            // Found the matching station entity, now extract Location
-            if (statement.contains("statements") && statement["statements"].is_array())
-            {
-                for (const auto &inner_stmt : statement["statements"])
+                else if (inner_stmt.value("idShort", "") == "Location" &&
+                         inner_stmt["modelType"] == "SubmodelElementCollection" &&
+                         !station.position.contains("x"))
                 {
-                    if (inner_stmt.value("idShort", "") == "Location" && 
-                        inner_stmt["modelType"] == "SubmodelElementCollection")
+                    nlohmann::json position;
+                    if (inner_stmt.contains("value") && inner_stmt["value"].is_array())
                     {
-                        nlohmann::json position;
-                        if (inner_stmt.contains("value") && inner_stmt["value"].is_array())
+                        for (const auto &prop : inner_stmt["value"])
                         {
-                            for (const auto &prop : inner_stmt["value"])
+                            std::string prop_name = prop.value("idShort", "");
+                            if (prop_name == "x" || prop_name == "X")
                             {
-                                std::string prop_name = prop.value("idShort", "");
-                                if (prop_name == "x" || prop_name == "X")
-                                {
-                                    position["x"] = std::stof(prop.value("value", "0"));
-                                }
-                                else if (prop_name == "y" || prop_name == "Y")
-                                {
-                                    position["y"] = std::stof(prop.value("value", "0"));
-                                }
-                                else if (prop_name == "yaw" || prop_name == "Yaw" || 
-                                         prop_name == "theta" || prop_name == "Theta")
-                                {
-                                    position["theta"] = std::stof(prop.value("value", "0"));
-                                }
+                                position["x"] = std::stof(prop.value("value", "0"));
+                            }
+                            else if (prop_name == "y" || prop_name == "Y")
+                            {
+                                position["y"] = std::stof(prop.value("value", "0"));
+                            }
+                            else if (prop_name == "yaw" || prop_name == "Yaw" ||
+                                     prop_name == "theta" || prop_name == "Theta")
+                            {
+                                position["theta"] = std::stof(prop.value("value", "0"));
                             }
                         }
-
-                        if (position.contains("x") && position.contains("y"))
-                        {
-                            std::cout << "Found position for " << entity_name << ": x=" 
-                                      << position["x"] << ", y=" << position["y"];
-                            if (position.contains("theta"))
-                                std::cout << ", theta=" << position["theta"];
-                            std::cout << std::endl;
-                            return position;
-                        }
+                    }
+                    if (position.contains("x") && position.contains("y"))
+                    {
+                        station.position = position;
                     }
                 }
             }
+
+            if (station.same_as.empty() || station.position.is_null())
+                continue;
+
+            layout.add(std::move(station));
         }
 
-        std::cerr << "Could not find station " << station_asset_id << " in HierarchicalStructures" << std::endl;
-        return std::nullopt;
+        BT_LOG_INFO << "Station layout of " << filling_line_asset_id << ": " << layout.stations.size()
+                    << " stations with a position";
+        return layout;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching station position: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching station position: " << e.what();
         return std::nullopt;
     }
 }
 
+void AASClient::StationLayout::add(Station station)
+{
+    for (const auto &key_value : station.same_as)
+    {
+        size_t instances_pos = key_value.find("/instances/");
+        if (instances_pos == std::string::npos)
+            continue;
+        size_t id_start = instances_pos + 11; // length of "/instances/"
+        size_t id_end = key_value.find('/', id_start);
+        by_system_id.emplace(key_value.substr(id_start, id_end == std::string::npos ? std::string::npos : id_end - id_start),
+                             stations.size());
+    }
+    stations.push_back(std::move(station));
+}
+
+std::optional<nlohmann::json> AASClient::StationLayout::find(const std::string &station_asset_id) const
+{
+    // station_asset_id: https://...aas/imaDispensingSystemAAS
+    size_t aas_pos = station_asset_id.rfind("/aas/");
+    std::string system_id = aas_pos != std::string::npos ? station_asset_id.substr(aas_pos + 5) : "";
+
+    auto indexed = by_system_id.find(system_id);
+    if (!system_id.empty() && indexed != by_system_id.end())
+    {
+        return stations[indexed->second].position;
+    }
+
+    // A reference containing the station's AAS ID or its system name
+    for (const auto &station : stations)
+    {
+        for (const auto &key_value : station.same_as)
+        {
+            if (key_value.find(station_asset_id) != std::string::npos ||
+                (!system_id.empty() && key_value.find(system_id) != std::string::npos))
+            {
+                return station.position;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
 std::optional<nlohmann::json> AASClient::fetchRequiredCapabilities(const std::string &aas_shell_id)
 {
     try
     {
-        std::cout << "Fetching RequiredCapabilities submodel for AAS: " << aas_shell_id << std::endl;
+        BT_LOG_INFO << "Fetching RequiredCapabilities submodel for AAS: " << aas_shell_id;
 
         // Step 1: Fetch the full shell to get submodel references
         std::string encoded_id = base64url_encode(aas_shell_id);
@@ -992,7 +1156,7 @@ std::optional<nlohmann::json> AASClient::fetchRequiredCapabilities(const std::st
 
         if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
         {
-            std::cerr << "Shell missing submodels array" << std::endl;
+            BT_LOG_ERROR << "Shell missing submodels array";
             return std::nullopt;
         }
 
@@ -1013,24 +1177,24 @@ std::optional<nlohmann::json> AASClient::fetchRequiredCapabilities(const std::st
 
         if (submodel_id.empty())
         {
-            std::cerr << "RequiredCapabilities submodel reference not found for AAS: " << aas_shell_id << std::endl;
+            BT_LOG_ERROR << "RequiredCapabilities submodel reference not found for AAS: " << aas_shell_id;
             return std::nullopt;
         }
 
-        std::cout << "Found RequiredCapabilities submodel reference: " << submodel_id << std::endl;
+        BT_LOG_INFO << "Found RequiredCapabilities submodel reference: " << submodel_id;
 
         // Step 3: Fetch the submodel using base64url-encoded ID
         std::string submodel_id_b64 = base64url_encode(submodel_id);
         std::string submodel_url = "/submodels/" + submodel_id_b64;
 
         nlohmann::json submodel_data = makeGetRequest(submodel_url);
-        std::cout << "Successfully fetched RequiredCapabilities submodel" << std::endl;
+        BT_LOG_INFO << "Successfully fetched RequiredCapabilities submodel";
 
         return submodel_data;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching RequiredCapabilities: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching RequiredCapabilities: " << e.what();
         return std::nullopt;
     }
 }
@@ -1039,7 +1203,7 @@ std::optional<nlohmann::json> AASClient::fetchProcessInformation(const std::stri
 {
     try
     {
-        std::cout << "Fetching ProcessInformation submodel for AAS: " << aas_shell_id << std::endl;
+        BT_LOG_INFO << "Fetching ProcessInformation submodel for AAS: " << aas_shell_id;
 
         // Step 1: Fetch the full shell to get submodel references
         std::string encoded_id = base64url_encode(aas_shell_id);
@@ -1048,7 +1212,7 @@ std::optional<nlohmann::json> AASClient::fetchProcessInformation(const std::stri
 
         if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
         {
-            std::cerr << "Shell missing submodels array" << std::endl;
+            BT_LOG_ERROR << "Shell missing submodels array";
             return std::nullopt;
         }
 
@@ -1069,24 +1233,24 @@ std::optional<nlohmann::json> AASClient::fetchProcessInformation(const std::stri
 
         if (submodel_id.empty())
         {
-            std::cerr << "ProcessInformation submodel reference not found for AAS: " << aas_shell_id << std::endl;
+            BT_LOG_ERROR << "ProcessInformation submodel reference not found for AAS: " << aas_shell_id;
             return std::nullopt;
         }
 
-        std::cout << "Found ProcessInformation submodel reference: " << submodel_id << std::endl;
+        BT_LOG_INFO << "Found ProcessInformation submodel reference: " << submodel_id;
 
         // Step 3: Fetch the submodel using base64url-encoded ID
         std::string submodel_id_b64 = base64url_encode(submodel_id);
         std::string submodel_url = "/submodels/" + submodel_id_b64;
 
         nlohmann::json submodel_data = makeGetRequest(submodel_url);
-        std::cout << "Successfully fetched ProcessInformation submodel" << std::endl;
+        BT_LOG_INFO << "Successfully fetched ProcessInformation submodel";
 
         return submodel_data;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching ProcessInformation: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching ProcessInformation: " << e.what();
         return std::nullopt;
     }
 }
@@ -1095,7 +1259,7 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
 {
     try
     {
-        std::cout << "Fetching Policy submodel for AAS: " << aas_shell_id << std::endl;
+        BT_LOG_INFO << "Fetching Policy submodel for AAS: " << aas_shell_id;
 
         // Step 1: Fetch the full shell to get submodel references
         std::string encoded_id = base64url_encode(aas_shell_id);
@@ -1104,7 +1268,7 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
 
         if (!shell_data.contains("submodels") || !shell_data["submodels"].is_array())
         {
-            std::cerr << "Shell missing submodels array" << std::endl;
+            BT_LOG_ERROR << "Shell missing submodels array";
             return std::nullopt;
         }
 
@@ -1125,11 +1289,11 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
 
         if (submodel_id.empty())
         {
-            std::cerr << "Policy submodel reference not found for AAS: " << aas_shell_id << std::endl;
+            BT_LOG_ERROR << "Policy submodel reference not found for AAS: " << aas_shell_id;
             return std::nullopt;
         }
 
-        std::cout << "Found Policy submodel reference: " << submodel_id << std::endl;
+        BT_LOG_INFO << "Found Policy submodel reference: " << submodel_id;
 
         // Step 3: Fetch the submodel using base64url-encoded ID
         std::string submodel_id_b64 = base64url_encode(submodel_id);
@@ -1141,7 +1305,7 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
         // Structure: Policy submodel -> submodelElements -> Policy (SMC) -> value -> File
         if (!submodel_data.contains("submodelElements") || !submodel_data["submodelElements"].is_array())
         {
-            std::cerr << "Policy submodel missing submodelElements array" << std::endl;
+            BT_LOG_ERROR << "Policy submodel missing submodelElements array";
             return std::nullopt;
         }
 
@@ -1158,7 +1322,7 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
             if (model_type == "File" && element.contains("value"))
             {
                 std::string bt_url = element["value"].get<std::string>();
-                std::cout << "Found BT description URL in File element '" << id_short << "': " << bt_url << std::endl;
+                BT_LOG_INFO << "Found BT description URL in File element '" << id_short << "': " << bt_url;
                 return bt_url;
             }
 
@@ -1172,19 +1336,19 @@ std::optional<std::string> AASClient::fetchPolicyBTUrl(const std::string &aas_sh
                     if (nested_model_type == "File" && nested_elem.contains("value"))
                     {
                         std::string bt_url = nested_elem["value"].get<std::string>();
-                        std::cout << "Found BT description URL in nested File element: " << bt_url << std::endl;
+                        BT_LOG_INFO << "Found BT description URL in nested File element: " << bt_url;
                         return bt_url;
                     }
                 }
             }
         }
 
-        std::cerr << "Could not find File property in Policy submodel" << std::endl;
+        BT_LOG_ERROR << "Could not find File property in Policy submodel";
         return std::nullopt;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error fetching Policy BT URL: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error fetching Policy BT URL: " << e.what();
         return std::nullopt;
     }
 }
@@ -1200,7 +1364,7 @@ std::optional<nlohmann::json> AASClient::lookupAssetById(const std::string &asse
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error looking up asset: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error looking up asset: " << e.what();
         return std::nullopt;
     }
 }
@@ -1209,7 +1373,7 @@ std::optional<std::string> AASClient::lookupAasIdFromAssetId(const std::string &
 {
     try
     {
-        std::cout << "Looking up AAS shell ID for asset: " << asset_id << std::endl;
+        BT_LOG_INFO << "Looking up AAS shell ID for asset: " << asset_id;
 
         // Query the registry for all shell descriptors
         std::string endpoint = "/shell-descriptors";
@@ -1217,7 +1381,7 @@ std::optional<std::string> AASClient::lookupAasIdFromAssetId(const std::string &
 
         if (!response.contains("result") || !response["result"].is_array())
         {
-            std::cerr << "Invalid response from registry" << std::endl;
+            BT_LOG_ERROR << "Invalid response from registry";
             return std::nullopt;
         }
 
@@ -1231,18 +1395,18 @@ std::optional<std::string> AASClient::lookupAasIdFromAssetId(const std::string &
                 if (shell_descriptor.contains("id"))
                 {
                     std::string shell_id = shell_descriptor["id"].get<std::string>();
-                    std::cout << "  ✓ Found matching AAS shell ID: " << shell_id << std::endl;
+                    BT_LOG_INFO << "  ✓ Found matching AAS shell ID: " << shell_id;
                     return shell_id;
                 }
             }
         }
 
-        std::cerr << "No AAS shell found for asset ID: " << asset_id << std::endl;
+        BT_LOG_ERROR << "No AAS shell found for asset ID: " << asset_id;
         return std::nullopt;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error looking up AAS ID from asset ID: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error looking up AAS ID from asset ID: " << e.what();
         return std::nullopt;
     }
 }
@@ -1253,14 +1417,14 @@ std::optional<std::string> AASClient::resolveInterfaceReference(
 {
     try
     {
-        std::cout << "Resolving interface reference for interaction: " << interaction
-                  << " in Variables submodel of asset: " << asset_id << std::endl;
+        BT_LOG_INFO << "Resolving interface reference for interaction: " << interaction
+                    << " in Variables submodel of asset: " << asset_id;
 
         // Fetch the Variables submodel
         auto variables_data = fetchSubmodelData(asset_id, "Variables");
         if (!variables_data)
         {
-            std::cout << "No Variables submodel found for asset: " << asset_id << std::endl;
+            BT_LOG_INFO << "No Variables submodel found for asset: " << asset_id;
             return std::nullopt;
         }
 
@@ -1268,7 +1432,7 @@ std::optional<std::string> AASClient::resolveInterfaceReference(
         if (!variables_data->contains("submodelElements") ||
             !(*variables_data)["submodelElements"].is_array())
         {
-            std::cout << "Variables submodel has no submodelElements" << std::endl;
+            BT_LOG_INFO << "Variables submodel has no submodelElements";
             return std::nullopt;
         }
 
@@ -1297,7 +1461,7 @@ std::optional<std::string> AASClient::resolveInterfaceReference(
                 if (!child.contains("value") || !child["value"].contains("keys") ||
                     !child["value"]["keys"].is_array())
                 {
-                    std::cerr << "InterfaceReference has invalid structure" << std::endl;
+                    BT_LOG_ERROR << "InterfaceReference has invalid structure";
                     return std::nullopt;
                 }
 
@@ -1306,7 +1470,7 @@ std::optional<std::string> AASClient::resolveInterfaceReference(
                 const auto &keys = child["value"]["keys"];
                 if (keys.empty())
                 {
-                    std::cerr << "InterfaceReference has no keys" << std::endl;
+                    BT_LOG_ERROR << "InterfaceReference has no keys";
                     return std::nullopt;
                 }
 
@@ -1314,23 +1478,23 @@ std::optional<std::string> AASClient::resolveInterfaceReference(
                 const auto &last_key = keys[keys.size() - 1];
                 if (!last_key.contains("value"))
                 {
-                    std::cerr << "InterfaceReference last key has no value" << std::endl;
+                    BT_LOG_ERROR << "InterfaceReference last key has no value";
                     return std::nullopt;
                 }
 
                 std::string resolved_interface = last_key["value"].get<std::string>();
-                std::cout << "Resolved interface reference: " << interaction
-                          << " -> " << resolved_interface << std::endl;
+                BT_LOG_INFO << "Resolved interface reference: " << interaction
+                            << " -> " << resolved_interface;
                 return resolved_interface;
             }
         }
 
-        std::cout << "No InterfaceReference found for interaction: " << interaction << std::endl;
+        BT_LOG_INFO << "No InterfaceReference found for interaction: " << interaction;
         return std::nullopt;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Error resolving interface reference: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Error resolving interface reference: " << e.what();
         return std::nullopt;
     }
 }
\ No newline at end of file
@@ -1,9 +1,17 @@
 #include "aas/aas_interface_cache.h"
 #include "aas/aas_client.h"
 #include "utils.h"
+#include "metrics/span_trace.h"
+#include "mqtt/payload_codec.h"
+#include <fmt/format.h>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <algorithm>
 #include <cctype>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 namespace
 {
@@ -15,40 +23,92 @@ namespace
                        { return std::tolower(c); });
         return result;
     }
+
+    // asset_ref is the AAS ID itself or its last path segment (idShort)
+    bool refersTo(const std::string &asset_id, const std::string &asset_ref)
+    {
+        if (asset_id == asset_ref)
+        {
+            return true;
+        }
+        return asset_id.size() > asset_ref.size() &&
+               asset_id.compare(asset_id.size() - asset_ref.size(), asset_ref.size(), asset_ref) == 0 &&
+               asset_id[asset_id.size() - asset_ref.size() - 1] == '/';
+    }
+
+    bool sameTopic(const mqtt_utils::Topic &a, const mqtt_utils::Topic &b)
+    {
+        return a.getTopic() == b.getTopic() && a.getQos() == b.getQos() &&
+               a.getRetain() == b.getRetain() && a.getEncoding() == b.getEncoding() &&
+               a.getSchema() == b.getSchema();
+    }
+
+    nlohmann::json topicToSnapshot(const mqtt_utils::Topic &topic, const std::string &schema_url)
+    {
+        return {{"topic", topic.getTopic()},
+                {"qos", topic.getQos()},
+                {"retain", topic.getRetain()},
+                {"content_type", mqtt_utils::contentTypeFor(topic.getEncoding())},
+                {"schema", schema_url}};
+    }
+
+    mqtt_utils::Topic topicFromSnapshot(const nlohmann::json &entry, const nlohmann::json &schemas)
+    {
+        std::string schema_url = entry.value("schema", "");
+        auto schema = schemas.find(schema_url);
+        mqtt_utils::Topic topic(entry.at("topic").get<std::string>(),
+                                schema != schemas.end() ? *schema : nlohmann::json(),
+                                entry.value("qos", 0), entry.value("retain", false));
+        topic.setEncoding(mqtt_utils::parsePayloadEncoding(entry.value("content_type", ""))
+                              .value_or(mqtt_utils::PayloadEncoding::Json));
+        return topic;
+    }
 }
 
-AASInterfaceCache::AASInterfaceCache(AASClient &aas_client)
-    : aas_client_(aas_client)
+AASInterfaceCache::AASInterfaceCache(AASClient &aas_client, size_t max_parallel_fetches)
+    : aas_client_(aas_client),
+      max_parallel_fetches_(std::max<size_t>(max_parallel_fetches, 1))
 {
 }
 
 bool AASInterfaceCache::prefetchInterfaces(const std::map<std::string, std::string> &asset_ids)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // Only one prefetch at a time; readers keep using mutex_ and are blocked only while merging
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
 
-    std::cout << "AASInterfaceCache: Pre-fetching interfaces for " << asset_ids.size() << " assets..." << std::endl;
+    auto prefetch_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::string>> work(asset_ids.begin(), asset_ids.end());
 
-    clear();
+    std::cout << "AASInterfaceCache: Pre-fetching interfaces for " << asset_ids.size() << " assets ("
+              << std::min(max_parallel_fetches_, work.size()) << " parallel)..." << std::endl;
 
-    size_t success_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clear();
+    }
 
-    for (const auto &[equipment_name, asset_id] : asset_ids)
+    size_t success_count = fetchAssetsConcurrently(work);
+
+    // Station layouts of the lines nodes have used, so moves don't fetch them mid-run
+    std::set<std::string> layout_lines;
     {
-        std::cout << "  Fetching interfaces for: " << equipment_name << " (" << asset_id << ")" << std::endl;
+        std::lock_guard<std::mutex> lock(mutex_);
+        layout_lines = layout_lines_;
+    }
+    for (const auto &line_asset_id : layout_lines)
+    {
+        buildStationLayout(line_asset_id);
+    }
 
-        if (fetchAssetInterfaces(asset_id))
-        {
-            success_count++;
-        }
-        else
-        {
-            failed_assets_.insert(asset_id);
-            std::cerr << "  Warning: Failed to fetch interfaces for " << equipment_name << std::endl;
-        }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_prefetch_duration_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - prefetch_start);
     }
 
     std::cout << "AASInterfaceCache: Pre-fetch complete. "
-              << success_count << "/" << asset_ids.size() << " assets cached successfully." << std::endl
+              << success_count << "/" << asset_ids.size() << " assets cached successfully in "
+              << last_prefetch_duration_.count() << " ms." << std::endl
               << std::flush;
 
     std::cout << "AASInterfaceCache: Returning from prefetchInterfaces with " << (success_count > 0 ? "true" : "false") << std::endl
@@ -57,8 +117,348 @@ bool AASInterfaceCache::prefetchInterfaces(const std::map<std::string, std::stri
     return success_count > 0;
 }
 
-bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
+bool AASInterfaceCache::refreshInterfaces(const std::map<std::string, std::string> &asset_ids)
 {
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+
+    auto refresh_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::string>> work;
+    size_t kept = 0;
+    size_t evicted = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::set<std::string> wanted;
+        for (const auto &[equipment_name, asset_id] : asset_ids)
+        {
+            wanted.insert(asset_id);
+        }
+
+        auto evict = [&wanted](auto &per_asset)
+        {
+            size_t count = 0;
+            for (auto it = per_asset.begin(); it != per_asset.end();)
+            {
+                if (wanted.count(it->first) == 0)
+                {
+                    it = per_asset.erase(it);
+                    count++;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            return count;
+        };
+        evicted = evict(interface_cache_);
+        evict(variable_alias_cache_);
+        evict(asset_base_topics_);
+        evict(asset_fetch_latency_);
+        evict(asset_versions_);
+
+        // Assets that failed last time get another chance
+        failed_assets_.clear();
+
+        std::set<std::string> queued;
+        for (const auto &[equipment_name, asset_id] : asset_ids)
+        {
+            if (interface_cache_.count(asset_id) > 0)
+            {
+                kept++;
+            }
+            else if (queued.insert(asset_id).second)
+            {
+                work.emplace_back(equipment_name, asset_id);
+            }
+        }
+    }
+
+    std::cout << "AASInterfaceCache: Refreshing for " << asset_ids.size() << " assets: "
+              << kept << " kept, " << evicted << " evicted, " << work.size() << " to fetch" << std::endl;
+
+    size_t success_count = fetchAssetsConcurrently(work);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_prefetch_duration_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - refresh_start);
+    }
+
+    std::cout << "AASInterfaceCache: Refresh complete. " << success_count << "/" << work.size()
+              << " assets fetched in " << last_prefetch_duration_.count() << " ms." << std::endl;
+
+    return kept + success_count > 0;
+}
+
+std::vector<AASInterfaceCache::AssetChange> AASInterfaceCache::refreshAsset(const std::string &asset_ref)
+{
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+
+    std::set<std::string> asset_ids;
+    std::set<std::string> lines;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[asset_id, interfaces] : interface_cache_)
+        {
+            if (refersTo(asset_id, asset_ref))
+            {
+                asset_ids.insert(asset_id);
+            }
+        }
+        for (const auto &asset_id : failed_assets_)
+        {
+            if (refersTo(asset_id, asset_ref))
+            {
+                asset_ids.insert(asset_id);
+            }
+        }
+        for (const auto &line_asset_id : layout_lines_)
+        {
+            if (refersTo(line_asset_id, asset_ref))
+            {
+                lines.insert(line_asset_id);
+            }
+        }
+    }
+
+    std::vector<AssetChange> changes;
+    for (const auto &asset_id : asset_ids)
+    {
+        aas_client_.forgetAsset(asset_id);
+
+        auto start = std::chrono::steady_clock::now();
+        AssetInterfaces result;
+        bool ok = fetchAssetInterfaces(asset_id, result);
+        auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        asset_fetch_latency_[asset_id] = latency;
+        if (!ok)
+        {
+            std::cerr << "AASInterfaceCache: Refetch of " << asset_id << " failed, keeping its previous interfaces" << std::endl;
+            continue;
+        }
+
+        AssetChange change{asset_id, {}};
+        auto old_asset = interface_cache_.find(asset_id);
+        if (old_asset != interface_cache_.end())
+        {
+            // A changed alias can re-point any interaction, so then every one counts as changed
+            auto old_aliases = variable_alias_cache_.find(asset_id);
+            bool aliases_changed = old_aliases == variable_alias_cache_.end()
+                                       ? !result.aliases.empty()
+                                       : old_aliases->second != result.aliases;
+
+            for (const auto &[interaction, old_data] : old_asset->second)
+            {
+                auto new_data = result.interfaces.find(interaction);
+                bool unchanged = !aliases_changed && new_data != result.interfaces.end() &&
+                                 old_data.has_input == new_data->second.has_input &&
+                                 old_data.has_output == new_data->second.has_output &&
+                                 (!old_data.has_input || sameTopic(old_data.input_topic, new_data->second.input_topic)) &&
+                                 (!old_data.has_output || sameTopic(old_data.output_topic, new_data->second.output_topic));
+                if (unchanged)
+                {
+                    continue;
+                }
+                if (old_data.has_input)
+                {
+                    change.stale_topics.push_back(old_data.input_topic);
+                }
+                if (old_data.has_output)
+                {
+                    change.stale_topics.push_back(old_data.output_topic);
+                }
+            }
+        }
+
+        interface_cache_.erase(asset_id);
+        variable_alias_cache_.erase(asset_id);
+        asset_base_topics_.erase(asset_id);
+        asset_versions_.erase(asset_id);
+        failed_assets_.erase(asset_id);
+        mergeAssetInterfaces(asset_id, std::move(result));
+
+        std::cout << "AASInterfaceCache: Refetched " << asset_id << " in " << latency.count() << " ms, "
+                  << change.stale_topics.size() << " topic(s) changed" << std::endl;
+        changes.push_back(std::move(change));
+    }
+
+    for (const auto &line_asset_id : lines)
+    {
+        if (asset_ids.count(line_asset_id) == 0)
+        {
+            aas_client_.forgetAsset(line_asset_id);
+        }
+        buildStationLayout(line_asset_id);
+    }
+
+    return changes;
+}
+
+size_t AASInterfaceCache::fetchAssetsConcurrently(const std::vector<std::pair<std::string, std::string>> &work)
+{
+    size_t worker_count = std::min(max_parallel_fetches_, work.size());
+    std::atomic<size_t> next_index{0};
+    std::atomic<size_t> success_count{0};
+
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            size_t index = next_index.fetch_add(1);
+            if (index >= work.size())
+            {
+                return;
+            }
+            const auto &[equipment_name, asset_id] = work[index];
+
+            std::cout << "  Fetching interfaces for: " << equipment_name << " (" << asset_id << ")" << std::endl;
+
+            auto start = std::chrono::steady_clock::now();
+            AssetInterfaces result;
+            bool ok = fetchAssetInterfaces(asset_id, result);
+            auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            // Merge this asset's results; other assets keep fetching meanwhile
+            std::lock_guard<std::mutex> lock(mutex_);
+            asset_fetch_latency_[asset_id] = latency;
+            mergeAssetInterfaces(asset_id, std::move(result));
+
+            if (ok)
+            {
+                success_count++;
+            }
+            else
+            {
+                failed_assets_.insert(asset_id);
+                std::cerr << "  Warning: Failed to fetch interfaces for " << equipment_name << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < worker_count; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    worker(); // The calling thread takes part as well
+    for (auto &t : workers)
+    {
+        t.join();
+    }
+
+    return success_count;
+}
+
+void AASInterfaceCache::mergeAssetInterfaces(const std::string &asset_id, AssetInterfaces &&result)
+{
+    if (!result.base_topic.empty())
+    {
+        asset_base_topics_[asset_id] = result.base_topic;
+    }
+    if (!result.interfaces.empty())
+    {
+        interface_cache_[asset_id] = std::move(result.interfaces);
+    }
+    if (!result.aliases.empty())
+    {
+        variable_alias_cache_[asset_id] = std::move(result.aliases);
+    }
+    if (!result.version.empty())
+    {
+        asset_versions_[asset_id] = std::move(result.version);
+    }
+    unverified_assets_.erase(asset_id);
+}
+
+bool AASInterfaceCache::fillAsset(const std::string &asset_id)
+{
+    // Serialized with prefetchInterfaces: a node initializing during a prefetch waits
+    // for it instead of fetching the same asset a second time
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (interface_cache_.count(asset_id) > 0)
+        {
+            return true;
+        }
+        if (failed_assets_.count(asset_id) > 0)
+        {
+            return false;
+        }
+    }
+
+    std::cout << "AASInterfaceCache: Filling cache for asset not covered by prefetch: " << asset_id << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    AssetInterfaces result;
+    bool ok = fetchAssetInterfaces(asset_id, result);
+    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    asset_fetch_latency_[asset_id] = latency;
+    mergeAssetInterfaces(asset_id, std::move(result));
+    if (!ok)
+    {
+        failed_assets_.insert(asset_id);
+    }
+    return ok;
+}
+
+std::vector<std::optional<mqtt_utils::Topic>> AASInterfaceCache::resolveInterfaces(
+    const std::string &asset_id,
+    const std::vector<std::pair<std::string, std::string>> &requests)
+{
+    std::vector<std::optional<mqtt_utils::Topic>> topics;
+    topics.reserve(requests.size());
+    bool any_missing = false;
+    for (const auto &[interaction, endpoint] : requests)
+    {
+        topics.push_back(getInterface(asset_id, interaction, endpoint));
+        any_missing = any_missing || !topics.back().has_value();
+    }
+
+    if (!any_missing)
+    {
+        return topics;
+    }
+
+    // One batched fill for the whole asset, then retry everything that missed
+    if (!hasAsset(asset_id) && fillAsset(asset_id))
+    {
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            if (!topics[i].has_value())
+            {
+                topics[i] = getInterface(asset_id, requests[i].first, requests[i].second);
+            }
+        }
+    }
+
+    // Whatever the cached description can't answer (e.g. Variables references the
+    // cache didn't alias) goes to the direct, memoized AAS lookup
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        if (!topics[i].has_value())
+        {
+            std::cout << "AASInterfaceCache: " << requests[i].first << "/" << requests[i].second
+                      << " not cached for " << asset_id << ", querying AAS" << std::endl;
+            topics[i] = aas_client_.fetchInterface(asset_id, requests[i].first, requests[i].second);
+        }
+    }
+
+    return topics;
+}
+
+bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id, AssetInterfaces &result)
+{
+    TraceSpan span("fetchAssetInterfaces", "aas");
+    span.attr("asset", asset_id);
     try
     {
         // Fetch the AssetInterfacesDescription submodel
@@ -71,7 +471,7 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
         nlohmann::json shell_data;
         try
         {
-            shell_data = aas_client_.makeGetRequest(shell_path);
+            shell_data = *aas_client_.getMemoized(shell_path);
         }
         catch (const std::exception &e)
         {
@@ -114,7 +514,7 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
         nlohmann::json submodel_data;
         try
         {
-            submodel_data = aas_client_.makeGetRequest(submodel_url);
+            submodel_data = *aas_client_.getMemoized(submodel_url, &AASClient::interfaceFilter());
         }
         catch (const std::exception &e)
         {
@@ -189,7 +589,7 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
         // Store the base topic for this asset
         if (!base_topic.empty())
         {
-            asset_base_topics_[asset_id] = base_topic;
+            result.base_topic = base_topic;
         }
 
         // Find InteractionMetadata and extract all actions and properties
@@ -220,6 +620,8 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
                     int qos = 0;
                     bool retain = false;
                     std::string response_href;
+                    std::string content_type;
+                    std::string response_content_type;
                     std::string input_schema_url;
                     std::string output_schema_url;
 
@@ -234,6 +636,10 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
                                 {
                                     href = f["value"].get<std::string>();
                                 }
+                                else if (f_id == "contentType" && f["value"].is_string())
+                                {
+                                    content_type = f["value"].get<std::string>();
+                                }
                                 else if (f_id == "mqv_qos")
                                 {
                                     if (f["value"].is_number())
@@ -259,6 +665,10 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
                                         {
                                             response_href = resp_elem["value"].get<std::string>();
                                         }
+                                        else if (resp_elem["idShort"] == "contentType" && resp_elem["value"].is_string())
+                                        {
+                                            response_content_type = resp_elem["value"].get<std::string>();
+                                        }
                                     }
                                 }
                             }
@@ -328,6 +738,9 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
                         }
 
                         interface_data.input_topic = mqtt_utils::Topic(full_topic, input_schema, qos, retain);
+                        interface_data.input_schema_url = input_schema_url;
+                        interface_data.input_topic.setEncoding(
+                            mqtt_utils::parsePayloadEncoding(content_type).value_or(mqtt_utils::PayloadEncoding::Json));
                         interface_data.has_input = true;
                     }
 
@@ -347,19 +760,25 @@ bool AASInterfaceCache::fetchAssetInterfaces(const std::string &asset_id)
                         }
 
                         interface_data.output_topic = mqtt_utils::Topic(full_topic, output_schema, qos, retain);
+                        interface_data.output_schema_url = output_schema_url;
+                        // The response form may declare its own content type, else the request's applies
+                        interface_data.output_topic.setEncoding(
+                            mqtt_utils::parsePayloadEncoding(response_content_type.empty() ? content_type : response_content_type)
+                                .value_or(mqtt_utils::PayloadEncoding::Json));
                         interface_data.has_output = true;
                     }
 
-                    interface_cache_[asset_id][interaction_name] = interface_data;
+                    result.interfaces[interaction_name] = interface_data;
                 }
             }
         }
 
-        size_t num_interfaces = interface_cache_[asset_id].size();
-        std::cout << "    Cached " << num_interfaces << " interfaces" << std::endl;
+        size_t num_interfaces = result.interfaces.size();
+        std::cout << "    Cached " << num_interfaces << " interfaces for " << asset_id << std::endl;
 
         // Also fetch variable aliases for this asset
-        fetchVariableAliases(asset_id);
+        result.aliases = fetchVariableAliases(asset_id);
+        result.version = fetchAssetVersion(asset_id);
 
         return num_interfaces > 0;
     }
@@ -466,13 +885,86 @@ bool AASInterfaceCache::hasAsset(const std::string &asset_id) const
     return interface_cache_.find(asset_id) != interface_cache_.end();
 }
 
+bool AASInterfaceCache::loadStationLayout(const std::string &line_asset_id)
+{
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        layout_lines_.insert(line_asset_id);
+        if (station_layouts_.count(line_asset_id) > 0)
+        {
+            return true;
+        }
+    }
+    return buildStationLayout(line_asset_id);
+}
+
+std::optional<nlohmann::json> AASInterfaceCache::getStationPosition(
+    const std::string &station_asset_id,
+    const std::string &line_asset_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = station_layouts_.find(line_asset_id);
+        if (it != station_layouts_.end())
+        {
+            return it->second.find(station_asset_id);
+        }
+    }
+
+    if (!loadStationLayout(line_asset_id))
+    {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = station_layouts_.find(line_asset_id);
+    if (it == station_layouts_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second.find(station_asset_id);
+}
+
+void AASInterfaceCache::invalidateStationLayout(const std::string &line_asset_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (line_asset_id.empty())
+    {
+        station_layouts_.clear();
+    }
+    else
+    {
+        station_layouts_.erase(line_asset_id);
+    }
+}
+
+bool AASInterfaceCache::buildStationLayout(const std::string &line_asset_id)
+{
+    auto layout = aas_client_.fetchStationLayout(line_asset_id);
+    if (!layout.has_value())
+    {
+        std::cerr << "AASInterfaceCache: Could not load station layout of " << line_asset_id << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    station_layouts_[line_asset_id] = std::move(layout.value());
+    return true;
+}
+
 void AASInterfaceCache::clear()
 {
     // Note: mutex should already be locked by caller
     interface_cache_.clear();
+    station_layouts_.clear();
     variable_alias_cache_.clear();
     asset_base_topics_.clear();
     failed_assets_.clear();
+    asset_fetch_latency_.clear();
+    asset_versions_.clear();
+    unverified_assets_.clear();
+    snapshot_layout_lines_.clear();
 }
 
 AASInterfaceCache::CacheStats AASInterfaceCache::getStats() const
@@ -483,6 +975,8 @@ AASInterfaceCache::CacheStats AASInterfaceCache::getStats() const
     stats.total_assets = interface_cache_.size();
     stats.failed_assets = failed_assets_.size();
     stats.total_interfaces = 0;
+    stats.asset_fetch_latency = asset_fetch_latency_;
+    stats.last_prefetch_duration = last_prefetch_duration_;
 
     for (const auto &[asset_id, interfaces] : interface_cache_)
     {
@@ -519,7 +1013,7 @@ std::string AASInterfaceCache::extractBaseTopic(const std::string &topic) const
 
     return topic;
 }
-void AASInterfaceCache::fetchVariableAliases(const std::string &asset_id)
+std::map<std::string, std::string> AASInterfaceCache::fetchVariableAliases(const std::string &asset_id)
 {
     try
     {
@@ -528,13 +1022,13 @@ void AASInterfaceCache::fetchVariableAliases(const std::string &asset_id)
         if (!variables_data)
         {
             // No Variables submodel - this is normal for some assets
-            return;
+            return {};
         }
 
         if (!variables_data->contains("submodelElements") ||
             !(*variables_data)["submodelElements"].is_array())
         {
-            return;
+            return {};
         }
 
         std::map<std::string, std::string> aliases;
@@ -583,12 +1077,282 @@ void AASInterfaceCache::fetchVariableAliases(const std::string &asset_id)
 
         if (!aliases.empty())
         {
-            variable_alias_cache_[asset_id] = aliases;
             std::cout << "    Cached " << aliases.size() << " variable aliases" << std::endl;
         }
+        return aliases;
     }
     catch (const std::exception &e)
     {
         std::cerr << "    Exception fetching variable aliases: " << e.what() << std::endl;
+        return {};
+    }
+}
+
+std::string AASInterfaceCache::fetchAssetVersion(const std::string &asset_id)
+{
+    try
+    {
+        // The documents the interfaces and aliases were built from; all memoized by now
+        auto shell = aas_client_.getMemoized("/shells/" + aas_client_.base64url_encode(asset_id));
+        std::string submodel_path = aas_client_.findInterfaceSubmodelPath(asset_id);
+        if (submodel_path.empty())
+        {
+            return "";
+        }
+        auto interfaces = aas_client_.getMemoized(submodel_path, &AASClient::interfaceFilter());
+        auto variables = aas_client_.fetchSubmodelData(asset_id, "Variables");
+
+        size_t hash = 0;
+        for (const std::string &part : {shell->dump(), interfaces->dump(), variables ? variables->dump() : std::string()})
+        {
+            hash ^= std::hash<std::string>{}(part) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return fmt::format("{:016x}", hash);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "    Could not determine AAS version of " << asset_id << ": " << e.what() << std::endl;
+        return "";
+    }
+}
+
+bool AASInterfaceCache::saveSnapshot(const std::string &path) const
+{
+    nlohmann::json snapshot = {{"format", 1}, {"saved", bt_utils::getCurrentTimestampISO()}};
+    nlohmann::json &schemas = snapshot["schemas"] = nlohmann::json::object();
+    nlohmann::json &assets = snapshot["assets"] = nlohmann::json::object();
+    nlohmann::json &layouts = snapshot["station_layouts"] = nlohmann::json::object();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[asset_id, interfaces] : interface_cache_)
+        {
+            auto version = asset_versions_.find(asset_id);
+            auto base_topic = asset_base_topics_.find(asset_id);
+            auto aliases = variable_alias_cache_.find(asset_id);
+
+            nlohmann::json &asset = assets[asset_id];
+            asset["version"] = version != asset_versions_.end() ? version->second : "";
+            asset["base_topic"] = base_topic != asset_base_topics_.end() ? base_topic->second : "";
+            asset["aliases"] = aliases != variable_alias_cache_.end() ? nlohmann::json(aliases->second)
+                                                                      : nlohmann::json::object();
+            nlohmann::json &entries = asset["interfaces"] = nlohmann::json::object();
+            for (const auto &[interaction, data] : interfaces)
+            {
+                nlohmann::json &entry = entries[interaction] = nlohmann::json::object();
+                if (data.has_input)
+                {
+                    entry["input"] = topicToSnapshot(data.input_topic, data.input_schema_url);
+                    if (!data.input_schema_url.empty())
+                    {
+                        schemas[data.input_schema_url] = data.input_topic.getSchema();
+                    }
+                }
+                if (data.has_output)
+                {
+                    entry["output"] = topicToSnapshot(data.output_topic, data.output_schema_url);
+                    if (!data.output_schema_url.empty())
+                    {
+                        schemas[data.output_schema_url] = data.output_topic.getSchema();
+                    }
+                }
+            }
+        }
+
+        for (const auto &[line_asset_id, layout] : station_layouts_)
+        {
+            nlohmann::json &stations = layouts[line_asset_id] = nlohmann::json::array();
+            for (const auto &station : layout.stations)
+            {
+                stations.push_back({{"name", station.name}, {"same_as", station.same_as}, {"position", station.position}});
+            }
+        }
+    }
+
+    try
+    {
+        std::filesystem::path target(path);
+        if (target.has_parent_path())
+        {
+            std::filesystem::create_directories(target.parent_path());
+        }
+        // Write to a temporary file first so a crash never leaves a truncated snapshot
+        std::filesystem::path tmp = target;
+        tmp += ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::trunc);
+            file << snapshot.dump();
+            if (!file)
+            {
+                throw std::runtime_error("write failed");
+            }
+        }
+        std::filesystem::rename(tmp, target);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "AASInterfaceCache: Failed to write snapshot " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    std::cout << "AASInterfaceCache: Snapshot of " << assets.size() << " assets and " << layouts.size()
+              << " station layouts written to " << path << std::endl;
+    return true;
+}
+
+size_t AASInterfaceCache::loadSnapshot(const std::string &path, const std::map<std::string, std::string> &asset_ids)
+{
+    TraceSpan span("loadSnapshot", "aas");
+    nlohmann::json snapshot;
+    try
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            return 0;
+        }
+        snapshot = nlohmann::json::parse(file);
+        if (snapshot.value("format", 0) != 1)
+        {
+            std::cerr << "AASInterfaceCache: Ignoring snapshot " << path << " of unknown format" << std::endl;
+            return 0;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "AASInterfaceCache: Ignoring unreadable snapshot " << path << ": " << e.what() << std::endl;
+        return 0;
+    }
+
+    const nlohmann::json schemas = snapshot.value("schemas", nlohmann::json::object());
+    const nlohmann::json assets = snapshot.value("assets", nlohmann::json::object());
+
+    std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t loaded = 0;
+    for (const auto &[equipment_name, asset_id] : asset_ids)
+    {
+        auto asset = assets.find(asset_id);
+        if (asset == assets.end() || interface_cache_.count(asset_id) > 0)
+        {
+            continue;
+        }
+
+        try
+        {
+            AssetInterfaces result;
+            for (const auto &[interaction, entry] : asset->value("interfaces", nlohmann::json::object()).items())
+            {
+                InterfaceData data;
+                if (entry.contains("input"))
+                {
+                    data.input_topic = topicFromSnapshot(entry["input"], schemas);
+                    data.input_schema_url = entry["input"].value("schema", "");
+                    data.has_input = true;
+                }
+                if (entry.contains("output"))
+                {
+                    data.output_topic = topicFromSnapshot(entry["output"], schemas);
+                    data.output_schema_url = entry["output"].value("schema", "");
+                    data.has_output = true;
+                }
+                result.interfaces.emplace(interaction, std::move(data));
+            }
+            result.aliases = asset->value("aliases", std::map<std::string, std::string>{});
+            result.base_topic = asset->value("base_topic", "");
+            result.version = asset->value("version", "");
+            if (result.interfaces.empty())
+            {
+                continue;
+            }
+
+            failed_assets_.erase(asset_id);
+            mergeAssetInterfaces(asset_id, std::move(result));
+            unverified_assets_.insert(asset_id);
+            loaded++;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "AASInterfaceCache: Skipping snapshot entry of " << asset_id << ": " << e.what() << std::endl;
+        }
+    }
+
+    size_t layouts = 0;
+    for (const auto &[line_asset_id, stations] : snapshot.value("station_layouts", nlohmann::json::object()).items())
+    {
+        if (station_layouts_.count(line_asset_id) > 0 || !stations.is_array())
+        {
+            continue;
+        }
+        AASClient::StationLayout layout;
+        for (const auto &station : stations)
+        {
+            layout.add({station.value("name", ""),
+                        station.value("same_as", std::vector<std::string>{}),
+                        station.value("position", nlohmann::json())});
+        }
+        station_layouts_.emplace(line_asset_id, std::move(layout));
+        layout_lines_.insert(line_asset_id);
+        snapshot_layout_lines_.insert(line_asset_id);
+        layouts++;
     }
-}
\ No newline at end of file
+
+    std::cout << "AASInterfaceCache: Loaded " << loaded << "/" << asset_ids.size() << " assets and " << layouts
+              << " station layouts from snapshot " << path << " (saved " << snapshot.value("saved", "?")
+              << "), revalidating in the background" << std::endl;
+    return loaded;
+}
+
+std::vector<std::string> AASInterfaceCache::revalidateSnapshot()
+{
+    TraceSpan span("revalidateSnapshot", "aas");
+    std::map<std::string, std::string> loaded_versions;
+    std::set<std::string> lines;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &asset_id : unverified_assets_)
+        {
+            auto version = asset_versions_.find(asset_id);
+            loaded_versions[asset_id] = version != asset_versions_.end() ? version->second : "";
+        }
+        lines.swap(snapshot_layout_lines_);
+    }
+
+    // No lock is held while the AAS is queried: nodes keep resolving from the snapshot
+    std::vector<std::string> changed;
+    size_t unchecked = 0;
+    for (const auto &[asset_id, loaded_version] : loaded_versions)
+    {
+        aas_client_.forgetAsset(asset_id);
+        std::string current_version = fetchAssetVersion(asset_id);
+        if (current_version.empty())
+        {
+            unchecked++;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (unverified_assets_.erase(asset_id) == 0)
+        {
+            continue; // Refetched meanwhile
+        }
+        if (current_version != loaded_version)
+        {
+            changed.push_back(asset_id);
+        }
+    }
+
+    for (const auto &line_asset_id : lines)
+    {
+        aas_client_.forgetAsset(line_asset_id);
+        if (auto layout = aas_client_.fetchStationLayout(line_asset_id))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            station_layouts_[line_asset_id] = std::move(layout.value());
+        }
+    }
+
+    std::cout << "AASInterfaceCache: Snapshot revalidated: " << loaded_versions.size() - changed.size() - unchecked
+              << " unchanged, " << changed.size() << " changed, " << unchecked << " not reachable; "
+              << lines.size() << " station layouts rebuilt" << std::endl;
+    return changed;
+}
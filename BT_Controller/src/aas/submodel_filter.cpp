@@ -0,0 +1,147 @@
+#include "aas/submodel_filter.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Parser state of one open object or array
+    struct Frame
+    {
+        bool is_object = false;
+        bool has_id = false; // A submodel element, once its idShort has been read
+        bool pruned = false; // Its idShort leads to no declared path; skip the rest
+        std::string id_short;
+        std::string last_key;
+    };
+}
+
+SubmodelFilter::SubmodelFilter(std::vector<std::string> paths)
+{
+    std::sort(paths.begin(), paths.end());
+    for (const auto &path : paths)
+    {
+        std::vector<std::string> segments;
+        size_t start = 0;
+        while (start <= path.size())
+        {
+            size_t end = path.find('/', start);
+            if (end == std::string::npos)
+            {
+                end = path.size();
+            }
+            if (end > start)
+            {
+                segments.push_back(path.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        if (!segments.empty())
+        {
+            paths_.push_back(std::move(segments));
+        }
+        key_ += (key_.empty() ? "" : "|") + path;
+    }
+}
+
+bool SubmodelFilter::wanted(const std::vector<std::string_view> &element_path) const
+{
+    if (paths_.empty())
+    {
+        return true;
+    }
+    for (const auto &path : paths_)
+    {
+        size_t common = std::min(path.size(), element_path.size());
+        bool match = true;
+        for (size_t i = 0; i < common && match; ++i)
+        {
+            match = path[i] == "*" || path[i] == element_path[i];
+        }
+        if (match)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+nlohmann::json SubmodelFilter::parse(std::string_view body) const
+{
+    using parse_event_t = nlohmann::json::parse_event_t;
+
+    std::vector<Frame> frames;
+    std::vector<std::string_view> element_path;
+
+    // Path of the element open at depth: the idShorts of the elements enclosing it and its
+    // own. The root (depth 0) is the submodel itself, whose idShort is not part of paths.
+    auto path_to = [&](size_t depth) -> const std::vector<std::string_view> &
+    {
+        element_path.clear();
+        for (size_t d = 1; d <= depth && d < frames.size(); ++d)
+        {
+            if (frames[d].has_id)
+            {
+                element_path.emplace_back(frames[d].id_short);
+            }
+        }
+        return element_path;
+    };
+
+    nlohmann::json::parser_callback_t callback =
+        [&](int depth, parse_event_t event, nlohmann::json &parsed) -> bool
+    {
+        size_t level = static_cast<size_t>(depth);
+        switch (event)
+        {
+        case parse_event_t::object_start:
+        case parse_event_t::array_start:
+            frames.resize(level + 1);
+            frames[level] = Frame{};
+            frames[level].is_object = event == parse_event_t::object_start;
+            return true;
+
+        case parse_event_t::key:
+        {
+            // Keys sit one level below their object
+            Frame &object = frames[level - 1];
+            if (object.pruned)
+            {
+                return false;
+            }
+            object.last_key = parsed.get<std::string>();
+            return true;
+        }
+
+        case parse_event_t::value:
+        {
+            if (level == 0 || level - 1 >= frames.size())
+            {
+                return true;
+            }
+            Frame &object = frames[level - 1];
+            if (object.is_object && level - 1 > 0 && !object.has_id && object.last_key == "idShort" &&
+                parsed.is_string())
+            {
+                object.id_short = parsed.get<std::string>();
+                object.has_id = true;
+                object.pruned = !wanted(path_to(level - 1));
+            }
+            return true;
+        }
+
+        case parse_event_t::object_end:
+        {
+            bool drop = level > 0 && level < frames.size() && frames[level].has_id && !wanted(path_to(level));
+            frames.resize(level);
+            return !drop;
+        }
+
+        case parse_event_t::array_end:
+            frames.resize(level);
+            return true;
+        }
+        return true;
+    };
+
+    return nlohmann::json::parse(body.begin(), body.end(), callback);
+}
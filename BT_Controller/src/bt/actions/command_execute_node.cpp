@@ -3,6 +3,7 @@
 #include <behaviortree_cpp/bt_factory.h>
 #include <nlohmann/json.hpp>
 #include "utils.h"
+#include "logging/logger.h"
 #include <string>
 
 void CommandExecuteNode::initializeTopicsFromAAS()
@@ -20,38 +21,38 @@ void CommandExecuteNode::initializeTopicsFromAAS()
 
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         if (!operation_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Operation input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Operation input configured";
             return;
         }
 
         std::string asset_id = asset_input.value();
         std::string operation = operation_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_id
-                  << ", Operation: " << operation << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_id
+                    << ", Operation: " << operation;
 
         // Create Topic objects
-        auto request_opt = aas_client_.fetchInterface(asset_id, operation, "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, operation, "output");
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id,
+                                                     {{operation, "input"}, {operation, "output"}});
 
-        if (!request_opt.has_value() || !response_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttSubBase::setTopic("output", topics[1].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
@@ -79,9 +80,8 @@ BT::PortsList CommandExecuteNode::providedPorts()
                 "The parameters for the operation")};
 }
 
-nlohmann::json CommandExecuteNode::createMessage()
+void CommandExecuteNode::selectUuid()
 {
-    nlohmann::json message;
     BT::Expected<std::string> uuid = getInput<std::string>("Uuid");
     if (uuid && uuid.has_value() && !uuid.value().empty())
     {
@@ -91,6 +91,12 @@ nlohmann::json CommandExecuteNode::createMessage()
     {
         current_uuid_ = mqtt_utils::generate_uuid();
     }
+}
+
+nlohmann::json CommandExecuteNode::createMessage()
+{
+    nlohmann::json message;
+    selectUuid();
     BT::Expected<nlohmann::json> params = getInput<nlohmann::json>("Parameters");
 
     if (params)
@@ -102,9 +108,55 @@ nlohmann::json CommandExecuteNode::createMessage()
     }
     else
     {
-        std::cerr << "Warning: Could not get or parse 'Parameters' port. Error: " << params.error() << std::endl;
+        BT_LOG_ERROR << "Warning: Could not get or parse 'Parameters' port. Error: " << params.error();
     }
 
     message["Uuid"] = current_uuid_;
     return message;
 }
+
+void CommandExecuteNode::publishCommand()
+{
+    // Parameters given as a literal (the usual case) are parsed once; a blackboard entry
+    // holding a json, or text that does not parse, takes the createMessage() path
+    BT::Expected<std::string> params_text = getInput<std::string>("Parameters");
+    if (!params_text)
+    {
+        publish("input", createMessage());
+        return;
+    }
+
+    if (command_template_.empty() || params_text.value() != template_parameters_)
+    {
+        nlohmann::json message = nlohmann::json::object();
+        try
+        {
+            nlohmann::json params = BT::convertFromString<nlohmann::json>(params_text.value());
+            if (!params.empty() && params.is_object())
+            {
+                message.update(params);
+            }
+        }
+        catch (const std::exception &)
+        {
+            publish("input", createMessage());
+            return;
+        }
+        command_template_ = MessageTemplate(std::move(message), {"/Uuid"});
+        template_parameters_ = params_text.value();
+    }
+
+    selectUuid();
+    publish("input", command_template_, {current_uuid_});
+}
+
+void CommandExecuteNode::resendCommand()
+{
+    // Without a Uuid input selectUuid() draws a fresh one; a resend repeats the one sent.
+    // Rare enough to build the message in full.
+    std::string sent_uuid = current_uuid_;
+    nlohmann::json message = createMessage();
+    current_uuid_ = sent_uuid;
+    message["Uuid"] = current_uuid_;
+    publish("input", message);
+}
@@ -5,10 +5,10 @@ BT::PortsList ConfigurationNode::providedPorts()
 {
     return {
         BT::InputPort<std::string>("Product", "{product}", "Product AAS ID to fetch batch information from"),
-        BT::details::PortWithDefault<BT::SharedQueue<std::string>>(BT::PortDirection::OUTPUT,
-                                                                   "ProductIDs",
-                                                                   "{ProductIDs}",
-                                                                   "List of product IDs to produce"),
+        BT::details::PortWithDefault<ProductQueuePtr>(BT::PortDirection::OUTPUT,
+                                                      "ProductIDs",
+                                                      "{ProductIDs}",
+                                                      "List of product IDs to produce"),
         BT::OutputPort<int>("BatchSize", "{BatchSize}", "Initial size of the product queue"),
         BT::OutputPort<int>("IPCInspection", "{IPCInspection}", "In-process control inspection sampling rate (0-100)")};
 }
@@ -24,8 +24,15 @@ BT::NodeStatus ConfigurationNode::onStart()
     }
     std::string product_aas_id = product_input.value();
 
-    // Fetch the Quantity from the BatchInformation submodel
-    auto quantity_opt = aas_client_.fetchPropertyValue(product_aas_id, "BatchInformation", "Quantity");
+    // Quantity from BatchInformation and the IPC inspection rate from
+    // Requirements -> InProcessControls -> IPCInspection, in one pass over the product AAS
+    auto values = aas_client_.fetchPropertyValues(
+        product_aas_id,
+        {{"BatchInformation", {"Quantity"}},
+         {"Requirements", {"InProcessControls", "IPCInspection"}}});
+    const auto &quantity_opt = values[0];
+    const auto &qc_opt = values[1];
+
     if (!quantity_opt.has_value())
     {
         std::cerr << "Failed to fetch Quantity from BatchInformation submodel" << std::endl;
@@ -61,28 +68,23 @@ BT::NodeStatus ConfigurationNode::onStart()
     std::cout << "ConfigurationNode: Creating queue with " << batchSize << " product IDs" << std::endl;
 
     // Generate UUIDs for each product in the batch
+    std::vector<std::string> ids;
+    ids.reserve(batchSize);
     for (int i = 0; i < batchSize; ++i)
     {
-        std::string id = mqtt_utils::generate_uuid();
-        shared_queue->push_back(id);
+        ids.push_back(mqtt_utils::generate_uuid());
     }
 
-    // Store the queue in the blackboard
-    config().blackboard->set("ProductIDs", shared_queue);
+    // Store the queue in the blackboard; a new batch replaces the previous one whole
+    config().blackboard->set("ProductIDs", std::make_shared<ProductQueue>(std::move(ids)));
 
     // Store the initial queue size for QualityControlGate
     setOutput("BatchSize", batchSize);
     std::cout << "ConfigurationNode: Set BatchSize = " << batchSize << std::endl;
 
-    // Fetch IPC inspection rate from Requirements submodel
-    // Path: Requirements -> InProcessControls -> IPCInspection
+    // IPC inspection rate from the Requirements submodel
     int ipcInspection = 100; // Default to 100% if not found
-    
-    auto qc_opt = aas_client_.fetchPropertyValue(
-        product_aas_id, 
-        "Requirements", 
-        std::vector<std::string>{"InProcessControls", "IPCInspection"});
-    
+
     if (qc_opt.has_value())
     {
         try
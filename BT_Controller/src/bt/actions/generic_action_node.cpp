@@ -1,7 +1,7 @@
 #include "bt/actions/generic_action_node.h"
 #include "utils.h"
 #include "mqtt/node_message_distributor.h"
-#include "aas/aas_interface_cache.h"
+#include "logging/logger.h"
 
 // MoveShuttleToPosition implementation
 GenericActionNode::GenericActionNode(
@@ -26,47 +26,30 @@ void GenericActionNode::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_id = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_id << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_id;
 
-        // First, try to use the cached interfaces (fast path)
-        auto cache = MqttSubBase::getAASInterfaceCache();
-        if (cache)
-        {
-            auto cached_input = cache->getInterface(asset_id, this->name(), "input");
-            auto cached_output = cache->getInterface(asset_id, this->name(), "output");
-            if (cached_input.has_value() && cached_output.has_value())
-            {
-                std::cout << "Node '" << this->name() << "' using cached interfaces" << std::endl;
-                MqttPubBase::setTopic("input", cached_input.value());
-                MqttSubBase::setTopic("output", cached_output.value());
-                topics_initialized_ = true;
-                return;
-            }
-        }
-
-        // Fall back to direct AAS query (slow path)
-        std::cout << "Node '" << this->name() << "' falling back to direct AAS query" << std::endl;
-        auto request_opt = aas_client_.fetchInterface(asset_id, this->name(), "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, this->name(), "output");
+        // Cache first; a miss fills the whole asset once instead of one query per endpoint
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id,
+                                                     {{this->name(), "input"}, {this->name(), "output"}});
 
-        if (!request_opt.has_value() || !response_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttSubBase::setTopic("output", topics[1].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
@@ -77,3 +60,15 @@ json GenericActionNode::createMessage()
     message["Uuid"] = current_uuid_;
     return message;
 }
+
+void GenericActionNode::publishCommand()
+{
+    current_uuid_ = mqtt_utils::generate_uuid();
+    publish("input", command_template_, {current_uuid_});
+}
+
+void GenericActionNode::resendCommand()
+{
+    // publishCommand() draws a fresh Uuid; a resend must repeat the one already sent
+    publish("input", command_template_, {current_uuid_});
+}
@@ -1,6 +1,11 @@
 #include "bt/actions/move_to_position.h"
 #include "utils.h"
 #include "mqtt/node_message_distributor.h"
+#include "aas/aas_interface_cache.h"
+#include "bt/move_batcher.h"
+#include "bt/assignment_scheduler.h"
+#include "bt/sim_clock.h"
+#include "logging/logger.h"
 
 // Filling line AAS ID - used to look up station positions from HierarchicalStructures
 static const std::string FILLING_LINE_AAS_ID = "https://smartproductionlab.aau.dk/aas/aauFillingLineAAS";
@@ -18,32 +23,37 @@ void MoveToPosition::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_id = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_id << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_id;
 
         // Create Topic objects
-        auto request_opt = aas_client_.fetchInterface(asset_id, this->name(), "input");
-        auto halt_opt = aas_client_.fetchInterface(asset_id, "halt", "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, this->name(), "output");
+        auto topics = MqttSubBase::resolveInterfaces(
+            aas_client_, asset_id, {{this->name(), "input"}, {"halt", "input"}, {this->name(), "output"}});
 
-        if (!request_opt.has_value() || !halt_opt.has_value() || !response_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value() || !topics[2].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttPubBase::setTopic("halt", halt_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttPubBase::setTopic("halt", topics[1].value());
+        MqttSubBase::setTopic("output", topics[2].value());
         topics_initialized_ = true;
+
+        // Index the station poses now so moves look their targets up without network I/O
+        if (AASInterfaceCache *cache = MqttSubBase::getAASInterfaceCache())
+        {
+            cache->loadStationLayout(FILLING_LINE_AAS_ID);
+        }
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
@@ -68,57 +78,111 @@ BT::PortsList MoveToPosition::providedPorts()
     };
 }
 
+BT::NodeStatus MoveToPosition::onStart()
+{
+    move_started_ = SimClock::now();
+    return MqttActionNode::onStart();
+}
+
+void MoveToPosition::callback(const std::string &topic_key, const nlohmann::json &msg, mqtt::properties props)
+{
+    {
+        // Arrivals tell the scheduler how far each station is for the shuttles
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status() == BT::NodeStatus::RUNNING && !current_uuid_.empty() && !target_station_.empty() &&
+            msg.is_object() && msg.value("Uuid", "") == current_uuid_ && msg.value("State", "") == "SUCCESS")
+        {
+            AssignmentScheduler::instance().recordTravelTime(target_station_, SimClock::now() - move_started_);
+        }
+    }
+    MqttActionNode::callback(topic_key, msg, props);
+}
+
 void MoveToPosition::onHalted()
 {
     // Clean up when the node is halted
-    std::cout << name() << " node halted" << std::endl;
-    // Additional cleanup as needed
+    BT_LOG_INFO << name() << " node halted";
+    // Not sent yet: the planner never hears of the move
+    if (MoveBatcher *batcher = MoveBatcher::installed(); batcher && batcher->withdraw(current_uuid_))
+    {
+        return;
+    }
     nlohmann::json message;
     message["TargetPosition"] = 0;
     message["Uuid"] = current_uuid_;
     publish("halt", message);
 }
 
-nlohmann::json MoveToPosition::createMessage()
+std::optional<nlohmann::json> MoveToPosition::resolveTarget()
 {
     BT::Expected<std::string> TargetPosition = getInput<std::string>("TargetPosition");
     BT::Expected<std::string> Uuid = getInput<std::string>("Uuid");
 
-    nlohmann::json message;
-    if (TargetPosition.has_value() && Uuid.has_value())
+    if (!TargetPosition.has_value() || !Uuid.has_value())
     {
-        // TargetPosition now contains the station's AAS ID (e.g., https://...imaDispensingSystemAAS)
-        // We need to look up the actual x, y, yaw position from the filling line's HierarchicalStructures
-        std::string station_aas_id = TargetPosition.value();
-        current_uuid_ = Uuid.value();
-        
-        // Fetch position from the filling line's HierarchicalStructures
-        auto position_opt = aas_client_.fetchStationPosition(station_aas_id, FILLING_LINE_AAS_ID);
-        
-        if (position_opt.has_value())
-        {
-            const auto& pos = position_opt.value();
-            float x = pos.value("x", 0.0f);
-            float y = pos.value("y", 0.0f);
-            float theta = pos.value("theta", 0.0f);
-            
-            // Build message according to schema: Position: [x, y, theta]
-            message["Position"] = nlohmann::json::array({x, y, theta});
-            message["Uuid"] = current_uuid_;
-            message["TimeStamp"] = bt_utils::getCurrentTimestampISO();
-            
-            std::cout << "MoveToPosition: Moving to station " << station_aas_id 
-                      << " at position [" << x << ", " << y << ", " << theta << "]" << std::endl;
-        }
-        else
-        {
-            std::cerr << "MoveToPosition: Failed to fetch position for station: " << station_aas_id << std::endl;
-            // Return empty message to indicate failure
-            return nlohmann::json();
-        }
-        
-        return message;
+        return std::nullopt;
     }
 
-    return nlohmann::json();
+    // TargetPosition now contains the station's AAS ID (e.g., https://...imaDispensingSystemAAS)
+    // We need to look up the actual x, y, yaw position from the filling line's HierarchicalStructures
+    std::string station_aas_id = TargetPosition.value();
+    current_uuid_ = Uuid.value();
+    target_station_ = station_aas_id;
+
+    // Position from the filling line's HierarchicalStructures, indexed by the interface cache
+    AASInterfaceCache *cache = MqttSubBase::getAASInterfaceCache();
+    auto position_opt = cache ? cache->getStationPosition(station_aas_id, FILLING_LINE_AAS_ID)
+                              : aas_client_.fetchStationPosition(station_aas_id, FILLING_LINE_AAS_ID);
+
+    if (!position_opt.has_value())
+    {
+        BT_LOG_ERROR << "MoveToPosition: Failed to fetch position for station: " << station_aas_id;
+        return std::nullopt;
+    }
+
+    const auto& pos = position_opt.value();
+    float x = pos.value("x", 0.0f);
+    float y = pos.value("y", 0.0f);
+    float theta = pos.value("theta", 0.0f);
+
+    BT_LOG_INFO << "MoveToPosition: Moving to station " << station_aas_id
+                << " at position [" << x << ", " << y << ", " << theta << "]";
+
+    // Position according to schema: [x, y, theta]
+    return nlohmann::json::array({x, y, theta});
+}
+
+nlohmann::json MoveToPosition::createMessage()
+{
+    auto position = resolveTarget();
+    if (!position.has_value())
+    {
+        // Return empty message to indicate failure
+        return nlohmann::json();
+    }
+
+    nlohmann::json message;
+    message["Position"] = std::move(position.value());
+    message["Uuid"] = current_uuid_;
+    message["TimeStamp"] = bt_utils::getCurrentTimestampISO();
+    return message;
+}
+
+void MoveToPosition::publishCommand()
+{
+    auto position = resolveTarget();
+    if (!position.has_value())
+    {
+        publish("input", nlohmann::json());
+        return;
+    }
+    // Moves issued in the same loop go to the planner together as one batch
+    auto input = MqttPubBase::getPublishTopics().find("input");
+    MoveBatcher *batcher = MoveBatcher::installed();
+    if (batcher && input != MqttPubBase::getPublishTopics().end())
+    {
+        batcher->enqueue(input->second, std::move(position.value()), current_uuid_);
+        return;
+    }
+    publish("input", command_template_, {position.value(), current_uuid_, bt_utils::getCurrentTimestampISO()});
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <nlohmann/json.hpp>
 #include "bt/actions/pop_element_node.h"
 #include "aas/aas_client.h"
+#include "logging/logger.h"
 
 void PopElementNode::initializeTopicsFromAAS()
 {
@@ -18,22 +19,23 @@ void PopElementNode::initializeTopicsFromAAS()
         auto xbot_topic_opt = this->config().blackboard->getAnyLocked("Xbot");
         if (!xbot_topic_opt)
         {
-            std::cerr << "Node '" << this->name() << "' cannot access XbotTopic from blackboard" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' cannot access XbotTopic from blackboard";
             return;
         }
 
         std::string xbot_topic = xbot_topic_opt->cast<std::string>();
-        std::cout << "Node '" << this->name() << "' initializing for XbotTopic: " << xbot_topic << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for XbotTopic: " << xbot_topic;
 
         // Use xbot_topic directly (should be resolved from blackboard)
         std::string asset_id = xbot_topic;
 
         // Create Topic objects - ProductID property with output endpoint (data being published)
-        auto product_association_opt = aas_client_.fetchInterface(asset_id, "ProductID", "input");
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id, {{"ProductID", "input"}});
+        auto &product_association_opt = topics[0];
 
         if (!product_association_opt.has_value())
         {
-            std::cerr << "Failed to fetch interface from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interface from AAS for node: " << this->name();
             return;
         }
 
@@ -42,7 +44,7 @@ void PopElementNode::initializeTopicsFromAAS()
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
@@ -50,33 +52,11 @@ nlohmann::json PopElementNode::createMessage()
 {
     std::string product_id_to_publish;
     BT::NodeStatus status_if_queue_empty_or_invalid = getInput<BT::NodeStatus>("if_empty").value_or(BT::NodeStatus::FAILURE);
-    {
-        BT::AnyPtrLocked any_ref = getLockedPortContent("Queue");
-
-        if (!any_ref)
-        {
-            return status_if_queue_empty_or_invalid;
-        }
-
-        BT::Expected<BT::SharedQueue<std::string>> queue_expected = any_ref.get()->cast<BT::SharedQueue<std::string>>();
-        if (!queue_expected)
-        {
-            return status_if_queue_empty_or_invalid;
-        }
 
-        BT::SharedQueue<std::string> queue_ptr = queue_expected.value();
-        if (!queue_ptr)
-        {
-            return status_if_queue_empty_or_invalid;
-        }
-
-        if (queue_ptr->empty())
-        {
-            return status_if_queue_empty_or_invalid;
-        }
-
-        product_id_to_publish = std::move(queue_ptr->front());
-        queue_ptr->pop_front();
+    auto queue = getInput<ProductQueuePtr>("Queue");
+    if (!queue || !queue.value() || !queue.value()->pop(product_id_to_publish))
+    {
+        return status_if_queue_empty_or_invalid;
     }
 
     json message;
@@ -88,7 +68,7 @@ nlohmann::json PopElementNode::createMessage()
 BT::PortsList PopElementNode::providedPorts()
 {
     return {
-        BT::InputPort<BT::SharedQueue<std::string>>(
+        BT::InputPort<ProductQueuePtr>(
             "Queue",
             "{ProductIDs}",
             "The shared queue of product IDs. An element will be popped from it."),
@@ -4,6 +4,7 @@
 #include "utils.h"
 #include <string>
 #include "bt/actions/refill_node.h"
+#include "logging/logger.h"
 
 void RefillNode::initializeTopicsFromAAS()
 {
@@ -18,32 +19,31 @@ void RefillNode::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_id = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_id << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_id;
 
         // Create Topic objects
-        auto request_opt = aas_client_.fetchInterface(asset_id, "dispense", "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, "dispense", "output");
-        auto weight_opt = aas_client_.fetchInterface(asset_id, "weight", "output");
+        auto topics = MqttSubBase::resolveInterfaces(
+            aas_client_, asset_id, {{"dispense", "input"}, {"dispense", "output"}, {"weight", "output"}});
 
-        if (!request_opt.has_value() || !response_opt.has_value() || !weight_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value() || !topics[2].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
-        MqttSubBase::setTopic("weight", weight_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttSubBase::setTopic("output", topics[1].value());
+        MqttSubBase::setTopic("weight", topics[2].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
@@ -71,11 +71,9 @@ nlohmann::json RefillNode::createMessage()
     }
     else
     {
-        std::cerr << "Error: Uuid not provided to StationExecuteNode. Error: "
-                  << uuid.error() << std::endl;
-
         current_uuid_ = mqtt_utils::generate_uuid();
-        std::cerr << "Using generated UUID instead: " << current_uuid_ << std::endl;
+        BT_LOG_WARN << "Node '" << this->name() << "' has no Uuid (" << uuid.error()
+                    << "), using generated UUID " << current_uuid_;
     }
     message["Uuid"] = current_uuid_;
     message["StartWeight"] = weight_;
@@ -105,21 +103,7 @@ void RefillNode::callback(const std::string &topic_key, const nlohmann::json &ms
             {
                 if (msg["Uuid"] == current_uuid_)
                 {
-
-                    if (msg["State"] == "FAILURE")
-                    {
-                        current_uuid_ = "";
-                        setStatus(BT::NodeStatus::FAILURE);
-                    }
-                    else if (msg["State"] == "SUCCESS")
-                    {
-                        current_uuid_ = "";
-                        setStatus(BT::NodeStatus::SUCCESS);
-                    }
-                    else if (msg["State"] == "RUNNING")
-                    {
-                        setStatus(BT::NodeStatus::RUNNING);
-                    }
+                    handleCommandResponse(msg);
                 }
                 emitWakeUpSignal();
             }
@@ -1,6 +1,112 @@
 #include "bt/actions/retrieve_aas_properties_node.h"
 #include "utils.h"
-#include <iostream>
+#include "logging/logger.h"
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Convert an AAS property value to a blackboard value and write it under output_key;
+    // false if there is nothing to write
+    bool writePropertyValue(BT::Blackboard &blackboard, const std::string &output_key,
+                            const nlohmann::json &property_value)
+    {
+        // Get the blackboard entry for output_key (may be null if it doesn't exist yet)
+        std::shared_ptr<BT::Blackboard::Entry> dst_entry = blackboard.getEntry(output_key);
+
+        BT::Any out_value;
+
+        // Check if this is an AAS property with valueType metadata
+        if (property_value.is_object() && property_value.contains("valueType") && property_value.contains("value"))
+        {
+            // AAS property structure - use valueType to determine conversion
+            std::string value_type = property_value["valueType"].get<std::string>();
+            nlohmann::json value = property_value["value"];
+
+            if (value_type == "xs:int" || value_type == "xs:integer" ||
+                value_type == "xs:long" || value_type == "xs:short")
+            {
+                out_value = BT::Any(std::stoi(value.get<std::string>()));
+            }
+            else if (value_type == "xs:float" || value_type == "xs:double" || value_type == "xs:decimal")
+            {
+                out_value = BT::Any(std::stod(value.get<std::string>()));
+            }
+            else if (value_type == "xs:boolean" || value_type == "xs:bool")
+            {
+                std::string val_str = value.get<std::string>();
+                out_value = BT::Any(val_str == "true" || val_str == "True" || val_str == "TRUE" || val_str == "1");
+            }
+            else if (value_type == "xs:string")
+            {
+                out_value = BT::Any(value.get<std::string>());
+            }
+            else
+            {
+                // Unknown valueType, store as string
+                out_value = BT::Any(value.is_string() ? value.get<std::string>() : value.dump());
+            }
+        }
+        else if (property_value.is_string())
+        {
+            // Plain string value
+            out_value = BT::Any(property_value.get<std::string>());
+        }
+        else
+        {
+            // Complex structure or array without valueType - output as JSON string
+            out_value = BT::Any(property_value.dump());
+        }
+
+        if (out_value.empty())
+        {
+            BT_LOG_ERROR << "Property value is empty";
+            return false;
+        }
+
+        // Handle type conversion if the destination already exists with a specific type
+        if (dst_entry && dst_entry->info.type() != typeid(std::string) && out_value.isString())
+        {
+            try
+            {
+                out_value = dst_entry->info.parseString(out_value.cast<std::string>());
+            }
+            catch (const std::exception &e)
+            {
+                throw BT::LogicError("Can't convert string [", out_value.cast<std::string>(),
+                                     "] to type [", BT::demangle(dst_entry->info.type()),
+                                     "]: ", e.what());
+            }
+        }
+
+        // Write the value to the blackboard
+        blackboard.set(output_key, out_value);
+        return true;
+    }
+
+    std::vector<std::string> splitPath(const std::string &property_input)
+    {
+        std::vector<std::string> property_path;
+        std::stringstream ss(property_input);
+        std::string segment;
+        while (std::getline(ss, segment, '|'))
+        {
+            property_path.push_back(segment);
+        }
+        return property_path;
+    }
+
+    std::string trim(const std::string &s)
+    {
+        size_t begin = s.find_first_not_of(" \t\n\r");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        size_t end = s.find_last_not_of(" \t\n\r");
+        return s.substr(begin, end - begin + 1);
+    }
+}
 
 BT::PortsList RetrieveAASPropertyNode::providedPorts()
 {
@@ -52,23 +158,15 @@ BT::NodeStatus RetrieveAASPropertyNode::tick()
         if (property_input.find('|') != std::string::npos)
         {
             // Parse as path - split by pipe delimiter
-            std::vector<std::string> property_path;
-            std::stringstream ss(property_input);
-            std::string segment;
-            while (std::getline(ss, segment, '|'))
-            {
-                property_path.push_back(segment);
-            }
+            std::vector<std::string> property_path = splitPath(property_input);
 
-            std::cout << "Retrieving property path [";
+            std::string joined_path;
             for (size_t i = 0; i < property_path.size(); ++i)
             {
-                std::cout << property_path[i];
-                if (i < property_path.size() - 1)
-                    std::cout << " | ";
+                joined_path += (i > 0 ? " | " : "") + property_path[i];
             }
-            std::cout << "] from submodel '" << submodel_id_short
-                      << "' of asset '" << asset_name << "' (ID: " << asset_id << ")" << std::endl;
+            BT_LOG_INFO << "Retrieving property path [" << joined_path << "] from submodel '" << submodel_id_short
+                        << "' of asset '" << asset_name << "' (ID: " << asset_id << ")";
 
             // Fetch using path-based method
             property_value_opt = aas_client_.fetchPropertyValue(
@@ -77,9 +175,9 @@ BT::NodeStatus RetrieveAASPropertyNode::tick()
         else
         {
             // Simple property name
-            std::cout << "Retrieving property '" << property_input
-                      << "' from submodel '" << submodel_id_short
-                      << "' of asset '" << asset_name << "' (ID: " << asset_id << ")" << std::endl;
+            BT_LOG_INFO << "Retrieving property '" << property_input
+                        << "' from submodel '" << submodel_id_short
+                        << "' of asset '" << asset_name << "' (ID: " << asset_id << ")";
 
             // Fetch using simple method (which internally uses path-based with single element)
             property_value_opt = aas_client_.fetchPropertyValue(
@@ -88,91 +186,120 @@ BT::NodeStatus RetrieveAASPropertyNode::tick()
 
         if (!property_value_opt.has_value())
         {
-            std::cerr << "Failed to retrieve property from AAS" << std::endl;
+            BT_LOG_ERROR << "Failed to retrieve property from AAS";
             return BT::NodeStatus::FAILURE;
         }
 
-        nlohmann::json property_value = property_value_opt.value();
+        if (!writePropertyValue(*config().blackboard, output_key, property_value_opt.value()))
+        {
+            return BT::NodeStatus::FAILURE;
+        }
 
-        // Get the blackboard entry for output_key (may be null if it doesn't exist yet)
-        std::shared_ptr<BT::Blackboard::Entry> dst_entry =
-            config().blackboard->getEntry(output_key);
+        BT_LOG_INFO << "Successfully wrote property value to blackboard key '" << output_key << "'";
 
-        BT::Any out_value;
+        return BT::NodeStatus::SUCCESS;
+    }
+    catch (const std::exception &e)
+    {
+        BT_LOG_ERROR << "Exception in RetrieveAASPropertyNode: " << e.what();
+        return BT::NodeStatus::FAILURE;
+    }
+}
 
-        // Check if this is an AAS property with valueType metadata
-        if (property_value.is_object() && property_value.contains("valueType") && property_value.contains("value"))
-        {
-            // AAS property structure - use valueType to determine conversion
-            std::string value_type = property_value["valueType"].get<std::string>();
-            nlohmann::json value = property_value["value"];
+BT::PortsList RetrieveAASPropertiesNode::providedPorts()
+{
+    return {
+        BT::InputPort<std::string>("Asset", "The asset name to retrieve the properties from"),
+        BT::InputPort<std::string>("Submodel", "", "Submodel idShort for entries that don't name one"),
+        BT::InputPort<std::string>("Properties", "Entries 'output_key=[Submodel:]Property' separated by ';', "
+                                                 "Property being an idShort or a | delimited path")};
+}
 
-            if (value_type == "xs:int" || value_type == "xs:integer" ||
-                value_type == "xs:long" || value_type == "xs:short")
-            {
-                out_value = BT::Any(std::stoi(value.get<std::string>()));
-            }
-            else if (value_type == "xs:float" || value_type == "xs:double" || value_type == "xs:decimal")
-            {
-                out_value = BT::Any(std::stod(value.get<std::string>()));
-            }
-            else if (value_type == "xs:boolean" || value_type == "xs:bool")
-            {
-                std::string val_str = value.get<std::string>();
-                out_value = BT::Any(val_str == "true" || val_str == "True" || val_str == "TRUE" || val_str == "1");
-            }
-            else if (value_type == "xs:string")
-            {
-                out_value = BT::Any(value.get<std::string>());
-            }
-            else
-            {
-                // Unknown valueType, store as string
-                out_value = BT::Any(value.is_string() ? value.get<std::string>() : value.dump());
-            }
-        }
-        else if (property_value.is_string())
+BT::NodeStatus RetrieveAASPropertiesNode::tick()
+{
+    std::string asset_name;
+    if (!getInput("Asset", asset_name))
+    {
+        throw BT::RuntimeError("missing port [Asset]");
+    }
+
+    std::string properties_input;
+    if (!getInput("Properties", properties_input))
+    {
+        throw BT::RuntimeError("missing port [Properties]");
+    }
+
+    std::string default_submodel;
+    getInput("Submodel", default_submodel);
+
+    // output_key=[Submodel:]Path|To|Property;...
+    std::vector<std::string> output_keys;
+    std::vector<AASClient::PropertyRequest> requests;
+    std::stringstream entries(properties_input);
+    std::string entry;
+    while (std::getline(entries, entry, ';'))
+    {
+        entry = trim(entry);
+        if (entry.empty())
         {
-            // Plain string value
-            out_value = BT::Any(property_value.get<std::string>());
+            continue;
         }
-        else
+
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos)
         {
-            // Complex structure or array without valueType - output as JSON string
-            out_value = BT::Any(property_value.dump());
+            throw BT::RuntimeError("RetrieveAASProperties: entry without output key: ", entry);
         }
+        std::string output_key = trim(entry.substr(0, equals));
+        std::string property_input = trim(entry.substr(equals + 1));
 
-        if (out_value.empty())
+        std::string submodel_id_short = default_submodel;
+        size_t colon = property_input.find(':');
+        if (colon != std::string::npos)
         {
-            std::cerr << "Property value is empty" << std::endl;
-            return BT::NodeStatus::FAILURE;
+            submodel_id_short = trim(property_input.substr(0, colon));
+            property_input = trim(property_input.substr(colon + 1));
+        }
+        if (output_key.empty() || submodel_id_short.empty() || property_input.empty())
+        {
+            throw BT::RuntimeError("RetrieveAASProperties: incomplete entry: ", entry);
         }
 
-        // Handle type conversion if the destination already exists with a specific type
-        if (dst_entry && dst_entry->info.type() != typeid(std::string) && out_value.isString())
+        output_keys.push_back(output_key);
+        requests.push_back({submodel_id_short, splitPath(property_input)});
+    }
+
+    if (requests.empty())
+    {
+        BT_LOG_ERROR << "RetrieveAASProperties: no properties requested";
+        return BT::NodeStatus::FAILURE;
+    }
+
+    try
+    {
+        BT_LOG_INFO << "Retrieving " << requests.size() << " properties of asset '" << asset_name << "'";
+
+        // Use asset name directly (already resolved from blackboard by BehaviorTree.CPP)
+        auto values = aas_client_.fetchPropertyValues(asset_name, requests);
+
+        // Write everything that resolved, but only succeed if all of it did
+        bool all_written = true;
+        for (size_t i = 0; i < requests.size(); ++i)
         {
-            try
+            if (!values[i].has_value())
             {
-                out_value = dst_entry->info.parseString(out_value.cast<std::string>());
-            }
-            catch (const std::exception &e)
-            {
-                throw BT::LogicError("Can't convert string [", out_value.cast<std::string>(),
-                                     "] to type [", BT::demangle(dst_entry->info.type()),
-                                     "]: ", e.what());
+                BT_LOG_ERROR << "Failed to retrieve property for blackboard key '" << output_keys[i] << "'";
+                all_written = false;
+                continue;
             }
+            all_written = writePropertyValue(*config().blackboard, output_keys[i], values[i].value()) && all_written;
         }
 
-        // Write the value to the blackboard
-        config().blackboard->set(output_key, out_value);
-
-        std::cout << "Successfully wrote property value to blackboard key '" << output_key << "'" << std::endl;
-
-        return BT::NodeStatus::SUCCESS;
+        return all_written ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception in RetrieveAASPropertyNode: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception in RetrieveAASPropertiesNode: " << e.what();
         return BT::NodeStatus::FAILURE;
     }
 }
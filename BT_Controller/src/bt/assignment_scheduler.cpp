@@ -0,0 +1,171 @@
+#include "bt/assignment_scheduler.h"
+#include "bt/sim_clock.h"
+#include "utils.h"
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+    // Weight of a new sample in the smoothed travel time, as for service times
+    constexpr double kTravelTimeSmoothing = 0.2;
+}
+
+AssignmentScheduler &AssignmentScheduler::instance()
+{
+    static AssignmentScheduler scheduler;
+    return scheduler;
+}
+
+void AssignmentScheduler::configure(const bt_utils::SchedulerConfig &config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    default_policy_ = config.occupy_policy;
+}
+
+std::string AssignmentScheduler::defaultPolicy() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return default_policy_;
+}
+
+void AssignmentScheduler::updateCapabilities(size_t execution,
+                                             const std::map<std::string, std::vector<std::string>> &capability_resources)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto first = capabilities_.lower_bound({execution, std::string()});
+    auto last = first;
+    while (last != capabilities_.end() && last->first.first == execution)
+    {
+        ++last;
+    }
+    capabilities_.erase(first, last);
+    for (const auto &[capability, resources] : capability_resources)
+    {
+        capabilities_[{execution, capability}] = resources;
+    }
+}
+
+std::vector<std::string> AssignmentScheduler::resourcesFor(size_t execution, const std::string &capability) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = capabilities_.find({execution, capability});
+    if (it == capabilities_.end())
+    {
+        return {};
+    }
+    return it->second;
+}
+
+size_t AssignmentScheduler::unreportedAssignments(const std::string &asset_id, const std::optional<StationLoad> &load)
+{
+    auto it = assignments_.find(asset_id);
+    if (it == assignments_.end())
+    {
+        return 0;
+    }
+
+    // A State message after the request already counts it in QueueDepth
+    if (load.has_value() && !load->state.empty())
+    {
+        auto reported = load->updated;
+        auto &pending = it->second;
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [reported](const Assignment &assignment)
+                                     { return assignment.assigned < reported; }),
+                      pending.end());
+    }
+    return it->second.size();
+}
+
+std::vector<std::string> AssignmentScheduler::rank(const std::vector<std::string> &candidates,
+                                                   StationLoadTracker &tracker)
+{
+    std::vector<std::optional<StationLoad>> loads;
+    loads.reserve(candidates.size());
+    for (const auto &asset_id : candidates)
+    {
+        loads.push_back(tracker.get(asset_id));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Candidates not observed yet are assumed as fast, and as far away, as the average known one
+    double known_service_ms = 0.0, known_travel_ms = 0.0;
+    size_t service_count = 0, travel_count = 0;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (loads[i].has_value() && loads[i]->service_samples > 0)
+        {
+            known_service_ms += loads[i]->mean_service_ms;
+            service_count++;
+        }
+        auto travel = travel_times_.find(candidates[i]);
+        if (travel != travel_times_.end())
+        {
+            known_travel_ms += travel->second.mean_ms;
+            travel_count++;
+        }
+    }
+    double default_service_ms = service_count > 0 ? known_service_ms / service_count : 1.0;
+    double default_travel_ms = travel_count > 0 ? known_travel_ms / travel_count : 0.0;
+
+    std::vector<std::tuple<bool, double, size_t>> keyed;
+    keyed.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        const auto &load = loads[i];
+        size_t queued = (load.has_value() ? load->queue_depth : 0) + unreportedAssignments(candidates[i], load);
+        double service_ms = (load.has_value() && load->service_samples > 0) ? load->mean_service_ms
+                                                                            : default_service_ms;
+        auto travel = travel_times_.find(candidates[i]);
+        double travel_ms = travel != travel_times_.end() ? travel->second.mean_ms : default_travel_ms;
+
+        // The shuttle travels while the queue ahead drains; the longer of both comes first
+        double expected_ms = std::max(travel_ms, queued * service_ms) + service_ms;
+        keyed.emplace_back(!OccupySelectionPolicy::acceptsWork(load), expected_ms, i);
+    }
+    std::stable_sort(keyed.begin(), keyed.end());
+
+    std::vector<std::string> ranked;
+    ranked.reserve(keyed.size());
+    for (const auto &[_, __, index] : keyed)
+    {
+        ranked.push_back(candidates[index]);
+    }
+    return ranked;
+}
+
+uint64_t AssignmentScheduler::assign(const std::string &asset_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t ticket = next_ticket_++;
+    assignments_[asset_id].push_back({ticket, SimClock::now()});
+    return ticket;
+}
+
+void AssignmentScheduler::withdraw(const std::string &asset_id, uint64_t ticket)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = assignments_.find(asset_id);
+    if (it == assignments_.end())
+    {
+        return;
+    }
+    auto &pending = it->second;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [ticket](const Assignment &assignment)
+                                 { return assignment.ticket == ticket; }),
+                  pending.end());
+}
+
+void AssignmentScheduler::recordTravelTime(const std::string &station_id, std::chrono::steady_clock::duration travel_time)
+{
+    double sample_ms = std::chrono::duration<double, std::milli>(travel_time).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    TravelTime &travel = travel_times_[station_id];
+    travel.mean_ms = travel.samples == 0
+                         ? sample_ms
+                         : travel.mean_ms + kTravelTimeSmoothing * (sample_ms - travel.mean_ms);
+    travel.samples++;
+}
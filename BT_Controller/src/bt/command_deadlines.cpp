@@ -0,0 +1,204 @@
+#include "bt/command_deadlines.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::atomic<CommandDeadlines *> CommandDeadline::wheel_{nullptr};
+std::atomic<uint64_t> CommandDeadline::next_generation_{1};
+
+CommandDeadlines::CommandDeadlines(const bt_utils::CommandDeadlineConfig &config)
+    : config_(config),
+      resolution_(std::chrono::milliseconds(std::max(config.resolution_ms, 1))),
+      origin_(Clock::now())
+{
+}
+
+uint64_t CommandDeadlines::schedule(std::chrono::milliseconds timeout, Callback on_expire)
+{
+    // Round up: a deadline never expires before its timeout
+    auto due = Clock::now() + timeout - origin_;
+    uint64_t expires_step = static_cast<uint64_t>((due + resolution_ - Clock::duration(1)) / resolution_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    expires_step = std::max(expires_step, current_step_ + 1);
+    uint64_t id = next_id_++;
+    entries_.emplace(id, Entry{expires_step, std::move(on_expire)});
+    place(id, expires_step);
+    return id;
+}
+
+bool CommandDeadlines::cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.erase(id) > 0;
+}
+
+void CommandDeadlines::place(uint64_t id, uint64_t expires_step)
+{
+    uint64_t delta = expires_step > current_step_ ? expires_step - current_step_ : 0;
+    unsigned level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t{1} << (kLevelBits * (level + 1))))
+    {
+        ++level;
+    }
+
+    uint64_t horizon = uint64_t{1} << (kLevelBits * kLevels);
+    if (delta >= horizon)
+    {
+        expires_step = current_step_ + horizon - 1;
+        entries_[id].expires_step = expires_step;
+    }
+    slots_[level][(expires_step >> (kLevelBits * level)) & (kSlots - 1)].push_back(id);
+}
+
+void CommandDeadlines::cascade(unsigned level)
+{
+    std::vector<uint64_t> ids;
+    ids.swap(slots_[level][(current_step_ >> (kLevelBits * level)) & (kSlots - 1)]);
+    for (uint64_t id : ids)
+    {
+        auto it = entries_.find(id);
+        if (it != entries_.end())
+        {
+            place(id, it->second.expires_step);
+        }
+    }
+}
+
+size_t CommandDeadlines::advance(Clock::time_point now)
+{
+    uint64_t target = now > origin_ ? static_cast<uint64_t>((now - origin_) / resolution_) : 0;
+
+    std::vector<std::pair<uint64_t, Callback>> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (current_step_ < target)
+        {
+            if (entries_.empty())
+            {
+                // Nothing to cascade or expire; slots only hold cancelled ids
+                for (auto &level : slots_)
+                {
+                    for (auto &slot : level)
+                    {
+                        slot.clear();
+                    }
+                }
+                current_step_ = target;
+                break;
+            }
+
+            ++current_step_;
+            // Coarser levels first: a level-2 slot may refill the level-1 slot due this step
+            for (unsigned level = kLevels - 1; level > 0; --level)
+            {
+                if ((current_step_ & ((uint64_t{1} << (kLevelBits * level)) - 1)) == 0)
+                {
+                    cascade(level);
+                }
+            }
+
+            std::vector<uint64_t> ids;
+            ids.swap(slots_[0][current_step_ & (kSlots - 1)]);
+            for (uint64_t id : ids)
+            {
+                auto it = entries_.find(id);
+                if (it == entries_.end())
+                {
+                    continue;
+                }
+                due.emplace_back(id, std::move(it->second.on_expire));
+                entries_.erase(it);
+            }
+        }
+    }
+
+    for (auto &[id, on_expire] : due)
+    {
+        on_expire(id);
+    }
+    return due.size();
+}
+
+std::chrono::milliseconds CommandDeadlines::untilNext(std::chrono::milliseconds cap) const
+{
+    uint64_t steps = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.empty())
+        {
+            return cap;
+        }
+
+        steps = kSlots - (current_step_ & (kSlots - 1)); // Next level-1 cascade
+        for (uint64_t offset = 1; offset < steps; ++offset)
+        {
+            if (!slots_[0][(current_step_ + offset) & (kSlots - 1)].empty())
+            {
+                steps = offset;
+                break;
+            }
+        }
+        steps += current_step_;
+    }
+
+    auto wait = origin_ + resolution_ * steps - Clock::now();
+    if (wait <= Clock::duration::zero())
+    {
+        return std::chrono::milliseconds(0);
+    }
+    return std::min(cap, std::chrono::ceil<std::chrono::milliseconds>(wait));
+}
+
+size_t CommandDeadlines::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void CommandDeadline::install(CommandDeadlines *wheel)
+{
+    wheel_.store(wheel, std::memory_order_release);
+}
+
+std::chrono::milliseconds CommandDeadline::backoff(std::chrono::milliseconds base, int attempt, double factor)
+{
+    double scaled = static_cast<double>(base.count()) * std::pow(std::max(factor, 1.0), attempt);
+    return std::chrono::milliseconds(static_cast<int64_t>(std::min(scaled, 86400000.0)));
+}
+
+void CommandDeadline::arm(std::chrono::milliseconds timeout, std::function<void()> on_expire)
+{
+    cancel();
+    CommandDeadlines *wheel = installed();
+    if (!wheel || timeout.count() <= 0)
+    {
+        return;
+    }
+
+    uint64_t generation = next_generation_.fetch_add(1, std::memory_order_relaxed);
+    generation_.store(generation, std::memory_order_release);
+    wheel_id_ = wheel->schedule(timeout,
+                                [this, generation, on_expire = std::move(on_expire)](uint64_t)
+                                {
+                                    // Replaced or cancelled after the wheel collected it
+                                    uint64_t expected = generation;
+                                    if (generation_.compare_exchange_strong(expected, 0, std::memory_order_acq_rel))
+                                    {
+                                        on_expire();
+                                    }
+                                });
+}
+
+void CommandDeadline::cancel()
+{
+    generation_.store(0, std::memory_order_release);
+    if (wheel_id_ != 0)
+    {
+        if (CommandDeadlines *wheel = installed())
+        {
+            wheel->cancel(wheel_id_);
+        }
+        wheel_id_ = 0;
+    }
+}
@@ -0,0 +1,164 @@
+#include "bt/conditions/compiled_condition.h"
+#include <cmath>
+
+namespace
+{
+    // Same acceptance as std::stod on the raw string
+    std::optional<double> parseNumber(const std::string &text)
+    {
+        try
+        {
+            return std::stod(text);
+        }
+        catch (...)
+        {
+            return std::nullopt;
+        }
+    }
+
+    // "a/b" -> "/a~1b": a plain field name is one pointer token
+    std::string escapeToken(const std::string &field)
+    {
+        std::string token;
+        for (char c : field)
+        {
+            if (c == '~')
+                token += "~0";
+            else if (c == '/')
+                token += "~1";
+            else
+                token += c;
+        }
+        return "/" + token;
+    }
+}
+
+std::optional<CompiledCondition> CompiledCondition::compile(const std::string &field,
+                                                            const std::string &comparison_type,
+                                                            const std::string &expected_value)
+{
+    CompiledCondition condition;
+    try
+    {
+        condition.path_ = nlohmann::json::json_pointer(!field.empty() && field[0] == '/' ? field : escapeToken(field));
+    }
+    catch (const nlohmann::json::exception &)
+    {
+        return std::nullopt;
+    }
+
+    nlohmann::json::json_pointer top = condition.path_;
+    while (!top.empty() && !top.parent_pointer().empty())
+    {
+        top = top.parent_pointer();
+    }
+    condition.top_level_field_ = top.empty() ? std::string() : top.back();
+
+    condition.field_ = field;
+    condition.comparison_type_ = comparison_type;
+    condition.expected_text_ = expected_value;
+    condition.expected_number_ = parseNumber(expected_value);
+
+    if (comparison_type == "equal" || comparison_type == "not_equal")
+    {
+        condition.op_ = Op::Equal;
+        condition.negate_ = comparison_type == "not_equal";
+        condition.operational_ = expected_value == "operational" && !condition.path_.empty() &&
+                                 condition.path_.back() == "State";
+    }
+    else if (comparison_type == "greater")
+    {
+        condition.op_ = Op::Greater;
+    }
+    else if (comparison_type == "less")
+    {
+        condition.op_ = Op::Less;
+    }
+    else if (comparison_type == "contains")
+    {
+        condition.op_ = Op::Contains;
+    }
+    else if (comparison_type == "inside" || comparison_type == "outside")
+    {
+        condition.op_ = Op::Inside;
+        condition.negate_ = comparison_type == "outside";
+        size_t delimiter_pos = expected_value.find(';');
+        if (delimiter_pos != std::string::npos)
+        {
+            condition.range_min_ = parseNumber(expected_value.substr(0, delimiter_pos));
+            condition.range_max_ = parseNumber(expected_value.substr(delimiter_pos + 1));
+        }
+    }
+    return condition;
+}
+
+bool CompiledCondition::evaluateEqual(const nlohmann::json &actual) const
+{
+    if (actual.is_string())
+    {
+        const auto &text = actual.get_ref<const std::string &>();
+        if (operational_)
+        {
+            return text == "IDLE" || text == "STARTING" || text == "EXECUTE" ||
+                   text == "COMPLETING" || text == "COMPLETE" || text == "RESETTING";
+        }
+        return text == expected_text_;
+    }
+    if (actual.is_number())
+    {
+        return expected_number_ && std::abs(actual.get<double>() - *expected_number_) < 1e-6;
+    }
+    if (actual.is_boolean())
+    {
+        return (expected_text_ == "true" && actual.get<bool>()) ||
+               (expected_text_ == "false" && !actual.get<bool>());
+    }
+    // For complex types, compare string representations
+    return actual.dump() == expected_text_;
+}
+
+bool CompiledCondition::evaluate(const nlohmann::json &actual) const
+{
+    switch (op_)
+    {
+    case Op::Equal:
+        return evaluateEqual(actual) != negate_;
+    case Op::Greater:
+    case Op::Less:
+        if (actual.is_number())
+        {
+            if (!expected_number_)
+            {
+                return false;
+            }
+            return op_ == Op::Greater ? actual.get<double>() > *expected_number_
+                                      : actual.get<double>() < *expected_number_;
+        }
+        if (actual.is_string())
+        {
+            const auto &text = actual.get_ref<const std::string &>();
+            return op_ == Op::Greater ? text > expected_text_ : text < expected_text_;
+        }
+        return false;
+    case Op::Contains:
+        if (actual.is_string())
+        {
+            return actual.get_ref<const std::string &>().find(expected_text_) != std::string::npos;
+        }
+        return actual.dump().find(expected_text_) != std::string::npos;
+    case Op::Inside:
+    {
+        // A malformed range or a non-numeric value fails both inside and outside
+        if (!actual.is_number() || !range_min_ || !range_max_)
+        {
+            return false;
+        }
+        double value = actual.get<double>();
+        bool is_inside = value >= *range_min_ && value <= *range_max_;
+        return is_inside != negate_;
+    }
+    case Op::Never:
+        break;
+    }
+    return false;
+}
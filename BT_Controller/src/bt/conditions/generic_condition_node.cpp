@@ -1,22 +1,9 @@
 #include "bt/conditions/generic_condition_node.h"
 #include "mqtt/node_message_distributor.h"
-#include "aas/aas_interface_cache.h"
 #include "utils.h"
+#include "logging/logger.h"
+#include "bt/sim_clock.h"
 #include <chrono>
-#include <iomanip>
-#include <thread>
-
-// Helper to get current timestamp for logging
-static std::string getLogTimestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::tm tm = *std::localtime(&time);
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return oss.str();
-}
 
 BT::PortsList GenericConditionNode::providedPorts()
 {
@@ -27,9 +14,14 @@ BT::PortsList GenericConditionNode::providedPorts()
             "{Asset}",
             "The Asset from which to receive a message"),
         BT::InputPort<std::string>("Property", "The property interface from the Asset"),
-        BT::InputPort<std::string>("Field", "Name of the field to monitor in the MQTT message"),
+        BT::InputPort<std::string>("Field", "Field to monitor in the MQTT message: a top-level name or a JSON pointer (/a/b)"),
         BT::InputPort<std::string>("comparison_type", "Type of comparison: equal, not_equal, greater, less, contains"),
-        BT::InputPort<std::string>("expected_value", "Value to compare against")};
+        BT::InputPort<std::string>("expected_value", "Value to compare against"),
+        BT::InputPort<BT::NodeStatus>("if_no_message", BT::NodeStatus::RUNNING,
+                                      "Status to return until the first message arrives: "
+                                      "RUNNING, FAILURE, SUCCESS"),
+        BT::InputPort<int>("first_message_timeout_ms", 5000,
+                           "FAILURE once no message arrived this long after initialization; 0 waits forever")};
 }
 
 void GenericConditionNode::initializeTopicsFromAAS()
@@ -39,8 +31,8 @@ void GenericConditionNode::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "[DataCondition] Node '" << this->name() 
+                         << "' has no Asset input configured";
             return;
         }
 
@@ -49,8 +41,8 @@ void GenericConditionNode::initializeTopicsFromAAS()
         auto property_name = getInput<std::string>("Property");
         if (!property_name.has_value())
         {
-            std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' has no Property input configured" << std::endl;
+            BT_LOG_ERROR << "[DataCondition] Node '" << this->name() 
+                         << "' has no Property input configured";
             return;
         }
 
@@ -67,63 +59,64 @@ void GenericConditionNode::initializeTopicsFromAAS()
         if (topics_initialized_ &&
             (asset_id != initialized_asset_id_ || property_name.value() != initialized_property_))
         {
-            std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' reinitializing: asset/property changed from "
-                      << initialized_asset_id_ << "/" << initialized_property_ << " to "
-                      << asset_id << "/" << property_name.value() << std::endl;
+            BT_LOG_INFO << "[DataCondition] Node '" << this->name() 
+                        << "' reinitializing: asset/property changed from "
+                        << initialized_asset_id_ << "/" << initialized_property_ << " to "
+                        << asset_id << "/" << property_name.value();
             topics_initialized_ = false;
-            latest_msg_ = json(); // Clear old message from different asset
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                latest_msg_ = json(); // Clear old message from different asset
+                result_.store(kNoMessage, std::memory_order_release);
+            }
             tick_count_ = 0;
             first_message_received_time_.reset();
+            waiting_logged_ = false;
+            first_message_timed_out_ = false;
         }
 
-        std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' INITIALIZING for Asset: " << asset_id 
-                  << ", Property: " << property_name.value() << std::endl;
+        BT_LOG_INFO << "[DataCondition] Node '" << this->name() 
+                    << "' INITIALIZING for Asset: " << asset_id 
+                    << ", Property: " << property_name.value();
         
-        initialization_time_ = std::chrono::steady_clock::now();
+        initialization_time_ = SimClock::now();
 
-        // First, try to use the cached interface (fast path)
-        auto cache = MqttSubBase::getAASInterfaceCache();
-        if (cache)
-        {
-            auto cached_interface = cache->getInterface(asset_id, property_name.value(), "output");
-            if (cached_interface.has_value())
-            {
-                std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                          << "' using cached interface for property: " << property_name.value() 
-                          << ", topic: " << cached_interface.value().getTopic() << std::endl;
-                MqttSubBase::setTopic("output", cached_interface.value());
-                topics_initialized_ = true;
-                initialized_asset_id_ = asset_id;
-                initialized_property_ = property_name.value();
-                return;
-            }
-        }
-
-        // Fall back to direct AAS query (slow path)
-        std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' falling back to direct AAS query" << std::endl;
-        auto condition_opt = aas_client_.fetchInterface(asset_id, property_name.value(), "output");
+        // Cache first, filling the asset once on a miss
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id, {{property_name.value(), "output"}});
+        auto &condition_opt = topics[0];
 
         if (!condition_opt.has_value())
         {
-            std::cerr << "[" << getLogTimestamp() << "] [DataCondition] FAILED to fetch interface from AAS for node: " 
-                      << this->name() << std::endl;
+            BT_LOG_ERROR << "[DataCondition] FAILED to fetch interface from AAS for node: " 
+                         << this->name();
             return;
         }
 
-        std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' got topic from AAS: " << condition_opt.value().getTopic() << std::endl;
+        BT_LOG_INFO << "[DataCondition] Node '" << this->name() 
+                    << "' resolved topic: " << condition_opt.value().getTopic();
+        {
+            // Compiled before the topic is set, so every delivered message finds it
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!compileCondition())
+            {
+                BT_LOG_ERROR << "[DataCondition] Node '" << this->name()
+                             << "' has missing or invalid Field/comparison_type/expected_value ports";
+            }
+        }
         MqttSubBase::setTopic("output", condition_opt.value());
+        if (condition_)
+        {
+            // Only the monitored field is read, so it is checked even where the schema is not
+            MqttSubBase::setRequiredFields("output", {condition_->topLevelField()});
+        }
         topics_initialized_ = true;
         initialized_asset_id_ = asset_id;
         initialized_property_ = property_name.value();
     }
     catch (const std::exception &e)
     {
-        std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Exception initializing topics from AAS: " 
-                  << e.what() << std::endl;
+        BT_LOG_ERROR << "[DataCondition] Exception initializing topics from AAS: " 
+                     << e.what();
     }
 }
 
@@ -132,289 +125,196 @@ BT::NodeStatus GenericConditionNode::tick()
     tick_count_++;
     
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto asset = getInput<std::string>("Asset");
         auto property = getInput<std::string>("Property");
-        std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' tick #" << tick_count_ << " FAILED - could not initialize. "
-                  << "Asset=" << (asset.has_value() ? asset.value() : "<not set>") << ", "
-                  << "Property=" << (property.has_value() ? property.value() : "<not set>") << std::endl;
+        BT_LOG_ERROR << "[DataCondition] Node '" << this->name() 
+                     << "' tick #" << tick_count_ << " FAILED - could not initialize. "
+                     << "Asset=" << (asset.has_value() ? asset.value() : "<not set>") << ", "
+                     << "Property=" << (property.has_value() ? property.value() : "<not set>");
         return BT::NodeStatus::FAILURE;
     }
 
     // Calculate time since initialization for debugging
-    auto now = std::chrono::steady_clock::now();
+    auto now = SimClock::now();
     auto ms_since_init = std::chrono::duration_cast<std::chrono::milliseconds>(now - initialization_time_).count();
 
-    // Use a unique_lock since we may need to wait on a condition variable
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    // Check if we have received a message yet
-    if (latest_msg_.is_null())
+    if (dynamic_ports_)
     {
-        // On early ticks, wait briefly for the first message to arrive
-        // This handles the race condition between subscription and retained message delivery
-        constexpr int MAX_WAIT_TICKS = 5;
-        constexpr auto WAIT_TIMEOUT = std::chrono::milliseconds(200);
-        
-        if (tick_count_ <= MAX_WAIT_TICKS)
+        // Blackboard-bound ports: recompile only when one of them changed
+        auto field = getInput<std::string>("Field");
+        auto comparison_type = getInput<std::string>("comparison_type");
+        auto expected_value = getInput<std::string>("expected_value");
+        if (!condition_ || !field || !comparison_type || !expected_value ||
+            !condition_->compiledFrom(field.value(), comparison_type.value(), expected_value.value()))
         {
-            std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' tick #" << tick_count_ << " - no message yet, waiting up to " 
-                      << WAIT_TIMEOUT.count() << "ms for first message..." << std::endl;
-            
-            // Release lock and wait for message to arrive
-            lock.unlock();
-            
-            // Wait in small increments, checking for message
-            auto wait_start = std::chrono::steady_clock::now();
-            while (std::chrono::steady_clock::now() - wait_start < WAIT_TIMEOUT)
+            std::lock_guard<std::mutex> lock(mutex_);
+            compileCondition();
+            if (!latest_msg_.is_null())
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                
-                std::lock_guard<std::mutex> check_lock(mutex_);
-                if (!latest_msg_.is_null())
-                {
-                    auto wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        std::chrono::steady_clock::now() - wait_start).count();
-                    std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                              << "' message arrived after " << wait_ms << "ms wait" << std::endl;
-                    break;
-                }
+                storeResult(latest_msg_);
             }
-            
-            // Re-acquire lock and check again
-            lock.lock();
         }
-        
-        // If still no message after waiting
-        if (latest_msg_.is_null())
+    }
+
+    uint8_t result = result_.load(std::memory_order_acquire);
+
+    // Until the first (usually retained) message arrives the node reports if_no_message
+    // instead of blocking the tick thread; callback() wakes the tree when it comes in
+    if (result == kNoMessage)
+    {
+        int timeout_ms = getInput<int>("first_message_timeout_ms").value_or(5000);
+        if (timeout_ms > 0 && ms_since_init >= timeout_ms)
         {
-            std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' tick #" << tick_count_ << " FAILURE - no message received!"
-                      << " Time since init: " << ms_since_init << "ms"
-                      << ", Asset: " << initialized_asset_id_
-                      << ", Property: " << initialized_property_ << std::endl;
-            
-            // Log topics we're subscribed to
-            for (const auto& [key, topic] : topics_)
+            if (!first_message_timed_out_)
             {
-                std::cerr << "[" << getLogTimestamp() << "] [DataCondition]   -> Subscribed topic[" << key << "]: " 
-                          << topic.getTopic() << std::endl;
+                first_message_timed_out_ = true;
+                BT_LOG_ERROR << "[DataCondition] Node '" << this->name()
+                             << "' tick #" << tick_count_ << " FAILURE - no message received!"
+                             << " Time since init: " << ms_since_init << "ms"
+                             << ", Asset: " << initialized_asset_id_
+                             << ", Property: " << initialized_property_;
+
+                // Log topics we're subscribed to
+                for (const auto &[key, topic] : topics_)
+                {
+                    BT_LOG_ERROR << "[DataCondition]   -> Subscribed topic[" << key << "]: "
+                                 << topic.getTopic();
+                }
             }
-            
             return BT::NodeStatus::FAILURE;
         }
-    }
-    
-    BT::Expected<std::string> field_name_res = getInput<std::string>("Field");
-    BT::Expected<std::string> expected_value_res = getInput<std::string>("expected_value");
-    BT::Expected<std::string> comparison_type_res = getInput<std::string>("comparison_type");
 
-    if (field_name_res.has_value() && expected_value_res.has_value() && comparison_type_res.has_value())
-    {
-        bool result = compare(latest_msg_, field_name_res.value(), comparison_type_res.value(), expected_value_res.value());
-        
-        // Log comparison details on first few ticks or when result changes
-        if (tick_count_ <= 3 || result != last_comparison_result_)
-        {
-            std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' tick #" << tick_count_ << ": comparing " << field_name_res.value()
-                      << " (" << comparison_type_res.value() << ") '" << expected_value_res.value() << "'"
-                      << " -> actual: " << (latest_msg_.contains(field_name_res.value()) ? 
-                                            latest_msg_[field_name_res.value()].dump() : "<missing>")
-                      << " -> result: " << (result ? "SUCCESS" : "FAILURE")
-                      << ", ms_since_init: " << ms_since_init << std::endl;
-            last_comparison_result_ = result;
-        }
-        
-        if (result)
+        if (!waiting_logged_)
         {
-            return BT::NodeStatus::SUCCESS;
+            waiting_logged_ = true;
+            BT_LOG_INFO << "[DataCondition] Node '" << this->name()
+                        << "' tick #" << tick_count_ << " - no message yet, waiting for the first one";
         }
+        return getInput<BT::NodeStatus>("if_no_message").value_or(BT::NodeStatus::RUNNING);
     }
-    else
+
+    if (result == kInvalid)
     {
-        std::cerr << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' tick #" << tick_count_ << " FAILURE - missing input ports: "
-                  << "Field=" << (field_name_res.has_value() ? field_name_res.value() : "<not set>")
-                  << ", expected_value=" << (expected_value_res.has_value() ? expected_value_res.value() : "<not set>")
-                  << ", comparison_type=" << (comparison_type_res.has_value() ? comparison_type_res.value() : "<not set>")
-                  << std::endl;
+        BT::Expected<std::string> field_name_res = getInput<std::string>("Field");
+        BT::Expected<std::string> expected_value_res = getInput<std::string>("expected_value");
+        BT::Expected<std::string> comparison_type_res = getInput<std::string>("comparison_type");
+        BT_LOG_ERROR << "[DataCondition] Node '" << this->name()
+                     << "' tick #" << tick_count_ << " FAILURE - missing or invalid input ports: "
+                     << "Field=" << (field_name_res.has_value() ? field_name_res.value() : "<not set>")
+                     << ", expected_value=" << (expected_value_res.has_value() ? expected_value_res.value() : "<not set>")
+                     << ", comparison_type=" << (comparison_type_res.has_value() ? comparison_type_res.value() : "<not set>");
+        return BT::NodeStatus::FAILURE;
+    }
+
+    bool matched = result == kTrue;
+
+    // Log comparison details on first few ticks or when result changes; the actual value
+    // is logged by the callback
+    if (tick_count_ <= 3 || matched != last_comparison_result_)
+    {
+        BT_LOG_INFO << "[DataCondition] Node '" << this->name()
+                    << "' tick #" << tick_count_ << ": comparing " << condition_->describe()
+                    << " -> result: " << (matched ? "SUCCESS" : "FAILURE")
+                    << ", ms_since_init: " << ms_since_init;
+        last_comparison_result_ = matched;
     }
-    return BT::NodeStatus::FAILURE;
+    return matched ? BT::NodeStatus::SUCCESS : BT::NodeStatus::FAILURE;
 }
 
-void GenericConditionNode::callback(const std::string &topic_key, const json &msg, mqtt::properties props)
+bool GenericConditionNode::compileCondition()
 {
-    BT::Expected<std::string> field_name_res = getInput<std::string>("Field");
-    if (field_name_res && msg.contains(field_name_res.value()))
+    auto is_dynamic = [this](const char *port)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        bool is_first_message = latest_msg_.is_null();
-        latest_msg_ = msg;
-        
-        if (is_first_message)
-        {
-            first_message_received_time_ = std::chrono::steady_clock::now();
-            auto ms_since_init = std::chrono::duration_cast<std::chrono::milliseconds>(
-                first_message_received_time_.value() - initialization_time_).count();
-            
-            std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                      << "' FIRST MESSAGE RECEIVED on topic_key='" << topic_key << "'"
-                      << ", " << ms_since_init << "ms after init"
-                      << ", tick_count at receipt: " << tick_count_
-                      << ", Field=" << field_name_res.value()
-                      << ", Value=" << msg[field_name_res.value()].dump() << std::endl;
-        }
+        auto it = config().input_ports.find(port);
+        return it != config().input_ports.end() && BT::TreeNode::isBlackboardPointer(it->second);
+    };
+    dynamic_ports_ = is_dynamic("Field") || is_dynamic("comparison_type") || is_dynamic("expected_value");
+
+    condition_.reset();
+    auto field = getInput<std::string>("Field");
+    auto comparison_type = getInput<std::string>("comparison_type");
+    auto expected_value = getInput<std::string>("expected_value");
+    if (!field || !comparison_type || !expected_value)
+    {
+        return false;
     }
-    else
+    if (auto compiled = CompiledCondition::compile(field.value(), comparison_type.value(), expected_value.value()))
     {
-        std::cout << "[" << getLogTimestamp() << "] [DataCondition] Node '" << this->name() 
-                  << "' received message on topic_key='" << topic_key << "' but field '"
-                  << (field_name_res.has_value() ? field_name_res.value() : "<not set>")
-                  << "' not found in message. Keys: ";
-        for (auto it = msg.begin(); it != msg.end(); ++it)
-        {
-            std::cout << it.key() << " ";
-        }
-        std::cout << std::endl;
+        condition_ = std::make_shared<const CompiledCondition>(std::move(*compiled));
+        return true;
     }
+    return false;
 }
 
-bool GenericConditionNode::compare(const json &msg, const std::string &field_name, const std::string &comparison_type,
-                                   const std::string &expected_str)
+void GenericConditionNode::storeResult(const json &msg)
 {
-    bool result = false;
-
-    json actual_value = msg[field_name];
-
-    // Handle different comparison types
-    if (comparison_type == "equal" || comparison_type == "not_equal")
+    if (!condition_)
     {
-        // Handle different JSON types appropriately
-        if (actual_value.is_string())
-        {
-            if (expected_str == "operational" && field_name == "State")
-            {
-                std::string state = actual_value.get<std::string>();
-                result = (state == "IDLE" ||
-                          state == "STARTING" ||
-                          state == "EXECUTE" ||
-                          state == "COMPLETING" ||
-                          state == "COMPLETE" ||
-                          state == "RESETTING");
-            }
-            else
-            {
-                result = (actual_value.get<std::string>() == expected_str);
-            }
-        }
-        else if (actual_value.is_number())
-        {
-            try
-            {
-                double expected_num = std::stod(expected_str);
-                result = (std::abs(actual_value.get<double>() - expected_num) < 1e-6);
-            }
-            catch (...)
-            {
-                result = false;
-            }
-        }
-        else if (actual_value.is_boolean())
-        {
-            result = ((expected_str == "true" && actual_value.get<bool>()) ||
-                      (expected_str == "false" && !actual_value.get<bool>()));
-        }
-        else
-        {
-            // For complex types, compare string representations
-            result = (actual_value.dump() == expected_str);
-        }
-
-        // Invert the result if comparison_type is "not_equal"
-        if (comparison_type == "not_equal")
-        {
-            result = !result;
-        }
+        result_.store(kInvalid, std::memory_order_release);
+        return;
     }
-    else if (comparison_type == "greater" || comparison_type == "less")
+    const auto &path = condition_->path();
+    bool matched = msg.contains(path) && condition_->evaluate(msg.at(path));
+    result_.store(matched ? kTrue : kFalse, std::memory_order_release);
+}
+
+void GenericConditionNode::callback(const std::string &topic_key, const json &msg, mqtt::properties props)
+{
+    bool stored = false;
+    std::shared_ptr<const CompiledCondition> condition;
     {
-        if (actual_value.is_number())
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition = condition_;
+        if (!condition_ || msg.contains(condition_->path()))
         {
-            try
+            bool is_first_message = result_.load(std::memory_order_relaxed) == kNoMessage;
+            if (dynamic_ports_)
             {
-                double expected_num = std::stod(expected_str);
-                // Use greater-than by default, switch to less-than if needed
-                if (comparison_type == "greater")
-                {
-                    result = (actual_value.get<double>() > expected_num);
-                }
-                else
-                { // "less"
-                    result = (actual_value.get<double>() < expected_num);
-                }
+                latest_msg_ = msg;
             }
-            catch (...)
-            {
-                result = false;
-            }
-        }
-        else if (actual_value.is_string())
-        {
-            // Use greater-than by default, switch to less-than if needed
-            if (comparison_type == "greater")
+            storeResult(msg);
+            stored = true;
+
+            if (is_first_message && condition_)
             {
-                result = (actual_value.get<std::string>() > expected_str);
-            }
-            else
-            { // "less"
-                result = (actual_value.get<std::string>() < expected_str);
+                first_message_received_time_ = SimClock::now();
+                auto ms_since_init = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    first_message_received_time_.value() - initialization_time_).count();
+
+                BT_LOG_INFO << "[DataCondition] Node '" << this->name()
+                            << "' FIRST MESSAGE RECEIVED on topic_key='" << topic_key << "'"
+                            << ", " << ms_since_init << "ms after init"
+                            << ", tick_count at receipt: " << tick_count_
+                            << ", " << condition_->describe()
+                            << ", Value=" << msg.at(condition_->path()).dump();
             }
         }
     }
-    else if (comparison_type == "contains")
+    if (stored)
     {
-        if (actual_value.is_string())
-        {
-            result = (actual_value.get<std::string>().find(expected_str) != std::string::npos);
-        }
-        else
-        {
-            std::string actual_str = actual_value.dump();
-            result = (actual_str.find(expected_str) != std::string::npos);
-        }
+        // Re-evaluate on the next tick instead of waiting out the idle interval
+        emitWakeUpSignal();
     }
-    else if (comparison_type == "inside" || comparison_type == "outside")
+    else
     {
-        // Parse the expected range values (format: "min;max")
-        size_t delimiter_pos = expected_str.find(';');
-        if (delimiter_pos != std::string::npos)
+        if (logging::enabled(logging::Level::Info))
         {
-            std::string min_str = expected_str.substr(0, delimiter_pos);
-            std::string max_str = expected_str.substr(delimiter_pos + 1);
-
-            if (actual_value.is_number())
+            logging::Line line(logging::Level::Info);
+            line << "[DataCondition] Node '" << this->name()
+                 << "' received message on topic_key='" << topic_key << "' but field '"
+                 << condition->field()
+                 << "' not found in message. Keys: ";
+            for (auto it = msg.begin(); it != msg.end(); ++it)
             {
-                try
-                {
-                    double min_val = std::stod(min_str);
-                    double max_val = std::stod(max_str);
-                    double actual_num = actual_value.get<double>();
-
-                    // Check if the value is inside or outside the range
-                    bool is_inside = (actual_num >= min_val && actual_num <= max_val);
-                    result = (comparison_type == "inside") ? is_inside : !is_inside;
-                }
-                catch (...)
-                {
-                    std::cerr << "Error parsing number for inside/outside comparison" << std::endl;
-                }
+                line << it.key() << " ";
             }
         }
     }
-    return result;
 }
\ No newline at end of file
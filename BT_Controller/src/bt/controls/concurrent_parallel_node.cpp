@@ -0,0 +1,262 @@
+#include "bt/controls/concurrent_parallel_node.h"
+#include "bt/tick_pool.h"
+#include "logging/logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <optional>
+#include <string>
+#include <typeindex>
+
+namespace BT
+{
+    ConcurrentParallelNode::ConcurrentParallelNode(const std::string &name, const NodeConfig &config)
+        : ControlNode::ControlNode(name, config)
+    {
+    }
+
+    PortsList ConcurrentParallelNode::providedPorts()
+    {
+        return {InputPort<int>("success_count", -1,
+                               "number of children that need to succeed to trigger a SUCCESS"),
+                InputPort<int>("failure_count", 1,
+                               "number of children that need to fail to trigger a FAILURE")};
+    }
+
+    size_t ConcurrentParallelNode::successThreshold() const
+    {
+        return success_threshold_ < 0
+                   ? static_cast<size_t>(std::max(int(children_nodes_.size()) + success_threshold_ + 1, 0))
+                   : static_cast<size_t>(success_threshold_);
+    }
+
+    size_t ConcurrentParallelNode::failureThreshold() const
+    {
+        return failure_threshold_ < 0
+                   ? static_cast<size_t>(std::max(int(children_nodes_.size()) + failure_threshold_ + 1, 0))
+                   : static_cast<size_t>(failure_threshold_);
+    }
+
+    void ConcurrentParallelNode::partitionChildren()
+    {
+        // Blackboard entry -> children writing it; entries are shared through subtree remapping,
+        // so the entry (not the key name) identifies what two branches have in common
+        std::map<const void *, std::set<size_t>> writers;
+        std::map<std::string, std::set<size_t>> unresolved_writers;
+
+        for (size_t i = 0; i < children_nodes_.size(); ++i)
+        {
+            applyRecursiveVisitor(children_nodes_[i],
+                                  [&writers, &unresolved_writers, i](TreeNode *node)
+                                  {
+                                      const NodeConfig &node_config = node->config();
+                                      for (const auto &[port, remapped] : node_config.output_ports)
+                                      {
+                                          StringView stripped;
+                                          if (!TreeNode::isBlackboardPointer(remapped, &stripped))
+                                          {
+                                              continue;
+                                          }
+
+                                          // Product queues are safe to draw from concurrently
+                                          if (node_config.manifest)
+                                          {
+                                              auto info = node_config.manifest->ports.find(port);
+                                              if (info != node_config.manifest->ports.end() &&
+                                                  info->second.type() == std::type_index(typeid(ProductQueuePtr)))
+                                              {
+                                                  continue;
+                                              }
+                                          }
+
+                                          std::string key = stripped == "=" ? port : std::string(stripped);
+                                          auto entry = node_config.blackboard ? node_config.blackboard->getEntry(key) : nullptr;
+                                          if (entry)
+                                          {
+                                              writers[entry.get()].insert(i);
+                                          }
+                                          else
+                                          {
+                                              unresolved_writers[key].insert(i);
+                                          }
+                                      }
+                                  });
+        }
+
+        std::set<size_t> conflicting;
+        for (const auto &[entry, children] : writers)
+        {
+            if (children.size() > 1)
+            {
+                conflicting.insert(children.begin(), children.end());
+            }
+        }
+        for (const auto &[key, children] : unresolved_writers)
+        {
+            if (children.size() > 1)
+            {
+                conflicting.insert(children.begin(), children.end());
+            }
+        }
+
+        concurrent_children_.clear();
+        sequential_children_.clear();
+        for (size_t i = 0; i < children_nodes_.size(); ++i)
+        {
+            (conflicting.count(i) ? sequential_children_ : concurrent_children_).push_back(i);
+        }
+        partitioned_ = true;
+
+        if (!sequential_children_.empty())
+        {
+            BT_LOG_INFO << "[" << name() << "]: " << sequential_children_.size() << " of " << children_nodes_.size()
+                        << " children share blackboard writes and are ticked sequentially";
+        }
+    }
+
+    NodeStatus ConcurrentParallelNode::tick()
+    {
+        int threshold = 0;
+        if (getInput("success_count", threshold))
+        {
+            success_threshold_ = threshold;
+        }
+        if (getInput("failure_count", threshold))
+        {
+            failure_threshold_ = threshold;
+        }
+
+        const size_t children_count = children_nodes_.size();
+
+        if (children_count < successThreshold())
+        {
+            throw LogicError("Number of children is less than threshold. Can never succeed.");
+        }
+
+        if (children_count < failureThreshold())
+        {
+            throw LogicError("Number of children is less than threshold. Can never fail.");
+        }
+
+        if (!partitioned_)
+        {
+            partitionChildren();
+        }
+
+        setStatus(NodeStatus::RUNNING);
+
+        size_t skipped_count = 0;
+
+        // Fold one child's result in; returns the node result once it is decided
+        auto record = [&](size_t index, NodeStatus child_status) -> std::optional<NodeStatus>
+        {
+            switch (child_status)
+            {
+            case NodeStatus::SKIPPED:
+                skipped_count++;
+                break;
+            case NodeStatus::SUCCESS:
+                completed_list_.insert(index);
+                success_count_++;
+                break;
+            case NodeStatus::FAILURE:
+                completed_list_.insert(index);
+                failure_count_++;
+                break;
+            case NodeStatus::RUNNING:
+                break;
+            case NodeStatus::IDLE:
+                throw LogicError("[", name(), "]: A children should not return IDLE");
+            }
+
+            const size_t required_success_count = successThreshold();
+            if (success_count_ >= required_success_count ||
+                (success_threshold_ < 0 && (success_count_ + skipped_count) >= required_success_count))
+            {
+                clear();
+                resetChildren();
+                return NodeStatus::SUCCESS;
+            }
+
+            // It fails if it is not possible to succeed anymore or if number of failures are equal to failure_theshold_
+            if (((children_count - failure_count_) < required_success_count) ||
+                (failure_count_ == failureThreshold()))
+            {
+                clear();
+                resetChildren();
+                return NodeStatus::FAILURE;
+            }
+            return std::nullopt;
+        };
+
+        std::vector<size_t> pending;
+        for (size_t index : concurrent_children_)
+        {
+            if (completed_list_.count(index) == 0)
+            {
+                pending.push_back(index);
+            }
+        }
+
+        // Exceptions are carried back so they surface on the ticking thread as with Parallel
+        std::vector<NodeStatus> results(pending.size(), NodeStatus::IDLE);
+        std::vector<std::exception_ptr> errors(pending.size());
+        TickPool::instance().run(pending.size(),
+                                 [this, &pending, &results, &errors](size_t k)
+                                 {
+                                     try
+                                     {
+                                         results[k] = children_nodes_[pending[k]]->executeTick();
+                                     }
+                                     catch (...)
+                                     {
+                                         errors[k] = std::current_exception();
+                                     }
+                                 });
+
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        for (size_t k = 0; k < pending.size(); ++k)
+        {
+            if (auto decided = record(pending[k], results[k]))
+            {
+                return *decided;
+            }
+        }
+
+        for (size_t index : sequential_children_)
+        {
+            if (completed_list_.count(index) == 0)
+            {
+                if (auto decided = record(index, children_nodes_[index]->executeTick()))
+                {
+                    return *decided;
+                }
+            }
+        }
+
+        // Skip if ALL the nodes have been skipped
+        return (skipped_count == children_count) ? NodeStatus::SKIPPED : NodeStatus::RUNNING;
+    }
+
+    void ConcurrentParallelNode::clear()
+    {
+        completed_list_.clear();
+        success_count_ = 0;
+        failure_count_ = 0;
+    }
+
+    void ConcurrentParallelNode::halt()
+    {
+        clear();
+        ControlNode::halt();
+    }
+
+} // namespace BT
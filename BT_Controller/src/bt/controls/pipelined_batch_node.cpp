@@ -0,0 +1,137 @@
+#include "bt/controls/pipelined_batch_node.h"
+#include "logging/logger.h"
+
+#include <behaviortree_cpp/decorators/subtree_node.h>
+#include <algorithm>
+
+namespace BT
+{
+    PipelinedBatchNode::PipelinedBatchNode(const std::string &name, const NodeConfig &config)
+        : ControlNode::ControlNode(name, config)
+    {
+    }
+
+    PortsList PipelinedBatchNode::providedPorts()
+    {
+        return {InputPort<ProductQueuePtr>("Queue", "{ProductIDs}",
+                                           "The batch the lanes take their products from"),
+                InputPort<int>("MaxInFlight", 0,
+                               "Products worked on at once, 0 = one per lane"),
+                InputPort<std::string>("ProductKey", "ProductID",
+                                       "Entry of each lane's SubTree blackboard receiving its product ID"),
+                InputPort<NodeStatus>("if_empty", NodeStatus::SUCCESS,
+                                      "Status to return if the queue held no product: SUCCESS, FAILURE, SKIPPED")};
+    }
+
+    void PipelinedBatchNode::setupLanes()
+    {
+        lanes_.assign(children_nodes_.size(), Lane{});
+        for (size_t i = 0; i < children_nodes_.size(); ++i)
+        {
+            auto *subtree = dynamic_cast<SubTreeNode *>(children_nodes_[i]);
+            if (subtree && subtree->child())
+            {
+                lanes_[i].blackboard = subtree->child()->config().blackboard;
+            }
+        }
+    }
+
+    void PipelinedBatchNode::clear()
+    {
+        lanes_.clear();
+        in_flight_ = 0;
+        completed_ = 0;
+        failed_ = false;
+    }
+
+    NodeStatus PipelinedBatchNode::tick()
+    {
+        if (status() == NodeStatus::IDLE)
+        {
+            clear();
+            setupLanes();
+            for (size_t i = 0; i < lanes_.size(); ++i)
+            {
+                if (!lanes_[i].blackboard)
+                {
+                    BT_LOG_ERROR << "[PipelinedBatch] Node '" << this->name() << "' child " << i
+                                 << " is not a SubTree, so it has no blackboard of its own";
+                    clear();
+                    return NodeStatus::FAILURE;
+                }
+            }
+        }
+
+        ProductQueuePtr queue = getInput<ProductQueuePtr>("Queue").value_or(nullptr);
+        int max_in_flight = getInput<int>("MaxInFlight").value_or(0);
+        size_t limit = max_in_flight > 0 ? std::min(static_cast<size_t>(max_in_flight), lanes_.size()) : lanes_.size();
+        std::string product_key = getInput<std::string>("ProductKey").value_or("ProductID");
+
+        setStatus(NodeStatus::RUNNING);
+
+        bool lane_freed = false;
+        for (size_t i = 0; i < lanes_.size(); ++i)
+        {
+            Lane &lane = lanes_[i];
+            if (!lane.busy)
+            {
+                std::string product_id;
+                if (failed_ || in_flight_ >= limit || !queue || !queue->pop(product_id))
+                {
+                    continue;
+                }
+                lane.blackboard->set(product_key, product_id);
+                lane.busy = true;
+                ++in_flight_;
+                BT_LOG_INFO << "[PipelinedBatch] Node '" << this->name() << "' lane " << i << " <- product "
+                            << product_id << " (" << in_flight_ << " in flight, " << queue->size() << " left)";
+            }
+
+            NodeStatus lane_status = children_nodes_[i]->executeTick();
+            if (lane_status == NodeStatus::RUNNING)
+            {
+                continue;
+            }
+
+            if (lane_status == NodeStatus::FAILURE)
+            {
+                BT_LOG_ERROR << "[PipelinedBatch] Node '" << this->name() << "' lane " << i
+                             << " FAILED, finishing the products in flight";
+                failed_ = true;
+            }
+            else
+            {
+                ++completed_;
+            }
+            haltChild(i);
+            lane.busy = false;
+            --in_flight_;
+            lane_freed = true;
+        }
+
+        if (in_flight_ == 0 && (failed_ || !queue || queue->empty()))
+        {
+            NodeStatus result = failed_ ? NodeStatus::FAILURE
+                                : completed_ > 0 ? NodeStatus::SUCCESS
+                                                 : getInput<NodeStatus>("if_empty").value_or(NodeStatus::SUCCESS);
+            resetChildren();
+            clear();
+            return result;
+        }
+
+        // A freed lane picks up the next product on the following tick without waiting
+        // for a station message
+        if (lane_freed && !failed_ && queue && !queue->empty())
+        {
+            emitWakeUpSignal();
+        }
+        return NodeStatus::RUNNING;
+    }
+
+    void PipelinedBatchNode::halt()
+    {
+        clear();
+        ControlNode::halt();
+    }
+
+} // namespace BT
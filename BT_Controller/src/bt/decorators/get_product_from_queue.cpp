@@ -4,6 +4,7 @@
 #include <string>
 #include "aas/aas_client.h"
 #include "mqtt/mqtt_pub_base.h"
+#include "logging/logger.h"
 
 void GetProductFromQueue::initializeTopicsFromAAS()
 {
@@ -18,22 +19,23 @@ void GetProductFromQueue::initializeTopicsFromAAS()
         auto xbot_topic_opt = this->config().blackboard->getAnyLocked("XbotTopic");
         if (!xbot_topic_opt)
         {
-            std::cerr << "Node '" << this->name() << "' cannot access XbotTopic from blackboard" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' cannot access XbotTopic from blackboard";
             return;
         }
 
         std::string xbot_topic = xbot_topic_opt->cast<std::string>();
-        std::cout << "Node '" << this->name() << "' initializing for XbotTopic: " << xbot_topic << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for XbotTopic: " << xbot_topic;
 
         // Use xbot_topic directly (should be resolved from blackboard)
         std::string asset_id = xbot_topic;
 
         // Create Topic objects - ProductID property with output endpoint (data being published)
-        auto request_opt = aas_client_.fetchInterface(asset_id, "ProductID", "input");
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id, {{"ProductID", "input"}});
+        auto &request_opt = topics[0];
 
         if (!request_opt.has_value())
         {
-            std::cerr << "Failed to fetch interface from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interface from AAS for node: " << this->name();
             return;
         }
 
@@ -42,41 +44,42 @@ void GetProductFromQueue::initializeTopicsFromAAS()
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
 BT::NodeStatus GetProductFromQueue::tick()
 {
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto xbot_topic_opt = this->config().blackboard->getAnyLocked("XbotTopic");
         std::string xbot_val = xbot_topic_opt ? xbot_topic_opt->cast<std::string>() : "<not set>";
-        std::cerr << "Node '" << this->name() << "' FAILED - could not initialize. "
-                  << "XbotTopic=" << xbot_val << std::endl;
+        BT_LOG_ERROR << "Node '" << this->name() << "' FAILED - could not initialize. "
+                     << "XbotTopic=" << xbot_val;
         return BT::NodeStatus::FAILURE;
     }
 
     bool popped = false;
-    if (status() == BT::NodeStatus::IDLE)
+    if (status() == BT::NodeStatus::IDLE || resumed_from_lazy_init_)
     {
         child_running_ = false;
 
         // Always get a fresh queue reference when starting from IDLE
-        BT::AnyPtrLocked any_ref = getLockedPortContent("Queue");
-        if (any_ref)
-        {
-            queue_ = any_ref.get()->cast<BT::SharedQueue<std::string>>();
-        }
+        queue_ = getInput<ProductQueuePtr>("Queue").value_or(nullptr);
     }
 
     if (!child_running_)
     {
-        if (queue_ && !queue_->empty())
+        // Branches ticking concurrently may draw from the same queue
+        std::string value;
+        if (queue_ && queue_->pop(value))
         {
-            auto value = std::move(queue_->front());
-            queue_->pop_front();
             popped = true;
 
             // Publish the product ID to the MQTT topic
@@ -118,7 +121,7 @@ BT::PortsList GetProductFromQueue::providedPorts()
 {
     // we mark "Queue" as BidirectionalPort, because the original element is modified
     return {
-        BT::details::PortWithDefault<BT::SharedQueue<std::string>>(
+        BT::details::PortWithDefault<ProductQueuePtr>(
             BT::PortDirection::INPUT,
             "Queue",
             "{ProductIDs}",
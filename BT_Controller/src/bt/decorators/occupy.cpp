@@ -3,23 +3,14 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include "mqtt/mqtt_pub_base.h"
-#include <fmt/chrono.h>
 #include <chrono>
-#include <iomanip>
 #include <utils.h>
 #include <algorithm>
-
-// Helper to get current timestamp for logging
-static std::string getOccupyLogTimestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::tm tm = *std::localtime(&time);
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return oss.str();
-}
+#include "metrics/latency_metrics.h"
+#include "logging/logger.h"
+#include "bt/sim_clock.h"
+#include "bt/assignment_scheduler.h"
+#include "bt/decorators/prefetch_occupy.h"
 
 // Helper functions to generate unique topic keys per asset
 std::string Occupy::getOccupyRequestKey(const std::string &asset_id) const
@@ -42,6 +33,13 @@ std::string Occupy::getReleaseResponseKey(const std::string &asset_id) const
     return "releaseResponse_" + asset_id;
 }
 
+static const std::string kStationStateKeyPrefix = "stationState_";
+
+std::string Occupy::getStationStateKey(const std::string &asset_id) const
+{
+    return kStationStateKeyPrefix + asset_id;
+}
+
 void Occupy::initializeTopicsFromAAS()
 {
     // Already initialized, skip
@@ -52,42 +50,70 @@ void Occupy::initializeTopicsFromAAS()
 
     try
     {
-        // Get the list of assets from input
+        // Get the list of assets from input, or the resources the process AAS lists for the Capability
         auto assets_input = getInput<std::vector<std::string>>("Assets");
-        if (!assets_input.has_value() || assets_input.value().empty())
+        auto capability = getInput<std::string>("Capability");
+        if (assets_input.has_value() && !assets_input.value().empty())
+        {
+            asset_ids_ = assets_input.value();
+        }
+        else if (capability.has_value() && !capability.value().empty())
         {
-            std::cerr << "Node '" << this->name() << "' has no Assets input configured or list is empty" << std::endl;
+            // Set on the root blackboard of each execution's tree; "@" reads it from a SubTree too
+            size_t execution = 0;
+            if (!config().blackboard->get("@ExecutionSlot", execution))
+            {
+                BT_LOG_WARN << "Node '" << this->name() << "' found no ExecutionSlot, using slot 0";
+            }
+            asset_ids_ = AssignmentScheduler::instance().resourcesFor(execution, capability.value());
+        }
+        if (asset_ids_.empty())
+        {
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Assets input configured or list is empty"
+                         << (capability.has_value() ? " and no resources for Capability " + capability.value() : "");
             return;
         }
 
-        asset_ids_ = assets_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for " << asset_ids_.size() << " assets" << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for " << asset_ids_.size() << " assets";
 
         // Initialize topics for each asset
         bool all_initialized = true;
         for (const auto &asset_id : asset_ids_)
         {
-            std::cout << "  - Fetching interfaces for asset: " << asset_id << std::endl;
-
-            auto occupy_req = aas_client_.fetchInterface(asset_id, "Occupy", "input");
-            auto occupy_resp = aas_client_.fetchInterface(asset_id, "Occupy", "output");
-            auto release_req = aas_client_.fetchInterface(asset_id, "Release", "input");
-            auto release_resp = aas_client_.fetchInterface(asset_id, "Release", "output");
+            BT_LOG_INFO << "  - Fetching interfaces for asset: " << asset_id;
+
+            auto topics = MqttSubBase::resolveInterfaces(
+                aas_client_, asset_id,
+                {{"Occupy", "input"}, {"Occupy", "output"}, {"Release", "input"}, {"Release", "output"},
+                 {"PackMLState", "output"}});
+            auto &occupy_req = topics[0];
+            auto &occupy_resp = topics[1];
+            auto &release_req = topics[2];
+            auto &release_resp = topics[3];
+            auto &station_state = topics[4];
 
             if (!occupy_req.has_value() || !occupy_resp.has_value() ||
                 !release_req.has_value() || !release_resp.has_value())
             {
-                std::cerr << "Failed to fetch interfaces from AAS for asset: " << asset_id
-                          << " in node: " << this->name() << std::endl;
+                BT_LOG_ERROR << "Failed to fetch interfaces from AAS for asset: " << asset_id
+                             << " in node: " << this->name();
                 all_initialized = false;
                 continue;
             }
 
-            // Set topics with asset-specific keys
+            // Set topics with asset-specific keys; responses go only to the Occupy owning their Uuid
+            MqttSubBase::setCorrelatedTopic(getOccupyResponseKey(asset_id));
+            MqttSubBase::setCorrelatedTopic(getReleaseResponseKey(asset_id));
             MqttPubBase::setTopic(getOccupyRequestKey(asset_id), occupy_req.value());
             MqttPubBase::setTopic(getReleaseRequestKey(asset_id), release_req.value());
             MqttSubBase::setTopic(getOccupyResponseKey(asset_id), occupy_resp.value());
             MqttSubBase::setTopic(getReleaseResponseKey(asset_id), release_resp.value());
+
+            // Optional: only the selection policies use the station's State telemetry
+            if (station_state.has_value())
+            {
+                MqttSubBase::setTopic(getStationStateKey(asset_id), station_state.value());
+            }
         }
 
         // Only mark initialized if we set up at least one asset
@@ -98,31 +124,44 @@ void Occupy::initializeTopicsFromAAS()
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
 BT::NodeStatus Occupy::tick()
 {
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto assets = getInput<std::vector<std::string>>("Assets");
-        std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' FAILED - could not initialize. "
-                  << "Assets count=" << (assets.has_value() ? std::to_string(assets.value().size()) : "<not set>") << std::endl;
+        BT_LOG_ERROR << "[Occupy] Node '" << this->name() 
+                     << "' FAILED - could not initialize. "
+                     << "Assets count=" << (assets.has_value() ? std::to_string(assets.value().size()) : "<not set>");
         return BT::NodeStatus::FAILURE;
     }
 
-    if (status() == BT::NodeStatus::IDLE)
+    if (status() == BT::NodeStatus::IDLE || resumed_from_lazy_init_)
     {
-        current_phase_ = PackML::State::STARTING;
-        selected_asset_id_.clear();
-        pending_assets_.clear();
-        assets_to_release_.clear();
-        assets_with_pending_requests_.clear();
-        occupy_uuid_.clear();
-        sendRegisterCommandToAll();
+        if (adoptPrefetchedOccupation())
+        {
+            return BT::NodeStatus::RUNNING;
+        }
+        bool begun;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            begun = beginOccupation();
+        }
+        if (!begun)
+        {
+            BT_LOG_ERROR << "[Occupy] Node '" << this->name()
+                         << "' has no asset with an occupy topic";
+            return BT::NodeStatus::FAILURE;
+        }
         return BT::NodeStatus::RUNNING;
     }
 
@@ -131,73 +170,258 @@ BT::NodeStatus Occupy::tick()
         BT::NodeStatus child_state = child_node_->executeTick();
         if (child_state == BT::NodeStatus::FAILURE)
         {
-            std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                      << "' child FAILED, releasing " << selected_asset_id_ << std::endl;
-            current_phase_ = PackML::State::STOPPING;
-            sendUnregisterCommand(selected_asset_id_);
+            BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                        << "' child FAILED, releasing " << selected_asset_id_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            beginRelease(PackML::State::STOPPING);
             return BT::NodeStatus::RUNNING;
         }
         else if (child_state == BT::NodeStatus::SUCCESS)
         {
-            std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                      << "' child SUCCESS, releasing " << selected_asset_id_ << std::endl;
+            BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                        << "' child SUCCESS, releasing " << selected_asset_id_;
             resetChild();
-            current_phase_ = PackML::State::COMPLETING;
-            sendUnregisterCommand(selected_asset_id_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            beginRelease(PackML::State::COMPLETING);
             return BT::NodeStatus::RUNNING;
         }
     }
     else if (current_phase_ == PackML::State::STOPPED)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         current_phase_ = PackML::State::IDLE;
+        policy_.reset(); // Ends the scheduler's assignment
         return BT::NodeStatus::FAILURE;
     }
     else if (current_phase_ == PackML::State::COMPLETE)
     {
+        std::lock_guard<std::mutex> lock(mutex_);
         current_phase_ = PackML::State::IDLE;
+        policy_.reset();
         return BT::NodeStatus::SUCCESS;
     }
 
     return BT::NodeStatus::RUNNING;
 }
 
+bool Occupy::beginOccupation()
+{
+    current_phase_ = PackML::State::STARTING;
+    selected_asset_id_.clear();
+    pending_assets_.clear();
+    assets_to_release_.clear();
+    assets_with_pending_requests_.clear();
+    occupy_uuid_.clear();
+    occupy_requested_time_ = std::chrono::steady_clock::now();
+    deadline_.attempt = 0;
+
+    auto policy_name = getInput<std::string>("Policy");
+    policy_ = OccupySelectionPolicy::create(policy_name.has_value() ? policy_name.value()
+                                                                    : AssignmentScheduler::instance().defaultPolicy());
+    ranked_assets_.clear();
+    next_ranked_asset_ = 0;
+    if (!policy_)
+    {
+        sendRegisterCommandToAll();
+        return true;
+    }
+
+    occupy_uuid_ = mqtt_utils::generate_uuid();
+    MqttSubBase::claimResponses(occupy_uuid_);
+    ranked_assets_ = policy_->rank(asset_ids_, StationLoadTracker::instance());
+    return sendRegisterCommandToNextRanked();
+}
+
+bool Occupy::adoptPrefetchedOccupation()
+{
+    auto uuid_input = getInput<std::string>("Uuid");
+    if (!uuid_input.has_value() || uuid_input.value().empty())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto prefetched = PrefetchedOccupations::instance().adopt(uuid_input.value(), asset_ids_);
+    if (!prefetched.has_value())
+    {
+        return false;
+    }
+
+    occupy_uuid_ = uuid_input.value();
+    // The PrefetchOccupy keeps its claim until it sees the occupation was handed over
+    MqttSubBase::claimResponses(occupy_uuid_);
+    assets_with_pending_requests_ = prefetched->requested;
+    pending_assets_ = prefetched->pending;
+    assets_to_release_.clear();
+    selected_asset_id_ = prefetched->selected;
+    policy_.reset();
+    ranked_assets_.clear();
+    next_ranked_asset_ = 0;
+    occupy_requested_time_ = std::chrono::steady_clock::now();
+
+    BT_LOG_INFO << "[Occupy] Node '" << this->name()
+                << "' adopted prefetched occupation UUID=" << occupy_uuid_
+                << (selected_asset_id_.empty() ? " (still queued)" : " already granted by " + selected_asset_id_);
+
+    if (selected_asset_id_.empty())
+    {
+        current_phase_ = PackML::State::STARTING;
+        deadline_.attempt = 0;
+        if (!pending_assets_.empty())
+        {
+            armOccupyDeadline();
+        }
+        return true;
+    }
+
+    // Granted while the previous step ran: nothing left on the critical path
+    setOutput("SelectedAsset", selected_asset_id_);
+    setOutput("Uuid", occupy_uuid_);
+    LatencyMetrics::instance().record("occupy_wait", this->name(), std::chrono::steady_clock::duration::zero());
+    granted_time_ = prefetched->granted_time;
+    current_phase_ = PackML::State::EXECUTE;
+    return true;
+}
+
 void Occupy::halt()
 {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-              << "' HALT called, releasing all assets with UUID=" << occupy_uuid_ << std::endl;
+    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                << "' HALT called, releasing all assets with UUID=" << occupy_uuid_;
 
     // Release all assets that still have pending requests
     // Make a copy since sendUnregisterCommand modifies the set
     std::set<std::string> to_release = assets_with_pending_requests_;
     for (const auto &asset_id : to_release)
     {
-        std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' halt: releasing " << asset_id << std::endl;
+        BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                    << "' halt: releasing " << asset_id;
         sendUnregisterCommand(asset_id);
     }
+    deadline_.cancel();
+    policy_.reset();
 
     DecoratorNode::halt();
 }
 
+void Occupy::beginRelease(PackML::State phase)
+{
+    current_phase_ = phase;
+    deadline_.attempt = 0;
+    sendUnregisterCommand(selected_asset_id_);
+    armReleaseDeadline();
+}
+
+void Occupy::armOccupyDeadline()
+{
+    CommandDeadlines *deadlines = CommandDeadline::installed();
+    if (!deadlines || !usesCommandDeadlines())
+    {
+        return;
+    }
+    const auto &config = deadlines->config();
+    deadline_.arm(CommandDeadline::backoff(std::chrono::milliseconds(config.ack_timeout_ms),
+                                           deadline_.attempt, config.backoff),
+                  [this]()
+                  { onDeadline(); });
+}
+
+void Occupy::armReleaseDeadline()
+{
+    CommandDeadlines *deadlines = CommandDeadline::installed();
+    if (!deadlines || !usesCommandDeadlines())
+    {
+        return;
+    }
+    const auto &config = deadlines->config();
+    deadline_.arm(CommandDeadline::backoff(std::chrono::milliseconds(config.release_timeout_ms),
+                                           deadline_.attempt, config.backoff),
+                  [this]()
+                  { onDeadline(); });
+}
+
+void Occupy::onDeadline()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    CommandDeadlines *deadlines = CommandDeadline::installed();
+    // Answered or halted, or re-armed by a response since the wheel fired
+    if (!deadlines || deadline_.armed() || status() != BT::NodeStatus::RUNNING)
+    {
+        return;
+    }
+    int retries = deadlines->config().retries;
+    bool resend = deadline_.attempt < retries;
+
+    if (current_phase_ == PackML::State::STARTING && !pending_assets_.empty())
+    {
+        std::vector<std::string> silent(pending_assets_.begin(), pending_assets_.end());
+        if (resend)
+        {
+            ++deadline_.attempt;
+            for (const auto &asset_id : silent)
+            {
+                BT_LOG_WARN << "[Occupy] Node '" << this->name() << "' no answer from " << asset_id
+                            << ", resending occupy request (" << deadline_.attempt << "/" << retries << ")";
+                sendRegisterCommand(asset_id);
+            }
+            return;
+        }
+
+        for (const auto &asset_id : silent)
+        {
+            BT_LOG_ERROR << "[Occupy] Node '" << this->name() << "' no answer from " << asset_id
+                         << " to occupy request UUID=" << occupy_uuid_ << ", treating it as refused";
+            pending_assets_.erase(asset_id);
+            onAssetRefused(asset_id);
+        }
+    }
+    else if ((current_phase_ == PackML::State::COMPLETING || current_phase_ == PackML::State::STOPPING) &&
+             !selected_asset_id_.empty())
+    {
+        if (resend)
+        {
+            ++deadline_.attempt;
+            BT_LOG_WARN << "[Occupy] Node '" << this->name() << "' no answer from " << selected_asset_id_
+                        << ", resending release (" << deadline_.attempt << "/" << retries << ")";
+            // sendUnregisterCommand() only releases assets it still counts as requested
+            assets_with_pending_requests_.insert(selected_asset_id_);
+            sendUnregisterCommand(selected_asset_id_);
+            armReleaseDeadline();
+            return;
+        }
+
+        BT_LOG_ERROR << "[Occupy] Node '" << this->name() << "' no answer from " << selected_asset_id_
+                     << " to release UUID=" << occupy_uuid_ << ", assuming it was released";
+        current_phase_ = current_phase_ == PackML::State::COMPLETING ? PackML::State::COMPLETE
+                                                                       : PackML::State::STOPPED;
+    }
+    else
+    {
+        return;
+    }
+
+    emitWakeUpSignal();
+}
+
 void Occupy::sendRegisterCommandToAll()
 {
     // Generate ONE UUID for this entire occupy operation - same UUID sent to all assets
     // This makes it traceable which Occupy node made which requests
     occupy_uuid_ = mqtt_utils::generate_uuid();
+    MqttSubBase::claimResponses(occupy_uuid_);
     
-    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-              << "' starting occupation with UUID=" << occupy_uuid_ 
-              << " for " << asset_ids_.size() << " assets" << std::endl;
+    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                << "' starting occupation with UUID=" << occupy_uuid_ 
+                << " for " << asset_ids_.size() << " assets";
 
     for (const auto &asset_id : asset_ids_)
     {
         // Check if we have valid topics for this asset
         if (MqttPubBase::topics_.find(getOccupyRequestKey(asset_id)) == MqttPubBase::topics_.end())
         {
-            std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] No occupy topic configured for asset: " 
-                      << asset_id << std::endl;
+            BT_LOG_ERROR << "[Occupy] No occupy topic configured for asset: " 
+                         << asset_id;
             continue;
         }
 
@@ -205,6 +429,26 @@ void Occupy::sendRegisterCommandToAll()
     }
 }
 
+bool Occupy::sendRegisterCommandToNextRanked()
+{
+    while (next_ranked_asset_ < ranked_assets_.size())
+    {
+        const std::string &asset_id = ranked_assets_[next_ranked_asset_++];
+        if (MqttPubBase::topics_.find(getOccupyRequestKey(asset_id)) == MqttPubBase::topics_.end())
+        {
+            continue;
+        }
+
+        BT_LOG_INFO << "[Occupy] Node '" << this->name()
+                    << "' policy " << policy_->name() << " chose " << asset_id
+                    << " (candidate " << next_ranked_asset_ << "/" << ranked_assets_.size() << ")";
+        policy_->onRequested(asset_id);
+        sendRegisterCommand(asset_id);
+        return true;
+    }
+    return false;
+}
+
 void Occupy::sendRegisterCommand(const std::string &asset_id)
 {
     json message;
@@ -216,35 +460,36 @@ void Occupy::sendRegisterCommand(const std::string &asset_id)
 
     message["Uuid"] = occupy_uuid_;
 
-    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-              << "' -> OCCUPY REQUEST to " << asset_id 
-              << " with UUID=" << occupy_uuid_ << std::endl;
+    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                << "' -> OCCUPY REQUEST to " << asset_id 
+                << " with UUID=" << occupy_uuid_;
     MqttPubBase::publish(getOccupyRequestKey(asset_id), message);
+    armOccupyDeadline();
 }
 
 void Occupy::sendUnregisterCommand(const std::string &asset_id)
 {
     if (occupy_uuid_.empty())
     {
-        std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' - No UUID set - cannot send release to " << asset_id << std::endl;
+        BT_LOG_ERROR << "[Occupy] Node '" << this->name() 
+                     << "' - No UUID set - cannot send release to " << asset_id;
         return;
     }
 
     // Check if we actually sent a request to this asset
     if (assets_with_pending_requests_.find(asset_id) == assets_with_pending_requests_.end())
     {
-        std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' - No pending request for " << asset_id << " - skipping release" << std::endl;
+        BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                    << "' - No pending request for " << asset_id << " - skipping release";
         return;
     }
 
     json message;
     message["Uuid"] = occupy_uuid_;
 
-    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-              << "' -> RELEASE REQUEST to " << asset_id 
-              << " with UUID=" << occupy_uuid_ << std::endl;
+    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                << "' -> RELEASE REQUEST to " << asset_id 
+                << " with UUID=" << occupy_uuid_;
     MqttPubBase::publish(getReleaseRequestKey(asset_id), message);
     
     // Mark that we've sent a release for this asset
@@ -253,9 +498,9 @@ void Occupy::sendUnregisterCommand(const std::string &asset_id)
 
 void Occupy::releaseNonSelectedAssets()
 {
-    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-              << "' releasing " << assets_with_pending_requests_.size() 
-              << " non-selected assets (selected=" << selected_asset_id_ << ")" << std::endl;
+    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                << "' releasing " << assets_with_pending_requests_.size() 
+                << " non-selected assets (selected=" << selected_asset_id_ << ")";
 
     // Make a copy since sendUnregisterCommand modifies the set
     std::set<std::string> assets_to_release_copy = assets_with_pending_requests_;
@@ -271,6 +516,13 @@ void Occupy::releaseNonSelectedAssets()
 
 void Occupy::callback(const std::string &topic_key, const json &msg, mqtt::properties props)
 {
+    // Station telemetry feeds the selection policies in every phase, also while idle
+    if (topic_key.compare(0, kStationStateKeyPrefix.size(), kStationStateKeyPrefix) == 0)
+    {
+        StationLoadTracker::instance().updateFromState(topic_key.substr(kStationStateKeyPrefix.size()), msg);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (status() != BT::NodeStatus::RUNNING)
@@ -302,18 +554,18 @@ void Occupy::callback(const std::string &topic_key, const json &msg, mqtt::prope
 
     if (responding_asset.empty())
     {
-        std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' received response on unknown topic_key: " << topic_key << std::endl;
+        BT_LOG_ERROR << "[Occupy] Node '" << this->name() 
+                     << "' received response on unknown topic_key: " << topic_key;
         return;
     }
 
     // Handle occupy responses (during STARTING phase)
     if (topic_key == getOccupyResponseKey(responding_asset))
     {
-        std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' <- OCCUPY RESPONSE from " << responding_asset 
-                  << ": " << state << " (UUID=" << received_uuid << ")" 
-                  << " phase=" << static_cast<int>(current_phase_) << std::endl;
+        BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                    << "' <- OCCUPY RESPONSE from " << responding_asset 
+                    << ": " << state << " (UUID=" << received_uuid << ")" 
+                    << " phase=" << static_cast<int>(current_phase_);
 
         if (current_phase_ == PackML::State::STARTING)
         {
@@ -330,61 +582,72 @@ void Occupy::callback(const std::string &topic_key, const json &msg, mqtt::prope
                     setOutput("SelectedAsset", selected_asset_id_);
                     setOutput("Uuid", occupy_uuid_);
 
-                    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                              << "' SELECTED asset: " << selected_asset_id_ 
-                              << " (UUID=" << occupy_uuid_ << ")" << std::endl;
+                    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                                << "' SELECTED asset: " << selected_asset_id_ 
+                                << " (UUID=" << occupy_uuid_ << ")";
 
                     // Release ALL other assets that we sent requests to (not just pending ones)
                     // This ensures we don't leave stale requests in asset queues
                     releaseNonSelectedAssets();
                     pending_assets_.clear();
 
+                    // Time spent queued at the stations until one granted us
+                    LatencyMetrics::instance().record("occupy_wait", this->name(),
+                                                      std::chrono::steady_clock::now() - occupy_requested_time_);
+
                     // Transition to EXECUTE - we have our asset
+                    granted_time_ = SimClock::now();
                     current_phase_ = PackML::State::EXECUTE;
                 }
                 else
                 {
                     // Already have a selected asset, need to release this one immediately
-                    std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                              << "' asset " << responding_asset << " also succeeded but "
-                              << selected_asset_id_ << " was already selected - releasing" << std::endl;
+                    BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                                << "' asset " << responding_asset << " also succeeded but "
+                                << selected_asset_id_ << " was already selected - releasing";
                     sendUnregisterCommand(responding_asset);
                 }
             }
             else if (state == "FAILURE")
             {
-                std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                          << "' asset " << responding_asset << " FAILED occupation request" << std::endl;
+                BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                            << "' asset " << responding_asset << " FAILED occupation request";
+                onAssetRefused(responding_asset);
+            }
 
-                // If all assets have failed, transition to STOPPED
-                if (pending_assets_.empty() && selected_asset_id_.empty())
-                {
-                    std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                              << "' ALL assets failed occupation - node failing" << std::endl;
-                    current_phase_ = PackML::State::STOPPED;
-                }
+            // Every asked asset answered: the wait in their queues is not bounded
+            if (pending_assets_.empty() || current_phase_ != PackML::State::STARTING)
+            {
+                deadline_.cancel();
             }
         }
     }
     // Handle release responses
     else if (topic_key == getReleaseResponseKey(responding_asset))
     {
-        std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                  << "' <- RELEASE RESPONSE from " << responding_asset 
-                  << ": " << state << " (UUID=" << received_uuid << ")" << std::endl;
+        BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                    << "' <- RELEASE RESPONSE from " << responding_asset 
+                    << ": " << state << " (UUID=" << received_uuid << ")";
 
         assets_to_release_.erase(responding_asset);
 
         if (responding_asset == selected_asset_id_)
         {
+            if (state == "SUCCESS" || state == "FAILURE")
+            {
+                deadline_.cancel();
+            }
+
             // This is the release of our main selected asset
             if (state == "SUCCESS")
             {
-                std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                          << "' successfully released selected asset: " << responding_asset << std::endl;
+                BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                            << "' successfully released selected asset: " << responding_asset;
                           
                 if (current_phase_ == PackML::State::COMPLETING)
                 {
+                    StationLoadTracker::instance().recordServiceTime(
+                        responding_asset, SimClock::now() - granted_time_);
                     current_phase_ = PackML::State::COMPLETE;
                 }
                 else if (current_phase_ == PackML::State::STOPPING)
@@ -394,29 +657,55 @@ void Occupy::callback(const std::string &topic_key, const json &msg, mqtt::prope
             }
             else if (state == "FAILURE")
             {
-                std::cerr << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                          << "' FAILED to release selected asset: " << responding_asset << std::endl;
+                BT_LOG_ERROR << "[Occupy] Node '" << this->name() 
+                             << "' FAILED to release selected asset: " << responding_asset;
                 current_phase_ = PackML::State::STOPPED;
             }
         }
         // For non-selected assets, we just log
         else
         {
-            std::cout << "[" << getOccupyLogTimestamp() << "] [Occupy] Node '" << this->name() 
-                      << "' released non-selected asset: " << responding_asset
-                      << " with state: " << state << std::endl;
+            BT_LOG_INFO << "[Occupy] Node '" << this->name() 
+                        << "' released non-selected asset: " << responding_asset
+                        << " with state: " << state;
         }
     }
 
     emitWakeUpSignal();
 }
 
+void Occupy::onAssetRefused(const std::string &asset_id)
+{
+    if (policy_)
+    {
+        policy_->onRefused(asset_id);
+    }
+
+    // A ranked policy asks the next candidate before giving up
+    bool asked_next = policy_ && selected_asset_id_.empty() && sendRegisterCommandToNextRanked();
+
+    // If all assets have failed, transition to STOPPED
+    if (!asked_next && pending_assets_.empty() && selected_asset_id_.empty())
+    {
+        BT_LOG_ERROR << "[Occupy] Node '" << this->name() 
+                     << "' ALL assets failed occupation - node failing";
+        current_phase_ = PackML::State::STOPPED;
+    }
+}
+
 BT::PortsList Occupy::providedPorts()
 {
     return {
         BT::InputPort<std::vector<std::string>>(
             "Assets",
             "List of asset IDs to attempt occupation on"),
+        BT::InputPort<std::string>(
+            "Capability",
+            "Without Assets: the resources the process AAS lists for this RequiredCapability"),
+        BT::InputPort<std::string>(
+            "Policy",
+            "Asset selection: first_response, least_queued, round_robin, earliest_completion or "
+            "shortest_expected_completion; unset uses scheduler.occupy_policy"),
         BT::details::PortWithDefault<std::string>(
             BT::PortDirection::OUTPUT,
             "SelectedAsset",
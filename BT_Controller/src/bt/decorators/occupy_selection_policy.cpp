@@ -0,0 +1,224 @@
+#include "bt/decorators/occupy_selection_policy.h"
+#include "bt/assignment_scheduler.h"
+#include "bt/sim_clock.h"
+#include "logging/logger.h"
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+    // Weight of a new sample in the smoothed service time
+    constexpr double kServiceTimeSmoothing = 0.2;
+
+    // Order candidates by key, unavailable stations last, ties in Assets order
+    template <typename KeyFn>
+    std::vector<std::string> rankBy(const std::vector<std::string> &candidates, KeyFn key)
+    {
+        std::vector<std::pair<decltype(key(candidates.front())), std::string>> keyed;
+        keyed.reserve(candidates.size());
+        for (const auto &asset_id : candidates)
+        {
+            keyed.emplace_back(key(asset_id), asset_id);
+        }
+        std::stable_sort(keyed.begin(), keyed.end(),
+                         [](const auto &a, const auto &b)
+                         { return a.first < b.first; });
+
+        std::vector<std::string> ranked;
+        ranked.reserve(keyed.size());
+        for (auto &[_, asset_id] : keyed)
+        {
+            ranked.push_back(std::move(asset_id));
+        }
+        return ranked;
+    }
+}
+
+StationLoadTracker &StationLoadTracker::instance()
+{
+    static StationLoadTracker tracker;
+    return tracker;
+}
+
+void StationLoadTracker::updateFromState(const std::string &asset_id, const nlohmann::json &state_msg)
+{
+    if (!state_msg.is_object())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    StationLoad &load = loads_[asset_id];
+    auto state_it = state_msg.find("State");
+    if (state_it != state_msg.end() && state_it->is_string())
+    {
+        load.state = state_it->get<std::string>();
+    }
+    auto depth_it = state_msg.find("QueueDepth");
+    auto queue_it = state_msg.find("ProcessQueue");
+    if (depth_it != state_msg.end() && depth_it->is_number_unsigned())
+    {
+        load.queue_depth = depth_it->get<size_t>();
+    }
+    else if (queue_it != state_msg.end() && queue_it->is_array())
+    {
+        load.queue_depth = queue_it->size();
+    }
+    load.updated = SimClock::now();
+}
+
+void StationLoadTracker::recordServiceTime(const std::string &asset_id, std::chrono::steady_clock::duration service_time)
+{
+    double sample_ms = std::chrono::duration<double, std::milli>(service_time).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    StationLoad &load = loads_[asset_id];
+    load.mean_service_ms = load.service_samples == 0
+                               ? sample_ms
+                               : load.mean_service_ms + kServiceTimeSmoothing * (sample_ms - load.mean_service_ms);
+    load.service_samples++;
+}
+
+std::optional<StationLoad> StationLoadTracker::get(const std::string &asset_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = loads_.find(asset_id);
+    if (it == loads_.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t StationLoadTracker::nextRoundRobin(const std::string &candidate_key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return round_robin_[candidate_key]++;
+}
+
+std::unique_ptr<OccupySelectionPolicy> OccupySelectionPolicy::create(const std::string &policy_name)
+{
+    if (policy_name == "least_queued")
+    {
+        return std::make_unique<LeastQueuedPolicy>();
+    }
+    if (policy_name == "round_robin")
+    {
+        return std::make_unique<RoundRobinPolicy>();
+    }
+    if (policy_name == "earliest_completion")
+    {
+        return std::make_unique<EarliestCompletionPolicy>();
+    }
+    if (policy_name == "shortest_expected_completion")
+    {
+        return std::make_unique<ShortestExpectedCompletionPolicy>();
+    }
+    if (policy_name != "first_response")
+    {
+        BT_LOG_WARN << "Unknown Occupy selection policy '" << policy_name << "', using first_response";
+    }
+    return nullptr;
+}
+
+bool OccupySelectionPolicy::acceptsWork(const std::optional<StationLoad> &load)
+{
+    if (!load.has_value() || load->state.empty())
+    {
+        return true; // No telemetry yet: let the station answer for itself
+    }
+    static const std::vector<std::string> unavailable = {
+        "HOLDING", "HELD", "SUSPENDING", "SUSPENDED", "ABORTING", "ABORTED", "CLEARING", "STOPPING", "STOPPED"};
+    return std::find(unavailable.begin(), unavailable.end(), load->state) == unavailable.end();
+}
+
+std::vector<std::string> LeastQueuedPolicy::rank(const std::vector<std::string> &candidates,
+                                                 StationLoadTracker &tracker)
+{
+    return rankBy(candidates, [&tracker](const std::string &asset_id)
+                  {
+                      auto load = tracker.get(asset_id);
+                      return std::make_tuple(!acceptsWork(load), load.has_value() ? load->queue_depth : size_t{0});
+                  });
+}
+
+std::vector<std::string> RoundRobinPolicy::rank(const std::vector<std::string> &candidates,
+                                                StationLoadTracker &tracker)
+{
+    if (candidates.empty())
+    {
+        return {};
+    }
+
+    std::string candidate_key;
+    for (const auto &asset_id : candidates)
+    {
+        candidate_key += asset_id;
+        candidate_key += '\n';
+    }
+    size_t offset = tracker.nextRoundRobin(candidate_key) % candidates.size();
+
+    std::vector<std::string> rotated(candidates.begin() + offset, candidates.end());
+    rotated.insert(rotated.end(), candidates.begin(), candidates.begin() + offset);
+    return rankBy(rotated, [&tracker](const std::string &asset_id)
+                  { return !acceptsWork(tracker.get(asset_id)); });
+}
+
+std::vector<std::string> EarliestCompletionPolicy::rank(const std::vector<std::string> &candidates,
+                                                        StationLoadTracker &tracker)
+{
+    // Stations without a service time yet are assumed as fast as the average known one
+    double known_total_ms = 0.0;
+    size_t known_count = 0;
+    for (const auto &asset_id : candidates)
+    {
+        auto load = tracker.get(asset_id);
+        if (load.has_value() && load->service_samples > 0)
+        {
+            known_total_ms += load->mean_service_ms;
+            known_count++;
+        }
+    }
+    double default_service_ms = known_count > 0 ? known_total_ms / known_count : 1.0;
+
+    return rankBy(candidates, [&tracker, default_service_ms](const std::string &asset_id)
+                  {
+                      auto load = tracker.get(asset_id);
+                      size_t depth = load.has_value() ? load->queue_depth : 0;
+                      double service_ms = (load.has_value() && load->service_samples > 0) ? load->mean_service_ms
+                                                                                          : default_service_ms;
+                      // Our own request waits for everyone queued and then its own turn
+                      return std::make_tuple(!acceptsWork(load), (depth + 1) * service_ms);
+                  });
+}
+
+ShortestExpectedCompletionPolicy::~ShortestExpectedCompletionPolicy()
+{
+    if (ticket_ != 0)
+    {
+        AssignmentScheduler::instance().withdraw(assigned_asset_, ticket_);
+    }
+}
+
+std::vector<std::string> ShortestExpectedCompletionPolicy::rank(const std::vector<std::string> &candidates,
+                                                                StationLoadTracker &tracker)
+{
+    return AssignmentScheduler::instance().rank(candidates, tracker);
+}
+
+void ShortestExpectedCompletionPolicy::onRequested(const std::string &asset_id)
+{
+    onRefused(assigned_asset_);
+    assigned_asset_ = asset_id;
+    ticket_ = AssignmentScheduler::instance().assign(asset_id);
+}
+
+void ShortestExpectedCompletionPolicy::onRefused(const std::string &asset_id)
+{
+    if (ticket_ != 0 && asset_id == assigned_asset_)
+    {
+        AssignmentScheduler::instance().withdraw(assigned_asset_, ticket_);
+        assigned_asset_.clear();
+        ticket_ = 0;
+    }
+}
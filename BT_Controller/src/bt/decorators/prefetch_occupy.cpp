@@ -0,0 +1,212 @@
+#include "bt/decorators/prefetch_occupy.h"
+#include "logging/logger.h"
+#include <algorithm>
+
+PrefetchedOccupations &PrefetchedOccupations::instance()
+{
+    static PrefetchedOccupations registry;
+    return registry;
+}
+
+void PrefetchedOccupations::offer(const std::string &uuid, Entry entry)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[uuid] = std::move(entry);
+}
+
+bool PrefetchedOccupations::updateIfOffered(const std::string &uuid, const std::function<void(Entry &)> &update)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(uuid);
+    if (it == entries_.end())
+    {
+        return false;
+    }
+    update(it->second);
+    return true;
+}
+
+std::optional<PrefetchedOccupations::Entry> PrefetchedOccupations::adopt(
+    const std::string &uuid, const std::vector<std::string> &adopter_assets)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(uuid);
+    if (it == entries_.end())
+    {
+        return std::nullopt;
+    }
+
+    // The adopter only hears responses from its own assets
+    for (const auto &asset_id : it->second.requested)
+    {
+        if (std::find(adopter_assets.begin(), adopter_assets.end(), asset_id) == adopter_assets.end())
+        {
+            BT_LOG_ERROR << "Prefetched occupation " << uuid << " includes " << asset_id
+                         << ", which is not among the adopting node's Assets - not adopted";
+            return std::nullopt;
+        }
+    }
+
+    Entry entry = std::move(it->second);
+    entries_.erase(it);
+
+    // Every station refused: let the adopter queue from scratch
+    if (entry.selected.empty() && entry.pending.empty())
+    {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+bool PrefetchedOccupations::withdraw(const std::string &uuid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.erase(uuid) > 0;
+}
+
+PrefetchedOccupations::Entry PrefetchOccupy::snapshot() const
+{
+    PrefetchedOccupations::Entry entry;
+    entry.requested = assets_with_pending_requests_;
+    entry.pending = pending_assets_;
+    entry.selected = selected_asset_id_;
+    entry.granted_time = granted_time_;
+    return entry;
+}
+
+BT::NodeStatus PrefetchOccupy::tick()
+{
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
+    {
+        BT_LOG_ERROR << "[PrefetchOccupy] Node '" << this->name() << "' FAILED - could not initialize";
+        return BT::NodeStatus::FAILURE;
+    }
+
+    if (status() == BT::NodeStatus::IDLE || resumed_from_lazy_init_)
+    {
+        PrefetchedOccupations::Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!beginOccupation())
+            {
+                BT_LOG_ERROR << "[PrefetchOccupy] Node '" << this->name()
+                             << "' has no asset with an occupy topic";
+                return BT::NodeStatus::FAILURE;
+            }
+            prefetching_ = true;
+            entry = snapshot();
+        }
+        setOutput("Uuid", occupy_uuid_);
+        PrefetchedOccupations::instance().offer(occupy_uuid_, std::move(entry));
+
+        BT_LOG_INFO << "[PrefetchOccupy] Node '" << this->name() << "' queued ahead with UUID="
+                    << occupy_uuid_ << ", running child";
+    }
+
+    // The child runs while the stations queue us; it is not gated on a grant
+    BT::NodeStatus child_state = child_node_->executeTick();
+    if (child_state != BT::NodeStatus::RUNNING)
+    {
+        releaseUnadopted();
+        resetChild();
+    }
+    return child_state;
+}
+
+void PrefetchOccupy::callback(const std::string &topic_key, const json &msg, mqtt::properties props)
+{
+    if (topic_key.rfind(getStationStateKey(""), 0) == 0)
+    {
+        Occupy::callback(topic_key, msg, props);
+        return;
+    }
+
+    std::string uuid;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!prefetching_)
+        {
+            return;
+        }
+        uuid = occupy_uuid_;
+    }
+
+    // Once adopted, the responses are the adopter's business
+    PrefetchedOccupations::instance().updateIfOffered(
+        uuid,
+        [&](PrefetchedOccupations::Entry &entry)
+        {
+            Occupy::callback(topic_key, msg, props);
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry = snapshot();
+        });
+}
+
+void PrefetchOccupy::releaseUnadopted()
+{
+    std::string uuid;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!prefetching_)
+        {
+            return;
+        }
+        prefetching_ = false;
+        uuid = occupy_uuid_;
+        policy_.reset(); // Adopted or released, the request no longer needs the scheduler
+    }
+
+    if (!PrefetchedOccupations::instance().withdraw(uuid))
+    {
+        BT_LOG_INFO << "[PrefetchOccupy] Node '" << this->name() << "' occupation " << uuid
+                    << " was handed over";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    BT_LOG_INFO << "[PrefetchOccupy] Node '" << this->name() << "' occupation " << uuid
+                << " not adopted, releasing " << assets_with_pending_requests_.size() << " assets";
+    std::set<std::string> to_release = assets_with_pending_requests_;
+    for (const auto &asset_id : to_release)
+    {
+        sendUnregisterCommand(asset_id);
+    }
+}
+
+void PrefetchOccupy::halt()
+{
+    releaseUnadopted();
+
+    // Not Occupy::halt(): an adopted occupation must not be released from here
+    MqttDecorator::halt();
+}
+
+BT::PortsList PrefetchOccupy::providedPorts()
+{
+    return {
+        BT::InputPort<std::vector<std::string>>(
+            "Assets",
+            "List of asset IDs to queue at ahead of time"),
+        BT::InputPort<std::string>(
+            "Capability",
+            "Without Assets: the resources the process AAS lists for this RequiredCapability"),
+        BT::InputPort<std::string>(
+            "Policy",
+            "Asset selection: first_response, least_queued, round_robin, earliest_completion or "
+            "shortest_expected_completion; unset uses scheduler.occupy_policy"),
+        BT::details::PortWithDefault<std::string>(
+            BT::PortDirection::OUTPUT,
+            "SelectedAsset",
+            "{PrefetchedAsset}",
+            "The Asset that granted the prefetched request, once it has"),
+        BT::details::PortWithDefault<std::string>(
+            BT::PortDirection::OUTPUT,
+            "Uuid",
+            "{PrefetchUuid}",
+            "UUID of the prefetched occupation; pass it to the Occupy that should adopt it")};
+}
@@ -1,6 +1,6 @@
 #include "bt/decorators/sampling_gate.h"
+#include "logging/logger.h"
 #include <behaviortree_cpp/bt_factory.h>
-#include <iostream>
 #include <cmath>
 
 BT::NodeStatus SamplingGate::tick()
@@ -28,8 +28,8 @@ BT::NodeStatus SamplingGate::tick()
     // If 0%, never execute child
     if (sampling_rate == 0)
     {
-        std::cout << "[SamplingGate] Node '" << this->name() 
-                  << "' sampling disabled (0%), skipping child" << std::endl;
+        BT_LOG_INFO << "[SamplingGate] Node '" << this->name() 
+                    << "' sampling disabled (0%), skipping child";
         return BT::NodeStatus::SUCCESS;
     }
 
@@ -37,24 +37,18 @@ BT::NodeStatus SamplingGate::tick()
     auto batch_size_input = getInput<int>("BatchSize");
     if (!batch_size_input.has_value() || batch_size_input.value() <= 0)
     {
-        std::cerr << "[SamplingGate] Node '" << this->name() 
-                  << "' no valid BatchSize, defaulting to execute child" << std::endl;
+        BT_LOG_ERROR << "[SamplingGate] Node '" << this->name() 
+                     << "' no valid BatchSize, defaulting to execute child";
         setStatus(BT::NodeStatus::RUNNING);
         return child_node_->executeTick();
     }
     int batch_size = batch_size_input.value();
 
     // Get current queue size
-    BT::AnyPtrLocked any_ref = getLockedPortContent("Queue");
     int current_size = 0;
-    
-    if (any_ref)
+    if (auto queue = getInput<ProductQueuePtr>("Queue"); queue && queue.value())
     {
-        auto queue_ptr = any_ref.get()->cast<BT::SharedQueue<std::string>>();
-        if (queue_ptr)
-        {
-            current_size = static_cast<int>(queue_ptr->size());
-        }
+        current_size = static_cast<int>(queue.value()->size());
     }
 
     // Calculate product index (0-based, counting from start of batch)
@@ -65,11 +59,11 @@ BT::NodeStatus SamplingGate::tick()
     
     bool should_execute = shouldExecute(product_index, sampling_rate);
 
-    std::cout << "[SamplingGate] Node '" << this->name() 
-              << "' product " << (product_index + 1) << "/" << batch_size 
-              << " (index=" << product_index << ")"
-              << " rate=" << sampling_rate << "%" 
-              << " -> " << (should_execute ? "EXECUTE" : "SKIP") << std::endl;
+    BT_LOG_INFO << "[SamplingGate] Node '" << this->name() 
+                << "' product " << (product_index + 1) << "/" << batch_size 
+                << " (index=" << product_index << ")"
+                << " rate=" << sampling_rate << "%" 
+                << " -> " << (should_execute ? "EXECUTE" : "SKIP");
 
     if (should_execute)
     {
@@ -109,7 +103,7 @@ BT::PortsList SamplingGate::providedPorts()
             "BatchSize",
             "{BatchSize}",
             "The initial size of the product queue (typically set by Configure node)"),
-        BT::InputPort<BT::SharedQueue<std::string>>(
+        BT::InputPort<ProductQueuePtr>(
             "Queue",
             "{ProductIDs}",
             "The queue of product IDs to determine current product index")
@@ -0,0 +1,90 @@
+#include "bt/groot2_monitor.h"
+#include "logging/logger.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <behaviortree_cpp/loggers/groot2_publisher.h>
+
+Groot2Monitor::Groot2Monitor(const BT::Tree &tree, unsigned port, const bt_utils::Groot2MonitorConfig &config)
+    : publisher_(std::make_unique<BT::Groot2Publisher>(tree, port)),
+      interval_(std::max(config.snapshot_interval_ms, 1))
+{
+    auto mode = parseMode(config.mode);
+    if (!mode)
+    {
+        BT_LOG_WARN << "[Groot2] Unknown mode '" << config.mode << "', using stock";
+    }
+    mode_ = mode.value_or(Mode::Stock);
+    if (mode_ == Mode::Stock)
+    {
+        return;
+    }
+
+    // Status changes now reach the publisher only through sample()
+    publisher_->setEnabled(false);
+    for (const auto &subtree : tree.subtrees)
+    {
+        for (const auto &node : subtree->nodes)
+        {
+            // The publisher's buffer starts out IDLE, so the first sample sends the rest
+            nodes_.push_back(SampledNode{node.get(), BT::NodeStatus::IDLE});
+        }
+    }
+    sampler_ = std::thread(&Groot2Monitor::samplerLoop, this);
+    BT_LOG_INFO << "[Groot2] Port " << port << ": snapshots of " << nodes_.size()
+                << " nodes every " << interval_.count() << " ms";
+}
+
+Groot2Monitor::~Groot2Monitor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    if (sampler_.joinable())
+    {
+        sampler_.join();
+    }
+}
+
+void Groot2Monitor::samplerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, interval_, [this]
+                              { return stopping_; }))
+    {
+        lock.unlock();
+        sample();
+        lock.lock();
+    }
+}
+
+void Groot2Monitor::sample()
+{
+    // callback() is private in Groot2Publisher but public in its logger base
+    auto &logger = static_cast<BT::StatusChangeLogger &>(*publisher_);
+    auto timestamp = std::chrono::high_resolution_clock::now().time_since_epoch();
+    for (auto &sampled : nodes_)
+    {
+        BT::NodeStatus status = sampled.node->status();
+        if (status != sampled.last)
+        {
+            logger.callback(timestamp, *sampled.node, sampled.last, status);
+            sampled.last = status;
+        }
+    }
+}
+
+std::optional<Groot2Monitor::Mode> Groot2Monitor::parseMode(const std::string &name)
+{
+    if (name == "stock")
+    {
+        return Mode::Stock;
+    }
+    if (name == "throttled")
+    {
+        return Mode::Throttled;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,46 @@
+#include "bt/lazy_node_init.h"
+#include <iostream>
+#include <chrono>
+
+LazyNodeInit::~LazyNodeInit()
+{
+    wait();
+}
+
+LazyNodeInit::Status LazyNodeInit::poll(const std::function<bool()> &work, const std::function<void()> &on_done)
+{
+    if (future_.valid())
+    {
+        if (future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            return Status::Pending;
+        }
+        return future_.get() ? Status::Ready : Status::Failed;
+    }
+
+    future_ = std::async(std::launch::async, [work, on_done]()
+                         {
+                             bool ok = false;
+                             try
+                             {
+                                 ok = work();
+                             }
+                             catch (const std::exception &e)
+                             {
+                                 std::cerr << "Lazy initialization threw: " << e.what() << std::endl;
+                             }
+                             if (on_done)
+                             {
+                                 on_done();
+                             }
+                             return ok; });
+    return Status::Pending;
+}
+
+void LazyNodeInit::wait()
+{
+    if (future_.valid())
+    {
+        future_.wait();
+    }
+}
@@ -0,0 +1,153 @@
+#include "bt/move_batcher.h"
+#include "mqtt/mqtt_client.h"
+#include "mqtt/mqtt_sub_base.h"
+#include "logging/logger.h"
+
+#include <algorithm>
+
+std::atomic<MoveBatcher *> MoveBatcher::batcher_{nullptr};
+
+MoveBatcher::MoveBatcher(MqttClient &mqtt_client, AASClient &aas_client, const bt_utils::MoveBatchConfig &config)
+    : MqttPubBase(mqtt_client),
+      aas_client_(aas_client),
+      config_(config)
+{
+}
+
+void MoveBatcher::install(MoveBatcher *batcher)
+{
+    batcher_.store(batcher, std::memory_order_release);
+}
+
+void MoveBatcher::enqueue(const mqtt_utils::Topic &xbot_topic, nlohmann::json position, const std::string &uuid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A resend replaces the move still waiting for the batch
+    std::erase_if(pending_, [&](const Move &move)
+                  { return move.uuid == uuid; });
+    if (pending_.empty())
+    {
+        window_end_ = Clock::now() + std::chrono::milliseconds(std::max(config_.window_ms, 0));
+    }
+    pending_.push_back(Move{xbot_topic, std::move(position), uuid});
+}
+
+bool MoveBatcher::withdraw(const std::string &uuid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::erase_if(pending_, [&](const Move &move)
+                         { return move.uuid == uuid; }) > 0;
+}
+
+size_t MoveBatcher::flush(Clock::time_point now)
+{
+    std::vector<Move> moves;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty() || now < window_end_)
+        {
+            return 0;
+        }
+        moves.swap(pending_);
+    }
+
+    if (moves.size() > 1 && resolveBatchTopic())
+    {
+        publishBatch(moves);
+    }
+    else
+    {
+        for (const Move &move : moves)
+        {
+            publishSingle(move);
+        }
+    }
+    return moves.size();
+}
+
+std::chrono::milliseconds MoveBatcher::untilFlush(std::chrono::milliseconds cap) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty())
+    {
+        return cap;
+    }
+    auto wait = window_end_ - Clock::now();
+    if (wait <= Clock::duration::zero())
+    {
+        return std::chrono::milliseconds(0);
+    }
+    return std::min(cap, std::chrono::ceil<std::chrono::milliseconds>(wait));
+}
+
+std::string MoveBatcher::xbotName(const std::string &topic)
+{
+    size_t cmd = topic.rfind("/CMD/");
+    if (cmd == std::string::npos || cmd == 0)
+    {
+        return {};
+    }
+    size_t slash = topic.rfind('/', cmd - 1);
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+    return topic.substr(start, cmd - start);
+}
+
+bool MoveBatcher::resolveBatchTopic()
+{
+    if (!batch_topic_resolved_)
+    {
+        batch_topic_resolved_ = true;
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, config_.asset, {{"BatchMotion", "input"}});
+        if (topics[0].has_value())
+        {
+            setTopic("batch", topics[0].value());
+            has_batch_topic_ = true;
+        }
+        else
+        {
+            BT_LOG_WARN << "[MoveBatcher] " << config_.asset << " has no BatchMotion interface, moves are sent one by one";
+        }
+    }
+    return has_batch_topic_;
+}
+
+void MoveBatcher::publishSingle(const Move &move)
+{
+    nlohmann::json message;
+    message["Position"] = move.position;
+    message["Uuid"] = move.uuid;
+    message["TimeStamp"] = bt_utils::getCurrentTimestampISO();
+
+    setTopic("move", move.xbot_topic);
+    publish("move", message);
+}
+
+void MoveBatcher::publishBatch(const std::vector<Move> &moves)
+{
+    nlohmann::json message;
+    message["Moves"] = nlohmann::json::array();
+    for (const Move &move : moves)
+    {
+        std::string xbot = xbotName(move.xbot_topic.getTopic());
+        if (xbot.empty())
+        {
+            // Not a planar xbot topic; the planner could not route it back
+            BT_LOG_WARN << "[MoveBatcher] Sending move " << move.uuid << " on its own, no xbot in topic "
+                        << move.xbot_topic.getTopic();
+            publishSingle(move);
+            continue;
+        }
+        message["Moves"].push_back({{"Xbot", std::move(xbot)}, {"Position", move.position}, {"Uuid", move.uuid}});
+    }
+
+    if (message["Moves"].empty())
+    {
+        return;
+    }
+    message["Uuid"] = mqtt_utils::generate_uuid();
+    message["TimeStamp"] = bt_utils::getCurrentTimestampISO();
+
+    BT_LOG_INFO << "[MoveBatcher] Sending " << message["Moves"].size() << " moves as batch "
+                << message["Uuid"].get<std::string>() << " on " << topics_.find("batch")->second.getTopic();
+    publish("batch", message);
+}
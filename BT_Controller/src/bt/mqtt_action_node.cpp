@@ -2,12 +2,16 @@
 #include "mqtt/node_message_distributor.h"
 #include "mqtt/mqtt_client.h"
 #include "utils.h"
-#include <iostream>
+#include "metrics/latency_metrics.h"
+#include "logging/logger.h"
 #include <condition_variable>
 #include <mutex>
 
 void MqttActionNode::initialize()
 {
+    // Command responses carry the Uuid sent; the node claims it in onStart()
+    MqttSubBase::setCorrelatedTopic("output");
+
     // Call the virtual function - safe because construction is complete
     initializeTopicsFromAAS();
 
@@ -18,65 +22,169 @@ void MqttActionNode::initialize()
     }
 }
 
-bool MqttActionNode::ensureInitialized()
+LazyNodeInit::Status MqttActionNode::ensureInitialized()
 {
-    if (topics_initialized_)
+    if (!lazy_init_.inProgress() && topics_initialized_)
     {
-        return true;
+        return LazyNodeInit::Status::Ready;
     }
 
-    // Try lazy initialization
-    std::cout << "Node '" << this->name() << "' attempting lazy initialization..." << std::endl;
-    initializeTopicsFromAAS();
-
-    if (topics_initialized_ && MqttSubBase::node_message_distributor_)
-    {
-        // Use registerLateInitializingNode to subscribe to specific topics
-        // This triggers the broker to resend retained messages
-        bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
-        if (success)
-        {
-            std::cout << "Node '" << this->name() << "' lazy initialized and subscribed successfully" << std::endl;
-        }
-        else
-        {
-            std::cerr << "Node '" << this->name() << "' lazy init: subscription failed" << std::endl;
-        }
-    }
-    else if (!topics_initialized_)
+    if (!lazy_init_.inProgress())
     {
-        std::cerr << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured" << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' attempting lazy initialization...";
     }
 
-    return topics_initialized_;
+    // AAS lookups and the late subscription run off the tick thread; the tree is
+    // woken up once they are done
+    return lazy_init_.poll(
+        [this]()
+        {
+            initializeTopicsFromAAS();
+
+            if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+            {
+                // Use registerLateInitializingNode to subscribe to specific topics
+                // This triggers the broker to resend retained messages
+                bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
+                if (success)
+                {
+                    BT_LOG_INFO << "Node '" << this->name() << "' lazy initialized and subscribed successfully";
+                }
+                else
+                {
+                    BT_LOG_ERROR << "Node '" << this->name() << "' lazy init: subscription failed";
+                }
+            }
+            else if (!topics_initialized_)
+            {
+                BT_LOG_ERROR << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured";
+            }
+            return topics_initialized_;
+        },
+        [this]()
+        { emitWakeUpSignal(); });
 }
 
 MqttActionNode::~MqttActionNode()
 {
+    lazy_init_.wait();
     if (MqttSubBase::node_message_distributor_)
     {
         MqttSubBase::node_message_distributor_->unregisterInstance(this);
     }
 }
 
+bool MqttActionNode::refreshTopicsFromAAS()
+{
+    // A lazy initialization still running resolves against the refreshed cache anyway
+    if (lazy_init_.inProgress() || !topics_initialized_)
+    {
+        return false;
+    }
+
+    auto previous_sub_topics = MqttSubBase::topics_;
+    auto previous_pub_topics = MqttPubBase::topics_;
+    topics_initialized_ = false;
+    initializeTopicsFromAAS();
+    if (!topics_initialized_)
+    {
+        BT_LOG_ERROR << "Node '" << this->name() << "' keeps its previous topics, AAS refresh failed";
+        MqttSubBase::topics_ = std::move(previous_sub_topics);
+        MqttPubBase::topics_ = std::move(previous_pub_topics);
+        topics_initialized_ = true;
+        return false;
+    }
+    return true;
+}
+
 BT::NodeStatus MqttActionNode::onStart()
 {
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    awaiting_lazy_init_ = (init_status == LazyNodeInit::Status::Pending);
+    if (awaiting_lazy_init_)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto asset = getInput<std::string>("Asset");
-        std::cerr << "Node '" << this->name() << "' FAILED - could not initialize. "
-                  << "Asset=" << (asset.has_value() ? asset.value() : "<not set>") << std::endl;
+        BT_LOG_ERROR << "Node '" << this->name() << "' FAILED - could not initialize. "
+                     << "Asset=" << (asset.has_value() ? asset.value() : "<not set>");
         return BT::NodeStatus::FAILURE;
     }
     // Create the message to send
-    publish("input", createMessage());
+    command_sent_time_ = std::chrono::steady_clock::now();
+    publishCommand();
+    MqttSubBase::claimResponses(current_uuid_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        acknowledged_ = false;
+        deadline_.attempt = 0;
+        armCommandDeadline();
+    }
 
     return BT::NodeStatus::RUNNING;
 }
 
+void MqttActionNode::armCommandDeadline()
+{
+    CommandDeadlines *deadlines = CommandDeadline::installed();
+    if (!deadlines)
+    {
+        return;
+    }
+    const auto &config = deadlines->config();
+    auto timeout = acknowledged_
+                       ? std::chrono::milliseconds(config.completion_timeout_ms)
+                       : CommandDeadline::backoff(std::chrono::milliseconds(config.ack_timeout_ms),
+                                                  deadline_.attempt, config.backoff);
+    deadline_.arm(timeout, [this]()
+                  { onCommandDeadline(); });
+}
+
+void MqttActionNode::onCommandDeadline()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    CommandDeadlines *deadlines = CommandDeadline::installed();
+    // Answered, halted or re-armed by a response since the wheel fired
+    if (!deadlines || deadline_.armed() || current_uuid_.empty() || status() != BT::NodeStatus::RUNNING)
+    {
+        return;
+    }
+
+    int retries = deadlines->config().retries;
+    if (!acknowledged_ && deadline_.attempt < retries)
+    {
+        ++deadline_.attempt;
+        BT_LOG_WARN << "Node '" << this->name() << "' got no response to " << current_uuid_
+                    << ", resending (" << deadline_.attempt << "/" << retries << ")";
+        resendCommand();
+        MqttSubBase::claimResponses(current_uuid_);
+        armCommandDeadline();
+        return;
+    }
+
+    BT_LOG_ERROR << "Node '" << this->name() << "' FAILED - "
+                 << (acknowledged_ ? "no SUCCESS/FAILURE" : "no response") << " to command "
+                 << current_uuid_ << " before its deadline";
+    current_uuid_ = "";
+    setStatus(BT::NodeStatus::FAILURE);
+    emitWakeUpSignal();
+}
+
+void MqttActionNode::publishCommand()
+{
+    publish("input", createMessage());
+}
+
 BT::NodeStatus MqttActionNode::onRunning()
 {
+    if (awaiting_lazy_init_)
+    {
+        // Nothing was sent yet; retry the start once initialization has finished
+        return onStart();
+    }
     return status();
 }
 
@@ -97,7 +205,12 @@ nlohmann::json MqttActionNode::createMessage()
 void MqttActionNode::onHalted()
 {
     // Clean up when the node is halted
-    std::cout << "MQTT action node halted" << std::endl;
+    BT_LOG_INFO << "MQTT action node halted";
+    awaiting_lazy_init_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        deadline_.cancel();
+    }
     // Additional cleanup as needed
 }
 
@@ -113,23 +226,40 @@ void MqttActionNode::callback(const std::string &topic_key, const nlohmann::json
         {
             if (msg["Uuid"] == current_uuid_)
             {
-
-                if (msg["State"] == "FAILURE")
-                {
-                    current_uuid_ = "";
-                    setStatus(BT::NodeStatus::FAILURE);
-                }
-                else if (msg["State"] == "SUCCESS")
-                {
-                    current_uuid_ = "";
-                    setStatus(BT::NodeStatus::SUCCESS);
-                }
-                else if (msg["State"] == "RUNNING")
-                {
-                    setStatus(BT::NodeStatus::RUNNING);
-                }
+                handleCommandResponse(msg);
             }
             emitWakeUpSignal();
         }
     }
+}
+
+void MqttActionNode::handleCommandResponse(const nlohmann::json &msg)
+{
+    if (msg["State"] == "FAILURE" || msg["State"] == "SUCCESS")
+    {
+        deadline_.cancel();
+        LatencyMetrics::instance().record("action_response", this->name(),
+                                          std::chrono::steady_clock::now() - command_sent_time_);
+    }
+
+    if (msg["State"] == "FAILURE")
+    {
+        current_uuid_ = "";
+        setStatus(BT::NodeStatus::FAILURE);
+    }
+    else if (msg["State"] == "SUCCESS")
+    {
+        current_uuid_ = "";
+        setStatus(BT::NodeStatus::SUCCESS);
+    }
+    else if (msg["State"] == "RUNNING")
+    {
+        // The station has the command: from here on only the completion deadline applies
+        if (!acknowledged_)
+        {
+            acknowledged_ = true;
+            armCommandDeadline();
+        }
+        setStatus(BT::NodeStatus::RUNNING);
+    }
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include "mqtt/mqtt_pub_base.h"
-#include "aas/aas_interface_cache.h"
+#include "logging/logger.h"
 #include <fmt/chrono.h>
 #include <chrono>
 #include <utils.h>
@@ -35,12 +35,36 @@ void MqttDecorator::initialize()
 
 MqttDecorator::~MqttDecorator()
 {
+    lazy_init_.wait();
     if (MqttSubBase::node_message_distributor_)
     {
         MqttSubBase::node_message_distributor_->unregisterInstance(this);
     }
 }
 
+bool MqttDecorator::refreshTopicsFromAAS()
+{
+    // A lazy initialization still running resolves against the refreshed cache anyway
+    if (lazy_init_.inProgress() || !topics_initialized_)
+    {
+        return false;
+    }
+
+    auto previous_sub_topics = MqttSubBase::topics_;
+    auto previous_pub_topics = MqttPubBase::topics_;
+    topics_initialized_ = false;
+    initializeTopicsFromAAS();
+    if (!topics_initialized_)
+    {
+        BT_LOG_ERROR << "Node '" << this->name() << "' keeps its previous topics, AAS refresh failed";
+        MqttSubBase::topics_ = std::move(previous_sub_topics);
+        MqttPubBase::topics_ = std::move(previous_pub_topics);
+        topics_initialized_ = true;
+        return false;
+    }
+    return true;
+}
+
 void MqttDecorator::initializeTopicsFromAAS()
 {
     // Already initialized, skip
@@ -54,81 +78,79 @@ void MqttDecorator::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_id = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_id << std::endl;
-
-        // First, try to use the cached interfaces (fast path)
-        auto cache = MqttSubBase::getAASInterfaceCache();
-        if (cache)
-        {
-            auto cached_input = cache->getInterface(asset_id, this->name(), "input");
-            auto cached_output = cache->getInterface(asset_id, this->name(), "output");
-            if (cached_input.has_value() && cached_output.has_value())
-            {
-                std::cout << "Node '" << this->name() << "' using cached interfaces" << std::endl;
-                MqttPubBase::setTopic("input", cached_input.value());
-                MqttSubBase::setTopic("output", cached_output.value());
-                topics_initialized_ = true;
-                return;
-            }
-        }
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_id;
 
-        // Fall back to direct AAS query (slow path)
-        std::cout << "Node '" << this->name() << "' falling back to direct AAS query" << std::endl;
-        auto request_opt = aas_client_.fetchInterface(asset_id, this->name(), "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, this->name(), "output");
+        // Cache first; a miss fills the whole asset once instead of one query per endpoint
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id,
+                                                     {{this->name(), "input"}, {this->name(), "output"}});
 
-        if (!request_opt.has_value() || !response_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttSubBase::setTopic("output", topics[1].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
-bool MqttDecorator::ensureInitialized()
+LazyNodeInit::Status MqttDecorator::ensureInitialized()
 {
-    if (topics_initialized_)
+    if (!lazy_init_.inProgress() && topics_initialized_)
     {
-        return true;
+        resumed_from_lazy_init_ = false;
+        return LazyNodeInit::Status::Ready;
     }
 
-    // Try lazy initialization
-    std::cout << "Node '" << this->name() << "' attempting lazy initialization..." << std::endl;
-    initializeTopicsFromAAS();
-
-    if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+    if (!lazy_init_.inProgress())
     {
-        // Use registerLateInitializingNode to subscribe to specific topics
-        // This triggers the broker to resend retained messages
-        bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
-        if (success)
-        {
-            std::cout << "Node '" << this->name() << "' lazy initialized and subscribed successfully" << std::endl;
-        }
-        else
-        {
-            std::cerr << "Node '" << this->name() << "' lazy init: subscription failed" << std::endl;
-        }
-    }
-    else if (!topics_initialized_)
-    {
-        std::cerr << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured" << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' attempting lazy initialization...";
     }
 
-    return topics_initialized_;
+    // AAS lookups and the late subscription run off the tick thread; the tree is
+    // woken up once they are done
+    LazyNodeInit::Status init_status = lazy_init_.poll(
+        [this]()
+        {
+            initializeTopicsFromAAS();
+
+            if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+            {
+                // Use registerLateInitializingNode to subscribe to specific topics
+                // This triggers the broker to resend retained messages
+                bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
+                if (success)
+                {
+                    BT_LOG_INFO << "Node '" << this->name() << "' lazy initialized and subscribed successfully";
+                }
+                else
+                {
+                    BT_LOG_ERROR << "Node '" << this->name() << "' lazy init: subscription failed";
+                }
+            }
+            else if (!topics_initialized_)
+            {
+                BT_LOG_ERROR << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured";
+            }
+            return topics_initialized_;
+        },
+        [this]()
+        { emitWakeUpSignal(); });
+
+    // The node already returned RUNNING while waiting, so derived ticks cannot rely on IDLE
+    resumed_from_lazy_init_ = (init_status == LazyNodeInit::Status::Ready);
+    return init_status;
 }
 
 void MqttDecorator::halt()
@@ -155,6 +177,6 @@ void MqttDecorator::callback(const std::string &topic_key, const nlohmann::json
 {
     // Use mutex to protect shared state
     {
-        std::cout << "Callback of Base class used" << std::endl;
+        BT_LOG_INFO << "Callback of Base class used";
     }
 }
\ No newline at end of file
@@ -4,14 +4,14 @@
 #include <nlohmann/json.hpp>
 #include "bt/mqtt_sync_action_node.h"
 #include "aas/aas_client.h"
-#include "aas/aas_interface_cache.h"
+#include "logging/logger.h"
 
 MqttSyncActionNode::MqttSyncActionNode(
     const std::string &name,
     const BT::NodeConfig &config,
     MqttClient &mqtt_client,
     AASClient &aas_client)
-    : BT::SyncActionNode(name, config),
+    : BT::ActionNodeBase(name, config),
       MqttPubBase(mqtt_client),
       MqttSubBase(mqtt_client),
       aas_client_(aas_client)
@@ -32,12 +32,36 @@ void MqttSyncActionNode::initialize()
 
 MqttSyncActionNode::~MqttSyncActionNode()
 {
+    lazy_init_.wait();
     if (MqttSubBase::node_message_distributor_)
     {
         MqttSubBase::node_message_distributor_->unregisterInstance(this);
     }
 }
 
+bool MqttSyncActionNode::refreshTopicsFromAAS()
+{
+    // A lazy initialization still running resolves against the refreshed cache anyway
+    if (lazy_init_.inProgress() || !topics_initialized_)
+    {
+        return false;
+    }
+
+    auto previous_sub_topics = MqttSubBase::topics_;
+    auto previous_pub_topics = MqttPubBase::topics_;
+    topics_initialized_ = false;
+    initializeTopicsFromAAS();
+    if (!topics_initialized_)
+    {
+        BT_LOG_ERROR << "Node '" << this->name() << "' keeps its previous topics, AAS refresh failed";
+        MqttSubBase::topics_ = std::move(previous_sub_topics);
+        MqttPubBase::topics_ = std::move(previous_pub_topics);
+        topics_initialized_ = true;
+        return false;
+    }
+    return true;
+}
+
 json MqttSyncActionNode::createMessage()
 {
     // Default implementation
@@ -51,11 +75,16 @@ json MqttSyncActionNode::createMessage()
 BT::NodeStatus MqttSyncActionNode::tick()
 {
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto asset = getInput<std::string>("Asset");
-        std::cerr << "Node '" << this->name() << "' FAILED - could not initialize. "
-                  << "Asset=" << (asset.has_value() ? asset.value() : "<not set>") << std::endl;
+        BT_LOG_ERROR << "Node '" << this->name() << "' FAILED - could not initialize. "
+                     << "Asset=" << (asset.has_value() ? asset.value() : "<not set>");
         return BT::NodeStatus::FAILURE;
     }
     publish("input", createMessage());
@@ -80,84 +109,77 @@ void MqttSyncActionNode::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_name = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_name << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_name;
 
         // Check if already a full URL (starts with https:// or http://)
         std::string asset_id = asset_name;
 
-        // First, try to use the cached interfaces (fast path)
-        auto cache = MqttSubBase::getAASInterfaceCache();
-        if (cache)
-        {
-            auto cached_input = cache->getInterface(asset_id, this->name(), "input");
-            auto cached_output = cache->getInterface(asset_id, this->name(), "output");
-            if (cached_input.has_value() && cached_output.has_value())
-            {
-                std::cout << "Node '" << this->name() << "' using cached interfaces" << std::endl;
-                MqttPubBase::setTopic("input", cached_input.value());
-                MqttSubBase::setTopic("output", cached_output.value());
-                topics_initialized_ = true;
-                return;
-            }
-        }
-
-        // Fall back to direct AAS query (slow path)
-        std::cout << "Node '" << this->name() << "' falling back to direct AAS query" << std::endl;
-        auto request_opt = aas_client_.fetchInterface(asset_id, this->name(), "input");
-        auto response_opt = aas_client_.fetchInterface(asset_id, this->name(), "output");
+        // Cache first; a miss fills the whole asset once instead of one query per endpoint
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id,
+                                                     {{this->name(), "input"}, {this->name(), "output"}});
 
-        if (!request_opt.has_value() || !response_opt.has_value())
+        if (!topics[0].has_value() || !topics[1].has_value())
         {
-            std::cerr << "Failed to fetch interfaces from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interfaces from AAS for node: " << this->name();
             return;
         }
 
-        MqttPubBase::setTopic("input", request_opt.value());
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttPubBase::setTopic("input", topics[0].value());
+        MqttSubBase::setTopic("output", topics[1].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
-bool MqttSyncActionNode::ensureInitialized()
+LazyNodeInit::Status MqttSyncActionNode::ensureInitialized()
 {
-    if (topics_initialized_)
+    if (!lazy_init_.inProgress() && topics_initialized_)
     {
-        return true;
+        return LazyNodeInit::Status::Ready;
     }
 
-    // Try lazy initialization
-    std::cout << "Node '" << this->name() << "' attempting lazy initialization..." << std::endl;
-    initializeTopicsFromAAS();
-
-    if (topics_initialized_ && MqttSubBase::node_message_distributor_)
-    {
-        // Use registerLateInitializingNode to subscribe to specific topics
-        // This triggers the broker to resend retained messages
-        bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
-        if (success)
-        {
-            std::cout << "Node '" << this->name() << "' lazy initialized and subscribed successfully" << std::endl;
-        }
-        else
-        {
-            std::cerr << "Node '" << this->name() << "' lazy init: subscription failed" << std::endl;
-        }
-    }
-    else if (!topics_initialized_)
+    if (!lazy_init_.inProgress())
     {
-        std::cerr << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured" << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' attempting lazy initialization...";
     }
 
-    return topics_initialized_;
+    // AAS lookups and the late subscription run off the tick thread; the tree is
+    // woken up once they are done
+    return lazy_init_.poll(
+        [this]()
+        {
+            initializeTopicsFromAAS();
+
+            if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+            {
+                // Use registerLateInitializingNode to subscribe to specific topics
+                // This triggers the broker to resend retained messages
+                bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
+                if (success)
+                {
+                    BT_LOG_INFO << "Node '" << this->name() << "' lazy initialized and subscribed successfully";
+                }
+                else
+                {
+                    BT_LOG_ERROR << "Node '" << this->name() << "' lazy init: subscription failed";
+                }
+            }
+            else if (!topics_initialized_)
+            {
+                BT_LOG_ERROR << "Node '" << this->name() << "' lazy initialization FAILED - topics not configured";
+            }
+            return topics_initialized_;
+        },
+        [this]()
+        { emitWakeUpSignal(); });
 }
 
 // Standard implementation based on PackML override this if needed
@@ -165,7 +187,8 @@ void MqttSyncActionNode::callback(const std::string &topic_key, const json &msg,
 {
     // Use mutex to protect shared state
     {
-        std::cout << "Callback received for topic key: " << topic_key << std::endl;
+        BT_LOG_INFO << "Callback received for topic key: " << topic_key;
         setStatus(BT::NodeStatus::SUCCESS);
     }
+    emitWakeUpSignal();
 }
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include "bt/mqtt_sync_condition_node.h"
 #include "mqtt/node_message_distributor.h"
-#include "aas/aas_interface_cache.h"
-#include <iostream>
+#include "logging/logger.h"
 #include <thread>
 #include <chrono>
 
@@ -30,12 +29,34 @@ void MqttSyncConditionNode::initialize()
 
 MqttSyncConditionNode::~MqttSyncConditionNode()
 {
+    lazy_init_.wait();
     if (MqttSubBase::node_message_distributor_)
     {
         MqttSubBase::node_message_distributor_->unregisterInstance(this);
     }
 }
 
+bool MqttSyncConditionNode::refreshTopicsFromAAS()
+{
+    // A lazy initialization still running resolves against the refreshed cache anyway
+    if (lazy_init_.inProgress() || !topics_initialized_)
+    {
+        return false;
+    }
+
+    auto previous_topics = MqttSubBase::topics_;
+    topics_initialized_ = false;
+    initializeTopicsFromAAS();
+    if (!topics_initialized_)
+    {
+        BT_LOG_ERROR << "Node '" << this->name() << "' keeps its previous topics, AAS refresh failed";
+        MqttSubBase::topics_ = std::move(previous_topics);
+        topics_initialized_ = true;
+        return false;
+    }
+    return true;
+}
+
 void MqttSyncConditionNode::initializeTopicsFromAAS()
 {
     // Already initialized, skip
@@ -49,97 +70,92 @@ void MqttSyncConditionNode::initializeTopicsFromAAS()
         auto asset_input = getInput<std::string>("Asset");
         if (!asset_input.has_value())
         {
-            std::cerr << "Node '" << this->name() << "' has no Asset input configured" << std::endl;
+            BT_LOG_ERROR << "Node '" << this->name() << "' has no Asset input configured";
             return;
         }
 
         std::string asset_name = asset_input.value();
-        std::cout << "Node '" << this->name() << "' initializing for Asset: " << asset_name << std::endl;
+        BT_LOG_INFO << "Node '" << this->name() << "' initializing for Asset: " << asset_name;
 
         // Check if already a full URL (starts with https:// or http://)
         std::string asset_id = asset_name;
 
-        // First, try to use the cached interface (fast path)
-        auto cache = MqttSubBase::getAASInterfaceCache();
-        if (cache)
-        {
-            auto cached_interface = cache->getInterface(asset_id, this->name(), "output");
-            if (cached_interface.has_value())
-            {
-                std::cout << "Node '" << this->name() << "' using cached interface" << std::endl;
-                MqttSubBase::setTopic("output", cached_interface.value());
-                topics_initialized_ = true;
-                return;
-            }
-        }
+        // Cache first, filling the asset once on a miss
+        auto topics = MqttSubBase::resolveInterfaces(aas_client_, asset_id, {{this->name(), "output"}});
 
-        // Fall back to direct AAS query (slow path)
-        std::cout << "Node '" << this->name() << "' falling back to direct AAS query" << std::endl;
-        auto response_opt = aas_client_.fetchInterface(asset_id, this->name(), "output");
-
-        if (!response_opt.has_value())
+        if (!topics[0].has_value())
         {
-            std::cerr << "Failed to fetch interface from AAS for node: " << this->name() << std::endl;
+            BT_LOG_ERROR << "Failed to fetch interface from AAS for node: " << this->name();
             return;
         }
 
-        MqttSubBase::setTopic("output", response_opt.value());
+        MqttSubBase::setTopic("output", topics[0].value());
         topics_initialized_ = true;
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Exception initializing topics from AAS: " << e.what() << std::endl;
+        BT_LOG_ERROR << "Exception initializing topics from AAS: " << e.what();
     }
 }
 
-bool MqttSyncConditionNode::ensureInitialized()
+LazyNodeInit::Status MqttSyncConditionNode::ensureInitialized()
 {
-    if (topics_initialized_)
+    if (!lazy_init_.inProgress() && topics_initialized_)
     {
-        return true;
+        return LazyNodeInit::Status::Ready;
     }
 
-    // Try lazy initialization
-    std::cout << "[MqttSyncConditionNode] Node '" << this->name() << "' attempting lazy initialization..." << std::endl;
-    initializeTopicsFromAAS();
-
-    if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+    if (!lazy_init_.inProgress())
     {
-        // Use registerLateInitializingNode to subscribe to specific topics
-        // This triggers the broker to resend retained messages
-        std::cout << "[MqttSyncConditionNode] Node '" << this->name() << "' registering for late subscription..." << std::endl;
-        auto start_time = std::chrono::steady_clock::now();
-        
-        bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
-        
-        auto sub_time = std::chrono::steady_clock::now();
-        auto sub_ms = std::chrono::duration_cast<std::chrono::milliseconds>(sub_time - start_time).count();
-        
-        if (success)
-        {
-            std::cout << "[MqttSyncConditionNode] Node '" << this->name() 
-                      << "' lazy initialized and subscribed successfully (took " << sub_ms << "ms)" << std::endl;
-
-            // Wait briefly for retained messages to arrive after subscription
-            // The MQTT broker sends retained messages asynchronously after subscription completes,
-            // so we need a small delay to allow them to be delivered before the first tick
-            std::cout << "[MqttSyncConditionNode] Node '" << this->name() 
-                      << "' waiting 50ms for retained messages..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            std::cout << "[MqttSyncConditionNode] Node '" << this->name() 
-                      << "' wait complete, returning from ensureInitialized()" << std::endl;
-        }
-        else
-        {
-            std::cerr << "[MqttSyncConditionNode] Node '" << this->name() << "' lazy init: subscription failed" << std::endl;
-        }
-    }
-    else if (!topics_initialized_)
-    {
-        std::cerr << "[MqttSyncConditionNode] Node '" << this->name() << "' lazy initialization FAILED - topics not configured" << std::endl;
+        BT_LOG_INFO << "[MqttSyncConditionNode] Node '" << this->name() << "' attempting lazy initialization...";
     }
 
-    return topics_initialized_;
+    // AAS lookups and the late subscription run off the tick thread; the tree is
+    // woken up once they are done
+    return lazy_init_.poll(
+        [this]()
+        {
+            initializeTopicsFromAAS();
+
+            if (topics_initialized_ && MqttSubBase::node_message_distributor_)
+            {
+                // Use registerLateInitializingNode to subscribe to specific topics
+                // This triggers the broker to resend retained messages
+                BT_LOG_INFO << "[MqttSyncConditionNode] Node '" << this->name() << "' registering for late subscription...";
+                auto start_time = std::chrono::steady_clock::now();
+
+                bool success = MqttSubBase::node_message_distributor_->registerLateInitializingNode(this);
+
+                auto sub_time = std::chrono::steady_clock::now();
+                auto sub_ms = std::chrono::duration_cast<std::chrono::milliseconds>(sub_time - start_time).count();
+
+                if (success)
+                {
+                    BT_LOG_INFO << "[MqttSyncConditionNode] Node '" << this->name()
+                                << "' lazy initialized and subscribed successfully (took " << sub_ms << "ms)";
+
+                    // Wait briefly for retained messages to arrive after subscription
+                    // The MQTT broker sends retained messages asynchronously after subscription completes,
+                    // so we need a small delay to allow them to be delivered before the first tick
+                    BT_LOG_INFO << "[MqttSyncConditionNode] Node '" << this->name()
+                                << "' waiting 50ms for retained messages...";
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    BT_LOG_INFO << "[MqttSyncConditionNode] Node '" << this->name()
+                                << "' wait complete, returning from ensureInitialized()";
+                }
+                else
+                {
+                    BT_LOG_ERROR << "[MqttSyncConditionNode] Node '" << this->name() << "' lazy init: subscription failed";
+                }
+            }
+            else if (!topics_initialized_)
+            {
+                BT_LOG_ERROR << "[MqttSyncConditionNode] Node '" << this->name() << "' lazy initialization FAILED - topics not configured";
+            }
+            return topics_initialized_;
+        },
+        [this]()
+        { emitWakeUpSignal(); });
 }
 
 BT::PortsList MqttSyncConditionNode::providedPorts()
@@ -149,19 +165,27 @@ BT::PortsList MqttSyncConditionNode::providedPorts()
 
 void MqttSyncConditionNode::callback(const std::string &topic_key, const json &msg, mqtt::properties props)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    latest_msg_ = msg;
-    std::cout << "Sync subscription node received message" << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_msg_ = msg;
+    }
+    BT_LOG_INFO << "Sync subscription node received message";
+    emitWakeUpSignal();
 }
 
 BT::NodeStatus MqttSyncConditionNode::tick()
 {
     // Ensure lazy initialization is done
-    if (!ensureInitialized())
+    LazyNodeInit::Status init_status = ensureInitialized();
+    if (init_status == LazyNodeInit::Status::Pending)
+    {
+        return BT::NodeStatus::RUNNING;
+    }
+    if (init_status == LazyNodeInit::Status::Failed)
     {
         auto asset = getInput<std::string>("Asset");
-        std::cerr << "Node '" << this->name() << "' FAILED - could not initialize. "
-                  << "Asset=" << (asset.has_value() ? asset.value() : "<not set>") << std::endl;
+        BT_LOG_ERROR << "Node '" << this->name() << "' FAILED - could not initialize. "
+                     << "Asset=" << (asset.has_value() ? asset.value() : "<not set>");
         return BT::NodeStatus::FAILURE;
     }
     return BT::NodeStatus::SUCCESS; // Default implementation
@@ -0,0 +1,64 @@
+#include "bt/product_queue.h"
+
+#include <algorithm>
+
+ProductQueue::ProductQueue(std::vector<std::string> ids)
+    : ids_(std::move(ids))
+{
+}
+
+bool ProductQueue::pop(std::string &id)
+{
+    // Nothing is ever pushed, so the cursor may run past the end; size() clamps it
+    size_t next = next_.fetch_add(1, std::memory_order_relaxed);
+    if (next >= ids_.size())
+    {
+        return false;
+    }
+    id = ids_[next];
+    return true;
+}
+
+std::vector<std::string> ProductQueue::reserve(size_t count)
+{
+    size_t next = next_.load(std::memory_order_relaxed);
+    size_t taken = 0;
+    do
+    {
+        taken = std::min(count, ids_.size() - std::min(next, ids_.size()));
+        if (taken == 0)
+        {
+            return {};
+        }
+    } while (!next_.compare_exchange_weak(next, next + taken, std::memory_order_relaxed));
+
+    return std::vector<std::string>(ids_.begin() + next, ids_.begin() + next + taken);
+}
+
+const std::string *ProductQueue::peek() const
+{
+    size_t next = next_.load(std::memory_order_relaxed);
+    return next < ids_.size() ? &ids_[next] : nullptr;
+}
+
+size_t ProductQueue::size() const
+{
+    return ids_.size() - std::min(next_.load(std::memory_order_relaxed), ids_.size());
+}
+
+namespace BT
+{
+    template <>
+    ProductQueuePtr convertFromString<ProductQueuePtr>(StringView str)
+    {
+        std::vector<std::string> ids;
+        for (StringView part : splitString(str, ';'))
+        {
+            if (!part.empty())
+            {
+                ids.emplace_back(part);
+            }
+        }
+        return std::make_shared<ProductQueue>(std::move(ids));
+    }
+}
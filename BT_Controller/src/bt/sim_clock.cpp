@@ -0,0 +1,176 @@
+#include "bt/sim_clock.h"
+#include "logging/logger.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using SystemClock = std::chrono::system_clock;
+
+    SystemClock::rep initialDateOffset()
+    {
+        auto offset = SystemClock::now().time_since_epoch() -
+                      std::chrono::duration_cast<SystemClock::duration>(std::chrono::steady_clock::now().time_since_epoch());
+        return offset.count();
+    }
+}
+
+std::atomic<SimClock::Mode> SimClock::mode_{SimClock::Mode::Wall};
+std::mutex SimClock::mutex_;
+SimClock::Anchor SimClock::anchor_;
+bool SimClock::synced_ = false;
+std::atomic<SimClock::rep> SimClock::latest_{0};
+std::atomic<std::chrono::system_clock::rep> SimClock::date_offset_{initialDateOffset()};
+
+SimClock::time_point SimClock::virtualNow(const Anchor &anchor, time_point wall_now)
+{
+    auto elapsed = std::chrono::duration<double, std::nano>(wall_now - anchor.wall_start) * anchor.speed;
+    return anchor.virtual_start + std::chrono::duration_cast<duration>(elapsed);
+}
+
+SimClock::time_point SimClock::now()
+{
+    if (mode() == Mode::Wall)
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    time_point candidate;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        candidate = virtualNow(anchor_, std::chrono::steady_clock::now());
+    }
+    rep value = candidate.time_since_epoch().count();
+    rep latest = latest_.load(std::memory_order_relaxed);
+    while (value > latest && !latest_.compare_exchange_weak(latest, value, std::memory_order_relaxed))
+    {
+    }
+    return time_point(duration(std::max(value, latest)));
+}
+
+std::chrono::system_clock::time_point SimClock::systemNow()
+{
+    if (mode() == Mode::Wall)
+    {
+        return std::chrono::system_clock::now();
+    }
+    auto offset = SystemClock::duration(date_offset_.load(std::memory_order_relaxed));
+    return SystemClock::time_point(std::chrono::duration_cast<SystemClock::duration>(now().time_since_epoch()) + offset);
+}
+
+double SimClock::speed()
+{
+    if (mode() == Mode::Wall)
+    {
+        return 1.0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return anchor_.speed;
+}
+
+std::chrono::milliseconds SimClock::toWall(std::chrono::milliseconds virtual_timeout)
+{
+    double current = speed();
+    if (current == 1.0 || current <= 0.0 || virtual_timeout <= std::chrono::milliseconds(0))
+    {
+        // A paused simulator still gets polled at the virtual timeout
+        return virtual_timeout;
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(std::ceil(virtual_timeout.count() / current)));
+}
+
+void SimClock::configure(const bt_utils::SimClockConfig &config)
+{
+    Mode mode = parseMode(config.mode).value_or(Mode::Wall);
+    if (!parseMode(config.mode))
+    {
+        BT_LOG_WARN << "[SimClock] Unknown mode '" << config.mode << "', using wall time";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto wall_now = std::chrono::steady_clock::now();
+    // Continue from the current (possibly virtual) time, so time points taken so far stay valid
+    time_point start = mode_.load() == Mode::Wall ? wall_now : std::max(virtualNow(anchor_, wall_now),
+                                                                       time_point(duration(latest_.load())));
+    anchor_ = Anchor{wall_now, start, mode == Mode::Wall ? 1.0 : std::max(config.speed, 0.0)};
+    latest_.store(start.time_since_epoch().count());
+    synced_ = false;
+    mode_.store(mode, std::memory_order_release);
+
+    if (mode != Mode::Wall)
+    {
+        BT_LOG_INFO << "[SimClock] " << modeName(mode) << " time at " << anchor_.speed << "x"
+                    << (mode == Mode::Driven ? " until the first clock message on " + config.topic : std::string());
+    }
+}
+
+bool SimClock::sync(const nlohmann::json &clock_message)
+{
+    auto sim_time = clock_message.find("SimTime");
+    if (sim_time == clock_message.end() || !sim_time->is_number())
+    {
+        return false;
+    }
+    double seconds = sim_time->get<double>();
+    double reported_speed = clock_message.value("Speed", speed());
+    auto date = SystemClock::time_point(
+        std::chrono::duration_cast<SystemClock::duration>(std::chrono::duration<double>(seconds)));
+    sync(date, reported_speed);
+    return true;
+}
+
+void SimClock::sync(std::chrono::system_clock::time_point sim_time, double speed)
+{
+    if (mode() != Mode::Driven)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto wall_now = std::chrono::steady_clock::now();
+    if (!synced_)
+    {
+        // The first message only dates the clock; the timeline itself stays continuous
+        time_point current = std::max(virtualNow(anchor_, wall_now), time_point(duration(latest_.load())));
+        auto offset = sim_time.time_since_epoch() - std::chrono::duration_cast<SystemClock::duration>(current.time_since_epoch());
+        date_offset_.store(offset.count(), std::memory_order_relaxed);
+        synced_ = true;
+        BT_LOG_INFO << "[SimClock] Following the simulator clock at " << speed << "x";
+    }
+    auto offset = SystemClock::duration(date_offset_.load(std::memory_order_relaxed));
+    auto virtual_start = time_point(std::chrono::duration_cast<duration>(sim_time.time_since_epoch() - offset));
+    anchor_ = Anchor{wall_now, virtual_start, std::max(speed, 0.0)};
+}
+
+std::optional<SimClock::Mode> SimClock::parseMode(const std::string &name)
+{
+    if (name == "wall")
+    {
+        return Mode::Wall;
+    }
+    if (name == "scaled")
+    {
+        return Mode::Scaled;
+    }
+    if (name == "driven")
+    {
+        return Mode::Driven;
+    }
+    return std::nullopt;
+}
+
+const char *SimClock::modeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::Scaled:
+        return "scaled";
+    case Mode::Driven:
+        return "driven";
+    case Mode::Wall:
+    default:
+        return "wall";
+    }
+}
@@ -0,0 +1,199 @@
+#include "bt/tick_pool.h"
+#include "logging/logger.h"
+
+TickPool &TickPool::instance()
+{
+    static TickPool pool;
+    return pool;
+}
+
+TickPool::~TickPool()
+{
+    stopWorkers();
+}
+
+void TickPool::configure(size_t workers)
+{
+    std::unique_lock<std::mutex> lock(config_mutex_);
+    if (workers == workers_.size())
+    {
+        return;
+    }
+    stopWorkers();
+
+    {
+        std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+        stopping_ = false;
+        pending_ = 0;
+    }
+    for (size_t i = 0; i < workers; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workers; ++i)
+    {
+        workers_[i]->thread = std::thread(&TickPool::workerLoop, this, i);
+    }
+    BT_LOG_INFO << "TickPool: " << workers << " worker threads";
+}
+
+size_t TickPool::workerCount() const
+{
+    std::lock_guard<std::mutex> lock(config_mutex_);
+    return workers_.size();
+}
+
+void TickPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto &worker : workers_)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+}
+
+void TickPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (workers_.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->task = &task;
+    batch->remaining = count;
+
+    // Index 0 stays with the caller; the rest are dealt round-robin from a rotating start
+    // so concurrent batches don't all pile onto worker 0
+    size_t start = next_worker_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 1; i < count; ++i)
+    {
+        Worker &worker = *workers_[(start + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back({batch, i});
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        pending_ += count - 1;
+    }
+    wake_cv_.notify_all();
+
+    Task own{batch, 0};
+    execute(own);
+
+    // Help with whatever is still queued instead of only waiting on it
+    Task stolen;
+    while (batch->remaining.load(std::memory_order_acquire) > 0 && steal(workers_.size(), stolen))
+    {
+        execute(stolen);
+    }
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch]
+                     { return batch->remaining.load(std::memory_order_acquire) == 0; });
+}
+
+bool TickPool::popOwn(size_t worker, Task &task)
+{
+    Worker &own = *workers_[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(own.tasks.front());
+    own.tasks.pop_front();
+    return true;
+}
+
+bool TickPool::steal(size_t thief, Task &task)
+{
+    // thief == workers_.size() is a calling thread, which owns no deque
+    for (size_t offset = 1; offset <= workers_.size(); ++offset)
+    {
+        size_t victim = (thief + offset) % workers_.size();
+        if (victim == thief)
+        {
+            continue;
+        }
+        Worker &other = *workers_[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty())
+        {
+            task = std::move(other.tasks.back());
+            other.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TickPool::execute(Task &task)
+{
+    if (task.index != 0)
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        pending_--;
+    }
+
+    try
+    {
+        (*task.batch->task)(task.index);
+    }
+    catch (const std::exception &e)
+    {
+        // Tasks report their own errors; one must not leave the batch waiting forever
+        BT_LOG_ERROR << "TickPool: task threw: " << e.what();
+    }
+
+    if (task.batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard<std::mutex> lock(task.batch->mutex);
+        task.batch->done.notify_all();
+    }
+    task.batch.reset();
+}
+
+void TickPool::workerLoop(size_t worker)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait(lock, [this]
+                          { return stopping_ || pending_ > 0; });
+            if (stopping_)
+            {
+                return;
+            }
+        }
+
+        Task task;
+        if (popOwn(worker, task) || steal(worker, task))
+        {
+            execute(task);
+        }
+        else
+        {
+            // Another thread took the last task between the wake-up and the pop
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include "bt/tree_template_cache.h"
+#include "http/http_transport.h"
+
+#include <iostream>
+#include <vector>
+
+std::shared_ptr<BT::XMLParser> TreeTemplateCache::load(const std::string &url, const BT::BehaviorTreeFactory &factory)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry &entry = entries_[url];
+    bool have_copy = !entry.xml.empty();
+
+    std::vector<std::string> headers;
+    if (have_copy && !entry.etag.empty())
+    {
+        headers.push_back("If-None-Match: " + entry.etag);
+    }
+    if (have_copy && !entry.last_modified.empty())
+    {
+        headers.push_back("If-Modified-Since: " + entry.last_modified);
+    }
+
+    std::cout << (have_copy ? "Revalidating BT description: " : "Fetching BT description: ") << url << std::endl;
+    HttpResponse response = HttpTransport::instance().get(url, headers, 30);
+
+    if (response.curl_code == CURLE_OK && response.status == 304 && have_copy)
+    {
+        std::cout << "BT description unchanged (304), using cached copy" << std::endl;
+    }
+    else if (response.ok() && !response.body.empty())
+    {
+        auto etag = response.headers.find("etag");
+        entry.etag = etag != response.headers.end() ? etag->second : "";
+        auto last_modified = response.headers.find("last-modified");
+        entry.last_modified = last_modified != response.headers.end() ? last_modified->second : "";
+
+        if (response.body == entry.xml)
+        {
+            std::cout << "BT description unchanged, using cached copy" << std::endl;
+        }
+        else
+        {
+            std::cout << "Fetched BT description (" << response.body.size() << " bytes)" << std::endl;
+            entry.xml = std::move(response.body);
+            entry.parsed.reset();
+        }
+    }
+    else if (have_copy)
+    {
+        std::cerr << "Could not revalidate BT description " << url << " (CURL: " << response.error()
+                  << ", HTTP " << response.status << "), using cached copy" << std::endl;
+    }
+    else
+    {
+        std::cerr << "Failed to fetch BT description " << url << " (CURL: " << response.error()
+                  << ", HTTP " << response.status << ")" << std::endl;
+        entries_.erase(url);
+        return nullptr;
+    }
+
+    if (!entry.parsed)
+    {
+        auto parser = std::make_shared<BT::XMLParser>(factory);
+        parser->loadFromText(entry.xml);
+        entry.parsed = std::move(parser);
+    }
+    return entry.parsed;
+}
+
+void TreeTemplateCache::dropParsed()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &[url, entry] : entries_)
+    {
+        entry.parsed.reset();
+    }
+}
@@ -0,0 +1,187 @@
+#include "http/http_transport.h"
+#include "metrics/span_trace.h"
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp)
+    {
+        static_cast<std::string *>(userp)->append(static_cast<char *>(contents), size * nmemb);
+        return size * nmemb;
+    }
+
+    size_t headerCallback(char *buffer, size_t size, size_t nitems, void *userp)
+    {
+        size_t length = size * nitems;
+        std::string line(buffer, length);
+        auto *headers = static_cast<std::map<std::string, std::string> *>(userp);
+
+        auto colon = line.find(':');
+        if (colon != std::string::npos)
+        {
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c)
+                           { return std::tolower(c); });
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t\r\n") + 1);
+            (*headers)[name] = value;
+        }
+        return length;
+    }
+}
+
+HttpTransport &HttpTransport::instance()
+{
+    static HttpTransport transport;
+    return transport;
+}
+
+HttpTransport::HttpTransport()
+{
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    share_ = curl_share_init();
+    if (share_)
+    {
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 // 7.57.0: connection cache sharing
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    }
+
+    json_headers_ = curl_slist_append(nullptr, "Accept: application/json");
+}
+
+HttpTransport::~HttpTransport()
+{
+    for (CURL *handle : idle_handles_)
+    {
+        curl_easy_cleanup(handle);
+    }
+    idle_handles_.clear();
+
+    if (share_)
+    {
+        curl_share_cleanup(share_);
+    }
+    curl_slist_free_all(json_headers_);
+    curl_global_cleanup();
+}
+
+void HttpTransport::lockShare(CURL *, curl_lock_data data, curl_lock_access, void *userptr)
+{
+    auto *self = static_cast<HttpTransport *>(userptr);
+    self->share_mutexes_[data].lock();
+}
+
+void HttpTransport::unlockShare(CURL *, curl_lock_data data, void *userptr)
+{
+    auto *self = static_cast<HttpTransport *>(userptr);
+    self->share_mutexes_[data].unlock();
+}
+
+CURL *HttpTransport::acquireHandle()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (!idle_handles_.empty())
+        {
+            CURL *handle = idle_handles_.back();
+            idle_handles_.pop_back();
+            return handle;
+        }
+    }
+    return curl_easy_init();
+}
+
+void HttpTransport::releaseHandle(CURL *handle)
+{
+    if (!handle)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (idle_handles_.size() < kMaxIdleHandles)
+    {
+        idle_handles_.push_back(handle);
+        return;
+    }
+    curl_easy_cleanup(handle);
+}
+
+HttpResponse HttpTransport::get(const std::string &url,
+                                const std::vector<std::string> &headers,
+                                long timeout_seconds)
+{
+    struct curl_slist *header_list = nullptr;
+    for (const auto &header : headers)
+    {
+        header_list = curl_slist_append(header_list, header.c_str());
+    }
+
+    HttpResponse response = perform(url, header_list, timeout_seconds);
+    curl_slist_free_all(header_list);
+    return response;
+}
+
+HttpResponse HttpTransport::getJson(const std::string &url, long timeout_seconds)
+{
+    return perform(url, json_headers_, timeout_seconds);
+}
+
+HttpResponse HttpTransport::perform(const std::string &url, const curl_slist *header_list, long timeout_seconds)
+{
+    HttpResponse response;
+    TraceSpan span("GET", "http");
+    span.attr("url", url);
+
+    CURL *curl = acquireHandle();
+    if (!curl)
+    {
+        response.curl_code = CURLE_FAILED_INIT;
+        return response;
+    }
+
+    // Reset per-request state from the previous user; the connection itself stays cached
+    curl_easy_reset(curl);
+    if (share_)
+    {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_seconds);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, ""); // Every encoding libcurl supports (gzip, deflate, ...)
+
+    if (header_list)
+    {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    }
+
+    response.curl_code = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    if (span.recording())
+    {
+        span.attr("status", std::to_string(response.status));
+        span.attr("bytes", std::to_string(response.body.size()));
+    }
+
+    releaseHandle(curl);
+
+    return response;
+}
@@ -0,0 +1,292 @@
+#include "logging/logger.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace logging
+{
+    namespace detail
+    {
+        std::atomic<Level> runtime_level{Level::Info};
+    }
+
+    namespace
+    {
+        /**
+         * Bounded multi-producer ring (Vyukov): each slot's sequence says whether it is free
+         * for the producer at that position or filled for the consumer. Producers claim a
+         * position with one CAS; the single writer thread drains in order.
+         */
+        class Backend
+        {
+        public:
+            static constexpr size_t kSlots = 4096; // Power of two
+
+            Backend()
+            {
+                for (size_t i = 0; i < kSlots; ++i)
+                {
+                    slots_[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                writer_ = std::thread(&Backend::writerLoop, this);
+            }
+
+            // Never destroyed: lines logged during static destruction still get written
+            static Backend &instance()
+            {
+                static Backend *backend = []
+                {
+                    auto *created = new Backend();
+                    std::atexit([]
+                                { Backend::instance().stop(); });
+                    return created;
+                }();
+                return *backend;
+            }
+
+            void submit(Level level, std::chrono::system_clock::time_point time, const char *text, size_t length)
+            {
+                if (stopped_.load(std::memory_order_acquire))
+                {
+                    // After shutdown there is no writer thread; write in place
+                    std::lock_guard<std::mutex> lock(write_mutex_);
+                    writeLine(level, time, text, length);
+                    flushStreams();
+                    return;
+                }
+
+                size_t position = enqueue_position_.load(std::memory_order_relaxed);
+                Slot *slot;
+                while (true)
+                {
+                    slot = &slots_[position & (kSlots - 1)];
+                    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                    if (difference == 0)
+                    {
+                        if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (difference < 0)
+                    {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    else
+                    {
+                        position = enqueue_position_.load(std::memory_order_relaxed);
+                    }
+                }
+
+                slot->level = level;
+                slot->time = time;
+                slot->length = length;
+                std::memcpy(slot->text, text, length);
+                slot->sequence.store(position + 1, std::memory_order_release);
+            }
+
+            void flush()
+            {
+                size_t target = enqueue_position_.load(std::memory_order_acquire);
+                while (!stopped_.load(std::memory_order_acquire) &&
+                       written_position_.load(std::memory_order_acquire) < target)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            Stats stats() const
+            {
+                return {written_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed)};
+            }
+
+        private:
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                Level level;
+                std::chrono::system_clock::time_point time;
+                size_t length;
+                char text[Line::kCapacity];
+            };
+
+            void stop()
+            {
+                bool expected = false;
+                if (stopping_.compare_exchange_strong(expected, true) && writer_.joinable())
+                {
+                    writer_.join();
+                }
+                stopped_.store(true, std::memory_order_release);
+            }
+
+            void writerLoop()
+            {
+                while (true)
+                {
+                    bool stopping = stopping_.load(std::memory_order_acquire);
+                    size_t drained = drain();
+                    if (drained == 0)
+                    {
+                        if (stopping)
+                        {
+                            return;
+                        }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    }
+                }
+            }
+
+            // Write every filled slot in order, then flush once for the whole batch
+            size_t drain()
+            {
+                size_t count = 0;
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                while (true)
+                {
+                    Slot &slot = slots_[dequeue_position_ & (kSlots - 1)];
+                    if (slot.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1)
+                    {
+                        break;
+                    }
+                    writeLine(slot.level, slot.time, slot.text, slot.length);
+                    slot.sequence.store(dequeue_position_ + kSlots, std::memory_order_release);
+                    ++dequeue_position_;
+                    ++count;
+                }
+
+                uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+                bool report_drops = dropped != reported_dropped_;
+                if (report_drops)
+                {
+                    std::fprintf(stderr, "[logging] %llu line(s) dropped, log ring full\n",
+                                 static_cast<unsigned long long>(dropped - reported_dropped_));
+                    reported_dropped_ = dropped;
+                    wrote_stderr_ = true;
+                }
+
+                if (count > 0 || report_drops)
+                {
+                    flushStreams();
+                    written_.fetch_add(count, std::memory_order_relaxed);
+                    written_position_.store(dequeue_position_, std::memory_order_release);
+                }
+                return count;
+            }
+
+            // "[HH:MM:SS.mmm] text\n"; localtime runs once per second of log time, not per line
+            void writeLine(Level level, std::chrono::system_clock::time_point time, const char *text, size_t length)
+            {
+                auto since_epoch = time.time_since_epoch();
+                auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+                auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch - seconds).count();
+                if (seconds.count() != cached_second_)
+                {
+                    std::time_t t = static_cast<std::time_t>(seconds.count());
+                    std::tm tm{};
+                    localtime_r(&t, &tm);
+                    std::strftime(cached_clock_, sizeof(cached_clock_), "%H:%M:%S", &tm);
+                    cached_second_ = seconds.count();
+                }
+
+                std::FILE *stream = level >= Level::Warn ? stderr : stdout;
+                std::fprintf(stream, "[%s.%03d] ", cached_clock_, static_cast<int>(millis));
+                std::fwrite(text, 1, length, stream);
+                std::fputc('\n', stream);
+                (level >= Level::Warn ? wrote_stderr_ : wrote_stdout_) = true;
+            }
+
+            void flushStreams()
+            {
+                if (wrote_stdout_)
+                {
+                    std::fflush(stdout);
+                    wrote_stdout_ = false;
+                }
+                if (wrote_stderr_)
+                {
+                    std::fflush(stderr);
+                    wrote_stderr_ = false;
+                }
+            }
+
+            std::array<Slot, kSlots> slots_;
+            alignas(64) std::atomic<size_t> enqueue_position_{0};
+            alignas(64) size_t dequeue_position_ = 0; // Writer thread only
+            std::atomic<size_t> written_position_{0};
+            std::atomic<uint64_t> written_{0};
+            std::atomic<uint64_t> dropped_{0};
+            uint64_t reported_dropped_ = 0;
+
+            std::mutex write_mutex_; // Writer thread vs. in-place writes after shutdown
+            int64_t cached_second_ = -1;
+            char cached_clock_[16] = {0};
+            bool wrote_stdout_ = false;
+            bool wrote_stderr_ = false;
+
+            std::atomic<bool> stopping_{false};
+            std::atomic<bool> stopped_{false};
+            std::thread writer_;
+        };
+    }
+
+    std::optional<Level> parseLevel(const std::string &name)
+    {
+        if (name == "trace")
+            return Level::Trace;
+        if (name == "debug")
+            return Level::Debug;
+        if (name == "info")
+            return Level::Info;
+        if (name == "warn" || name == "warning")
+            return Level::Warn;
+        if (name == "error")
+            return Level::Error;
+        if (name == "off")
+            return Level::Off;
+        return std::nullopt;
+    }
+
+    void setLevel(Level level)
+    {
+        detail::runtime_level.store(level, std::memory_order_relaxed);
+    }
+
+    void flush()
+    {
+        Backend::instance().flush();
+    }
+
+    Stats stats()
+    {
+        return Backend::instance().stats();
+    }
+
+    Line::~Line()
+    {
+        if (truncated_ && length_ >= 3)
+        {
+            std::memcpy(buffer_ + length_ - 3, "...", 3);
+        }
+        Backend::instance().submit(level_, time_, buffer_, length_);
+    }
+
+    void Line::append(const char *data, size_t size)
+    {
+        size_t room = kCapacity - length_;
+        if (size > room)
+        {
+            size = room;
+            truncated_ = true;
+        }
+        std::memcpy(buffer_ + length_, data, size);
+        length_ += size;
+    }
+}
@@ -0,0 +1,183 @@
+#include "metrics/command_trace.h"
+#include "metrics/latency_metrics.h"
+#include "logging/logger.h"
+
+#include <mqtt/async_client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+    constexpr const char *kIdProperty = "trace-id";
+    constexpr const char *kSentProperty = "trace-sent";
+    constexpr const char *kReceivedProperty = "trace-received";
+    constexpr const char *kStartedProperty = "trace-started";
+    constexpr const char *kCompletedProperty = "trace-completed";
+
+    int64_t wallMillis()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    std::string newTraceId()
+    {
+        thread_local std::mt19937_64 generator{std::random_device{}()};
+        char id[17];
+        std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(generator()));
+        return id;
+    }
+
+    struct Stamps
+    {
+        int64_t sent = 0;
+        int64_t received = 0;
+        int64_t started = 0;
+        int64_t completed = 0;
+    };
+
+    // Echoed user properties, or "Trace" in the payload; false if the message carries neither
+    bool readStamps(const nlohmann::json &msg, const mqtt::properties &props, Stamps &stamps)
+    {
+        bool traced = false;
+        size_t count = props.count(mqtt::property::USER_PROPERTY);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto [key, value] = mqtt::get<mqtt::string_pair>(props, mqtt::property::USER_PROPERTY, i);
+            int64_t ms = std::strtoll(value.c_str(), nullptr, 10);
+            if (key == kIdProperty)
+            {
+                traced = true;
+            }
+            else if (key == kSentProperty)
+            {
+                stamps.sent = ms;
+            }
+            else if (key == kReceivedProperty)
+            {
+                stamps.received = ms;
+            }
+            else if (key == kStartedProperty)
+            {
+                stamps.started = ms;
+            }
+            else if (key == kCompletedProperty)
+            {
+                stamps.completed = ms;
+            }
+        }
+        if (traced)
+        {
+            return true;
+        }
+
+        if (!msg.is_object())
+        {
+            return false;
+        }
+        auto trace = msg.find("Trace");
+        if (trace == msg.end() || !trace->is_object() || !trace->contains("Id"))
+        {
+            return false;
+        }
+        auto stamp = [&trace](const char *field)
+        {
+            auto it = trace->find(field);
+            return it != trace->end() && it->is_number() ? it->get<int64_t>() : int64_t{0};
+        };
+        stamps.sent = stamp("Sent");
+        stamps.received = stamp("Received");
+        stamps.started = stamp("Started");
+        stamps.completed = stamp("Completed");
+        return true;
+    }
+}
+
+std::atomic<CommandTrace::Mode> CommandTrace::mode_{CommandTrace::Mode::Off};
+
+void CommandTrace::configure(const std::string &mode)
+{
+    auto parsed = parseMode(mode);
+    if (!parsed)
+    {
+        BT_LOG_WARN << "[CommandTrace] Unknown mode '" << mode << "', tracing off";
+    }
+    mode_.store(parsed.value_or(Mode::Off), std::memory_order_relaxed);
+}
+
+CommandTrace::Context CommandTrace::begin(mqtt::properties &props)
+{
+    Context context{newTraceId(), wallMillis()};
+    props.add(mqtt::property(mqtt::property::USER_PROPERTY, kIdProperty, context.id));
+    props.add(mqtt::property(mqtt::property::USER_PROPERTY, kSentProperty, std::to_string(context.sent_ms)));
+    return context;
+}
+
+void CommandTrace::embed(std::string &json_text, const Context &context)
+{
+    size_t open = json_text.find_first_not_of(" \t\r\n");
+    size_t close = json_text.find_last_not_of(" \t\r\n");
+    if (open == std::string::npos || json_text[open] != '{' || json_text[close] != '}')
+    {
+        return;
+    }
+    bool empty = json_text.find_last_not_of(" \t\r\n", close - 1) == open;
+    std::string trace = (empty ? "\"Trace\":{\"Id\":\"" : ",\"Trace\":{\"Id\":\"") + context.id +
+                        "\",\"Sent\":" + std::to_string(context.sent_ms) + "}";
+    json_text.insert(close, trace);
+}
+
+void CommandTrace::embed(nlohmann::json &payload, const Context &context)
+{
+    if (payload.is_object())
+    {
+        payload["Trace"] = {{"Id", context.id}, {"Sent", context.sent_ms}};
+    }
+}
+
+bool CommandTrace::record(const std::string &name, const nlohmann::json &msg, const mqtt::properties &props)
+{
+    Stamps stamps;
+    if (!readStamps(msg, props, stamps) || stamps.completed == 0)
+    {
+        // Untraced, or a RUNNING acknowledgment: the final response records the whole command
+        return false;
+    }
+
+    int64_t now = wallMillis();
+    auto hop = [&name](const char *category, int64_t from, int64_t to)
+    {
+        if (from != 0 && to != 0)
+        {
+            LatencyMetrics::instance().record(category, name, std::chrono::milliseconds(std::max<int64_t>(to - from, 0)));
+        }
+    };
+    hop("trace_to_station", stamps.sent, stamps.received);
+    hop("trace_station_queue", stamps.received, stamps.started);
+    hop("trace_actuation", stamps.started, stamps.completed);
+    hop("trace_to_controller", stamps.completed, now);
+    hop("trace_total", stamps.sent, now);
+    return true;
+}
+
+std::optional<CommandTrace::Mode> CommandTrace::parseMode(const std::string &name)
+{
+    if (name == "off")
+    {
+        return Mode::Off;
+    }
+    if (name == "properties")
+    {
+        return Mode::Properties;
+    }
+    if (name == "payload")
+    {
+        return Mode::Payload;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,166 @@
+#include "metrics/latency_metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <mutex>
+
+size_t LatencyHistogram::bucketIndex(uint64_t value_us)
+{
+    if (value_us < static_cast<uint64_t>(kSubBucketCount))
+    {
+        return static_cast<size_t>(value_us);
+    }
+
+    int magnitude = std::bit_width(value_us) - 1; // Position of the highest set bit
+    if (magnitude > kMaxMagnitude)
+    {
+        return kBucketCount - 1;
+    }
+
+    // The top kSubBucketBits + 1 bits select the sub-bucket within this power of two
+    uint64_t sub_bucket = value_us >> (magnitude - kSubBucketBits);
+    return static_cast<size_t>(magnitude - kSubBucketBits + 1) * kSubBucketCount +
+           static_cast<size_t>(sub_bucket - kSubBucketCount);
+}
+
+double LatencyHistogram::bucketMidpointMs(size_t index)
+{
+    if (index < static_cast<size_t>(2 * kSubBucketCount))
+    {
+        // Exact buckets of width 1 us
+        return static_cast<double>(index) / 1000.0;
+    }
+
+    int shift = static_cast<int>(index / kSubBucketCount) - 1;
+    uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+    double lower_us = static_cast<double>(sub_bucket << shift);
+    double width_us = static_cast<double>(uint64_t{1} << shift);
+    return (lower_us + width_us / 2.0) / 1000.0;
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    uint64_t value = us > 0 ? static_cast<uint64_t>(us) : 0;
+
+    counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total_count_.fetch_add(1, std::memory_order_relaxed);
+    total_us_.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current_max = max_us_.load(std::memory_order_relaxed);
+    while (value > current_max &&
+           !max_us_.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize(bool reset)
+{
+    std::array<uint64_t, kBucketCount> snapshot;
+    uint64_t count = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        snapshot[i] = reset ? counts_[i].exchange(0, std::memory_order_relaxed)
+                            : counts_[i].load(std::memory_order_relaxed);
+        count += snapshot[i];
+    }
+    uint64_t total_us = reset ? total_us_.exchange(0, std::memory_order_relaxed)
+                              : total_us_.load(std::memory_order_relaxed);
+    uint64_t max_us = reset ? max_us_.exchange(0, std::memory_order_relaxed)
+                            : max_us_.load(std::memory_order_relaxed);
+    if (reset)
+    {
+        total_count_.store(0, std::memory_order_relaxed);
+    }
+
+    Summary summary;
+    summary.count = count;
+    if (count == 0)
+    {
+        return summary;
+    }
+
+    summary.mean_ms = static_cast<double>(total_us) / static_cast<double>(count) / 1000.0;
+    summary.max_ms = static_cast<double>(max_us) / 1000.0;
+
+    // Walk the buckets once, filling each percentile as its rank is crossed
+    const std::array<double, 3> quantiles = {0.50, 0.90, 0.99};
+    std::array<double *, 3> targets = {&summary.p50_ms, &summary.p90_ms, &summary.p99_ms};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount && next < quantiles.size(); ++i)
+    {
+        seen += snapshot[i];
+        while (next < quantiles.size() &&
+               static_cast<double>(seen) >= quantiles[next] * static_cast<double>(count))
+        {
+            // Never report a percentile above the observed maximum
+            *targets[next] = std::min(bucketMidpointMs(i), summary.max_ms);
+            next++;
+        }
+    }
+
+    return summary;
+}
+
+LatencyMetrics &LatencyMetrics::instance()
+{
+    static LatencyMetrics metrics;
+    return metrics;
+}
+
+LatencyHistogram &LatencyMetrics::histogram(const std::string &category, const std::string &name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto category_it = histograms_.find(category);
+        if (category_it != histograms_.end())
+        {
+            auto it = category_it->second.find(name);
+            if (it != category_it->second.end())
+            {
+                return *it->second;
+            }
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto &slot = histograms_[category][name];
+    if (!slot)
+    {
+        slot = std::make_unique<LatencyHistogram>();
+    }
+    return *slot;
+}
+
+nlohmann::json LatencyMetrics::toJson(bool reset)
+{
+    nlohmann::json result = nlohmann::json::object();
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto &[category, histograms] : histograms_)
+    {
+        nlohmann::json category_json = nlohmann::json::object();
+        for (const auto &[name, histogram] : histograms)
+        {
+            LatencyHistogram::Summary summary = histogram->summarize(reset);
+            if (summary.count == 0)
+            {
+                continue;
+            }
+            category_json[name] = {
+                {"Count", summary.count},
+                {"MeanMs", summary.mean_ms},
+                {"P50Ms", summary.p50_ms},
+                {"P90Ms", summary.p90_ms},
+                {"P99Ms", summary.p99_ms},
+                {"MaxMs", summary.max_ms}};
+        }
+        if (!category_json.empty())
+        {
+            result[category] = std::move(category_json);
+        }
+    }
+
+    return result;
+}
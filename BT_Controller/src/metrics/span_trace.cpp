@@ -0,0 +1,239 @@
+#include "metrics/span_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <utility>
+
+namespace
+{
+    // Innermost open span on this thread; spans of other threads fall back to the root
+    thread_local uint64_t current_span = 0;
+
+    std::string hex(uint64_t value)
+    {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+        return buffer;
+    }
+
+    nlohmann::json chromeTrace(const SpanTrace::Session &session)
+    {
+        nlohmann::json events = nlohmann::json::array();
+        if (session.spans.empty())
+        {
+            return {{"traceEvents", events}};
+        }
+
+        auto origin = session.spans.front().start;
+        uint32_t thread_count = 0;
+        for (const auto &span : session.spans)
+        {
+            nlohmann::json args = nlohmann::json::object();
+            for (const auto &[key, value] : span.attributes)
+            {
+                args[key] = value;
+            }
+            events.push_back({{"name", span.name},
+                              {"cat", span.category},
+                              {"ph", "X"},
+                              {"ts", std::chrono::duration<double, std::micro>(span.start - origin).count()},
+                              {"dur", std::chrono::duration<double, std::micro>(span.end - span.start).count()},
+                              {"pid", 1},
+                              {"tid", span.thread},
+                              {"args", args}});
+            thread_count = std::max(thread_count, span.thread + 1);
+        }
+
+        for (uint32_t thread = 0; thread < thread_count; ++thread)
+        {
+            events.push_back({{"name", "thread_name"},
+                              {"ph", "M"},
+                              {"pid", 1},
+                              {"tid", thread},
+                              {"args", {{"name", thread == 0 ? "controller" : "worker " + std::to_string(thread)}}}});
+        }
+        events.push_back({{"name", "process_name"},
+                          {"ph", "M"},
+                          {"pid", 1},
+                          {"args", {{"name", "bt_controller " + session.spans.front().name}}}});
+
+        return {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+    }
+
+    nlohmann::json otlpTrace(const SpanTrace::Session &session)
+    {
+        std::string trace_id = hex(session.trace_id_high) + hex(session.trace_id_low);
+        auto unix_nanos = [&session](std::chrono::steady_clock::time_point time)
+        {
+            auto since_root = time - session.spans.front().start;
+            auto wall = session.wall_start + std::chrono::duration_cast<std::chrono::system_clock::duration>(since_root);
+            // 64-bit integers are strings in OTLP/JSON
+            return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count());
+        };
+        auto span_id = [&session](uint64_t id)
+        { return hex(session.trace_id_low ^ id); };
+
+        nlohmann::json spans = nlohmann::json::array();
+        for (const auto &span : session.spans)
+        {
+            nlohmann::json attributes = nlohmann::json::array();
+            attributes.push_back({{"key", "thread.id"}, {"value", {{"intValue", std::to_string(span.thread)}}}});
+            attributes.push_back({{"key", "category"}, {"value", {{"stringValue", span.category}}}});
+            for (const auto &[key, value] : span.attributes)
+            {
+                attributes.push_back({{"key", key}, {"value", {{"stringValue", value}}}});
+            }
+
+            nlohmann::json otlp_span = {{"traceId", trace_id},
+                                        {"spanId", span_id(span.id)},
+                                        {"name", span.name},
+                                        {"kind", span.category == "http" ? 3 : 1}, // CLIENT : INTERNAL
+                                        {"startTimeUnixNano", unix_nanos(span.start)},
+                                        {"endTimeUnixNano", unix_nanos(span.end)},
+                                        {"attributes", attributes}};
+            if (span.parent_id != 0)
+            {
+                otlp_span["parentSpanId"] = span_id(span.parent_id);
+            }
+            spans.push_back(std::move(otlp_span));
+        }
+
+        return {{"resourceSpans",
+                 {{{"resource",
+                    {{"attributes", {{{"key", "service.name"}, {"value", {{"stringValue", "bt_controller"}}}}}}}},
+                   {"scopeSpans", {{{"scope", {{"name", "bt_controller.span_trace"}}}, {"spans", spans}}}}}}}};
+    }
+}
+
+std::optional<SpanTrace::Format> SpanTrace::parseFormat(const std::string &name)
+{
+    if (name == "chrome" || name == "perfetto")
+        return Format::Chrome;
+    if (name == "otlp")
+        return Format::Otlp;
+    return std::nullopt;
+}
+
+SpanTrace &SpanTrace::instance()
+{
+    static SpanTrace trace;
+    return trace;
+}
+
+void SpanTrace::begin(const std::string &name, std::vector<std::pair<std::string, std::string>> attributes)
+{
+    static thread_local std::mt19937_64 random{std::random_device{}()};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    session_ = Session{};
+    session_.wall_start = std::chrono::system_clock::now();
+    session_.trace_id_high = random();
+    session_.trace_id_low = random();
+
+    Span root;
+    root.name = name;
+    root.category = "phase";
+    root.id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    root.start = std::chrono::steady_clock::now();
+    root.attributes = std::move(attributes);
+    session_.spans.push_back(std::move(root));
+
+    threads_.assign(1, std::this_thread::get_id());
+    session_id_.store(next_id_.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+SpanTrace::Session SpanTrace::end(const std::string &outcome)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    session_id_.store(0, std::memory_order_relaxed);
+    if (session_.spans.empty())
+    {
+        return {};
+    }
+
+    Span &root = session_.spans.front();
+    root.end = std::chrono::steady_clock::now();
+    root.attributes.emplace_back("outcome", outcome);
+
+    // Spans were stored as they closed; report them by start time after the root
+    std::stable_sort(session_.spans.begin() + 1, session_.spans.end(),
+                     [](const Span &a, const Span &b)
+                     { return a.start < b.start; });
+    return std::exchange(session_, Session{});
+}
+
+void SpanTrace::closeSpan(uint64_t session_id, Span &&span)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (session_id_.load(std::memory_order_relaxed) != session_id || session_.spans.empty())
+    {
+        return;
+    }
+
+    auto thread = std::find(threads_.begin(), threads_.end(), std::this_thread::get_id());
+    span.thread = static_cast<uint32_t>(thread - threads_.begin());
+    if (thread == threads_.end())
+    {
+        threads_.push_back(std::this_thread::get_id());
+    }
+    if (span.parent_id == 0)
+    {
+        span.parent_id = session_.spans.front().id;
+    }
+    session_.spans.push_back(std::move(span));
+}
+
+nlohmann::json SpanTrace::toJson(const Session &session, Format format)
+{
+    return format == Format::Otlp && !session.spans.empty() ? otlpTrace(session) : chromeTrace(session);
+}
+
+bool SpanTrace::writeFile(const Session &session, Format format, const std::string &path)
+{
+    std::error_code ec;
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+    {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    file << toJson(session, format).dump();
+    return static_cast<bool>(file);
+}
+
+TraceSpan::TraceSpan(const char *name, const char *category)
+{
+    SpanTrace &trace = SpanTrace::instance();
+    session_ = trace.session_id_.load(std::memory_order_relaxed);
+    if (session_ == 0)
+    {
+        return;
+    }
+
+    span_.name = name;
+    span_.category = category;
+    span_.id = trace.next_id_.fetch_add(1, std::memory_order_relaxed);
+    span_.parent_id = current_span;
+    saved_parent_ = current_span;
+    current_span = span_.id;
+    span_.start = std::chrono::steady_clock::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (session_ == 0)
+    {
+        return;
+    }
+    span_.end = std::chrono::steady_clock::now();
+    current_span = saved_parent_;
+    SpanTrace::instance().closeSpan(session_, std::move(span_));
+}
@@ -0,0 +1,131 @@
+#include "mqtt/message_template.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    // Placeholder a field holds while the message is dumped; control characters are always
+    // escaped by dump(), so the marker text cannot come from user content
+    std::string fieldMarker(size_t index)
+    {
+        return "\x01MT" + std::to_string(index) + "\x01";
+    }
+}
+
+MessageTemplate::MessageTemplate(nlohmann::json message, const std::vector<std::string> &fields)
+{
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        message[nlohmann::json::json_pointer(fields[i])] = fieldMarker(i);
+    }
+    std::string text = message.dump();
+
+    // Locate every marker in the dump, then cut the text into the literal pieces around them
+    std::vector<std::pair<size_t, size_t>> positions; // (offset, field index)
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        std::string dumped_marker = nlohmann::json(fieldMarker(i)).dump();
+        size_t pos = text.find(dumped_marker);
+        if (pos == std::string::npos)
+        {
+            std::cerr << "MessageTemplate: field " << fields[i] << " not found in " << text << std::endl;
+            continue;
+        }
+        positions.emplace_back(pos, i);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    size_t cursor = 0;
+    for (const auto &[pos, field_index] : positions)
+    {
+        pieces_.push_back(text.substr(cursor, pos - cursor));
+        field_order_.push_back(field_index);
+        cursor = pos + nlohmann::json(fieldMarker(field_index)).dump().size();
+    }
+    pieces_.push_back(text.substr(cursor));
+
+    for (const auto &piece : pieces_)
+    {
+        literal_size_ += piece.size();
+    }
+}
+
+void MessageTemplate::render(std::string &out, std::initializer_list<Value> values) const
+{
+    out.clear();
+    if (pieces_.empty())
+    {
+        return;
+    }
+    out.reserve(literal_size_ + 64 * field_order_.size());
+
+    out += pieces_[0];
+    for (size_t k = 0; k < field_order_.size(); ++k)
+    {
+        size_t field_index = field_order_[k];
+        if (field_index < values.size())
+        {
+            const Value &value = values.begin()[field_index];
+            if (value.json_)
+            {
+                out += value.json_->dump();
+            }
+            else
+            {
+                appendJsonString(out, value.text_);
+            }
+        }
+        else
+        {
+            out += "null";
+        }
+        out += pieces_[k + 1];
+    }
+}
+
+void MessageTemplate::appendJsonString(std::string &out, std::string_view text)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    // Same escaping as nlohmann::json::dump() without ensure_ascii
+    out += '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out += "\\u00";
+                out += hex[(static_cast<unsigned char>(c) >> 4) & 0x0F];
+                out += hex[static_cast<unsigned char>(c) & 0x0F];
+            }
+            else
+            {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
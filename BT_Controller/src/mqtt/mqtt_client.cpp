@@ -1,22 +1,40 @@
 #include "mqtt/mqtt_client.h"
+#include "mqtt/traffic_log.h"
 
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    // Publishes of a topic before it gets an alias; one-off topics keep the full name
+    constexpr uint32_t kPublishesBeforeAlias = 2;
+}
 
 MqttClient::MqttClient(std::string serverURI, std::string client_id,
-                       mqtt::connect_options connOpts, int nretry_attempts)
+                       mqtt::connect_options connOpts, int nretry_attempts,
+                       int topic_alias_maximum, mqtt_utils::SessionConfig session)
     : mqtt::async_client(serverURI, client_id), // Initialize base
       server_uri_(std::move(serverURI)),
       conn_opts_(std::move(connOpts)),
-      nretry_attempts_(nretry_attempts)
+      nretry_attempts_(nretry_attempts),
+      topic_alias_maximum_(std::clamp(topic_alias_maximum, 0, 65535)),
+      session_(session)
 {
+    if (topic_alias_maximum_ > 0)
+    {
+        // Lets the broker alias the topics it delivers to us
+        mqtt::properties props = conn_opts_.get_properties();
+        props.add({mqtt::property::TOPIC_ALIAS_MAXIMUM, topic_alias_maximum_});
+        conn_opts_.set_properties(props);
+    }
 
     set_callback(*this);
 
     set_connected_handler([this](const std::string &cause)
-                          { this->on_successful_connect(); });
+                          { std::cout << "Successfully connected to MQTT broker: " << server_uri_ << std::endl; });
 
     set_disconnected_handler([this](const mqtt::properties &props, mqtt::ReasonCode reason)
                              {
@@ -27,25 +45,48 @@ MqttClient::MqttClient(std::string serverURI, std::string client_id,
                                  }
                                  this->connection_lost(cause_str); });
 
+    bool connected = false;
     try
     {
         std::cout << "Attempting to connect to MQTT broker: " << server_uri_ << " with client ID: " << client_id << std::endl;
-        connect(conn_opts_)->wait_for(std::chrono::seconds(10));
+        auto token = connect(conn_opts_);
+        if (token->wait_for(std::chrono::seconds(10)))
+        {
+            on_successful_connect(token->get_connect_response());
+            connected = true;
+        }
     }
     catch (const mqtt::exception &exc)
     {
         std::cerr << "Initial connection failed: " << exc.what() << std::endl;
     }
+    if (!connected)
+    {
+        // Keep trying in the background; publishes queue until it succeeds
+        start_reconnect();
+    }
 }
 
 MqttClient::~MqttClient()
 {
+    {
+        std::lock_guard<std::mutex> lock(reconnect_mutex_);
+        closing_ = true;
+    }
+    reconnect_cv_.notify_all();
+    if (reconnect_thread_.joinable())
+    {
+        reconnect_thread_.join();
+    }
+
     if (is_connected())
     {
         try
         {
             mqtt::disconnect_options opts;
             opts.set_timeout(std::chrono::seconds(1));
+            // A deliberate shutdown ends the session the broker would otherwise keep for us
+            opts.set_properties({{mqtt::property::SESSION_EXPIRY_INTERVAL, 0}});
             auto token = disconnect(opts);
             if (token)
             {
@@ -69,25 +110,57 @@ MqttClient::~MqttClient()
 
 void MqttClient::message_arrived(mqtt::const_message_ptr msg)
 {
-    std::string topic = msg->get_topic();
-    try
+    std::string aliased_topic;
+    if (topic_alias_maximum_ > 0 && msg->get_properties().contains(mqtt::property::TOPIC_ALIAS))
     {
-        json payload = json::parse(msg->get_payload_str());
-
-        if (message_handler_)
+        aliased_topic = resolve_inbound_topic(*msg);
+        if (aliased_topic.empty())
         {
-            message_handler_(topic, payload, msg->get_properties());
+            return;
         }
-        else
+    }
+    const std::string &topic = aliased_topic.empty() ? msg->get_topic() : aliased_topic;
+
+    if (auto *recorder = recorder_.load(std::memory_order_acquire))
+    {
+        recorder->record(topic, *msg);
+    }
+
+    // Without a handler there is nothing to parse for
+    // This can be verbose if many unhandled topics are expected (e.g. from wildcards)
+    if (!message_handler_)
+    {
+        return;
+    }
+
+    // Route on topic first: skip JSON parsing for messages nobody will consume
+    auto declared = mqtt_utils::PayloadEncoding::Json;
+    if (topic_route_)
+    {
+        auto route = topic_route_(topic);
+        if (!route)
         {
-            // This can be verbose if many unhandled topics are expected (e.g. from wildcards)
-            // std::cout << "Message arrived on topic '" << topic << "' but no application handler is set." << std::endl;
+            return;
         }
+        declared = *route;
+    }
+
+    auto encoding = payload_encoding(*msg, declared);
+    try
+    {
+        // Parsed once, straight into the shared document every handler downstream receives
+        auto payload = std::make_shared<const json>(mqtt_utils::decodePayload(msg->get_payload_ref(), encoding));
+        message_handler_(topic, payload, msg->get_properties());
     }
     catch (const json::parse_error &e)
     {
-        std::cerr << "JSON parse error for message on topic '" << topic << "': " << e.what()
-                  << "\nPayload: " << msg->get_payload_str() << std::endl;
+        std::cerr << "Payload parse error for message on topic '" << topic << "' ("
+                  << mqtt_utils::contentTypeFor(encoding) << "): " << e.what();
+        if (encoding == mqtt_utils::PayloadEncoding::Json)
+        {
+            std::cerr << "\nPayload: " << msg->get_payload_str();
+        }
+        std::cerr << std::endl;
     }
     catch (const std::exception &e)
     {
@@ -95,6 +168,21 @@ void MqttClient::message_arrived(mqtt::const_message_ptr msg)
     }
 }
 
+mqtt_utils::PayloadEncoding MqttClient::payload_encoding(const mqtt::message &msg,
+                                                     mqtt_utils::PayloadEncoding declared) const
+{
+    const auto &props = msg.get_properties();
+    if (props.contains(mqtt::property::CONTENT_TYPE))
+    {
+        auto content_type = mqtt::get<std::string>(props, mqtt::property::CONTENT_TYPE);
+        if (auto encoding = mqtt_utils::parsePayloadEncoding(content_type))
+        {
+            return *encoding;
+        }
+    }
+    return declared;
+}
+
 void MqttClient::connection_lost(const std::string &cause)
 {
     std::cout << "MQTT connection lost.";
@@ -102,6 +190,8 @@ void MqttClient::connection_lost(const std::string &cause)
     {
         std::cout << " Cause: " << cause << std::endl;
     }
+    outbox_active_ = true;
+    reset_topic_aliases(outbound_alias_limit_);
     on_connection_failure(); // Call internal handler
 }
 
@@ -115,18 +205,7 @@ void MqttClient::delivery_complete(mqtt::delivery_token_ptr token)
 
 mqtt::token_ptr MqttClient::subscribe_topic(const std::string &topic, int qos) // MODIFIED: Return token_ptr
 {
-    if (!is_connected())
-    {
-        // std::cerr << "Cannot subscribe to topic '" << topic << "', MQTT client not connected." << std::endl;
-        if (std::find_if(tracked_subscriptions_.begin(), tracked_subscriptions_.end(),
-                         [&](const TopicSubscriptionInfo &tsi)
-                         { return tsi.topic == topic; }) == tracked_subscriptions_.end())
-        {
-            tracked_subscriptions_.push_back({topic, qos});
-        }
-        return nullptr; // MODIFIED: Indicate failure to initiate
-    }
-
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
     auto it = std::find_if(tracked_subscriptions_.begin(), tracked_subscriptions_.end(),
                            [&](const TopicSubscriptionInfo &sub)
                            { return sub.topic == topic; });
@@ -141,20 +220,115 @@ mqtt::token_ptr MqttClient::subscribe_topic(const std::string &topic, int qos) /
         // std::cout << "QoS for tracked subscription '" << topic << "' updated to " << qos << ". Re-subscription needed to apply." << std::endl;
     }
 
+    if (!is_connected())
+    {
+        // Sent on reconnect
+        offline_subscribes_.insert(topic);
+        offline_unsubscribes_.erase(topic);
+        return nullptr; // MODIFIED: Indicate failure to initiate
+    }
+
     try
     {
-        auto listener = new subscription_listener(topic); // Paho MQTT library takes ownership
-        return subscribe(topic, qos, nullptr, *listener); // MODIFIED: Return the token
+        return subscribe(topic, qos, nullptr, subscription_listener_); // MODIFIED: Return the token
     }
     catch (const mqtt::exception &exc)
     {
         std::cerr << "Subscription to topic '" << topic << "' failed to initiate: " << exc.what() << std::endl;
+        offline_subscribes_.insert(topic);
         return nullptr; // MODIFIED: Indicate failure to initiate
     }
 }
 
+mqtt::token_ptr MqttClient::subscribe_topics(const std::vector<std::pair<std::string, int>> &topics)
+{
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    track_subscriptions(topics);
+
+    if (topics.empty())
+    {
+        return nullptr;
+    }
+
+    auto token = is_connected() ? send_subscribe(topics) : nullptr;
+    if (!token)
+    {
+        for (const auto &[topic, qos] : topics)
+        {
+            offline_subscribes_.insert(topic);
+            offline_unsubscribes_.erase(topic);
+        }
+    }
+    return token;
+}
+
+mqtt::token_ptr MqttClient::send_subscribe(const std::vector<std::pair<std::string, int>> &topics)
+{
+    auto topic_filters = mqtt::string_collection::create();
+    mqtt::iasync_client::qos_collection qos_values;
+    qos_values.reserve(topics.size());
+    for (const auto &[topic, qos] : topics)
+    {
+        topic_filters->push_back(topic);
+        qos_values.push_back(qos);
+    }
+
+    try
+    {
+        return subscribe(topic_filters, qos_values, nullptr, subscription_listener_);
+    }
+    catch (const mqtt::exception &exc)
+    {
+        std::cerr << "Batch subscription to " << topics.size() << " topics failed to initiate: " << exc.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void MqttClient::send_subscribes_batched(const std::vector<std::pair<std::string, int>> &topics)
+{
+    // Batched SUBSCRIBE packets instead of one packet per topic
+    for (size_t first = 0; first < topics.size(); first += kMaxTopicsPerSubscribe)
+    {
+        size_t last = std::min(first + kMaxTopicsPerSubscribe, topics.size());
+        std::vector<std::pair<std::string, int>> batch(topics.begin() + first, topics.begin() + last);
+        if (!send_subscribe(batch))
+        {
+            std::cerr << "Failed to resubscribe to " << batch.size() << " tracked topics" << std::endl;
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            for (const auto &[topic, qos] : batch)
+            {
+                offline_subscribes_.insert(topic);
+            }
+        }
+    }
+}
+
+void MqttClient::track_subscriptions(const std::vector<std::pair<std::string, int>> &topics)
+{
+    std::unordered_map<std::string, size_t> tracked_index;
+    tracked_index.reserve(tracked_subscriptions_.size() + topics.size());
+    for (size_t i = 0; i < tracked_subscriptions_.size(); ++i)
+    {
+        tracked_index.emplace(tracked_subscriptions_[i].topic, i);
+    }
+
+    for (const auto &[topic, qos] : topics)
+    {
+        auto [it, inserted] = tracked_index.emplace(topic, tracked_subscriptions_.size());
+        if (inserted)
+        {
+            tracked_subscriptions_.push_back({topic, qos});
+        }
+        else
+        {
+            tracked_subscriptions_[it->second].qos = qos;
+        }
+    }
+}
+
 bool MqttClient::unsubscribe_topic(const std::string &topic)
 {
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
     tracked_subscriptions_.erase(
         std::remove_if(tracked_subscriptions_.begin(), tracked_subscriptions_.end(),
                        [&](const TopicSubscriptionInfo &sub)
@@ -163,19 +337,23 @@ bool MqttClient::unsubscribe_topic(const std::string &topic)
 
     if (!is_connected())
     {
-        // std::cerr << "Cannot unsubscribe from topic '" << topic << "', MQTT client not connected (removed from tracking)." << std::endl; // MODIFIED
+        // A resumed session still holds it unless it was only subscribed while offline
+        if (offline_subscribes_.erase(topic) == 0)
+        {
+            offline_unsubscribes_.insert(topic);
+        }
         return false;
     }
 
     try
     {
-        auto listener = new unsubscription_listener(topic);
-        unsubscribe(topic, nullptr, *listener);
+        unsubscribe(topic, nullptr, unsubscription_listener_);
         return true;
     }
     catch (const mqtt::exception &) // MODIFIED
     {
         // std::cerr << "Unsubscription from topic '" << topic << "' failed: " << exc.what() << std::endl; // MODIFIED
+        offline_unsubscribes_.insert(topic);
         return false;
     }
 }
@@ -186,65 +364,336 @@ void MqttClient::resubscribe_all_topics()
     {
         return;
     }
-    if (tracked_subscriptions_.empty())
-    {
-        return;
-    }
-
-    std::vector<TopicSubscriptionInfo> current_subs = tracked_subscriptions_;
 
-    for (const auto &sub_info : current_subs)
+    std::vector<std::pair<std::string, int>> topics;
     {
-        try
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        topics.reserve(tracked_subscriptions_.size());
+        for (const auto &sub : tracked_subscriptions_)
         {
-            auto listener = new subscription_listener(sub_info.topic);
-            subscribe(sub_info.topic, sub_info.qos, nullptr, *listener);
-        }
-        catch (const mqtt::exception &exc)
-        {
-            std::cerr << "Failed to resubscribe to topic '" << sub_info.topic << "': " << exc.what() << std::endl;
+            topics.emplace_back(sub.topic, sub.qos);
         }
+        offline_subscribes_.clear();
     }
+    send_subscribes_batched(topics);
 }
 
 // --- Publishing ---
 
 bool MqttClient::publish_message(const std::string &topic, const json &payload,
-                                 int qos, bool retained)
+                                 int qos, bool retained, mqtt_utils::PayloadEncoding encoding,
+                                 mqtt::properties props)
 {
-    if (!is_connected())
+    if (encoding != mqtt_utils::PayloadEncoding::Json)
     {
-        std::cerr << "Cannot publish to topic '" << topic << "', MQTT client not connected." << std::endl;
-        return false;
+        props.add({mqtt::property::CONTENT_TYPE, mqtt_utils::contentTypeFor(encoding)});
     }
+    return publish_payload(topic, mqtt_utils::encodePayload(payload, encoding), qos, retained, std::move(props));
+}
 
+bool MqttClient::publish_payload(const std::string &topic, std::string payload, int qos, bool retained,
+                                 mqtt::properties props)
+{
+    if (outbox_active_.load(std::memory_order_acquire) || !is_connected())
+    {
+        return queue_publish(topic, std::move(payload), qos, retained, std::move(props));
+    }
+    return send_payload(topic, std::move(payload), qos, retained, std::move(props));
+}
+
+bool MqttClient::send_payload(const std::string &topic, std::string payload, int qos, bool retained,
+                              mqtt::properties props)
+{
     try
     {
-        std::string payload_str = payload.dump();
-        auto msg = mqtt::make_message(topic, payload_str);
+        std::unique_lock<std::mutex> alias_lock(alias_mutex_, std::defer_lock);
+        std::string wire_topic = topic;
+        if (outbound_alias_limit_ > 0)
+        {
+            // Paho sends in publish() order, so no thread may queue an alias-only publish
+            // before the one setting the alias up is handed over
+            alias_lock.lock();
+            bool establishing = false;
+            wire_topic = apply_outbound_alias(topic, qos, props, establishing);
+            if (!establishing)
+            {
+                alias_lock.unlock();
+            }
+        }
+        auto msg = mqtt::make_message(wire_topic, std::move(payload));
         msg->set_qos(qos);
         msg->set_retained(retained);
+        if (!props.empty())
+        {
+            msg->set_properties(props);
+        }
         publish(msg);
         return true;
     }
     catch (const mqtt::exception &exc)
     {
         std::cerr << "Publication to topic '" << topic << "' failed: " << exc.what() << std::endl;
+        if (outbound_alias_limit_ > 0)
+        {
+            // The broker may not have seen topic and alias together; send both again next time
+            std::lock_guard<std::mutex> lock(alias_mutex_);
+            auto it = outbound_aliases_.find(topic);
+            if (it != outbound_aliases_.end())
+            {
+                it->second.established = false;
+            }
+        }
+        return false;
+    }
+}
+
+bool MqttClient::queue_publish(const std::string &topic, std::string payload, int qos, bool retained,
+                               mqtt::properties props)
+{
+    std::lock_guard<std::mutex> lock(outbox_mutex_);
+    if (!outbox_active_.load(std::memory_order_relaxed) && is_connected())
+    {
+        // The queue was flushed meanwhile
+        return send_payload(topic, std::move(payload), qos, retained, std::move(props));
+    }
+    if (session_.offline_buffer == 0)
+    {
+        offline_dropped_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Cannot publish to topic '" << topic << "', MQTT client not connected." << std::endl;
         return false;
     }
+    if (outbox_.size() >= session_.offline_buffer)
+    {
+        if (offline_dropped_.fetch_add(1, std::memory_order_relaxed) % 100 == 0)
+        {
+            std::cerr << "MQTT offline queue full (" << session_.offline_buffer << "), dropping the oldest publish to '"
+                      << outbox_.front().topic << "'" << std::endl;
+        }
+        outbox_.pop_front();
+    }
+    outbox_.push_back(QueuedPublish{topic, std::move(payload), qos, retained, std::move(props)});
+    return true;
+}
+
+void MqttClient::flush_outbox()
+{
+    // Publishers wait on the mutex meanwhile, so their messages follow the queued ones
+    std::lock_guard<std::mutex> lock(outbox_mutex_);
+    if (!outbox_.empty())
+    {
+        std::cout << "Sending " << outbox_.size() << " publishes queued while disconnected" << std::endl;
+    }
+    while (!outbox_.empty() && is_connected())
+    {
+        QueuedPublish &queued = outbox_.front();
+        send_payload(queued.topic, std::move(queued.payload), queued.qos, queued.retained, std::move(queued.props));
+        outbox_.pop_front();
+    }
+    if (is_connected())
+    {
+        outbox_active_.store(false, std::memory_order_release);
+    }
+}
+
+// --- Reconnect ---
+
+void MqttClient::start_reconnect()
+{
+    if (closing_ || reconnecting_.exchange(true))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(reconnect_mutex_);
+    if (reconnect_thread_.joinable())
+    {
+        // The previous loop is returning: once it clears reconnecting_ it touches nothing else
+        reconnect_thread_.join();
+    }
+    reconnect_thread_ = std::thread(&MqttClient::reconnect_loop, this);
+}
+
+void MqttClient::reconnect_loop()
+{
+    const auto min_backoff = std::chrono::milliseconds(std::max(session_.reconnect_min_ms, 1));
+    const auto max_backoff = std::max(min_backoff, std::chrono::milliseconds(session_.reconnect_max_ms));
+    while (true)
+    {
+        auto backoff = min_backoff;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(reconnect_mutex_);
+                if (reconnect_cv_.wait_for(lock, backoff, [this]()
+                                           { return closing_.load(); }))
+                {
+                    break;
+                }
+            }
+
+            mqtt::connect_options options = conn_opts_;
+            options.set_clean_start(!(session_.resume && session_established_));
+            try
+            {
+                std::cout << "Reconnecting to MQTT broker: " << server_uri_ << std::endl;
+                auto token = connect(options);
+                if (token->wait_for(std::chrono::seconds(10)))
+                {
+                    on_successful_connect(token->get_connect_response());
+                    break;
+                }
+            }
+            catch (const mqtt::exception &exc)
+            {
+                std::cerr << "MQTT reconnect failed: " << exc.what() << ", next attempt in "
+                          << std::min(backoff * 2, max_backoff).count() << " ms" << std::endl;
+            }
+            backoff = std::min(backoff * 2, max_backoff);
+        }
+        reconnecting_ = false;
+
+        // A loss reported while reconnecting_ was still set found the loop running and was
+        // dropped; take it over unless a newer start_reconnect() already has
+        if (closing_ || is_connected() || reconnecting_.exchange(true))
+        {
+            return;
+        }
+    }
+}
+
+// --- Topic Aliases ---
+
+std::string MqttClient::apply_outbound_alias(const std::string &topic, int qos, mqtt::properties &props,
+                                             bool &establishing)
+{
+    // Only QoS 0 is aliased: a QoS 1/2 message may be retransmitted on a later connection,
+    // where an alias-only publish would name an alias the broker no longer has
+    if (qos != 0)
+    {
+        return topic;
+    }
+
+    auto &entry = outbound_aliases_[topic];
+    if (entry.alias == 0)
+    {
+        if (++entry.publishes < kPublishesBeforeAlias || next_outbound_alias_ > outbound_alias_limit_)
+        {
+            return topic;
+        }
+        entry.alias = next_outbound_alias_++;
+    }
+
+    props.add({mqtt::property::TOPIC_ALIAS, entry.alias});
+    if (!entry.established)
+    {
+        // Topic and alias together set up the mapping
+        entry.established = true;
+        establishing = true;
+        return topic;
+    }
+    return std::string();
+}
+
+std::string MqttClient::resolve_inbound_topic(const mqtt::message &msg)
+{
+    int alias = mqtt::get<int>(msg.get_properties(), mqtt::property::TOPIC_ALIAS);
+    std::lock_guard<std::mutex> lock(alias_mutex_);
+    if (!msg.get_topic().empty())
+    {
+        inbound_aliases_[static_cast<uint16_t>(alias)] = msg.get_topic();
+        return msg.get_topic();
+    }
+
+    auto it = inbound_aliases_.find(static_cast<uint16_t>(alias));
+    if (it == inbound_aliases_.end())
+    {
+        std::cerr << "Dropping message with unknown topic alias " << alias << std::endl;
+        return std::string();
+    }
+    return it->second;
+}
+
+void MqttClient::reset_topic_aliases(uint16_t outbound_limit)
+{
+    std::lock_guard<std::mutex> lock(alias_mutex_);
+    outbound_alias_limit_ = outbound_limit;
+    outbound_aliases_.clear();
+    next_outbound_alias_ = 1;
+    inbound_aliases_.clear();
 }
 
 // --- Internal Connection Handlers ---
 
-void MqttClient::on_successful_connect()
+void MqttClient::on_successful_connect(const mqtt::connect_response &response)
 {
-    std::cout << "Successfully connected to MQTT broker: " << server_uri_ << std::endl;
-    resubscribe_all_topics();
+    bool resumed = session_.resume && session_established_ && response.is_session_present();
+    session_established_ = true;
+
+    // Aliases live for one connection; the broker's limit for ours may have changed
+    uint16_t outbound_limit = 0;
+    if (topic_alias_maximum_ > 0)
+    {
+        // Absent means the broker accepts none
+        const auto &connack = response.get_properties();
+        int broker_maximum = connack.contains(mqtt::property::TOPIC_ALIAS_MAXIMUM)
+                                 ? mqtt::get<int>(connack, mqtt::property::TOPIC_ALIAS_MAXIMUM)
+                                 : 0;
+        outbound_limit = static_cast<uint16_t>(std::min(topic_alias_maximum_, broker_maximum));
+    }
+    reset_topic_aliases(outbound_limit);
+    if (topic_alias_maximum_ > 0)
+    {
+        std::cout << "MQTT topic aliases: " << outbound_alias_limit_.load() << " outbound, "
+                  << topic_alias_maximum_ << " inbound" << std::endl;
+    }
+
+    if (resumed)
+    {
+        // The broker kept our subscriptions: no resubscribe, so no retained-message replay
+        std::vector<std::pair<std::string, int>> subscribes;
+        std::vector<std::string> unsubscribes;
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            for (const auto &sub : tracked_subscriptions_)
+            {
+                if (offline_subscribes_.count(sub.topic) > 0)
+                {
+                    subscribes.emplace_back(sub.topic, sub.qos);
+                }
+            }
+            unsubscribes.assign(offline_unsubscribes_.begin(), offline_unsubscribes_.end());
+            offline_subscribes_.clear();
+            offline_unsubscribes_.clear();
+        }
+        std::cout << "MQTT session resumed: " << subscribes.size() << " topic(s) to subscribe, "
+                  << unsubscribes.size() << " to unsubscribe" << std::endl;
+        send_subscribes_batched(subscribes);
+        for (const auto &topic : unsubscribes)
+        {
+            try
+            {
+                unsubscribe(topic, nullptr, unsubscription_listener_);
+            }
+            catch (const mqtt::exception &)
+            {
+            }
+        }
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            offline_unsubscribes_.clear();
+        }
+        resubscribe_all_topics();
+    }
+
+    flush_outbox();
 }
 
 void MqttClient::on_connection_failure()
 {
     std::cout << "MQTT connection failure processing." << std::endl;
+    start_reconnect();
 }
 
 // --- Listener Implementations ---
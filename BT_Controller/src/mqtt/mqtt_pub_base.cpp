@@ -1,6 +1,9 @@
 #include "mqtt/mqtt_pub_base.h"
 #include "mqtt/mqtt_client.h" // Ensure MqttClient definition is available
-#include <iostream>
+#include "logging/logger.h"
+#include "metrics/command_trace.h"
+
+#include <optional>
 
 namespace fs = std::filesystem;
 
@@ -18,7 +21,7 @@ void MqttPubBase::publish(const std::string &topic_key, const nlohmann::json &me
 {
   if (!mqtt_client_)
   {
-    std::cerr << "MqttPubBase: MQTT client is not initialized." << std::endl;
+    BT_LOG_ERROR << "MqttPubBase: MQTT client is not initialized.";
     return;
   }
 
@@ -28,14 +31,26 @@ void MqttPubBase::publish(const std::string &topic_key, const nlohmann::json &me
     const std::string &topic_str = it->second.getTopic();
     if (topic_str.empty() || topic_str.find('{') != std::string::npos)
     {
-      std::cerr << "MqttPubBase: Topic for key '" << topic_key << "' is not fully formatted or is empty: " << topic_str << std::endl;
+      BT_LOG_ERROR << "MqttPubBase: Topic for key '" << topic_key << "' is not fully formatted or is empty: " << topic_str;
       return;
     }
-    mqtt_client_->publish(topic_str, message.dump(), it->second.getQos(), it->second.getRetain());
+    mqtt::properties props;
+    if (CommandTrace::enabled())
+    {
+      auto trace = CommandTrace::begin(props);
+      if (CommandTrace::mode() == CommandTrace::Mode::Payload)
+      {
+        nlohmann::json traced = message;
+        CommandTrace::embed(traced, trace);
+        publishEncoded(it->second, traced, std::move(props));
+        return;
+      }
+    }
+    publishEncoded(it->second, message, std::move(props));
   }
   else
   {
-    std::cerr << "MqttPubBase: Topic key '" << topic_key << "' not found." << std::endl;
+    BT_LOG_ERROR << "MqttPubBase: Topic key '" << topic_key << "' not found.";
   }
 }
 
@@ -43,7 +58,7 @@ void MqttPubBase::publish(const std::string &topic_key, const std::string &messa
 {
   if (!mqtt_client_)
   {
-    std::cerr << "MqttPubBase: MQTT client is not initialized." << std::endl;
+    BT_LOG_ERROR << "MqttPubBase: MQTT client is not initialized.";
     return;
   }
 
@@ -53,15 +68,63 @@ void MqttPubBase::publish(const std::string &topic_key, const std::string &messa
     const std::string &topic_str = it->second.getTopic();
     if (topic_str.empty() || topic_str.find('{') != std::string::npos)
     {
-      std::cerr << "MqttPubBase: Topic for key '" << topic_key << "' is not fully formatted or is empty: " << topic_str << std::endl;
+      BT_LOG_ERROR << "MqttPubBase: Topic for key '" << topic_key << "' is not fully formatted or is empty: " << topic_str;
+      return;
+    }
+    mqtt::properties props;
+    std::optional<CommandTrace::Context> trace; // Set if the payload carries the context too
+    if (CommandTrace::enabled())
+    {
+      auto context = CommandTrace::begin(props);
+      if (CommandTrace::mode() == CommandTrace::Mode::Payload)
+      {
+        trace = std::move(context);
+      }
+    }
+    if (it->second.getEncoding() != mqtt_utils::PayloadEncoding::Json)
+    {
+      // Pre-serialized JSON text (templates) on a binary topic: re-encode it for the wire
+      nlohmann::json payload = nlohmann::json::parse(message);
+      if (trace)
+      {
+        CommandTrace::embed(payload, *trace);
+      }
+      mqtt_client_->publish_message(topic_str, payload, it->second.getQos(), it->second.getRetain(),
+                                    it->second.getEncoding(), std::move(props));
       return;
     }
-    mqtt_client_->publish(topic_str, message, it->second.getQos(), it->second.getRetain());
+    std::string payload = message;
+    if (trace)
+    {
+      CommandTrace::embed(payload, *trace);
+    }
+    mqtt_client_->publish_payload(topic_str, std::move(payload), it->second.getQos(), it->second.getRetain(),
+                                  std::move(props));
   }
   else
   {
-    std::cerr << "MqttPubBase: Topic key '" << topic_key << "' not found." << std::endl;
+    BT_LOG_ERROR << "MqttPubBase: Topic key '" << topic_key << "' not found.";
+  }
+}
+
+void MqttPubBase::publish(const std::string &topic_key, const MessageTemplate &message_template,
+                          std::initializer_list<MessageTemplate::Value> values)
+{
+  message_template.render(publish_buffer_, values);
+  publish(topic_key, publish_buffer_);
+}
+
+void MqttPubBase::publishEncoded(const mqtt_utils::Topic &topic, const nlohmann::json &message,
+                                 mqtt::properties props)
+{
+  if (topic.getEncoding() != mqtt_utils::PayloadEncoding::Json)
+  {
+    mqtt_client_->publish_message(topic.getTopic(), message, topic.getQos(), topic.getRetain(),
+                                  topic.getEncoding(), std::move(props));
+    return;
   }
+  mqtt_client_->publish_payload(topic.getTopic(), message.dump(), topic.getQos(), topic.getRetain(),
+                                std::move(props));
 }
 
 void MqttPubBase::setTopic(const std::string &topic_key, const mqtt_utils::Topic &topic_object)
@@ -78,6 +141,6 @@ void MqttPubBase::setFormattedTopic(const std::string &topic_key, const std::str
   }
   else
   {
-    std::cerr << "MqttPubBase: Cannot set formatted topic for unknown key '" << topic_key << "'" << std::endl;
+    BT_LOG_ERROR << "MqttPubBase: Cannot set formatted topic for unknown key '" << topic_key << "'";
   }
 }
\ No newline at end of file
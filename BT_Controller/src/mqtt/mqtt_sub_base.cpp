@@ -1,9 +1,11 @@
 #include "mqtt/mqtt_sub_base.h"
 #include "mqtt/node_message_distributor.h"
 #include "aas/aas_interface_cache.h"
+#include "aas/aas_client.h"
 #include "utils.h"
-#include <iostream>
 #include "behaviortree_cpp/blackboard.h"
+#include "logging/logger.h"
+#include "metrics/command_trace.h"
 
 namespace fs = std::filesystem;
 // Initialize the static members
@@ -21,17 +23,21 @@ void MqttSubBase::processMessage(const std::string &actual_topic_str, const json
     {
         // Check if the incoming actual_topic_str matches the pattern of topic_obj.getTopic()
         // topic_obj.getTopic() should be the (potentially wildcarded) string subscribed to.
-        if (mqtt_utils::topicMatches(topic_obj.getTopic(), actual_topic_str))
+        if (topic_obj.matches(actual_topic_str))
         {
-            if (topic_obj.validateMessage(msg))
+            if (hasRequiredFields(key, msg) && topic_obj.validateInbound(msg))
             {
+                if (CommandTrace::enabled())
+                {
+                    CommandTrace::record(getBTNodeName(), msg, props);
+                }
                 callback(key, msg, props); // Pass the logical key
                 return;                    // Assuming one message is handled by one callback logic path per instance
             }
             else
             {
-                std::cerr << getBTNodeName() << ": Message validation failed for topic key '" << key
-                          << "' on actual topic '" << actual_topic_str << "'" << std::endl;
+                BT_LOG_ERROR << getBTNodeName() << ": Message validation failed for topic key '" << key
+                             << "' on actual topic '" << actual_topic_str << "'";
                 return;
             }
         }
@@ -54,8 +60,79 @@ AASInterfaceCache* MqttSubBase::getAASInterfaceCache()
     return aas_interface_cache_;
 }
 
+std::vector<std::optional<mqtt_utils::Topic>> MqttSubBase::resolveInterfaces(
+    AASClient &aas_client,
+    const std::string &asset_id,
+    const std::vector<std::pair<std::string, std::string>> &requests)
+{
+    if (aas_interface_cache_)
+    {
+        return aas_interface_cache_->resolveInterfaces(asset_id, requests);
+    }
+
+    std::vector<std::optional<mqtt_utils::Topic>> topics;
+    topics.reserve(requests.size());
+    for (const auto &[interaction, endpoint] : requests)
+    {
+        topics.push_back(aas_client.fetchInterface(asset_id, interaction, endpoint));
+    }
+    return topics;
+}
+
 void MqttSubBase::setTopic(const std::string &topic_key, const mqtt_utils::Topic &topic_object)
 {
     topics_[topic_key] = topic_object;
 }
 
+void MqttSubBase::setRequiredFields(const std::string &topic_key, std::vector<std::string> fields)
+{
+    required_fields_[topic_key] = std::move(fields);
+}
+
+void MqttSubBase::setCorrelatedTopic(const std::string &topic_key)
+{
+    correlated_keys_.insert(topic_key);
+}
+
+bool MqttSubBase::isCorrelatedTopic(const std::string &topic_str) const
+{
+    for (const auto &key : correlated_keys_)
+    {
+        auto it = topics_.find(key);
+        if (it != topics_.end() && it->second.getTopic() == topic_str)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MqttSubBase::claimResponses(const std::string &uuid)
+{
+    if (node_message_distributor_ && !uuid.empty())
+    {
+        node_message_distributor_->claimResponses(this, uuid);
+    }
+}
+
+bool MqttSubBase::hasRequiredFields(const std::string &topic_key, const json &msg) const
+{
+    auto it = required_fields_.find(topic_key);
+    if (it == required_fields_.end())
+    {
+        return true;
+    }
+    if (!msg.is_object())
+    {
+        return false;
+    }
+    for (const auto &field : it->second)
+    {
+        if (!msg.contains(field))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
@@ -1,21 +1,44 @@
 #include "mqtt/node_message_distributor.h"
 #include "mqtt/mqtt_client.h"
+#include "mqtt/mqtt_pub_base.h"
 #include "utils.h"
-#include <iostream>
+#include "metrics/latency_metrics.h"
+#include "metrics/span_trace.h"
+#include "logging/logger.h"
+#include <array>
 #include <set>
 
-NodeMessageDistributor::NodeMessageDistributor(MqttClient &mqtt_client_ref)
-    : mqtt_client_(mqtt_client_ref) {}
+NodeMessageDistributor::NodeMessageDistributor(MqttClient &mqtt_client_ref,
+                                               size_t worker_count,
+                                               size_t queue_capacity,
+                                               bool last_value_cache)
+    : mqtt_client_(mqtt_client_ref),
+      routing_(std::make_shared<const RoutingTable>()),
+      queue_capacity_(std::max<size_t>(queue_capacity, 1)),
+      last_value_cache_enabled_(last_value_cache)
+{
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        shards_.push_back(std::make_unique<DispatchShard>());
+    }
+    for (auto &shard : shards_)
+    {
+        DispatchShard *shard_ptr = shard.get();
+        shard->worker = std::thread([this, shard_ptr]
+                                    { workerLoop(*shard_ptr); });
+    }
+}
 
 NodeMessageDistributor::~NodeMessageDistributor()
 {
+    stopWorkers();
 }
 
 std::vector<std::string> NodeMessageDistributor::getActiveTopicPatterns() const
 {
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    auto routing = loadRouting();
     std::set<std::string> unique_topics;
-    for (const auto &handler : topic_handlers_)
+    for (const auto &handler : routing->handlers)
     {
         if (handler.subscribed)
         {
@@ -30,7 +53,7 @@ bool NodeMessageDistributor::subscribeForActiveNodes(const BT::Tree &tree,
 {
     if (!tree.rootNode())
     {
-        std::cerr << "NodeMessageDistributor: Cannot subscribe, behavior tree has no root node." << std::endl;
+        BT_LOG_ERROR << "NodeMessageDistributor: Cannot subscribe, behavior tree has no root node.";
         return false;
     }
 
@@ -48,7 +71,9 @@ bool NodeMessageDistributor::subscribeForActiveNodes(const BT::Tree &tree,
     // Build map of topics to node instances
     std::map<std::string, std::vector<MqttSubBase *>> topic_to_instances_map;
     std::map<std::string, int> topic_to_max_qos;
+    std::map<std::string, mqtt_utils::Topic> topic_objects;
 
+    std::unique_lock<std::mutex> registry_lock(registry_mutex_);
     for (const auto &[type_idx, type_subscription_info] : node_subscriptions_)
     {
         for (MqttSubBase *instance : type_subscription_info.instances)
@@ -69,6 +94,7 @@ bool NodeMessageDistributor::subscribeForActiveNodes(const BT::Tree &tree,
                     continue;
 
                 topic_to_instances_map[topic_str].push_back(instance);
+                topic_objects.emplace(topic_str, topic_obj);
 
                 int instance_qos = topic_obj.getQos();
                 if (topic_to_max_qos.find(topic_str) == topic_to_max_qos.end() || instance_qos > topic_to_max_qos[topic_str])
@@ -79,120 +105,653 @@ bool NodeMessageDistributor::subscribeForActiveNodes(const BT::Tree &tree,
         }
     }
 
-    // Clear existing handlers and set up routing
+    registry_lock.unlock();
+
+    // With the last-value cache, topics an earlier tree left subscribed (a warm restart, or
+    // another tree on this distributor) are seeded locally; the broker would only resend
+    // the retained message we already hold
+    size_t seeded_count = 0;
+    if (last_value_cache_enabled_)
     {
-        std::lock_guard<std::mutex> lock(handlers_mutex_);
-        topic_handlers_.clear();
+        auto routing = loadRouting();
+        for (auto it = topic_to_instances_map.begin(); it != topic_to_instances_map.end();)
+        {
+            const std::string &topic_str = it->first;
+            int qos = topic_to_max_qos[topic_str];
+            bool covered = std::any_of(routing->handlers.begin(), routing->handlers.end(),
+                                       [&topic_str, qos](const TopicHandler &handler)
+                                       { return handler.topic == topic_str && handler.subscribed && handler.qos >= qos; });
+
+            // Every instance reads the same cached value, so either all are seeded or, with
+            // nothing cached yet, none are and the topic is left to the subscribe below
+            bool seeded = covered;
+            for (MqttSubBase *instance : it->second)
+            {
+                if (!seeded)
+                {
+                    break;
+                }
+                auto attach = [instance, &topic_str](std::vector<TopicHandler> &handlers)
+                {
+                    for (auto &handler : handlers)
+                    {
+                        if (handler.topic == topic_str)
+                        {
+                            if (std::find(handler.instances.begin(), handler.instances.end(), instance) == handler.instances.end())
+                            {
+                                handler.instances.push_back(instance);
+                            }
+                            return;
+                        }
+                    }
+                };
+                seeded = attachFromLastValueCache(instance, topic_objects.at(topic_str), attach);
+            }
+
+            if (seeded)
+            {
+                seeded_count++;
+                it = topic_to_instances_map.erase(it);
+                continue;
+            }
+            ++it;
+        }
+    }
+    if (seeded_count > 0)
+    {
+        BT_LOG_INFO << "NodeMessageDistributor: Seeded " << seeded_count
+                    << " still-subscribed topics from last-value cache";
+    }
+
+    // Merge into the existing handlers, so trees already running on this distributor keep
+    // their routing; every topic of this tree is (re)subscribed to get its retained messages
+    std::vector<std::pair<std::string, int>> topics_to_subscribe;
+    updateRouting([&topic_to_instances_map, &topic_to_max_qos, &topics_to_subscribe](std::vector<TopicHandler> &handlers)
+                  {
+                      for (const auto &[topic_str, instances_for_topic] : topic_to_instances_map)
+                      {
+                          if (instances_for_topic.empty())
+                              continue;
+
+                          auto existing = std::find_if(handlers.begin(), handlers.end(),
+                                                       [&topic_str](const TopicHandler &handler)
+                                                       { return handler.topic == topic_str; });
+                          if (existing == handlers.end())
+                          {
+                              TopicHandler handler;
+                              handler.topic = topic_str;
+                              handler.qos = topic_to_max_qos[topic_str];
+                              handler.subscribed = false;
+                              handlers.push_back(std::move(handler));
+                              existing = std::prev(handlers.end());
+                          }
+                          for (MqttSubBase *instance : instances_for_topic)
+                          {
+                              if (std::find(existing->instances.begin(), existing->instances.end(), instance) == existing->instances.end())
+                              {
+                                  existing->instances.push_back(instance);
+                              }
+                          }
+                          existing->qos = std::max(existing->qos, topic_to_max_qos[topic_str]);
+
+                          // Keep only topic/qos for subscribing, so no snapshot is held while waiting on the broker
+                          topics_to_subscribe.emplace_back(existing->topic, existing->qos);
+                      } });
+
+    if (topics_to_subscribe.empty())
+    {
+        BT_LOG_INFO << "NodeMessageDistributor: No topics to subscribe to for active nodes.";
+        return true;
+    }
+
+    BT_LOG_INFO << "NodeMessageDistributor: Subscribing to " << topics_to_subscribe.size() << " specific topics...";
 
-        for (const auto &[topic_str, instances_for_topic] : topic_to_instances_map)
+    // Send the whole set in as few SUBSCRIBE packets as possible, then wait once for all of them
+    struct PendingBatch
+    {
+        mqtt::token_ptr token;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<PendingBatch> batches;
+
+    {
+        TraceSpan span("mqtt.subscribe", "mqtt");
+        span.attr("topics", std::to_string(topics_to_subscribe.size()));
+        for (size_t begin = 0; begin < topics_to_subscribe.size(); begin += MqttClient::kMaxTopicsPerSubscribe)
+        {
+            size_t end = std::min(begin + MqttClient::kMaxTopicsPerSubscribe, topics_to_subscribe.size());
+            std::vector<std::pair<std::string, int>> batch(topics_to_subscribe.begin() + begin,
+                                                           topics_to_subscribe.begin() + end);
+            try
+            {
+                auto token = mqtt_client_.subscribe_topics(batch);
+                if (token)
+                {
+                    batches.push_back({token, begin, end});
+                }
+                else
+                {
+                    BT_LOG_ERROR << "  Failed to initiate subscription to " << batch.size() << " topics";
+                }
+            }
+            catch (const std::exception &e)
+            {
+                BT_LOG_ERROR << "  Exception subscribing to " << batch.size() << " topics: " << e.what();
+            }
+        }
+    }
+
+    // All batches are in flight together, so they share one deadline
+    TraceSpan wait_span("mqtt.suback", "mqtt");
+    auto deadline = std::chrono::steady_clock::now() + timeout_per_subscription;
+    std::set<std::string> subscribed_topics;
+    for (auto &batch : batches)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (!batch.token->wait_for(std::max(remaining, std::chrono::milliseconds(0))))
         {
-            if (instances_for_topic.empty())
+            BT_LOG_ERROR << "  Subscription timed out for " << (batch.end - batch.begin) << " topics";
+            continue;
+        }
+        if (batch.token->get_return_code() != mqtt::SUCCESS)
+        {
+            BT_LOG_ERROR << "  Subscription failed for " << (batch.end - batch.begin) << " topics";
+            continue;
+        }
+
+        // One reason code per topic; codes >= 0x80 reject that topic only
+        const auto reason_codes = batch.token->get_subscribe_response().get_reason_codes();
+        for (size_t i = batch.begin; i < batch.end; ++i)
+        {
+            const std::string &topic_str = topics_to_subscribe[i].first;
+            size_t code_index = i - batch.begin;
+            if (code_index < reason_codes.size() && reason_codes[code_index] >= 0x80)
+            {
+                BT_LOG_ERROR << "  Subscription failed for: " << topic_str;
                 continue;
+            }
+            subscribed_topics.insert(topic_str);
+        }
+    }
+    int success_count = static_cast<int>(subscribed_topics.size());
 
-            TopicHandler handler;
-            handler.topic = topic_str;
-            handler.instances = instances_for_topic;
-            handler.qos = topic_to_max_qos[topic_str];
-            handler.subscribed = false;
-            topic_handlers_.push_back(handler);
+    // Mark as subscribed, publishing one routing snapshot for the whole set
+    markSubscribed(subscribed_topics);
+
+    BT_LOG_INFO << "NodeMessageDistributor: Subscription complete: "
+                << success_count << "/" << topics_to_subscribe.size() << " topics";
+
+    return success_count == static_cast<int>(topics_to_subscribe.size());
+}
+
+std::vector<std::string> NodeMessageDistributor::releaseUnusedTopics()
+{
+    std::vector<std::string> released;
+    updateRouting([&released](std::vector<TopicHandler> &handlers)
+                  {
+                      auto unused = std::stable_partition(handlers.begin(), handlers.end(),
+                                                          [](const TopicHandler &handler)
+                                                          { return !handler.instances.empty(); });
+                      for (auto it = unused; it != handlers.end(); ++it)
+                      {
+                          if (it->subscribed)
+                          {
+                              released.push_back(it->topic);
+                          }
+                      }
+                      handlers.erase(unused, handlers.end()); });
+
+    // A cached value on a topic nobody is subscribed to any more would seed, and mark as
+    // subscribed, a node that then never hears a live message on it
+    if (last_value_cache_enabled_ && !released.empty())
+    {
+        auto routing = loadRouting();
+        std::vector<size_t> matches;
+        std::lock_guard<std::mutex> lock(last_value_mutex_);
+        for (auto it = last_values_.begin(); it != last_values_.end();)
+        {
+            matches.clear();
+            routing->trie.match(it->first, matches);
+            bool covered = std::any_of(matches.begin(), matches.end(),
+                                       [&routing](size_t index)
+                                       { return routing->handlers[index].subscribed; });
+            it = covered ? std::next(it) : last_values_.erase(it);
         }
     }
+    return released;
+}
 
-    if (topic_handlers_.empty())
+void NodeMessageDistributor::setDeliveryHook(std::function<void()> hook)
+{
+    delivery_hook_ = std::move(hook);
+}
+
+void NodeMessageDistributor::handle_incoming_message(const std::string &msg_topic,
+                                                     const std::shared_ptr<const json> &payload,
+                                                     mqtt::properties props)
+{
+    // Don't cache or queue payloads that no handler will consume (e.g. CMD topics from
+    // wildcard subscriptions when we only care about DATA)
+    Route matched = route(msg_topic);
+    if (!matched)
     {
-        std::cout << "NodeMessageDistributor: No topics to subscribe to for active nodes." << std::endl;
-        return true;
+        return;
     }
 
-    std::cout << "NodeMessageDistributor: Subscribing to " << topic_handlers_.size() << " specific topics..." << std::endl;
+    // Without the last-value cache we rely on MQTT broker retained messages
+    if (last_value_cache_enabled_)
+    {
+        storeLastValue(msg_topic, payload, props);
+    }
 
-    // Subscribe to each topic
-    std::vector<std::pair<mqtt::token_ptr, std::string>> subscription_tokens;
+    if (shards_.empty())
+    {
+        dispatch(msg_topic, *payload, props, &matched);
+        return;
+    }
 
-    for (const auto &handler : topic_handlers_)
+    DispatchShard &shard = *shards_[std::hash<std::string>{}(msg_topic) % shards_.size()];
     {
-        try
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.queue.size() >= queue_capacity_)
         {
-            auto token = mqtt_client_.subscribe_topic(handler.topic, handler.qos);
-            if (token)
+            uint64_t dropped = ++dropped_count_;
+            // Log the first drop and then at powers of two to avoid flooding the console
+            if ((dropped & (dropped - 1)) == 0)
             {
-                subscription_tokens.emplace_back(token, handler.topic);
+                BT_LOG_WARN << "NodeMessageDistributor: Dispatch queue full, dropped message on " << msg_topic
+                            << " (" << dropped << " dropped so far)";
             }
-            else
+            return;
+        }
+        shard.queue.push_back({msg_topic, payload, std::move(props), std::chrono::steady_clock::now()});
+    }
+
+    enqueued_count_++;
+    size_t depth = ++queue_depth_;
+    size_t max_depth = max_queue_depth_.load();
+    while (depth > max_depth && !max_queue_depth_.compare_exchange_weak(max_depth, depth))
+    {
+    }
+    shard.cv.notify_one();
+}
+
+void NodeMessageDistributor::dispatch(const std::string &msg_topic,
+                                      const json &payload,
+                                      const mqtt::properties &props,
+                                      const Route *matched)
+{
+    // Held across delivery, whatever snapshot it uses: unregisterInstance takes it
+    // exclusively before a node is destroyed. A route matched before the lock is only
+    // safe to use while its snapshot is still the current one.
+    std::shared_lock<std::shared_mutex> delivering(delivery_mutex_);
+    Route current;
+    if (!matched || matched->routing != loadRouting())
+    {
+        current = route(msg_topic);
+        matched = &current;
+    }
+
+    // If multiple handlers match (e.g. overlapping wildcards), all will be called.
+    bool delivered = false;
+    for (size_t index : matched->handlers)
+    {
+        const auto &handler = matched->routing->handlers[index];
+        if (handler.correlated.empty())
+        {
+            handler.routeMessage(msg_topic, payload, props);
+        }
+        else
+        {
+            routeCorrelated(handler, msg_topic, payload, props);
+        }
+        delivered = true;
+    }
+
+    delivering.unlock();
+
+    if (delivered && delivery_hook_)
+    {
+        delivery_hook_();
+    }
+}
+
+void NodeMessageDistributor::routeCorrelated(const TopicHandler &handler,
+                                             const std::string &msg_topic,
+                                             const json &payload,
+                                             const mqtt::properties &props)
+{
+    std::array<MqttSubBase *, kMaxOwnersPerUuid> owners{};
+    size_t owner_count = 0;
+    bool claimed = false;
+
+    auto uuid = payload.find("Uuid"); // end() for non-objects
+    if (uuid != payload.end() && uuid->is_string())
+    {
+        std::shared_lock<std::shared_mutex> lock(correlation_mutex_);
+        auto it = owners_by_uuid_.find(uuid->get_ref<const std::string &>());
+        if (it != owners_by_uuid_.end() && it->second.size() <= kMaxOwnersPerUuid)
+        {
+            claimed = true;
+            owner_count = it->second.size();
+            std::copy(it->second.begin(), it->second.end(), owners.begin());
+        }
+    }
+
+    if (!claimed)
+    {
+        handler.routeMessage(msg_topic, payload, props);
+        return;
+    }
+
+    correlated_count_.fetch_add(1, std::memory_order_relaxed);
+    for (MqttSubBase *instance : handler.uncorrelated)
+    {
+        instance->processMessage(msg_topic, payload, props);
+    }
+    // Only owners in this snapshot are called: they cannot be destroyed while it is held
+    for (size_t i = 0; i < owner_count; ++i)
+    {
+        if (std::binary_search(handler.correlated.begin(), handler.correlated.end(), owners[i]))
+        {
+            owners[i]->processMessage(msg_topic, payload, props);
+        }
+    }
+}
+
+void NodeMessageDistributor::claimResponses(MqttSubBase *owner, const std::string &uuid)
+{
+    std::unique_lock<std::shared_mutex> lock(correlation_mutex_);
+    auto previous = uuid_by_owner_.find(owner);
+    if (previous != uuid_by_owner_.end())
+    {
+        if (previous->second == uuid)
+        {
+            return;
+        }
+        auto &owners = owners_by_uuid_[previous->second];
+        owners.erase(std::remove(owners.begin(), owners.end(), owner), owners.end());
+        if (owners.empty())
+        {
+            owners_by_uuid_.erase(previous->second);
+        }
+    }
+    uuid_by_owner_[owner] = uuid;
+    owners_by_uuid_[uuid].push_back(owner);
+}
+
+void NodeMessageDistributor::releaseResponses(MqttSubBase *owner)
+{
+    std::unique_lock<std::shared_mutex> lock(correlation_mutex_);
+    auto previous = uuid_by_owner_.find(owner);
+    if (previous == uuid_by_owner_.end())
+    {
+        return;
+    }
+    auto &owners = owners_by_uuid_[previous->second];
+    owners.erase(std::remove(owners.begin(), owners.end(), owner), owners.end());
+    if (owners.empty())
+    {
+        owners_by_uuid_.erase(previous->second);
+    }
+    uuid_by_owner_.erase(previous);
+}
+
+void NodeMessageDistributor::workerLoop(DispatchShard &shard)
+{
+    while (true)
+    {
+        DispatchItem item;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.cv.wait(lock, [this, &shard]
+                          { return stopping_.load() || !shard.queue.empty(); });
+            if (stopping_.load())
             {
-                std::cerr << "  Failed to initiate subscription to: " << handler.topic << std::endl;
+                // Pending messages are discarded: their target nodes may already be gone
+                return;
             }
+            item = std::move(shard.queue.front());
+            shard.queue.pop_front();
+        }
+        queue_depth_--;
+
+        try
+        {
+            dispatch(item.topic, *item.payload, item.props);
+            // Queue wait plus handler time, arrival to delivered
+            LatencyMetrics::instance().record("dispatch", item.topic,
+                                              std::chrono::steady_clock::now() - item.enqueued);
         }
         catch (const std::exception &e)
         {
-            std::cerr << "  Exception subscribing to " << handler.topic << ": " << e.what() << std::endl;
+            BT_LOG_ERROR << "NodeMessageDistributor: Exception dispatching message on " << item.topic
+                         << ": " << e.what();
         }
+        processed_count_++;
     }
+}
 
-    // Wait for all subscriptions to complete
-    int success_count = 0;
-    for (auto &[token, topic_str] : subscription_tokens)
+void NodeMessageDistributor::stopWorkers()
+{
+    stopping_ = true;
+    for (auto &shard : shards_)
     {
-        if (token->wait_for(timeout_per_subscription))
         {
-            if (token->get_return_code() == mqtt::SUCCESS)
+            std::lock_guard<std::mutex> lock(shard->mutex);
+        }
+        shard->cv.notify_all();
+    }
+    for (auto &shard : shards_)
+    {
+        if (shard->worker.joinable())
+        {
+            shard->worker.join();
+        }
+    }
+    shards_.clear();
+    queue_depth_ = 0;
+}
+
+NodeMessageDistributor::DispatchStats NodeMessageDistributor::getDispatchStats() const
+{
+    DispatchStats stats;
+    stats.workers = shards_.size();
+    stats.queue_capacity = queue_capacity_;
+    stats.queue_depth = queue_depth_.load();
+    stats.max_queue_depth = max_queue_depth_.load();
+    stats.enqueued = enqueued_count_.load();
+    stats.processed = processed_count_.load();
+    stats.dropped = dropped_count_.load();
+    stats.correlated = correlated_count_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::map<std::string, NodeMessageDistributor::TopicMemoryStats> NodeMessageDistributor::getTopicMemoryStats() const
+{
+    std::map<std::string, TopicMemoryStats> stats;
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (const auto &[type_idx, subscription] : node_subscriptions_)
+    {
+        for (const MqttSubBase *instance : subscription.instances)
+        {
+            if (!instance)
+            {
+                continue;
+            }
+            const auto *tree_node = dynamic_cast<const BT::TreeNode *>(instance);
+            TopicMemoryStats &type_stats = stats[tree_node ? tree_node->registrationName()
+                                                           : instance->getRegistrationName()];
+            type_stats.nodes++;
+            type_stats.topics += instance->getTopics().size();
+            type_stats.bytes += instance->getTopics().memoryUsage();
+            if (const auto *publisher = dynamic_cast<const MqttPubBase *>(instance))
             {
-                std::cout << "  Subscribed: " << topic_str << std::endl;
-                success_count++;
+                type_stats.topics += publisher->getPublishTopics().size();
+                type_stats.bytes += publisher->getPublishTopics().memoryUsage();
+            }
+        }
+    }
+    return stats;
+}
 
-                // Mark as subscribed
-                std::lock_guard<std::mutex> lock(handlers_mutex_);
-                for (auto &h : topic_handlers_)
+NodeMessageDistributor::Route NodeMessageDistributor::route(const std::string &msg_topic) const
+{
+    Route result{loadRouting(), {}};
+    // Single trie walk returns every handler whose (possibly wildcard) topic covers msg_topic
+    result.routing->trie.match(msg_topic, result.handlers);
+    const auto &handlers = result.routing->handlers;
+    std::erase_if(result.handlers, [&handlers](size_t index)
+                  { return !handlers[index].subscribed || handlers[index].instances.empty(); });
+    return result;
+}
+
+std::optional<mqtt_utils::PayloadEncoding> NodeMessageDistributor::routeFor(const std::string &msg_topic) const
+{
+    // On the MQTT callback thread for every message: no node topic tables are read here,
+    // updateRouting resolved each handler's encoding once
+    Route matched = route(msg_topic);
+    if (!matched)
+    {
+        return std::nullopt;
+    }
+    return matched.routing->handlers[matched.handlers.front()].encoding;
+}
+
+void NodeMessageDistributor::updateRouting(const std::function<void(std::vector<TopicHandler> &)> &mutate,
+                                           bool wait_for_readers)
+{
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+
+        auto new_routing = std::make_shared<RoutingTable>();
+        new_routing->handlers = loadRouting()->handlers;
+        mutate(new_routing->handlers);
+        for (size_t i = 0; i < new_routing->handlers.size(); ++i)
+        {
+            auto &handler = new_routing->handlers[i];
+            new_routing->trie.insert(handler.topic, i);
+
+            handler.correlated.clear();
+            handler.uncorrelated.clear();
+            handler.encoding = mqtt_utils::PayloadEncoding::Json;
+            bool encoding_found = false;
+            for (MqttSubBase *instance : handler.instances)
+            {
+                if (!instance)
                 {
-                    if (h.topic == topic_str)
+                    continue;
+                }
+                (instance->isCorrelatedTopic(handler.topic) ? handler.correlated : handler.uncorrelated)
+                    .push_back(instance);
+                for (const auto &[key, topic_obj] : instance->getTopics())
+                {
+                    if (!encoding_found && topic_obj.getTopic() == handler.topic)
                     {
-                        h.subscribed = true;
+                        handler.encoding = topic_obj.getEncoding();
+                        encoding_found = true;
                         break;
                     }
                 }
             }
-            else
-            {
-                std::cerr << "  Subscription failed for: " << topic_str << std::endl;
-            }
-        }
-        else
-        {
-            std::cerr << "  Subscription timed out for: " << topic_str << std::endl;
+            std::sort(handler.correlated.begin(), handler.correlated.end());
         }
+
+        std::lock_guard<std::mutex> routing_lock(routing_mutex_);
+        routing_ = std::move(new_routing);
     }
 
-    std::cout << "NodeMessageDistributor: Subscription complete: "
-              << success_count << "/" << topic_handlers_.size() << " topics" << std::endl;
+    if (wait_for_readers)
+    {
+        // Grace period: every delivery holds delivery_mutex_ shared, so once we get it
+        // exclusively, none that started on this or any earlier snapshot is still running
+        std::unique_lock<std::shared_mutex> grace(delivery_mutex_);
+    }
+}
 
-    return success_count == static_cast<int>(topic_handlers_.size());
+void NodeMessageDistributor::markSubscribed(const std::string &topic_str)
+{
+    markSubscribed(std::set<std::string>{topic_str});
 }
 
-void NodeMessageDistributor::handle_incoming_message(const std::string &msg_topic,
-                                                     const json &payload,
-                                                     mqtt::properties props)
+void NodeMessageDistributor::markSubscribed(const std::set<std::string> &topics)
 {
-    // Route message to registered handlers
-    // Note: We rely on MQTT broker retained messages instead of local caching
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
-    bool handled = false;
-    for (const auto &handler : topic_handlers_)
-    {
-        // handler.topic is the subscribed topic (can have wildcards)
-        // msg_topic is the actual topic the message arrived on
-        if (handler.subscribed && mqtt_utils::topicMatches(handler.topic, msg_topic))
+    if (topics.empty())
+    {
+        return;
+    }
+
+    updateRouting([&topics](std::vector<TopicHandler> &handlers)
+                  {
+                      for (auto &h : handlers)
+                      {
+                          if (topics.count(h.topic))
+                          {
+                              h.subscribed = true;
+                          }
+                      } });
+}
+
+void NodeMessageDistributor::storeLastValue(const std::string &msg_topic,
+                                            const std::shared_ptr<const json> &payload,
+                                            const mqtt::properties &props)
+{
+    std::lock_guard<std::mutex> lock(last_value_mutex_);
+    last_values_[msg_topic] = {payload, props};
+}
+
+bool NodeMessageDistributor::attachFromLastValueCache(MqttSubBase *instance,
+                                                      const mqtt_utils::Topic &topic_obj,
+                                                      const std::function<void(std::vector<TopicHandler> &)> &attach)
+{
+    std::lock_guard<std::mutex> lock(last_value_mutex_);
+
+    const std::string &topic_str = topic_obj.getTopic();
+    std::vector<std::pair<std::string, const LastValue *>> seeds;
+    if (topic_str.find_first_of("+#") == std::string::npos)
+    {
+        auto it = last_values_.find(topic_str);
+        if (it != last_values_.end())
         {
-            handler.routeMessage(msg_topic, payload, props);
-            handled = true;
-            // If multiple handlers match (e.g. overlapping wildcards), all will be called.
+            seeds.emplace_back(it->first, &it->second);
+        }
+    }
+    else
+    {
+        for (const auto &[cached_topic, value] : last_values_)
+        {
+            if (topic_obj.matches(cached_topic))
+            {
+                seeds.emplace_back(cached_topic, &value);
+            }
         }
     }
 
-    if (!handled)
+    if (seeds.empty())
     {
-        // Message not handled - this is normal for messages from wildcard subscriptions
-        // that don't have a specific handler (e.g., CMD topics when we only care about DATA)
+        return false;
     }
+
+    // Attach before delivering: any message stored after this point is dispatched with the
+    // new routing, one stored before it is what we deliver here. Having seen the topic means
+    // an existing subscription covers it, so the handler is live right away.
+    updateRouting([&](std::vector<TopicHandler> &handlers)
+                  {
+                      attach(handlers);
+                      for (auto &h : handlers)
+                      {
+                          if (h.topic == topic_str)
+                          {
+                              h.subscribed = true;
+                              break;
+                          }
+                      } });
+    for (const auto &[cached_topic, value] : seeds)
+    {
+        instance->processMessage(cached_topic, *value->payload, value->props);
+    }
+    return true;
 }
 
 void NodeMessageDistributor::registerDerivedInstance(MqttSubBase *instance)
@@ -200,6 +759,7 @@ void NodeMessageDistributor::registerDerivedInstance(MqttSubBase *instance)
     if (!instance)
         return;
 
+    std::lock_guard<std::mutex> lock(registry_mutex_);
     std::type_index instance_type_idx(typeid(*instance));
     node_subscriptions_[instance_type_idx].instances.push_back(instance);
 }
@@ -213,12 +773,17 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
     // First, register the instance in our data structures
     registerDerivedInstance(instance);
 
+    return attachInstanceTopics(instance, timeout);
+}
+
+bool NodeMessageDistributor::attachInstanceTopics(MqttSubBase *instance, std::chrono::milliseconds timeout)
+{
     // Get the topics this node wants to subscribe to
     const auto &topics = instance->getTopics();
     if (topics.empty())
     {
-        std::cerr << "Late-initializing node " << instance->getBTNodeName()
-                  << " has no topics configured" << std::endl;
+        BT_LOG_ERROR << "Late-initializing node " << instance->getBTNodeName()
+                     << " has no topics configured";
         return false;
     }
 
@@ -231,9 +796,9 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
 
         // Check if handler already exists for this topic and add instance if so
         bool handler_exists = false;
+        auto attach = [&](std::vector<TopicHandler> &handlers)
         {
-            std::lock_guard<std::mutex> lock(handlers_mutex_);
-            for (auto &h : topic_handlers_)
+            for (auto &h : handlers)
             {
                 if (h.topic == topic_str)
                 {
@@ -252,7 +817,7 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
                     {
                         // ADD the new instance to the existing handler
                         h.instances.push_back(instance);
-                        std::cout << "  Added late-init instance to existing handler for: " << topic_str << std::endl;
+                        BT_LOG_INFO << "  Added late-init instance to existing handler for: " << topic_str;
                     }
                     break;
                 }
@@ -266,17 +831,27 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
                 handler.instances.push_back(instance);
                 handler.qos = qos;
                 handler.subscribed = false;
-                topic_handlers_.push_back(handler);
+                handlers.push_back(handler);
             }
+        };
+
+        // A topic we have already seen is seeded from the last-value cache; the broker
+        // would only resend the same retained message, to every instance on the topic
+        if (last_value_cache_enabled_ && attachFromLastValueCache(instance, topic_obj, attach))
+        {
+            BT_LOG_INFO << "Late-init node " << instance->getBTNodeName()
+                        << " seeded from last-value cache: " << topic_str;
+            continue;
         }
+        updateRouting(attach);
 
-        // Always (re-)subscribe to trigger retained message delivery
+        // (Re-)subscribe to trigger retained message delivery
         // Re-subscribing is idempotent but causes broker to resend retained message
         try
         {
-            std::cout << "Late-init node " << instance->getBTNodeName()
-                      << (handler_exists ? " re-subscribing to: " : " subscribing to: ") 
-                      << topic_str << std::endl;
+            BT_LOG_INFO << "Late-init node " << instance->getBTNodeName()
+                        << (handler_exists ? " re-subscribing to: " : " subscribing to: ") 
+                        << topic_str;
 
             auto token = mqtt_client_.subscribe_topic(topic_str, qos);
             if (token)
@@ -284,32 +859,24 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
                 bool completed = token->wait_for(timeout);
                 if (!completed)
                 {
-                    std::cerr << "Timeout subscribing to " << topic_str << std::endl;
+                    BT_LOG_ERROR << "Timeout subscribing to " << topic_str;
                     all_success = false;
                 }
                 else if (token->get_return_code() == mqtt::SUCCESS)
                 {
                     // Mark as subscribed
-                    std::lock_guard<std::mutex> lock(handlers_mutex_);
-                    for (auto &h : topic_handlers_)
-                    {
-                        if (h.topic == topic_str)
-                        {
-                            h.subscribed = true;
-                            break;
-                        }
-                    }
+                    markSubscribed(topic_str);
                 }
                 else
                 {
-                    std::cerr << "Subscription failed for " << topic_str << std::endl;
+                    BT_LOG_ERROR << "Subscription failed for " << topic_str;
                     all_success = false;
                 }
             }
         }
         catch (const std::exception &e)
         {
-            std::cerr << "Exception subscribing to " << topic_str << ": " << e.what() << std::endl;
+            BT_LOG_ERROR << "Exception subscribing to " << topic_str << ": " << e.what();
             all_success = false;
         }
     }
@@ -317,16 +884,106 @@ bool NodeMessageDistributor::registerLateInitializingNode(MqttSubBase *instance,
     return all_success;
 }
 
+size_t NodeMessageDistributor::refreshInstancesUsing(const std::vector<mqtt_utils::Topic> &stale_topics,
+                                                     std::chrono::milliseconds timeout)
+{
+    if (stale_topics.empty())
+    {
+        return 0;
+    }
+
+    // Node topics may be concrete instances of a wildcarded interface topic
+    auto uses_stale_topic = [&stale_topics](const mqtt_utils::TopicMap &topics)
+    {
+        for (const auto &[key, topic_obj] : topics)
+        {
+            for (const auto &stale : stale_topics)
+            {
+                if (topic_obj.getTopic() == stale.getTopic() || stale.matches(topic_obj.getTopic()))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    std::vector<MqttSubBase *> affected;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        for (const auto &[type_idx, subscription] : node_subscriptions_)
+        {
+            for (MqttSubBase *instance : subscription.instances)
+            {
+                if (!instance || std::find(affected.begin(), affected.end(), instance) != affected.end())
+                {
+                    continue;
+                }
+                const auto *publisher = dynamic_cast<const MqttPubBase *>(instance);
+                if (uses_stale_topic(instance->getTopics()) ||
+                    (publisher && uses_stale_topic(publisher->getPublishTopics())))
+                {
+                    affected.push_back(instance);
+                }
+            }
+        }
+    }
+    if (affected.empty())
+    {
+        return 0;
+    }
+
+    // Detach first and wait for in-flight deliveries, so no callback reads the topics
+    // while they are replaced
+    updateRouting([&affected](std::vector<TopicHandler> &handlers)
+                  {
+                      for (auto &handler : handlers)
+                      {
+                          auto &instances_vec = handler.instances;
+                          instances_vec.erase(std::remove_if(instances_vec.begin(), instances_vec.end(),
+                                                             [&affected](MqttSubBase *instance)
+                                                             { return std::find(affected.begin(), affected.end(), instance) != affected.end(); }),
+                                              instances_vec.end());
+                      } },
+                  true);
+
+    size_t refreshed = 0;
+    for (MqttSubBase *instance : affected)
+    {
+        if (instance->refreshTopicsFromAAS())
+        {
+            refreshed++;
+            BT_LOG_INFO << "Node " << instance->getBTNodeName() << " re-resolved its topics after an AAS change";
+        }
+        // Unchanged nodes get their previous routing back
+        attachInstanceTopics(instance, timeout);
+    }
+    return refreshed;
+}
+
 void NodeMessageDistributor::unregisterInstance(MqttSubBase *instance)
 {
     if (!instance)
         return;
 
-    std::type_index instance_type_idx(typeid(*instance));
-    auto it = node_subscriptions_.find(instance_type_idx);
-    if (it != node_subscriptions_.end())
+    // Publish a table without the instance and wait for in-flight deliveries on the old one;
+    // afterwards no dispatch can reach this instance
+    updateRouting([instance](std::vector<TopicHandler> &handlers)
+                  {
+                      for (auto &handler : handlers)
+                      {
+                          auto &instances_vec = handler.instances;
+                          instances_vec.erase(std::remove(instances_vec.begin(), instances_vec.end(), instance), instances_vec.end());
+                      } },
+                  true);
+    releaseResponses(instance);
+
+    // Called from base-class destructors, where typeid no longer yields the derived type,
+    // so remove the instance from every registered type
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (auto &[type_idx, subscription] : node_subscriptions_)
     {
-        auto &instances_vec = it->second.instances;
+        auto &instances_vec = subscription.instances;
         instances_vec.erase(std::remove(instances_vec.begin(), instances_vec.end(), instance), instances_vec.end());
     }
-}
\ No newline at end of file
+}
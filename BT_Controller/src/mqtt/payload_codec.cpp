@@ -0,0 +1,82 @@
+#include "mqtt/payload_codec.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+namespace mqtt_utils
+{
+    std::optional<PayloadEncoding> parsePayloadEncoding(std::string_view content_type)
+    {
+        content_type = content_type.substr(0, content_type.find(';'));
+        while (!content_type.empty() && std::isspace(static_cast<unsigned char>(content_type.back())))
+        {
+            content_type.remove_suffix(1);
+        }
+        while (!content_type.empty() && std::isspace(static_cast<unsigned char>(content_type.front())))
+        {
+            content_type.remove_prefix(1);
+        }
+
+        std::string type(content_type);
+        std::transform(type.begin(), type.end(), type.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+
+        if (type == "application/json" || type == "text/json")
+            return PayloadEncoding::Json;
+        if (type == "application/cbor")
+            return PayloadEncoding::Cbor;
+        if (type == "application/msgpack" || type == "application/x-msgpack" || type == "application/vnd.msgpack")
+            return PayloadEncoding::MsgPack;
+        return std::nullopt;
+    }
+
+    const char *contentTypeFor(PayloadEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case PayloadEncoding::Cbor:
+            return "application/cbor";
+        case PayloadEncoding::MsgPack:
+            return "application/msgpack";
+        case PayloadEncoding::Json:
+        default:
+            return "application/json";
+        }
+    }
+
+    nlohmann::json decodePayload(std::string_view payload, PayloadEncoding encoding)
+    {
+        const auto *begin = reinterpret_cast<const std::uint8_t *>(payload.data());
+        const auto *end = begin + payload.size();
+        switch (encoding)
+        {
+        case PayloadEncoding::Cbor:
+            return nlohmann::json::from_cbor(begin, end);
+        case PayloadEncoding::MsgPack:
+            return nlohmann::json::from_msgpack(begin, end);
+        case PayloadEncoding::Json:
+        default:
+            return nlohmann::json::parse(payload);
+        }
+    }
+
+    std::string encodePayload(const nlohmann::json &payload, PayloadEncoding encoding)
+    {
+        std::string out;
+        switch (encoding)
+        {
+        case PayloadEncoding::Cbor:
+            nlohmann::json::to_cbor(payload, nlohmann::detail::output_adapter<char>(out));
+            break;
+        case PayloadEncoding::MsgPack:
+            nlohmann::json::to_msgpack(payload, nlohmann::detail::output_adapter<char>(out));
+            break;
+        case PayloadEncoding::Json:
+        default:
+            out = payload.dump();
+            break;
+        }
+        return out;
+    }
+}
@@ -0,0 +1,101 @@
+#include "mqtt/state_publisher.h"
+#include "mqtt/mqtt_client.h"
+#include <algorithm>
+
+StatePublisher::StatePublisher(MqttClient &mqtt_client, std::chrono::milliseconds coalesce_window)
+    : mqtt_client_(mqtt_client),
+      coalesce_window_(std::max(coalesce_window, std::chrono::milliseconds(0)))
+{
+    worker_ = std::thread(&StatePublisher::workerLoop, this);
+}
+
+StatePublisher::~StatePublisher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+void StatePublisher::post(const std::string &topic, nlohmann::json payload, int qos, bool retain, bool coalesce)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto due = coalesce ? now + coalesce_window_ : now;
+    if (coalesce)
+    {
+        // Last writer wins: the waiting message is dropped and the new one keeps its deadline,
+        // queued behind everything posted in between
+        auto waiting = std::find_if(queue_.begin(), queue_.end(),
+                                    [&topic](const Pending &pending)
+                                    { return pending.coalesce && pending.topic == topic; });
+        if (waiting != queue_.end())
+        {
+            due = waiting->due;
+            queue_.erase(waiting);
+        }
+    }
+    queue_.push_back({topic, std::move(payload), qos, retain, coalesce, due});
+    cv_.notify_one();
+}
+
+void StatePublisher::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushing_ = true;
+    cv_.notify_all();
+    idle_cv_.wait(lock, [this]()
+                  { return queue_.empty() && !publishing_; });
+    flushing_ = false;
+}
+
+void StatePublisher::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        if (queue_.empty())
+        {
+            idle_cv_.notify_all();
+            if (stopping_)
+            {
+                return;
+            }
+            cv_.wait(lock, [this]()
+                     { return stopping_ || !queue_.empty(); });
+            continue;
+        }
+
+        auto due = queue_.front().due;
+        if (!flushing_ && !stopping_ && std::chrono::steady_clock::now() < due)
+        {
+            cv_.wait_until(lock, due);
+            continue;
+        }
+
+        // While disconnected the queue holds, so State keeps coalescing and only its latest
+        // version goes out on reconnect; flush and shutdown hand it to the offline queue instead
+        if (!flushing_ && !stopping_ && !mqtt_client_.is_connected())
+        {
+            cv_.wait_for(lock, kReconnectPoll);
+            continue;
+        }
+
+        Pending next = std::move(queue_.front());
+        queue_.pop_front();
+        publishing_ = true;
+        lock.unlock();
+
+        // Broker backpressure stalls only this thread
+        mqtt_client_.publish_message(next.topic, next.payload, next.qos, next.retain);
+
+        lock.lock();
+        publishing_ = false;
+    }
+}
@@ -0,0 +1,119 @@
+#include "mqtt/topic_trie.h"
+
+TopicTrie::TopicTrie() : root_(std::make_unique<Node>()) {}
+
+TopicTrie::~TopicTrie() = default;
+
+TopicTrie::TopicTrie(TopicTrie &&) noexcept = default;
+
+TopicTrie &TopicTrie::operator=(TopicTrie &&) noexcept = default;
+
+void TopicTrie::insert(const std::string &pattern, size_t value)
+{
+    if (!root_)
+    {
+        root_ = std::make_unique<Node>();
+    }
+
+    Node *node = root_.get();
+    std::string_view remaining(pattern);
+
+    while (true)
+    {
+        size_t pos = remaining.find('/');
+        std::string_view level = remaining.substr(0, pos);
+
+        if (level == "#")
+        {
+            // '#' must be the last level; anything after it is ignored
+            node->multi_level.push_back(value);
+            size_++;
+            return;
+        }
+
+        if (level == "+")
+        {
+            if (!node->single_level)
+            {
+                node->single_level = std::make_unique<Node>();
+            }
+            node = node->single_level.get();
+        }
+        else
+        {
+            auto it = node->children.find(level);
+            if (it == node->children.end())
+            {
+                it = node->children.emplace(std::string(level), std::make_unique<Node>()).first;
+            }
+            node = it->second.get();
+        }
+
+        if (pos == std::string_view::npos)
+        {
+            break;
+        }
+        remaining.remove_prefix(pos + 1);
+    }
+
+    node->values.push_back(value);
+    size_++;
+}
+
+void TopicTrie::clear()
+{
+    root_ = std::make_unique<Node>();
+    size_ = 0;
+}
+
+void TopicTrie::match(std::string_view topic, std::vector<size_t> &out) const
+{
+    if (!root_ || size_ == 0)
+    {
+        return;
+    }
+
+    // Topics starting with '$' are not matched by wildcards at the first level
+    if (!topic.empty() && topic.front() == '$')
+    {
+        size_t pos = topic.find('/');
+        auto it = root_->children.find(topic.substr(0, pos));
+        if (it != root_->children.end())
+        {
+            bool at_end = pos == std::string_view::npos;
+            matchLevel(it->second.get(), at_end ? std::string_view() : topic.substr(pos + 1), at_end, out);
+        }
+        return;
+    }
+
+    matchLevel(root_.get(), topic, false, out);
+}
+
+void TopicTrie::matchLevel(const Node *node, std::string_view remaining, bool at_end,
+                           std::vector<size_t> &out)
+{
+    // A trailing '#' also matches the parent level ("a/#" matches "a")
+    out.insert(out.end(), node->multi_level.begin(), node->multi_level.end());
+
+    if (at_end)
+    {
+        out.insert(out.end(), node->values.begin(), node->values.end());
+        return;
+    }
+
+    size_t pos = remaining.find('/');
+    std::string_view level = remaining.substr(0, pos);
+    bool next_at_end = pos == std::string_view::npos;
+    std::string_view rest = next_at_end ? std::string_view() : remaining.substr(pos + 1);
+
+    auto it = node->children.find(level);
+    if (it != node->children.end())
+    {
+        matchLevel(it->second.get(), rest, next_at_end, out);
+    }
+
+    if (node->single_level)
+    {
+        matchLevel(node->single_level.get(), rest, next_at_end, out);
+    }
+}
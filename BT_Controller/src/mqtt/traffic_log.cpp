@@ -0,0 +1,387 @@
+#include "mqtt/traffic_log.h"
+#include "mqtt/node_message_distributor.h"
+#include "mqtt/payload_codec.h"
+#include "logging/logger.h"
+
+#include <mqtt/async_client.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr size_t kAlignment = 8;
+
+    size_t alignedSize(size_t size)
+    {
+        return (size + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    std::string propertyString(const mqtt::properties &props, mqtt::property::code code)
+    {
+        return props.contains(code) ? mqtt::get<std::string>(props, code) : std::string();
+    }
+
+    std::string base64Decode(std::string_view input)
+    {
+        static const auto table = []()
+        {
+            std::array<int8_t, 256> t{};
+            t.fill(-1);
+            const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for (int i = 0; i < 64; ++i)
+            {
+                t[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+            }
+            return t;
+        }();
+
+        std::string output;
+        output.reserve(input.size() * 3 / 4);
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : input)
+        {
+            int8_t value = table[static_cast<uint8_t>(c)];
+            if (value < 0)
+            {
+                continue; // Padding and line breaks
+            }
+            buffer = (buffer << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                output.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+            }
+        }
+        return output;
+    }
+}
+
+// --- TrafficRecorder ---
+
+TrafficRecorder::~TrafficRecorder()
+{
+    close();
+}
+
+bool TrafficRecorder::open(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_)
+    {
+        std::fclose(file_);
+    }
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_)
+    {
+        BT_LOG_ERROR << "TrafficRecorder: Cannot open " << path << ": " << std::strerror(errno);
+        return false;
+    }
+    if (std::ftell(file_) == 0)
+    {
+        std::fwrite(traffic_log::kMagic, 1, sizeof(traffic_log::kMagic), file_);
+    }
+    BT_LOG_INFO << "TrafficRecorder: Recording received MQTT traffic to " << path;
+    return true;
+}
+
+void TrafficRecorder::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void TrafficRecorder::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_)
+    {
+        std::fflush(file_);
+    }
+}
+
+void TrafficRecorder::record(const std::string &topic, const mqtt::message &msg)
+{
+    const auto &props = msg.get_properties();
+    std::string content_type = propertyString(props, mqtt::property::CONTENT_TYPE);
+    std::string response_topic = propertyString(props, mqtt::property::RESPONSE_TOPIC);
+    std::string correlation_data = propertyString(props, mqtt::property::CORRELATION_DATA);
+    const std::string &payload = msg.get_payload_ref();
+
+    traffic_log::Record record;
+    record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    record.topic = topic;
+    record.content_type = content_type;
+    record.response_topic = response_topic;
+    record.correlation_data = correlation_data;
+    record.payload = std::string_view(payload.data(), payload.size());
+    record.qos = msg.get_qos();
+    record.retained = msg.is_retained();
+    this->record(record);
+}
+
+void TrafficRecorder::record(const traffic_log::Record &record)
+{
+    auto clamp16 = [](size_t size)
+    { return static_cast<uint16_t>(std::min<size_t>(size, UINT16_MAX)); };
+
+    traffic_log::RecordHeader header{};
+    header.topic_size = clamp16(record.topic.size());
+    header.content_type_size = clamp16(record.content_type.size());
+    header.response_topic_size = clamp16(record.response_topic.size());
+    header.correlation_size = clamp16(record.correlation_data.size());
+    header.payload_size = static_cast<uint32_t>(std::min<size_t>(record.payload.size(), UINT32_MAX - 4096));
+    header.time_ns = record.time.count();
+    header.qos = static_cast<uint8_t>(record.qos);
+    header.retained = record.retained ? 1 : 0;
+    size_t unpadded = sizeof(header) + header.topic_size + header.content_type_size + header.response_topic_size +
+                      header.correlation_size + header.payload_size;
+    header.size = static_cast<uint32_t>(alignedSize(unpadded));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_)
+    {
+        return;
+    }
+    scratch_.assign(header.size, 0);
+    char *out = scratch_.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (auto [part, size] : {std::pair{record.topic, header.topic_size},
+                              std::pair{record.content_type, header.content_type_size},
+                              std::pair{record.response_topic, header.response_topic_size},
+                              std::pair{record.correlation_data, header.correlation_size}})
+    {
+        std::memcpy(out, part.data(), size);
+        out += size;
+    }
+    std::memcpy(out, record.payload.data(), header.payload_size);
+    // One write per record, so a reader never sees a record without its header
+    std::fwrite(scratch_.data(), 1, scratch_.size(), file_);
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --- TrafficLog ---
+
+TrafficLog::~TrafficLog()
+{
+    unmap();
+}
+
+void TrafficLog::unmap()
+{
+    if (data_)
+    {
+        ::munmap(data_, length_);
+        data_ = nullptr;
+        length_ = 0;
+    }
+    records_.clear();
+}
+
+bool TrafficLog::open(const std::string &path)
+{
+    unmap();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        BT_LOG_ERROR << "TrafficLog: Cannot open " << path << ": " << std::strerror(errno);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(traffic_log::kMagic))
+    {
+        ::close(fd);
+        BT_LOG_ERROR << "TrafficLog: " << path << " is not a traffic log";
+        return false;
+    }
+    length_ = static_cast<size_t>(st.st_size);
+    void *data = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        length_ = 0;
+        BT_LOG_ERROR << "TrafficLog: Cannot map " << path << ": " << std::strerror(errno);
+        return false;
+    }
+    data_ = data;
+
+    const char *base = static_cast<const char *>(data_);
+    if (std::memcmp(base, traffic_log::kMagic, sizeof(traffic_log::kMagic)) != 0)
+    {
+        unmap();
+        BT_LOG_ERROR << "TrafficLog: " << path << " is not a traffic log";
+        return false;
+    }
+    ::madvise(data_, length_, MADV_SEQUENTIAL);
+
+    size_t offset = sizeof(traffic_log::kMagic);
+    while (offset + sizeof(traffic_log::RecordHeader) <= length_)
+    {
+        traffic_log::RecordHeader header;
+        std::memcpy(&header, base + offset, sizeof(header));
+        size_t content = sizeof(header) + header.topic_size + header.content_type_size +
+                         header.response_topic_size + header.correlation_size + header.payload_size;
+        if (header.size < content || header.size % kAlignment != 0 || offset + header.size > length_)
+        {
+            break; // Truncated by a crash while writing
+        }
+
+        const char *field = base + offset + sizeof(header);
+        auto take = [&field](size_t size)
+        {
+            std::string_view view(field, size);
+            field += size;
+            return view;
+        };
+        traffic_log::Record record;
+        record.time = std::chrono::nanoseconds(header.time_ns);
+        record.topic = take(header.topic_size);
+        record.content_type = take(header.content_type_size);
+        record.response_topic = take(header.response_topic_size);
+        record.correlation_data = take(header.correlation_size);
+        record.payload = take(header.payload_size);
+        record.qos = header.qos;
+        record.retained = header.retained != 0;
+        records_.push_back(record);
+        offset += header.size;
+    }
+    if (offset != length_)
+    {
+        BT_LOG_WARN << "TrafficLog: Ignoring " << length_ - offset << " trailing bytes of " << path;
+    }
+    return true;
+}
+
+std::chrono::nanoseconds TrafficLog::duration() const
+{
+    return records_.empty() ? std::chrono::nanoseconds(0) : records_.back().time - records_.front().time;
+}
+
+long importNdjsonCapture(const std::string &ndjson_path, TrafficRecorder &recorder)
+{
+    std::ifstream input(ndjson_path);
+    if (!input.is_open() || !recorder.isOpen())
+    {
+        BT_LOG_ERROR << "importNdjsonCapture: Cannot read " << ndjson_path;
+        return -1;
+    }
+
+    long written = 0;
+    size_t line_number = 0;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        ++line_number;
+        if (line.empty())
+        {
+            continue;
+        }
+        try
+        {
+            auto entry = nlohmann::json::parse(line);
+            std::string topic = entry.at("topic").get<std::string>();
+            std::string payload = base64Decode(entry.at("msg_b64").get<std::string>());
+
+            traffic_log::Record record;
+            record.time = std::chrono::nanoseconds(static_cast<int64_t>(entry.at("time").get<double>() * 1e9));
+            record.topic = topic;
+            record.payload = payload;
+            record.qos = entry.value("qos", 0);
+            record.retained = entry.value("retain", false);
+            recorder.record(record);
+            ++written;
+        }
+        catch (const std::exception &e)
+        {
+            BT_LOG_WARN << "importNdjsonCapture: Skipping line " << line_number << ": " << e.what();
+        }
+    }
+    recorder.flush();
+    return written;
+}
+
+// --- TrafficReplayer ---
+
+TrafficReplayer::TrafficReplayer(const TrafficLog &log, NodeMessageDistributor &distributor)
+    : log_(log),
+      distributor_(distributor)
+{
+}
+
+TrafficReplayer::Result TrafficReplayer::run(double speed)
+{
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    const auto &records = log_.records();
+    if (records.empty())
+    {
+        return result;
+    }
+
+    stopping_ = false;
+    const auto first_time = records.front().time;
+    const auto start = Clock::now();
+    std::string topic;
+    for (const auto &record : records)
+    {
+        if (stopping_)
+        {
+            break;
+        }
+        if (speed > 0)
+        {
+            auto offset = std::chrono::duration_cast<Clock::duration>((record.time - first_time) / speed);
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        mqtt::properties props;
+        if (!record.content_type.empty())
+        {
+            props.add({mqtt::property::CONTENT_TYPE, std::string(record.content_type)});
+        }
+        if (!record.response_topic.empty())
+        {
+            props.add({mqtt::property::RESPONSE_TOPIC, std::string(record.response_topic)});
+        }
+        if (!record.correlation_data.empty())
+        {
+            props.add({mqtt::property::CORRELATION_DATA, std::string(record.correlation_data)});
+        }
+
+        topic.assign(record.topic);
+        // As MqttClient: the content type first, else what the AAS declares for the topic
+        auto encoding = record.content_type.empty()
+                            ? distributor_.routeFor(topic).value_or(mqtt_utils::PayloadEncoding::Json)
+                            : mqtt_utils::parsePayloadEncoding(record.content_type).value_or(mqtt_utils::PayloadEncoding::Json);
+        try
+        {
+            auto payload = std::make_shared<const nlohmann::json>(mqtt_utils::decodePayload(record.payload, encoding));
+            distributor_.handle_incoming_message(topic, payload, std::move(props));
+            ++result.messages;
+        }
+        catch (const std::exception &)
+        {
+            ++result.decode_errors;
+        }
+        result.recorded_ms = std::chrono::duration<double, std::milli>(record.time - first_time).count();
+    }
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
@@ -4,10 +4,15 @@
 #include <filesystem>
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
 #include <regex>
 #include <cstdlib>
 #include <uuid/uuid.h>
 #include <curl/curl.h>
+#include "http/http_transport.h"
+#include "bt/sim_clock.h"
 #include <nlohmann/json-schema.hpp>
 #include <fmt/chrono.h>
 #include <chrono>
@@ -17,7 +22,7 @@ namespace bt_utils
 {
     std::string getCurrentTimestampISO()
     {
-        auto now = std::chrono::system_clock::now();
+        auto now = SimClock::systemNow();
         auto time_point_ms = std::chrono::floor<std::chrono::milliseconds>(now);
         auto time_point_s = std::chrono::time_point_cast<std::chrono::seconds>(time_point_ms);
         auto fraction_ms = time_point_ms - time_point_s;
@@ -88,18 +93,7 @@ namespace bt_utils
         return result;
     }
 
-    bool loadConfigFromYaml(const std::string &filename,
-                            bool &generate_xml_models,
-                            std::string &serverURI,
-                            std::string &clientId,
-                            std::string &unsTopicPrefix,
-                            std::string &aasServerUri,
-                            std::string &aasRegistryUrl,
-                            int &groot2_port,
-                            std::string &bt_description_path,
-                            std::string &bt_nodes_path,
-                            std::string &registration_config_path,
-                            std::string &registration_topic_pattern)
+    bool loadConfigFromYaml(const std::string &filename, ControllerConfig &params)
     {
         try
         {
@@ -118,22 +112,82 @@ namespace bt_utils
 
                 if (mqtt["broker_uri"])
                 {
-                    serverURI = expandEnvVars(mqtt["broker_uri"].as<std::string>());
+                    params.serverURI = expandEnvVars(mqtt["broker_uri"].as<std::string>());
                     // Add "tcp://" prefix if not present
-                    if (serverURI.find("://") == std::string::npos)
+                    if (params.serverURI.find("://") == std::string::npos)
                     {
-                        serverURI = "tcp://" + serverURI;
+                        params.serverURI = "tcp://" + params.serverURI;
                     }
                 }
 
                 if (mqtt["client_id"])
                 {
-                    clientId = expandEnvVars(mqtt["client_id"].as<std::string>());
+                    params.clientId = expandEnvVars(mqtt["client_id"].as<std::string>());
                 }
 
                 if (mqtt["uns_topic"])
                 {
-                    unsTopicPrefix = expandEnvVars(mqtt["uns_topic"].as<std::string>());
+                    params.unsTopicPrefix = expandEnvVars(mqtt["uns_topic"].as<std::string>());
+                }
+
+                if (mqtt["lazy_payload_parsing"])
+                {
+                    params.lazy_payload_parsing = mqtt["lazy_payload_parsing"].as<bool>();
+                }
+
+                if (mqtt["dispatch_workers"])
+                {
+                    params.dispatch_workers = mqtt["dispatch_workers"].as<int>();
+                }
+
+                if (mqtt["dispatch_queue_capacity"])
+                {
+                    params.dispatch_queue_capacity = mqtt["dispatch_queue_capacity"].as<int>();
+                }
+
+                if (mqtt["last_value_cache"])
+                {
+                    params.last_value_cache = mqtt["last_value_cache"].as<bool>();
+                }
+
+                if (mqtt["state_coalesce_window_ms"])
+                {
+                    params.state_coalesce_window_ms = mqtt["state_coalesce_window_ms"].as<int>();
+                }
+
+                if (mqtt["topic_alias_maximum"])
+                {
+                    params.topic_alias_maximum = mqtt["topic_alias_maximum"].as<int>();
+                }
+
+                if (mqtt["shared_group"])
+                {
+                    params.shared_group = expandEnvVars(mqtt["shared_group"].as<std::string>());
+                }
+
+                if (mqtt["session"])
+                {
+                    auto session = mqtt["session"];
+                    if (session["resume"])
+                    {
+                        params.mqtt_session.resume = session["resume"].as<bool>();
+                    }
+                    if (session["expiry_s"])
+                    {
+                        params.mqtt_session.expiry_s = session["expiry_s"].as<int>();
+                    }
+                    if (session["offline_buffer"])
+                    {
+                        params.mqtt_session.offline_buffer = session["offline_buffer"].as<size_t>();
+                    }
+                    if (session["reconnect_min_ms"])
+                    {
+                        params.mqtt_session.reconnect_min_ms = session["reconnect_min_ms"].as<int>();
+                    }
+                    if (session["reconnect_max_ms"])
+                    {
+                        params.mqtt_session.reconnect_max_ms = session["reconnect_max_ms"].as<int>();
+                    }
                 }
             }
 
@@ -144,12 +198,17 @@ namespace bt_utils
 
                 if (aas["server_url"])
                 {
-                    aasServerUri = expandEnvVars(aas["server_url"].as<std::string>());
+                    params.aasServerUrl = expandEnvVars(aas["server_url"].as<std::string>());
                 }
 
                 if (aas["registry_url"])
                 {
-                    aasRegistryUrl = expandEnvVars(aas["registry_url"].as<std::string>());
+                    params.aasRegistryUrl = expandEnvVars(aas["registry_url"].as<std::string>());
+                }
+
+                if (aas["snapshot_path"])
+                {
+                    params.aas_snapshot_path = expandEnvVars(aas["snapshot_path"].as<std::string>());
                 }
             }
 
@@ -160,7 +219,17 @@ namespace bt_utils
 
                 if (groot2["port"])
                 {
-                    groot2_port = groot2["port"].as<int>();
+                    params.groot2_port = groot2["port"].as<int>();
+                }
+
+                if (groot2["mode"])
+                {
+                    params.groot2_monitor.mode = expandEnvVars(groot2["mode"].as<std::string>());
+                }
+
+                if (groot2["snapshot_interval_ms"])
+                {
+                    params.groot2_monitor.snapshot_interval_ms = groot2["snapshot_interval_ms"].as<int>();
                 }
             }
 
@@ -171,17 +240,220 @@ namespace bt_utils
 
                 if (bt["generate_xml_models"])
                 {
-                    generate_xml_models = bt["generate_xml_models"].as<bool>();
+                    params.generate_xml_models = bt["generate_xml_models"].as<bool>();
                 }
 
                 if (bt["description_path"])
                 {
-                    bt_description_path = expandEnvVars(bt["description_path"].as<std::string>());
+                    params.bt_description_path = expandEnvVars(bt["description_path"].as<std::string>());
                 }
 
                 if (bt["nodes_path"])
                 {
-                    bt_nodes_path = expandEnvVars(bt["nodes_path"].as<std::string>());
+                    params.bt_nodes_path = expandEnvVars(bt["nodes_path"].as<std::string>());
+                }
+
+                if (bt["max_idle_interval_ms"])
+                {
+                    params.max_idle_interval_ms = bt["max_idle_interval_ms"].as<int>();
+                }
+
+                if (bt["max_concurrent_processes"])
+                {
+                    params.max_concurrent_processes = bt["max_concurrent_processes"].as<int>();
+                }
+
+                if (bt["parallel_tick_workers"])
+                {
+                    params.parallel_tick_workers = bt["parallel_tick_workers"].as<int>();
+                }
+
+                if (bt["warm_restart"])
+                {
+                    params.warm_restart = bt["warm_restart"].as<bool>();
+                }
+            }
+
+            // Parse Schemas section
+            if (config["schemas"])
+            {
+                auto schemas = config["schemas"];
+
+                if (schemas["cache_dir"])
+                {
+                    params.schema_cache_dir = expandEnvVars(schemas["cache_dir"].as<std::string>());
+                }
+
+                if (schemas["validation"])
+                {
+                    auto validation = schemas["validation"];
+
+                    if (validation["default"])
+                    {
+                        std::string name = validation["default"].as<std::string>();
+                        if (auto policy = mqtt_utils::parseValidationPolicy(name))
+                        {
+                            params.validation.default_policy = *policy;
+                        }
+                        else
+                        {
+                            std::cerr << "Unknown validation policy '" << name << "', keeping 'always'" << std::endl;
+                        }
+                    }
+
+                    if (validation["sample_first"])
+                    {
+                        params.validation.sample_first = validation["sample_first"].as<uint64_t>();
+                    }
+
+                    if (validation["sample_every"])
+                    {
+                        params.validation.sample_every = validation["sample_every"].as<uint64_t>();
+                    }
+
+                    if (validation["topics"])
+                    {
+                        for (const auto &entry : validation["topics"])
+                        {
+                            std::string filter = expandEnvVars(entry.first.as<std::string>());
+                            std::string name = entry.second.as<std::string>();
+                            if (auto policy = mqtt_utils::parseValidationPolicy(name))
+                            {
+                                params.validation.topic_policies.emplace_back(mqtt_utils::CompiledTopicPattern(filter), *policy);
+                            }
+                            else
+                            {
+                                std::cerr << "Unknown validation policy '" << name << "' for " << filter << ", ignored" << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Parse Logging section
+            if (config["logging"])
+            {
+                auto logging_config = config["logging"];
+
+                if (logging_config["level"])
+                {
+                    params.log_level = logging_config["level"].as<std::string>();
+                }
+            }
+
+            // Parse Metrics section
+            if (config["metrics"])
+            {
+                auto metrics = config["metrics"];
+
+                if (metrics["publish_interval_ms"])
+                {
+                    params.metrics_publish_interval_ms = metrics["publish_interval_ms"].as<int>();
+                }
+
+                if (metrics["starting_trace_dir"])
+                {
+                    params.starting_trace_dir = expandEnvVars(metrics["starting_trace_dir"].as<std::string>());
+                }
+
+                if (metrics["trace_format"])
+                {
+                    params.trace_format = metrics["trace_format"].as<std::string>();
+                }
+
+                if (metrics["traffic_record_path"])
+                {
+                    params.traffic_record_path = expandEnvVars(metrics["traffic_record_path"].as<std::string>());
+                }
+
+                if (metrics["command_trace"])
+                {
+                    params.command_trace = expandEnvVars(metrics["command_trace"].as<std::string>());
+                }
+            }
+
+            // Parse Command Deadlines section
+            if (config["command_deadlines"])
+            {
+                auto deadlines = config["command_deadlines"];
+
+                if (deadlines["resolution_ms"])
+                {
+                    params.command_deadlines.resolution_ms = deadlines["resolution_ms"].as<int>();
+                }
+
+                if (deadlines["ack_timeout_ms"])
+                {
+                    params.command_deadlines.ack_timeout_ms = deadlines["ack_timeout_ms"].as<int>();
+                }
+
+                if (deadlines["completion_timeout_ms"])
+                {
+                    params.command_deadlines.completion_timeout_ms = deadlines["completion_timeout_ms"].as<int>();
+                }
+
+                if (deadlines["release_timeout_ms"])
+                {
+                    params.command_deadlines.release_timeout_ms = deadlines["release_timeout_ms"].as<int>();
+                }
+
+                if (deadlines["retries"])
+                {
+                    params.command_deadlines.retries = deadlines["retries"].as<int>();
+                }
+
+                if (deadlines["backoff"])
+                {
+                    params.command_deadlines.backoff = deadlines["backoff"].as<double>();
+                }
+            }
+
+            // Parse Move Batching section
+            if (config["move_batching"])
+            {
+                auto batching = config["move_batching"];
+
+                if (batching["asset"])
+                {
+                    params.move_batching.asset = expandEnvVars(batching["asset"].as<std::string>());
+                }
+
+                if (batching["window_ms"])
+                {
+                    params.move_batching.window_ms = batching["window_ms"].as<int>();
+                }
+            }
+
+            // Parse Scheduler section
+            if (config["scheduler"])
+            {
+                auto scheduling = config["scheduler"];
+
+                if (scheduling["occupy_policy"])
+                {
+                    params.scheduler.occupy_policy = expandEnvVars(scheduling["occupy_policy"].as<std::string>());
+                }
+            }
+
+            // Parse Simulation Clock section
+            if (config["sim_clock"])
+            {
+                auto clock = config["sim_clock"];
+
+                if (clock["mode"])
+                {
+                    params.sim_clock.mode = expandEnvVars(clock["mode"].as<std::string>());
+                }
+
+                if (clock["speed"])
+                {
+                    // Expanded first so SIM_SPEED can set it, as it does for the stations
+                    params.sim_clock.speed = YAML::Load(expandEnvVars(clock["speed"].as<std::string>())).as<double>();
+                }
+
+                if (clock["topic"])
+                {
+                    params.sim_clock.topic = expandEnvVars(clock["topic"].as<std::string>());
                 }
             }
 
@@ -192,26 +464,96 @@ namespace bt_utils
 
                 if (reg["config_path"])
                 {
-                    registration_config_path = expandEnvVars(reg["config_path"].as<std::string>());
+                    params.registration_config_path = expandEnvVars(reg["config_path"].as<std::string>());
                 }
 
                 if (reg["topic_pattern"])
                 {
-                    registration_topic_pattern = expandEnvVars(reg["topic_pattern"].as<std::string>());
+                    params.registration_topic_pattern = expandEnvVars(reg["topic_pattern"].as<std::string>());
+                }
+
+                if (reg["response_topic"])
+                {
+                    params.registration_response_topic = expandEnvVars(reg["response_topic"].as<std::string>());
                 }
             }
 
             std::cout << "Configuration loaded from: " << filename << std::endl;
-            std::cout << "  MQTT Broker: " << serverURI << std::endl;
-            std::cout << "  Client ID: " << clientId << std::endl;
-            std::cout << "  UNS Topic Prefix: " << unsTopicPrefix << std::endl;
-            std::cout << "  AAS Server: " << aasServerUri << std::endl;
-            std::cout << "  AAS Registry: " << aasRegistryUrl << std::endl;
-            std::cout << "  Groot2 Port: " << groot2_port << std::endl;
-            if (!registration_config_path.empty())
+            std::cout << "  MQTT Broker: " << params.serverURI << std::endl;
+            std::cout << "  Client ID: " << params.clientId << std::endl;
+            std::cout << "  UNS Topic Prefix: " << params.unsTopicPrefix << std::endl;
+            std::cout << "  AAS Server: " << params.aasServerUrl << std::endl;
+            std::cout << "  AAS Registry: " << params.aasRegistryUrl << std::endl;
+            std::cout << "  Groot2 Port: " << params.groot2_port << " (" << params.groot2_monitor.mode;
+            if (params.groot2_monitor.mode == "throttled")
+            {
+                std::cout << ", snapshots every " << params.groot2_monitor.snapshot_interval_ms << " ms";
+            }
+            std::cout << ")" << std::endl;
+            std::cout << "  Lazy Payload Parsing: " << (params.lazy_payload_parsing ? "on" : "off") << std::endl;
+            std::cout << "  Dispatch Workers: " << params.dispatch_workers << " (queue " << params.dispatch_queue_capacity << ")" << std::endl;
+            std::cout << "  Last-Value Cache: " << (params.last_value_cache ? "on" : "off") << std::endl;
+            std::cout << "  State Coalesce Window: " << params.state_coalesce_window_ms << " ms" << std::endl;
+            std::cout << "  Topic Alias Maximum: " << params.topic_alias_maximum << std::endl;
+            std::cout << "  MQTT Session: " << (params.mqtt_session.resume ? "resumed" : "clean") << " on reconnect, expiry "
+                      << params.mqtt_session.expiry_s << " s, offline buffer " << params.mqtt_session.offline_buffer
+                      << ", backoff " << params.mqtt_session.reconnect_min_ms << "-" << params.mqtt_session.reconnect_max_ms
+                      << " ms" << std::endl;
+            if (!params.shared_group.empty())
+            {
+                std::cout << "  Shared Command Group: " << params.shared_group << std::endl;
+            }
+            std::cout << "  Max Idle Tick Interval: " << params.max_idle_interval_ms << " ms" << std::endl;
+            std::cout << "  Max Concurrent Processes: " << params.max_concurrent_processes << std::endl;
+            std::cout << "  Parallel Tick Workers: " << params.parallel_tick_workers << std::endl;
+            std::cout << "  Warm Restart: " << (params.warm_restart ? "on" : "off") << std::endl;
+            std::cout << "  Metrics Interval: " << params.metrics_publish_interval_ms << " ms" << std::endl;
+            std::cout << "  Log Level: " << params.log_level << std::endl;
+            if (!params.starting_trace_dir.empty())
+            {
+                std::cout << "  STARTING Traces: " << params.starting_trace_dir << " (" << params.trace_format << ")" << std::endl;
+            }
+            if (!params.traffic_record_path.empty())
+            {
+                std::cout << "  Traffic Recording: " << params.traffic_record_path << std::endl;
+            }
+            std::cout << "  Command Tracing: " << params.command_trace << std::endl;
+            std::cout << "  Command Deadlines: ack " << params.command_deadlines.ack_timeout_ms
+                      << " ms, completion " << params.command_deadlines.completion_timeout_ms
+                      << " ms, release " << params.command_deadlines.release_timeout_ms
+                      << " ms, " << params.command_deadlines.retries << " retries" << std::endl;
+            if (!params.move_batching.asset.empty())
+            {
+                std::cout << "  Move Batching: " << params.move_batching.asset << " (window "
+                          << params.move_batching.window_ms << " ms)" << std::endl;
+            }
+            std::cout << "  Occupy Policy: " << params.scheduler.occupy_policy << std::endl;
+            if (params.sim_clock.mode != "wall")
+            {
+                std::cout << "  Simulation Clock: " << params.sim_clock.mode << " at " << params.sim_clock.speed << "x";
+                if (params.sim_clock.mode == "driven")
+                {
+                    std::cout << " from " << params.sim_clock.topic;
+                }
+                std::cout << std::endl;
+            }
+            if (!params.schema_cache_dir.empty())
+            {
+                std::cout << "  Schema Cache: " << params.schema_cache_dir << std::endl;
+            }
+            if (!params.aas_snapshot_path.empty())
+            {
+                std::cout << "  AAS Snapshot: " << params.aas_snapshot_path << std::endl;
+            }
+            std::cout << "  Schema Validation Overrides: " << params.validation.topic_policies.size() << " topic filter(s)" << std::endl;
+            if (!params.registration_config_path.empty())
             {
-                std::cout << "  Registration Config: " << registration_config_path << std::endl;
-                std::cout << "  Registration Topic Pattern: " << registration_topic_pattern << std::endl;
+                std::cout << "  Registration Config: " << params.registration_config_path << std::endl;
+                std::cout << "  Registration Topic Pattern: " << params.registration_topic_pattern << std::endl;
+            }
+            if (!params.registration_response_topic.empty())
+            {
+                std::cout << "  AAS Change Events: " << params.registration_response_topic << std::endl;
             }
 
             return true;
@@ -327,15 +669,36 @@ namespace mqtt_utils
         }
     }
 
-    bool topicMatches(const std::string &pattern, const std::string &topic)
+    namespace
     {
-        std::istringstream patternStream(pattern);
-        std::istringstream topicStream(topic);
-        std::string patternSegment, topicSegment;
+        // Pop the next '/'-separated level off the front of a topic view
+        inline std::string_view nextLevel(std::string_view &remaining, bool &done)
+        {
+            size_t pos = remaining.find('/');
+            std::string_view level = remaining.substr(0, pos);
+            if (pos == std::string_view::npos)
+            {
+                done = true;
+                remaining = std::string_view();
+            }
+            else
+            {
+                remaining.remove_prefix(pos + 1);
+            }
+            return level;
+        }
+    }
+
+    bool topicMatches(std::string_view pattern, std::string_view topic)
+    {
+        bool patternDone = pattern.empty();
+        bool topicDone = topic.empty();
 
-        while (std::getline(patternStream, patternSegment, '/') &&
-               std::getline(topicStream, topicSegment, '/'))
+        while (!patternDone && !topicDone)
         {
+            std::string_view patternSegment = nextLevel(pattern, patternDone);
+            std::string_view topicSegment = nextLevel(topic, topicDone);
+
             if (patternSegment == "+" || topicSegment == "+")
             {
                 continue;
@@ -350,23 +713,289 @@ namespace mqtt_utils
             }
         }
 
-        bool patternDone = !std::getline(patternStream, patternSegment, '/');
-        bool topicDone = !std::getline(topicStream, topicSegment, '/');
-
         return patternDone && topicDone;
     }
 
+    SharedValidator getCachedValidator(const nlohmann::json &schema, const std::string &context)
+    {
+        if (schema.is_null() || schema.empty())
+        {
+            return nullptr;
+        }
+
+        static std::mutex cache_mutex;
+        static std::map<std::string, SharedValidator> validator_cache;
+
+        std::string key = schema.dump();
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = validator_cache.find(key);
+            if (it != validator_cache.end())
+            {
+                return it->second;
+            }
+        }
+
+        // Compile outside the lock: resolving $refs may go over the network
+        try
+        {
+            auto validator = std::make_shared<nlohmann::json_schema::json_validator>(
+                [](const nlohmann::json_uri &uri, nlohmann::json &ref_schema)
+                {
+                    // Get the full URI as a string for HTTP fetch
+                    std::string uri_str = uri.url();
+
+                    // If it's an HTTP(S) URL, fetch it via network
+                    if (uri_str.find("http://") == 0 || uri_str.find("https://") == 0)
+                    {
+                        ref_schema = schema_utils::fetchSchemaFromUrl(uri_str);
+                        if (!ref_schema.is_null())
+                        {
+                            schema_utils::resolveSchemaReferences(ref_schema);
+                        }
+                        return;
+                    }
+
+                    // Fallback: try to load as local file (legacy behavior)
+                    std::string schema_file = uri.path();
+                    if (!schema_file.empty() && schema_file[0] == '/')
+                    {
+                        schema_file = schema_file.substr(1);
+                    }
+                    std::string schema_path = "../../MQTTSchemas/" + schema_file;
+                    ref_schema = load_schema(schema_path);
+                },
+                nlohmann::json_schema::default_string_format_check);
+            validator->set_root_schema(schema);
+
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            // Another thread may have compiled the same schema meanwhile; keep the first one
+            return validator_cache.emplace(std::move(key), std::move(validator)).first->second;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error creating schema validator for topic '" << context << "': " << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    CompiledTopicPattern::CompiledTopicPattern(const std::string &pattern)
+        : pattern_(pattern)
+    {
+        std::string_view remaining(pattern_);
+        bool done = pattern_.empty();
+        size_t offset = 0;
+
+        while (!done)
+        {
+            std::string_view level = nextLevel(remaining, done);
+            SegmentKind kind = SegmentKind::Literal;
+            if (level == "+")
+            {
+                kind = SegmentKind::SingleLevel;
+                has_wildcards_ = true;
+            }
+            else if (level == "#")
+            {
+                kind = SegmentKind::MultiLevel;
+                has_wildcards_ = true;
+            }
+            segments_.push_back({static_cast<uint32_t>(offset), static_cast<uint32_t>(level.size()), kind});
+            offset += level.size() + 1;
+
+            if (kind == SegmentKind::MultiLevel)
+            {
+                break; // '#' must be last
+            }
+        }
+    }
+
+    bool CompiledTopicPattern::matches(std::string_view topic) const
+    {
+        if (segments_.empty())
+        {
+            return topic.empty() && pattern_.empty();
+        }
+
+        // Fast path for plain topics: a single byte comparison
+        if (!has_wildcards_)
+        {
+            return topic == pattern_;
+        }
+
+        std::string_view pattern_view(pattern_);
+        bool topicDone = topic.empty();
+        for (const Segment &seg : segments_)
+        {
+            if (seg.kind == SegmentKind::MultiLevel)
+            {
+                return true;
+            }
+            if (topicDone)
+            {
+                return false;
+            }
+
+            std::string_view level = nextLevel(topic, topicDone);
+            if (seg.kind == SegmentKind::Literal &&
+                level != pattern_view.substr(seg.offset, seg.length))
+            {
+                return false;
+            }
+        }
+
+        return topicDone;
+    }
+
+    namespace
+    {
+        ValidationConfig validation_config;
+    }
+
+    std::optional<ValidationPolicy> parseValidationPolicy(const std::string &name)
+    {
+        if (name == "always")
+            return ValidationPolicy::Always;
+        if (name == "sampled")
+            return ValidationPolicy::Sampled;
+        if (name == "on_schema_change")
+            return ValidationPolicy::OnSchemaChange;
+        if (name == "off")
+            return ValidationPolicy::Off;
+        return std::nullopt;
+    }
+
+    ValidationPolicy ValidationConfig::policyFor(std::string_view topic) const
+    {
+        for (const auto &[pattern, policy] : topic_policies)
+        {
+            if (pattern.matches(topic) || pattern.str() == topic)
+            {
+                return policy;
+            }
+        }
+        return default_policy;
+    }
+
+    void setValidationConfig(ValidationConfig config)
+    {
+        validation_config = std::move(config);
+    }
+
+    const ValidationConfig &getValidationConfig()
+    {
+        return validation_config;
+    }
+
+    namespace
+    {
+        // Weak entries: an interned value is freed with the last Topic holding it, and the
+        // expired entries are swept whenever the table has doubled since the last sweep
+        template <typename Value>
+        class InternTable
+        {
+        public:
+            template <typename Make>
+            std::shared_ptr<const Value> intern(const std::string &key, Make &&make)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = entries_.find(key);
+                if (it != entries_.end())
+                {
+                    if (auto value = it->second.lock())
+                    {
+                        return value;
+                    }
+                }
+
+                auto value = std::make_shared<const Value>(make());
+                entries_.insert_or_assign(key, value);
+                if (entries_.size() >= 2 * swept_size_)
+                {
+                    std::erase_if(entries_, [](const auto &entry)
+                                  { return entry.second.expired(); });
+                    swept_size_ = std::max<size_t>(entries_.size(), 64);
+                }
+                return value;
+            }
+
+            // Calls visit(key, value, use_count) for each live entry
+            template <typename Visit>
+            void forEach(Visit &&visit) const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto &[key, weak] : entries_)
+                {
+                    if (auto value = weak.lock())
+                    {
+                        visit(key, *value, static_cast<size_t>(value.use_count() - 1));
+                    }
+                }
+            }
+
+        private:
+            mutable std::mutex mutex_;
+            std::unordered_map<std::string, std::weak_ptr<const Value>> entries_;
+            size_t swept_size_ = 64;
+        };
+
+        InternTable<CompiledTopicPattern> &topicTable()
+        {
+            static InternTable<CompiledTopicPattern> table;
+            return table;
+        }
+
+        InternTable<nlohmann::json> &schemaTable()
+        {
+            static InternTable<nlohmann::json> table;
+            return table;
+        }
+    }
+
+    SharedTopicPattern internTopic(const std::string &topic)
+    {
+        return topicTable().intern(topic, [&topic]()
+                                   { return CompiledTopicPattern(topic); });
+    }
+
+    SharedSchema internSchema(const nlohmann::json &schema)
+    {
+        if (schema.is_null() || schema.empty())
+        {
+            return nullptr;
+        }
+        return schemaTable().intern(schema.dump(), [&schema]()
+                                    { return schema; });
+    }
+
+    InternStats getInternStats()
+    {
+        InternStats stats;
+        topicTable().forEach([&stats](const std::string &key, const CompiledTopicPattern &, size_t)
+                             {
+                                 stats.topics++;
+                                 stats.topic_bytes += key.size();
+                             });
+        schemaTable().forEach([&stats](const std::string &key, const nlohmann::json &, size_t refs)
+                              {
+                                  stats.schemas++;
+                                  stats.schema_bytes += key.size();
+                                  stats.schema_refs += refs;
+                              });
+        return stats;
+    }
+
     // Constructor with JSON schema directly
     Topic::Topic(const std::string &topic,
                  const nlohmann::json &schema,
                  int qos,
                  bool retain)
-        : topic_(topic),
-          pattern_(topic),
-          schema_(schema),
+        : topic_(internTopic(topic)),
+          schema_(internSchema(schema)),
           schema_validator_(nullptr),
           qos_(qos),
-          retain_(retain)
+          retain_(retain),
+          validation_policy_(validation_config.policyFor(topic))
     {
         initValidator();
     }
@@ -382,15 +1011,19 @@ namespace mqtt_utils
     }
 
     // Copy Constructor
+    // Shares the compiled validator instead of rebuilding it
     Topic::Topic(const Topic &other)
         : topic_(other.topic_),
           pattern_(other.pattern_),
           schema_(other.schema_),
-          schema_validator_(nullptr),
+          schema_validator_(other.schema_validator_),
           qos_(other.qos_),
-          retain_(other.retain_)
+          retain_(other.retain_),
+          encoding_(other.encoding_),
+          validation_policy_(other.validation_policy_),
+          inbound_count_(other.inbound_count_.load()),
+          schema_verified_(other.schema_verified_.load())
     {
-        initValidator();
     }
 
     // Move Constructor
@@ -400,7 +1033,11 @@ namespace mqtt_utils
           schema_(std::move(other.schema_)),
           schema_validator_(std::move(other.schema_validator_)),
           qos_(other.qos_),
-          retain_(other.retain_)
+          retain_(other.retain_),
+          encoding_(other.encoding_),
+          validation_policy_(other.validation_policy_),
+          inbound_count_(other.inbound_count_.load()),
+          schema_verified_(other.schema_verified_.load())
     {
     }
 
@@ -412,10 +1049,13 @@ namespace mqtt_utils
             topic_ = other.topic_;
             pattern_ = other.pattern_;
             schema_ = other.schema_;
-            schema_validator_.reset();
-            initValidator();
+            schema_validator_ = other.schema_validator_;
             qos_ = other.qos_;
             retain_ = other.retain_;
+            encoding_ = other.encoding_;
+            validation_policy_ = other.validation_policy_;
+            inbound_count_ = other.inbound_count_.load();
+            schema_verified_ = other.schema_verified_.load();
         }
         return *this;
     }
@@ -431,6 +1071,10 @@ namespace mqtt_utils
             schema_validator_ = std::move(other.schema_validator_);
             qos_ = other.qos_;
             retain_ = other.retain_;
+            encoding_ = other.encoding_;
+            validation_policy_ = other.validation_policy_;
+            inbound_count_ = other.inbound_count_.load();
+            schema_verified_ = other.schema_verified_.load();
         }
         return *this;
     }
@@ -438,59 +1082,45 @@ namespace mqtt_utils
     // Initialize schema validator
     void Topic::initValidator()
     {
-        if (!schema_.is_null() && !schema_.empty())
-        {
-            try
-            {
-                auto validator = std::make_unique<nlohmann::json_schema::json_validator>(
-                    [](const nlohmann::json_uri &uri, nlohmann::json &schema)
-                    {
-                        // Get the full URI as a string for HTTP fetch
-                        std::string uri_str = uri.url();
+        schema_validator_ = schema_ ? getCachedValidator(*schema_, getTopic()) : nullptr;
+    }
 
-                        // If it's an HTTP(S) URL, fetch it via network
-                        if (uri_str.find("http://") == 0 || uri_str.find("https://") == 0)
-                        {
-                            schema = schema_utils::fetchSchemaFromUrl(uri_str);
-                            if (!schema.is_null())
-                            {
-                                schema_utils::resolveSchemaReferences(schema);
-                            }
-                            return;
-                        }
+    const nlohmann::json &Topic::getSchema() const
+    {
+        static const nlohmann::json no_schema;
+        return schema_ ? *schema_ : no_schema;
+    }
 
-                        // Fallback: try to load as local file (legacy behavior)
-                        std::string schema_file = uri.path();
-                        if (!schema_file.empty() && schema_file[0] == '/')
-                        {
-                            schema_file = schema_file.substr(1);
-                        }
-                        std::string schema_path = "../../MQTTSchemas/" + schema_file;
-                        schema = load_schema(schema_path);
-                    },
-                    nlohmann::json_schema::default_string_format_check);
-                validator->set_root_schema(schema_);
-                schema_validator_ = std::move(validator);
-            }
-            catch (const std::exception &e)
-            {
-                std::cerr << "Error creating schema validator for topic '" << topic_ << "': " << e.what() << std::endl;
-                schema_validator_.reset();
-            }
+    const CompiledTopicPattern &Topic::getCompiledTopic() const
+    {
+        // Only a moved-from Topic has no pattern
+        static const CompiledTopicPattern no_topic;
+        return topic_ ? *topic_ : no_topic;
+    }
+
+    void Topic::setTopic(const std::string &topic)
+    {
+        if (!pattern_)
+        {
+            pattern_ = topic_; // The pattern stays what the Topic was created with
         }
+        topic_ = internTopic(topic);
+        validation_policy_ = validation_config.policyFor(topic);
     }
 
     void Topic::setSchema(const nlohmann::json &schema)
     {
-        schema_ = schema;
+        schema_ = internSchema(schema);
         schema_validator_.reset();
         initValidator();
+        schema_verified_ = false;
     }
     void Topic::setSchemaFromPath(const std::string &schema_path)
     {
-        schema_ = load_schema(schema_path);
+        schema_ = internSchema(load_schema(schema_path));
         schema_validator_.reset();
         initValidator();
+        schema_verified_ = false;
     }
 
     // Validate message against schema
@@ -505,12 +1135,101 @@ namespace mqtt_utils
             }
             catch (const std::exception &e)
             {
-                std::cerr << "JSON validation failed for topic '" << topic_ << "': " << e.what() << std::endl;
+                std::cerr << "JSON validation failed for topic '" << getTopic() << "': " << e.what() << std::endl;
                 return false;
             }
         }
         return false;
     }
+
+    bool Topic::validateInbound(const nlohmann::json &message) const
+    {
+        switch (validation_policy_)
+        {
+        case ValidationPolicy::Off:
+            return true;
+        case ValidationPolicy::Sampled:
+        {
+            uint64_t seen = inbound_count_.fetch_add(1, std::memory_order_relaxed);
+            uint64_t first = validation_config.sample_first;
+            uint64_t every = validation_config.sample_every;
+            if (seen >= first && (every == 0 || (seen - first) % every != 0))
+            {
+                return true;
+            }
+            return validateMessage(message);
+        }
+        case ValidationPolicy::OnSchemaChange:
+        {
+            if (schema_verified_.load(std::memory_order_relaxed))
+            {
+                return true;
+            }
+            bool valid = validateMessage(message);
+            if (valid)
+            {
+                schema_verified_.store(true, std::memory_order_relaxed);
+            }
+            return valid;
+        }
+        case ValidationPolicy::Always:
+        default:
+            return validateMessage(message);
+        }
+    }
+
+    TopicMap::const_iterator TopicMap::lowerBound(std::string_view key) const
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), key,
+                                [](const value_type &entry, std::string_view k)
+                                { return entry.first < k; });
+    }
+
+    TopicMap::const_iterator TopicMap::find(std::string_view key) const
+    {
+        auto it = lowerBound(key);
+        return it != entries_.end() && it->first == key ? it : entries_.end();
+    }
+
+    TopicMap::iterator TopicMap::find(std::string_view key)
+    {
+        return entries_.begin() + (static_cast<const TopicMap &>(*this).find(key) - entries_.cbegin());
+    }
+
+    Topic &TopicMap::operator[](const std::string &key)
+    {
+        auto it = lowerBound(key);
+        if (it != entries_.end() && it->first == key)
+        {
+            return entries_[it - entries_.cbegin()].second;
+        }
+        return entries_.emplace(it, key, Topic())->second;
+    }
+
+    size_t TopicMap::erase(std::string_view key)
+    {
+        auto it = find(key);
+        if (it == entries_.end())
+        {
+            return 0;
+        }
+        entries_.erase(it);
+        return 1;
+    }
+
+    size_t TopicMap::memoryUsage() const
+    {
+        size_t bytes = entries_.capacity() * sizeof(value_type);
+        for (const auto &[key, topic] : entries_)
+        {
+            // Keys beyond the small-string buffer live on the heap
+            if (key.capacity() > std::string().capacity())
+            {
+                bytes += key.capacity() + 1;
+            }
+        }
+        return bytes;
+    }
 } // namespace mqtt_utils
 
 namespace BT
@@ -544,60 +1263,181 @@ namespace BT
 namespace schema_utils
 {
     // Cache for fetched schemas to avoid redundant HTTP requests
+    // Shared by validator loaders on several threads, hence the mutex
     static std::map<std::string, nlohmann::json> schema_cache;
+    static std::mutex schema_cache_mutex;
+    static std::string schema_cache_dir;
+
+    // Validators stored next to a schema on disk
+    struct CachedSchemaValidators
+    {
+        std::string etag;
+        std::string last_modified;
+    };
+
+    static fs::path diskCachePath(const std::string &schema_url)
+    {
+        // Hash keeps file names short and filesystem-safe; the URL is stored inside for verification
+        std::string file_name = fmt::format("{:016x}.json", std::hash<std::string>{}(schema_url));
+        return fs::path(schema_cache_dir) / file_name;
+    }
+
+    // Load a schema and its validators from the disk store; returns false if absent or stale
+    static bool loadFromDisk(const std::string &schema_url, nlohmann::json &schema, CachedSchemaValidators &validators)
+    {
+        if (schema_cache_dir.empty())
+        {
+            return false;
+        }
+
+        try
+        {
+            std::ifstream file(diskCachePath(schema_url));
+            if (!file.is_open())
+            {
+                return false;
+            }
+            nlohmann::json entry = nlohmann::json::parse(file);
+            if (entry.value("url", "") != schema_url || !entry.contains("schema"))
+            {
+                return false;
+            }
+            schema = entry["schema"];
+            validators.etag = entry.value("etag", "");
+            validators.last_modified = entry.value("last_modified", "");
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Ignoring unreadable schema cache entry for " << schema_url << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
 
-    // CURL write callback
-    static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
+    static void storeToDisk(const std::string &schema_url, const nlohmann::json &schema, const CachedSchemaValidators &validators)
     {
-        ((std::string *)userp)->append((char *)contents, size * nmemb);
-        return size * nmemb;
+        if (schema_cache_dir.empty())
+        {
+            return;
+        }
+
+        try
+        {
+            fs::create_directories(schema_cache_dir);
+            nlohmann::json entry = {
+                {"url", schema_url},
+                {"etag", validators.etag},
+                {"last_modified", validators.last_modified},
+                {"schema", schema}};
+
+            // Write to a temporary file first so a crash never leaves a truncated entry
+            fs::path target = diskCachePath(schema_url);
+            fs::path tmp = target;
+            tmp += ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::trunc);
+                file << entry.dump(2);
+            }
+            fs::rename(tmp, target);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to write schema cache entry for " << schema_url << ": " << e.what() << std::endl;
+        }
+    }
+
+    void setSchemaCacheDirectory(const std::string &directory)
+    {
+        std::lock_guard<std::mutex> lock(schema_cache_mutex);
+        schema_cache_dir = directory;
     }
 
     nlohmann::json fetchSchemaFromUrl(const std::string &schema_url)
     {
         // Check cache first
-        auto cache_it = schema_cache.find(schema_url);
-        if (cache_it != schema_cache.end())
         {
-            std::cout << "Using cached schema for: " << schema_url << std::endl;
-            return cache_it->second;
+            std::lock_guard<std::mutex> lock(schema_cache_mutex);
+            auto cache_it = schema_cache.find(schema_url);
+            if (cache_it != schema_cache.end())
+            {
+                std::cout << "Using cached schema for: " << schema_url << std::endl;
+                return cache_it->second;
+            }
         }
 
-        std::cout << "Fetching schema from: " << schema_url << std::endl;
-
-        // Make HTTP request to fetch schema
-        CURL *curl = curl_easy_init();
-        if (!curl)
+        nlohmann::json disk_schema;
+        CachedSchemaValidators disk_validators;
+        bool have_disk_copy = false;
         {
-            std::cerr << "Failed to initialize CURL for schema fetch" << std::endl;
-            return nlohmann::json();
+            std::lock_guard<std::mutex> lock(schema_cache_mutex);
+            have_disk_copy = loadFromDisk(schema_url, disk_schema, disk_validators);
         }
 
-        std::string schema_buffer;
-        curl_easy_setopt(curl, CURLOPT_URL, schema_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &schema_buffer);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        std::cout << (have_disk_copy ? "Revalidating cached schema: " : "Fetching schema from: ") << schema_url << std::endl;
 
-        struct curl_slist *headers = nullptr;
-        headers = curl_slist_append(headers, "Accept: application/json");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        // Make HTTP request to fetch schema, conditional if we hold a disk copy
+        std::vector<std::string> headers = {"Accept: application/json"};
+        if (have_disk_copy && !disk_validators.etag.empty())
+        {
+            headers.push_back("If-None-Match: " + disk_validators.etag);
+        }
+        if (have_disk_copy && !disk_validators.last_modified.empty())
+        {
+            headers.push_back("If-Modified-Since: " + disk_validators.last_modified);
+        }
+
+        HttpResponse response = HttpTransport::instance().get(schema_url, headers, 10);
+        CURLcode res = response.curl_code;
+        long response_code = response.status;
+        const std::string &schema_buffer = response.body;
 
-        CURLcode res = curl_easy_perform(curl);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+        CachedSchemaValidators fetched_validators;
+        if (auto it = response.headers.find("etag"); it != response.headers.end())
+        {
+            fetched_validators.etag = it->second;
+        }
+        if (auto it = response.headers.find("last-modified"); it != response.headers.end())
+        {
+            fetched_validators.last_modified = it->second;
+        }
 
-        if (res != CURLE_OK || schema_buffer.empty())
+        nlohmann::json schema;
+        if (res == CURLE_OK && response_code == 304 && have_disk_copy)
+        {
+            std::cout << "Schema unchanged, using disk cache: " << schema_url << std::endl;
+            schema = disk_schema;
+        }
+        else if (res == CURLE_OK && response_code == 200 && !schema_buffer.empty())
+        {
+            try
+            {
+                schema = nlohmann::json::parse(schema_buffer);
+            }
+            catch (const nlohmann::json::parse_error &e)
+            {
+                std::cerr << "Invalid JSON in schema from URL: " << schema_url << ": " << e.what() << std::endl;
+                return have_disk_copy ? disk_schema : nlohmann::json();
+            }
+            std::lock_guard<std::mutex> lock(schema_cache_mutex);
+            storeToDisk(schema_url, schema, fetched_validators);
+        }
+        else if (have_disk_copy)
+        {
+            // Network unavailable or server error: the last known copy is better than nothing
+            std::cerr << "Failed to fetch schema from URL: " << schema_url << ", using disk cache" << std::endl;
+            schema = disk_schema;
+        }
+        else
         {
             std::cerr << "Failed to fetch schema from URL: " << schema_url << std::endl;
             return nlohmann::json();
         }
 
-        nlohmann::json schema = nlohmann::json::parse(schema_buffer);
-
         // Store in cache
-        schema_cache[schema_url] = schema;
+        {
+            std::lock_guard<std::mutex> lock(schema_cache_mutex);
+            schema_cache.emplace(schema_url, schema);
+        }
 
         std::cout << "Successfully fetched and cached schema from: " << schema_url << std::endl;
 
@@ -668,24 +1508,10 @@ namespace schema_utils
     {
         std::cout << "Fetching content from: " << url << std::endl;
 
-        CURL *curl = curl_easy_init();
-        if (!curl)
-        {
-            std::cerr << "Failed to initialize CURL for content fetch" << std::endl;
-            return "";
-        }
-
-        std::string content_buffer;
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &content_buffer);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-        CURLcode res = curl_easy_perform(curl);
-        long response_code;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-        curl_easy_cleanup(curl);
+        HttpResponse response = HttpTransport::instance().get(url, {}, 30);
+        CURLcode res = response.curl_code;
+        long response_code = response.status;
+        std::string &content_buffer = response.body;
 
         if (res != CURLE_OK)
         {
@@ -1,10 +1,10 @@
 import enum
-import datetime
 import threading  # Add this import
 import inspect   # Add this import
 import os        # Add this import for file path handling
 from typing import Optional
 from MQTT_classes import Proxy, Publisher, ResponseAsync, Topic
+import sim_clock
 
 
 class PackMLState(enum.Enum):
@@ -111,6 +111,8 @@ class PackMLStateMachine:
             client.register_topic(topic)
 
         self.publish_state()
+        # Faster-than-real-time runs tell the controller where the simulation is
+        sim_clock.start_publisher(client)
         
         # Auto-transition to EXECUTE for service-type stations (no occupation needed)
         if self.auto_execute:
@@ -168,8 +170,7 @@ class PackMLStateMachine:
                 self.abort_command()
 
     def _publish_command_status(self, status_topic_publisher, command_uuid, state_value):
-        timestamp = datetime.datetime.now(datetime.timezone.utc).isoformat(
-            timespec='milliseconds').replace('+00:00', 'Z')
+        timestamp = sim_clock.timestamp()
         response = {
             "State": state_value,
             "TimeStamp": timestamp,
@@ -340,8 +341,7 @@ class PackMLStateMachine:
             additional_response_data: Optional dict with additional fields to include in response
         """
         # Publish final command status
-        timestamp_final = datetime.datetime.now(datetime.timezone.utc).isoformat(
-            timespec='milliseconds').replace('+00:00', 'Z')
+        timestamp_final = sim_clock.timestamp()
         response_final = {
             "State": final_command_state,
             "TimeStamp": timestamp_final,
@@ -417,8 +417,7 @@ class PackMLStateMachine:
                 if can_be_interrupted_immediately:
                     self.processing_events[active_uuid] = interrupt_event
 
-                timestamp_running = datetime.datetime.now(datetime.timezone.utc).isoformat(
-                    timespec='milliseconds').replace('+00:00', 'Z')
+                timestamp_running = sim_clock.timestamp()
                 response_running = {
                     "State": "RUNNING",
                     "TimeStamp": timestamp_running,
@@ -491,8 +490,7 @@ class PackMLStateMachine:
                       f"Current State: {self.state.value}, Expected Head: '{current_queue_head}', "
                       f"Is Processing: {self.is_processing}, Queue: {self.uuids}")
 
-                timestamp_failure = datetime.datetime.now(datetime.timezone.utc).isoformat(
-                    timespec='milliseconds').replace('+00:00', 'Z')
+                timestamp_failure = sim_clock.timestamp()
                 response_failure = {
                     "State": "FAILURE",
                     "TimeStamp": timestamp_failure,
@@ -504,8 +502,7 @@ class PackMLStateMachine:
                 "Uuid") if message else "UNKNOWN_MESSAGE_UUID"
             print(
                 f"Execute command rejected for UUID '{attempted_uuid}'. Machine not in EXECUTE state (current: {self.state.value}).")
-            timestamp_failure = datetime.datetime.now(datetime.timezone.utc).isoformat(
-                timespec='milliseconds').replace('+00:00', 'Z')
+            timestamp_failure = sim_clock.timestamp()
             response_failure = {
                 "State": "FAILURE",
                 "TimeStamp": timestamp_failure,
@@ -644,7 +641,7 @@ class PackMLStateMachine:
         """Publish the current state"""
         response = {
             "State": self.state.value,
-            "TimeStamp": datetime.datetime.now(datetime.timezone.utc).isoformat(timespec='milliseconds').replace('+00:00', 'Z'),
+            "TimeStamp": sim_clock.timestamp(),
             "ProcessQueue": self.uuids
         }
         self.state_topic.publish(response, self.client, True)
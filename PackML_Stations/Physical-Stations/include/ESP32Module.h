@@ -7,6 +7,26 @@
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 
+// Verbose MQTT message logging (full payload dumps) costs milliseconds per message at 115200 baud.
+// Enable with -D STATION_VERBOSE_LOG=1 in platformio.ini build_flags.
+#ifndef STATION_VERBOSE_LOG
+#define STATION_VERBOSE_LOG 0
+#endif
+
+#if STATION_VERBOSE_LOG
+#define STATION_VLOG(x) Serial.print(x)
+#define STATION_VLOGLN(x) Serial.println(x)
+#else
+#define STATION_VLOG(x) \
+    do                  \
+    {                   \
+    } while (0)
+#define STATION_VLOGLN(x) \
+    do                    \
+    {                     \
+    } while (0)
+#endif
+
 // Forward declaration
 class PackMLStateMachine;
 
@@ -44,9 +64,9 @@ public:
 
     /**
      * @brief Get the current command UUID
-     * @return Current command UUID string
+     * @return Current command UUID string (no copy)
      */
-    String getCommandUuid();
+    const String &getCommandUuid() const;
 
     /**
      * @brief Set the PackML state machine instance
@@ -55,9 +75,12 @@ public:
     void setStateMachine(PackMLStateMachine *sm);
     /**
      * @brief Publish the stored YAML configuration (from filesystem) to MQTT
-     * 
-     * Sends the YAML config to the Registration/Config topic where the
-     * Registration Service will generate the full AAS description.
+     *
+     * Streams the YAML config from LittleFS to Registration/Config/<module>, where the
+     * Registration Service reassembles it and generates the full AAS description. A header
+     * {"Hash", "Size", "Chunks"} goes to .../Header first, then the file in CONFIG_CHUNK_SIZE
+     * pieces to .../Chunk/<index>, so the config is never held in RAM as a whole. The hash
+     * (FNV-1a over the file) lets the service skip configs it has already registered.
      */
     void publishDescriptionFromFile();
 
@@ -106,6 +129,40 @@ private:
     bool initialized;
     const char *configFilePath;
 
+    // Reassembly of messages AsyncMqttClient delivers in several parts (index/total).
+    // Preallocated so fragmented commands never allocate; larger messages are dropped.
+    static const size_t MQTT_REASSEMBLY_BUFFER_SIZE = 4096;
+    char reassemblyBuffer[MQTT_REASSEMBLY_BUFFER_SIZE];
+    size_t reassemblyReceived;
+    bool reassemblyDiscard;
+
+    // Config streaming: at most CONFIG_PUBLISH_WINDOW chunks await their PUBACK, so the
+    // client's outgoing queue holds a bounded amount of the file. Config packets take ids
+    // from CONFIG_PACKET_ID_BASE up, above those the client hands out during boot.
+    static const size_t CONFIG_CHUNK_SIZE = 1024;
+    static const UBaseType_t CONFIG_PUBLISH_WINDOW = 2;
+    static const uint16_t CONFIG_PACKET_ID_BASE = 0xF000;
+    static const uint32_t CONFIG_ACK_TIMEOUT_MS = 5000;
+    static const uint32_t CONFIG_CONNECT_TIMEOUT_MS = 5000;
+    SemaphoreHandle_t configPublishSlots;
+    volatile bool configStreaming;
+    uint16_t configPacketCount;
+
+    /**
+     * @brief Mount LittleFS, formatting it if the mount fails
+     */
+    bool mountFilesystem();
+
+    /**
+     * @brief Publish one part of the config stream at QoS 1, waiting for a free window slot
+     */
+    bool publishConfigPart(const char *topic, const char *payload, size_t len);
+
+    /**
+     * @brief Parse a complete message payload and route it to the state machine
+     */
+    void dispatchMessage(const char *topic, const char *payload, size_t len);
+
     /**
      * @brief Initialize WiFi connection
      */
@@ -126,6 +183,7 @@ private:
      */
     void onMqttConnect(bool sessionPresent);
     void onMqttDisconnect(AsyncMqttClientDisconnectReason reason);
+    void onMqttPublish(uint16_t packetId);
     void onMqttMessage(char *topic, char *payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total);
 };
 
@@ -3,6 +3,17 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "PackMLStateMachine.h"
+#include "MotionSequencer.h"
+
+// Weight telemetry streaming: sample period in ms, 0 disables streaming.
+// Frames of WEIGHT_STREAM_FRAME_SAMPLES delta-encoded samples go to /DATA/WeightStream at QoS 0.
+#ifndef WEIGHT_STREAM_INTERVAL_MS
+#define WEIGHT_STREAM_INTERVAL_MS 0
+#endif
+#ifndef WEIGHT_STREAM_FRAME_SAMPLES
+#define WEIGHT_STREAM_FRAME_SAMPLES 25
+#endif
 
 // Forward declarations
 class ESP32Module;
@@ -17,6 +28,9 @@ class PackMLStateMachine;
  * - Limit switch reading
  * - Device primitives (filling, needle attachment, tare)
  * - Weight measurement and publishing
+ *
+ * The primitives run as motion sequences: the needle and the scale each have a sequencer
+ * track, so a Tare runs while the needle moves and no command blocks the station.
  */
 class FillingModule
 {
@@ -45,6 +59,7 @@ private:
     static const int MOTOR_SPEED = 140;
     static const int MOTOR_SPEED_BOOST = 50;
     static const unsigned long MOTION_TIMEOUT = 8000; // 8 seconds
+    static const uint32_t FILL_DURATION_MS = 1000;    // Dwell at the bottom while the vial fills
 
     // Custom MQTT action/data topics
     static const String TOPIC_SUB_FILLING_CMD;
@@ -54,34 +69,54 @@ private:
     static const String TOPIC_SUB_TARE_CMD;
     static const String TOPIC_PUB_TARE_DATA;
     static const String TOPIC_PUB_WEIGHT;
+    static const String TOPIC_PUB_WEIGHT_STREAM;
+
+    // Weight streaming ring buffer (milligrams); holds several frames so samples taken
+    // while MQTT is disconnected are sent once it is back, oldest dropped first
+    static const size_t WEIGHT_RING_CAPACITY = WEIGHT_STREAM_FRAME_SAMPLES * 8;
+    static const uint32_t WEIGHT_STREAM_STACK_SIZE = 4096;
+
+    // Sequencer tracks
+    static const uint8_t NEEDLE_TRACK = 0;
+    static const uint8_t SCALE_TRACK = 1;
 
     /**
-     * @brief Execute complete filling cycle
-     * @return true if successful, false if motion error occurred
+     * @brief Complete filling cycle: down, dwell, up, then publish the weight
      */
-    static bool runFillingCycle();
+    static void buildFillingCycle(MotionSequence &sequence);
 
     /**
      * @brief Move needle down to attachment position
      */
-    static void attachNeedle();
+    static void buildAttachNeedle(MotionSequence &sequence);
 
     /**
      * @brief Tare the scale
      */
-    static void tareScale();
+    static void buildTareScale(MotionSequence &sequence);
 
     /**
-     * @brief Move needle to top position
-     * @return true if successful, false if motion error occurred
+     * @brief Needle motion steps, ending with the motor stopped
      */
-    static bool moveToTop();
+    static void appendMoveToTop(MotionSequence &sequence);
+    static void appendMoveToBottom(MotionSequence &sequence);
 
     /**
-     * @brief Move needle to bottom position
+     * @brief Move needle to top position, blocking the caller
      * @return true if successful, false if motion error occurred
      */
-    static bool moveToBottom();
+    static bool moveToTop();
+
+    // Step actions
+    static void startMoveUp();
+    static void startMoveDown();
+    static void startAttachMove();
+    static void cruise();
+    static void brakeFromUp();
+    static void brakeFromDown();
+    static void startFill();
+    static void publishFilledWeight();
+    static void publishTare();
 
     /**
      * @brief Stop motor movement
@@ -95,16 +130,45 @@ private:
     static void publishWeight(double weight);
 
     /**
-     * @brief Wait for button press with timeout
-     * @param buttonPin Pin number of button to monitor
-     * @param timeoutMs Timeout in milliseconds
-     * @return true if button pressed, false if timeout
+     * @brief Current scale reading in grams
+     *
+     * The station has no load cell driver yet, so this simulates one: the weight ramps up
+     * to the fill target while the needle dwells and holds there until the next tare.
+     * Replace with the hardware read when one is fitted.
+     */
+    static double readWeight();
+
+    /**
+     * @brief Start the weight streaming task if WEIGHT_STREAM_INTERVAL_MS is non-zero
+     */
+    static void startWeightStream();
+
+    /**
+     * @brief Streaming task: samples at a fixed rate into the ring buffer and publishes frames
+     */
+    static void weightStreamTask(void *parameter);
+
+    /**
+     * @brief Publish up to one frame of buffered samples as first value plus deltas
+     * @return true if a frame was published
      */
-    static bool waitForButton(int buttonPin, unsigned long timeoutMs);
+    static bool publishWeightFrame();
 
     // Static members
     static ESP32Module *esp32Module;
     static PackMLStateMachine *stateMachine;
+    static TopicBuffer weightTopic; // Full weight topic, built once in setup()
+    static TopicBuffer weightStreamTopic;
+    // Simulated scale, written by the sequencer and read by the streaming task; 32-bit so
+    // each field is read untorn
+    static volatile float fillTargetWeight; // Grams in the vial once the current fill completes
+    static volatile uint32_t fillStartMs;   // millis() at the start of the current fill
+
+    // Ring buffer state, only touched by the streaming task
+    static int32_t weightRing[WEIGHT_RING_CAPACITY];
+    static size_t weightRingHead;  // Index of the oldest sample
+    static size_t weightRingCount;
+    static int64_t weightRingStartMs; // Epoch ms of the oldest sample
 };
 
 #endif // FILLING_MODULE_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef MOTION_SEQUENCER_H
+#define MOTION_SEQUENCER_H
+
+#include <Arduino.h>
+#include "TaskLayout.h"
+
+// Sequencer period in ms; end switches are sampled at this rate (5 ms = 200 Hz)
+#ifndef SEQUENCER_TICK_MS
+#define SEQUENCER_TICK_MS 5
+#endif
+
+typedef void (*StepAction)();
+typedef void (*SequenceDone)(void *context, bool success);
+
+/**
+ * @brief One step of a motion sequence
+ *
+ * The action runs when the step starts; the step then lasts holdMs, or until pin reads
+ * level. A pin that does not get there within timeoutMs fails the sequence.
+ */
+struct SequenceStep
+{
+    StepAction action;
+    uint32_t holdMs;
+    int8_t pin; // -1: timed step
+    uint8_t level;
+    uint32_t timeoutMs;
+};
+
+/**
+ * @class MotionSequence
+ * @brief Fixed-capacity list of steps, built by chaining then()/until()
+ *
+ * Copied by value into the sequencer, so it can be built on the caller's stack.
+ */
+class MotionSequence
+{
+public:
+    static const size_t MAX_STEPS = 16;
+
+    /// @brief Run action, then hold for holdMs
+    MotionSequence &then(StepAction action, uint32_t holdMs = 0);
+
+    /// @brief Run action, then wait until pin reads level; fail after timeoutMs
+    MotionSequence &until(int pin, uint8_t level, uint32_t timeoutMs, StepAction action = nullptr);
+
+    /// @brief Run after a failed step instead of the remaining ones, e.g. to stop the motors
+    MotionSequence &onFailure(StepAction action);
+
+    /// @brief Called from the sequencer task once the sequence has finished or failed
+    MotionSequence &onDone(SequenceDone callback, void *context);
+
+    size_t size() const { return count; }
+    bool overflowed() const { return overflow; }
+
+private:
+    friend class MotionSequencer;
+
+    SequenceStep steps[MAX_STEPS];
+    size_t count = 0;
+    bool overflow = false;
+    StepAction failureAction = nullptr;
+    SequenceDone doneCallback = nullptr;
+    void *doneContext = nullptr;
+
+    MotionSequence &add(const SequenceStep &step);
+};
+
+/**
+ * @class MotionSequencer
+ * @brief Cooperative scheduler running motion sequences on independent tracks
+ *
+ * A FreeRTOS task wakes every SEQUENCER_TICK_MS and advances each track's current sequence
+ * by as many steps as are due on ACTUATION_CORE, so timed holds and end-switch waits cost no CPU in
+ * between. Tracks (e.g. needle and scale) run side by side; sequences started on a busy
+ * track queue behind it. Actions run on the sequencer task and must not block.
+ */
+class MotionSequencer
+{
+public:
+    static const uint8_t TRACKS = 3;
+    static const size_t TRACK_QUEUE_LENGTH = 3;
+    static const uint32_t TASK_STACK_SIZE = 4096;
+    static const UBaseType_t TASK_PRIORITY = SEQUENCER_TASK_PRIORITY; // Above the PackML command worker
+
+    /// @brief Create the sequencer task; start() calls it when needed
+    static void begin();
+
+    /**
+     * @brief Queue a sequence on a track
+     * @return false if the track is invalid, its queue full or the sequence overflowed
+     */
+    static bool start(uint8_t track, const MotionSequence &sequence);
+
+    /**
+     * @brief Queue a sequence and block the calling task until it finishes
+     * @return true if every step completed
+     */
+    static bool run(uint8_t track, const MotionSequence &sequence);
+
+    /// @brief True while the track has a sequence running or queued
+    static bool busy(uint8_t track);
+
+private:
+    struct Track
+    {
+        MotionSequence queue[TRACK_QUEUE_LENGTH];
+        size_t head = 0;
+        size_t count = 0;
+        size_t step = 0;
+        bool stepStarted = false;
+        uint32_t stepStartMs = 0;
+    };
+
+    struct Completion
+    {
+        SequenceDone callback;
+        void *context;
+        bool success;
+    };
+
+    static Track tracks[TRACKS];
+    static SemaphoreHandle_t mutex; // Guards tracks against start() from other tasks
+    static TaskHandle_t taskHandle;
+
+    static void sequencerTask(void *parameter);
+
+    // Caller holds mutex; finished sequences are appended to completions
+    static void advance(Track &track, uint32_t nowMs, Completion *completions, size_t &completed);
+};
+
+#endif // MOTION_SEQUENCER_H
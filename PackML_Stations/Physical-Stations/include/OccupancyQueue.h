@@ -0,0 +1,221 @@
+#ifndef OCCUPANCY_QUEUE_H
+#define OCCUPANCY_QUEUE_H
+
+#include <Arduino.h>
+#include <string.h>
+
+#ifndef OCCUPANCY_QUEUE_CAPACITY
+#define OCCUPANCY_QUEUE_CAPACITY 16
+#endif
+
+/// @brief Smallest power of two >= n
+constexpr size_t occupancyIndexSize(size_t n)
+{
+    return n <= 1 ? 1 : 2 * occupancyIndexSize((n + 1) / 2);
+}
+
+/**
+ * @class OccupancyQueue
+ * @brief Bounded FIFO of occupant UUIDs with O(1) duplicate detection
+ *
+ * UUIDs are stored in a fixed pool of slots; the FIFO order is a ring of slot
+ * indices and a small open-addressing hash table maps UUID -> slot. Nothing is
+ * allocated after construction. Each entry also carries whether its Occupy
+ * request is still waiting for the SUCCESS reply.
+ */
+class OccupancyQueue
+{
+public:
+    static const size_t CAPACITY = OCCUPANCY_QUEUE_CAPACITY;
+    static const size_t UUID_SLOT_SIZE = 64;
+
+    OccupancyQueue() { clear(); }
+
+    bool empty() const { return count == 0; }
+    bool full() const { return count == CAPACITY; }
+    size_t size() const { return count; }
+
+    /// @brief UUID at position i (0 = head); i must be < size()
+    const char *at(size_t i) const { return slots[order[(head + i) % CAPACITY]].uuid; }
+    const char *front() const { return at(0); }
+
+    bool contains(const char *uuid) const { return findSlot(uuid) != NO_SLOT; }
+
+    /**
+     * @brief Append a UUID marked as pending registration
+     * @return false if the queue is full, the UUID is too long or already queued
+     */
+    bool push(const char *uuid)
+    {
+        if (full() || strlen(uuid) >= UUID_SLOT_SIZE || contains(uuid))
+        {
+            return false;
+        }
+        uint8_t slot = freeSlots[--freeCount];
+        strcpy(slots[slot].uuid, uuid);
+        slots[slot].pendingRegistration = true;
+        order[(head + count) % CAPACITY] = slot;
+        count++;
+        indexInsert(slot);
+        return true;
+    }
+
+    /**
+     * @brief Remove a UUID wherever it is; O(1) at the head, shifts slot indices otherwise
+     * @param wasPending Set to the entry's pending-registration flag when found
+     * @return false if the UUID is not queued
+     */
+    bool remove(const char *uuid, bool *wasPending = nullptr)
+    {
+        uint8_t slot = findSlot(uuid);
+        if (slot == NO_SLOT)
+        {
+            return false;
+        }
+        if (wasPending)
+        {
+            *wasPending = slots[slot].pendingRegistration;
+        }
+
+        size_t position = 0;
+        while (order[(head + position) % CAPACITY] != slot)
+        {
+            position++;
+        }
+        if (position == 0)
+        {
+            head = (head + 1) % CAPACITY;
+        }
+        else
+        {
+            for (size_t i = position; i + 1 < count; i++)
+            {
+                order[(head + i) % CAPACITY] = order[(head + i + 1) % CAPACITY];
+            }
+        }
+        count--;
+
+        indexErase(slot);
+        slots[slot].uuid[0] = '\0';
+        freeSlots[freeCount++] = slot;
+        return true;
+    }
+
+    /**
+     * @brief Clear the pending-registration flag of a queued UUID
+     * @return true if the UUID was queued and still pending
+     */
+    bool takePendingRegistration(const char *uuid)
+    {
+        uint8_t slot = findSlot(uuid);
+        if (slot == NO_SLOT || !slots[slot].pendingRegistration)
+        {
+            return false;
+        }
+        slots[slot].pendingRegistration = false;
+        return true;
+    }
+
+    /// @brief Whether the entry at position i is still waiting for its registration reply
+    bool isPendingRegistration(size_t i) const { return slots[order[(head + i) % CAPACITY]].pendingRegistration; }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+        freeCount = CAPACITY;
+        for (size_t i = 0; i < CAPACITY; i++)
+        {
+            freeSlots[i] = (uint8_t)(CAPACITY - 1 - i);
+            slots[i].uuid[0] = '\0';
+            slots[i].pendingRegistration = false;
+        }
+        for (size_t i = 0; i < INDEX_SIZE; i++)
+        {
+            index[i] = NO_SLOT;
+        }
+    }
+
+private:
+    static_assert(CAPACITY > 0 && CAPACITY < 128, "OCCUPANCY_QUEUE_CAPACITY must be between 1 and 127");
+
+    // Power of two at least twice the capacity keeps probe sequences short
+    static const size_t INDEX_SIZE = occupancyIndexSize(CAPACITY * 2);
+    static const uint8_t NO_SLOT = 0xFF;
+    static const uint8_t TOMBSTONE = 0xFE;
+
+    struct Slot
+    {
+        char uuid[UUID_SLOT_SIZE];
+        bool pendingRegistration;
+    };
+
+    Slot slots[CAPACITY];
+    uint8_t order[CAPACITY]; // Ring of slot indices in FIFO order
+    size_t head;
+    size_t count;
+    uint8_t freeSlots[CAPACITY];
+    size_t freeCount;
+    uint8_t index[INDEX_SIZE]; // UUID hash -> slot, linear probing
+
+    static uint32_t hashUuid(const char *uuid)
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (const char *c = uuid; *c; ++c)
+        {
+            hash ^= (uint8_t)*c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    uint8_t findSlot(const char *uuid) const
+    {
+        size_t bucket = hashUuid(uuid) & (INDEX_SIZE - 1);
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++)
+        {
+            uint8_t slot = index[bucket];
+            if (slot == NO_SLOT)
+            {
+                return NO_SLOT;
+            }
+            if (slot != TOMBSTONE && strcmp(slots[slot].uuid, uuid) == 0)
+            {
+                return slot;
+            }
+            bucket = (bucket + 1) & (INDEX_SIZE - 1);
+        }
+        return NO_SLOT;
+    }
+
+    void indexInsert(uint8_t slot)
+    {
+        size_t bucket = hashUuid(slots[slot].uuid) & (INDEX_SIZE - 1);
+        while (index[bucket] != NO_SLOT && index[bucket] != TOMBSTONE)
+        {
+            bucket = (bucket + 1) & (INDEX_SIZE - 1);
+        }
+        index[bucket] = slot;
+    }
+
+    void indexErase(uint8_t slot)
+    {
+        size_t bucket = hashUuid(slots[slot].uuid) & (INDEX_SIZE - 1);
+        while (index[bucket] != slot)
+        {
+            bucket = (bucket + 1) & (INDEX_SIZE - 1);
+        }
+        index[bucket] = TOMBSTONE;
+        // With the queue empty no probe chain needs the tombstones any more
+        if (count == 0)
+        {
+            for (size_t i = 0; i < INDEX_SIZE; i++)
+            {
+                index[i] = NO_SLOT;
+            }
+        }
+    }
+};
+
+#endif // OCCUPANCY_QUEUE_H
@@ -6,6 +6,10 @@
 #include <AsyncMqttClient.h>
 #include <vector>
 #include <time.h>
+#include "PayloadBuffer.h"
+#include "OccupancyQueue.h"
+#include "MotionSequencer.h"
+#include "TaskLayout.h"
 
 // PackML State Enumeration
 enum class PackMLState
@@ -29,26 +33,52 @@ enum class PackMLState
     CLEARING
 };
 
+// State names indexed by PackMLState, so publishing a state never builds a String
+constexpr const char *PACKML_STATE_NAMES[] = {
+    "IDLE", "STARTING", "EXECUTE", "COMPLETING", "COMPLETE", "RESETTING",
+    "HOLDING", "HELD", "UNHOLDING", "SUSPENDING", "SUSPENDED", "UNSUSPENDING",
+    "STOPPING", "STOPPED", "ABORTING", "ABORTED", "CLEARING"};
+static_assert(sizeof(PACKML_STATE_NAMES) / sizeof(PACKML_STATE_NAMES[0]) == (size_t)PackMLState::CLEARING + 1,
+              "PACKML_STATE_NAMES must cover every PackMLState");
+
+// Full MQTT topics are built once at setup into fixed buffers of this size
+typedef PayloadBuffer<96> TopicBuffer;
+
 // Forward declaration for command callback
 class PackMLStateMachine;
 typedef void (*CommandCallback)(PackMLStateMachine *, const JsonDocument &);
+// Fills in the steps of a command that runs as a motion sequence
+typedef void (*SequenceBuilder)(MotionSequence &);
 
 // Command registration structure
 struct CommandHandler
 {
-    String cmdTopic;
-    String dataTopic;
+    TopicBuffer cmdTopic;
+    TopicBuffer dataTopic;
     CommandCallback callback;
 };
 
-// Task data structure for async execution
-struct TaskData {
-    PackMLStateMachine* sm;
-    String topic;
-    String uuid;
-    void (*voidFunc)();
-    bool (*boolFunc)();
-    bool isBoolFunc;
+// Trace context a command arrived with, echoed as "Trace" on its DATA responses together
+// with this station's own timestamps (ms since epoch, 0 while NTP has not synchronized)
+struct CommandTrace
+{
+    static const size_t ID_MAX_LEN = 40;
+
+    char id[ID_MAX_LEN]; // Empty if the command carried no trace context
+    uint64_t sentMs;     // Controller clock
+    uint64_t receivedMs;
+    uint64_t startedMs;
+};
+
+// Command descriptor passed by value through the worker queue (no heap, no String)
+struct CommandDescriptor
+{
+    static const size_t UUID_MAX_LEN = 64;
+
+    const char *topic; // Points into a CommandHandler's precomputed data topic
+    char uuid[UUID_MAX_LEN];
+    CommandTrace trace;
+    bool (*processFunction)();
 };
 
 class PackMLStateMachine
@@ -59,30 +89,58 @@ private:
     String moduleName;
     AsyncMqttClient *client;
 
-    // Process queue
-    std::vector<String> uuids;
-    std::vector<String> pendingRegistrations; // Maps queued UUID to original registration command UUID
+    // Process queue: bounded FIFO of occupants, each flagged while its Occupy awaits SUCCESS
+    OccupancyQueue uuids;
     bool isProcessing;
     String currentProcessingUuid;
     String currentUuid;
     
-    // Task handle for async execution
+    // Long-lived worker task fed by a queue of command descriptors, created once in the constructor.
+    // The occupant at the head of the queue may queue its next command while one is running.
+    static const UBaseType_t COMMAND_QUEUE_LENGTH = 4;
+    static const uint32_t WORKER_STACK_SIZE = 8192;
+    static const UBaseType_t WORKER_PRIORITY = WORKER_TASK_PRIORITY; // Pinned to ACTUATION_CORE
     TaskHandle_t processTaskHandle;
+    QueueHandle_t commandQueue;
+    SemaphoreHandle_t commandMutex;  // Guards isProcessing/currentProcessingUuid against the worker
+    UBaseType_t commandsInFlight;    // Queued or running, guarded by commandMutex
+
+    // Commands running as motion sequences, answered when their sequence finishes
+    struct SequenceCommand
+    {
+        PackMLStateMachine *machine;
+        const char *topic;
+        char uuid[CommandDescriptor::UUID_MAX_LEN];
+        CommandTrace trace;
+        bool inUse; // Guarded by commandMutex
+    };
+    SequenceCommand sequenceCommands[MotionSequencer::TRACKS * MotionSequencer::TRACK_QUEUE_LENGTH];
 
     // Command handlers
     std::vector<CommandHandler> commandHandlers;
     bool subscriptionsInitialized;
 
-    // Topics
-    String occupyCmdTopic;
-    String occupyDataTopic;
-    String releaseCmdTopic;
-    String releaseDataTopic;
-    String stateDataTopic;
+    // Topics, precomputed in the constructor and registerCommandHandler()
+    TopicBuffer occupyCmdTopic;
+    TopicBuffer occupyDataTopic;
+    TopicBuffer releaseCmdTopic;
+    TopicBuffer releaseDataTopic;
+    TopicBuffer stateDataTopic;
 
     // Helper methods
-    void publishCommandStatus(const String &topic, const String &uuid, const char *stateValue);
-    String stateToString(PackMLState state);
+    // With a trace, SUCCESS and FAILURE also stamp the trace's completion time
+    void publishCommandStatus(const char *topic, const char *uuid, const char *stateValue,
+                              const CommandTrace *trace = nullptr);
+    const char *resolveDataTopic(const String &dataTopic) const;
+    const char *admitCommand(const JsonDocument &message, const String &dataTopic, String &commandUuid,
+                             CommandTrace &trace);
+    bool busyWithOther(const String &commandUuid, const char *topic,
+                       const CommandTrace &trace); // Caller holds commandMutex
+    void runCommand(const CommandDescriptor &command);
+    void finishCommand(const char *topic, const char *uuid, bool success, const CommandTrace &trace);
+    static void readTrace(const JsonDocument &message, CommandTrace &trace);
+    static uint64_t epochMillis();
+    static void sequenceDone(void *context, bool success);
     static void processTask(void* parameter);
 
     // State transition methods
@@ -112,20 +170,25 @@ public:
     void subscribeToTopics();
     void publishState();
     String getTimestamp();
+    static const char *stateToString(PackMLState state);
 
     // Command registration
     void registerCommandHandler(const String &cmdTopic, const String &dataTopic,
                                 CommandCallback callback);
 
     // Message handling
-    void handleMessage(const String &topic, const JsonDocument &message);
+    void handleMessage(const char *topic, const JsonDocument &message);
 
-    // Command execution
-    void executeCommand(const JsonDocument &message, const String &topic,
-                        void (*processFunction)());
-    void executeCommand(const JsonDocument &message, const String &topic,
+    // Command run by processFunction on the worker task, one at a time in arrival order; used
+    // by the native fleet and benchmark. dataTopic is the suffix given to registerCommandHandler()
+    void enqueueCommand(const JsonDocument &message, const String &dataTopic,
                         bool (*processFunction)());
 
+    // Command run as a motion sequence on a sequencer track instead of the worker task: it
+    // completes when the sequence does, and commands on other tracks run alongside it
+    void executeSequence(const JsonDocument &message, const String &dataTopic,
+                         uint8_t track, SequenceBuilder build);
+
     // Queue management
     void occupyCommand(const String &uuid);
     void releaseCommand(const String &uuid);
@@ -0,0 +1,122 @@
+#ifndef PAYLOAD_BUFFER_H
+#define PAYLOAD_BUFFER_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @class PayloadBuffer
+ * @brief Fixed-capacity text buffer for building MQTT topics and JSON payloads
+ *
+ * Lives on the stack or as a member, so the publish paths never touch the heap.
+ * Appends past the capacity are dropped and flagged via overflowed() instead of
+ * growing the buffer.
+ */
+template <size_t N>
+class PayloadBuffer
+{
+public:
+    PayloadBuffer() { clear(); }
+
+    void clear()
+    {
+        length = 0;
+        overflow = false;
+        data[0] = '\0';
+    }
+
+    PayloadBuffer &append(const char *text)
+    {
+        return append(text, strlen(text));
+    }
+
+    PayloadBuffer &append(const char *text, size_t textLen)
+    {
+        if (length + textLen >= N)
+        {
+            overflow = true;
+            textLen = N - 1 - length;
+        }
+        memcpy(data + length, text, textLen);
+        length += textLen;
+        data[length] = '\0';
+        return *this;
+    }
+
+    PayloadBuffer &appendf(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(data + length, N - length, format, args);
+        va_end(args);
+        if (written < 0 || (size_t)written >= N - length)
+        {
+            overflow = true;
+            length = N - 1;
+        }
+        else
+        {
+            length += written;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Append a JSON string literal, escaping quotes, backslashes and control characters
+     */
+    PayloadBuffer &appendJsonString(const char *text)
+    {
+        append("\"", 1);
+        for (const char *c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                char escaped[2] = {'\\', *c};
+                append(escaped, 2);
+            }
+            else if ((unsigned char)*c < 0x20)
+            {
+                appendf("\\u%04x", (unsigned int)(unsigned char)*c);
+            }
+            else
+            {
+                append(c, 1);
+            }
+        }
+        return append("\"", 1);
+    }
+
+    /**
+     * @brief Append the current local time as a JSON ISO 8601 string ("2000-01-01T00:00:00.000Z" if unset)
+     */
+    PayloadBuffer &appendJsonTimestamp()
+    {
+        char timestamp[32];
+        struct tm timeinfo;
+        if (getLocalTime(&timeinfo, 0))
+        {
+            strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S.000Z", &timeinfo);
+        }
+        else
+        {
+            strcpy(timestamp, "2000-01-01T00:00:00.000Z");
+        }
+        append("\"", 1);
+        append(timestamp);
+        return append("\"", 1);
+    }
+
+    const char *c_str() const { return data; }
+    size_t size() const { return length; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char data[N];
+    size_t length;
+    bool overflow;
+};
+
+#endif // PAYLOAD_BUFFER_H
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <ESP32Servo.h>
+#include "MotionSequencer.h"
 
 // Forward declarations
 class ESP32Module;
@@ -18,6 +19,9 @@ class PackMLStateMachine;
  * - Linear actuator control
  * - Limit switch reading
  * - Plunging operation sequence
+ *
+ * The cycle runs as a motion sequence on the sequencer, so the station keeps answering
+ * Occupy/Release and state requests while the mechanism moves.
  */
 class StopperingModule
 {
@@ -85,32 +89,29 @@ private:
      */
     static void initDCMotor();
 
-    /**
-     * @brief Execute complete stoppering cycle
-     * @return true if successful, false if motion error occurred
-     */
-    static bool runStopperingCycle();
-
-    /**
-     * @brief Move linear actuator down and up
-     */
-    static void runLinearActuator();
-
-    /**
-     * @brief Move servo from inner to outer position
-     */
-    static void runServo();
+    // Sequencer track of the mechanism; its actuators share the vial, so steps run in order
+    static const uint8_t MECHANISM_TRACK = 0;
 
     /**
-     * @brief Move DC motor down until limit switch
-     * @return true if successful, false if timeout
+     * @brief Complete stoppering cycle: DC down, servo, plunge, DC up
      */
-    static bool moveDCDown();
+    static void buildStopperingCycle(MotionSequence &sequence);
+
+    // Step actions
+    static void startDCDown();
+    static void startDCUp();
+    static void attachServo();
+    static void servoInner();
+    static void servoOuter();
+    static void detachServo();
+    static void startLinearActuatorDown();
+    static void startLinearActuatorUp();
+    static void reportCycleComplete();
 
     /**
-     * @brief Move DC motor up for clearance
+     * @brief Stop every actuator after a motion error
      */
-    static void moveDCUp();
+    static void stopAll();
 
     /**
      * @brief Stop DC motor
@@ -122,14 +123,6 @@ private:
      */
     static void stopLinearActuator();
 
-    /**
-     * @brief Wait for limit switch with timeout
-     * @param buttonPin Pin number of button to monitor
-     * @param timeoutMs Timeout in milliseconds
-     * @return true if button pressed, false if timeout
-     */
-    static bool waitForButton(int buttonPin, unsigned long timeoutMs);
-
     // Static members
     static ESP32Module *esp32Module;
     static Servo servo;
@@ -0,0 +1,47 @@
+#ifndef TASK_LAYOUT_H
+#define TASK_LAYOUT_H
+
+#include <Arduino.h>
+
+// Core affinity and priorities of the station's FreeRTOS tasks.
+//
+// Core 0 (NETWORK_CORE) runs the WiFi stack and AsyncTCP, whose task delivers MQTT messages
+// to ESP32Module::onMqttMessage; admission and the RUNNING acknowledgment happen there.
+// Core 1 (ACTUATION_CORE) runs the motion sequencer, the PackML command worker and sensor
+// streaming, so WiFi bursts do not delay motion steps and long commands do not delay
+// acknowledgments. The two sides only meet in the command queue and the sequencer tracks.
+//
+// AsyncTCP reads its core from CONFIG_ASYNC_TCP_RUNNING_CORE (set in platformio.ini); the
+// network core follows it. Override any of these with -D flags.
+
+#ifndef NETWORK_CORE
+#if defined(CONFIG_ASYNC_TCP_RUNNING_CORE) && CONFIG_ASYNC_TCP_RUNNING_CORE >= 0
+#define NETWORK_CORE CONFIG_ASYNC_TCP_RUNNING_CORE
+#else
+#define NETWORK_CORE 0
+#endif
+#endif
+
+#ifndef ACTUATION_CORE
+#if CONFIG_FREERTOS_UNICORE
+#define ACTUATION_CORE 0
+#else
+#define ACTUATION_CORE (NETWORK_CORE == 0 ? 1 : 0)
+#endif
+#endif
+
+// Priorities on the actuation core: the sequencer preempts the worker's blocking commands,
+// both preempt sensing (the Arduino loop task, priority 1, is deleted in main.cpp)
+#ifndef SEQUENCER_TASK_PRIORITY
+#define SEQUENCER_TASK_PRIORITY 3
+#endif
+
+#ifndef WORKER_TASK_PRIORITY
+#define WORKER_TASK_PRIORITY 2
+#endif
+
+#ifndef SENSING_TASK_PRIORITY
+#define SENSING_TASK_PRIORITY 1
+#endif
+
+#endif // TASK_LAYOUT_H
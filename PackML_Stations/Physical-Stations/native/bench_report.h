@@ -0,0 +1,103 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @class LatencySamples
+ * @brief Thread-safe list of latencies in microseconds, summarized as percentiles
+ *
+ * Keeps every sample: runs of the native tools are minutes long, so that stays small
+ * and the percentiles are exact.
+ */
+class LatencySamples
+{
+public:
+    void add(uint64_t us)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.push_back(us);
+    }
+
+    size_t count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return samples.size();
+    }
+
+    /// @brief Write {Count, MeanUs, P50Us, P90Us, P99Us, MaxUs} into out
+    void summarize(JsonObject out) const
+    {
+        std::vector<uint64_t> sorted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sorted = samples;
+        }
+        out["Count"] = sorted.size();
+        if (sorted.empty())
+        {
+            return;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t total = 0;
+        for (uint64_t us : sorted)
+        {
+            total += us;
+        }
+        out["MeanUs"] = total / sorted.size();
+        out["P50Us"] = percentile(sorted, 0.50);
+        out["P90Us"] = percentile(sorted, 0.90);
+        out["P99Us"] = percentile(sorted, 0.99);
+        out["MaxUs"] = sorted.back();
+    }
+
+private:
+    static uint64_t percentile(const std::vector<uint64_t> &sorted, double fraction)
+    {
+        size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    mutable std::mutex mutex;
+    std::vector<uint64_t> samples;
+};
+
+/// @brief Local time as ISO 8601, for the report's TimeStamp
+inline std::string reportTimestamp()
+{
+    char timestamp[32];
+    struct tm timeinfo;
+    getLocalTime(&timeinfo, 0);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+    return timestamp;
+}
+
+/// @brief Write the report as pretty JSON to output, "-" for stdout; 0 on success
+inline int writeReport(const JsonDocument &report, const std::string &output)
+{
+    std::string text;
+    serializeJsonPretty(report, text);
+    if (output == "-")
+    {
+        std::cout << text << std::endl;
+        return 0;
+    }
+    std::ofstream out(output);
+    if (!out)
+    {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    out << text << std::endl;
+    std::cerr << "Results written to " << output << std::endl;
+    return 0;
+}
+
+#endif // BENCH_REPORT_H
@@ -0,0 +1,252 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+NativeSerial Serial;
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const Clock::time_point processStart = Clock::now();
+
+    std::atomic<bool> serialEnabled{true};
+    std::mutex serialMutex;
+
+    std::atomic<uint8_t> pinLevels[256];
+
+    // Blocks like a FreeRTOS wait of ticksToWait ms; portMAX_DELAY waits forever
+    bool waitUntil(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticksToWait,
+                   const std::function<bool()> &ready)
+    {
+        if (ticksToWait == portMAX_DELAY)
+        {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticksToWait), ready);
+    }
+}
+
+struct NativeTask
+{
+    std::thread thread;
+};
+
+struct NativeQueue
+{
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t itemSize;
+};
+
+struct NativeSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable available;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+};
+
+// Arduino core
+
+void NativeSerial::flush()
+{
+    fflush(stdout);
+}
+
+void NativeSerial::setEnabled(bool enabled)
+{
+    serialEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+size_t NativeSerial::print(const char *text)
+{
+    if (!serialEnabled.load(std::memory_order_relaxed) || !text)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(serialMutex);
+    return fwrite(text, 1, strlen(text), stdout);
+}
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - processStart).count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - processStart).count();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP)
+    {
+        pinLevels[pin].store(HIGH);
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    pinLevels[pin].store(level ? HIGH : LOW);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pinLevels[pin].load();
+}
+
+bool getLocalTime(struct tm *info, uint32_t)
+{
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return info->tm_year > (2016 - 1900);
+}
+
+// FreeRTOS
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)millis();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment)
+{
+    *previousWakeTime += increment;
+    std::this_thread::sleep_until(processStart + std::chrono::milliseconds(*previousWakeTime));
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth,
+                                   void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t)
+{
+    return xTaskCreate(function, name, stackDepth, parameter, priority, handle);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *, uint32_t, void *parameter, UBaseType_t,
+                       TaskHandle_t *handle)
+{
+    // Station tasks run for the life of the process, like on the ESP32
+    NativeTask *task = new NativeTask{std::thread(function, parameter)};
+    task->thread.detach();
+    if (handle)
+    {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    NativeQueue *queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitUntil(queue->notFull, lock, ticksToWait, [queue]
+                   { return queue->items.size() < queue->length; }))
+    {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = (const uint8_t *)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    lock.unlock();
+    queue->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitUntil(queue->notEmpty, lock, ticksToWait, [queue]
+                   { return !queue->items.empty(); }))
+    {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    lock.unlock();
+    queue->notFull.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    NativeSemaphore *semaphore = new NativeSemaphore();
+    semaphore->count = initialCount;
+    semaphore->maxCount = maxCount;
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitUntil(semaphore->available, lock, ticksToWait, [semaphore]
+                   { return semaphore->count > 0; }))
+    {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        if (semaphore->count == semaphore->maxCount)
+        {
+            return pdFALSE;
+        }
+        semaphore->count++;
+    }
+    semaphore->available.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
@@ -0,0 +1,209 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the parts of the ESP32 Arduino core and FreeRTOS that PackMLStateMachine
+// and MotionSequencer use, so they build unchanged for the native targets in this directory.
+// Tasks are detached std::threads; queues and semaphores are built on std::mutex and
+// std::condition_variable. Task priorities, stack sizes and core affinity are ignored.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <type_traits>
+
+// Arduino core
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+class StringSumHelper;
+
+// The subset of Arduino's String the station code and ArduinoJson use
+class String
+{
+public:
+    String() {}
+    String(const char *text) : value(text ? text : "") {}
+    String(const std::string &text) : value(text) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    String &operator=(const char *text)
+    {
+        value = text ? text : "";
+        return *this;
+    }
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return (unsigned int)value.size(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size)
+    {
+        value.reserve(size);
+        return true;
+    }
+
+    bool concat(const char *text)
+    {
+        if (text)
+        {
+            value += text;
+        }
+        return true;
+    }
+    bool concat(const String &text) { return concat(text.c_str()); }
+    bool concat(char c)
+    {
+        value += c;
+        return true;
+    }
+
+    String &operator+=(const char *text)
+    {
+        concat(text);
+        return *this;
+    }
+    String &operator+=(const String &text)
+    {
+        concat(text);
+        return *this;
+    }
+
+    bool operator==(const String &other) const { return value == other.value; }
+    bool operator==(const char *other) const { return value == (other ? other : ""); }
+    bool operator!=(const String &other) const { return !(*this == other); }
+    bool operator!=(const char *other) const { return !(*this == other); }
+    bool operator<(const String &other) const { return value < other.value; }
+
+    friend StringSumHelper operator+(const StringSumHelper &lhs, const String &rhs);
+    friend StringSumHelper operator+(const StringSumHelper &lhs, const char *rhs);
+
+private:
+    std::string value;
+};
+
+// Result of String concatenation, as in the Arduino core (ArduinoJson adapts both types)
+class StringSumHelper : public String
+{
+public:
+    StringSumHelper(const String &text) : String(text) {}
+    StringSumHelper(const char *text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const StringSumHelper &lhs, const String &rhs)
+{
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+inline StringSumHelper operator+(const StringSumHelper &lhs, const char *rhs)
+{
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+// Writes to stdout; muted with setEnabled(false), which the fleet does for hundreds of stations
+class NativeSerial
+{
+public:
+    void begin(unsigned long) {}
+    void flush();
+    void setEnabled(bool enabled);
+
+    size_t print(const char *text);
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t print(char c)
+    {
+        char text[2] = {c, '\0'};
+        return print(text);
+    }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    size_t print(T number)
+    {
+        return print(std::to_string(number).c_str());
+    }
+
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t written = print(value);
+        return written + println();
+    }
+};
+
+extern NativeSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+// Pins are plain levels; digitalWrite() on an input is how a test drives an end switch
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+
+// The host clock is always set, so this only fails before 2016 like the ESP32 version
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+
+// FreeRTOS
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+struct NativeTask;
+struct NativeQueue;
+struct NativeSemaphore;
+typedef NativeTask *TaskHandle_t;
+typedef NativeQueue *QueueHandle_t;
+typedef NativeSemaphore *SemaphoreHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+// Ticks are milliseconds since the process started
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth,
+                                   void *parameter, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter,
+                       UBaseType_t priority, TaskHandle_t *handle);
+
+// Items are copied in and out by value, as FreeRTOS does
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+// Mutexes are binary semaphores that start out given; none of the callers nest them
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif // NATIVE_ARDUINO_H
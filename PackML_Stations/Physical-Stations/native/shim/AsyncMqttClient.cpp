@@ -0,0 +1,239 @@
+#include "AsyncMqttClient.h"
+
+#include <mqtt/async_client.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+struct AsyncMqttClient::Impl : public virtual mqtt::callback, public virtual mqtt::iaction_listener
+{
+    std::string host = "localhost";
+    uint16_t port = 1883;
+    std::string clientId;
+    uint16_t keepAlive = 15; // AsyncMqttClient's default
+    bool cleanSession = true;
+
+    OnConnectUserCallback connectCallback;
+    OnDisconnectUserCallback disconnectCallback;
+    OnMessageUserCallback messageCallback;
+    OnPublishUserCallback publishCallback;
+    LoopbackHandler loopback;
+
+    std::unique_ptr<mqtt::async_client> client;
+    std::atomic<bool> isConnected{false};
+
+    // mqtt::callback, on Paho's callback thread
+    void connected(const std::string &) override
+    {
+        isConnected.store(true);
+        if (connectCallback)
+        {
+            connectCallback(false);
+        }
+    }
+
+    void connection_lost(const std::string &) override
+    {
+        isConnected.store(false);
+        if (disconnectCallback)
+        {
+            disconnectCallback(AsyncMqttClientDisconnectReason::TCP_DISCONNECTED);
+        }
+    }
+
+    void message_arrived(mqtt::const_message_ptr msg) override
+    {
+        // The callback may modify topic and payload, as AsyncMqttClient's buffers allow
+        std::string topic = msg->get_topic();
+        std::string payload = msg->to_string();
+        AsyncMqttClientMessageProperties properties{(uint8_t)msg->get_qos(), false, msg->is_retained()};
+        if (messageCallback)
+        {
+            messageCallback(&topic[0], &payload[0], properties, payload.size(), 0, payload.size());
+        }
+    }
+
+    void delivery_complete(mqtt::delivery_token_ptr token) override
+    {
+        if (token && publishCallback)
+        {
+            publishCallback((uint16_t)token->get_message_id());
+        }
+    }
+
+    // mqtt::iaction_listener, for the connect attempt only
+    void on_failure(const mqtt::token &) override
+    {
+        if (disconnectCallback)
+        {
+            disconnectCallback(AsyncMqttClientDisconnectReason::MQTT_SERVER_UNAVAILABLE);
+        }
+    }
+
+    void on_success(const mqtt::token &) override {}
+};
+
+AsyncMqttClient::AsyncMqttClient() : impl(new Impl()) {}
+
+AsyncMqttClient::~AsyncMqttClient()
+{
+    disconnect();
+}
+
+AsyncMqttClient &AsyncMqttClient::setServer(const char *host, uint16_t port)
+{
+    impl->host = host;
+    impl->port = port;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::setClientId(const char *clientId)
+{
+    impl->clientId = clientId;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::setKeepAlive(uint16_t keepAlive)
+{
+    impl->keepAlive = keepAlive;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::setCleanSession(bool cleanSession)
+{
+    impl->cleanSession = cleanSession;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::onConnect(OnConnectUserCallback callback)
+{
+    impl->connectCallback = callback;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::onDisconnect(OnDisconnectUserCallback callback)
+{
+    impl->disconnectCallback = callback;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::onMessage(OnMessageUserCallback callback)
+{
+    impl->messageCallback = callback;
+    return *this;
+}
+
+AsyncMqttClient &AsyncMqttClient::onPublish(OnPublishUserCallback callback)
+{
+    impl->publishCallback = callback;
+    return *this;
+}
+
+bool AsyncMqttClient::connected() const
+{
+    return impl->loopback || impl->isConnected.load();
+}
+
+void AsyncMqttClient::connect()
+{
+    if (impl->loopback)
+    {
+        return;
+    }
+    if (!impl->client)
+    {
+        std::string uri = "tcp://" + impl->host + ":" + std::to_string(impl->port);
+        impl->client.reset(new mqtt::async_client(uri, impl->clientId));
+        impl->client->set_callback(*impl);
+    }
+
+    auto options = mqtt::connect_options_builder()
+                       .mqtt_version(MQTTVERSION_3_1_1)
+                       .keep_alive_interval(std::chrono::seconds(impl->keepAlive))
+                       .clean_session(impl->cleanSession)
+                       .automatic_reconnect(std::chrono::seconds(1), std::chrono::seconds(30))
+                       .finalize();
+    try
+    {
+        impl->client->connect(options, nullptr, *impl);
+    }
+    catch (const mqtt::exception &e)
+    {
+        Serial.print("MQTT connect failed: ");
+        Serial.println(e.what());
+    }
+}
+
+void AsyncMqttClient::disconnect(bool force)
+{
+    if (!impl->client || !impl->isConnected.load())
+    {
+        return;
+    }
+    try
+    {
+        // force does not give in-flight messages time to complete
+        impl->client->disconnect(force ? 0 : 1000)->wait_for(std::chrono::seconds(2));
+    }
+    catch (const mqtt::exception &)
+    {
+    }
+    impl->isConnected.store(false);
+}
+
+uint16_t AsyncMqttClient::subscribe(const char *topic, uint8_t qos)
+{
+    if (impl->loopback)
+    {
+        return 1;
+    }
+    if (!connected())
+    {
+        return 0;
+    }
+    try
+    {
+        int packetId = impl->client->subscribe(topic, qos)->get_message_id();
+        return packetId ? (uint16_t)packetId : 1;
+    }
+    catch (const mqtt::exception &)
+    {
+        return 0;
+    }
+}
+
+uint16_t AsyncMqttClient::publish(const char *topic, uint8_t qos, bool retain, const char *payload, size_t length,
+                                  bool, uint16_t)
+{
+    if (!payload)
+    {
+        payload = "";
+        length = 0;
+    }
+    if (impl->loopback)
+    {
+        impl->loopback(topic, payload, length);
+        return 1;
+    }
+    if (!connected())
+    {
+        return 0;
+    }
+    try
+    {
+        // Paho assigns packet ids itself; a requested message_id is not honored
+        auto message = mqtt::make_message(topic, payload, length, qos, retain);
+        int packetId = impl->client->publish(message)->get_message_id();
+        return packetId ? (uint16_t)packetId : 1;
+    }
+    catch (const mqtt::exception &)
+    {
+        return 0;
+    }
+}
+
+void AsyncMqttClient::setLoopback(LoopbackHandler handler)
+{
+    impl->loopback = handler;
+}
@@ -0,0 +1,83 @@
+#ifndef NATIVE_ASYNC_MQTT_CLIENT_H
+#define NATIVE_ASYNC_MQTT_CLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+
+// Host stand-in for marvinroger/AsyncMqttClient 0.9.0, backed by the Paho MQTT C++ client on
+// MQTT 3.1.1 like the ESP32 stations. Callbacks have the library's signatures and run on
+// Paho's callback thread, which plays the AsyncTCP task; Paho also reconnects after a lost
+// connection, where ESP32Module would call connect() from onDisconnect.
+
+enum class AsyncMqttClientDisconnectReason : uint8_t
+{
+    TCP_DISCONNECTED = 0,
+    MQTT_UNACCEPTABLE_PROTOCOL_VERSION = 1,
+    MQTT_IDENTIFIER_REJECTED = 2,
+    MQTT_SERVER_UNAVAILABLE = 3,
+    MQTT_MALFORMED_CREDENTIALS = 4,
+    MQTT_NOT_AUTHORIZED = 5,
+    ESP8266_NOT_ENOUGH_SPACE = 6,
+    TLS_BAD_FINGERPRINT = 7
+};
+
+struct AsyncMqttClientMessageProperties
+{
+    uint8_t qos;
+    bool dup;
+    bool retain;
+};
+
+class AsyncMqttClient
+{
+public:
+    typedef std::function<void(bool sessionPresent)> OnConnectUserCallback;
+    typedef std::function<void(AsyncMqttClientDisconnectReason reason)> OnDisconnectUserCallback;
+    typedef std::function<void(char *topic, char *payload, AsyncMqttClientMessageProperties properties,
+                               size_t len, size_t index, size_t total)>
+        OnMessageUserCallback;
+    typedef std::function<void(uint16_t packetId)> OnPublishUserCallback;
+
+    // Native only: receives every publish instead of a broker, see setLoopback()
+    typedef std::function<void(const char *topic, const char *payload, size_t length)> LoopbackHandler;
+
+    AsyncMqttClient();
+    ~AsyncMqttClient();
+
+    AsyncMqttClient(const AsyncMqttClient &) = delete;
+    AsyncMqttClient &operator=(const AsyncMqttClient &) = delete;
+
+    AsyncMqttClient &setServer(const char *host, uint16_t port);
+    AsyncMqttClient &setClientId(const char *clientId);
+    AsyncMqttClient &setKeepAlive(uint16_t keepAlive);
+    AsyncMqttClient &setCleanSession(bool cleanSession);
+
+    AsyncMqttClient &onConnect(OnConnectUserCallback callback);
+    AsyncMqttClient &onDisconnect(OnDisconnectUserCallback callback);
+    AsyncMqttClient &onMessage(OnMessageUserCallback callback);
+    AsyncMqttClient &onPublish(OnPublishUserCallback callback);
+
+    bool connected() const;
+    void connect();
+    void disconnect(bool force = false);
+
+    // 0 on failure, like the library; QoS 0 publishes that went out return 1
+    uint16_t subscribe(const char *topic, uint8_t qos);
+    uint16_t publish(const char *topic, uint8_t qos, bool retain, const char *payload = nullptr,
+                     size_t length = 0, bool dup = false, uint16_t message_id = 0);
+
+    /**
+     * @brief Native only: run without a broker, handing every publish to handler
+     *
+     * The client then counts as connected and subscriptions succeed without effect, so an
+     * in-process benchmark can drive PackMLStateMachine::handleMessage() directly.
+     */
+    void setLoopback(LoopbackHandler handler);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // NATIVE_ASYNC_MQTT_CLIENT_H
@@ -0,0 +1,588 @@
+// Spawns a fleet of virtual stations against a real broker: each runs the firmware's
+// PackMLStateMachine on its own MQTT connection. Optionally drives them like the controller
+// (Occupy, each command, Release) and reports round-trip latencies.
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <AsyncMqttClient.h>
+#include "PackMLStateMachine.h"
+#include "bench_report.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct FleetOptions
+    {
+        std::string host = "localhost";
+        uint16_t port = 1883;
+        std::string baseTopic = "NN/Nybrovej/InnoLab";
+        std::string namePrefix = "VirtualStation";
+        size_t stations = 100;
+        std::vector<std::string> commands{"Process"};
+        uint32_t commandMs = 200;
+        double failureRate = 0.0;
+        bool drive = false;
+        size_t occupants = 1; // Per station, when driving
+        uint32_t durationS = 60; // 0 = until interrupted
+        uint32_t timeoutMs = 10000;
+        std::string output = "-";
+        bool verbose = false;
+    };
+
+    std::atomic<bool> stopRequested{false};
+
+    void onSignal(int)
+    {
+        stopRequested.store(true);
+    }
+
+    uint64_t elapsedUs(Clock::time_point from, Clock::time_point to)
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+
+    // The simulated process shared by all stations: the worker task sleeps for the command
+    // time and then fails at the configured rate
+    std::atomic<uint32_t> commandMs{0};
+    std::atomic<uint32_t> failurePpm{0};
+    std::atomic<uint64_t> commandsRun{0};
+
+    bool simulatedProcess()
+    {
+        vTaskDelay(pdMS_TO_TICKS(commandMs.load()));
+        commandsRun.fetch_add(1);
+        thread_local std::mt19937 generator{std::random_device{}()};
+        return std::uniform_int_distribution<uint32_t>(0, 999999)(generator) >= failurePpm.load();
+    }
+
+    // Command handlers are plain function pointers, so each command slot has its own.
+    // The sequencer path is not used: MotionSequencer is process-wide and its three tracks
+    // would be shared by the whole fleet.
+    const size_t MAX_COMMANDS = 4;
+    String commandDataTopics[MAX_COMMANDS];
+
+    template <size_t I>
+    void runCommand(PackMLStateMachine *sm, const JsonDocument &message)
+    {
+        sm->enqueueCommand(message, commandDataTopics[I], simulatedProcess);
+    }
+
+    const CommandCallback commandCallbacks[MAX_COMMANDS] = {runCommand<0>, runCommand<1>, runCommand<2>,
+                                                            runCommand<3>};
+
+    // A station's tasks run until the process exits, so stations are never destroyed
+    struct VirtualStation
+    {
+        String name;
+        AsyncMqttClient client;
+        PackMLStateMachine *machine = nullptr;
+    };
+
+    VirtualStation *startStation(const FleetOptions &options, size_t index)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "%s%03zu", options.namePrefix.c_str(), index + 1);
+
+        VirtualStation *station = new VirtualStation();
+        station->name = name;
+        station->machine = new PackMLStateMachine(options.baseTopic.c_str(), station->name, &station->client);
+        for (size_t i = 0; i < options.commands.size(); i++)
+        {
+            station->machine->registerCommandHandler(("/CMD/" + options.commands[i]).c_str(), commandDataTopics[i],
+                                                     commandCallbacks[i]);
+        }
+
+        // Routed like ESP32Module::onMqttConnect and dispatchMessage
+        PackMLStateMachine *machine = station->machine;
+        station->client.onConnect([machine](bool)
+                                  {
+                                      machine->subscribeToTopics();
+                                      machine->publishState();
+                                  });
+        station->client.onMessage([machine](char *topic, char *payload, AsyncMqttClientMessageProperties, size_t len,
+                                            size_t, size_t)
+                                  {
+                                      JsonDocument message;
+                                      if (!deserializeJson(message, payload, len))
+                                      {
+                                          machine->handleMessage(topic, message);
+                                      }
+                                  });
+        station->client.setServer(options.host.c_str(), options.port);
+        station->client.setClientId(name);
+        station->client.connect();
+        return station;
+    }
+
+    /**
+     * @class FleetDriver
+     * @brief Plays the controller: occupants loop Occupy, each command in turn, Release
+     *
+     * Every occupant holds one UUID per cycle and waits for each answer before the next
+     * step, so a station with several occupants queues them like concurrent products.
+     */
+    class FleetDriver
+    {
+    public:
+        FleetDriver(const FleetOptions &options, const std::vector<VirtualStation *> &stations)
+            : options(options), runId(std::random_device{}())
+        {
+            for (size_t s = 0; s < stations.size(); s++)
+            {
+                std::string base = options.baseTopic + "/" + stations[s]->name.c_str();
+                for (size_t i = 0; i < options.occupants; i++)
+                {
+                    Occupant occupant;
+                    occupant.base = base;
+                    occupant.index = s * options.occupants + i;
+                    occupants.push_back(occupant);
+                }
+            }
+        }
+
+        bool start()
+        {
+            client.onMessage([this](char *topic, char *payload, AsyncMqttClientMessageProperties, size_t len, size_t,
+                                    size_t)
+                             { onMessage(topic, payload, len); });
+            client.setServer(options.host.c_str(), options.port);
+            client.setClientId((options.namePrefix + "Driver").c_str());
+            client.connect();
+            auto deadline = Clock::now() + std::chrono::seconds(10);
+            while (!client.connected() && Clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            if (!client.connected())
+            {
+                return false;
+            }
+
+            std::string responses = options.baseTopic + "/+/DATA/";
+            client.subscribe((responses + "Occupy").c_str(), 2);
+            client.subscribe((responses + "Release").c_str(), 2);
+            for (const auto &command : options.commands)
+            {
+                client.subscribe((responses + command).c_str(), 2);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Let the SUBACKs arrive
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            started = now;
+            for (auto &occupant : occupants)
+            {
+                beginCycle(occupant, now);
+            }
+            return true;
+        }
+
+        void stop()
+        {
+            client.disconnect();
+        }
+
+        uint64_t cycles() const { return completedCycles.load(); }
+
+        void report(JsonObject out)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            size_t stalled = 0;
+            for (const auto &occupant : occupants)
+            {
+                if (now - occupant.stepStart > std::chrono::milliseconds(options.timeoutMs))
+                {
+                    stalled++;
+                }
+            }
+            double elapsedS = std::chrono::duration<double>(now - started).count();
+            out["Occupants"] = occupants.size();
+            out["Cycles"] = completedCycles.load();
+            out["CyclesPerSecond"] = elapsedS > 0 ? completedCycles.load() / elapsedS : 0.0;
+            out["Failures"] = failures.load();
+            out["Stalled"] = stalled;
+            JsonObject latency = out["Latency"].to<JsonObject>();
+            occupyLatency.summarize(latency["Occupy"].to<JsonObject>());
+            ackLatency.summarize(latency["CommandAck"].to<JsonObject>());
+            commandLatency.summarize(latency["Command"].to<JsonObject>());
+            releaseLatency.summarize(latency["Release"].to<JsonObject>());
+            cycleLatency.summarize(latency["Cycle"].to<JsonObject>());
+        }
+
+    private:
+        enum class Step
+        {
+            Occupy,
+            Command,
+            Release
+        };
+
+        struct Occupant
+        {
+            std::string base; // <baseTopic>/<station>
+            size_t index;
+            uint64_t cycle = 0;
+            Step step = Step::Occupy;
+            size_t command = 0;
+            bool acknowledged = false;
+            std::string uuid;
+            Clock::time_point cycleStart;
+            Clock::time_point stepStart;
+        };
+
+        // Caller holds mutex
+        void beginCycle(Occupant &occupant, Clock::time_point now)
+        {
+            byUuid.erase(occupant.uuid);
+            char uuid[64];
+            snprintf(uuid, sizeof(uuid), "fleet-%08x-%zu-%llu", runId, occupant.index,
+                     (unsigned long long)occupant.cycle++);
+            occupant.uuid = uuid;
+            byUuid[occupant.uuid] = &occupant;
+            occupant.cycleStart = now;
+            send(occupant, Step::Occupy, "Occupy", now);
+        }
+
+        void send(Occupant &occupant, Step step, const std::string &command, Clock::time_point now)
+        {
+            occupant.step = step;
+            occupant.acknowledged = false;
+            occupant.stepStart = now;
+            PayloadBuffer<128> payload;
+            payload.append("{\"Uuid\":").appendJsonString(occupant.uuid.c_str()).append("}");
+            client.publish((occupant.base + "/CMD/" + command).c_str(), 2, false, payload.c_str(), payload.size());
+        }
+
+        void onMessage(const char *topic, const char *payload, size_t len)
+        {
+            JsonDocument message;
+            if (deserializeJson(message, payload, len))
+            {
+                return;
+            }
+            const char *uuid = message["Uuid"];
+            const char *state = message["State"];
+            const char *command = strrchr(topic, '/');
+            if (!uuid || !state || !command)
+            {
+                return;
+            }
+            command++;
+            auto now = Clock::now();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = byUuid.find(uuid);
+            if (found == byUuid.end())
+            {
+                return; // Retained answer from an earlier cycle or run
+            }
+            Occupant &occupant = *found->second;
+            bool running = strcmp(state, "RUNNING") == 0;
+            bool success = strcmp(state, "SUCCESS") == 0;
+
+            switch (occupant.step)
+            {
+            case Step::Occupy:
+                if (strcmp(command, "Occupy") != 0 || running)
+                {
+                    return; // Queued behind other occupants
+                }
+                if (!success)
+                {
+                    failures.fetch_add(1);
+                    beginCycle(occupant, now);
+                    return;
+                }
+                occupyLatency.add(elapsedUs(occupant.stepStart, now));
+                occupant.command = 0;
+                send(occupant, Step::Command, options.commands[0], now);
+                return;
+
+            case Step::Command:
+                if (strcmp(command, options.commands[occupant.command].c_str()) != 0)
+                {
+                    return;
+                }
+                if (running)
+                {
+                    if (!occupant.acknowledged)
+                    {
+                        ackLatency.add(elapsedUs(occupant.stepStart, now));
+                        occupant.acknowledged = true;
+                    }
+                    return;
+                }
+                commandLatency.add(elapsedUs(occupant.stepStart, now));
+                if (!success)
+                {
+                    failures.fetch_add(1);
+                }
+                if (++occupant.command < options.commands.size())
+                {
+                    send(occupant, Step::Command, options.commands[occupant.command], now);
+                    return;
+                }
+                send(occupant, Step::Release, "Release", now);
+                return;
+
+            case Step::Release:
+                if (strcmp(command, "Release") != 0 || running)
+                {
+                    return;
+                }
+                if (success)
+                {
+                    releaseLatency.add(elapsedUs(occupant.stepStart, now));
+                    cycleLatency.add(elapsedUs(occupant.cycleStart, now));
+                    completedCycles.fetch_add(1);
+                }
+                else
+                {
+                    failures.fetch_add(1);
+                }
+                beginCycle(occupant, now);
+                return;
+            }
+        }
+
+        const FleetOptions &options;
+        const uint32_t runId; // Keeps this run's UUIDs apart from retained answers to earlier ones
+        AsyncMqttClient client;
+
+        std::mutex mutex; // Guards occupants and byUuid against the callback thread
+        std::vector<Occupant> occupants;
+        std::unordered_map<std::string, Occupant *> byUuid;
+        Clock::time_point started;
+
+        std::atomic<uint64_t> completedCycles{0};
+        std::atomic<uint64_t> failures{0};
+        LatencySamples occupyLatency;
+        LatencySamples ackLatency;
+        LatencySamples commandLatency;
+        LatencySamples releaseLatency;
+        LatencySamples cycleLatency;
+    };
+
+    size_t connectedStations(const std::vector<VirtualStation *> &stations)
+    {
+        size_t connected = 0;
+        for (const auto *station : stations)
+        {
+            connected += station->client.connected() ? 1 : 0;
+        }
+        return connected;
+    }
+
+    int runFleet(const FleetOptions &options)
+    {
+        Serial.setEnabled(options.verbose);
+        commandMs.store(options.commandMs);
+        failurePpm.store((uint32_t)(options.failureRate * 1000000));
+        for (size_t i = 0; i < options.commands.size(); i++)
+        {
+            commandDataTopics[i] = ("/DATA/" + options.commands[i]).c_str();
+        }
+
+        std::vector<VirtualStation *> stations;
+        for (size_t i = 0; i < options.stations; i++)
+        {
+            stations.push_back(startStation(options, i));
+        }
+        auto deadline = Clock::now() + std::chrono::seconds(30);
+        while (connectedStations(stations) < stations.size() && Clock::now() < deadline && !stopRequested.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        size_t connected = connectedStations(stations);
+        std::cerr << connected << "/" << stations.size() << " stations connected to " << options.host << ":"
+                  << options.port << std::endl;
+        if (connected == 0)
+        {
+            return 1;
+        }
+
+        FleetDriver driver(options, stations);
+        if (options.drive && !driver.start())
+        {
+            std::cerr << "Driver could not connect" << std::endl;
+            return 1;
+        }
+
+        auto start = Clock::now();
+        uint64_t lastCommands = 0;
+        while (!stopRequested.load() &&
+               (options.durationS == 0 || Clock::now() - start < std::chrono::seconds(options.durationS)))
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            uint64_t commands = commandsRun.load();
+            std::cerr << "[" << std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - start).count()
+                      << " s] " << connectedStations(stations) << " connected, " << commands - lastCommands
+                      << " commands/s";
+            if (options.drive)
+            {
+                std::cerr << ", " << driver.cycles() << " cycles";
+            }
+            std::cerr << std::endl;
+            lastCommands = commands;
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        JsonDocument report;
+        report["Benchmark"] = "station_fleet";
+        report["TimeStamp"] = reportTimestamp();
+        JsonObject settings = report["Options"].to<JsonObject>();
+        settings["Broker"] = options.host + ":" + std::to_string(options.port);
+        settings["Stations"] = options.stations;
+        JsonArray commands = settings["Commands"].to<JsonArray>();
+        for (const auto &command : options.commands)
+        {
+            commands.add(command);
+        }
+        settings["CommandMs"] = options.commandMs;
+        settings["FailureRate"] = options.failureRate;
+        settings["Occupants"] = options.drive ? options.occupants : 0;
+        report["ConnectedStations"] = connectedStations(stations);
+        report["ElapsedMs"] = elapsedMs;
+        report["CommandsRun"] = commandsRun.load();
+        report["CommandsPerSecond"] = elapsedMs > 0 ? commandsRun.load() * 1000.0 / elapsedMs : 0.0;
+        if (options.drive)
+        {
+            driver.report(report["Drive"].to<JsonObject>());
+            driver.stop();
+        }
+        for (auto *station : stations)
+        {
+            station->client.disconnect();
+        }
+        return writeReport(report, options.output);
+    }
+
+    std::vector<std::string> splitList(const std::string &list)
+    {
+        std::vector<std::string> items;
+        size_t begin = 0;
+        while (begin <= list.size())
+        {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            if (end > begin)
+            {
+                items.push_back(list.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+        return items;
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --broker HOST[:PORT]     MQTT broker (default localhost:1883)\n"
+                  << "  --base-topic TOPIC       Station base topic (default NN/Nybrovej/InnoLab)\n"
+                  << "  --stations N             Virtual stations, one connection each (default 100)\n"
+                  << "  --name-prefix NAME       Station names are NAME001, NAME002, ... (default VirtualStation)\n"
+                  << "  --commands A,B           Commands on <station>/CMD/<A>, at most 4 (default Process)\n"
+                  << "  --command-ms MS          Simulated process time of every command (default 200)\n"
+                  << "  --failure-rate P         Fraction of commands answering FAILURE (default 0)\n"
+                  << "  --drive                  Also act as the controller: Occupy, commands, Release\n"
+                  << "  --occupants N            Concurrent occupants per station when driving (default 1)\n"
+                  << "  --duration S             Run time, 0 = until interrupted (default 60)\n"
+                  << "  --timeout-ms MS          Driven steps unanswered this long count as stalled (default 10000)\n"
+                  << "  --output PATH            JSON results (default - for stdout)\n"
+                  << "  --verbose                Print the stations' serial log\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    FleetOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--broker")
+            {
+                std::string broker = next();
+                size_t colon = broker.rfind(':');
+                options.host = broker.substr(0, colon);
+                if (colon != std::string::npos)
+                    options.port = (uint16_t)std::stoul(broker.substr(colon + 1));
+            }
+            else if (arg == "--base-topic")
+                options.baseTopic = next();
+            else if (arg == "--stations")
+                options.stations = std::stoul(next());
+            else if (arg == "--name-prefix")
+                options.namePrefix = next();
+            else if (arg == "--commands")
+                options.commands = splitList(next());
+            else if (arg == "--command-ms")
+                options.commandMs = (uint32_t)std::stoul(next());
+            else if (arg == "--failure-rate")
+                options.failureRate = std::stod(next());
+            else if (arg == "--drive")
+                options.drive = true;
+            else if (arg == "--occupants")
+                options.occupants = std::stoul(next());
+            else if (arg == "--duration")
+                options.durationS = (uint32_t)std::stoul(next());
+            else if (arg == "--timeout-ms")
+                options.timeoutMs = (uint32_t)std::stoul(next());
+            else if (arg == "--output")
+                options.output = next();
+            else if (arg == "--verbose")
+                options.verbose = true;
+            else
+            {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Invalid argument " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.stations == 0 || options.commands.empty() || options.commands.size() > MAX_COMMANDS)
+    {
+        std::cerr << "Need at least one station and 1 to " << MAX_COMMANDS << " commands" << std::endl;
+        return 1;
+    }
+    if (options.occupants == 0 || options.occupants > OccupancyQueue::CAPACITY)
+    {
+        std::cerr << "Occupants per station must be 1 to " << OccupancyQueue::CAPACITY << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    return runFleet(options);
+}
@@ -0,0 +1,249 @@
+// Runs one PackMLStateMachine in-process, without a broker, through Occupy / command /
+// Release cycles at a given queue depth and reports the station-side cost of each step
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <AsyncMqttClient.h>
+#include "PackMLStateMachine.h"
+#include "bench_report.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct BenchOptions
+    {
+        size_t cycles = 10000;
+        size_t depth = 1; // Occupants taking turns at the head of the queue
+        uint32_t commandMs = 0;
+        std::string output = "-";
+    };
+
+    const String BASE_TOPIC = "Bench";
+    const String MODULE_NAME = "Station";
+    const String TOPIC_SUB_PROCESS_CMD = "/CMD/Process";
+    const String TOPIC_PUB_PROCESS_DATA = "/DATA/Process";
+
+    std::atomic<uint32_t> commandMs{0};
+
+    bool benchProcess()
+    {
+        if (commandMs.load() > 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(commandMs.load()));
+        }
+        return true;
+    }
+
+    uint64_t elapsedUs(Clock::time_point from, Clock::time_point to)
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+
+    // Answers the worker publishes for the command, handed to the benchmark thread
+    class CompletionWaiter
+    {
+    public:
+        void complete(bool success)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done = true;
+                succeeded = success;
+            }
+            cv.notify_one();
+        }
+
+        bool wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]
+                    { return done; });
+            done = false;
+            return succeeded;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        bool succeeded = false;
+    };
+
+    // Parses like ESP32Module::dispatchMessage, so each step includes the station's JSON cost
+    void deliver(PackMLStateMachine &machine, const std::string &topic, const std::string &uuid)
+    {
+        PayloadBuffer<128> payload;
+        payload.append("{\"Uuid\":").appendJsonString(uuid.c_str()).append("}");
+        JsonDocument message;
+        deserializeJson(message, payload.c_str(), payload.size());
+        machine.handleMessage(topic.c_str(), message);
+    }
+
+    int runBench(const BenchOptions &options)
+    {
+        Serial.setEnabled(false);
+        commandMs.store(options.commandMs);
+
+        std::string base = std::string(BASE_TOPIC.c_str()) + "/" + MODULE_NAME.c_str();
+        std::string occupyTopic = base + "/CMD/Occupy";
+        std::string releaseTopic = base + "/CMD/Release";
+        std::string processTopic = base + TOPIC_SUB_PROCESS_CMD.c_str();
+        std::string processDataTopic = base + TOPIC_PUB_PROCESS_DATA.c_str();
+        std::string occupyDataTopic = base + "/DATA/Occupy";
+        std::string releaseDataTopic = base + "/DATA/Release";
+
+        CompletionWaiter waiter;
+        std::atomic<uint64_t> publishes{0};
+        std::atomic<uint64_t> rejected{0}; // Occupy or Release answered FAILURE
+        AsyncMqttClient client;
+        client.setLoopback([&](const char *topic, const char *payload, size_t)
+                           {
+                               publishes.fetch_add(1, std::memory_order_relaxed);
+                               if (processDataTopic == topic && !strstr(payload, "\"State\":\"RUNNING\""))
+                               {
+                                   waiter.complete(strstr(payload, "\"State\":\"SUCCESS\"") != nullptr);
+                               }
+                               else if ((occupyDataTopic == topic || releaseDataTopic == topic) &&
+                                        strstr(payload, "\"State\":\"FAILURE\""))
+                               {
+                                   rejected.fetch_add(1, std::memory_order_relaxed);
+                               }
+                           });
+
+        // Never destroyed: its worker task runs until the process exits
+        PackMLStateMachine *machine = new PackMLStateMachine(BASE_TOPIC, MODULE_NAME, &client);
+        machine->registerCommandHandler(
+            TOPIC_SUB_PROCESS_CMD,
+            TOPIC_PUB_PROCESS_DATA,
+            [](PackMLStateMachine *sm, const JsonDocument &msg)
+            {
+                sm->enqueueCommand(msg, TOPIC_PUB_PROCESS_DATA, benchProcess);
+            });
+        machine->subscribeToTopics();
+
+        std::deque<std::string> order;
+        for (size_t i = 0; i < options.depth; i++)
+        {
+            order.push_back("bench-" + std::to_string(i));
+            deliver(*machine, occupyTopic, order.back());
+        }
+
+        LatencySamples commandLatency;
+        LatencySamples releaseLatency;
+        LatencySamples occupyLatency;
+        LatencySamples cycleLatency;
+        uint64_t failures = 0;
+        uint64_t basePublishes = publishes.load();
+
+        auto start = Clock::now();
+        for (size_t cycle = 0; cycle < options.cycles; cycle++)
+        {
+            std::string head = order.front();
+            order.pop_front();
+
+            auto commandStart = Clock::now();
+            deliver(*machine, processTopic, head);
+            if (!waiter.wait())
+            {
+                failures++;
+            }
+            auto releaseStart = Clock::now();
+            deliver(*machine, releaseTopic, head);
+            // Back in line behind the others, or straight to the head of an empty queue
+            auto occupyStart = Clock::now();
+            deliver(*machine, occupyTopic, head);
+            auto end = Clock::now();
+            order.push_back(head);
+
+            commandLatency.add(elapsedUs(commandStart, releaseStart));
+            releaseLatency.add(elapsedUs(releaseStart, occupyStart));
+            occupyLatency.add(elapsedUs(occupyStart, end));
+            cycleLatency.add(elapsedUs(commandStart, end));
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        JsonDocument report;
+        report["Benchmark"] = "station_queue";
+        report["TimeStamp"] = reportTimestamp();
+        JsonObject settings = report["Options"].to<JsonObject>();
+        settings["Cycles"] = options.cycles;
+        settings["Depth"] = options.depth;
+        settings["CommandMs"] = options.commandMs;
+        report["ElapsedMs"] = elapsedMs;
+        report["CyclesPerSecond"] = elapsedMs > 0 ? options.cycles * 1000.0 / elapsedMs : 0.0;
+        report["PublishesPerCycle"] = options.cycles ? (double)(publishes.load() - basePublishes) / options.cycles : 0.0;
+        report["Failures"] = failures;
+        report["Rejected"] = rejected.load();
+        report["FinalState"] = PackMLStateMachine::stateToString(machine->getState());
+        JsonObject latency = report["Latency"].to<JsonObject>();
+        commandLatency.summarize(latency["Command"].to<JsonObject>());
+        releaseLatency.summarize(latency["Release"].to<JsonObject>());
+        occupyLatency.summarize(latency["Occupy"].to<JsonObject>());
+        cycleLatency.summarize(latency["Cycle"].to<JsonObject>());
+        return writeReport(report, options.output);
+    }
+
+    void printUsage(const char *program)
+    {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --cycles N               Occupy/command/Release cycles (default 10000)\n"
+                  << "  --depth N                Occupants taking turns in the queue (default 1)\n"
+                  << "  --command-ms MS          Simulated process time (default 0)\n"
+                  << "  --output PATH            JSON results (default - for stdout)\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try
+        {
+            if (arg == "--cycles")
+                options.cycles = std::stoul(next());
+            else if (arg == "--depth")
+                options.depth = std::stoul(next());
+            else if (arg == "--command-ms")
+                options.commandMs = (uint32_t)std::stoul(next());
+            else if (arg == "--output")
+                options.output = next();
+            else
+            {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Invalid argument " << arg << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.depth == 0 || options.depth > OccupancyQueue::CAPACITY)
+    {
+        std::cerr << "Depth must be 1 to " << OccupancyQueue::CAPACITY << std::endl;
+        return 1;
+    }
+    return runBench(options);
+}
@@ -1,5 +1,6 @@
 #include "ESP32Module.h"
 #include "PackMLStateMachine.h"
+#include "TaskLayout.h"
 #include <FS.h>
 #include <esp_task_wdt.h>
 
@@ -11,7 +12,12 @@ ESP32Module::ESP32Module()
       config(),
       baseTopic(""),
       initialized(false),
-      configFilePath("/config.yaml")
+      configFilePath("/config.yaml"),
+      reassemblyReceived(0),
+      reassemblyDiscard(false),
+      configPublishSlots(nullptr),
+      configStreaming(false),
+      configPacketCount(0)
 {
 }
 
@@ -38,6 +44,11 @@ void ESP32Module::setup(const String &topic, const String &name, unsigned long b
     
     baseTopic = topic;
     moduleName = name;
+
+    Serial.print("Task layout: network on core ");
+    Serial.print(NETWORK_CORE);
+    Serial.print(", actuation on core ");
+    Serial.println(ACTUATION_CORE);
     
     Serial.println("Step 1: Initializing WiFi...");
     Serial.flush();
@@ -116,11 +127,10 @@ void ESP32Module::initMQTT()
                                 this->onMqttDisconnect(reason); 
                             });
     mqttClient.onMessage([this](char *topic, char *payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total)
-                         { 
-                             Serial.println("[CALLBACK] onMessage triggered!");
-                             Serial.flush();
-                             this->onMqttMessage(topic, payload, properties, len, index, total); 
-                         });
+                         { this->onMqttMessage(topic, payload, properties, len, index, total); });
+    mqttClient.onPublish([this](uint16_t packetId)
+                         { this->onMqttPublish(packetId); });
+    configPublishSlots = xSemaphoreCreateCounting(CONFIG_PUBLISH_WINDOW, CONFIG_PUBLISH_WINDOW);
 
     // Set server and credentials
     Serial.println("Setting MQTT server...");
@@ -182,30 +192,105 @@ void ESP32Module::initializeTime()
 
 void ESP32Module::publishDescriptionFromFile()
 {
-    String content = readConfig(configFilePath);
-    if (content.length() == 0)
+    if (!mountFilesystem())
+    {
+        return;
+    }
+    File file;
+    if (LittleFS.exists(configFilePath))
+    {
+        file = LittleFS.open(configFilePath, FILE_READ);
+    }
+    if (!file)
     {
         Serial.println("No YAML config found to publish");
         return;
     }
 
-    Serial.print("Publishing YAML config (");
-    Serial.print(content.length());
-    Serial.println(" bytes)");
-
-    // Wait briefly to ensure MQTT connection is stable
-    delay(500);
+    // First pass: size and hash, so the header can go out ahead of the content
+    char chunk[CONFIG_CHUNK_SIZE];
+    uint32_t hash = 2166136261u; // FNV-1a
+    size_t size = 0;
+    size_t n;
+    while ((n = file.read((uint8_t *)chunk, sizeof(chunk))) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            hash ^= (uint8_t)chunk[i];
+            hash *= 16777619u;
+        }
+        size += n;
+    }
+    if (size == 0)
+    {
+        Serial.println("No YAML config found to publish");
+        file.close();
+        return;
+    }
+    size_t chunks = (size + CONFIG_CHUNK_SIZE - 1) / CONFIG_CHUNK_SIZE;
     esp_task_wdt_reset();
 
-    // Publish to the Config topic for YAML-based registration
-    String fullTopic = baseTopic + "/Registration/Config";
+    // Publish as soon as the broker connection is up
+    unsigned long waitStart = millis();
+    while (!mqttClient.connected() && millis() - waitStart < CONFIG_CONNECT_TIMEOUT_MS)
+    {
+        delay(50);
+        esp_task_wdt_reset();
+    }
+    if (!mqttClient.connected())
+    {
+        Serial.println("Failed to publish YAML config: MQTT not connected");
+        file.close();
+        return;
+    }
+
+    String streamTopic = baseTopic + "/Registration/Config/" + moduleName;
+    char header[96];
+    int headerLen = snprintf(header, sizeof(header), "{\"Hash\":\"%08lx\",\"Size\":%u,\"Chunks\":%u}",
+                             (unsigned long)hash, (unsigned int)size, (unsigned int)chunks);
+
+    Serial.print("Publishing YAML config (");
+    Serial.print(size);
+    Serial.print(" bytes, ");
+    Serial.print(chunks);
+    Serial.print(" chunks, hash ");
+    Serial.print(hash, HEX);
+    Serial.println(")");
+
+    configStreaming = true;
+    bool published = publishConfigPart((streamTopic + "/Header").c_str(), header, headerLen);
+
+    // Second pass: stream the file
+    file.seek(0);
+    for (size_t index = 0; published && index < chunks; index++)
+    {
+        n = file.read((uint8_t *)chunk, sizeof(chunk));
+        if (n == 0)
+        {
+            published = false;
+            break;
+        }
+        published = publishConfigPart((streamTopic + "/Chunk/" + String(index)).c_str(), chunk, n);
+        esp_task_wdt_reset();
+    }
+    file.close();
 
-    // AsyncMqttClient can handle large payloads without QoS issues
-    uint16_t packetId = mqttClient.publish(fullTopic.c_str(), 2, false, content.c_str(), content.length());
+    // Wait for the last PUBACKs, so the window is free for a later publish
+    UBaseType_t drained = 0;
+    while (drained < CONFIG_PUBLISH_WINDOW &&
+           xSemaphoreTake(configPublishSlots, pdMS_TO_TICKS(CONFIG_ACK_TIMEOUT_MS)) == pdTRUE)
+    {
+        drained++;
+    }
+    configStreaming = false;
+    for (UBaseType_t i = 0; i < CONFIG_PUBLISH_WINDOW; i++)
+    {
+        xSemaphoreGive(configPublishSlots);
+    }
 
-    if (packetId > 0)
+    if (published && drained == CONFIG_PUBLISH_WINDOW)
     {
-        Serial.println("Published YAML config to " + fullTopic);
+        Serial.println("Published YAML config to " + streamTopic);
     }
     else
     {
@@ -213,26 +298,56 @@ void ESP32Module::publishDescriptionFromFile()
     }
 }
 
-String ESP32Module::readConfig(const char *path)
+bool ESP32Module::publishConfigPart(const char *topic, const char *payload, size_t len)
+{
+    if (xSemaphoreTake(configPublishSlots, pdMS_TO_TICKS(CONFIG_ACK_TIMEOUT_MS)) != pdTRUE)
+    {
+        Serial.println("❌ Config publish: no PUBACK from broker");
+        return false;
+    }
+
+    uint16_t packetId = CONFIG_PACKET_ID_BASE + configPacketCount % (0xFFFF - CONFIG_PACKET_ID_BASE);
+    configPacketCount++;
+    if (mqttClient.publish(topic, 1, false, payload, len, false, packetId) == 0)
+    {
+        xSemaphoreGive(configPublishSlots);
+        Serial.print("❌ Config publish failed on topic: ");
+        Serial.println(topic);
+        return false;
+    }
+    return true;
+}
+
+void ESP32Module::onMqttPublish(uint16_t packetId)
 {
+    if (configStreaming && packetId >= CONFIG_PACKET_ID_BASE)
+    {
+        xSemaphoreGive(configPublishSlots);
+    }
+}
 
+bool ESP32Module::mountFilesystem()
+{
     // Mount LittleFS to allow storing large JSON files persistently
-    if (!LittleFS.begin())
+    if (LittleFS.begin())
     {
-        Serial.println("LittleFS mount failed - attempting to format...");
-        if (LittleFS.format() && LittleFS.begin())
-        {
-            Serial.println("LittleFS mounted after format");
-        }
-        else
-        {
-            Serial.println("LittleFS mount failed even after format");
-            return String("");
-        }
+        return true;
     }
-    else
+    Serial.println("LittleFS mount failed - attempting to format...");
+    if (LittleFS.format() && LittleFS.begin())
     {
-        Serial.println("LittleFS mounted");
+        Serial.println("LittleFS mounted after format");
+        return true;
+    }
+    Serial.println("LittleFS mount failed even after format");
+    return false;
+}
+
+String ESP32Module::readConfig(const char *path)
+{
+    if (!mountFilesystem())
+    {
+        return String("");
     }
 
     // Find AAS Description
@@ -303,47 +418,86 @@ void ESP32Module::onMqttDisconnect(AsyncMqttClientDisconnectReason reason)
 
 void ESP32Module::onMqttMessage(char *topic, char *payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total)
 {
-    // Debug: Print received message info
-    Serial.print("📨 MQTT Message received on topic: ");
-    Serial.println(topic);
-    Serial.print("   Payload length: ");
-    Serial.println(len);
+    STATION_VLOG("📨 MQTT Message received on topic: ");
+    STATION_VLOGLN(topic);
+    STATION_VLOG("   Payload length: ");
+    STATION_VLOGLN(len);
+
+    // Common case: the whole message in one callback, parsed straight from the client's buffer
+    if (index == 0 && len == total)
+    {
+        dispatchMessage(topic, payload, len);
+        return;
+    }
+
+    // Fragmented message: collect the parts, then parse once complete
+    if (index == 0)
+    {
+        reassemblyReceived = 0;
+        reassemblyDiscard = total > MQTT_REASSEMBLY_BUFFER_SIZE;
+        if (reassemblyDiscard)
+        {
+            Serial.print("❌ MQTT message too large for reassembly buffer (");
+            Serial.print(total);
+            Serial.print(" bytes) on topic: ");
+            Serial.println(topic);
+        }
+    }
+    if (reassemblyDiscard)
+    {
+        return;
+    }
+    if (index != reassemblyReceived || index + len > MQTT_REASSEMBLY_BUFFER_SIZE)
+    {
+        Serial.println("❌ MQTT message fragment out of order, dropping message");
+        reassemblyDiscard = true;
+        return;
+    }
 
-    // Convert topic and payload to strings
-    String topicStr = String(topic);
-    String message;
-    message.reserve(len);
-    for (size_t i = 0; i < len; i++)
+    memcpy(reassemblyBuffer + index, payload, len);
+    reassemblyReceived = index + len;
+    if (reassemblyReceived == total)
     {
-        message += (char)payload[i];
+        dispatchMessage(topic, reassemblyBuffer, total);
+        reassemblyReceived = 0;
     }
+}
 
+void ESP32Module::dispatchMessage(const char *topic, const char *payload, size_t len)
+{
+#if STATION_VERBOSE_LOG
     Serial.print("   Payload: ");
-    Serial.println(message);
+    Serial.write((const uint8_t *)payload, len);
+    Serial.println();
+#endif
 
-    // Parse JSON message
+    // Parse directly from the payload bytes (no intermediate String copy). Commands on topics
+    // the AAS declares as application/msgpack arrive as a MessagePack map, never as '{'
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, message);
+    uint8_t first = len > 0 ? (uint8_t)payload[0] : 0;
+    bool msgpack = (first & 0xF0) == 0x80 || first == 0xDE || first == 0xDF;
+    DeserializationError error = msgpack ? deserializeMsgPack(doc, payload, len)
+                                         : deserializeJson(doc, payload, len);
 
     if (error)
     {
-        Serial.print("❌ JSON parse error: ");
+        Serial.print(msgpack ? "❌ MessagePack parse error: " : "❌ JSON parse error: ");
         Serial.println(error.c_str());
         return;
     }
 
     // Extract and store command UUID
-    if (doc["Uuid"].is<String>())
+    if (doc["Uuid"].is<const char *>())
     {
-        commandUuid = doc["Uuid"].as<String>();
-        Serial.print("   UUID: ");
-        Serial.println(commandUuid);
+        commandUuid = doc["Uuid"].as<const char *>();
+        STATION_VLOG("   UUID: ");
+        STATION_VLOGLN(commandUuid);
     }
 
     // Route message to PackML state machine
     if (stateMachine)
     {
-        stateMachine->handleMessage(topicStr, doc);
+        stateMachine->handleMessage(topic, doc);
     }
     else
     {
@@ -356,7 +510,7 @@ AsyncMqttClient &ESP32Module::getMqttClient()
     return mqttClient;
 }
 
-String ESP32Module::getCommandUuid()
+const String &ESP32Module::getCommandUuid() const
 {
     return commandUuid;
 }
@@ -1,7 +1,9 @@
 #include "FillingModule.h"
 #include "ESP32Module.h"
 #include "PackMLStateMachine.h"
+#include "MotionSequencer.h"
 #include <esp_task_wdt.h>
+#include <sys/time.h>
 
 // MQTT topic definitions
 const String baseTopic = "NN/Nybrovej/InnoLab";
@@ -13,10 +15,19 @@ const String FillingModule::TOPIC_PUB_NEEDLE_DATA = "/DATA/Needle";
 const String FillingModule::TOPIC_SUB_TARE_CMD = "/CMD/Tare";
 const String FillingModule::TOPIC_PUB_TARE_DATA = "/DATA/Tare";
 const String FillingModule::TOPIC_PUB_WEIGHT = "/DATA/Weight";
+const String FillingModule::TOPIC_PUB_WEIGHT_STREAM = "/DATA/WeightStream";
 
 // Static member initialization
 ESP32Module *FillingModule::esp32Module = nullptr;
 PackMLStateMachine *FillingModule::stateMachine = nullptr;
+TopicBuffer FillingModule::weightTopic;
+TopicBuffer FillingModule::weightStreamTopic;
+volatile float FillingModule::fillTargetWeight = 0.0f;
+volatile uint32_t FillingModule::fillStartMs = 0;
+int32_t FillingModule::weightRing[FillingModule::WEIGHT_RING_CAPACITY];
+size_t FillingModule::weightRingHead = 0;
+size_t FillingModule::weightRingCount = 0;
+int64_t FillingModule::weightRingStartMs = 0;
 
 void FillingModule::setup(ESP32Module *moduleInstance)
 {
@@ -25,6 +36,10 @@ void FillingModule::setup(ESP32Module *moduleInstance)
     // Initialize ESP32 (WiFi, MQTT, Time) first to get valid MQTT client
     esp32Module->setup(baseTopic, moduleName);
 
+    // Weight samples are published often; build the topic once
+    weightTopic.appendf("%s/%s%s", baseTopic.c_str(), moduleName.c_str(), TOPIC_PUB_WEIGHT.c_str());
+    weightStreamTopic.appendf("%s/%s%s", baseTopic.c_str(), moduleName.c_str(), TOPIC_PUB_WEIGHT_STREAM.c_str());
+
     // Initialize filling hardware
     initHardware();
 
@@ -40,7 +55,7 @@ void FillingModule::setup(ESP32Module *moduleInstance)
         TOPIC_PUB_FILLING_DATA,
         [](PackMLStateMachine *sm, const JsonDocument &msg)
         {
-            sm->executeCommand(msg, TOPIC_PUB_FILLING_DATA, runFillingCycle);
+            sm->executeSequence(msg, TOPIC_PUB_FILLING_DATA, NEEDLE_TRACK, buildFillingCycle);
         });
 
     stateMachine->registerCommandHandler(
@@ -48,7 +63,7 @@ void FillingModule::setup(ESP32Module *moduleInstance)
         TOPIC_PUB_NEEDLE_DATA,
         [](PackMLStateMachine *sm, const JsonDocument &msg)
         {
-            sm->executeCommand(msg, TOPIC_PUB_NEEDLE_DATA, attachNeedle);
+            sm->executeSequence(msg, TOPIC_PUB_NEEDLE_DATA, NEEDLE_TRACK, buildAttachNeedle);
         });
 
     stateMachine->registerCommandHandler(
@@ -56,13 +71,16 @@ void FillingModule::setup(ESP32Module *moduleInstance)
         TOPIC_PUB_TARE_DATA,
         [](PackMLStateMachine *sm, const JsonDocument &msg)
         {
-            sm->executeCommand(msg, TOPIC_PUB_TARE_DATA, tareScale);
+            // The scale has its own track, so taring overlaps needle movement
+            sm->executeSequence(msg, TOPIC_PUB_TARE_DATA, SCALE_TRACK, buildTareScale);
         });
 
     // Subscribe to MQTT topics now that state machine is fully configured
     stateMachine->subscribeToTopics();
     stateMachine->publishState();
 
+    startWeightStream();
+
     Serial.println("Filling Module ready!\n");
 }
 
@@ -87,67 +105,68 @@ void FillingModule::initHardware()
     Serial.println("Filling hardware initialized");
 }
 
-bool FillingModule::moveToTop()
+void FillingModule::appendMoveToTop(MotionSequence &sequence)
 {
-    Serial.println("Moving to top position");
-    Serial.print("  Top button state at start: ");
-    Serial.println(digitalRead(BUTTON_PIN_TOP) == HIGH ? "HIGH (Pressed)" : "LOW (pressed)");
-
-    // Move up with boost
-    digitalWrite(PIN_IN3, HIGH);
-    digitalWrite(PIN_IN4, LOW);
-    analogWrite(PIN_ENB, MOTOR_SPEED + MOTOR_SPEED_BOOST);
+    // Up with boost, cruise until the top switch, then a brief reverse with boost to stop smoothly
+    sequence.then(startMoveUp, 200)
+        .until(BUTTON_PIN_TOP, HIGH, MOTION_TIMEOUT, cruise)
+        .then(brakeFromUp, 100)
+        .then(stopMotor);
+}
 
-    delay(200);
-    analogWrite(PIN_ENB, MOTOR_SPEED);
+void FillingModule::appendMoveToBottom(MotionSequence &sequence)
+{
+    sequence.then(startMoveDown, 200)
+        .until(BUTTON_PIN_BOTTOM, HIGH, MOTION_TIMEOUT, cruise)
+        .then(brakeFromDown, 100)
+        .then(stopMotor);
+}
 
-    // Wait for top button
-    bool success = waitForButton(BUTTON_PIN_TOP, MOTION_TIMEOUT);
+bool FillingModule::moveToTop()
+{
+    MotionSequence sequence;
+    appendMoveToTop(sequence);
+    sequence.onFailure(stopMotor);
+    bool success = MotionSequencer::run(NEEDLE_TRACK, sequence);
     if (!success)
     {
         Serial.println("Motion Error: Move to top timeout");
     }
+    return success;
+}
 
-    // Brief reverse with boost to stop smoothly
+void FillingModule::startMoveUp()
+{
+    Serial.println("Moving to top position");
+    digitalWrite(PIN_IN3, HIGH);
+    digitalWrite(PIN_IN4, LOW);
     analogWrite(PIN_ENB, MOTOR_SPEED + MOTOR_SPEED_BOOST);
-    digitalWrite(PIN_IN3, LOW);
-    digitalWrite(PIN_IN4, HIGH);
-    delay(100);
-    analogWrite(PIN_ENB, MOTOR_SPEED);
-    // Stop motor
-    stopMotor();
-
-    return success;
 }
 
-bool FillingModule::moveToBottom()
+void FillingModule::startMoveDown()
 {
     Serial.println("Moving to bottom position");
-    Serial.print("  Bottom button state at start: ");
-    Serial.println(digitalRead(BUTTON_PIN_BOTTOM) == HIGH ? "HIGH (not pressed)" : "LOW (pressed)");
-
-    // Move down with boost
     digitalWrite(PIN_IN3, LOW);
     digitalWrite(PIN_IN4, HIGH);
     analogWrite(PIN_ENB, MOTOR_SPEED + MOTOR_SPEED_BOOST);
+}
 
-    delay(200);
+void FillingModule::cruise()
+{
     analogWrite(PIN_ENB, MOTOR_SPEED);
+}
 
-    // Wait for bottom button
-    bool success = waitForButton(BUTTON_PIN_BOTTOM, MOTION_TIMEOUT);
-    if (!success)
-    {
-        Serial.println("Motion Error: Move to bottom timeout");
-    }
+void FillingModule::brakeFromUp()
+{
+    analogWrite(PIN_ENB, MOTOR_SPEED + MOTOR_SPEED_BOOST);
+    digitalWrite(PIN_IN3, LOW);
+    digitalWrite(PIN_IN4, HIGH);
+}
 
+void FillingModule::brakeFromDown()
+{
     digitalWrite(PIN_IN3, HIGH);
     digitalWrite(PIN_IN4, LOW);
-    delay(100);
-    // Stop motor
-    stopMotor();
-
-    return success;
 }
 
 void FillingModule::stopMotor()
@@ -157,130 +176,179 @@ void FillingModule::stopMotor()
     analogWrite(PIN_ENB, 0);
 }
 
-bool FillingModule::waitForButton(int buttonPin, unsigned long timeoutMs)
+void FillingModule::buildFillingCycle(MotionSequence &sequence)
 {
-    unsigned long startTime = millis();
-    Serial.print("  Waiting for button on pin ");
-    Serial.print(buttonPin);
-    Serial.print(", current state: ");
-    Serial.println(digitalRead(buttonPin) == 0 ? "Not pressed" : "Pressed");
-
-    // Button will read HIGH when physically pressed
-    while (digitalRead(buttonPin) == LOW)
-    {
-        if (millis() - startTime >= timeoutMs)
-        {
-            Serial.println("  Button wait TIMEOUT");
-            return false; // Timeout
-        }
-        //delay(5); // Sample the endswitch at 200Hz
-    }
+    Serial.println("Starting filling cycle");
 
-    Serial.print("  Button pressed after ");
-    Serial.print(millis() - startTime);
-    Serial.println(" ms");
-    return true; // Button pressed
+    // Down to the fill position, dwell while filling, back up to the stop position
+    appendMoveToBottom(sequence);
+    sequence.then(startFill, FILL_DURATION_MS);
+    appendMoveToTop(sequence);
+    sequence.then(publishFilledWeight).onFailure(stopMotor);
 }
 
-bool FillingModule::runFillingCycle()
+void FillingModule::startFill()
 {
-    Serial.println("Starting filling cycle");
-
-    // Move down to fill position
-    if (!moveToBottom())
-    {
-        Serial.println("Filling cycle failed: Motion error during move to bottom");
-        return false;
-    }
-
-    // Wait at bottom (simulating filling)
-    delay(1000);
-
-    // Move back up to stop position
-    if (!moveToTop())
-    {
-        Serial.println("Filling cycle failed: Motion error during move to top");
-        return false;
-    }
+    // Random fill weight (1.8 - 2.2 g), reached at the end of the dwell
+    fillStartMs = millis();
+    fillTargetWeight = random(1800, 2200) / 1000.0f;
+}
 
-    // Generate and publish random weight (1.8 - 2.2 g)
-    long weightInt = random(1800, 2200);
-    float weight = weightInt / 1000.0;
-    publishWeight(weight);
+void FillingModule::publishFilledWeight()
+{
+    publishWeight(readWeight());
 
     Serial.println("Filling cycle completed successfully");
-    return true;
 }
 
-void FillingModule::attachNeedle()
+void FillingModule::buildAttachNeedle(MotionSequence &sequence)
 {
     Serial.println("Attaching needle");
 
-    // Move down to attachment position
+    // Down to the attachment position, then a brief reverse to stop smoothly
+    sequence.until(BUTTON_PIN_BOTTOM, HIGH, MOTION_TIMEOUT, startAttachMove)
+        .then(brakeFromDown, 100)
+        .then(stopMotor)
+        .onFailure(stopMotor);
+}
+
+void FillingModule::startAttachMove()
+{
     digitalWrite(PIN_IN3, LOW);
     digitalWrite(PIN_IN4, HIGH);
     analogWrite(PIN_ENB, MOTOR_SPEED);
-
-    if (!waitForButton(BUTTON_PIN_BOTTOM, MOTION_TIMEOUT))
-    {
-        Serial.println("Motion Error: Needle attachment timeout");
-    }
-
-    // Brief reverse to stop smoothly
-    digitalWrite(PIN_IN3, HIGH);
-    digitalWrite(PIN_IN4, LOW);
-    delay(100);
-
-    // Stop motor
-    stopMotor();
-
-    Serial.println("Needle attached");
 }
 
-void FillingModule::tareScale()
+void FillingModule::buildTareScale(MotionSequence &sequence)
 {
     Serial.println("Taring scale");
 
-    // Simulate tare operation
-    delay(2000);
-
-    // Publish zero weight
-    publishWeight(0.0);
+    // Simulate tare operation, then publish zero weight
+    sequence.then(nullptr, 2000).then(publishTare);
+}
 
+void FillingModule::publishTare()
+{
+    fillTargetWeight = 0.0f;
+    publishWeight(readWeight());
     Serial.println("Scale tared");
 }
 
 void FillingModule::publishWeight(double weight)
 {
     AsyncMqttClient &client = esp32Module->getMqttClient();
-    String commandUuid = esp32Module->getCommandUuid();
 
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
+    // Stack buffer and precomputed topic: no heap allocation per sample
+    PayloadBuffer<256> output;
+    output.appendf("{\"Weight\":%.3f,\"TimeStamp\":", weight);
+    output.appendJsonTimestamp();
+    output.append(",\"Uuid\":").appendJsonString(esp32Module->getCommandUuid().c_str()).append("}");
+
+    if (output.overflowed())
     {
-        Serial.println("⚠️ Error getting time for weight publication");
+        Serial.println("⚠️ Weight payload truncated, not published");
         return;
     }
+    client.publish(weightTopic.c_str(), 2, true, output.c_str(), output.size());
 
-    // Format timestamp as ISO 8601
-    char timestamp[30];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &timeinfo);
-    String isoTimestamp = String(timestamp) + ".000Z";
+    Serial.print("⚖️  Published weight: ");
+    Serial.print(weight);
+    Serial.println(" g");
+}
 
-    // Create JSON document
-    JsonDocument doc;
-    doc["Weight"] = weight;
-    doc["TimeStamp"] = isoTimestamp;
-    doc["Uuid"] = commandUuid;
+double FillingModule::readWeight()
+{
+    float target = fillTargetWeight;
+    uint32_t elapsed = millis() - fillStartMs;
+    if (elapsed >= FILL_DURATION_MS)
+    {
+        return target;
+    }
+    return target * elapsed / FILL_DURATION_MS;
+}
 
-    // Serialize and publish
-    char output[256];
-    size_t len = serializeJson(doc, output);
+void FillingModule::startWeightStream()
+{
+#if WEIGHT_STREAM_INTERVAL_MS > 0
+    xTaskCreatePinnedToCore(weightStreamTask, "WeightStream", WEIGHT_STREAM_STACK_SIZE, nullptr, SENSING_TASK_PRIORITY,
+                            nullptr, ACTUATION_CORE);
+    Serial.print("Weight streaming every ");
+    Serial.print(WEIGHT_STREAM_INTERVAL_MS);
+    Serial.print(" ms to ");
+    Serial.println(weightStreamTopic.c_str());
+#endif
+}
 
-    String fullTopic = baseTopic + "/" + moduleName + TOPIC_PUB_WEIGHT;
-    client.publish(fullTopic.c_str(), 2, true, output, len);
+void FillingModule::weightStreamTask(void *parameter)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        // Fixed-rate sampling independent of how long publishing takes
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(WEIGHT_STREAM_INTERVAL_MS));
 
-    Serial.print("⚖️  Published weight: ");
-    Serial.print(weight);
-    Serial.println(" g");
+        int32_t sampleMg = (int32_t)lround(readWeight() * 1000.0);
+        if (weightRingCount == 0)
+        {
+            struct timeval now;
+            gettimeofday(&now, nullptr);
+            weightRingStartMs = (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+        }
+        if (weightRingCount == WEIGHT_RING_CAPACITY)
+        {
+            // Full while disconnected: drop the oldest sample
+            weightRingHead = (weightRingHead + 1) % WEIGHT_RING_CAPACITY;
+            weightRingCount--;
+            weightRingStartMs += WEIGHT_STREAM_INTERVAL_MS;
+        }
+        weightRing[(weightRingHead + weightRingCount) % WEIGHT_RING_CAPACITY] = sampleMg;
+        weightRingCount++;
+
+        while (weightRingCount >= WEIGHT_STREAM_FRAME_SAMPLES && publishWeightFrame())
+        {
+        }
+    }
+}
+
+bool FillingModule::publishWeightFrame()
+{
+    AsyncMqttClient &client = esp32Module->getMqttClient();
+    if (!client.connected())
+    {
+        return false;
+    }
+
+    size_t frameSamples = weightRingCount < WEIGHT_STREAM_FRAME_SAMPLES ? weightRingCount : WEIGHT_STREAM_FRAME_SAMPLES;
+    if (frameSamples == 0)
+    {
+        return false;
+    }
+
+    // {"StartTime":<epoch ms>,"IntervalMs":20,"Unit":"mg","First":1834,"Deltas":[2,-1,...]}
+    PayloadBuffer<512> output;
+    output.appendf("{\"StartTime\":%lld,\"IntervalMs\":%d,\"Unit\":\"mg\",\"First\":%ld,\"Deltas\":[",
+                   (long long)weightRingStartMs, WEIGHT_STREAM_INTERVAL_MS, (long)weightRing[weightRingHead]);
+    int32_t previous = weightRing[weightRingHead];
+    for (size_t i = 1; i < frameSamples; i++)
+    {
+        int32_t sample = weightRing[(weightRingHead + i) % WEIGHT_RING_CAPACITY];
+        output.appendf(i > 1 ? ",%ld" : "%ld", (long)(sample - previous));
+        previous = sample;
+    }
+    output.append("]}");
+
+    if (output.overflowed())
+    {
+        Serial.println("⚠️ Weight stream frame truncated, dropping it");
+    }
+    else if (client.publish(weightStreamTopic.c_str(), 0, false, output.c_str(), output.size()) == 0)
+    {
+        // Not queued by the client; keep the samples for the next attempt
+        return false;
+    }
+
+    weightRingHead = (weightRingHead + frameSamples) % WEIGHT_RING_CAPACITY;
+    weightRingCount -= frameSamples;
+    weightRingStartMs += (int64_t)frameSamples * WEIGHT_STREAM_INTERVAL_MS;
+    return true;
 }
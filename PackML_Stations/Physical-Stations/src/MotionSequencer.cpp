@@ -0,0 +1,211 @@
+#include "MotionSequencer.h"
+
+MotionSequencer::Track MotionSequencer::tracks[MotionSequencer::TRACKS];
+SemaphoreHandle_t MotionSequencer::mutex = nullptr;
+TaskHandle_t MotionSequencer::taskHandle = nullptr;
+
+// MotionSequence
+
+MotionSequence &MotionSequence::add(const SequenceStep &step)
+{
+    if (count == MAX_STEPS)
+    {
+        overflow = true;
+        return *this;
+    }
+    steps[count++] = step;
+    return *this;
+}
+
+MotionSequence &MotionSequence::then(StepAction action, uint32_t holdMs)
+{
+    return add(SequenceStep{action, holdMs, -1, 0, 0});
+}
+
+MotionSequence &MotionSequence::until(int pin, uint8_t level, uint32_t timeoutMs, StepAction action)
+{
+    return add(SequenceStep{action, 0, (int8_t)pin, level, timeoutMs});
+}
+
+MotionSequence &MotionSequence::onFailure(StepAction action)
+{
+    failureAction = action;
+    return *this;
+}
+
+MotionSequence &MotionSequence::onDone(SequenceDone callback, void *context)
+{
+    doneCallback = callback;
+    doneContext = context;
+    return *this;
+}
+
+// MotionSequencer
+
+void MotionSequencer::begin()
+{
+    if (taskHandle)
+    {
+        return;
+    }
+    mutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(sequencerTask, "Sequencer", TASK_STACK_SIZE, nullptr, TASK_PRIORITY, &taskHandle,
+                            ACTUATION_CORE);
+}
+
+bool MotionSequencer::start(uint8_t track, const MotionSequence &sequence)
+{
+    if (track >= TRACKS || sequence.overflowed())
+    {
+        return false;
+    }
+    begin();
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    Track &t = tracks[track];
+    if (t.count == TRACK_QUEUE_LENGTH)
+    {
+        xSemaphoreGive(mutex);
+        return false;
+    }
+    t.queue[(t.head + t.count) % TRACK_QUEUE_LENGTH] = sequence;
+    t.count++;
+    xSemaphoreGive(mutex);
+    return true;
+}
+
+namespace
+{
+    struct BlockingRun
+    {
+        SemaphoreHandle_t done;
+        bool success;
+    };
+
+    void blockingRunDone(void *context, bool success)
+    {
+        BlockingRun *run = (BlockingRun *)context;
+        run->success = success;
+        xSemaphoreGive(run->done);
+    }
+}
+
+bool MotionSequencer::run(uint8_t track, const MotionSequence &sequence)
+{
+    BlockingRun blocking{xSemaphoreCreateBinary(), false};
+    MotionSequence copy = sequence;
+    copy.onDone(blockingRunDone, &blocking);
+    if (!start(track, copy))
+    {
+        vSemaphoreDelete(blocking.done);
+        return false;
+    }
+    xSemaphoreTake(blocking.done, portMAX_DELAY);
+    vSemaphoreDelete(blocking.done);
+    return blocking.success;
+}
+
+bool MotionSequencer::busy(uint8_t track)
+{
+    if (track >= TRACKS || !mutex)
+    {
+        return false;
+    }
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool result = tracks[track].count > 0;
+    xSemaphoreGive(mutex);
+    return result;
+}
+
+void MotionSequencer::advance(Track &track, uint32_t nowMs, Completion *completions, size_t &completed)
+{
+    while (track.count > 0)
+    {
+        MotionSequence &sequence = track.queue[track.head];
+        bool finished = track.step >= sequence.count;
+        bool success = true;
+
+        if (!finished)
+        {
+            const SequenceStep &step = sequence.steps[track.step];
+            if (!track.stepStarted)
+            {
+                if (step.action)
+                {
+                    step.action();
+                }
+                track.stepStarted = true;
+                track.stepStartMs = nowMs;
+            }
+
+            uint32_t elapsed = nowMs - track.stepStartMs;
+            if (step.pin >= 0)
+            {
+                if (digitalRead(step.pin) != step.level)
+                {
+                    if (elapsed < step.timeoutMs)
+                    {
+                        return; // Sampled again next tick
+                    }
+                    Serial.print("  Sequencer: pin ");
+                    Serial.print(step.pin);
+                    Serial.print(" wait TIMEOUT after ");
+                    Serial.print(elapsed);
+                    Serial.println(" ms");
+                    finished = true;
+                    success = false;
+                }
+            }
+            else if (elapsed < step.holdMs)
+            {
+                return;
+            }
+
+            if (!finished)
+            {
+                // Due: the next step starts in this same tick
+                track.step++;
+                track.stepStarted = false;
+                continue;
+            }
+        }
+
+        if (!success && sequence.failureAction)
+        {
+            sequence.failureAction();
+        }
+        if (sequence.doneCallback)
+        {
+            completions[completed++] = Completion{sequence.doneCallback, sequence.doneContext, success};
+        }
+        track.head = (track.head + 1) % TRACK_QUEUE_LENGTH;
+        track.count--;
+        track.step = 0;
+        track.stepStarted = false;
+    }
+}
+
+void MotionSequencer::sequencerTask(void *parameter)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    Completion completions[TRACKS * TRACK_QUEUE_LENGTH];
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SEQUENCER_TICK_MS));
+
+        size_t completed = 0;
+        uint32_t nowMs = millis();
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        for (uint8_t i = 0; i < TRACKS; i++)
+        {
+            advance(tracks[i], nowMs, completions, completed);
+        }
+        xSemaphoreGive(mutex);
+
+        // Outside the lock: a callback may start the next sequence
+        for (size_t i = 0; i < completed; i++)
+        {
+            completions[i].callback(completions[i].context, completions[i].success);
+        }
+    }
+}
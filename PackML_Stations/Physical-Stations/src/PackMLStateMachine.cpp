@@ -1,15 +1,28 @@
 #include "PackMLStateMachine.h"
+#include <sys/time.h>
 
 PackMLStateMachine::PackMLStateMachine(const String &baseTopic, const String &moduleName, AsyncMqttClient *mqttClient)
     : state(PackMLState::RESETTING), baseTopic(baseTopic), moduleName(moduleName), client(mqttClient),
-      isProcessing(false), currentProcessingUuid(""), currentUuid(""), subscriptionsInitialized(false),
-      processTaskHandle(nullptr)
+      isProcessing(false), currentProcessingUuid(""), currentUuid(""),
+      processTaskHandle(nullptr), commandQueue(nullptr), commandMutex(nullptr), commandsInFlight(0),
+      subscriptionsInitialized(false)
 {
-    occupyCmdTopic = baseTopic + "/" + moduleName + "/CMD/Occupy";
-    occupyDataTopic = baseTopic + "/" + moduleName + "/DATA/Occupy";
-    releaseCmdTopic = baseTopic + "/" + moduleName + "/CMD/Release";
-    releaseDataTopic = baseTopic + "/" + moduleName + "/DATA/Release";
-    stateDataTopic = baseTopic + "/" + moduleName + "/DATA/State";
+    occupyCmdTopic.appendf("%s/%s/CMD/Occupy", baseTopic.c_str(), moduleName.c_str());
+    occupyDataTopic.appendf("%s/%s/DATA/Occupy", baseTopic.c_str(), moduleName.c_str());
+    releaseCmdTopic.appendf("%s/%s/CMD/Release", baseTopic.c_str(), moduleName.c_str());
+    releaseDataTopic.appendf("%s/%s/DATA/Release", baseTopic.c_str(), moduleName.c_str());
+    stateDataTopic.appendf("%s/%s/DATA/State", baseTopic.c_str(), moduleName.c_str());
+
+    for (auto &slot : sequenceCommands)
+    {
+        slot.inUse = false;
+    }
+
+    commandQueue = xQueueCreate(COMMAND_QUEUE_LENGTH, sizeof(CommandDescriptor));
+    commandMutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(processTask, "PackMLWorker", WORKER_STACK_SIZE, this, WORKER_PRIORITY, &processTaskHandle,
+                            ACTUATION_CORE);
+
     resettingState();
 }
 
@@ -37,14 +50,14 @@ void PackMLStateMachine::subscribeToTopics()
     // Subscribe to occupy and release topics
     uint16_t packetId1 = client->subscribe(occupyCmdTopic.c_str(), 0);
     Serial.print("  ✓ ");
-    Serial.print(occupyCmdTopic);
+    Serial.print(occupyCmdTopic.c_str());
     Serial.print(" (packetId: ");
     Serial.print(packetId1);
     Serial.println(")");
 
     uint16_t packetId2 = client->subscribe(releaseCmdTopic.c_str(), 0);
     Serial.print("  ✓ ");
-    Serial.print(releaseCmdTopic);
+    Serial.print(releaseCmdTopic.c_str());
     Serial.print(" (packetId: ");
     Serial.print(packetId2);
     Serial.println(")");
@@ -54,7 +67,7 @@ void PackMLStateMachine::subscribeToTopics()
     {
         uint16_t packetId = client->subscribe(handler.cmdTopic.c_str(), 0);
         Serial.print("  ✓ ");
-        Serial.print(handler.cmdTopic);
+        Serial.print(handler.cmdTopic.c_str());
         Serial.print(" (packetId: ");
         Serial.print(packetId);
         Serial.println(")");
@@ -67,25 +80,46 @@ void PackMLStateMachine::subscribeToTopics()
 void PackMLStateMachine::registerCommandHandler(const String &cmdTopic, const String &dataTopic,
                                                 CommandCallback callback)
 {
+    // Registration happens during setup only; TaskData keeps pointers into these entries
     CommandHandler handler;
-    handler.cmdTopic = baseTopic + "/" + moduleName + cmdTopic;
-    handler.dataTopic = baseTopic + "/" + moduleName + dataTopic;
+    handler.cmdTopic.appendf("%s/%s%s", baseTopic.c_str(), moduleName.c_str(), cmdTopic.c_str());
+    handler.dataTopic.appendf("%s/%s%s", baseTopic.c_str(), moduleName.c_str(), dataTopic.c_str());
     handler.callback = callback;
+    if (handler.cmdTopic.overflowed() || handler.dataTopic.overflowed())
+    {
+        Serial.print("Topic too long for buffer: ");
+        Serial.println(cmdTopic);
+    }
     commandHandlers.push_back(handler);
 
     Serial.print("Registered: ");
-    Serial.println(handler.cmdTopic);
+    Serial.println(handler.cmdTopic.c_str());
 }
 
-void PackMLStateMachine::handleMessage(const String &topic, const JsonDocument &message)
+const char *PackMLStateMachine::resolveDataTopic(const String &dataTopic) const
+{
+    // Full topics are "<baseTopic>/<moduleName><suffix>"; match on the suffix without building a String
+    size_t prefixLength = baseTopic.length() + 1 + moduleName.length();
+    for (const auto &handler : commandHandlers)
+    {
+        if (handler.dataTopic.size() >= prefixLength &&
+            strcmp(handler.dataTopic.c_str() + prefixLength, dataTopic.c_str()) == 0)
+        {
+            return handler.dataTopic.c_str();
+        }
+    }
+    return nullptr;
+}
+
+void PackMLStateMachine::handleMessage(const char *topic, const JsonDocument &message)
 {
     // Check if it's an occupy/release command
-    if (topic == occupyCmdTopic)
+    if (strcmp(topic, occupyCmdTopic.c_str()) == 0)
     {
         occupyCallback(this, message);
         return;
     }
-    if (topic == releaseCmdTopic)
+    if (strcmp(topic, releaseCmdTopic.c_str()) == 0)
     {
         releaseCallback(this, message);
         return;
@@ -94,7 +128,7 @@ void PackMLStateMachine::handleMessage(const String &topic, const JsonDocument &
     // Check command handlers
     for (const auto &handler : commandHandlers)
     {
-        if (topic == handler.cmdTopic)
+        if (strcmp(topic, handler.cmdTopic.c_str()) == 0)
         {
             if (handler.callback)
             {
@@ -105,11 +139,18 @@ void PackMLStateMachine::handleMessage(const String &topic, const JsonDocument &
     }
 }
 
-void PackMLStateMachine::executeCommand(const JsonDocument &message, const String &dataTopic,
-                                        void (*processFunction)())
+const char *PackMLStateMachine::admitCommand(const JsonDocument &message, const String &dataTopic,
+                                             String &commandUuid, CommandTrace &trace)
 {
-    String commandUuid = message["Uuid"].as<String>();
-    String topic = baseTopic + "/" + moduleName + dataTopic;
+    readTrace(message, trace);
+    commandUuid = message["Uuid"].as<String>();
+    const char *topic = resolveDataTopic(dataTopic);
+    if (!topic)
+    {
+        Serial.print("Execute command rejected: no handler registered for data topic ");
+        Serial.println(dataTopic);
+        return nullptr;
+    }
 
     // Condition 1: Not in EXECUTE state
     if (state != PackMLState::EXECUTE)
@@ -117,11 +158,11 @@ void PackMLStateMachine::executeCommand(const JsonDocument &message, const Strin
         Serial.print("Execute command rejected for UUID '");
         Serial.print(commandUuid);
         Serial.print("'. Machine not in EXECUTE state (current: ");
-        Serial.print(stateToString(state).c_str());
+        Serial.print(stateToString(state));
         Serial.println(").");
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
-        return;
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
+        return nullptr;
     }
 
     // Condition 2: Queue is empty
@@ -131,168 +172,179 @@ void PackMLStateMachine::executeCommand(const JsonDocument &message, const Strin
         Serial.print(commandUuid);
         Serial.println("'. Queue is empty.");
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
-        return;
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
+        return nullptr;
     }
 
     // Condition 3: UUID not at front of queue
-    if (uuids[0] != commandUuid)
+    if (strcmp(uuids.front(), commandUuid.c_str()) != 0)
     {
         Serial.print("Execute command rejected for UUID '");
         Serial.print(commandUuid);
         Serial.print("'. Expected head: '");
-        Serial.print(uuids[0]);
-        Serial.print("', Queue: [");
-        for (size_t i = 0; i < uuids.size(); i++)
-        {
-            Serial.print(uuids[i]);
-            if (i < uuids.size() - 1)
-                Serial.print(", ");
-        }
-        Serial.println("]");
+        Serial.print(uuids.front());
+        Serial.print("', queue depth: ");
+        Serial.println((unsigned int)uuids.size());
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
-        return;
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
+        return nullptr;
     }
 
-    // Condition 4: Already processing another command
-    if (isProcessing)
+    if (commandUuid.length() >= CommandDescriptor::UUID_MAX_LEN)
     {
         Serial.print("Execute command rejected for UUID '");
         Serial.print(commandUuid);
-        Serial.print("'. Already processing: ");
-        Serial.println(currentProcessingUuid);
+        Serial.println("'. UUID too long.");
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
-        return;
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
+        return nullptr;
     }
+    return topic;
+}
 
-    // All conditions met - execute the command asynchronously
-    isProcessing = true;
-    currentProcessingUuid = commandUuid;
+bool PackMLStateMachine::busyWithOther(const String &commandUuid, const char *topic,
+                                       const CommandTrace &trace)
+{
+    // Condition 4: Already processing a command for another occupant. The head occupant's own
+    // follow-up commands are queued behind the running one.
+    if (isProcessing && currentProcessingUuid != commandUuid)
+    {
+        Serial.print("Execute command rejected for UUID '");
+        Serial.print(commandUuid);
+        Serial.print("'. Already processing: ");
+        Serial.println(currentProcessingUuid);
 
-    // Publish RUNNING status
-    publishCommandStatus(topic, commandUuid, "RUNNING");
-
-    // Create task data
-    TaskData* taskData = new TaskData();
-    taskData->sm = this;
-    taskData->topic = topic;
-    taskData->uuid = commandUuid;
-    taskData->voidFunc = processFunction;
-    taskData->boolFunc = nullptr;
-    taskData->isBoolFunc = false;
-
-    // Execute the process function in a separate task
-    xTaskCreate(
-        processTask,
-        "ProcessTask",
-        8192,  // Stack size
-        (void*)taskData,
-        1,     // Priority
-        &processTaskHandle
-    );
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
+        return true;
+    }
+    return false;
 }
 
-void PackMLStateMachine::executeCommand(const JsonDocument &message, const String &dataTopic,
+void PackMLStateMachine::enqueueCommand(const JsonDocument &message, const String &dataTopic,
                                         bool (*processFunction)())
 {
-    String commandUuid = message["Uuid"].as<String>();
-    String topic = baseTopic + "/" + moduleName + dataTopic;
+    String commandUuid;
+    CommandTrace trace;
+    const char *topic = admitCommand(message, dataTopic, commandUuid, trace);
+    if (!topic)
+    {
+        return;
+    }
 
-    // Condition 1: Not in EXECUTE state
-    if (state != PackMLState::EXECUTE)
+    CommandDescriptor command;
+    command.topic = topic;
+    strncpy(command.uuid, commandUuid.c_str(), sizeof(command.uuid));
+    command.trace = trace;
+    command.processFunction = processFunction;
+
+    xSemaphoreTake(commandMutex, portMAX_DELAY);
+    if (busyWithOther(commandUuid, topic, trace))
     {
+        xSemaphoreGive(commandMutex);
+        return;
+    }
+
+    // RUNNING goes out before the worker can answer SUCCESS; a full queue follows it with FAILURE
+    publishCommandStatus(topic, commandUuid.c_str(), "RUNNING", &trace);
+
+    // Hand the command to the worker task without waiting
+    if (xQueueSend(commandQueue, &command, 0) != pdTRUE)
+    {
+        xSemaphoreGive(commandMutex);
         Serial.print("Execute command rejected for UUID '");
         Serial.print(commandUuid);
-        Serial.print("'. Machine not in EXECUTE state (current: ");
-        Serial.print(stateToString(state).c_str());
-        Serial.println(").");
+        Serial.println("'. Command queue full.");
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
         return;
     }
 
-    // Condition 2: Queue is empty
-    if (uuids.empty())
+    commandsInFlight++;
+    isProcessing = true;
+    currentProcessingUuid = commandUuid;
+    xSemaphoreGive(commandMutex);
+}
+
+void PackMLStateMachine::executeSequence(const JsonDocument &message, const String &dataTopic,
+                                         uint8_t track, SequenceBuilder build)
+{
+    String commandUuid;
+    CommandTrace trace;
+    const char *topic = admitCommand(message, dataTopic, commandUuid, trace);
+    if (!topic)
     {
-        Serial.print("Execute command rejected for UUID '");
-        Serial.print(commandUuid);
-        Serial.println("'. Queue is empty.");
+        return;
+    }
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
+    xSemaphoreTake(commandMutex, portMAX_DELAY);
+    if (busyWithOther(commandUuid, topic, trace))
+    {
+        xSemaphoreGive(commandMutex);
         return;
     }
 
-    // Condition 3: UUID not at front of queue
-    if (uuids[0] != commandUuid)
+    SequenceCommand *slot = nullptr;
+    for (auto &candidate : sequenceCommands)
     {
-        Serial.print("Execute command rejected for UUID '");
-        Serial.print(commandUuid);
-        Serial.print("'. Expected head: '");
-        Serial.print(uuids[0]);
-        Serial.print("', Queue: [");
-        for (size_t i = 0; i < uuids.size(); i++)
+        if (!candidate.inUse)
         {
-            Serial.print(uuids[i]);
-            if (i < uuids.size() - 1)
-                Serial.print(", ");
+            slot = &candidate;
+            break;
         }
-        Serial.println("]");
-
-        publishCommandStatus(topic, commandUuid, "FAILURE");
-        return;
     }
 
-    // Condition 4: Already processing another command
-    if (isProcessing)
+    MotionSequence sequence;
+    build(sequence);
+    trace.startedMs = epochMillis();
+    // RUNNING goes out before the sequencer can answer SUCCESS
+    if (slot)
     {
+        publishCommandStatus(topic, commandUuid.c_str(), "RUNNING", &trace);
+        slot->machine = this;
+        slot->topic = topic;
+        strncpy(slot->uuid, commandUuid.c_str(), sizeof(slot->uuid));
+        slot->trace = trace;
+        slot->inUse = true;
+        sequence.onDone(sequenceDone, slot);
+    }
+    if (!slot || !MotionSequencer::start(track, sequence))
+    {
+        if (slot)
+        {
+            slot->inUse = false;
+        }
+        xSemaphoreGive(commandMutex);
         Serial.print("Execute command rejected for UUID '");
         Serial.print(commandUuid);
-        Serial.print("'. Already processing: ");
-        Serial.println(currentProcessingUuid);
+        Serial.println("'. Sequencer track full.");
 
-        publishCommandStatus(topic, commandUuid, "FAILURE");
+        publishCommandStatus(topic, commandUuid.c_str(), "FAILURE", &trace);
         return;
     }
 
-    // All conditions met - execute the command asynchronously
+    commandsInFlight++;
     isProcessing = true;
     currentProcessingUuid = commandUuid;
+    xSemaphoreGive(commandMutex);
+}
+
+void PackMLStateMachine::sequenceDone(void *context, bool success)
+{
+    SequenceCommand *slot = (SequenceCommand *)context;
+    slot->machine->finishCommand(slot->topic, slot->uuid, success, slot->trace);
 
-    // Publish RUNNING status
-    publishCommandStatus(topic, commandUuid, "RUNNING");
-
-    // Create task data
-    TaskData* taskData = new TaskData();
-    taskData->sm = this;
-    taskData->topic = topic;
-    taskData->uuid = commandUuid;
-    taskData->voidFunc = nullptr;
-    taskData->boolFunc = processFunction;
-    taskData->isBoolFunc = true;
-
-    // Execute the process function in a separate task
-    xTaskCreate(
-        processTask,
-        "ProcessTask",
-        8192,  // Stack size
-        (void*)taskData,
-        1,     // Priority
-        &processTaskHandle
-    );
+    xSemaphoreTake(slot->machine->commandMutex, portMAX_DELAY);
+    slot->inUse = false;
+    xSemaphoreGive(slot->machine->commandMutex);
 }
 
 void PackMLStateMachine::occupyCommand(const String &uuid)
 {
     // Check if alreadyoccupyed
-    for (const auto &existingUuid : uuids)
+    if (uuids.contains(uuid.c_str()))
     {
-        if (existingUuid == uuid)
-        {
-            Serial.println("UUID alreadyoccupyed");
-            return;
-        }
+        Serial.println("UUID alreadyoccupyed");
+        return;
     }
     if (currentProcessingUuid == uuid)
     {
@@ -300,12 +352,20 @@ void PackMLStateMachine::occupyCommand(const String &uuid)
         return;
     }
 
-    // Add to queue
-    uuids.push_back(uuid);
-    pendingRegistrations.push_back(uuid);
+    // Add to queue; a full queue (or an oversized UUID) is refused instead of growing
+    if (!uuids.push(uuid.c_str()))
+    {
+        Serial.print("Occupy rejected for UUID '");
+        Serial.print(uuid);
+        Serial.print("'. Queue full or UUID too long (depth ");
+        Serial.print((unsigned int)uuids.size());
+        Serial.println(")");
+        publishCommandStatus(occupyDataTopic.c_str(), uuid.c_str(), "FAILURE");
+        return;
+    }
 
     // Publish RUNNING for registration
-    publishCommandStatus(occupyDataTopic.c_str(), uuid, "RUNNING");
+    publishCommandStatus(occupyDataTopic.c_str(), uuid.c_str(), "RUNNING");
 
     publishState();
 
@@ -318,37 +378,36 @@ void PackMLStateMachine::occupyCommand(const String &uuid)
 
 void PackMLStateMachine::releaseCommand(const String &uuid)
 {
-    bool found = false;
-
     // Check if currently processing
     if (isProcessing && uuid == currentProcessingUuid)
     {
         Serial.println("Cannot release: command is currently processing");
-        publishCommandStatus(releaseDataTopic.c_str(), uuid, "FAILURE");
+        publishCommandStatus(releaseDataTopic.c_str(), uuid.c_str(), "FAILURE");
         return;
     }
 
     // Check if at front of queue
-    if (!uuids.empty() && uuid == uuids[0] && !isProcessing)
+    bool startNext = !isProcessing && !uuids.empty() && strcmp(uuids.front(), uuid.c_str()) == 0;
+
+    bool wasPending = false;
+    if (!uuids.remove(uuid.c_str(), &wasPending))
     {
-        uuids.erase(uuids.begin());
+        publishCommandStatus(releaseDataTopic.c_str(), uuid.c_str(), "FAILURE");
+        return;
+    }
 
-        // Remove from pending registrations
-        for (size_t i = 0; i < pendingRegistrations.size(); i++)
-        {
-            if (pendingRegistrations[i] == uuid)
-            {
-                pendingRegistrations.erase(pendingRegistrations.begin() + i);
-                publishCommandStatus(occupyDataTopic.c_str(), uuid, "FAILURE");
-                break;
-            }
-        }
+    // Released before its registration succeeded
+    if (wasPending)
+    {
+        publishCommandStatus(occupyDataTopic.c_str(), uuid.c_str(), "FAILURE");
+    }
 
-        publishCommandStatus(releaseDataTopic.c_str(), uuid, "SUCCESS");
-        publishState();
-        found = true;
+    publishCommandStatus(releaseDataTopic.c_str(), uuid.c_str(), "SUCCESS");
+    publishState();
 
-        // Transition back to idle or start next
+    // Released the head occupant: transition back to idle or start next
+    if (startNext)
+    {
         if (uuids.empty())
         {
             transitionTo(PackMLState::RESETTING);
@@ -357,37 +416,6 @@ void PackMLStateMachine::releaseCommand(const String &uuid)
         {
             transitionTo(PackMLState::STARTING);
         }
-        return;
-    }
-
-    // Check if in queue
-    for (size_t i = 0; i < uuids.size(); i++)
-    {
-        if (uuids[i] == uuid)
-        {
-            uuids.erase(uuids.begin() + i);
-
-            // Remove from pending registrations
-            for (size_t j = 0; j < pendingRegistrations.size(); j++)
-            {
-                if (pendingRegistrations[j] == uuid)
-                {
-                    pendingRegistrations.erase(pendingRegistrations.begin() + j);
-                    publishCommandStatus(occupyDataTopic.c_str(), uuid, "FAILURE");
-                    break;
-                }
-            }
-
-            publishCommandStatus(releaseDataTopic.c_str(), uuid, "SUCCESS");
-            publishState();
-            found = true;
-            break;
-        }
-    }
-
-    if (!found)
-    {
-        publishCommandStatus(releaseDataTopic.c_str(), uuid, "FAILURE");
     }
 }
 
@@ -429,7 +457,7 @@ void PackMLStateMachine::transitionTo(PackMLState newState, const String &uuidPa
     publishState();
 
     Serial.print("Transitioned to state: ");
-    Serial.println(stateToString(state).c_str());
+    Serial.println(stateToString(state));
 
     switch (newState)
     {
@@ -484,17 +512,12 @@ void PackMLStateMachine::startingState()
         return;
     }
 
-    currentUuid = uuids[0];
+    currentUuid = uuids.front();
 
     // Check if this UUID has a pending registration and mark it as SUCCESS
-    for (size_t i = 0; i < pendingRegistrations.size(); i++)
+    if (uuids.takePendingRegistration(currentUuid.c_str()))
     {
-        if (pendingRegistrations[i] == currentUuid)
-        {
-            publishCommandStatus(occupyDataTopic.c_str(), currentUuid, "SUCCESS");
-            pendingRegistrations.erase(pendingRegistrations.begin() + i);
-            break;
-        }
+        publishCommandStatus(occupyDataTopic.c_str(), currentUuid.c_str(), "SUCCESS");
     }
 
     transitionTo(PackMLState::EXECUTE);
@@ -512,14 +535,7 @@ void PackMLStateMachine::completingState(const String &uuidCompleted)
     else
     {
         // Remove from queue
-        for (size_t i = 0; i < uuids.size(); i++)
-        {
-            if (uuids[i] == uuidCompleted)
-            {
-                uuids.erase(uuids.begin() + i);
-                break;
-            }
-        }
+        uuids.remove(uuidCompleted.c_str());
     }
 
     if (currentProcessingUuid == uuidCompleted)
@@ -542,11 +558,13 @@ void PackMLStateMachine::abortingState(const String &abortedTaskUuid)
     onAborting();
 
     // Fail all pending registrations
-    for (const auto &uuid : pendingRegistrations)
+    for (size_t i = 0; i < uuids.size(); i++)
     {
-        publishCommandStatus(occupyDataTopic.c_str(), uuid, "FAILURE");
+        if (uuids.isPendingRegistration(i))
+        {
+            publishCommandStatus(occupyDataTopic.c_str(), uuids.at(i), "FAILURE");
+        }
     }
-    pendingRegistrations.clear();
 
     // Clear queue
     uuids.clear();
@@ -579,123 +597,157 @@ void PackMLStateMachine::clearingState()
 // Helper methods
 void PackMLStateMachine::publishState()
 {
-    JsonDocument doc;
-    doc["State"] = stateToString(state);
-    doc["TimeStamp"] = getTimestamp();
+    // Built into a stack buffer: no JsonDocument or String allocation per publish
+    // Sized for a full queue of maximum-length UUIDs
+    PayloadBuffer<160 + OccupancyQueue::CAPACITY * (OccupancyQueue::UUID_SLOT_SIZE + 3)> output;
+    output.append("{\"State\":\"").append(stateToString(state)).append("\",\"TimeStamp\":");
+    output.appendJsonTimestamp().appendf(",\"QueueDepth\":%u", (unsigned int)uuids.size());
+    output.append(",\"ProcessQueue\":[");
+    for (size_t i = 0; i < uuids.size(); i++)
+    {
+        if (i > 0)
+        {
+            output.append(",");
+        }
+        output.appendJsonString(uuids.at(i));
+    }
+    output.append("]}");
+
+    if (output.overflowed())
+    {
+        Serial.println("⚠️ State payload truncated, not published");
+        return;
+    }
+    client->publish(stateDataTopic.c_str(), 2, true, output.c_str(), output.size());
+}
+
+void PackMLStateMachine::publishCommandStatus(const char *topic, const char *uuid, const char *stateValue,
+                                              const CommandTrace *trace)
+{
+    PayloadBuffer<384> output;
+    output.append("{\"State\":").appendJsonString(stateValue);
+    output.append(",\"TimeStamp\":").appendJsonTimestamp();
+    output.append(",\"Uuid\":").appendJsonString(uuid);
+    if (trace && trace->id[0])
+    {
+        uint64_t completedMs = strcmp(stateValue, "RUNNING") != 0 ? epochMillis() : 0;
+        output.append(",\"Trace\":{\"Id\":").appendJsonString(trace->id);
+        output.appendf(",\"Sent\":%llu", (unsigned long long)trace->sentMs);
+        if (trace->receivedMs)
+        {
+            output.appendf(",\"Received\":%llu", (unsigned long long)trace->receivedMs);
+        }
+        if (trace->startedMs)
+        {
+            output.appendf(",\"Started\":%llu", (unsigned long long)trace->startedMs);
+        }
+        if (completedMs)
+        {
+            output.appendf(",\"Completed\":%llu", (unsigned long long)completedMs);
+        }
+        output.append("}");
+    }
+    output.append("}");
 
-    JsonArray queueArray = doc["ProcessQueue"].to<JsonArray>();
-    for (const auto &uuid : uuids)
+    if (output.overflowed())
     {
-        queueArray.add(uuid);
+        Serial.println("⚠️ Command status payload truncated, not published");
+        return;
     }
+    client->publish(topic, 2, true, output.c_str(), output.size());
+}
+
+void PackMLStateMachine::readTrace(const JsonDocument &message, CommandTrace &trace)
+{
+    trace.id[0] = '\0';
+    trace.sentMs = 0;
+    trace.receivedMs = epochMillis();
+    trace.startedMs = 0;
 
-    char output[512];
-    size_t len = serializeJson(doc, output);
-    client->publish(stateDataTopic.c_str(), 2, true, output, len);
+    const char *id = message["Trace"]["Id"];
+    if (id && strlen(id) < sizeof(trace.id))
+    {
+        strcpy(trace.id, id);
+        trace.sentMs = message["Trace"]["Sent"] | (uint64_t)0;
+    }
 }
 
-void PackMLStateMachine::publishCommandStatus(const String &topic, const String &uuid, const char *stateValue)
+uint64_t PackMLStateMachine::epochMillis()
 {
-    JsonDocument doc;
-    doc["State"] = stateValue;
-    doc["TimeStamp"] = getTimestamp();
-    doc["Uuid"] = uuid;
-
-    char output[256];
-    size_t len = serializeJson(doc, output);
-    client->publish(topic.c_str(), 2, true, output, len);
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    if (now.tv_sec < 1600000000) // Not synchronized yet: a timestamp would be meaningless
+    {
+        return 0;
+    }
+    return (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
 }
 
 String PackMLStateMachine::getTimestamp()
 {
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
+    if (!getLocalTime(&timeinfo, 0))
     {
         return "2000-01-01T00:00:00.000Z";
     }
 
     char buffer[30];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
-    return String(buffer) + ".000Z";
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000Z", &timeinfo);
+    return String(buffer);
 }
 
-String PackMLStateMachine::stateToString(PackMLState state)
+const char *PackMLStateMachine::stateToString(PackMLState state)
 {
-    switch (state)
+    size_t index = (size_t)state;
+    if (index >= sizeof(PACKML_STATE_NAMES) / sizeof(PACKML_STATE_NAMES[0]))
     {
-    case PackMLState::IDLE:
-        return "IDLE";
-    case PackMLState::STARTING:
-        return "STARTING";
-    case PackMLState::EXECUTE:
-        return "EXECUTE";
-    case PackMLState::COMPLETING:
-        return "COMPLETING";
-    case PackMLState::COMPLETE:
-        return "COMPLETE";
-    case PackMLState::RESETTING:
-        return "RESETTING";
-    case PackMLState::HOLDING:
-        return "HOLDING";
-    case PackMLState::HELD:
-        return "HELD";
-    case PackMLState::UNHOLDING:
-        return "UNHOLDING";
-    case PackMLState::SUSPENDING:
-        return "SUSPENDING";
-    case PackMLState::SUSPENDED:
-        return "SUSPENDED";
-    case PackMLState::UNSUSPENDING:
-        return "UNSUSPENDING";
-    case PackMLState::STOPPING:
-        return "STOPPING";
-    case PackMLState::STOPPED:
-        return "STOPPED";
-    case PackMLState::ABORTING:
-        return "ABORTING";
-    case PackMLState::ABORTED:
-        return "ABORTED";
-    case PackMLState::CLEARING:
-        return "CLEARING";
-    default:
         return "UNKNOWN";
     }
+    return PACKML_STATE_NAMES[index];
 }
 
 void PackMLStateMachine::processTask(void* parameter)
 {
-    TaskData* data = (TaskData*)parameter;
-    bool success = true;
-    
-    // Execute the function in this separate task
-    if (data->isBoolFunc && data->boolFunc)
+    PackMLStateMachine *sm = (PackMLStateMachine *)parameter;
+    CommandDescriptor command;
+
+    // Runs for the lifetime of the station; commands execute one at a time in arrival order
+    while (true)
     {
-        success = data->boolFunc();
+        if (xQueueReceive(sm->commandQueue, &command, portMAX_DELAY) == pdTRUE)
+        {
+            sm->runCommand(command);
+        }
     }
-    else if (!data->isBoolFunc && data->voidFunc)
+}
+
+void PackMLStateMachine::runCommand(const CommandDescriptor &command)
+{
+    CommandTrace trace = command.trace;
+    trace.startedMs = epochMillis();
+
+    // Execute the process function on the worker task
+    bool success = command.processFunction();
+
+    finishCommand(command.topic, command.uuid, success, trace);
+}
+
+void PackMLStateMachine::finishCommand(const char *topic, const char *uuid, bool success,
+                                       const CommandTrace &trace)
+{
+    // Mark processing as complete once nothing else is queued, before the response goes out:
+    // a controller answering SUCCESS with Release at once must not find the station busy
+    xSemaphoreTake(commandMutex, portMAX_DELAY);
+    if (commandsInFlight > 0)
     {
-        data->voidFunc();
-        success = true;
+        commandsInFlight--;
     }
-    
-    // Publish completion status
-    if (success)
+    if (commandsInFlight == 0)
     {
-        data->sm->publishCommandStatus(data->topic, data->uuid, "SUCCESS");
+        isProcessing = false;
+        currentProcessingUuid = "";
     }
-    else
-    {
-        data->sm->publishCommandStatus(data->topic, data->uuid, "FAILURE");
-    }
-    
-    // Mark processing as complete
-    data->sm->isProcessing = false;
-    data->sm->currentProcessingUuid = "";
-    data->sm->processTaskHandle = nullptr;
-    
-    // Clean up
-    delete data;
-    
-    // Delete this task
-    vTaskDelete(NULL);
-}
\ No newline at end of file
+    xSemaphoreGive(commandMutex);
+
+    publishCommandStatus(topic, uuid, success ? "SUCCESS" : "FAILURE", &trace);
+}
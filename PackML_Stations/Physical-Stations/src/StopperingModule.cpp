@@ -1,6 +1,7 @@
 #include "StopperingModule.h"
 #include "ESP32Module.h"
 #include "PackMLStateMachine.h"
+#include "MotionSequencer.h"
 #include <esp_task_wdt.h>
 
 // Static member initialization
@@ -46,7 +47,7 @@ void StopperingModule::setup(ESP32Module *moduleInstance)
         TOPIC_PUB_STOPPERING_DATA,
         [](PackMLStateMachine *sm, const JsonDocument &msg)
         {
-            sm->executeCommand(msg, TOPIC_PUB_STOPPERING_DATA, runStopperingCycle);
+            sm->executeSequence(msg, TOPIC_PUB_STOPPERING_DATA, MECHANISM_TRACK, buildStopperingCycle);
         });
     stateMachine->subscribeToTopics();
     stateMachine->publishState();
@@ -114,7 +115,7 @@ void StopperingModule::initServo()
     delay(SERVO_MOVE_TIME);
     
     // Keep servo attached during initialization to avoid PWM conflicts
-    // It will be detached after first use in runServo()
+    // It will be detached after its first stoppering cycle
     Serial.println("Servo initialized to home position");
     Serial.flush();
 }
@@ -136,127 +137,109 @@ void StopperingModule::initDCMotor()
 {
     Serial.println("Initializing DC motor to home position");
 
-    // Move down until limit switch
-    digitalWrite(DC_IN3, LOW);
-    digitalWrite(DC_IN4, HIGH);
-
-    if (!waitForButton(BUTTON_PIN, MOTION_TIMEOUT))
+    // Move down until limit switch, then up for clearance. A timeout still backs off.
+    MotionSequence down;
+    down.until(BUTTON_PIN, HIGH, MOTION_TIMEOUT, startDCDown);
+    if (!MotionSequencer::run(MECHANISM_TRACK, down))
     {
         Serial.println("Motion Error: DC motor initialization timeout");
     }
 
-    // Move up for clearance
-    digitalWrite(DC_IN3, HIGH);
-    digitalWrite(DC_IN4, LOW);
-    delay(DC_INIT_UP_TIME);
-
-    // Stop motor
-    stopDCMotor();
+    MotionSequence up;
+    up.then(startDCUp, DC_INIT_UP_TIME).then(stopDCMotor);
+    MotionSequencer::run(MECHANISM_TRACK, up);
 }
 
-bool StopperingModule::runStopperingCycle()
+void StopperingModule::buildStopperingCycle(MotionSequence &sequence)
 {
     Serial.println("Starting stoppering cycle");
 
     // Position DC motor down to working position
-    if (!moveDCDown())
-    {
-        Serial.println("Error: Failed to move DC motor down");
-        return false;
-    }
-    delay(100);
+    sequence.until(BUTTON_PIN, HIGH, MOTION_TIMEOUT, startDCDown)
+        .then(stopDCMotor, 100);
 
-    // Move servo to position stopper
-    runServo();
-    delay(100);
+    // Move servo from outer to inner position to place the stopper, and back
+    sequence.then(attachServo, 100)
+        .then(servoInner, SERVO_MOVE_TIME)
+        .then(servoOuter, SERVO_MOVE_TIME)
+        .then(detachServo, 100);
 
-    // Execute plunging operation
-    runLinearActuator();
-    delay(100);
+    // Plunge: actuator down to push the plunger, back up to home position
+    sequence.then(startLinearActuatorDown, LA_DOWN_TIME)
+        .then(startLinearActuatorUp, LA_UP_TIME)
+        .then(stopLinearActuator, 100);
 
     // Return DC motor to home position
-    moveDCUp();
-    delay(500);
-
-    Serial.println("Stoppering cycle completed successfully");
-    return true;
+    sequence.then(startDCUp, DC_UP_TIME)
+        .then(stopDCMotor, 500)
+        .then(reportCycleComplete)
+        .onFailure(stopAll);
 }
 
-void StopperingModule::runLinearActuator()
+void StopperingModule::startDCDown()
 {
-    Serial.println("Running linear actuator cycle");
-
-    // Move actuator down to push plunger
-    digitalWrite(LA_IN1, LOW);
-    digitalWrite(LA_IN2, HIGH);
-    delay(LA_DOWN_TIME);
-
-    // Move actuator back up to home position
-    digitalWrite(LA_IN1, HIGH);
-    digitalWrite(LA_IN2, LOW);
-    delay(LA_UP_TIME);
+    Serial.println("Moving DC motor down to working position");
+    digitalWrite(DC_IN3, LOW);
+    digitalWrite(DC_IN4, HIGH);
+}
 
-    // Stop actuator
-    stopLinearActuator();
+void StopperingModule::startDCUp()
+{
+    Serial.println("Moving DC motor up to home position");
+    digitalWrite(DC_IN3, HIGH);
+    digitalWrite(DC_IN4, LOW);
 }
 
-void StopperingModule::runServo()
+void StopperingModule::attachServo()
 {
     Serial.println("Moving servo to position stopper");
-    Serial.flush();
-    
     // Re-attach servo if needed (in case it was detached)
     if (!servo.attached())
     {
         servo.attach(SERVO_PIN);
-        delay(100);
     }
+}
 
-    // Move from outer position to inner position
+void StopperingModule::servoInner()
+{
     servo.write(1);
-    delay(SERVO_MOVE_TIME);
+}
 
-    // Return to home position (outer)
+void StopperingModule::servoOuter()
+{
     servo.write(121);
-    delay(SERVO_MOVE_TIME);
-    
+}
+
+void StopperingModule::detachServo()
+{
     // Detach servo to prevent vibration
     servo.detach();
     Serial.println("Servo cycle complete, servo detached");
-    Serial.flush();
 }
 
-bool StopperingModule::moveDCDown()
+void StopperingModule::startLinearActuatorDown()
 {
-    Serial.println("Moving DC motor down to working position");
-
-    // Run piston down until it hits the limit switch
-    digitalWrite(DC_IN3, LOW);
-    digitalWrite(DC_IN4, HIGH);
-
-    if (!waitForButton(BUTTON_PIN, MOTION_TIMEOUT))
-    {
-        Serial.println("Motion Error: Move DC down timeout");
-        stopDCMotor();
-        return false;
-    }
-
-    // Stop motor
-    stopDCMotor();
-    return true;
+    Serial.println("Running linear actuator cycle");
+    digitalWrite(LA_IN1, LOW);
+    digitalWrite(LA_IN2, HIGH);
 }
 
-void StopperingModule::moveDCUp()
+void StopperingModule::startLinearActuatorUp()
 {
-    Serial.println("Moving DC motor up to home position");
+    digitalWrite(LA_IN1, HIGH);
+    digitalWrite(LA_IN2, LOW);
+}
 
-    // Run piston up for clearance
-    digitalWrite(DC_IN3, HIGH);
-    digitalWrite(DC_IN4, LOW);
-    delay(DC_UP_TIME);
+void StopperingModule::reportCycleComplete()
+{
+    Serial.println("Stoppering cycle completed successfully");
+}
 
-    // Stop motor
+void StopperingModule::stopAll()
+{
+    Serial.println("Error: Stoppering cycle aborted, stopping actuators");
     stopDCMotor();
+    stopLinearActuator();
 }
 
 void StopperingModule::stopDCMotor()
@@ -269,22 +252,4 @@ void StopperingModule::stopLinearActuator()
 {
     digitalWrite(LA_IN1, LOW);
     digitalWrite(LA_IN2, LOW);
-    delay(10);
-}
-
-bool StopperingModule::waitForButton(int buttonPin, unsigned long timeoutMs)
-{
-    unsigned long startTime = millis();
-
-    // Wait for button to be pressed (HIGH when pressed due to logic)
-    while (digitalRead(buttonPin) == LOW)
-    {
-        if (millis() - startTime >= timeoutMs)
-        {
-            return false; // Timeout
-        }
-        //delay(5); // Sample the endswitch at 200Hz
-    }
-
-    return true; // Button pressed
 }
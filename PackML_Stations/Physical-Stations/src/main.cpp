@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "ESP32Module.h"
+#include "TaskLayout.h"
 
 #ifdef FILLING_STATION
 #include "FillingModule.h"
@@ -34,5 +35,7 @@ void setup()
 
 void loop()
 {
-    // Event-driven architecture - all processing handled by MQTT callbacks
+    // Event-driven architecture - all processing handled by MQTT callbacks and the tasks on
+    // ACTUATION_CORE. The Arduino loop task would otherwise spin on that core at priority 1.
+    vTaskDelete(nullptr);
 }
@@ -1,7 +1,6 @@
 from MQTT_classes import Proxy, ResponseAsync, Publisher, Subscriber
-import time
 from PackMLSimulator import PackMLStateMachine
-import datetime
+import sim_clock
 import cv2
 import base64
 import os
@@ -18,7 +17,7 @@ image_publisher = Publisher(
 
 
 def capture_process(duration=0.5):
-    time.sleep(duration)
+    sim_clock.sleep(duration)
     webcam = None
     try:
         webcam = cv2.VideoCapture(0)
@@ -37,8 +36,7 @@ def capture_process(duration=0.5):
         img_bytes = base64.b64encode(img_encoded).decode('utf-8')
 
         # Generate ISO 8601 timestamp with Z suffix for UTC
-        timestamp = datetime.datetime.now(datetime.timezone.utc).isoformat(
-            timespec='milliseconds').replace('+00:00', 'Z')
+        timestamp = sim_clock.timestamp()
 
         response = {
             "Image": img_bytes,
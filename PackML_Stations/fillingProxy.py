@@ -1,8 +1,7 @@
 from MQTT_classes import Proxy, Publisher, ResponseAsync
-import time
 import numpy as np
 from PackMLSimulator import PackMLStateMachine
-import datetime
+import sim_clock
 import os
 
 BROKER_ADDRESS = os.getenv("MQTT_BROKER", "hivemq-broker")
@@ -39,7 +38,7 @@ def dispense_process(mean_duration=2.0, mean_weight=2.0, start_weight=0.0):
     publish_weight(start_weight)
 
     for i in range(steps):
-        time.sleep(step_size)
+        sim_clock.sleep(step_size)
         current_time = (i+1) * step_size
         # PT1 response formula with scaling to ensure reaching 1.0
         pt1_value = 1.0 - np.exp(-current_time / time_constant)
@@ -48,7 +47,7 @@ def dispense_process(mean_duration=2.0, mean_weight=2.0, start_weight=0.0):
 
 
 def tare_process(duration=2.0):
-    time.sleep(duration)
+    sim_clock.sleep(duration)
     publish_weight(0.0, reset=True)
 
 
@@ -58,8 +57,7 @@ def publish_weight(weight, reset=False):
         weight = 0.0
 
     # Generate ISO 8601 timestamp with Z suffix for UTC
-    timestamp = datetime.datetime.now(datetime.timezone.utc).isoformat(
-        timespec='milliseconds').replace('+00:00', 'Z')
+    timestamp = sim_clock.timestamp()
     global uuid
     response = {
         "Weight": weight,
@@ -107,8 +105,7 @@ def refill_callback(topic, client, message, properties):
             message, refill, dispense_process, duration, weight, start_weight)
     except Exception as e:
         print(f"Error in stopper_callback: {e}")
-        timestamp = datetime.datetime.now(datetime.timezone.utc).isoformat(
-            timespec='milliseconds').replace('+00:00', 'Z')
+        timestamp = sim_clock.timestamp()
         response = {
             "State": "FAILURE",
             "TimeStamp": timestamp,
@@ -1,6 +1,6 @@
 from MQTT_classes import Proxy, ResponseAsync, Publisher, Subscriber
-import time
 from PackMLSimulator import PackMLStateMachine
+import sim_clock
 
 import os
 
@@ -10,7 +10,7 @@ BASE_TOPIC = "NN/Nybrovej/InnoLab/Loading"
 
 
 def load_process(duration=2.0):
-    time.sleep(duration)
+    sim_clock.sleep(duration)
 
 
 def load_callback(topic, client, message, properties):
@@ -0,0 +1,73 @@
+"""
+Simulation time shared by the simulated stations and the BT controller.
+
+SIM_SPEED runs processes that many times faster than real time (1 = real time).
+Stations started with the same SIM_EPOCH (Unix seconds) agree on the simulated time
+without talking to each other: it is SIM_EPOCH + (now - SIM_EPOCH) * SIM_SPEED. Without
+SIM_EPOCH each process counts from its own start.
+
+With SIM_SPEED other than 1 each station publishes the simulated time on
+SIM_CLOCK_TOPIC, which the controller follows in its "driven" sim_clock mode.
+"""
+import datetime
+import json
+import os
+import threading
+import time
+
+SPEED = max(float(os.getenv("SIM_SPEED") or "1.0"), 1e-6)
+EPOCH = float(os.getenv("SIM_EPOCH") or time.time())
+CLOCK_TOPIC = os.getenv(
+    "SIM_CLOCK_TOPIC", "NN/Nybrovej/InnoLab/Simulation/DATA/Clock")
+CLOCK_INTERVAL = float(os.getenv("SIM_CLOCK_INTERVAL", "1.0"))
+
+_publisher_started = False
+_publisher_lock = threading.Lock()
+
+
+def is_virtual():
+    return SPEED != 1.0
+
+
+def now():
+    """Simulated time in Unix seconds"""
+    if not is_virtual():
+        return time.time()
+    return EPOCH + (time.time() - EPOCH) * SPEED
+
+
+def sleep(seconds):
+    """Sleep for a simulated duration"""
+    time.sleep(max(seconds, 0.0) / SPEED)
+
+
+def timestamp():
+    """ISO 8601 UTC timestamp of the simulated time, with a Z suffix"""
+    return datetime.datetime.fromtimestamp(now(), datetime.timezone.utc).isoformat(
+        timespec='milliseconds').replace('+00:00', 'Z')
+
+
+def clock_message():
+    return {"TimeStamp": timestamp(), "SimTime": now(), "Speed": SPEED}
+
+
+def start_publisher(client):
+    """Publish the simulated time every CLOCK_INTERVAL wall seconds; once per process"""
+    global _publisher_started
+    if not is_virtual():
+        return
+    with _publisher_lock:
+        if _publisher_started:
+            return
+        _publisher_started = True
+
+    def publish_loop():
+        while True:
+            try:
+                client.publish(CLOCK_TOPIC, json.dumps(clock_message()), qos=0, retain=True)
+            except Exception as e:
+                print(f"[SimClock] Error publishing clock: {e}", flush=True)
+            time.sleep(CLOCK_INTERVAL)
+
+    threading.Thread(target=publish_loop, daemon=True).start()
+    print(f"[SimClock] Running at {SPEED}x, publishing on {CLOCK_TOPIC}", flush=True)
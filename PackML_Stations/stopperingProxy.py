@@ -1,6 +1,6 @@
 from MQTT_classes import Proxy, ResponseAsync, Publisher, Subscriber
-import time
 from PackMLSimulator import PackMLStateMachine
+import sim_clock
 import os
 
 BROKER_ADDRESS = os.getenv("MQTT_BROKER", "hivemq-broker")
@@ -9,7 +9,7 @@ BASE_TOPIC = "NN/Nybrovej/InnoLab/Stoppering"
 
 
 def stopper_process(duration=2.0):
-    time.sleep(duration)
+    sim_clock.sleep(duration)
 
 
 def stopper_callback(topic, client, message, properties):
@@ -36,7 +36,7 @@ from library.astar_pathfinding import astar_search
 from library.path_simplifier import simplify_path, merge_collinear_segments
 
 from PackMLSimulator import PackMLStateMachine, PackMLState
-from MQTT_classes import Proxy, ResponseAsync, Publisher, Topic
+from MQTT_classes import Proxy, ResponseAsync, Publisher, Subscriber, Topic
 
 # MQTT Configuration
 MQTT_BROKER = os.environ.get("MQTT_BROKER", "localhost")
@@ -48,6 +48,9 @@ WORKSPACE = None
 ACTIVE_XBOT_IDS = set()
 PMC_LOCK = threading.Lock()
 XBOT_POS_PUBLISHERS = {}
+# Goals (m) of the xbots moving as part of a CMD/BatchMotion, kept clear by the others
+BATCH_GOALS = {}
+BATCH_LOCK = threading.Lock()
 
 def get_flyway_centers():
     """Get all valid flyway centers."""
@@ -199,6 +202,9 @@ def perform_xbot_task(xbot_id, goal_pos, goal_rot, execute_topic_publisher):
             if oid != xbot_id:
                 op = get_xbot_position(oid)
                 if op: others.append(op)
+        # Moves of the same batch do not route through each other's goals
+        with BATCH_LOCK:
+            others.extend(g for oid, g in BATCH_GOALS.items() if oid != xbot_id and g != goal_pos)
         
         grid, gw, gh = create_occupancy_grid(WORKSPACE, others)
         print(f"XBot {xbot_id}: Grid dimensions: {gw}x{gh}, Workspace: {WORKSPACE['width']}x{WORKSPACE['height']} flyways, Holes: {WORKSPACE.get('holes', [])}", flush=True)
@@ -330,7 +336,7 @@ class PlanarSystemHandler:
 
 # --- Callbacks ---
 
-def handle_xbot_motion_cmd(topic, client, message, properties, xbot_sm, xbot_id):
+def handle_xbot_motion_cmd(topic, client, message, properties, xbot_sm, xbot_id, batched=False):
     """Callback for XBot CMD/XYMotion"""
     # 1. Extract Info
     print(f"XBot {xbot_id} Motion Callback triggered.", flush=True)
@@ -352,7 +358,12 @@ def handle_xbot_motion_cmd(topic, client, message, properties, xbot_sm, xbot_id)
     def process_func(*args):
         # We pass self.interrupt_event if available?
         # PackMLSimulator checks signature. 
-        perform_xbot_task(xbot_id, goal_pos, goal_rot, topic)
+        try:
+            perform_xbot_task(xbot_id, goal_pos, goal_rot, topic)
+        finally:
+            if batched:
+                with BATCH_LOCK:
+                    BATCH_GOALS.pop(xbot_id, None)
     
     # We call execute immediately. 
     # If the queue has only 1 item (this one), it will execute.
@@ -366,6 +377,36 @@ def handle_xbot_motion_cmd(topic, client, message, properties, xbot_sm, xbot_id)
     
     xbot_sm.execute_command(message, topic, process_func)
 
+def handle_batch_motion_cmd(topic, client, message, properties, xbot_sms, motion_topics):
+    """Callback for CMD/BatchMotion: moves of several xbots started together.
+
+    Every move is run and answered as if it had arrived on its xbot's own CMD/XYMotion;
+    the goals of the batch are registered first so each xbot plans around the others'.
+    """
+    moves = []
+    for move in message.get("Moves", []):
+        name = str(move.get("Xbot", ""))
+        xbot_id = int(name[4:]) if name.startswith("Xbot") and name[4:].isdigit() else None
+        pos = move.get("Position")
+        if xbot_id not in xbot_sms or not move.get("Uuid") or not pos:
+            print(f"Batch {message.get('Uuid')}: Invalid Move {move}", flush=True)
+            continue
+        moves.append((xbot_id, move))
+
+    print(f"Batch {message.get('Uuid')}: {len(moves)} moves", flush=True)
+    with BATCH_LOCK:
+        for xbot_id, move in moves:
+            pos = move["Position"]
+            BATCH_GOALS[xbot_id] = (float(pos[0]) / 1000.0, float(pos[1]) / 1000.0)
+
+    for xbot_id, move in moves:
+        xbot_sm = xbot_sms[xbot_id]
+        handle_xbot_motion_cmd(motion_topics[xbot_id], client, move, properties, xbot_sm, xbot_id, batched=True)
+        # Not started (not occupied, or another task running): nothing will clear its goal
+        if xbot_sm.current_processing_uuid != move["Uuid"]:
+            with BATCH_LOCK:
+                BATCH_GOALS.pop(xbot_id, None)
+
 def publish_positions_loop(proxy):
     """Background thread to publish XBot positions"""
     last_positions = {}
@@ -470,6 +511,7 @@ def main():
     
     # 4. XBot SMs
     xbot_sms = {}
+    motion_topics = {}
     
     # Dynamic detection via global function or updated lib function
     print("Scanning for detected XBots...", flush=True)
@@ -513,6 +555,7 @@ def main():
             lambda t, c, m, p, sm=xb_sm, xid=i: handle_xbot_motion_cmd(t, c, m, p, sm, xid)
         )
         proxy.register_topic(mot_topic)
+        motion_topics[i] = mot_topic
         
         # Position Publisher
         pos_topic = Publisher(
@@ -523,6 +566,15 @@ def main():
         proxy.register_topic(pos_topic)
         XBOT_POS_PUBLISHERS[i] = pos_topic
         
+    # Batch Motion Topic: moves of several xbots sent together by the orchestrator
+    batch_topic = Subscriber(
+        f"{MQTT_BASE_TOPIC}/CMD/BatchMotion",
+        "./MQTTSchemas/batchMotion.schema.json",
+        2,
+        lambda t, c, m, p: handle_batch_motion_cmd(t, c, m, p, xbot_sms, motion_topics)
+    )
+    proxy.register_topic(batch_topic)
+
     # 5. Position Thread
     pos_thread = threading.Thread(target=publish_positions_loop, args=(proxy,), daemon=True)
     pos_thread.start()
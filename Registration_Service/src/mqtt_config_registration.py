@@ -3,6 +3,12 @@ MQTT Registration Listener for Unified Registration Service
 
 Listens for asset registration messages via MQTT and processes YAML configurations.
 Supports both full AAS JSON and lightweight YAML config transmission.
+
+Stations may stream their config in chunks below the config topic:
+    {config_topic}/{station}/Header       {"Hash": "<fnv1a32 hex>", "Size": n, "Chunks": k}
+    {config_topic}/{station}/Chunk/{i}    raw bytes i*chunk_size .. (i+1)*chunk_size
+A header whose hash matches the station's last successful registration is
+answered right away and its chunks are ignored.
 """
 
 import json
@@ -19,6 +25,14 @@ from .unified_service import UnifiedRegistrationService
 logger = logging.getLogger(__name__)
 
 
+def fnv1a32(data: bytes) -> int:
+    """32-bit FNV-1a, the station's config hash"""
+    value = 0x811c9dc5
+    for byte in data:
+        value = ((value ^ byte) * 0x01000193) & 0xffffffff
+    return value
+
+
 class MQTTConfigRegistrationService:
     """
     MQTT interface for config-based asset registration.
@@ -66,6 +80,11 @@ class MQTTConfigRegistrationService:
         # Lock for service operations
         self.service_lock = threading.Lock()
 
+        # Chunked configs being reassembled, and the hash of each station's
+        # last successfully registered config
+        self._config_streams: Dict[str, Dict[str, Any]] = {}
+        self._registered_hashes: Dict[str, str] = {}
+
         # Batch processing configuration
         # Wait this long after last message before restarting databridge
         self.batch_debounce_seconds = 2.0
@@ -77,6 +96,7 @@ class MQTTConfigRegistrationService:
         # Statistics
         self.stats = {
             'config_received': 0,
+            'config_unchanged': 0,
             'processed': 0,
             'failed': 0,
             'databridge_restarts': 0
@@ -148,7 +168,8 @@ class MQTTConfigRegistrationService:
             logger.info("Connected to MQTT broker")
             # Subscribe to config topic
             client.subscribe(self.config_topic, qos=2)
-            logger.info(f"Subscribed to: {self.config_topic}")
+            client.subscribe(f"{self.config_topic}/#", qos=1)
+            logger.info(f"Subscribed to: {self.config_topic} (and chunked streams below it)")
         else:
             logger.error(f"Failed to connect: {reason_code}")
 
@@ -161,12 +182,15 @@ class MQTTConfigRegistrationService:
         """Handle incoming MQTT messages"""
         try:
             topic = msg.topic
-            payload_str = msg.payload.decode('utf-8')
 
             # Handle config registration messages
             if topic == self.config_topic:
                 self.stats['config_received'] += 1
-                self._handle_config_message(payload_str)
+                self._handle_config_message(msg.payload.decode('utf-8'))
+            elif topic.startswith(self.config_topic + '/'):
+                # Chunks may split multi-byte characters, so decode once reassembled
+                self._handle_stream_message(
+                    topic[len(self.config_topic) + 1:], msg.payload)
             else:
                 logger.warning(f"Unknown topic: {topic}")
 
@@ -174,7 +198,58 @@ class MQTTConfigRegistrationService:
             logger.error(f"Error processing message: {e}")
             self.stats['failed'] += 1
 
-    def _handle_config_message(self, payload: str):
+    def _handle_stream_message(self, subtopic: str, payload: bytes):
+        """Handle one part of a chunked config: {station}/Header or {station}/Chunk/{i}"""
+        parts = subtopic.split('/')
+        if len(parts) == 2 and parts[1] == 'Header':
+            station = parts[0]
+            header = json.loads(payload)
+            config_hash = str(header['Hash']).lower()
+            if self._registered_hashes.get(station) == config_hash:
+                logger.info(
+                    f"Config for {station} unchanged (hash {config_hash}), skipping regeneration")
+                self._config_streams.pop(station, None)
+                self.stats['config_unchanged'] += 1
+                self._send_response(f"device-{station}-{int(time.time())}", True,
+                                    f"Config for {station} unchanged")
+                return
+            self._config_streams[station] = {
+                'hash': config_hash,
+                'size': int(header['Size']),
+                'chunks': int(header['Chunks']),
+                'parts': {}
+            }
+            return
+
+        if len(parts) != 3 or parts[1] != 'Chunk':
+            logger.warning(f"Unknown config stream topic: {subtopic}")
+            return
+
+        station = parts[0]
+        stream = self._config_streams.get(station)
+        if stream is None:
+            # Unchanged config, or the header was missed
+            return
+        stream['parts'][int(parts[2])] = payload
+        if len(stream['parts']) < stream['chunks']:
+            return
+
+        del self._config_streams[station]
+        content = b''.join(stream['parts'][i] for i in range(stream['chunks']))
+        content_hash = f"{fnv1a32(content):08x}"
+        if len(content) != stream['size'] or content_hash != stream['hash']:
+            logger.error(
+                f"Config stream from {station} corrupt: {len(content)}/{stream['size']} bytes, "
+                f"hash {content_hash} (expected {stream['hash']})")
+            self.stats['failed'] += 1
+            return
+
+        self.stats['config_received'] += 1
+        self._handle_config_message(content.decode('utf-8'),
+                                    station=station, config_hash=content_hash)
+
+    def _handle_config_message(self, payload: str, station: Optional[str] = None,
+                               config_hash: Optional[str] = None):
         """
         Handle YAML config registration message.
 
@@ -240,6 +315,8 @@ class MQTTConfigRegistrationService:
                 'request_id': request_id,
                 'asset_id': asset_id,
                 'config_data': config_data,
+                'station': station,
+                'config_hash': config_hash,
                 'timestamp': time.time()
             })
 
@@ -331,12 +408,15 @@ class MQTTConfigRegistrationService:
                 if success:
                     logger.info(f"Successfully registered: {asset_id}")
                     self._send_response(
-                        request_id, True, f"Asset {asset_id} registered (databridge restart pending)")
+                        request_id, True, f"Asset {asset_id} registered (databridge restart pending)",
+                        asset_id=asset_id)
                     self.stats['processed'] += 1
                     # Mark that we need to restart databridge and update timing
                     self._pending_databridge_restart = True
                     self._last_registration_time = time.time()
                     self._batch_processed_count += 1
+                    if item.get('config_hash'):
+                        self._registered_hashes[item['station']] = item['config_hash']
                 else:
                     logger.error(f"Failed to register: {asset_id}")
                     self._send_response(request_id, False,
@@ -430,8 +510,13 @@ class MQTTConfigRegistrationService:
             logger.error(f"Legacy registration failed: {e}")
             return False
 
-    def _send_response(self, request_id: str, success: bool, message: str):
-        """Send registration response via MQTT"""
+    def _send_response(self, request_id: str, success: bool, message: str,
+                       asset_id: Optional[str] = None):
+        """Send registration response via MQTT
+
+        Successful responses name the registered asset so subscribers (e.g. the
+        BT controller's interface cache) can refresh just that asset.
+        """
         try:
             response = {
                 'requestId': request_id,
@@ -439,6 +524,8 @@ class MQTTConfigRegistrationService:
                 'message': message,
                 'timestamp': time.time()
             }
+            if asset_id and asset_id != 'unknown':
+                response['assetId'] = asset_id
 
             self.mqtt_client.publish(
                 self.response_topic,